@@ -13,6 +13,7 @@
 
 #include <memory>
 
+#include "absl/types/optional.h"
 #include "api/audio/audio_frame.h"
 #include "rtc_base/refcount.h"
 
@@ -35,6 +36,14 @@ class AudioMixer : public rtc::RefCountInterface {
       kError,   // The audio_frame will not be used.
     };
 
+    // What a source knows about its next frame before decoding it, e.g. from
+    // the RTP audio level header extension (RFC 6464).
+    struct PreDecodeInfo {
+      // Audio level in -dBov, in the range [0, 127]. Lower is louder.
+      uint8_t audio_level_dbov = 127;
+      bool voice_activity = false;
+    };
+
     // Overwrites |audio_frame|. The data_ field is overwritten with
     // 10 ms of new audio (either 1 or 2 interleaved channels) at
     // |sample_rate_hz|. All fields in |audio_frame| must be updated.
@@ -48,6 +57,19 @@ class AudioMixer : public rtc::RefCountInterface {
     // with this sample rate or higher will not cause quality loss.
     virtual int PreferredSampleRate() const = 0;
 
+    // Returns information about the next frame that is available without
+    // decoding it, or nothing if the source can't tell. A mixer may use it to
+    // leave out sources before asking for audio; those sources then get a
+    // call to SkipAudioFrame() instead of GetAudioFrameWithInfo(). A source
+    // that needs to produce every frame, e.g. for a sink, returns nothing.
+    virtual absl::optional<PreDecodeInfo> GetPreDecodeInfo() const {
+      return absl::nullopt;
+    }
+
+    // Advances the source by 10 ms without producing audio. Only called on
+    // sources which have returned a value from GetPreDecodeInfo().
+    virtual void SkipAudioFrame() {}
+
     virtual ~Source() {}
   };
 
@@ -54,6 +54,18 @@ struct DataChannelInit {
 
   // The stream id, or SID, for SCTP data channels. -1 if unset (see above).
   int id = -1;
+
+  // Non-standard. If positive, messages are sent in groups of this size, each
+  // followed by |fecParityMessages| parity messages from which the receiver
+  // rebuilds lost messages without waiting for a retransmission. Only valid
+  // for unordered SCTP channels with |maxRetransmits| or |maxRetransmitTime|
+  // set, and at most 48. Both endpoints must use the same values, so the
+  // channel has to be |negotiated|.
+  int fecGroupSize = 0;
+
+  // Number of parity messages per group, between 1 and |fecGroupSize|. With
+  // one, a single lost message per group can be rebuilt.
+  int fecParityMessages = 1;
 };
 
 // At the JavaScript level, data can be passed in as a string or a blob, so
@@ -814,6 +814,14 @@ class PeerConnectionInterface : public rtc::RefCountInterface {
   virtual void GetStats(
       rtc::scoped_refptr<RtpReceiverInterface> selector,
       rtc::scoped_refptr<RTCStatsCollectorCallback> callback) {}
+  // Like the spec-compliant GetStats(), but delivers only the changes since
+  // the previous call: the stats objects that are new or have changed, and
+  // the IDs of the ones that went away. The first call delivers every stats
+  // object. Cheaper than a full report for an application that polls stats
+  // and keeps the previous report. There is one baseline per PeerConnection,
+  // so this is meant for a single consumer.
+  virtual void GetStatsDelta(
+      rtc::scoped_refptr<RTCStatsDeltaCallback> callback) {}
   // Clear cached stats in the RTCStatsCollector.
   // Exposed for testing while waiting for automatic cache clear to work.
   // https://bugs.webrtc.org/8693
@@ -1205,6 +1213,39 @@ class PeerConnectionFactoryInterface : public rtc::RefCountInterface {
 
     // Sets crypto related options, e.g. enabled cipher suites.
     rtc::CryptoOptions crypto_options;
+
+    // If positive, the SCTP stacks of the data channels of created
+    // PeerConnections process received packets on this many threads, shared
+    // round robin, instead of on the network thread. Useful for servers with
+    // many busy data channels.
+    int sctp_thread_count = 0;
+
+    // If positive, the factory keeps this many DTLS certificates generated
+    // ahead of time, and gives one to each created PeerConnection that brings
+    // neither certificates nor a certificate generator of its own.
+    int certificate_pool_size = 0;
+
+    // If positive, the factory keeps this many default port allocators that
+    // have started gathering candidates for the configuration of the last
+    // created PeerConnection, and gives one to each created PeerConnection
+    // with the same configuration that brings no port allocator of its own.
+    // Only has an effect on configurations with a positive
+    // |ice_candidate_pool_size|. Useful for servers that see many similar
+    // PeerConnections created in a short time.
+    int port_allocator_pool_size = 0;
+
+    // If set to true, the DTLS transports of created PeerConnections share a
+    // session cache, so that a second connection between the same two
+    // certificates resumes the session of the first instead of doing a full
+    // handshake.
+    bool enable_dtls_session_resumption = false;
+
+    // If set to true, the DTLS handshakes of created PeerConnections do their
+    // private key operations on a shared pool of threads instead of the
+    // network thread, so that one expensive handshake doesn't hold up the
+    // packets of the other PeerConnections. Only has an effect with BoringSSL
+    // and ECDSA certificates.
+    bool offload_dtls_handshakes = false;
   };
 
   // Set the options to be used for subsequently created PeerConnections.
@@ -71,6 +71,7 @@ PROXY_METHOD2(void,
               GetStats,
               rtc::scoped_refptr<RtpReceiverInterface>,
               rtc::scoped_refptr<RTCStatsCollectorCallback>);
+PROXY_METHOD1(void, GetStatsDelta, rtc::scoped_refptr<RTCStatsDeltaCallback>)
 PROXY_METHOD2(rtc::scoped_refptr<DataChannelInterface>,
               CreateDataChannel,
               const std::string&,
@@ -128,6 +128,10 @@ class RTCDataChannelStats final : public RTCStats {
   RTCStatsMember<uint64_t> bytes_sent;
   RTCStatsMember<uint32_t> messages_received;
   RTCStatsMember<uint64_t> bytes_received;
+  // Non-standard, only set when the channel uses FEC
+  // (DataChannelInit::fecGroupSize).
+  RTCNonStandardStatsMember<uint32_t> fec_messages_recovered;
+  RTCNonStandardStatsMember<uint32_t> fec_messages_unrecovered;
 };
 
 // https://w3c.github.io/webrtc-stats/#candidatepair-dict*
@@ -11,6 +11,9 @@
 #ifndef API_STATS_RTCSTATSCOLLECTORCALLBACK_H_
 #define API_STATS_RTCSTATSCOLLECTORCALLBACK_H_
 
+#include <string>
+#include <vector>
+
 #include "api/stats/rtcstatsreport.h"
 #include "rtc_base/refcount.h"
 #include "rtc_base/scoped_ref_ptr.h"
@@ -25,6 +28,20 @@ class RTCStatsCollectorCallback : public virtual rtc::RefCountInterface {
       const rtc::scoped_refptr<const RTCStatsReport>& report) = 0;
 };
 
+// Callback for |PeerConnectionInterface::GetStatsDelta|.
+class RTCStatsDeltaCallback : public virtual rtc::RefCountInterface {
+ public:
+  ~RTCStatsDeltaCallback() override = default;
+
+  // |delta| holds the stats objects that are new or have members that changed
+  // since the previous delta, and |removed_ids| the IDs of the stats objects
+  // that have gone away since then. Applied to the report the previous deltas
+  // add up to, they give the current report, timestamps aside.
+  virtual void OnStatsDeltaDelivered(
+      const rtc::scoped_refptr<const RTCStatsReport>& delta,
+      const std::vector<std::string>& removed_ids) = 0;
+};
+
 }  // namespace webrtc
 
 #endif  // API_STATS_RTCSTATSCOLLECTORCALLBACK_H_
@@ -248,6 +248,15 @@ int AudioReceiveStream::PreferredSampleRate() const {
   return channel_proxy_->PreferredSampleRate();
 }
 
+absl::optional<AudioMixer::Source::PreDecodeInfo>
+AudioReceiveStream::GetPreDecodeInfo() const {
+  return channel_proxy_->GetPreDecodeInfo();
+}
+
+void AudioReceiveStream::SkipAudioFrame() {
+  channel_proxy_->SkipAudioFrame();
+}
+
 int AudioReceiveStream::id() const {
   RTC_DCHECK_RUN_ON(&worker_thread_checker_);
   return config_.rtp.remote_ssrc;
@@ -460,6 +460,29 @@ AudioMixer::Source::AudioFrameInfo Channel::GetAudioFrameWithInfo(
                : AudioMixer::Source::AudioFrameInfo::kNormal;
 }
 
+absl::optional<AudioMixer::Source::PreDecodeInfo> Channel::GetPreDecodeInfo()
+    const {
+  {
+    // A sink gets every frame, so a stream with one is never skipped.
+    rtc::CritScope cs(&_callbackCritSect);
+    if (audio_sink_) {
+      return absl::nullopt;
+    }
+  }
+  rtc::CritScope cs(&rtp_sources_lock_);
+  if (!last_received_rtp_audio_level_) {
+    return absl::nullopt;
+  }
+  AudioMixer::Source::PreDecodeInfo info;
+  info.audio_level_dbov = *last_received_rtp_audio_level_;
+  info.voice_activity = last_received_rtp_voice_activity_;
+  return info;
+}
+
+void Channel::SkipAudioFrame() {
+  audio_coding_->SkipPlayout10Ms();
+}
+
 int Channel::PreferredSampleRate() const {
   // Return the bigger of playout and receive frequency in the ACM.
   return std::max(audio_coding_->ReceiveFrequency(),
@@ -860,8 +883,10 @@ void Channel::OnRtpPacket(const RtpPacketReceived& packet) {
     rtc::CritScope cs(&rtp_sources_lock_);
     last_received_rtp_timestamp_ = packet.Timestamp();
     last_received_rtp_system_time_ms_ = now_ms;
-    if (has_audio_level)
+    if (has_audio_level) {
       last_received_rtp_audio_level_ = audio_level;
+      last_received_rtp_voice_activity_ = voice_activity;
+    }
     std::vector<uint32_t> csrcs = packet.Csrcs();
     contributing_sources_.Update(now_ms, csrcs);
   }
@@ -266,6 +266,14 @@ class Channel
 
   int PreferredSampleRate() const;
 
+  // Returns the audio level and voice activity of the last received packet,
+  // as signaled in the RTP audio level header extension, if any. Returns
+  // nothing while a sink is set, so that the stream is always decoded.
+  absl::optional<AudioMixer::Source::PreDecodeInfo> GetPreDecodeInfo() const;
+
+  // Advances the jitter buffer by 10 ms without decoding.
+  void SkipAudioFrame();
+
   bool Playing() const { return channel_state_.Get().playing; }
   bool Sending() const { return channel_state_.Get().sending; }
   RtpRtcp* RtpRtcpModulePtr() const { return _rtpRtcpModule.get(); }
@@ -354,6 +362,8 @@ class Channel
       RTC_GUARDED_BY(&rtp_sources_lock_);
   absl::optional<uint8_t> last_received_rtp_audio_level_
       RTC_GUARDED_BY(&rtp_sources_lock_);
+  bool last_received_rtp_voice_activity_ RTC_GUARDED_BY(&rtp_sources_lock_) =
+      false;
 
   std::unique_ptr<AudioCodingModule> audio_coding_;
   AudioSinkInterface* audio_sink_ = nullptr;
@@ -233,6 +233,17 @@ int ChannelProxy::PreferredSampleRate() const {
   return channel_->PreferredSampleRate();
 }
 
+absl::optional<AudioMixer::Source::PreDecodeInfo>
+ChannelProxy::GetPreDecodeInfo() const {
+  RTC_DCHECK_RUNS_SERIALIZED(&audio_thread_race_checker_);
+  return channel_->GetPreDecodeInfo();
+}
+
+void ChannelProxy::SkipAudioFrame() {
+  RTC_DCHECK_RUNS_SERIALIZED(&audio_thread_race_checker_);
+  channel_->SkipAudioFrame();
+}
+
 void ChannelProxy::ProcessAndEncodeAudio(
     std::unique_ptr<AudioFrame> audio_frame) {
   RTC_DCHECK_RUNS_SERIALIZED(&audio_thread_race_checker_);
@@ -101,6 +101,9 @@ class ChannelProxy : public RtpPacketSinkInterface {
       int sample_rate_hz,
       AudioFrame* audio_frame);
   virtual int PreferredSampleRate() const;
+  virtual absl::optional<AudioMixer::Source::PreDecodeInfo> GetPreDecodeInfo()
+      const;
+  virtual void SkipAudioFrame();
   virtual void ProcessAndEncodeAudio(std::unique_ptr<AudioFrame> audio_frame);
   virtual void SetTransportOverhead(int transport_overhead_per_packet);
   virtual void AssociateSendChannel(const ChannelProxy& send_channel_proxy);
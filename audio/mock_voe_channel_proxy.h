@@ -71,6 +71,9 @@ class MockVoEChannelProxy : public voe::ChannelProxy {
                AudioMixer::Source::AudioFrameInfo(int sample_rate_hz,
                                                   AudioFrame* audio_frame));
   MOCK_CONST_METHOD0(PreferredSampleRate, int());
+  MOCK_CONST_METHOD0(GetPreDecodeInfo,
+                     absl::optional<AudioMixer::Source::PreDecodeInfo>());
+  MOCK_METHOD0(SkipAudioFrame, void());
   // GMock doesn't like move-only types, like std::unique_ptr.
   virtual void ProcessAndEncodeAudio(std::unique_ptr<AudioFrame> audio_frame) {
     ProcessAndEncodeAudioForMock(&audio_frame);
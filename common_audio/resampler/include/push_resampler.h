@@ -17,7 +17,8 @@ namespace webrtc {
 
 class PushSincResampler;
 
-// Wraps PushSincResampler to provide stereo support.
+// Wraps PushSincResampler to provide stereo support. Stereo is resampled by a
+// single multi-channel PushSincResampler, directly on the interleaved audio.
 // TODO(ajm): add support for an arbitrary number of channels.
 template <typename T>
 class PushResampler {
@@ -37,14 +38,9 @@ class PushResampler {
 
  private:
   std::unique_ptr<PushSincResampler> sinc_resampler_;
-  std::unique_ptr<PushSincResampler> sinc_resampler_right_;
   int src_sample_rate_hz_;
   int dst_sample_rate_hz_;
   size_t num_channels_;
-  std::unique_ptr<T[]> src_left_;
-  std::unique_ptr<T[]> src_right_;
-  std::unique_ptr<T[]> dst_left_;
-  std::unique_ptr<T[]> dst_right_;
 };
 
 }  // namespace webrtc
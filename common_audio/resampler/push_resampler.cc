@@ -12,7 +12,6 @@
 
 #include <string.h>
 
-#include "common_audio/include/audio_util.h"
 #include "common_audio/resampler/include/resampler.h"
 #include "common_audio/resampler/push_sinc_resampler.h"
 #include "rtc_base/checks.h"
@@ -89,16 +88,8 @@ int PushResampler<T>::InitializeIfNeeded(int src_sample_rate_hz,
       static_cast<size_t>(src_sample_rate_hz / 100);
   const size_t dst_size_10ms_mono =
       static_cast<size_t>(dst_sample_rate_hz / 100);
-  sinc_resampler_.reset(
-      new PushSincResampler(src_size_10ms_mono, dst_size_10ms_mono));
-  if (num_channels_ == 2) {
-    src_left_.reset(new T[src_size_10ms_mono]);
-    src_right_.reset(new T[src_size_10ms_mono]);
-    dst_left_.reset(new T[dst_size_10ms_mono]);
-    dst_right_.reset(new T[dst_size_10ms_mono]);
-    sinc_resampler_right_.reset(
-        new PushSincResampler(src_size_10ms_mono, dst_size_10ms_mono));
-  }
+  sinc_resampler_.reset(new PushSincResampler(
+      src_size_10ms_mono, dst_size_10ms_mono, num_channels_));
 
   return 0;
 }
@@ -117,25 +108,8 @@ int PushResampler<T>::Resample(const T* src,
     memcpy(dst, src, src_length * sizeof(T));
     return static_cast<int>(src_length);
   }
-  if (num_channels_ == 2) {
-    const size_t src_length_mono = src_length / num_channels_;
-    const size_t dst_capacity_mono = dst_capacity / num_channels_;
-    T* deinterleaved[] = {src_left_.get(), src_right_.get()};
-    Deinterleave(src, src_length_mono, num_channels_, deinterleaved);
-
-    size_t dst_length_mono = sinc_resampler_->Resample(
-        src_left_.get(), src_length_mono, dst_left_.get(), dst_capacity_mono);
-    sinc_resampler_right_->Resample(src_right_.get(), src_length_mono,
-                                    dst_right_.get(), dst_capacity_mono);
-
-    deinterleaved[0] = dst_left_.get();
-    deinterleaved[1] = dst_right_.get();
-    Interleave(deinterleaved, dst_length_mono, num_channels_, dst);
-    return static_cast<int>(dst_length_mono * num_channels_);
-  } else {
-    return static_cast<int>(
-        sinc_resampler_->Resample(src, src_length, dst, dst_capacity));
-  }
+  return static_cast<int>(
+      sinc_resampler_->Resample(src, src_length, dst, dst_capacity));
 }
 
 // Explictly generate required instantiations.
@@ -332,4 +332,48 @@ INSTANTIATE_TEST_CASE_P(
         ::testing::make_tuple(96000, 32000, -19.61, -18.04),
         ::testing::make_tuple(192000, 32000, -21.02, -10.94)));
 
+// Resampling interleaved stereo in one pass gives the same result as resampling
+// the channels separately.
+TEST(PushSincResamplerMultiChannelTest, MatchesSingleChannelResampling) {
+  const size_t kChannels = 2;
+  const size_t kSourceFrames = 480;
+  const size_t kDestinationFrames = 160;
+  const int kNumBlocks = 5;
+
+  PushSincResampler stereo_resampler(kSourceFrames, kDestinationFrames,
+                                     kChannels);
+  PushSincResampler left_resampler(kSourceFrames, kDestinationFrames);
+  PushSincResampler right_resampler(kSourceFrames, kDestinationFrames);
+
+  std::unique_ptr<float[]> source(new float[kSourceFrames * kChannels]);
+  std::unique_ptr<float[]> left_source(new float[kSourceFrames]);
+  std::unique_ptr<float[]> right_source(new float[kSourceFrames]);
+  std::unique_ptr<float[]> destination(
+      new float[kDestinationFrames * kChannels]);
+  std::unique_ptr<float[]> left_destination(new float[kDestinationFrames]);
+  std::unique_ptr<float[]> right_destination(new float[kDestinationFrames]);
+
+  for (int block = 0; block < kNumBlocks; ++block) {
+    for (size_t i = 0; i < kSourceFrames; ++i) {
+      const float t = static_cast<float>(block * kSourceFrames + i);
+      left_source[i] = 1000.f * std::sin(0.01f * t);
+      right_source[i] = 500.f * std::cos(0.03f * t);
+      source[kChannels * i] = left_source[i];
+      source[kChannels * i + 1] = right_source[i];
+    }
+    EXPECT_EQ(kDestinationFrames * kChannels,
+              stereo_resampler.Resample(source.get(), kSourceFrames * kChannels,
+                                        destination.get(),
+                                        kDestinationFrames * kChannels));
+    left_resampler.Resample(left_source.get(), kSourceFrames,
+                            left_destination.get(), kDestinationFrames);
+    right_resampler.Resample(right_source.get(), kSourceFrames,
+                             right_destination.get(), kDestinationFrames);
+    for (size_t i = 0; i < kDestinationFrames; ++i) {
+      EXPECT_EQ(left_destination[i], destination[kChannels * i]);
+      EXPECT_EQ(right_destination[i], destination[kChannels * i + 1]);
+    }
+  }
+}
+
 }  // namespace webrtc
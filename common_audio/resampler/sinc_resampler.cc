@@ -122,7 +122,16 @@ const size_t SincResampler::kKernelSize;
 
 // If we know the minimum architecture at compile time, avoid CPU detection.
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-#if defined(__SSE2__)
+#if defined(WEBRTC_ENABLE_AVX2)
+// AVX2 support has to be detected at run time.
+#define CONVOLVE_FUNC convolve_proc_
+
+void SincResampler::InitializeCPUSpecificFeatures() {
+  convolve_proc_ = WebRtc_GetCPUInfo(kAVX2)
+                       ? Convolve_AVX2
+                       : WebRtc_GetCPUInfo(kSSE2) ? Convolve_SSE : Convolve_C;
+}
+#elif defined(__SSE2__)
 #define CONVOLVE_FUNC Convolve_SSE
 void SincResampler::InitializeCPUSpecificFeatures() {}
 #else
@@ -147,29 +156,44 @@ void SincResampler::InitializeCPUSpecificFeatures() {}
 SincResampler::SincResampler(double io_sample_rate_ratio,
                              size_t request_frames,
                              SincResamplerCallback* read_cb)
+    : SincResampler(io_sample_rate_ratio, request_frames, 1, read_cb) {}
+
+SincResampler::SincResampler(double io_sample_rate_ratio,
+                             size_t request_frames,
+                             size_t num_channels,
+                             SincResamplerCallback* read_cb)
     : io_sample_rate_ratio_(io_sample_rate_ratio),
       read_cb_(read_cb),
       request_frames_(request_frames),
+      num_channels_(num_channels),
       input_buffer_size_(request_frames_ + kKernelSize),
       // Create input buffers with a 16-byte alignment for SSE optimizations.
+      // The kernels are 32-byte aligned for AVX.
       kernel_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
+          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
       kernel_pre_sinc_storage_(static_cast<float*>(
           AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
       kernel_window_storage_(static_cast<float*>(
           AlignedMalloc(sizeof(float) * kKernelStorageSize, 16))),
-      input_buffer_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * input_buffer_size_, 16))),
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+      input_buffer_(static_cast<float*>(AlignedMalloc(
+          sizeof(float) * input_buffer_size_ * num_channels_,
+          16))),
+      interleaved_input_(num_channels_ > 1
+                             ? new float[request_frames_ * num_channels_]
+                             : nullptr),
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (!defined(__SSE2__) || defined(WEBRTC_ENABLE_AVX2))
       convolve_proc_(nullptr),
 #endif
       r1_(input_buffer_.get()),
       r2_(input_buffer_.get() + kKernelSize / 2) {
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (!defined(__SSE2__) || defined(WEBRTC_ENABLE_AVX2))
   InitializeCPUSpecificFeatures();
   RTC_DCHECK(convolve_proc_);
 #endif
   RTC_DCHECK_GT(request_frames_, 0);
+  RTC_DCHECK_GT(num_channels_, 0);
   Flush();
   RTC_DCHECK_GT(block_size_, kKernelSize);
 
@@ -201,6 +225,20 @@ void SincResampler::UpdateRegions(bool second_load) {
   RTC_DCHECK_LT(r2_, r3_);
 }
 
+void SincResampler::ReadInput() {
+  if (num_channels_ == 1) {
+    read_cb_->Run(request_frames_, r0_);
+    return;
+  }
+  read_cb_->Run(request_frames_, interleaved_input_.get());
+  for (size_t ch = 0; ch < num_channels_; ++ch) {
+    float* const channel_r0 = r0_ + ch * input_buffer_size_;
+    const float* interleaved = interleaved_input_.get() + ch;
+    for (size_t i = 0; i < request_frames_; ++i, interleaved += num_channels_)
+      channel_r0[i] = *interleaved;
+  }
+}
+
 void SincResampler::InitializeKernel() {
   // Blackman window parameters.
   static const double kAlpha = 0.16;
@@ -268,7 +306,7 @@ void SincResampler::Resample(size_t frames, float* destination) {
 
   // Step (1) -- Prime the input buffer at the start of the input stream.
   if (!buffer_primed_ && remaining_frames) {
-    read_cb_->Run(request_frames_, r0_);
+    ReadInput();
     buffer_primed_ = true;
   }
 
@@ -276,6 +314,7 @@ void SincResampler::Resample(size_t frames, float* destination) {
   // actually has an impact on ARM performance.  See inner loop comment below.
   const double current_io_ratio = io_sample_rate_ratio_;
   const float* const kernel_ptr = kernel_storage_.get();
+  const size_t num_channels = num_channels_;
   while (remaining_frames) {
     // |i| may be negative if the last Resample() call ended on an iteration
     // that put |virtual_source_idx_| over the limit.
@@ -312,8 +351,18 @@ void SincResampler::Resample(size_t frames, float* destination) {
       // Figure out how much to weight each kernel's "convolution".
       const double kernel_interpolation_factor =
           virtual_offset_idx - offset_idx;
-      *destination++ =
-          CONVOLVE_FUNC(input_ptr, k1, k2, kernel_interpolation_factor);
+      if (num_channels == 1) {
+        *destination++ =
+            CONVOLVE_FUNC(input_ptr, k1, k2, kernel_interpolation_factor);
+      } else {
+        // All channels are convolved with the same kernels, which stay in
+        // cache between the channels.
+        for (size_t ch = 0; ch < num_channels; ++ch) {
+          *destination++ =
+              CONVOLVE_FUNC(input_ptr + ch * input_buffer_size_, k1, k2,
+                            kernel_interpolation_factor);
+        }
+      }
 
       // Advance the virtual index.
       virtual_source_idx_ += current_io_ratio;
@@ -327,14 +376,17 @@ void SincResampler::Resample(size_t frames, float* destination) {
 
     // Step (3) -- Copy r3_, r4_ to r1_, r2_.
     // This wraps the last input frames back to the start of the buffer.
-    memcpy(r1_, r3_, sizeof(*input_buffer_.get()) * kKernelSize);
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      memcpy(r1_ + ch * input_buffer_size_, r3_ + ch * input_buffer_size_,
+             sizeof(*input_buffer_.get()) * kKernelSize);
+    }
 
     // Step (4) -- Reinitialize regions if necessary.
     if (r0_ == r2_)
       UpdateRegions(true);
 
     // Step (5) -- Refresh the buffer with more input.
-    read_cb_->Run(request_frames_, r0_);
+    ReadInput();
   }
 }
 
@@ -348,7 +400,7 @@ void SincResampler::Flush() {
   virtual_source_idx_ = 0;
   buffer_primed_ = false;
   memset(input_buffer_.get(), 0,
-         sizeof(*input_buffer_.get()) * input_buffer_size_);
+         sizeof(*input_buffer_.get()) * input_buffer_size_ * num_channels_);
   UpdateRegions(false);
 }
 
@@ -32,7 +32,9 @@ class SincResamplerCallback {
   virtual void Run(size_t frames, float* destination) = 0;
 };
 
-// SincResampler is a high-quality single-channel sample-rate converter.
+// SincResampler is a high-quality sample-rate converter. It converts a single
+// channel, or several interleaved channels which then share the kernels and
+// the sub-sample position.
 class SincResampler {
  public:
   // The kernel size can be adjusted for quality (higher is better) at the
@@ -60,9 +62,17 @@ class SincResampler {
   SincResampler(double io_sample_rate_ratio,
                 size_t request_frames,
                 SincResamplerCallback* read_cb);
+  // As above, but for |num_channels| channels of interleaved audio. |read_cb|
+  // is asked for |request_frames| interleaved frames at a time, i.e.
+  // |request_frames| * |num_channels| samples.
+  SincResampler(double io_sample_rate_ratio,
+                size_t request_frames,
+                size_t num_channels,
+                SincResamplerCallback* read_cb);
   virtual ~SincResampler();
 
-  // Resample |frames| of data from |read_cb_| into |destination|.
+  // Resample |frames| of data from |read_cb_| into |destination|. With more
+  // than one channel, |frames| interleaved frames are written.
   void Resample(size_t frames, float* destination);
 
   // The maximum size in frames that guarantees Resample() will only make a
@@ -70,6 +80,7 @@ class SincResampler {
   size_t ChunkSize() const;
 
   size_t request_frames() const { return request_frames_; }
+  size_t num_channels() const { return num_channels_; }
 
   // Flush all buffered data and reset internal indices.  Not thread safe, do
   // not call while Resample() is in progress.
@@ -88,10 +99,15 @@ class SincResampler {
  private:
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveBenchmark);
+  FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveAVX2);
 
   void InitializeKernel();
   void UpdateRegions(bool second_load);
 
+  // Reads |request_frames_| frames from |read_cb_| into the r0_ region of each
+  // channel.
+  void ReadInput();
+
   // Selects runtime specific CPU features like SSE.  Must be called before
   // using SincResampler.
   // TODO(ajm): Currently managed by the class internally. See the note with
@@ -110,6 +126,12 @@ class SincResampler {
                             const float* k1,
                             const float* k2,
                             double kernel_interpolation_factor);
+#if defined(WEBRTC_ENABLE_AVX2)
+  static float Convolve_AVX2(const float* input_ptr,
+                             const float* k1,
+                             const float* k2,
+                             double kernel_interpolation_factor);
+#endif
 #elif defined(WEBRTC_HAS_NEON)
   static float Convolve_NEON(const float* input_ptr,
                              const float* k1,
@@ -130,13 +152,16 @@ class SincResampler {
   // Source of data for resampling.
   SincResamplerCallback* read_cb_;
 
-  // The size (in samples) to request from each |read_cb_| execution.
+  // The size (in frames) to request from each |read_cb_| execution.
   const size_t request_frames_;
 
+  const size_t num_channels_;
+
   // The number of source frames processed per pass.
   size_t block_size_;
 
-  // The size (in samples) of the internal buffer used by the resampler.
+  // The size (in samples) of the internal buffer used by the resampler, per
+  // channel.
   const size_t input_buffer_size_;
 
   // Contains kKernelOffsetCount kernels back-to-back, each of size kKernelSize.
@@ -147,13 +172,19 @@ class SincResampler {
   std::unique_ptr<float[], AlignedFreeDeleter> kernel_window_storage_;
 
   // Data from the source is copied into this buffer for each processing pass.
+  // Channel |c| starts at |input_buffer_| + |c| * |input_buffer_size_|.
   std::unique_ptr<float[], AlignedFreeDeleter> input_buffer_;
 
+  // Receives the interleaved input from |read_cb_| when there is more than one
+  // channel.
+  std::unique_ptr<float[]> interleaved_input_;
+
 // Stores the runtime selection of which Convolve function to use.
 // TODO(ajm): Move to using a global static which must only be initialized
 // once by the user. We're not doing this initially, because we don't have
 // e.g. a LazyInstance helper in webrtc.
-#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(__SSE2__)
+#if defined(WEBRTC_ARCH_X86_FAMILY) && \
+    (!defined(__SSE2__) || defined(WEBRTC_ENABLE_AVX2))
   typedef float (*ConvolveProc)(const float*,
                                 const float*,
                                 const float*,
@@ -161,8 +192,8 @@ class SincResampler {
   ConvolveProc convolve_proc_;
 #endif
 
-  // Pointers to the various regions inside |input_buffer_|.  See the diagram at
-  // the top of the .cc file for more information.
+  // Pointers to the various regions inside |input_buffer_|, for the first
+  // channel.  See the diagram at the top of the .cc file for more information.
   float* r0_;
   float* const r1_;
   float* const r2_;
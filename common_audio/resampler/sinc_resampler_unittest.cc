@@ -163,6 +163,37 @@ TEST(SincResamplerTest, Convolve) {
 }
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(WEBRTC_ENABLE_AVX2)
+TEST(SincResamplerTest, ConvolveAVX2) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    printf("Skipping test, AVX2 is not supported.\n");
+    return;
+  }
+
+  MockSource mock_source;
+  SincResampler resampler(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                          &mock_source);
+  static const double kEpsilon = 0.00000005;
+
+  double result = resampler.Convolve_C(
+      resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
+      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+  double result2 = resampler.Convolve_AVX2(
+      resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
+      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+  EXPECT_NEAR(result2, result, kEpsilon);
+
+  // Test Convolve_AVX2() w/ unaligned input pointer.
+  result = resampler.Convolve_C(
+      resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+  result2 = resampler.Convolve_AVX2(
+      resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+  EXPECT_NEAR(result2, result, kEpsilon);
+}
+#endif
+
 // Benchmark for the various Convolve() methods.  Make sure to build with
 // branding=Chrome so that RTC_DCHECKs are compiled out when benchmarking.
 // Original benchmarks were run with --convolve-iterations=50000000.
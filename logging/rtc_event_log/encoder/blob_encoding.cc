@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/encoder/blob_encoding.h"
+
+#include <stdint.h>
+
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+
+std::string EncodeBlobs(const std::vector<std::string>& blobs) {
+  size_t size = 0;
+  for (const std::string& blob : blobs)
+    size += blob.size() + 10;  // A varint takes at most 10 bytes.
+  std::string output;
+  output.reserve(size);
+  for (const std::string& blob : blobs) {
+    uint64_t length = blob.size();
+    while (length >= 0x80) {
+      output.push_back(static_cast<char>(0x80 | (length & 0x7f)));
+      length >>= 7;
+    }
+    output.push_back(static_cast<char>(length));
+    output += blob;
+  }
+  return output;
+}
+
+std::vector<std::string> DecodeBlobs(const std::string& input,
+                                     size_t num_of_blobs) {
+  std::vector<std::string> blobs;
+  size_t position = 0;
+  for (size_t i = 0; i < num_of_blobs; ++i) {
+    uint64_t length = 0;
+    for (int shift = 0;; shift += 7) {
+      if (position == input.size() || shift > 63) {
+        RTC_LOG(LS_WARNING) << "Malformed blob length.";
+        return std::vector<std::string>();
+      }
+      const uint8_t byte = static_cast<uint8_t>(input[position++]);
+      length |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        break;
+    }
+    if (length > input.size() - position) {
+      RTC_LOG(LS_WARNING) << "Blob longer than its input.";
+      return std::vector<std::string>();
+    }
+    blobs.push_back(input.substr(position, length));
+    position += length;
+  }
+  if (position != input.size()) {
+    RTC_LOG(LS_WARNING) << "Unexpected data after the last blob.";
+    return std::vector<std::string>();
+  }
+  return blobs;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include "logging/rtc_event_log/encoder/blob_encoding.h"
+
+#include <string>
+#include <vector>
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+TEST(BlobEncodingTest, EmptyAndShortBlobs) {
+  const std::vector<std::string> blobs = {"", "a", "", "abc", ""};
+  const std::string encoded = EncodeBlobs(blobs);
+  // Short blobs take a single byte for their length.
+  EXPECT_EQ(encoded.size(), blobs.size() + 4);
+  EXPECT_EQ(DecodeBlobs(encoded, blobs.size()), blobs);
+}
+
+TEST(BlobEncodingTest, LongBlobs) {
+  const std::vector<std::string> blobs = {std::string(127, 'x'),
+                                          std::string(128, 'y'),
+                                          std::string(20000, 'z')};
+  const std::string encoded = EncodeBlobs(blobs);
+  EXPECT_EQ(encoded.size(), 127 + 1 + 128 + 2 + 20000 + 3u);
+  EXPECT_EQ(DecodeBlobs(encoded, blobs.size()), blobs);
+}
+
+TEST(BlobEncodingTest, BlobsWithNullCharacters) {
+  const std::vector<std::string> blobs = {std::string("\0\0\x80", 3),
+                                          std::string(1, '\0')};
+  EXPECT_EQ(DecodeBlobs(EncodeBlobs(blobs), blobs.size()), blobs);
+}
+
+TEST(BlobEncodingTest, WrongNumberOfBlobsFailsToDecode) {
+  const std::vector<std::string> blobs = {"abc", "defg", "h"};
+  const std::string encoded = EncodeBlobs(blobs);
+  EXPECT_TRUE(DecodeBlobs(encoded, blobs.size() - 1).empty());
+  EXPECT_TRUE(DecodeBlobs(encoded, blobs.size() + 1).empty());
+}
+
+TEST(BlobEncodingTest, TruncatedInputFailsToDecode) {
+  const std::vector<std::string> blobs = {"abc", std::string(300, 'd')};
+  const std::string encoded = EncodeBlobs(blobs);
+  for (size_t length = 0; length < encoded.size(); ++length)
+    EXPECT_TRUE(DecodeBlobs(encoded.substr(0, length), blobs.size()).empty());
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,198 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/encoder/delta_encoding.h"
+
+#include <algorithm>
+
+#include "rtc_base/bitbuffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+namespace {
+
+// The encoding starts with a header of these fields, followed by a bit per
+// value that tells whether it is present, if any is missing, and then the
+// deltas of the present values.
+constexpr size_t kEncodingTypeBits = 2;
+constexpr size_t kDeltaWidthBits = 6;     // Stored minus one.
+constexpr size_t kSignedDeltasBits = 1;
+constexpr size_t kValuesOptionalBits = 1;
+constexpr size_t kValueWidthBits = 6;     // Stored minus one.
+constexpr size_t kHeaderBits = kEncodingTypeBits + kDeltaWidthBits +
+                               kSignedDeltasBits + kValuesOptionalBits +
+                               kValueWidthBits;
+
+// The only encoding so far. The others are reserved for future ones, e.g.
+// run-length encoding of deltas.
+constexpr uint32_t kFixedSizeDeltas = 0;
+
+// Returns the number of bits up to and including the highest set one.
+size_t BitsNeeded(uint64_t value) {
+  size_t bits = 0;
+  while (bits < 64 && (value >> bits) != 0)
+    ++bits;
+  return bits;
+}
+
+uint64_t MaxValue(size_t bit_width) {
+  RTC_DCHECK_GE(bit_width, 1);
+  RTC_DCHECK_LE(bit_width, 64);
+  return bit_width == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_width) - 1;
+}
+
+// The bits needed to store |delta|, a |value_width| bit two's complement
+// number, as a shorter two's complement number.
+size_t SignedBitsNeeded(uint64_t delta, size_t value_width) {
+  const bool negative = (delta >> (value_width - 1)) & 1;
+  return BitsNeeded(negative ? ~delta & MaxValue(value_width) : delta) + 1;
+}
+
+bool ReadBits(rtc::BitBuffer* reader, size_t bit_count, uint64_t* value) {
+  RTC_DCHECK_LE(bit_count, 64);
+  uint32_t high = 0;
+  uint32_t low = 0;
+  if (bit_count > 32) {
+    if (!reader->ReadBits(&high, bit_count - 32) || !reader->ReadBits(&low, 32))
+      return false;
+  } else if (!reader->ReadBits(&low, bit_count)) {
+    return false;
+  }
+  *value = (static_cast<uint64_t>(high) << 32) | low;
+  return true;
+}
+
+}  // namespace
+
+std::string EncodeDeltas(absl::optional<uint64_t> base,
+                         const std::vector<absl::optional<uint64_t>>& values) {
+  if (std::all_of(values.begin(), values.end(),
+                  [&base](const absl::optional<uint64_t>& value) {
+                    return value == base;
+                  })) {
+    return std::string();
+  }
+
+  uint64_t max_value = base.value_or(0);
+  bool values_optional = false;
+  for (const absl::optional<uint64_t>& value : values) {
+    if (value)
+      max_value = std::max(max_value, *value);
+    else
+      values_optional = true;
+  }
+  const size_t value_width = std::max<size_t>(BitsNeeded(max_value), 1);
+  const uint64_t value_mask = MaxValue(value_width);
+
+  std::vector<uint64_t> deltas;
+  deltas.reserve(values.size());
+  size_t unsigned_width = 1;
+  size_t signed_width = 1;
+  uint64_t previous = base.value_or(0);
+  for (const absl::optional<uint64_t>& value : values) {
+    if (!value)
+      continue;
+    const uint64_t delta = (*value - previous) & value_mask;
+    unsigned_width = std::max(unsigned_width, BitsNeeded(delta));
+    signed_width =
+        std::max(signed_width, SignedBitsNeeded(delta, value_width));
+    deltas.push_back(delta);
+    previous = *value;
+  }
+  const bool signed_deltas = signed_width < unsigned_width;
+  const size_t delta_width = signed_deltas ? signed_width : unsigned_width;
+
+  const size_t bit_count = kHeaderBits +
+                           (values_optional ? values.size() : 0) +
+                           deltas.size() * delta_width;
+  std::vector<uint8_t> buffer((bit_count + 7) / 8);
+  rtc::BitBufferWriter writer(buffer.data(), buffer.size());
+  bool success = writer.WriteBits(kFixedSizeDeltas, kEncodingTypeBits) &&
+                 writer.WriteBits(delta_width - 1, kDeltaWidthBits) &&
+                 writer.WriteBits(signed_deltas, kSignedDeltasBits) &&
+                 writer.WriteBits(values_optional, kValuesOptionalBits) &&
+                 writer.WriteBits(value_width - 1, kValueWidthBits);
+  if (values_optional) {
+    for (const absl::optional<uint64_t>& value : values)
+      success &= writer.WriteBits(value.has_value(), 1);
+  }
+  const uint64_t delta_mask = MaxValue(delta_width);
+  for (uint64_t delta : deltas)
+    success &= writer.WriteBits(delta & delta_mask, delta_width);
+  RTC_DCHECK(success);
+
+  return std::string(buffer.begin(), buffer.end());
+}
+
+std::vector<absl::optional<uint64_t>> DecodeDeltas(
+    const std::string& input,
+    absl::optional<uint64_t> base,
+    size_t num_of_deltas) {
+  if (input.empty())
+    return std::vector<absl::optional<uint64_t>>(num_of_deltas, base);
+
+  rtc::BitBuffer reader(reinterpret_cast<const uint8_t*>(input.data()),
+                        input.size());
+  uint32_t encoding_type;
+  uint32_t delta_width;
+  uint32_t signed_deltas;
+  uint32_t values_optional;
+  uint32_t value_width;
+  if (!reader.ReadBits(&encoding_type, kEncodingTypeBits) ||
+      !reader.ReadBits(&delta_width, kDeltaWidthBits) ||
+      !reader.ReadBits(&signed_deltas, kSignedDeltasBits) ||
+      !reader.ReadBits(&values_optional, kValuesOptionalBits) ||
+      !reader.ReadBits(&value_width, kValueWidthBits)) {
+    RTC_LOG(LS_WARNING) << "Delta encoding too short.";
+    return std::vector<absl::optional<uint64_t>>();
+  }
+  if (encoding_type != kFixedSizeDeltas) {
+    RTC_LOG(LS_WARNING) << "Unknown delta encoding " << encoding_type << ".";
+    return std::vector<absl::optional<uint64_t>>();
+  }
+  ++delta_width;
+  ++value_width;
+  // Each value takes at least a bit, which bounds what we allocate.
+  if (num_of_deltas > reader.RemainingBitCount()) {
+    RTC_LOG(LS_WARNING) << "Delta encoding too short.";
+    return std::vector<absl::optional<uint64_t>>();
+  }
+
+  std::vector<absl::optional<uint64_t>> values(num_of_deltas);
+  std::vector<bool> present(num_of_deltas, true);
+  if (values_optional) {
+    for (size_t i = 0; i < num_of_deltas; ++i) {
+      uint32_t bit;
+      if (!reader.ReadBits(&bit, 1))
+        return std::vector<absl::optional<uint64_t>>();
+      present[i] = bit != 0;
+    }
+  }
+  const uint64_t value_mask = MaxValue(value_width);
+  const uint64_t sign_extension = value_mask & ~MaxValue(delta_width);
+  uint64_t previous = base.value_or(0);
+  for (size_t i = 0; i < num_of_deltas; ++i) {
+    if (!present[i])
+      continue;
+    uint64_t delta;
+    if (!ReadBits(&reader, delta_width, &delta)) {
+      RTC_LOG(LS_WARNING) << "Delta encoding too short.";
+      return std::vector<absl::optional<uint64_t>>();
+    }
+    if (signed_deltas && ((delta >> (delta_width - 1)) & 1))
+      delta |= sign_extension;
+    previous = (previous + delta) & value_mask;
+    values[i] = previous;
+  }
+  return values;
+}
+
+}  // namespace webrtc
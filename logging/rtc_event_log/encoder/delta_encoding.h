@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef LOGGING_RTC_EVENT_LOG_ENCODER_DELTA_ENCODING_H_
+#define LOGGING_RTC_EVENT_LOG_ENCODER_DELTA_ENCODING_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+
+namespace webrtc {
+
+// Encodes |values| as the difference of each to the one before it, the first
+// one to |base|, all in the least number of bits that fits every difference.
+// The values are unsigned integers of the least bit width that fits all of
+// them and |base|, so that differences wrap around as sequence numbers do, and
+// are encoded as negative numbers where that takes fewer bits.
+// Missing values only cost a bit each, and the next present value is encoded
+// as the difference to the last present one. If every value equals |base|,
+// the result is empty.
+std::string EncodeDeltas(absl::optional<uint64_t> base,
+                         const std::vector<absl::optional<uint64_t>>& values);
+
+// Reverses EncodeDeltas() given the same |base| and the number of values.
+// Returns an empty vector if |input| isn't a valid encoding of that many.
+std::vector<absl::optional<uint64_t>> DecodeDeltas(
+    const std::string& input,
+    absl::optional<uint64_t> base,
+    size_t num_of_deltas);
+
+}  // namespace webrtc
+
+#endif  // LOGGING_RTC_EVENT_LOG_ENCODER_DELTA_ENCODING_H_
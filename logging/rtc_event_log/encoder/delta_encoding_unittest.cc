@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+#include "logging/rtc_event_log/encoder/delta_encoding.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ValueVector = std::vector<absl::optional<uint64_t>>;
+
+void TestEncodingAndDecoding(absl::optional<uint64_t> base,
+                             const ValueVector& values) {
+  const std::string encoded = EncodeDeltas(base, values);
+  const ValueVector decoded = DecodeDeltas(encoded, base, values.size());
+  EXPECT_EQ(decoded, values);
+}
+
+TEST(DeltaEncodingTest, AllValuesEqualToBaseEncodeToEmptyString) {
+  const ValueVector values(10, uint64_t{1234});
+  EXPECT_TRUE(EncodeDeltas(1234, values).empty());
+  EXPECT_EQ(DecodeDeltas(std::string(), 1234, values.size()), values);
+}
+
+TEST(DeltaEncodingTest, AllValuesMissingAndNoBaseEncodeToEmptyString) {
+  const ValueVector values(10);
+  EXPECT_TRUE(EncodeDeltas(absl::nullopt, values).empty());
+  EXPECT_EQ(DecodeDeltas(std::string(), absl::nullopt, values.size()), values);
+}
+
+TEST(DeltaEncodingTest, IncreasingSequence) {
+  ValueVector values;
+  for (uint64_t i = 1; i <= 100; ++i)
+    values.push_back(1000 + 20 * i);
+  TestEncodingAndDecoding(1000, values);
+  // Equal deltas of 20 take 5 bits each, plus a header of two bytes.
+  EXPECT_EQ(EncodeDeltas(1000, values).size(), (16 + 100 * 5 + 7) / 8u);
+}
+
+TEST(DeltaEncodingTest, DecreasingSequenceUsesSignedDeltas) {
+  ValueVector values;
+  for (uint64_t i = 1; i <= 100; ++i)
+    values.push_back(100000 - 3 * i);
+  TestEncodingAndDecoding(100000, values);
+  // A delta of -3 takes 3 bits as a signed number.
+  EXPECT_EQ(EncodeDeltas(100000, values).size(), (16 + 100 * 3 + 7) / 8u);
+}
+
+TEST(DeltaEncodingTest, WrapAround) {
+  // Like 16-bit sequence numbers, the values wrap around at their bit width.
+  const ValueVector values = {65534, 65535, 0, 1, 2};
+  TestEncodingAndDecoding(65533, values);
+}
+
+TEST(DeltaEncodingTest, MaxWidthValues) {
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+  TestEncodingAndDecoding(0, {max, 0, max - 1, 1});
+  TestEncodingAndDecoding(max, {0, max, 1});
+}
+
+TEST(DeltaEncodingTest, MissingValues) {
+  TestEncodingAndDecoding(10, {absl::nullopt, 12, absl::nullopt, 9, 20});
+  TestEncodingAndDecoding(absl::nullopt, {absl::nullopt, 5, absl::nullopt});
+  TestEncodingAndDecoding(10, {absl::nullopt, absl::nullopt});
+}
+
+TEST(DeltaEncodingTest, RandomValues) {
+  Random prng(1234);
+  for (uint32_t bit_width : {1u, 7u, 16u, 32u, 33u, 63u, 64u}) {
+    const uint64_t mask = bit_width == 64
+                              ? std::numeric_limits<uint64_t>::max()
+                              : (uint64_t{1} << bit_width) - 1;
+    ValueVector values;
+    for (size_t i = 0; i < 50; ++i) {
+      if (prng.Rand(0, 9) == 0) {
+        values.push_back(absl::nullopt);
+      } else {
+        const uint64_t value =
+            (uint64_t{prng.Rand<uint32_t>()} << 32) | prng.Rand<uint32_t>();
+        values.push_back(value & mask);
+      }
+    }
+    TestEncodingAndDecoding(prng.Rand<uint32_t>() & mask, values);
+  }
+}
+
+TEST(DeltaEncodingTest, TruncatedInputFailsToDecode) {
+  ValueVector values;
+  for (uint64_t i = 0; i < 20; ++i)
+    values.push_back(i * i);
+  const std::string encoded = EncodeDeltas(0, values);
+  ASSERT_GT(encoded.size(), 1u);
+  EXPECT_TRUE(DecodeDeltas(encoded.substr(0, encoded.size() - 1), 0,
+                           values.size())
+                  .empty());
+  EXPECT_TRUE(DecodeDeltas(encoded.substr(0, 1), 0, values.size()).empty());
+}
+
+}  // namespace
+}  // namespace webrtc
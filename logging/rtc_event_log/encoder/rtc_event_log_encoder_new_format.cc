@@ -0,0 +1,1033 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
+
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "logging/rtc_event_log/encoder/blob_encoding.h"
+#include "logging/rtc_event_log/encoder/delta_encoding.h"
+#include "logging/rtc_event_log/events/rtc_event_alr_state.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_network_adaptation.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_receive_stream_config.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_send_stream_config.h"
+#include "logging/rtc_event_log/events/rtc_event_bwe_update_delay_based.h"
+#include "logging/rtc_event_log/events/rtc_event_bwe_update_loss_based.h"
+#include "logging/rtc_event_log/events/rtc_event_ice_candidate_pair.h"
+#include "logging/rtc_event_log/events/rtc_event_ice_candidate_pair_config.h"
+#include "logging/rtc_event_log/events/rtc_event_probe_cluster_created.h"
+#include "logging/rtc_event_log/events/rtc_event_probe_result_failure.h"
+#include "logging/rtc_event_log/events/rtc_event_probe_result_success.h"
+#include "logging/rtc_event_log/events/rtc_event_rtcp_packet_incoming.h"
+#include "logging/rtc_event_log/events/rtc_event_rtcp_packet_outgoing.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_incoming.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_outgoing.h"
+#include "logging/rtc_event_log/events/rtc_event_video_receive_stream_config.h"
+#include "logging/rtc_event_log/events/rtc_event_video_send_stream_config.h"
+#include "logging/rtc_event_log/rtc_stream_config.h"
+#include "modules/audio_coding/audio_network_adaptor/include/audio_network_adaptor_config.h"
+#include "modules/remote_bitrate_estimator/include/bwe_defines.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/app.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/bye.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/common_header.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/extended_jitter_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/extended_reports.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/psfb.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/rtpfb.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sdes.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/sender_report.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ignore_wundef.h"
+#include "rtc_base/logging.h"
+
+#ifdef ENABLE_RTC_EVENT_LOG
+
+// *.pb.h files are generated at build-time by the protobuf compiler.
+RTC_PUSH_IGNORING_WUNDEF()
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/logging/rtc_event_log/rtc_event_log2.pb.h"
+#else
+#include "logging/rtc_event_log/rtc_event_log2.pb.h"
+#endif
+RTC_POP_IGNORING_WUNDEF()
+
+namespace webrtc {
+
+namespace {
+rtclog2::DelayBasedBweUpdates::DetectorState ConvertDetectorState(
+    BandwidthUsage state) {
+  switch (state) {
+    case BandwidthUsage::kBwNormal:
+      return rtclog2::DelayBasedBweUpdates::BWE_NORMAL;
+    case BandwidthUsage::kBwUnderusing:
+      return rtclog2::DelayBasedBweUpdates::BWE_UNDERUSING;
+    case BandwidthUsage::kBwOverusing:
+      return rtclog2::DelayBasedBweUpdates::BWE_OVERUSING;
+    case BandwidthUsage::kLast:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::DelayBasedBweUpdates::BWE_NORMAL;
+}
+
+rtclog2::BweProbeResultFailure::FailureReason ConvertProbeResultType(
+    ProbeFailureReason failure_reason) {
+  switch (failure_reason) {
+    case ProbeFailureReason::kInvalidSendReceiveInterval:
+      return rtclog2::BweProbeResultFailure::INVALID_SEND_RECEIVE_INTERVAL;
+    case ProbeFailureReason::kInvalidSendReceiveRatio:
+      return rtclog2::BweProbeResultFailure::INVALID_SEND_RECEIVE_RATIO;
+    case ProbeFailureReason::kTimeout:
+      return rtclog2::BweProbeResultFailure::TIMEOUT;
+    case ProbeFailureReason::kLast:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::BweProbeResultFailure::UNKNOWN;
+}
+
+rtclog2::IceCandidatePairConfig::IceCandidatePairConfigType
+ConvertIceCandidatePairConfigType(IceCandidatePairConfigType type) {
+  switch (type) {
+    case IceCandidatePairConfigType::kAdded:
+      return rtclog2::IceCandidatePairConfig::ADDED;
+    case IceCandidatePairConfigType::kUpdated:
+      return rtclog2::IceCandidatePairConfig::UPDATED;
+    case IceCandidatePairConfigType::kDestroyed:
+      return rtclog2::IceCandidatePairConfig::DESTROYED;
+    case IceCandidatePairConfigType::kSelected:
+      return rtclog2::IceCandidatePairConfig::SELECTED;
+    case IceCandidatePairConfigType::kNumValues:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::IceCandidatePairConfig::UNKNOWN_CONFIG_TYPE;
+}
+
+rtclog2::IceCandidatePairConfig::IceCandidateType ConvertIceCandidateType(
+    IceCandidateType type) {
+  switch (type) {
+    case IceCandidateType::kUnknown:
+      return rtclog2::IceCandidatePairConfig::UNKNOWN_CANDIDATE_TYPE;
+    case IceCandidateType::kLocal:
+      return rtclog2::IceCandidatePairConfig::LOCAL;
+    case IceCandidateType::kStun:
+      return rtclog2::IceCandidatePairConfig::STUN;
+    case IceCandidateType::kPrflx:
+      return rtclog2::IceCandidatePairConfig::PRFLX;
+    case IceCandidateType::kRelay:
+      return rtclog2::IceCandidatePairConfig::RELAY;
+    case IceCandidateType::kNumValues:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::IceCandidatePairConfig::UNKNOWN_CANDIDATE_TYPE;
+}
+
+rtclog2::IceCandidatePairConfig::Protocol ConvertIceCandidatePairProtocol(
+    IceCandidatePairProtocol protocol) {
+  switch (protocol) {
+    case IceCandidatePairProtocol::kUnknown:
+      return rtclog2::IceCandidatePairConfig::UNKNOWN_PROTOCOL;
+    case IceCandidatePairProtocol::kUdp:
+      return rtclog2::IceCandidatePairConfig::UDP;
+    case IceCandidatePairProtocol::kTcp:
+      return rtclog2::IceCandidatePairConfig::TCP;
+    case IceCandidatePairProtocol::kSsltcp:
+      return rtclog2::IceCandidatePairConfig::SSLTCP;
+    case IceCandidatePairProtocol::kTls:
+      return rtclog2::IceCandidatePairConfig::TLS;
+    case IceCandidatePairProtocol::kNumValues:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::IceCandidatePairConfig::UNKNOWN_PROTOCOL;
+}
+
+rtclog2::IceCandidatePairConfig::AddressFamily
+ConvertIceCandidatePairAddressFamily(
+    IceCandidatePairAddressFamily address_family) {
+  switch (address_family) {
+    case IceCandidatePairAddressFamily::kUnknown:
+      return rtclog2::IceCandidatePairConfig::UNKNOWN_ADDRESS_FAMILY;
+    case IceCandidatePairAddressFamily::kIpv4:
+      return rtclog2::IceCandidatePairConfig::IPV4;
+    case IceCandidatePairAddressFamily::kIpv6:
+      return rtclog2::IceCandidatePairConfig::IPV6;
+    case IceCandidatePairAddressFamily::kNumValues:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::IceCandidatePairConfig::UNKNOWN_ADDRESS_FAMILY;
+}
+
+rtclog2::IceCandidatePairConfig::NetworkType ConvertIceCandidateNetworkType(
+    IceCandidateNetworkType network_type) {
+  switch (network_type) {
+    case IceCandidateNetworkType::kUnknown:
+      return rtclog2::IceCandidatePairConfig::UNKNOWN_NETWORK_TYPE;
+    case IceCandidateNetworkType::kEthernet:
+      return rtclog2::IceCandidatePairConfig::ETHERNET;
+    case IceCandidateNetworkType::kLoopback:
+      return rtclog2::IceCandidatePairConfig::LOOPBACK;
+    case IceCandidateNetworkType::kWifi:
+      return rtclog2::IceCandidatePairConfig::WIFI;
+    case IceCandidateNetworkType::kVpn:
+      return rtclog2::IceCandidatePairConfig::VPN;
+    case IceCandidateNetworkType::kCellular:
+      return rtclog2::IceCandidatePairConfig::CELLULAR;
+    case IceCandidateNetworkType::kNumValues:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::IceCandidatePairConfig::UNKNOWN_NETWORK_TYPE;
+}
+
+rtclog2::IceCandidatePairEvent::IceCandidatePairEventType
+ConvertIceCandidatePairEventType(IceCandidatePairEventType type) {
+  switch (type) {
+    case IceCandidatePairEventType::kCheckSent:
+      return rtclog2::IceCandidatePairEvent::CHECK_SENT;
+    case IceCandidatePairEventType::kCheckReceived:
+      return rtclog2::IceCandidatePairEvent::CHECK_RECEIVED;
+    case IceCandidatePairEventType::kCheckResponseSent:
+      return rtclog2::IceCandidatePairEvent::CHECK_RESPONSE_SENT;
+    case IceCandidatePairEventType::kCheckResponseReceived:
+      return rtclog2::IceCandidatePairEvent::CHECK_RESPONSE_RECEIVED;
+    case IceCandidatePairEventType::kNumValues:
+      RTC_NOTREACHED();
+  }
+  RTC_NOTREACHED();
+  return rtclog2::IceCandidatePairEvent::UNKNOWN_CHECK_TYPE;
+}
+
+// The format stores times in milliseconds.
+uint64_t TimestampMs(const RtcEvent* event) {
+  return event->timestamp_us_ / 1000;
+}
+
+// Delta encodes the value |getter| returns for each element of |batch| but
+// the first, starting from the value of the first.
+template <typename Batch, typename Getter>
+std::string EncodeFieldDeltas(const Batch& batch, Getter getter) {
+  RTC_DCHECK(!batch.empty());
+  std::vector<absl::optional<uint64_t>> values;
+  values.reserve(batch.size() - 1);
+  for (size_t i = 1; i < batch.size(); ++i)
+    values.push_back(getter(batch[i]));
+  return EncodeDeltas(getter(batch[0]), values);
+}
+
+// Unlike numbers, byte strings are written as they are, and only if some
+// differs from the first.
+template <typename Batch, typename Getter>
+std::string EncodeFieldBlobs(const Batch& batch, Getter getter) {
+  RTC_DCHECK(!batch.empty());
+  bool all_equal = true;
+  std::vector<std::string> blobs;
+  blobs.reserve(batch.size() - 1);
+  for (size_t i = 1; i < batch.size(); ++i) {
+    blobs.push_back(getter(batch[i]));
+    all_equal &= blobs.back() == getter(batch[0]);
+  }
+  return all_equal ? std::string() : EncodeBlobs(blobs);
+}
+
+// Keeps only the RTCP blocks that the legacy encoder logs, which for instance
+// leaves out the CNAME of SDES packets.
+std::string FilterRtcpPacket(const rtc::Buffer& packet) {
+  std::string filtered;
+  filtered.reserve(packet.size());
+  rtcp::CommonHeader header;
+  const uint8_t* block_begin = packet.data();
+  const uint8_t* packet_end = packet.data() + packet.size();
+  while (block_begin < packet_end) {
+    if (!header.Parse(block_begin, packet_end - block_begin)) {
+      break;  // Incorrect message header.
+    }
+    const uint8_t* next_block = header.NextPacket();
+    switch (header.type()) {
+      case rtcp::Bye::kPacketType:
+      case rtcp::ExtendedJitterReport::kPacketType:
+      case rtcp::ExtendedReports::kPacketType:
+      case rtcp::Psfb::kPacketType:
+      case rtcp::ReceiverReport::kPacketType:
+      case rtcp::Rtpfb::kPacketType:
+      case rtcp::SenderReport::kPacketType:
+        filtered.append(reinterpret_cast<const char*>(block_begin),
+                        next_block - block_begin);
+        break;
+      case rtcp::App::kPacketType:
+      case rtcp::Sdes::kPacketType:
+      default:
+        break;
+    }
+    block_begin = next_block;
+  }
+  return filtered;
+}
+
+// The logged fields of an RTP packet, read from its header once rather than
+// once per column.
+struct RtpPacketFields {
+  RtpPacketFields(int64_t timestamp_us,
+                  const RtpPacket& header,
+                  size_t packet_length)
+      : timestamp_ms(timestamp_us / 1000),
+        marker(header.Marker()),
+        payload_type(header.PayloadType()),
+        sequence_number(header.SequenceNumber()),
+        rtp_timestamp(header.Timestamp()),
+        ssrc(header.Ssrc()),
+        packet_size(packet_length),
+        header_size(header.headers_size()) {
+    const std::vector<uint32_t> csrc_list = header.Csrcs();
+    csrcs.resize(4 * csrc_list.size());
+    for (size_t i = 0; i < csrc_list.size(); ++i) {
+      ByteWriter<uint32_t>::WriteBigEndian(
+          reinterpret_cast<uint8_t*>(&csrcs[4 * i]), csrc_list[i]);
+    }
+    // Only the header is logged, so as the legacy format we assume that a
+    // packet with the padding bit set holds nothing but padding.
+    if ((header.data()[0] & 0x20) != 0)
+      padding_size = packet_length - header.headers_size();
+
+    int32_t offset;
+    if (header.GetExtension<TransmissionOffset>(&offset))
+      transmission_time_offset = static_cast<uint32_t>(offset);
+    uint32_t send_time;
+    if (header.GetExtension<AbsoluteSendTime>(&send_time))
+      absolute_send_time = send_time;
+    uint16_t transport_seq_no;
+    if (header.GetExtension<TransportSequenceNumber>(&transport_seq_no))
+      transport_sequence_number = transport_seq_no;
+    bool voice;
+    uint8_t level;
+    if (header.GetExtension<AudioLevel>(&voice, &level)) {
+      voice_activity = voice;
+      audio_level = level;
+    }
+    uint8_t cvo_byte;
+    if (header.GetExtension<VideoOrientation>(&cvo_byte))
+      video_rotation = cvo_byte;
+  }
+
+  uint64_t timestamp_ms;
+  bool marker;
+  uint8_t payload_type;
+  uint16_t sequence_number;
+  uint32_t rtp_timestamp;
+  uint32_t ssrc;
+  std::string csrcs;
+  size_t packet_size;
+  size_t header_size;
+  size_t padding_size = 0;
+  absl::optional<uint64_t> transmission_time_offset;
+  absl::optional<uint64_t> absolute_send_time;
+  absl::optional<uint64_t> transport_sequence_number;
+  absl::optional<uint64_t> audio_level;
+  absl::optional<uint64_t> voice_activity;
+  absl::optional<uint64_t> video_rotation;
+};
+
+// Encodes the fields that incoming and outgoing packets have in common.
+template <typename ProtoType>
+void EncodeRtpPacketFields(const std::vector<RtpPacketFields>& batch,
+                           ProtoType* proto_batch) {
+  const RtpPacketFields& base = batch[0];
+  proto_batch->set_timestamp_ms(base.timestamp_ms);
+  proto_batch->set_marker(base.marker);
+  proto_batch->set_payload_type(base.payload_type);
+  proto_batch->set_sequence_number(base.sequence_number);
+  proto_batch->set_rtp_timestamp(base.rtp_timestamp);
+  proto_batch->set_ssrc(base.ssrc);
+  if (!base.csrcs.empty())
+    proto_batch->set_csrcs(base.csrcs);
+  proto_batch->set_packet_size(base.packet_size);
+  proto_batch->set_header_size(base.header_size);
+  proto_batch->set_padding_size(base.padding_size);
+  if (base.transmission_time_offset) {
+    proto_batch->set_transmission_time_offset(
+        static_cast<int32_t>(*base.transmission_time_offset));
+  }
+  if (base.absolute_send_time)
+    proto_batch->set_absolute_send_time(*base.absolute_send_time);
+  if (base.transport_sequence_number)
+    proto_batch->set_transport_sequence_number(*base.transport_sequence_number);
+  if (base.audio_level) {
+    proto_batch->set_audio_level(*base.audio_level);
+    proto_batch->set_voice_activity(*base.voice_activity != 0);
+  }
+  if (base.video_rotation)
+    proto_batch->set_video_rotation(*base.video_rotation);
+
+  proto_batch->set_number_of_deltas(batch.size() - 1);
+  if (batch.size() == 1)
+    return;
+
+  std::string deltas;
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return p.timestamp_ms; });
+  if (!deltas.empty())
+    proto_batch->set_timestamp_deltas_ms(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return uint64_t{p.marker}; });
+  if (!deltas.empty())
+    proto_batch->set_marker_deltas(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return uint64_t{p.payload_type}; });
+  if (!deltas.empty())
+    proto_batch->set_payload_type_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](const RtpPacketFields& p) {
+    return uint64_t{p.sequence_number};
+  });
+  if (!deltas.empty())
+    proto_batch->set_sequence_number_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](const RtpPacketFields& p) {
+    return uint64_t{p.rtp_timestamp};
+  });
+  if (!deltas.empty())
+    proto_batch->set_rtp_timestamp_deltas(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return uint64_t{p.ssrc}; });
+  if (!deltas.empty())
+    proto_batch->set_ssrc_deltas(deltas);
+  deltas = EncodeFieldBlobs(
+      batch, [](const RtpPacketFields& p) { return p.csrcs; });
+  if (!deltas.empty())
+    proto_batch->set_csrcs_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](const RtpPacketFields& p) {
+    return uint64_t{p.packet_size};
+  });
+  if (!deltas.empty())
+    proto_batch->set_packet_size_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](const RtpPacketFields& p) {
+    return uint64_t{p.header_size};
+  });
+  if (!deltas.empty())
+    proto_batch->set_header_size_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](const RtpPacketFields& p) {
+    return uint64_t{p.padding_size};
+  });
+  if (!deltas.empty())
+    proto_batch->set_padding_size_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](const RtpPacketFields& p) {
+    return p.transmission_time_offset;
+  });
+  if (!deltas.empty())
+    proto_batch->set_transmission_time_offset_deltas(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return p.absolute_send_time; });
+  if (!deltas.empty())
+    proto_batch->set_absolute_send_time_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](const RtpPacketFields& p) {
+    return p.transport_sequence_number;
+  });
+  if (!deltas.empty())
+    proto_batch->set_transport_sequence_number_deltas(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return p.audio_level; });
+  if (!deltas.empty())
+    proto_batch->set_audio_level_deltas(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return p.voice_activity; });
+  if (!deltas.empty())
+    proto_batch->set_voice_activity_deltas(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtpPacketFields& p) { return p.video_rotation; });
+  if (!deltas.empty())
+    proto_batch->set_video_rotation_deltas(deltas);
+}
+
+template <typename EventType, typename ProtoType>
+void EncodeRtcpPacket(rtc::ArrayView<const EventType*> batch,
+                      ProtoType* proto_batch) {
+  std::vector<std::string> packets;
+  packets.reserve(batch.size());
+  for (const EventType* event : batch)
+    packets.push_back(FilterRtcpPacket(event->packet_));
+
+  proto_batch->set_timestamp_ms(TimestampMs(batch[0]));
+  proto_batch->set_raw_packet(packets[0]);
+  proto_batch->set_number_of_deltas(batch.size() - 1);
+  if (batch.size() == 1)
+    return;
+
+  std::string deltas = EncodeFieldDeltas(batch, TimestampMs);
+  if (!deltas.empty())
+    proto_batch->set_timestamp_deltas_ms(deltas);
+  packets.erase(packets.begin());
+  proto_batch->set_raw_packet_deltas(EncodeBlobs(packets));
+}
+
+template <typename ProtoType>
+void EncodeHeaderExtensions(const std::vector<RtpExtension>& extensions,
+                            ProtoType* proto_config) {
+  rtclog2::RtpHeaderExtensionConfig proto_extensions;
+  for (const RtpExtension& extension : extensions) {
+    if (extension.uri == RtpExtension::kTimestampOffsetUri) {
+      proto_extensions.set_transmission_time_offset_id(extension.id);
+    } else if (extension.uri == RtpExtension::kAbsSendTimeUri) {
+      proto_extensions.set_absolute_send_time_id(extension.id);
+    } else if (extension.uri == RtpExtension::kTransportSequenceNumberUri) {
+      proto_extensions.set_transport_sequence_number_id(extension.id);
+    } else if (extension.uri == RtpExtension::kAudioLevelUri) {
+      proto_extensions.set_audio_level_id(extension.id);
+    } else if (extension.uri == RtpExtension::kVideoRotationUri) {
+      proto_extensions.set_video_rotation_id(extension.id);
+    }
+  }
+  if (proto_extensions.ByteSizeLong() > 0)
+    proto_config->mutable_header_extensions()->Swap(&proto_extensions);
+}
+
+}  // namespace
+
+std::string RtcEventLogEncoderNewFormat::EncodeLogStart(int64_t timestamp_us) {
+  rtclog2::EventStream event_stream;
+  event_stream.set_version(2);
+  event_stream.add_begin_log_events()->set_timestamp_ms(timestamp_us / 1000);
+  return event_stream.SerializeAsString();
+}
+
+std::string RtcEventLogEncoderNewFormat::EncodeLogEnd(int64_t timestamp_us) {
+  rtclog2::EventStream event_stream;
+  event_stream.add_end_log_events()->set_timestamp_ms(timestamp_us / 1000);
+  return event_stream.SerializeAsString();
+}
+
+std::string RtcEventLogEncoderNewFormat::EncodeBatch(
+    std::deque<std::unique_ptr<RtcEvent>>::const_iterator begin,
+    std::deque<std::unique_ptr<RtcEvent>>::const_iterator end) {
+  rtclog2::EventStream event_stream;
+
+  std::vector<const RtcEventAlrState*> alr_state_events;
+  std::vector<const RtcEventAudioNetworkAdaptation*>
+      audio_network_adaptation_events;
+  std::map<uint32_t, std::vector<const RtcEventAudioPlayout*>>
+      audio_playout_events;
+  std::vector<const RtcEventBweUpdateDelayBased*> bwe_delay_based_updates;
+  std::vector<const RtcEventBweUpdateLossBased*> bwe_loss_based_updates;
+  std::vector<const RtcEventIceCandidatePair*> ice_candidate_events;
+  std::vector<const RtcEventRtcpPacketIncoming*> incoming_rtcp_packets;
+  std::vector<const RtcEventRtcpPacketOutgoing*> outgoing_rtcp_packets;
+  std::map<uint32_t, std::vector<const RtcEventRtpPacketIncoming*>>
+      incoming_rtp_packets;
+  std::map<uint32_t, std::vector<const RtcEventRtpPacketOutgoing*>>
+      outgoing_rtp_packets;
+
+  for (auto it = begin; it != end; ++it) {
+    RTC_CHECK(it->get() != nullptr);
+    const RtcEvent& event = **it;
+    switch (event.GetType()) {
+      case RtcEvent::Type::AlrStateEvent: {
+        alr_state_events.push_back(
+            static_cast<const RtcEventAlrState*>(&event));
+        break;
+      }
+      case RtcEvent::Type::AudioNetworkAdaptation: {
+        audio_network_adaptation_events.push_back(
+            static_cast<const RtcEventAudioNetworkAdaptation*>(&event));
+        break;
+      }
+      case RtcEvent::Type::AudioPlayout: {
+        auto* rtc_event = static_cast<const RtcEventAudioPlayout*>(&event);
+        audio_playout_events[rtc_event->ssrc_].push_back(rtc_event);
+        break;
+      }
+      case RtcEvent::Type::AudioReceiveStreamConfig: {
+        EncodeAudioReceiveStreamConfig(
+            static_cast<const RtcEventAudioReceiveStreamConfig&>(event),
+            &event_stream);
+        break;
+      }
+      case RtcEvent::Type::AudioSendStreamConfig: {
+        EncodeAudioSendStreamConfig(
+            static_cast<const RtcEventAudioSendStreamConfig&>(event),
+            &event_stream);
+        break;
+      }
+      case RtcEvent::Type::BweUpdateDelayBased: {
+        bwe_delay_based_updates.push_back(
+            static_cast<const RtcEventBweUpdateDelayBased*>(&event));
+        break;
+      }
+      case RtcEvent::Type::BweUpdateLossBased: {
+        bwe_loss_based_updates.push_back(
+            static_cast<const RtcEventBweUpdateLossBased*>(&event));
+        break;
+      }
+      case RtcEvent::Type::IceCandidatePairConfig: {
+        EncodeIceCandidatePairConfig(
+            static_cast<const RtcEventIceCandidatePairConfig&>(event),
+            &event_stream);
+        break;
+      }
+      case RtcEvent::Type::IceCandidatePairEvent: {
+        ice_candidate_events.push_back(
+            static_cast<const RtcEventIceCandidatePair*>(&event));
+        break;
+      }
+      case RtcEvent::Type::ProbeClusterCreated: {
+        EncodeProbeClusterCreated(
+            static_cast<const RtcEventProbeClusterCreated&>(event),
+            &event_stream);
+        break;
+      }
+      case RtcEvent::Type::ProbeResultFailure: {
+        EncodeProbeResultFailure(
+            static_cast<const RtcEventProbeResultFailure&>(event),
+            &event_stream);
+        break;
+      }
+      case RtcEvent::Type::ProbeResultSuccess: {
+        EncodeProbeResultSuccess(
+            static_cast<const RtcEventProbeResultSuccess&>(event),
+            &event_stream);
+        break;
+      }
+      case RtcEvent::Type::RtcpPacketIncoming: {
+        incoming_rtcp_packets.push_back(
+            static_cast<const RtcEventRtcpPacketIncoming*>(&event));
+        break;
+      }
+      case RtcEvent::Type::RtcpPacketOutgoing: {
+        outgoing_rtcp_packets.push_back(
+            static_cast<const RtcEventRtcpPacketOutgoing*>(&event));
+        break;
+      }
+      case RtcEvent::Type::RtpPacketIncoming: {
+        auto* rtc_event = static_cast<const RtcEventRtpPacketIncoming*>(&event);
+        incoming_rtp_packets[rtc_event->header_.Ssrc()].push_back(rtc_event);
+        break;
+      }
+      case RtcEvent::Type::RtpPacketOutgoing: {
+        auto* rtc_event = static_cast<const RtcEventRtpPacketOutgoing*>(&event);
+        outgoing_rtp_packets[rtc_event->header_.Ssrc()].push_back(rtc_event);
+        break;
+      }
+      case RtcEvent::Type::VideoReceiveStreamConfig: {
+        EncodeVideoReceiveStreamConfig(
+            static_cast<const RtcEventVideoReceiveStreamConfig&>(event),
+            &event_stream);
+        break;
+      }
+      case RtcEvent::Type::VideoSendStreamConfig: {
+        EncodeVideoSendStreamConfig(
+            static_cast<const RtcEventVideoSendStreamConfig&>(event),
+            &event_stream);
+        break;
+      }
+    }
+  }
+
+  if (!alr_state_events.empty())
+    EncodeAlrState(alr_state_events, &event_stream);
+  if (!audio_network_adaptation_events.empty())
+    EncodeAudioNetworkAdaptation(audio_network_adaptation_events,
+                                 &event_stream);
+  for (auto& kv : audio_playout_events)
+    EncodeAudioPlayout(kv.second, &event_stream);
+  if (!bwe_delay_based_updates.empty())
+    EncodeBweUpdateDelayBased(bwe_delay_based_updates, &event_stream);
+  if (!bwe_loss_based_updates.empty())
+    EncodeBweUpdateLossBased(bwe_loss_based_updates, &event_stream);
+  if (!ice_candidate_events.empty())
+    EncodeIceCandidatePairEvent(ice_candidate_events, &event_stream);
+  if (!incoming_rtcp_packets.empty())
+    EncodeRtcpPacketIncoming(incoming_rtcp_packets, &event_stream);
+  if (!outgoing_rtcp_packets.empty())
+    EncodeRtcpPacketOutgoing(outgoing_rtcp_packets, &event_stream);
+  for (auto& kv : incoming_rtp_packets)
+    EncodeRtpPacketIncoming(kv.second, &event_stream);
+  for (auto& kv : outgoing_rtp_packets)
+    EncodeRtpPacketOutgoing(kv.second, &event_stream);
+
+  return event_stream.SerializeAsString();
+}
+
+void RtcEventLogEncoderNewFormat::EncodeAlrState(
+    rtc::ArrayView<const RtcEventAlrState*> batch,
+    rtclog2::EventStream* event_stream) {
+  for (const RtcEventAlrState* event : batch) {
+    rtclog2::AlrState* proto_event = event_stream->add_alr_states();
+    proto_event->set_timestamp_ms(TimestampMs(event));
+    proto_event->set_in_alr(event->in_alr_);
+  }
+}
+
+void RtcEventLogEncoderNewFormat::EncodeAudioNetworkAdaptation(
+    rtc::ArrayView<const RtcEventAudioNetworkAdaptation*> batch,
+    rtclog2::EventStream* event_stream) {
+  using Event = const RtcEventAudioNetworkAdaptation*;
+  rtclog2::AudioNetworkAdaptations* proto_batch =
+      event_stream->add_audio_network_adaptations();
+  const AudioEncoderRuntimeConfig& base = *batch[0]->config_;
+  proto_batch->set_timestamp_ms(TimestampMs(batch[0]));
+  if (base.bitrate_bps)
+    proto_batch->set_bitrate_bps(*base.bitrate_bps);
+  if (base.frame_length_ms)
+    proto_batch->set_frame_length_ms(*base.frame_length_ms);
+  if (base.uplink_packet_loss_fraction) {
+    proto_batch->set_uplink_packet_loss_fraction(
+        *base.uplink_packet_loss_fraction);
+  }
+  if (base.enable_fec)
+    proto_batch->set_enable_fec(*base.enable_fec);
+  if (base.enable_dtx)
+    proto_batch->set_enable_dtx(*base.enable_dtx);
+  if (base.num_channels)
+    proto_batch->set_num_channels(*base.num_channels);
+
+  proto_batch->set_number_of_deltas(batch.size() - 1);
+  if (batch.size() == 1)
+    return;
+
+  std::string deltas;
+  deltas = EncodeFieldDeltas(batch, TimestampMs);
+  if (!deltas.empty())
+    proto_batch->set_timestamp_deltas_ms(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) -> absl::optional<uint64_t> {
+    if (!e->config_->bitrate_bps)
+      return absl::nullopt;
+    return static_cast<uint32_t>(*e->config_->bitrate_bps);
+  });
+  if (!deltas.empty())
+    proto_batch->set_bitrate_deltas_bps(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) -> absl::optional<uint64_t> {
+    if (!e->config_->frame_length_ms)
+      return absl::nullopt;
+    return static_cast<uint32_t>(*e->config_->frame_length_ms);
+  });
+  if (!deltas.empty())
+    proto_batch->set_frame_length_deltas_ms(deltas);
+  // The bit pattern of the float; the deltas are only as small as the
+  // changes, but repeated values cost nothing.
+  deltas = EncodeFieldDeltas(batch, [](Event e) -> absl::optional<uint64_t> {
+    if (!e->config_->uplink_packet_loss_fraction)
+      return absl::nullopt;
+    uint32_t bits;
+    static_assert(sizeof(bits) == sizeof(float), "");
+    memcpy(&bits, &*e->config_->uplink_packet_loss_fraction, sizeof(bits));
+    return bits;
+  });
+  if (!deltas.empty())
+    proto_batch->set_uplink_packet_loss_fraction_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) -> absl::optional<uint64_t> {
+    if (!e->config_->enable_fec)
+      return absl::nullopt;
+    return uint64_t{*e->config_->enable_fec};
+  });
+  if (!deltas.empty())
+    proto_batch->set_enable_fec_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) -> absl::optional<uint64_t> {
+    if (!e->config_->enable_dtx)
+      return absl::nullopt;
+    return uint64_t{*e->config_->enable_dtx};
+  });
+  if (!deltas.empty())
+    proto_batch->set_enable_dtx_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) -> absl::optional<uint64_t> {
+    if (!e->config_->num_channels)
+      return absl::nullopt;
+    return uint64_t{*e->config_->num_channels};
+  });
+  if (!deltas.empty())
+    proto_batch->set_num_channels_deltas(deltas);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeAudioPlayout(
+    rtc::ArrayView<const RtcEventAudioPlayout*> batch,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::AudioPlayoutEvents* proto_batch =
+      event_stream->add_audio_playout_events();
+  proto_batch->set_timestamp_ms(TimestampMs(batch[0]));
+  proto_batch->set_local_ssrc(batch[0]->ssrc_);
+  proto_batch->set_number_of_deltas(batch.size() - 1);
+  if (batch.size() == 1)
+    return;
+
+  std::string deltas;
+  deltas = EncodeFieldDeltas(batch, TimestampMs);
+  if (!deltas.empty())
+    proto_batch->set_timestamp_deltas_ms(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](const RtcEventAudioPlayout* e) { return uint64_t{e->ssrc_}; });
+  if (!deltas.empty())
+    proto_batch->set_local_ssrc_deltas(deltas);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeBweUpdateDelayBased(
+    rtc::ArrayView<const RtcEventBweUpdateDelayBased*> batch,
+    rtclog2::EventStream* event_stream) {
+  using Event = const RtcEventBweUpdateDelayBased*;
+  rtclog2::DelayBasedBweUpdates* proto_batch =
+      event_stream->add_delay_based_bwe_updates();
+  proto_batch->set_timestamp_ms(TimestampMs(batch[0]));
+  proto_batch->set_bitrate_bps(batch[0]->bitrate_bps_);
+  proto_batch->set_detector_state(
+      ConvertDetectorState(batch[0]->detector_state_));
+  proto_batch->set_number_of_deltas(batch.size() - 1);
+  if (batch.size() == 1)
+    return;
+
+  std::string deltas;
+  deltas = EncodeFieldDeltas(batch, TimestampMs);
+  if (!deltas.empty())
+    proto_batch->set_timestamp_deltas_ms(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) {
+    return uint64_t{static_cast<uint32_t>(e->bitrate_bps_)};
+  });
+  if (!deltas.empty())
+    proto_batch->set_bitrate_deltas_bps(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) {
+    return static_cast<uint64_t>(ConvertDetectorState(e->detector_state_));
+  });
+  if (!deltas.empty())
+    proto_batch->set_detector_state_deltas(deltas);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeBweUpdateLossBased(
+    rtc::ArrayView<const RtcEventBweUpdateLossBased*> batch,
+    rtclog2::EventStream* event_stream) {
+  using Event = const RtcEventBweUpdateLossBased*;
+  rtclog2::LossBasedBweUpdates* proto_batch =
+      event_stream->add_loss_based_bwe_updates();
+  proto_batch->set_timestamp_ms(TimestampMs(batch[0]));
+  proto_batch->set_bitrate_bps(batch[0]->bitrate_bps_);
+  proto_batch->set_fraction_loss(batch[0]->fraction_loss_);
+  proto_batch->set_total_packets(batch[0]->total_packets_);
+  proto_batch->set_number_of_deltas(batch.size() - 1);
+  if (batch.size() == 1)
+    return;
+
+  std::string deltas;
+  deltas = EncodeFieldDeltas(batch, TimestampMs);
+  if (!deltas.empty())
+    proto_batch->set_timestamp_deltas_ms(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) {
+    return uint64_t{static_cast<uint32_t>(e->bitrate_bps_)};
+  });
+  if (!deltas.empty())
+    proto_batch->set_bitrate_deltas_bps(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](Event e) { return uint64_t{e->fraction_loss_}; });
+  if (!deltas.empty())
+    proto_batch->set_fraction_loss_deltas(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) {
+    return uint64_t{static_cast<uint32_t>(e->total_packets_)};
+  });
+  if (!deltas.empty())
+    proto_batch->set_total_packets_deltas(deltas);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeIceCandidatePairEvent(
+    rtc::ArrayView<const RtcEventIceCandidatePair*> batch,
+    rtclog2::EventStream* event_stream) {
+  using Event = const RtcEventIceCandidatePair*;
+  rtclog2::IceCandidatePairEvent* proto_batch =
+      event_stream->add_ice_candidate_events();
+  proto_batch->set_timestamp_ms(TimestampMs(batch[0]));
+  proto_batch->set_event_type(ConvertIceCandidatePairEventType(batch[0]->type_));
+  proto_batch->set_candidate_pair_id(batch[0]->candidate_pair_id_);
+  proto_batch->set_number_of_deltas(batch.size() - 1);
+  if (batch.size() == 1)
+    return;
+
+  std::string deltas;
+  deltas = EncodeFieldDeltas(batch, TimestampMs);
+  if (!deltas.empty())
+    proto_batch->set_timestamp_deltas_ms(deltas);
+  deltas = EncodeFieldDeltas(batch, [](Event e) {
+    return static_cast<uint64_t>(ConvertIceCandidatePairEventType(e->type_));
+  });
+  if (!deltas.empty())
+    proto_batch->set_event_type_deltas(deltas);
+  deltas = EncodeFieldDeltas(
+      batch, [](Event e) { return uint64_t{e->candidate_pair_id_}; });
+  if (!deltas.empty())
+    proto_batch->set_candidate_pair_id_deltas(deltas);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeRtcpPacketIncoming(
+    rtc::ArrayView<const RtcEventRtcpPacketIncoming*> batch,
+    rtclog2::EventStream* event_stream) {
+  EncodeRtcpPacket(batch, event_stream->add_incoming_rtcp_packets());
+}
+
+void RtcEventLogEncoderNewFormat::EncodeRtcpPacketOutgoing(
+    rtc::ArrayView<const RtcEventRtcpPacketOutgoing*> batch,
+    rtclog2::EventStream* event_stream) {
+  EncodeRtcpPacket(batch, event_stream->add_outgoing_rtcp_packets());
+}
+
+void RtcEventLogEncoderNewFormat::EncodeRtpPacketIncoming(
+    rtc::ArrayView<const RtcEventRtpPacketIncoming*> batch,
+    rtclog2::EventStream* event_stream) {
+  std::vector<RtpPacketFields> packets;
+  packets.reserve(batch.size());
+  for (const RtcEventRtpPacketIncoming* event : batch) {
+    packets.emplace_back(event->timestamp_us_, event->header_,
+                         event->packet_length_);
+  }
+  EncodeRtpPacketFields(packets, event_stream->add_incoming_rtp_packets());
+}
+
+void RtcEventLogEncoderNewFormat::EncodeRtpPacketOutgoing(
+    rtc::ArrayView<const RtcEventRtpPacketOutgoing*> batch,
+    rtclog2::EventStream* event_stream) {
+  using Event = const RtcEventRtpPacketOutgoing*;
+  std::vector<RtpPacketFields> packets;
+  packets.reserve(batch.size());
+  for (const RtcEventRtpPacketOutgoing* event : batch) {
+    packets.emplace_back(event->timestamp_us_, event->header_,
+                         event->packet_length_);
+  }
+  rtclog2::OutgoingRtpPackets* proto_batch =
+      event_stream->add_outgoing_rtp_packets();
+  EncodeRtpPacketFields(packets, proto_batch);
+
+  if (batch[0]->probe_cluster_id_ != PacedPacketInfo::kNotAProbe)
+    proto_batch->set_probe_cluster_id(batch[0]->probe_cluster_id_);
+  if (batch.size() == 1)
+    return;
+  std::string deltas =
+      EncodeFieldDeltas(batch, [](Event e) -> absl::optional<uint64_t> {
+        if (e->probe_cluster_id_ == PacedPacketInfo::kNotAProbe)
+          return absl::nullopt;
+        return static_cast<uint32_t>(e->probe_cluster_id_);
+      });
+  if (!deltas.empty())
+    proto_batch->set_probe_cluster_id_deltas(deltas);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeAudioReceiveStreamConfig(
+    const RtcEventAudioReceiveStreamConfig& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::AudioRecvStreamConfig* proto_config =
+      event_stream->add_audio_recv_stream_configs();
+  proto_config->set_timestamp_ms(TimestampMs(&event));
+  proto_config->set_remote_ssrc(event.config_->remote_ssrc);
+  proto_config->set_local_ssrc(event.config_->local_ssrc);
+  if (!event.config_->rsid.empty())
+    proto_config->set_rsid(event.config_->rsid);
+  EncodeHeaderExtensions(event.config_->rtp_extensions, proto_config);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeAudioSendStreamConfig(
+    const RtcEventAudioSendStreamConfig& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::AudioSendStreamConfig* proto_config =
+      event_stream->add_audio_send_stream_configs();
+  proto_config->set_timestamp_ms(TimestampMs(&event));
+  proto_config->set_ssrc(event.config_->local_ssrc);
+  if (!event.config_->rsid.empty())
+    proto_config->set_rsid(event.config_->rsid);
+  EncodeHeaderExtensions(event.config_->rtp_extensions, proto_config);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeIceCandidatePairConfig(
+    const RtcEventIceCandidatePairConfig& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::IceCandidatePairConfig* proto_event =
+      event_stream->add_ice_candidate_configs();
+  proto_event->set_timestamp_ms(TimestampMs(&event));
+  proto_event->set_config_type(ConvertIceCandidatePairConfigType(event.type_));
+  proto_event->set_candidate_pair_id(event.candidate_pair_id_);
+  const IceCandidatePairDescription& desc = event.candidate_pair_desc_;
+  proto_event->set_local_candidate_type(
+      ConvertIceCandidateType(desc.local_candidate_type));
+  proto_event->set_local_relay_protocol(
+      ConvertIceCandidatePairProtocol(desc.local_relay_protocol));
+  proto_event->set_local_network_type(
+      ConvertIceCandidateNetworkType(desc.local_network_type));
+  proto_event->set_local_address_family(
+      ConvertIceCandidatePairAddressFamily(desc.local_address_family));
+  proto_event->set_remote_candidate_type(
+      ConvertIceCandidateType(desc.remote_candidate_type));
+  proto_event->set_remote_address_family(
+      ConvertIceCandidatePairAddressFamily(desc.remote_address_family));
+  proto_event->set_candidate_pair_protocol(
+      ConvertIceCandidatePairProtocol(desc.candidate_pair_protocol));
+}
+
+void RtcEventLogEncoderNewFormat::EncodeProbeClusterCreated(
+    const RtcEventProbeClusterCreated& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::BweProbeCluster* proto_event = event_stream->add_probe_clusters();
+  proto_event->set_timestamp_ms(TimestampMs(&event));
+  proto_event->set_id(event.id_);
+  proto_event->set_bitrate_bps(event.bitrate_bps_);
+  proto_event->set_min_packets(event.min_probes_);
+  proto_event->set_min_bytes(event.min_bytes_);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeProbeResultFailure(
+    const RtcEventProbeResultFailure& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::BweProbeResultFailure* proto_event =
+      event_stream->add_probe_failure();
+  proto_event->set_timestamp_ms(TimestampMs(&event));
+  proto_event->set_id(event.id_);
+  proto_event->set_failure(ConvertProbeResultType(event.failure_reason_));
+}
+
+void RtcEventLogEncoderNewFormat::EncodeProbeResultSuccess(
+    const RtcEventProbeResultSuccess& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::BweProbeResultSuccess* proto_event =
+      event_stream->add_probe_success();
+  proto_event->set_timestamp_ms(TimestampMs(&event));
+  proto_event->set_id(event.id_);
+  proto_event->set_bitrate_bps(event.bitrate_bps_);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeVideoReceiveStreamConfig(
+    const RtcEventVideoReceiveStreamConfig& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::VideoRecvStreamConfig* proto_config =
+      event_stream->add_video_recv_stream_configs();
+  proto_config->set_timestamp_ms(TimestampMs(&event));
+  proto_config->set_remote_ssrc(event.config_->remote_ssrc);
+  proto_config->set_local_ssrc(event.config_->local_ssrc);
+  if (event.config_->rtx_ssrc != 0)
+    proto_config->set_rtx_ssrc(event.config_->rtx_ssrc);
+  if (!event.config_->rsid.empty())
+    proto_config->set_rsid(event.config_->rsid);
+  EncodeHeaderExtensions(event.config_->rtp_extensions, proto_config);
+}
+
+void RtcEventLogEncoderNewFormat::EncodeVideoSendStreamConfig(
+    const RtcEventVideoSendStreamConfig& event,
+    rtclog2::EventStream* event_stream) {
+  rtclog2::VideoSendStreamConfig* proto_config =
+      event_stream->add_video_send_stream_configs();
+  proto_config->set_timestamp_ms(TimestampMs(&event));
+  proto_config->set_ssrc(event.config_->local_ssrc);
+  if (event.config_->rtx_ssrc != 0)
+    proto_config->set_rtx_ssrc(event.config_->rtx_ssrc);
+  if (!event.config_->rsid.empty())
+    proto_config->set_rsid(event.config_->rsid);
+  EncodeHeaderExtensions(event.config_->rtp_extensions, proto_config);
+}
+
+}  // namespace webrtc
+
+#endif  // ENABLE_RTC_EVENT_LOG
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef LOGGING_RTC_EVENT_LOG_ENCODER_RTC_EVENT_LOG_ENCODER_NEW_FORMAT_H_
+#define LOGGING_RTC_EVENT_LOG_ENCODER_RTC_EVENT_LOG_ENCODER_NEW_FORMAT_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "api/array_view.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder.h"
+
+#if defined(ENABLE_RTC_EVENT_LOG)
+
+namespace webrtc {
+
+namespace rtclog2 {
+class EventStream;  // Auto-generated from protobuf.
+}  // namespace rtclog2
+
+class RtcEventAlrState;
+class RtcEventAudioNetworkAdaptation;
+class RtcEventAudioPlayout;
+class RtcEventAudioReceiveStreamConfig;
+class RtcEventAudioSendStreamConfig;
+class RtcEventBweUpdateDelayBased;
+class RtcEventBweUpdateLossBased;
+class RtcEventIceCandidatePairConfig;
+class RtcEventIceCandidatePair;
+class RtcEventProbeClusterCreated;
+class RtcEventProbeResultFailure;
+class RtcEventProbeResultSuccess;
+class RtcEventRtcpPacketIncoming;
+class RtcEventRtcpPacketOutgoing;
+class RtcEventRtpPacketIncoming;
+class RtcEventRtpPacketOutgoing;
+class RtcEventVideoReceiveStreamConfig;
+class RtcEventVideoSendStreamConfig;
+
+// Encodes events in the rtclog2 format. Each call to EncodeBatch() groups the
+// events by type, and for RTP packets and audio playouts also by SSRC, and
+// writes each group as one message in which all but the first event are
+// delta encoded. See rtc_event_log2.proto.
+class RtcEventLogEncoderNewFormat final : public RtcEventLogEncoder {
+ public:
+  ~RtcEventLogEncoderNewFormat() override = default;
+
+  std::string EncodeLogStart(int64_t timestamp_us) override;
+  std::string EncodeLogEnd(int64_t timestamp_us) override;
+
+  std::string EncodeBatch(
+      std::deque<std::unique_ptr<RtcEvent>>::const_iterator begin,
+      std::deque<std::unique_ptr<RtcEvent>>::const_iterator end) override;
+
+ private:
+  // Events that are batched, each batch non-empty and in logging order.
+  void EncodeAlrState(rtc::ArrayView<const RtcEventAlrState*> batch,
+                      rtclog2::EventStream* event_stream);
+  void EncodeAudioNetworkAdaptation(
+      rtc::ArrayView<const RtcEventAudioNetworkAdaptation*> batch,
+      rtclog2::EventStream* event_stream);
+  void EncodeAudioPlayout(rtc::ArrayView<const RtcEventAudioPlayout*> batch,
+                          rtclog2::EventStream* event_stream);
+  void EncodeBweUpdateDelayBased(
+      rtc::ArrayView<const RtcEventBweUpdateDelayBased*> batch,
+      rtclog2::EventStream* event_stream);
+  void EncodeBweUpdateLossBased(
+      rtc::ArrayView<const RtcEventBweUpdateLossBased*> batch,
+      rtclog2::EventStream* event_stream);
+  void EncodeIceCandidatePairEvent(
+      rtc::ArrayView<const RtcEventIceCandidatePair*> batch,
+      rtclog2::EventStream* event_stream);
+  void EncodeRtcpPacketIncoming(
+      rtc::ArrayView<const RtcEventRtcpPacketIncoming*> batch,
+      rtclog2::EventStream* event_stream);
+  void EncodeRtcpPacketOutgoing(
+      rtc::ArrayView<const RtcEventRtcpPacketOutgoing*> batch,
+      rtclog2::EventStream* event_stream);
+  void EncodeRtpPacketIncoming(
+      rtc::ArrayView<const RtcEventRtpPacketIncoming*> batch,
+      rtclog2::EventStream* event_stream);
+  void EncodeRtpPacketOutgoing(
+      rtc::ArrayView<const RtcEventRtpPacketOutgoing*> batch,
+      rtclog2::EventStream* event_stream);
+
+  // Rare events, which are written one message each.
+  void EncodeAudioReceiveStreamConfig(
+      const RtcEventAudioReceiveStreamConfig& event,
+      rtclog2::EventStream* event_stream);
+  void EncodeAudioSendStreamConfig(const RtcEventAudioSendStreamConfig& event,
+                                   rtclog2::EventStream* event_stream);
+  void EncodeIceCandidatePairConfig(
+      const RtcEventIceCandidatePairConfig& event,
+      rtclog2::EventStream* event_stream);
+  void EncodeProbeClusterCreated(const RtcEventProbeClusterCreated& event,
+                                 rtclog2::EventStream* event_stream);
+  void EncodeProbeResultFailure(const RtcEventProbeResultFailure& event,
+                                rtclog2::EventStream* event_stream);
+  void EncodeProbeResultSuccess(const RtcEventProbeResultSuccess& event,
+                                rtclog2::EventStream* event_stream);
+  void EncodeVideoReceiveStreamConfig(
+      const RtcEventVideoReceiveStreamConfig& event,
+      rtclog2::EventStream* event_stream);
+  void EncodeVideoSendStreamConfig(const RtcEventVideoSendStreamConfig& event,
+                                   rtclog2::EventStream* event_stream);
+};
+
+}  // namespace webrtc
+
+#endif  // ENABLE_RTC_EVENT_LOG
+
+#endif  // LOGGING_RTC_EVENT_LOG_ENCODER_RTC_EVENT_LOG_ENCODER_NEW_FORMAT_H_
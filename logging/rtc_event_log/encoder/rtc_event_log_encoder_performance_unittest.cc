@@ -0,0 +1,170 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
+#include "logging/rtc_event_log/events/rtc_event_bwe_update_delay_based.h"
+#include "logging/rtc_event_log/events/rtc_event_rtcp_packet_outgoing.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_incoming.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_outgoing.h"
+#include "modules/remote_bitrate_estimator/include/bwe_defines.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/report_block.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kCallDurationMs = 60000;
+// RtcEventLogImpl hands the encoder what was logged since the last output.
+constexpr int kBatchDurationMs = 1000;
+constexpr int kAudioPacketIntervalMs = 20;
+constexpr int kBweUpdateIntervalMs = 25;
+constexpr int kRtcpIntervalMs = 100;
+constexpr uint32_t kVideoSsrc = 0x1234;
+constexpr uint32_t kAudioSsrc = 0x5678;
+constexpr uint32_t kRemoteAudioSsrc = 0x9abc;
+
+// The events of one second of a call, logged in the order a call logs them:
+// a video packet sent every millisecond, audio in both directions, delay
+// based bandwidth estimates and receiver reports.
+class CallSimulator {
+ public:
+  CallSimulator() {
+    extensions_.Register<TransportSequenceNumber>(1);
+    extensions_.Register<AbsoluteSendTime>(2);
+    extensions_.Register<AudioLevel>(3);
+  }
+
+  std::deque<std::unique_ptr<RtcEvent>> NextBatch() {
+    std::deque<std::unique_ptr<RtcEvent>> batch;
+    for (int i = 0; i < kBatchDurationMs; ++i, ++time_ms_) {
+      clock_.SetTimeMicros(time_ms_ * 1000);
+      batch.push_back(absl::make_unique<RtcEventRtpPacketOutgoing>(
+          NewPacket<RtpPacketToSend>(kVideoSsrc, 96, video_sequence_number_++,
+                                     90 * (time_ms_ - time_ms_ % 33), 1100),
+          PacedPacketInfo::kNotAProbe));
+      if (time_ms_ % kAudioPacketIntervalMs == 0) {
+        const uint32_t rtp_timestamp = 48 * time_ms_;
+        batch.push_back(absl::make_unique<RtcEventRtpPacketOutgoing>(
+            NewPacket<RtpPacketToSend>(kAudioSsrc, 111,
+                                       audio_sequence_number_, rtp_timestamp,
+                                       80),
+            PacedPacketInfo::kNotAProbe));
+        batch.push_back(absl::make_unique<RtcEventRtpPacketIncoming>(
+            NewPacket<RtpPacketReceived>(kRemoteAudioSsrc, 111,
+                                         audio_sequence_number_++,
+                                         rtp_timestamp, 80)));
+        batch.push_back(
+            absl::make_unique<RtcEventAudioPlayout>(kRemoteAudioSsrc));
+      }
+      if (time_ms_ % kBweUpdateIntervalMs == 0) {
+        batch.push_back(absl::make_unique<RtcEventBweUpdateDelayBased>(
+            1000000 + 100 * (time_ms_ % 1000), BandwidthUsage::kBwNormal));
+      }
+      if (time_ms_ % kRtcpIntervalMs == 0) {
+        rtcp::ReportBlock report_block;
+        report_block.SetMediaSsrc(kRemoteAudioSsrc);
+        report_block.SetExtHighestSeqNum(audio_sequence_number_);
+        rtcp::ReceiverReport receiver_report;
+        receiver_report.SetSenderSsrc(kAudioSsrc);
+        receiver_report.AddReportBlock(report_block);
+        rtc::Buffer packet = receiver_report.Build();
+        batch.push_back(absl::make_unique<RtcEventRtcpPacketOutgoing>(packet));
+      }
+    }
+    return batch;
+  }
+
+ private:
+  template <typename PacketType>
+  PacketType NewPacket(uint32_t ssrc,
+                       uint8_t payload_type,
+                       uint16_t sequence_number,
+                       uint32_t rtp_timestamp,
+                       size_t payload_size) {
+    PacketType packet(&extensions_);
+    packet.SetPayloadType(payload_type);
+    packet.SetSequenceNumber(sequence_number);
+    packet.SetTimestamp(rtp_timestamp);
+    packet.SetSsrc(ssrc);
+    packet.template SetExtension<TransportSequenceNumber>(
+        transport_sequence_number_++);
+    packet.template SetExtension<AbsoluteSendTime>(
+        AbsoluteSendTime::MsTo24Bits(time_ms_));
+    if (ssrc != kVideoSsrc)
+      packet.template SetExtension<AudioLevel>(true, 30);
+    packet.SetPayloadSize(payload_size);
+    return packet;
+  }
+
+  rtc::ScopedFakeClock clock_;
+  RtpHeaderExtensionMap extensions_;
+  int64_t time_ms_ = 1;
+  uint16_t video_sequence_number_ = 1000;
+  uint16_t audio_sequence_number_ = 2000;
+  uint16_t transport_sequence_number_ = 0;
+};
+
+using EventBatch = std::deque<std::unique_ptr<RtcEvent>>;
+
+std::deque<EventBatch> SimulateCall() {
+  CallSimulator call;
+  std::deque<EventBatch> batches;
+  for (int i = 0; i < kCallDurationMs / kBatchDurationMs; ++i)
+    batches.push_back(call.NextBatch());
+  return batches;
+}
+
+void MeasureEncoder(const std::string& trace,
+                    const std::deque<EventBatch>& batches,
+                    RtcEventLogEncoder* encoder) {
+  size_t num_events = 0;
+  size_t num_bytes = 0;
+  const int64_t start_ns = rtc::TimeNanos();
+  for (const EventBatch& batch : batches) {
+    num_events += batch.size();
+    num_bytes += encoder->EncodeBatch(batch.begin(), batch.end()).size();
+  }
+  const int64_t elapsed_ns = rtc::TimeNanos() - start_ns;
+  test::PrintResult("rtc_event_log_encoded_size", "", trace,
+                    static_cast<double>(num_bytes) / num_events, "bytes/event",
+                    true);
+  test::PrintResult("rtc_event_log_encoding_time", "", trace,
+                    static_cast<double>(elapsed_ns) / num_events, "ns/event",
+                    true);
+}
+
+}  // namespace
+
+// Encodes a minute of a video call, a second at a time, with each encoder.
+TEST(RtcEventLogEncoderPerformanceTest, EncodeCall) {
+  const std::deque<EventBatch> batches = SimulateCall();
+  RtcEventLogEncoderLegacy legacy_encoder;
+  MeasureEncoder("legacy", batches, &legacy_encoder);
+  RtcEventLogEncoderNewFormat new_format_encoder;
+  MeasureEncoder("new_format", batches, &new_format_encoder);
+}
+
+}  // namespace webrtc
@@ -11,9 +11,12 @@
 #include <deque>
 #include <limits>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
 #include "logging/rtc_event_log/events/rtc_event_alr_state.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_network_adaptation.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
@@ -30,35 +33,77 @@
 #include "logging/rtc_event_log/events/rtc_event_rtp_packet_outgoing.h"
 #include "logging/rtc_event_log/events/rtc_event_video_receive_stream_config.h"
 #include "logging/rtc_event_log/events/rtc_event_video_send_stream_config.h"
+#include "logging/rtc_event_log/rtc_event_log.h"
 #include "logging/rtc_event_log/rtc_event_log_parser_new.h"
 #include "logging/rtc_event_log/rtc_event_log_unittest_helper.h"
 #include "modules/audio_coding/audio_network_adaptor/include/audio_network_adaptor_config.h"
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/fakeclock.h"
 #include "rtc_base/random.h"
 #include "test/gtest.h"
 
 namespace webrtc {
+namespace {
+std::unique_ptr<RtcEventLogEncoder> CreateEncoder(
+    RtcEventLog::EncodingType encoding_type) {
+  switch (encoding_type) {
+    case RtcEventLog::EncodingType::Legacy:
+      return absl::make_unique<RtcEventLogEncoderLegacy>();
+    case RtcEventLog::EncodingType::NewFormat:
+      return absl::make_unique<RtcEventLogEncoderNewFormat>();
+  }
+  RTC_NOTREACHED();
+  return nullptr;
+}
+}  // namespace
 
-
-class RtcEventLogEncoderTest : public testing::TestWithParam<int> {
+class RtcEventLogEncoderTest
+    : public testing::TestWithParam<
+          std::tuple<int, RtcEventLog::EncodingType>> {
  protected:
   RtcEventLogEncoderTest()
-      : encoder_(new RtcEventLogEncoderLegacy),
-        seed_(GetParam()),
+      : encoding_type_(std::get<1>(GetParam())),
+        encoder_(CreateEncoder(encoding_type_)),
+        seed_(std::get<0>(GetParam())),
         prng_(seed_),
-        gen_(seed_ * 880001UL) {}
+        gen_(seed_ * 880001UL) {
+    // The new format logs timestamps in milliseconds.
+    fake_clock_.SetTimeMicros(1000 *
+                              static_cast<int64_t>(prng_.Rand(1, 1000000)));
+  }
   ~RtcEventLogEncoderTest() override = default;
 
+  // The new format does not log codecs, REMB or the RTCP mode. Returns a copy
+  // of |event| with whatever the parser can be expected to reproduce.
+  template <typename EventType>
+  std::unique_ptr<EventType> LoggableConfig(const EventType& event) const {
+    auto config = absl::make_unique<rtclog::StreamConfig>(*event.config_);
+    if (encoding_type_ == RtcEventLog::EncodingType::NewFormat) {
+      config->remb = false;
+      config->rtcp_mode = RtcpMode::kReducedSize;
+      config->codecs.clear();
+    }
+    return absl::make_unique<EventType>(std::move(config));
+  }
+
+  // Moves the clock forward by a random number of whole milliseconds, so that
+  // consecutive events in a batch get distinct timestamps.
+  void AdvanceClock() {
+    fake_clock_.AdvanceTimeMicros(1000 *
+                                  static_cast<int64_t>(prng_.Rand(0, 100)));
+  }
+
   // ANA events have some optional fields, so we want to make sure that we get
   // correct behavior both when all of the values are there, as well as when
   // only some.
   void TestRtcEventAudioNetworkAdaptation(
       std::unique_ptr<AudioEncoderRuntimeConfig> runtime_config);
 
+  rtc::ScopedFakeClock fake_clock_;
   std::deque<std::unique_ptr<RtcEvent>> history_;
-  // TODO(eladalon): Once we have more than one possible encoder, parameterize
-  // encoder selection.
+  const RtcEventLog::EncodingType encoding_type_;
   std::unique_ptr<RtcEventLogEncoder> encoder_;
   ParsedRtcEventLogNew parsed_log_;
   const uint64_t seed_;
@@ -201,7 +246,8 @@ TEST_P(RtcEventLogEncoderTest, RtcEventAudioReceiveStreamConfig) {
   const auto& audio_recv_configs = parsed_log_.audio_recv_configs();
 
   ASSERT_EQ(audio_recv_configs.size(), 1u);
-  EXPECT_TRUE(test::VerifyLoggedAudioRecvConfig(*event, audio_recv_configs[0]));
+  EXPECT_TRUE(test::VerifyLoggedAudioRecvConfig(*LoggableConfig(*event),
+                                                audio_recv_configs[0]));
 }
 
 TEST_P(RtcEventLogEncoderTest, RtcEventAudioSendStreamConfig) {
@@ -216,7 +262,8 @@ TEST_P(RtcEventLogEncoderTest, RtcEventAudioSendStreamConfig) {
   const auto& audio_send_configs = parsed_log_.audio_send_configs();
 
   ASSERT_EQ(audio_send_configs.size(), 1u);
-  EXPECT_TRUE(test::VerifyLoggedAudioSendConfig(*event, audio_send_configs[0]));
+  EXPECT_TRUE(test::VerifyLoggedAudioSendConfig(*LoggableConfig(*event),
+                                                audio_send_configs[0]));
 }
 
 TEST_P(RtcEventLogEncoderTest, RtcEventBweUpdateDelayBased) {
@@ -419,7 +466,8 @@ TEST_P(RtcEventLogEncoderTest, RtcEventVideoReceiveStreamConfig) {
   const auto& video_recv_configs = parsed_log_.video_recv_configs();
 
   ASSERT_EQ(video_recv_configs.size(), 1u);
-  EXPECT_TRUE(test::VerifyLoggedVideoRecvConfig(*event, video_recv_configs[0]));
+  EXPECT_TRUE(test::VerifyLoggedVideoRecvConfig(*LoggableConfig(*event),
+                                                video_recv_configs[0]));
 }
 
 TEST_P(RtcEventLogEncoderTest, RtcEventVideoSendStreamConfig) {
@@ -434,11 +482,103 @@ TEST_P(RtcEventLogEncoderTest, RtcEventVideoSendStreamConfig) {
   const auto& video_send_configs = parsed_log_.video_send_configs();
 
   ASSERT_EQ(video_send_configs.size(), 1u);
-  EXPECT_TRUE(test::VerifyLoggedVideoSendConfig(*event, video_send_configs[0]));
+  EXPECT_TRUE(test::VerifyLoggedVideoSendConfig(*LoggableConfig(*event),
+                                                video_send_configs[0]));
+}
+
+TEST_P(RtcEventLogEncoderTest, BatchOfAudioPlayoutEvents) {
+  const uint32_t ssrcs[] = {prng_.Rand<uint32_t>(), prng_.Rand<uint32_t>()};
+  std::vector<std::unique_ptr<RtcEventAudioPlayout>> events;
+  for (size_t i = 0; i < 20; ++i) {
+    AdvanceClock();
+    events.push_back(gen_.NewAudioPlayout(ssrcs[i % 2]));
+    history_.push_back(events.back()->Copy());
+  }
+
+  std::string encoded = encoder_->EncodeBatch(history_.begin(), history_.end());
+  ASSERT_TRUE(parsed_log_.ParseString(encoded));
+  const auto& playout_events = parsed_log_.audio_playout_events();
+
+  ASSERT_EQ(playout_events.size(), 2u);
+  for (size_t i = 0; i < events.size(); ++i) {
+    const auto playout_stream = playout_events.find(ssrcs[i % 2]);
+    ASSERT_TRUE(playout_stream != playout_events.end());
+    ASSERT_EQ(playout_stream->second.size(), events.size() / 2);
+    EXPECT_TRUE(test::VerifyLoggedAudioPlayoutEvent(
+        *events[i], playout_stream->second[i / 2]));
+  }
+}
+
+TEST_P(RtcEventLogEncoderTest, BatchOfBweUpdatesLossBased) {
+  std::vector<std::unique_ptr<RtcEventBweUpdateLossBased>> events;
+  for (size_t i = 0; i < 20; ++i) {
+    AdvanceClock();
+    events.push_back(gen_.NewBweUpdateLossBased());
+    history_.push_back(events.back()->Copy());
+  }
+
+  std::string encoded = encoder_->EncodeBatch(history_.begin(), history_.end());
+  ASSERT_TRUE(parsed_log_.ParseString(encoded));
+  const auto& bwe_loss_updates = parsed_log_.bwe_loss_updates();
+
+  ASSERT_EQ(bwe_loss_updates.size(), events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_TRUE(
+        test::VerifyLoggedBweLossBasedUpdate(*events[i], bwe_loss_updates[i]));
+  }
+}
+
+TEST_P(RtcEventLogEncoderTest, BatchOfRtpPacketsWithHeaderExtensions) {
+  const uint32_t ssrc = prng_.Rand<uint32_t>();
+  RtpHeaderExtensionMap extension_map = gen_.NewRtpHeaderExtensionMap();
+  // The legacy parser needs the stream's config to find the extensions.
+  history_.push_back(gen_.NewVideoReceiveStreamConfig(ssrc, extension_map));
+  std::vector<std::unique_ptr<RtcEventRtpPacketIncoming>> events;
+  for (size_t i = 0; i < 20; ++i) {
+    AdvanceClock();
+    events.push_back(gen_.NewRtpPacketIncoming(ssrc, extension_map));
+    history_.push_back(events.back()->Copy());
+  }
+
+  std::string encoded = encoder_->EncodeBatch(history_.begin(), history_.end());
+  ASSERT_TRUE(parsed_log_.ParseString(encoded));
+  const auto& incoming_rtp_packets_by_ssrc =
+      parsed_log_.incoming_rtp_packets_by_ssrc();
+
+  ASSERT_EQ(incoming_rtp_packets_by_ssrc.size(), 1u);
+  const auto& stream = incoming_rtp_packets_by_ssrc[0];
+  EXPECT_EQ(stream.ssrc, ssrc);
+  ASSERT_EQ(stream.incoming_packets.size(), events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_TRUE(test::VerifyLoggedRtpPacketIncoming(
+        *events[i], stream.incoming_packets[i]));
+  }
+}
+
+TEST_P(RtcEventLogEncoderTest, NewFormatIsSmallerForLargeBatches) {
+  if (encoding_type_ != RtcEventLog::EncodingType::NewFormat)
+    return;
+  const uint32_t ssrc = prng_.Rand<uint32_t>();
+  RtpHeaderExtensionMap extension_map = gen_.NewRtpHeaderExtensionMap();
+  for (size_t i = 0; i < 100; ++i) {
+    AdvanceClock();
+    history_.push_back(gen_.NewRtpPacketOutgoing(ssrc, extension_map));
+    history_.push_back(gen_.NewBweUpdateDelayBased());
+  }
+
+  RtcEventLogEncoderLegacy legacy_encoder;
+  std::string legacy_encoded =
+      legacy_encoder.EncodeBatch(history_.begin(), history_.end());
+  std::string encoded = encoder_->EncodeBatch(history_.begin(), history_.end());
+  EXPECT_LT(encoded.size(), legacy_encoded.size());
 }
 
-INSTANTIATE_TEST_CASE_P(RandomSeeds,
-                        RtcEventLogEncoderTest,
-                        ::testing::Values(1, 2, 3, 4, 5));
+INSTANTIATE_TEST_CASE_P(
+    RandomSeeds,
+    RtcEventLogEncoderTest,
+    ::testing::Combine(
+        ::testing::Values(1, 2, 3, 4, 5),
+        ::testing::Values(RtcEventLog::EncodingType::Legacy,
+                          RtcEventLog::EncodingType::NewFormat)));
 
 }  // namespace webrtc
@@ -17,13 +17,15 @@ namespace webrtc {
 
 RtcEventRtpPacketIncoming::RtcEventRtpPacketIncoming(
     const RtpPacketReceived& packet)
-    : packet_length_(packet.size()) {
+    : header_(nullptr, packet.headers_size()), packet_length_(packet.size()) {
   header_.CopyHeaderFrom(packet);
 }
 
 RtcEventRtpPacketIncoming::RtcEventRtpPacketIncoming(
     const RtcEventRtpPacketIncoming& other)
-    : RtcEvent(other.timestamp_us_), packet_length_(other.packet_length_) {
+    : RtcEvent(other.timestamp_us_),
+      header_(nullptr, other.header_.headers_size()),
+      packet_length_(other.packet_length_) {
   header_.CopyHeaderFrom(other.header_);
 }
 
@@ -18,13 +18,16 @@ namespace webrtc {
 RtcEventRtpPacketOutgoing::RtcEventRtpPacketOutgoing(
     const RtpPacketToSend& packet,
     int probe_cluster_id)
-    : packet_length_(packet.size()), probe_cluster_id_(probe_cluster_id) {
+    : header_(nullptr, packet.headers_size()),
+      packet_length_(packet.size()),
+      probe_cluster_id_(probe_cluster_id) {
   header_.CopyHeaderFrom(packet);
 }
 
 RtcEventRtpPacketOutgoing::RtcEventRtpPacketOutgoing(
     const RtcEventRtpPacketOutgoing& other)
     : RtcEvent(other.timestamp_us_),
+      header_(nullptr, other.header_.headers_size()),
       packet_length_(other.packet_length_),
       probe_cluster_id_(other.probe_cluster_id_) {
   header_.CopyHeaderFrom(other.header_);
@@ -32,7 +32,8 @@ class RtcEventRtpPacketOutgoing final : public RtcEvent {
 
   std::unique_ptr<RtcEvent> Copy() const override;
 
-  RtpPacket header_;            // Only the packet's header will be stored here.
+  // Only the packet's header is stored here, in a buffer of just its size.
+  RtpPacket header_;
   const size_t packet_length_;  // Length before stripping away all but header.
   const int probe_cluster_id_;
 
@@ -10,6 +10,7 @@
 
 #include "logging/rtc_event_log/rtc_event_log.h"
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <limits>
@@ -19,7 +20,9 @@
 
 #include "absl/memory/memory.h"
 #include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
 #include "logging/rtc_event_log/output/rtc_event_log_output_file.h"
+#include "logging/rtc_event_log/rtc_event_queue.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/constructormagic.h"
 #include "rtc_base/event.h"
@@ -39,6 +42,10 @@ constexpr size_t kMaxEventsInHistory = 10000;
 // The config-history is supposed to be unbounded, but needs to have some bound
 // to prevent an attack via unreasonable memory use.
 constexpr size_t kMaxEventsInConfigHistory = 1000;
+// Events are handed to the task queue through a ring buffer, which the task
+// queue drains in one task per burst of events. It only has to hold what is
+// logged while that task is pending.
+constexpr size_t kIncomingEventsCapacity = 4096;
 
 // TODO(eladalon): This class exists because C++11 doesn't allow transferring a
 // unique_ptr to a lambda (a copy constructor is required). We should get
@@ -65,6 +72,8 @@ std::unique_ptr<RtcEventLogEncoder> CreateEncoder(
   switch (type) {
     case RtcEventLog::EncodingType::Legacy:
       return absl::make_unique<RtcEventLogEncoderLegacy>();
+    case RtcEventLog::EncodingType::NewFormat:
+      return absl::make_unique<RtcEventLogEncoderNewFormat>();
     default:
       RTC_LOG(LS_ERROR) << "Unknown RtcEventLog encoder type (" << int(type)
                         << ")";
@@ -89,6 +98,8 @@ class RtcEventLogImpl final : public RtcEventLog {
   void Log(std::unique_ptr<RtcEvent> event) override;
 
  private:
+  void DrainIncomingEvents() RTC_RUN_ON(task_queue_);
+  void MoveIncomingEventsToMemory() RTC_RUN_ON(task_queue_);
   void LogToMemory(std::unique_ptr<RtcEvent> event) RTC_RUN_ON(task_queue_);
   void LogEventsFromMemoryToOutput() RTC_RUN_ON(task_queue_);
 
@@ -126,6 +137,11 @@ class RtcEventLogImpl final : public RtcEventLog {
   int64_t last_output_ms_ RTC_GUARDED_BY(*task_queue_);
   bool output_scheduled_ RTC_GUARDED_BY(*task_queue_);
 
+  // Events logged on any thread and not yet moved to the histories.
+  RtcEventQueue incoming_events_;
+  // Whether a task that will drain |incoming_events_| is pending.
+  std::atomic<bool> drain_scheduled_;
+
   // Since we are posting tasks bound to |this|,  it is critical that the event
   // log and it's members outlive the |task_queue_|. Keep the "task_queue_|
   // last to ensure it destructs first, or else tasks living on the queue might
@@ -145,6 +161,8 @@ RtcEventLogImpl::RtcEventLogImpl(
       output_period_ms_(kImmediateOutput),
       last_output_ms_(rtc::TimeMillis()),
       output_scheduled_(false),
+      incoming_events_(kIncomingEventsCapacity),
+      drain_scheduled_(false),
       task_queue_(std::move(task_queue)) {
   RTC_DCHECK(task_queue_);
 }
@@ -182,7 +200,9 @@ bool RtcEventLogImpl::StartLogging(std::unique_ptr<RtcEventLogOutput> output,
     event_output_ = std::move(output);
     num_config_events_written_ = 0;
     WriteToOutput(event_encoder_->EncodeLogStart(timestamp_us));
-    LogEventsFromMemoryToOutput();
+    MoveIncomingEventsToMemory();
+    if (event_output_)
+      LogEventsFromMemoryToOutput();
   };
 
   task_queue_->PostTask(
@@ -202,6 +222,7 @@ void RtcEventLogImpl::StopLogging() {
   // Binding to |this| is safe because |this| outlives the |task_queue_|.
   task_queue_->PostTask([this, &output_stopped]() {
     RTC_DCHECK_RUN_ON(task_queue_.get());
+    MoveIncomingEventsToMemory();
     if (event_output_) {
       RTC_DCHECK(event_output_->IsActive());
       LogEventsFromMemoryToOutput();
@@ -218,16 +239,52 @@ void RtcEventLogImpl::StopLogging() {
 void RtcEventLogImpl::Log(std::unique_ptr<RtcEvent> event) {
   RTC_CHECK(event);
 
-  // Binding to |this| is safe because |this| outlives the |task_queue_|.
-  auto event_handler = [this](std::unique_ptr<RtcEvent> unencoded_event) {
-    RTC_DCHECK_RUN_ON(task_queue_.get());
-    LogToMemory(std::move(unencoded_event));
-    if (event_output_)
-      ScheduleOutput();
-  };
+  if (!incoming_events_.Push(&event)) {
+    // The task queue is far behind. Rather than drop the event, hand it over
+    // in a task of its own, after whatever was pushed before it.
+    // Binding to |this| is safe because |this| outlives the |task_queue_|.
+    auto event_handler = [this](std::unique_ptr<RtcEvent> unencoded_event) {
+      RTC_DCHECK_RUN_ON(task_queue_.get());
+      MoveIncomingEventsToMemory();
+      LogToMemory(std::move(unencoded_event));
+      if (event_output_)
+        ScheduleOutput();
+    };
+    task_queue_->PostTask(absl::make_unique<ResourceOwningTask<RtcEvent>>(
+        std::move(event), event_handler));
+    return;
+  }
+
+  // Only the first event pushed after a drain posts a task; the events that
+  // follow it are drained by the same task. The load keeps the common case
+  // from writing to the flag.
+  if (!drain_scheduled_.load() && !drain_scheduled_.exchange(true)) {
+    // Binding to |this| is safe because |this| outlives the |task_queue_|.
+    task_queue_->PostTask([this]() {
+      RTC_DCHECK_RUN_ON(task_queue_.get());
+      DrainIncomingEvents();
+    });
+  }
+}
 
-  task_queue_->PostTask(absl::make_unique<ResourceOwningTask<RtcEvent>>(
-      std::move(event), event_handler));
+void RtcEventLogImpl::DrainIncomingEvents() {
+  // Cleared before popping, so that an event which is pushed too late to be
+  // popped here sees the flag cleared and posts another drain.
+  drain_scheduled_.store(false);
+  MoveIncomingEventsToMemory();
+  if (event_output_)
+    ScheduleOutput();
+}
+
+void RtcEventLogImpl::MoveIncomingEventsToMemory() {
+  while (std::unique_ptr<RtcEvent> event = incoming_events_.Pop()) {
+    LogToMemory(std::move(event));
+    if (event_output_ && history_.size() >= kMaxEventsInHistory) {
+      // Write out the history rather than let LogToMemory() drop events.
+      RTC_DCHECK(event_output_->IsActive());
+      LogEventsFromMemoryToOutput();
+    }
+  }
 }
 
 void RtcEventLogImpl::ScheduleOutput() {
@@ -251,6 +308,7 @@ void RtcEventLogImpl::ScheduleOutput() {
     // Binding to |this| is safe because |this| outlives the |task_queue_|.
     auto output_task = [this]() {
       RTC_DCHECK_RUN_ON(task_queue_.get());
+      MoveIncomingEventsToMemory();
       if (event_output_) {
         RTC_DCHECK(event_output_->IsActive());
         LogEventsFromMemoryToOutput();
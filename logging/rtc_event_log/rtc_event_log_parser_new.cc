@@ -14,18 +14,22 @@
 #include <string.h>
 
 #include <algorithm>
-#include <fstream>
 #include <istream>  // no-presubmit-check TODO(webrtc:8982)
+#include <iterator>
 #include <limits>
 #include <map>
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
 #include "api/rtp_headers.h"
 #include "api/rtpparameters.h"
+#include "logging/rtc_event_log/encoder/blob_encoding.h"
+#include "logging/rtc_event_log/encoder/delta_encoding.h"
 #include "logging/rtc_event_log/rtc_event_log.h"
 #include "modules/audio_coding/audio_network_adaptor/include/audio_network_adaptor.h"
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
+#include "modules/rtp_rtcp/include/rtp_cvo.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
@@ -210,28 +214,6 @@ IceCandidatePairEventType GetRuntimeIceCandidatePairEventType(
   return IceCandidatePairEventType::kCheckSent;
 }
 
-std::pair<uint64_t, bool> ParseVarInt(
-    std::istream& stream) {  // no-presubmit-check TODO(webrtc:8982)
-  uint64_t varint = 0;
-  for (size_t bytes_read = 0; bytes_read < 10; ++bytes_read) {
-    // The most significant bit of each byte is 0 if it is the last byte in
-    // the varint and 1 otherwise. Thus, we take the 7 least significant bits
-    // of each byte and shift them 7 bits for each byte read previously to get
-    // the (unsigned) integer.
-    int byte = stream.get();
-    if (stream.eof()) {
-      return std::make_pair(varint, false);
-    }
-    RTC_DCHECK_GE(byte, 0);
-    RTC_DCHECK_LE(byte, 255);
-    varint |= static_cast<uint64_t>(byte & 0x7F) << (7 * bytes_read);
-    if ((byte & 0x80) == 0) {
-      return std::make_pair(varint, true);
-    }
-  }
-  return std::make_pair(varint, false);
-}
-
 void GetHeaderExtensions(std::vector<RtpExtension>* header_extensions,
                          const RepeatedPtrField<rtclog::RtpHeaderExtension>&
                              proto_header_extensions) {
@@ -245,6 +227,369 @@ void GetHeaderExtensions(std::vector<RtpExtension>* header_extensions,
   }
 }
 
+BandwidthUsage GetRuntimeDetectorState(
+    rtclog2::DelayBasedBweUpdates::DetectorState detector_state) {
+  switch (detector_state) {
+    case rtclog2::DelayBasedBweUpdates::BWE_NORMAL:
+      return BandwidthUsage::kBwNormal;
+    case rtclog2::DelayBasedBweUpdates::BWE_UNDERUSING:
+      return BandwidthUsage::kBwUnderusing;
+    case rtclog2::DelayBasedBweUpdates::BWE_OVERUSING:
+      return BandwidthUsage::kBwOverusing;
+  }
+  RTC_NOTREACHED();
+  return BandwidthUsage::kBwNormal;
+}
+
+bool GetRuntimeProbeFailureReason(
+    rtclog2::BweProbeResultFailure::FailureReason failure,
+    ProbeFailureReason* failure_reason) {
+  switch (failure) {
+    case rtclog2::BweProbeResultFailure::INVALID_SEND_RECEIVE_INTERVAL:
+      *failure_reason = ProbeFailureReason::kInvalidSendReceiveInterval;
+      return true;
+    case rtclog2::BweProbeResultFailure::INVALID_SEND_RECEIVE_RATIO:
+      *failure_reason = ProbeFailureReason::kInvalidSendReceiveRatio;
+      return true;
+    case rtclog2::BweProbeResultFailure::TIMEOUT:
+      *failure_reason = ProbeFailureReason::kTimeout;
+      return true;
+    case rtclog2::BweProbeResultFailure::UNKNOWN:
+      return false;
+  }
+  return false;
+}
+
+bool GetRuntimeIceCandidatePairConfigType(
+    rtclog2::IceCandidatePairConfig::IceCandidatePairConfigType proto_type,
+    IceCandidatePairConfigType* type) {
+  switch (proto_type) {
+    case rtclog2::IceCandidatePairConfig::ADDED:
+      *type = IceCandidatePairConfigType::kAdded;
+      return true;
+    case rtclog2::IceCandidatePairConfig::UPDATED:
+      *type = IceCandidatePairConfigType::kUpdated;
+      return true;
+    case rtclog2::IceCandidatePairConfig::DESTROYED:
+      *type = IceCandidatePairConfigType::kDestroyed;
+      return true;
+    case rtclog2::IceCandidatePairConfig::SELECTED:
+      *type = IceCandidatePairConfigType::kSelected;
+      return true;
+    case rtclog2::IceCandidatePairConfig::UNKNOWN_CONFIG_TYPE:
+      return false;
+  }
+  return false;
+}
+
+IceCandidateType GetRuntimeIceCandidateType(
+    rtclog2::IceCandidatePairConfig::IceCandidateType type) {
+  switch (type) {
+    case rtclog2::IceCandidatePairConfig::LOCAL:
+      return IceCandidateType::kLocal;
+    case rtclog2::IceCandidatePairConfig::STUN:
+      return IceCandidateType::kStun;
+    case rtclog2::IceCandidatePairConfig::PRFLX:
+      return IceCandidateType::kPrflx;
+    case rtclog2::IceCandidatePairConfig::RELAY:
+      return IceCandidateType::kRelay;
+    case rtclog2::IceCandidatePairConfig::UNKNOWN_CANDIDATE_TYPE:
+      return IceCandidateType::kUnknown;
+  }
+  return IceCandidateType::kUnknown;
+}
+
+IceCandidatePairProtocol GetRuntimeIceCandidatePairProtocol(
+    rtclog2::IceCandidatePairConfig::Protocol protocol) {
+  switch (protocol) {
+    case rtclog2::IceCandidatePairConfig::UDP:
+      return IceCandidatePairProtocol::kUdp;
+    case rtclog2::IceCandidatePairConfig::TCP:
+      return IceCandidatePairProtocol::kTcp;
+    case rtclog2::IceCandidatePairConfig::SSLTCP:
+      return IceCandidatePairProtocol::kSsltcp;
+    case rtclog2::IceCandidatePairConfig::TLS:
+      return IceCandidatePairProtocol::kTls;
+    case rtclog2::IceCandidatePairConfig::UNKNOWN_PROTOCOL:
+      return IceCandidatePairProtocol::kUnknown;
+  }
+  return IceCandidatePairProtocol::kUnknown;
+}
+
+IceCandidatePairAddressFamily GetRuntimeIceCandidatePairAddressFamily(
+    rtclog2::IceCandidatePairConfig::AddressFamily address_family) {
+  switch (address_family) {
+    case rtclog2::IceCandidatePairConfig::IPV4:
+      return IceCandidatePairAddressFamily::kIpv4;
+    case rtclog2::IceCandidatePairConfig::IPV6:
+      return IceCandidatePairAddressFamily::kIpv6;
+    case rtclog2::IceCandidatePairConfig::UNKNOWN_ADDRESS_FAMILY:
+      return IceCandidatePairAddressFamily::kUnknown;
+  }
+  return IceCandidatePairAddressFamily::kUnknown;
+}
+
+IceCandidateNetworkType GetRuntimeIceCandidateNetworkType(
+    rtclog2::IceCandidatePairConfig::NetworkType network_type) {
+  switch (network_type) {
+    case rtclog2::IceCandidatePairConfig::ETHERNET:
+      return IceCandidateNetworkType::kEthernet;
+    case rtclog2::IceCandidatePairConfig::LOOPBACK:
+      return IceCandidateNetworkType::kLoopback;
+    case rtclog2::IceCandidatePairConfig::WIFI:
+      return IceCandidateNetworkType::kWifi;
+    case rtclog2::IceCandidatePairConfig::VPN:
+      return IceCandidateNetworkType::kVpn;
+    case rtclog2::IceCandidatePairConfig::CELLULAR:
+      return IceCandidateNetworkType::kCellular;
+    case rtclog2::IceCandidatePairConfig::UNKNOWN_NETWORK_TYPE:
+      return IceCandidateNetworkType::kUnknown;
+  }
+  return IceCandidateNetworkType::kUnknown;
+}
+
+bool GetRuntimeIceCandidatePairEventType(
+    rtclog2::IceCandidatePairEvent::IceCandidatePairEventType proto_type,
+    IceCandidatePairEventType* type) {
+  switch (proto_type) {
+    case rtclog2::IceCandidatePairEvent::CHECK_SENT:
+      *type = IceCandidatePairEventType::kCheckSent;
+      return true;
+    case rtclog2::IceCandidatePairEvent::CHECK_RECEIVED:
+      *type = IceCandidatePairEventType::kCheckReceived;
+      return true;
+    case rtclog2::IceCandidatePairEvent::CHECK_RESPONSE_SENT:
+      *type = IceCandidatePairEventType::kCheckResponseSent;
+      return true;
+    case rtclog2::IceCandidatePairEvent::CHECK_RESPONSE_RECEIVED:
+      *type = IceCandidatePairEventType::kCheckResponseReceived;
+      return true;
+    case rtclog2::IceCandidatePairEvent::UNKNOWN_CHECK_TYPE:
+      return false;
+  }
+  return false;
+}
+
+std::vector<RtpExtension> GetRuntimeRtpHeaderExtensionConfig(
+    const rtclog2::RtpHeaderExtensionConfig& proto_header_extensions) {
+  std::vector<RtpExtension> rtp_extensions;
+  if (proto_header_extensions.has_transmission_time_offset_id()) {
+    rtp_extensions.emplace_back(
+        RtpExtension::kTimestampOffsetUri,
+        proto_header_extensions.transmission_time_offset_id());
+  }
+  if (proto_header_extensions.has_absolute_send_time_id()) {
+    rtp_extensions.emplace_back(
+        RtpExtension::kAbsSendTimeUri,
+        proto_header_extensions.absolute_send_time_id());
+  }
+  if (proto_header_extensions.has_transport_sequence_number_id()) {
+    rtp_extensions.emplace_back(
+        RtpExtension::kTransportSequenceNumberUri,
+        proto_header_extensions.transport_sequence_number_id());
+  }
+  if (proto_header_extensions.has_audio_level_id()) {
+    rtp_extensions.emplace_back(RtpExtension::kAudioLevelUri,
+                                proto_header_extensions.audio_level_id());
+  }
+  if (proto_header_extensions.has_video_rotation_id()) {
+    rtp_extensions.emplace_back(RtpExtension::kVideoRotationUri,
+                                proto_header_extensions.video_rotation_id());
+  }
+  return rtp_extensions;
+}
+
+// Fills |values| with a field of every event in a batch: the first event's,
+// |base|, followed by |number_of_deltas| values decoded from |deltas|.
+bool DecodeBatchField(absl::optional<uint64_t> base,
+                      const std::string& deltas,
+                      size_t number_of_deltas,
+                      std::vector<absl::optional<uint64_t>>* values) {
+  *values = DecodeDeltas(deltas, base, number_of_deltas);
+  if (values->size() != number_of_deltas)
+    return false;
+  values->insert(values->begin(), base);
+  return true;
+}
+
+// As above, for fields that every event has.
+bool DecodeRequiredBatchField(bool has_base,
+                              uint64_t base,
+                              const std::string& deltas,
+                              size_t number_of_deltas,
+                              std::vector<uint64_t>* values) {
+  if (!has_base)
+    return false;
+  std::vector<absl::optional<uint64_t>> optional_values;
+  if (!DecodeBatchField(base, deltas, number_of_deltas, &optional_values))
+    return false;
+  values->clear();
+  values->reserve(optional_values.size());
+  for (const absl::optional<uint64_t>& value : optional_values) {
+    if (!value)
+      return false;
+    values->push_back(*value);
+  }
+  return true;
+}
+
+// Byte strings are written whole; empty |deltas| means all equal |base|.
+bool DecodeBatchBlobs(const std::string& base,
+                      const std::string& deltas,
+                      size_t number_of_deltas,
+                      std::vector<std::string>* values) {
+  if (deltas.empty()) {
+    values->assign(number_of_deltas + 1, base);
+    return true;
+  }
+  *values = DecodeBlobs(deltas, number_of_deltas);
+  if (values->size() != number_of_deltas)
+    return false;
+  values->insert(values->begin(), base);
+  return true;
+}
+
+absl::optional<uint64_t> OptionalField(bool has_value, uint64_t value) {
+  return has_value ? absl::optional<uint64_t>(value) : absl::nullopt;
+}
+
+// Incoming and outgoing packets are logged with the same fields, except for
+// the probe cluster of outgoing ones, which the parser doesn't keep.
+template <typename ProtoType, typename LoggedType>
+bool DecodeRtpPackets(const ProtoType& proto, std::vector<LoggedType>* packets) {
+  const size_t n = proto.number_of_deltas();
+  std::vector<uint64_t> timestamps_ms, markers, payload_types, sequence_numbers,
+      rtp_timestamps, ssrcs, packet_sizes, header_sizes, padding_sizes;
+  std::vector<absl::optional<uint64_t>> transmission_time_offsets,
+      absolute_send_times, transport_sequence_numbers, audio_levels,
+      voice_activities, video_rotations;
+  std::vector<std::string> csrcs;
+  if (!DecodeRequiredBatchField(proto.has_timestamp_ms(), proto.timestamp_ms(),
+                                proto.timestamp_deltas_ms(), n,
+                                &timestamps_ms) ||
+      !DecodeRequiredBatchField(proto.has_marker(), proto.marker(),
+                                proto.marker_deltas(), n, &markers) ||
+      !DecodeRequiredBatchField(proto.has_payload_type(), proto.payload_type(),
+                                proto.payload_type_deltas(), n,
+                                &payload_types) ||
+      !DecodeRequiredBatchField(
+          proto.has_sequence_number(), proto.sequence_number(),
+          proto.sequence_number_deltas(), n, &sequence_numbers) ||
+      !DecodeRequiredBatchField(proto.has_rtp_timestamp(),
+                                proto.rtp_timestamp(),
+                                proto.rtp_timestamp_deltas(), n,
+                                &rtp_timestamps) ||
+      !DecodeRequiredBatchField(proto.has_ssrc(), proto.ssrc(),
+                                proto.ssrc_deltas(), n, &ssrcs) ||
+      !DecodeRequiredBatchField(proto.has_packet_size(), proto.packet_size(),
+                                proto.packet_size_deltas(), n,
+                                &packet_sizes) ||
+      !DecodeRequiredBatchField(proto.has_header_size(), proto.header_size(),
+                                proto.header_size_deltas(), n,
+                                &header_sizes) ||
+      !DecodeRequiredBatchField(proto.has_padding_size(),
+                                proto.padding_size(),
+                                proto.padding_size_deltas(), n,
+                                &padding_sizes) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_transmission_time_offset(),
+                        static_cast<uint32_t>(
+                            proto.transmission_time_offset())),
+          proto.transmission_time_offset_deltas(), n,
+          &transmission_time_offsets) ||
+      !DecodeBatchField(OptionalField(proto.has_absolute_send_time(),
+                                      proto.absolute_send_time()),
+                        proto.absolute_send_time_deltas(), n,
+                        &absolute_send_times) ||
+      !DecodeBatchField(OptionalField(proto.has_transport_sequence_number(),
+                                      proto.transport_sequence_number()),
+                        proto.transport_sequence_number_deltas(), n,
+                        &transport_sequence_numbers) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_audio_level(), proto.audio_level()),
+          proto.audio_level_deltas(), n, &audio_levels) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_voice_activity(), proto.voice_activity()),
+          proto.voice_activity_deltas(), n, &voice_activities) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_video_rotation(), proto.video_rotation()),
+          proto.video_rotation_deltas(), n, &video_rotations) ||
+      !DecodeBatchBlobs(proto.csrcs(), proto.csrcs_deltas(), n, &csrcs)) {
+    return false;
+  }
+
+  packets->reserve(packets->size() + n + 1);
+  for (size_t i = 0; i <= n; ++i) {
+    RTPHeader header;
+    header.markerBit = markers[i] != 0;
+    header.payloadType = static_cast<uint8_t>(payload_types[i]);
+    header.sequenceNumber = static_cast<uint16_t>(sequence_numbers[i]);
+    header.timestamp = static_cast<uint32_t>(rtp_timestamps[i]);
+    header.ssrc = static_cast<uint32_t>(ssrcs[i]);
+    if (csrcs[i].size() % 4 != 0 || csrcs[i].size() / 4 > kRtpCsrcSize)
+      return false;
+    header.numCSRCs = csrcs[i].size() / 4;
+    for (size_t j = 0; j < header.numCSRCs; ++j) {
+      header.arrOfCSRCs[j] = ByteReader<uint32_t>::ReadBigEndian(
+          reinterpret_cast<const uint8_t*>(&csrcs[i][4 * j]));
+    }
+    header.paddingLength = padding_sizes[i];
+    header.headerLength = header_sizes[i];
+    if (transmission_time_offsets[i]) {
+      header.extension.hasTransmissionTimeOffset = true;
+      header.extension.transmissionTimeOffset =
+          static_cast<int32_t>(*transmission_time_offsets[i]);
+    }
+    if (absolute_send_times[i]) {
+      header.extension.hasAbsoluteSendTime = true;
+      header.extension.absoluteSendTime =
+          static_cast<uint32_t>(*absolute_send_times[i]);
+    }
+    if (transport_sequence_numbers[i]) {
+      header.extension.hasTransportSequenceNumber = true;
+      header.extension.transportSequenceNumber =
+          static_cast<uint16_t>(*transport_sequence_numbers[i]);
+    }
+    if (audio_levels[i]) {
+      header.extension.hasAudioLevel = true;
+      header.extension.audioLevel =
+          static_cast<uint8_t>(*audio_levels[i]);
+      header.extension.voiceActivity =
+          voice_activities[i] && *voice_activities[i] != 0;
+    }
+    if (video_rotations[i]) {
+      header.extension.hasVideoRotation = true;
+      header.extension.videoRotation = ConvertCVOByteToVideoRotation(
+          static_cast<uint8_t>(*video_rotations[i]));
+    }
+    packets->emplace_back(timestamps_ms[i] * 1000, header, header_sizes[i],
+                          packet_sizes[i]);
+  }
+  return true;
+}
+
+template <typename ProtoType>
+bool DecodeRtcpPackets(const ProtoType& proto,
+                       std::vector<uint64_t>* timestamps_ms,
+                       std::vector<std::string>* packets) {
+  const size_t n = proto.number_of_deltas();
+  if (!proto.has_raw_packet() ||
+      !DecodeRequiredBatchField(proto.has_timestamp_ms(), proto.timestamp_ms(),
+                                proto.timestamp_deltas_ms(), n,
+                                timestamps_ms)) {
+    return false;
+  }
+  if (n == 0) {
+    packets->assign(1, proto.raw_packet());
+    return true;
+  }
+  *packets = DecodeBlobs(proto.raw_packet_deltas(), n);
+  if (packets->size() != n)
+    return false;
+  packets->insert(packets->begin(), proto.raw_packet());
+  return true;
+}
+
 }  // namespace
 
 LoggedRtcpPacket::LoggedRtcpPacket(uint64_t timestamp_us,
@@ -328,9 +673,11 @@ ParsedRtcEventLogNew::GetDefaultHeaderExtensionMap() {
 }
 
 ParsedRtcEventLogNew::ParsedRtcEventLogNew(
-    UnconfiguredHeaderExtensions parse_unconfigured_header_extensions)
+    UnconfiguredHeaderExtensions parse_unconfigured_header_extensions,
+    RawEvents raw_events)
     : parse_unconfigured_header_extensions_(
-          parse_unconfigured_header_extensions) {
+          parse_unconfigured_header_extensions),
+      raw_events_(raw_events) {
   Clear();
 }
 
@@ -394,28 +741,30 @@ void ParsedRtcEventLogNew::Clear() {
 }
 
 bool ParsedRtcEventLogNew::ParseFile(const std::string& filename) {
-  std::ifstream file(  // no-presubmit-check TODO(webrtc:8982)
-      filename, std::ios_base::in | std::ios_base::binary);
-  if (!file.good() || !file.is_open()) {
-    RTC_LOG(LS_WARNING) << "Could not open file for reading.";
+  std::unique_ptr<RtcEventLogReader> reader =
+      RtcEventLogReader::CreateFromFile(filename);
+  if (!reader)
     return false;
-  }
-
-  return ParseStream(file);
+  return ParseReader(reader.get());
 }
 
 bool ParsedRtcEventLogNew::ParseString(const std::string& s) {
-  std::istringstream stream(  // no-presubmit-check TODO(webrtc:8982)
-      s, std::ios_base::in | std::ios_base::binary);
-  return ParseStream(stream);
+  RtcEventLogReader reader(s.data(), s.size());
+  return ParseReader(&reader);
 }
 
 bool ParsedRtcEventLogNew::ParseStream(
     std::istream& stream) {  // no-presubmit-check TODO(webrtc:8982)
+  const std::string log((std::istreambuf_iterator<char>(stream)),
+                        std::istreambuf_iterator<char>());
+  return ParseString(log);
+}
+
+bool ParsedRtcEventLogNew::ParseReader(RtcEventLogReader* reader) {
   Clear();
-  bool success = ParseStreamInternal(stream);
+  bool success = ParseReaderInternal(reader);
 
-  // ParseStreamInternal stores the RTP packets in a map indexed by SSRC.
+  // ParseReaderInternal stores the RTP packets in a map indexed by SSRC.
   // Since we dont need rapid lookup based on SSRC after parsing, we move the
   // packets_streams from map to vector.
   incoming_rtp_packets_by_ssrc_.reserve(incoming_rtp_packets_map_.size());
@@ -450,67 +799,27 @@ bool ParsedRtcEventLogNew::ParseStream(
   return success;
 }
 
-bool ParsedRtcEventLogNew::ParseStreamInternal(
-    std::istream& stream) {  // no-presubmit-check TODO(webrtc:8982)
-  const size_t kMaxEventSize = (1u << 16) - 1;
-  std::vector<char> tmp_buffer(kMaxEventSize);
-  uint64_t tag;
-  uint64_t message_length;
-  bool success;
-
-  RTC_DCHECK(stream.good());
-
-  while (1) {
-    // Check whether we have reached end of file.
-    stream.peek();
-    if (stream.eof()) {
-      break;
-    }
-
-    // Read the next message tag. The tag number is defined as
-    // (fieldnumber << 3) | wire_type. In our case, the field number is
-    // supposed to be 1 and the wire type for an
-    // length-delimited field is 2.
-    const uint64_t kExpectedTag = (1 << 3) | 2;
-    std::tie(tag, success) = ParseVarInt(stream);
-    if (!success) {
-      RTC_LOG(LS_WARNING)
-          << "Missing field tag from beginning of protobuf event.";
-      return false;
-    } else if (tag != kExpectedTag) {
-      RTC_LOG(LS_WARNING)
-          << "Unexpected field tag at beginning of protobuf event.";
-      return false;
-    }
-
-    // Read the length field.
-    std::tie(message_length, success) = ParseVarInt(stream);
-    if (!success) {
-      RTC_LOG(LS_WARNING) << "Missing message length after protobuf field tag.";
-      return false;
-    } else if (message_length > kMaxEventSize) {
-      RTC_LOG(LS_WARNING) << "Protobuf message length is too large.";
-      return false;
+bool ParsedRtcEventLogNew::ParseReaderInternal(RtcEventLogReader* reader) {
+  RtcEventLogReader::Result result;
+  while ((result = reader->ReadNext()) == RtcEventLogReader::kRecord) {
+    if (!reader->is_new_format()) {
+      StoreParsedEvent(reader->legacy_event());
+      if (raw_events_ == RawEvents::kKeep)
+        events_.push_back(reader->legacy_event());
+      continue;
     }
-
-    // Read the next protobuf event to a temporary char buffer.
-    stream.read(tmp_buffer.data(), message_length);
-    if (stream.gcount() != static_cast<int>(message_length)) {
-      RTC_LOG(LS_WARNING) << "Failed to read protobuf message from file.";
+    const rtclog2::EventStream& batch = reader->batch();
+    if (batch.has_version() && batch.version() != 2) {
+      RTC_LOG(LS_WARNING) << "Unsupported event log version "
+                          << batch.version() << ".";
       return false;
     }
-
-    // Parse the protobuf event from the buffer.
-    rtclog::Event event;
-    if (!event.ParseFromArray(tmp_buffer.data(), message_length)) {
-      RTC_LOG(LS_WARNING) << "Failed to parse protobuf message.";
+    if (!StoreParsedNewFormatEvent(batch)) {
+      RTC_LOG(LS_WARNING) << "Malformed event in the new log format.";
       return false;
     }
-
-    StoreParsedEvent(event);
-    events_.push_back(event);
   }
-  return true;
+  return result == RtcEventLogReader::kEndOfLog;
 }
 
 void ParsedRtcEventLogNew::StoreParsedEvent(const rtclog::Event& event) {
@@ -528,50 +837,19 @@ void ParsedRtcEventLogNew::StoreParsedEvent(const rtclog::Event& event) {
 
   switch (GetEventType(event)) {
     case ParsedRtcEventLogNew::EventType::VIDEO_RECEIVER_CONFIG_EVENT: {
-      rtclog::StreamConfig config = GetVideoReceiveConfig(event);
-      video_recv_configs_.emplace_back(GetTimestamp(event), config);
-      incoming_rtp_extensions_maps_[config.remote_ssrc] =
-          RtpHeaderExtensionMap(config.rtp_extensions);
-      // TODO(terelius): I don't understand the reason for configuring header
-      // extensions for the local SSRC. I think it should be removed, but for
-      // now I want to preserve the previous functionality.
-      incoming_rtp_extensions_maps_[config.local_ssrc] =
-          RtpHeaderExtensionMap(config.rtp_extensions);
-      incoming_video_ssrcs_.insert(config.remote_ssrc);
-      incoming_video_ssrcs_.insert(config.rtx_ssrc);
-      incoming_rtx_ssrcs_.insert(config.rtx_ssrc);
+      StoreVideoRecvConfig(GetTimestamp(event), GetVideoReceiveConfig(event));
       break;
     }
     case ParsedRtcEventLogNew::EventType::VIDEO_SENDER_CONFIG_EVENT: {
-      std::vector<rtclog::StreamConfig> configs = GetVideoSendConfig(event);
-      video_send_configs_.emplace_back(GetTimestamp(event), configs);
-      for (const auto& config : configs) {
-        outgoing_rtp_extensions_maps_[config.local_ssrc] =
-            RtpHeaderExtensionMap(config.rtp_extensions);
-        outgoing_rtp_extensions_maps_[config.rtx_ssrc] =
-            RtpHeaderExtensionMap(config.rtp_extensions);
-        outgoing_video_ssrcs_.insert(config.local_ssrc);
-        outgoing_video_ssrcs_.insert(config.rtx_ssrc);
-        outgoing_rtx_ssrcs_.insert(config.rtx_ssrc);
-      }
+      StoreVideoSendConfig(GetTimestamp(event), GetVideoSendConfig(event));
       break;
     }
     case ParsedRtcEventLogNew::EventType::AUDIO_RECEIVER_CONFIG_EVENT: {
-      rtclog::StreamConfig config = GetAudioReceiveConfig(event);
-      audio_recv_configs_.emplace_back(GetTimestamp(event), config);
-      incoming_rtp_extensions_maps_[config.remote_ssrc] =
-          RtpHeaderExtensionMap(config.rtp_extensions);
-      incoming_rtp_extensions_maps_[config.local_ssrc] =
-          RtpHeaderExtensionMap(config.rtp_extensions);
-      incoming_audio_ssrcs_.insert(config.remote_ssrc);
+      StoreAudioRecvConfig(GetTimestamp(event), GetAudioReceiveConfig(event));
       break;
     }
     case ParsedRtcEventLogNew::EventType::AUDIO_SENDER_CONFIG_EVENT: {
-      rtclog::StreamConfig config = GetAudioSendConfig(event);
-      audio_send_configs_.emplace_back(GetTimestamp(event), config);
-      outgoing_rtp_extensions_maps_[config.local_ssrc] =
-          RtpHeaderExtensionMap(config.rtp_extensions);
-      outgoing_audio_ssrcs_.insert(config.local_ssrc);
+      StoreAudioSendConfig(GetTimestamp(event), GetAudioSendConfig(event));
       break;
     }
     case ParsedRtcEventLogNew::EventType::RTP_EVENT: {
@@ -622,85 +900,7 @@ void ParsedRtcEventLogNew::StoreParsedEvent(const rtclog::Event& event) {
       uint8_t packet[IP_PACKET_SIZE];
       size_t total_length;
       GetRtcpPacket(event, &direction, packet, &total_length);
-      uint64_t timestamp_us = GetTimestamp(event);
-      RTC_CHECK_LE(total_length, IP_PACKET_SIZE);
-      if (direction == kIncomingPacket) {
-        // Currently incoming RTCP packets are logged twice, both for audio and
-        // video. Only act on one of them. Compare against the previous parsed
-        // incoming RTCP packet.
-        if (total_length == last_incoming_rtcp_packet_length_ &&
-            memcmp(last_incoming_rtcp_packet_, packet, total_length) == 0)
-          break;
-        incoming_rtcp_packets_.push_back(
-            LoggedRtcpPacketIncoming(timestamp_us, packet, total_length));
-        last_incoming_rtcp_packet_length_ = total_length;
-        memcpy(last_incoming_rtcp_packet_, packet, total_length);
-      } else {
-        outgoing_rtcp_packets_.push_back(
-            LoggedRtcpPacketOutgoing(timestamp_us, packet, total_length));
-      }
-      rtcp::CommonHeader header;
-      const uint8_t* packet_end = packet + total_length;
-      for (const uint8_t* block = packet; block < packet_end;
-           block = header.NextPacket()) {
-        RTC_CHECK(header.Parse(block, packet_end - block));
-        if (header.type() == rtcp::TransportFeedback::kPacketType &&
-            header.fmt() == rtcp::TransportFeedback::kFeedbackMessageType) {
-          if (direction == kIncomingPacket) {
-            incoming_transport_feedback_.emplace_back();
-            LoggedRtcpPacketTransportFeedback& parsed_block =
-                incoming_transport_feedback_.back();
-            parsed_block.timestamp_us = GetTimestamp(event);
-            if (!parsed_block.transport_feedback.Parse(header))
-              incoming_transport_feedback_.pop_back();
-          } else {
-            outgoing_transport_feedback_.emplace_back();
-            LoggedRtcpPacketTransportFeedback& parsed_block =
-                outgoing_transport_feedback_.back();
-            parsed_block.timestamp_us = GetTimestamp(event);
-            if (!parsed_block.transport_feedback.Parse(header))
-              outgoing_transport_feedback_.pop_back();
-          }
-        } else if (header.type() == rtcp::SenderReport::kPacketType) {
-          LoggedRtcpPacketSenderReport parsed_block;
-          parsed_block.timestamp_us = GetTimestamp(event);
-          if (parsed_block.sr.Parse(header)) {
-            if (direction == kIncomingPacket)
-              incoming_sr_.push_back(std::move(parsed_block));
-            else
-              outgoing_sr_.push_back(std::move(parsed_block));
-          }
-        } else if (header.type() == rtcp::ReceiverReport::kPacketType) {
-          LoggedRtcpPacketReceiverReport parsed_block;
-          parsed_block.timestamp_us = GetTimestamp(event);
-          if (parsed_block.rr.Parse(header)) {
-            if (direction == kIncomingPacket)
-              incoming_rr_.push_back(std::move(parsed_block));
-            else
-              outgoing_rr_.push_back(std::move(parsed_block));
-          }
-        } else if (header.type() == rtcp::Remb::kPacketType &&
-                   header.fmt() == rtcp::Remb::kFeedbackMessageType) {
-          LoggedRtcpPacketRemb parsed_block;
-          parsed_block.timestamp_us = GetTimestamp(event);
-          if (parsed_block.remb.Parse(header)) {
-            if (direction == kIncomingPacket)
-              incoming_remb_.push_back(std::move(parsed_block));
-            else
-              outgoing_remb_.push_back(std::move(parsed_block));
-          }
-        } else if (header.type() == rtcp::Nack::kPacketType &&
-                   header.fmt() == rtcp::Nack::kFeedbackMessageType) {
-          LoggedRtcpPacketNack parsed_block;
-          parsed_block.timestamp_us = GetTimestamp(event);
-          if (parsed_block.nack.Parse(header)) {
-            if (direction == kIncomingPacket)
-              incoming_nack_.push_back(std::move(parsed_block));
-            else
-              outgoing_nack_.push_back(std::move(parsed_block));
-          }
-        }
-      }
+      StoreRtcpPacket(GetTimestamp(event), direction, packet, total_length);
       break;
     }
     case ParsedRtcEventLogNew::EventType::LOG_START: {
@@ -761,6 +961,631 @@ void ParsedRtcEventLogNew::StoreParsedEvent(const rtclog::Event& event) {
   }
 }
 
+void ParsedRtcEventLogNew::StoreVideoRecvConfig(
+    int64_t timestamp_us,
+    const rtclog::StreamConfig& config) {
+  video_recv_configs_.emplace_back(timestamp_us, config);
+  incoming_rtp_extensions_maps_[config.remote_ssrc] =
+      RtpHeaderExtensionMap(config.rtp_extensions);
+  // TODO(terelius): I don't understand the reason for configuring header
+  // extensions for the local SSRC. I think it should be removed, but for
+  // now I want to preserve the previous functionality.
+  incoming_rtp_extensions_maps_[config.local_ssrc] =
+      RtpHeaderExtensionMap(config.rtp_extensions);
+  incoming_video_ssrcs_.insert(config.remote_ssrc);
+  incoming_video_ssrcs_.insert(config.rtx_ssrc);
+  incoming_rtx_ssrcs_.insert(config.rtx_ssrc);
+}
+
+void ParsedRtcEventLogNew::StoreVideoSendConfig(
+    int64_t timestamp_us,
+    const std::vector<rtclog::StreamConfig>& configs) {
+  video_send_configs_.emplace_back(timestamp_us, configs);
+  for (const auto& config : configs) {
+    outgoing_rtp_extensions_maps_[config.local_ssrc] =
+        RtpHeaderExtensionMap(config.rtp_extensions);
+    outgoing_rtp_extensions_maps_[config.rtx_ssrc] =
+        RtpHeaderExtensionMap(config.rtp_extensions);
+    outgoing_video_ssrcs_.insert(config.local_ssrc);
+    outgoing_video_ssrcs_.insert(config.rtx_ssrc);
+    outgoing_rtx_ssrcs_.insert(config.rtx_ssrc);
+  }
+}
+
+void ParsedRtcEventLogNew::StoreAudioRecvConfig(
+    int64_t timestamp_us,
+    const rtclog::StreamConfig& config) {
+  audio_recv_configs_.emplace_back(timestamp_us, config);
+  incoming_rtp_extensions_maps_[config.remote_ssrc] =
+      RtpHeaderExtensionMap(config.rtp_extensions);
+  incoming_rtp_extensions_maps_[config.local_ssrc] =
+      RtpHeaderExtensionMap(config.rtp_extensions);
+  incoming_audio_ssrcs_.insert(config.remote_ssrc);
+}
+
+void ParsedRtcEventLogNew::StoreAudioSendConfig(
+    int64_t timestamp_us,
+    const rtclog::StreamConfig& config) {
+  audio_send_configs_.emplace_back(timestamp_us, config);
+  outgoing_rtp_extensions_maps_[config.local_ssrc] =
+      RtpHeaderExtensionMap(config.rtp_extensions);
+  outgoing_audio_ssrcs_.insert(config.local_ssrc);
+}
+
+void ParsedRtcEventLogNew::StoreRtcpPacket(int64_t timestamp_us,
+                                           PacketDirection direction,
+                                           const uint8_t* packet,
+                                           size_t total_length) {
+  RTC_CHECK_LE(total_length, IP_PACKET_SIZE);
+  if (direction == kIncomingPacket) {
+    // Currently incoming RTCP packets are logged twice, both for audio and
+    // video. Only act on one of them. Compare against the previous parsed
+    // incoming RTCP packet.
+    if (total_length == last_incoming_rtcp_packet_length_ &&
+        memcmp(last_incoming_rtcp_packet_, packet, total_length) == 0)
+      return;
+    incoming_rtcp_packets_.push_back(
+        LoggedRtcpPacketIncoming(timestamp_us, packet, total_length));
+    last_incoming_rtcp_packet_length_ = total_length;
+    memcpy(last_incoming_rtcp_packet_, packet, total_length);
+  } else {
+    outgoing_rtcp_packets_.push_back(
+        LoggedRtcpPacketOutgoing(timestamp_us, packet, total_length));
+  }
+  rtcp::CommonHeader header;
+  const uint8_t* packet_end = packet + total_length;
+  for (const uint8_t* block = packet; block < packet_end;
+       block = header.NextPacket()) {
+    RTC_CHECK(header.Parse(block, packet_end - block));
+    if (header.type() == rtcp::TransportFeedback::kPacketType &&
+        header.fmt() == rtcp::TransportFeedback::kFeedbackMessageType) {
+      if (direction == kIncomingPacket) {
+        incoming_transport_feedback_.emplace_back();
+        LoggedRtcpPacketTransportFeedback& parsed_block =
+            incoming_transport_feedback_.back();
+        parsed_block.timestamp_us = timestamp_us;
+        if (!parsed_block.transport_feedback.Parse(header))
+          incoming_transport_feedback_.pop_back();
+      } else {
+        outgoing_transport_feedback_.emplace_back();
+        LoggedRtcpPacketTransportFeedback& parsed_block =
+            outgoing_transport_feedback_.back();
+        parsed_block.timestamp_us = timestamp_us;
+        if (!parsed_block.transport_feedback.Parse(header))
+          outgoing_transport_feedback_.pop_back();
+      }
+    } else if (header.type() == rtcp::SenderReport::kPacketType) {
+      LoggedRtcpPacketSenderReport parsed_block;
+      parsed_block.timestamp_us = timestamp_us;
+      if (parsed_block.sr.Parse(header)) {
+        if (direction == kIncomingPacket)
+          incoming_sr_.push_back(std::move(parsed_block));
+        else
+          outgoing_sr_.push_back(std::move(parsed_block));
+      }
+    } else if (header.type() == rtcp::ReceiverReport::kPacketType) {
+      LoggedRtcpPacketReceiverReport parsed_block;
+      parsed_block.timestamp_us = timestamp_us;
+      if (parsed_block.rr.Parse(header)) {
+        if (direction == kIncomingPacket)
+          incoming_rr_.push_back(std::move(parsed_block));
+        else
+          outgoing_rr_.push_back(std::move(parsed_block));
+      }
+    } else if (header.type() == rtcp::Remb::kPacketType &&
+               header.fmt() == rtcp::Remb::kFeedbackMessageType) {
+      LoggedRtcpPacketRemb parsed_block;
+      parsed_block.timestamp_us = timestamp_us;
+      if (parsed_block.remb.Parse(header)) {
+        if (direction == kIncomingPacket)
+          incoming_remb_.push_back(std::move(parsed_block));
+        else
+          outgoing_remb_.push_back(std::move(parsed_block));
+      }
+    } else if (header.type() == rtcp::Nack::kPacketType &&
+               header.fmt() == rtcp::Nack::kFeedbackMessageType) {
+      LoggedRtcpPacketNack parsed_block;
+      parsed_block.timestamp_us = timestamp_us;
+      if (parsed_block.nack.Parse(header)) {
+        if (direction == kIncomingPacket)
+          incoming_nack_.push_back(std::move(parsed_block));
+        else
+          outgoing_nack_.push_back(std::move(parsed_block));
+      }
+    }
+  }
+}
+
+void ParsedRtcEventLogNew::UpdateFirstAndLastTimestamp(int64_t timestamp_us) {
+  first_timestamp_ = std::min(first_timestamp_, timestamp_us);
+  last_timestamp_ = std::max(last_timestamp_, timestamp_us);
+}
+
+bool ParsedRtcEventLogNew::StoreParsedNewFormatEvent(
+    const rtclog2::EventStream& stream) {
+  // Stream configs first, since the packets of a batch may predate the config
+  // that is logged in the same batch.
+  for (const auto& proto : stream.video_recv_stream_configs()) {
+    if (!StoreVideoRecvConfig(proto))
+      return false;
+  }
+  for (const auto& proto : stream.video_send_stream_configs()) {
+    if (!StoreVideoSendConfig(proto))
+      return false;
+  }
+  for (const auto& proto : stream.audio_recv_stream_configs()) {
+    if (!StoreAudioRecvConfig(proto))
+      return false;
+  }
+  for (const auto& proto : stream.audio_send_stream_configs()) {
+    if (!StoreAudioSendConfig(proto))
+      return false;
+  }
+  for (const auto& proto : stream.begin_log_events()) {
+    if (!proto.has_timestamp_ms())
+      return false;
+    start_log_events_.push_back(LoggedStartEvent(proto.timestamp_ms() * 1000));
+  }
+  for (const auto& proto : stream.end_log_events()) {
+    if (!proto.has_timestamp_ms())
+      return false;
+    stop_log_events_.push_back(LoggedStopEvent(proto.timestamp_ms() * 1000));
+  }
+  for (const auto& proto : stream.incoming_rtp_packets()) {
+    if (!StoreIncomingRtpPackets(proto))
+      return false;
+  }
+  for (const auto& proto : stream.outgoing_rtp_packets()) {
+    if (!StoreOutgoingRtpPackets(proto))
+      return false;
+  }
+  for (const auto& proto : stream.incoming_rtcp_packets()) {
+    if (!StoreIncomingRtcpPackets(proto))
+      return false;
+  }
+  for (const auto& proto : stream.outgoing_rtcp_packets()) {
+    if (!StoreOutgoingRtcpPackets(proto))
+      return false;
+  }
+  for (const auto& proto : stream.audio_playout_events()) {
+    if (!StoreAudioPlayoutEvents(proto))
+      return false;
+  }
+  for (const auto& proto : stream.loss_based_bwe_updates()) {
+    if (!StoreLossBasedBweUpdates(proto))
+      return false;
+  }
+  for (const auto& proto : stream.delay_based_bwe_updates()) {
+    if (!StoreDelayBasedBweUpdates(proto))
+      return false;
+  }
+  for (const auto& proto : stream.audio_network_adaptations()) {
+    if (!StoreAudioNetworkAdaptations(proto))
+      return false;
+  }
+  for (const auto& proto : stream.probe_clusters()) {
+    if (!StoreBweProbeClusterCreated(proto))
+      return false;
+  }
+  for (const auto& proto : stream.probe_success()) {
+    if (!StoreBweProbeSuccess(proto))
+      return false;
+  }
+  for (const auto& proto : stream.probe_failure()) {
+    if (!StoreBweProbeFailure(proto))
+      return false;
+  }
+  for (const auto& proto : stream.alr_states()) {
+    if (!StoreAlrState(proto))
+      return false;
+  }
+  for (const auto& proto : stream.ice_candidate_configs()) {
+    if (!StoreIceCandidatePairConfig(proto))
+      return false;
+  }
+  for (const auto& proto : stream.ice_candidate_events()) {
+    if (!StoreIceCandidatePairEvents(proto))
+      return false;
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreIncomingRtpPackets(
+    const rtclog2::IncomingRtpPackets& proto) {
+  std::vector<LoggedRtpPacketIncoming> packets;
+  if (!DecodeRtpPackets(proto, &packets))
+    return false;
+  for (const LoggedRtpPacketIncoming& packet : packets) {
+    UpdateFirstAndLastTimestamp(packet.log_time_us());
+    incoming_rtp_packets_map_[packet.rtp.header.ssrc].push_back(packet);
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreOutgoingRtpPackets(
+    const rtclog2::OutgoingRtpPackets& proto) {
+  std::vector<LoggedRtpPacketOutgoing> packets;
+  if (!DecodeRtpPackets(proto, &packets))
+    return false;
+  for (const LoggedRtpPacketOutgoing& packet : packets) {
+    UpdateFirstAndLastTimestamp(packet.log_time_us());
+    outgoing_rtp_packets_map_[packet.rtp.header.ssrc].push_back(packet);
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreIncomingRtcpPackets(
+    const rtclog2::IncomingRtcpPackets& proto) {
+  std::vector<uint64_t> timestamps_ms;
+  std::vector<std::string> packets;
+  if (!DecodeRtcpPackets(proto, &timestamps_ms, &packets))
+    return false;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    if (packets[i].size() > IP_PACKET_SIZE)
+      return false;
+    UpdateFirstAndLastTimestamp(timestamps_ms[i] * 1000);
+    StoreRtcpPacket(timestamps_ms[i] * 1000, kIncomingPacket,
+                    reinterpret_cast<const uint8_t*>(packets[i].data()),
+                    packets[i].size());
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreOutgoingRtcpPackets(
+    const rtclog2::OutgoingRtcpPackets& proto) {
+  std::vector<uint64_t> timestamps_ms;
+  std::vector<std::string> packets;
+  if (!DecodeRtcpPackets(proto, &timestamps_ms, &packets))
+    return false;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    if (packets[i].size() > IP_PACKET_SIZE)
+      return false;
+    UpdateFirstAndLastTimestamp(timestamps_ms[i] * 1000);
+    StoreRtcpPacket(timestamps_ms[i] * 1000, kOutgoingPacket,
+                    reinterpret_cast<const uint8_t*>(packets[i].data()),
+                    packets[i].size());
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreAudioPlayoutEvents(
+    const rtclog2::AudioPlayoutEvents& proto) {
+  const size_t n = proto.number_of_deltas();
+  std::vector<uint64_t> timestamps_ms, local_ssrcs;
+  if (!DecodeRequiredBatchField(proto.has_timestamp_ms(), proto.timestamp_ms(),
+                                proto.timestamp_deltas_ms(), n,
+                                &timestamps_ms) ||
+      !DecodeRequiredBatchField(proto.has_local_ssrc(), proto.local_ssrc(),
+                                proto.local_ssrc_deltas(), n, &local_ssrcs)) {
+    return false;
+  }
+  for (size_t i = 0; i <= n; ++i) {
+    LoggedAudioPlayoutEvent playout_event;
+    playout_event.timestamp_us = timestamps_ms[i] * 1000;
+    playout_event.ssrc = static_cast<uint32_t>(local_ssrcs[i]);
+    UpdateFirstAndLastTimestamp(playout_event.timestamp_us);
+    audio_playout_events_[playout_event.ssrc].push_back(playout_event);
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreLossBasedBweUpdates(
+    const rtclog2::LossBasedBweUpdates& proto) {
+  const size_t n = proto.number_of_deltas();
+  std::vector<uint64_t> timestamps_ms, bitrates_bps, fraction_losses,
+      total_packets;
+  if (!DecodeRequiredBatchField(proto.has_timestamp_ms(), proto.timestamp_ms(),
+                                proto.timestamp_deltas_ms(), n,
+                                &timestamps_ms) ||
+      !DecodeRequiredBatchField(proto.has_bitrate_bps(), proto.bitrate_bps(),
+                                proto.bitrate_deltas_bps(), n,
+                                &bitrates_bps) ||
+      !DecodeRequiredBatchField(proto.has_fraction_loss(),
+                                proto.fraction_loss(),
+                                proto.fraction_loss_deltas(), n,
+                                &fraction_losses) ||
+      !DecodeRequiredBatchField(proto.has_total_packets(),
+                                proto.total_packets(),
+                                proto.total_packets_deltas(), n,
+                                &total_packets)) {
+    return false;
+  }
+  for (size_t i = 0; i <= n; ++i) {
+    LoggedBweLossBasedUpdate bwe_update;
+    bwe_update.timestamp_us = timestamps_ms[i] * 1000;
+    bwe_update.bitrate_bps = static_cast<int32_t>(bitrates_bps[i]);
+    bwe_update.fraction_lost = static_cast<uint8_t>(fraction_losses[i]);
+    bwe_update.expected_packets = static_cast<int32_t>(total_packets[i]);
+    UpdateFirstAndLastTimestamp(bwe_update.timestamp_us);
+    bwe_loss_updates_.push_back(bwe_update);
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreDelayBasedBweUpdates(
+    const rtclog2::DelayBasedBweUpdates& proto) {
+  const size_t n = proto.number_of_deltas();
+  std::vector<uint64_t> timestamps_ms, bitrates_bps, detector_states;
+  if (!DecodeRequiredBatchField(proto.has_timestamp_ms(), proto.timestamp_ms(),
+                                proto.timestamp_deltas_ms(), n,
+                                &timestamps_ms) ||
+      !DecodeRequiredBatchField(proto.has_bitrate_bps(), proto.bitrate_bps(),
+                                proto.bitrate_deltas_bps(), n,
+                                &bitrates_bps) ||
+      !DecodeRequiredBatchField(proto.has_detector_state(),
+                                proto.detector_state(),
+                                proto.detector_state_deltas(), n,
+                                &detector_states)) {
+    return false;
+  }
+  for (size_t i = 0; i <= n; ++i) {
+    if (detector_states[i] > std::numeric_limits<int>::max() ||
+        !rtclog2::DelayBasedBweUpdates::DetectorState_IsValid(
+            static_cast<int>(detector_states[i]))) {
+      return false;
+    }
+    LoggedBweDelayBasedUpdate bwe_update;
+    bwe_update.timestamp_us = timestamps_ms[i] * 1000;
+    bwe_update.bitrate_bps = static_cast<int32_t>(bitrates_bps[i]);
+    bwe_update.detector_state = GetRuntimeDetectorState(
+        static_cast<rtclog2::DelayBasedBweUpdates::DetectorState>(
+            detector_states[i]));
+    UpdateFirstAndLastTimestamp(bwe_update.timestamp_us);
+    bwe_delay_updates_.push_back(bwe_update);
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreAudioNetworkAdaptations(
+    const rtclog2::AudioNetworkAdaptations& proto) {
+  const size_t n = proto.number_of_deltas();
+  std::vector<uint64_t> timestamps_ms;
+  std::vector<absl::optional<uint64_t>> bitrates_bps, frame_lengths_ms,
+      uplink_packet_loss_fractions, enable_fecs, enable_dtxs, num_channels;
+  absl::optional<uint64_t> uplink_packet_loss_fraction_base;
+  if (proto.has_uplink_packet_loss_fraction()) {
+    const float fraction = proto.uplink_packet_loss_fraction();
+    uint32_t bits;
+    memcpy(&bits, &fraction, sizeof(bits));
+    uplink_packet_loss_fraction_base = bits;
+  }
+  if (!DecodeRequiredBatchField(proto.has_timestamp_ms(), proto.timestamp_ms(),
+                                proto.timestamp_deltas_ms(), n,
+                                &timestamps_ms) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_bitrate_bps(),
+                        static_cast<uint32_t>(proto.bitrate_bps())),
+          proto.bitrate_deltas_bps(), n, &bitrates_bps) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_frame_length_ms(),
+                        static_cast<uint32_t>(proto.frame_length_ms())),
+          proto.frame_length_deltas_ms(), n, &frame_lengths_ms) ||
+      !DecodeBatchField(uplink_packet_loss_fraction_base,
+                        proto.uplink_packet_loss_fraction_deltas(), n,
+                        &uplink_packet_loss_fractions) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_enable_fec(), proto.enable_fec()),
+          proto.enable_fec_deltas(), n, &enable_fecs) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_enable_dtx(), proto.enable_dtx()),
+          proto.enable_dtx_deltas(), n, &enable_dtxs) ||
+      !DecodeBatchField(
+          OptionalField(proto.has_num_channels(), proto.num_channels()),
+          proto.num_channels_deltas(), n, &num_channels)) {
+    return false;
+  }
+  for (size_t i = 0; i <= n; ++i) {
+    LoggedAudioNetworkAdaptationEvent ana_event;
+    ana_event.timestamp_us = timestamps_ms[i] * 1000;
+    if (bitrates_bps[i])
+      ana_event.config.bitrate_bps = static_cast<int32_t>(*bitrates_bps[i]);
+    if (frame_lengths_ms[i]) {
+      ana_event.config.frame_length_ms =
+          static_cast<int32_t>(*frame_lengths_ms[i]);
+    }
+    if (uplink_packet_loss_fractions[i]) {
+      const uint32_t bits =
+          static_cast<uint32_t>(*uplink_packet_loss_fractions[i]);
+      float fraction;
+      memcpy(&fraction, &bits, sizeof(fraction));
+      ana_event.config.uplink_packet_loss_fraction = fraction;
+    }
+    if (enable_fecs[i])
+      ana_event.config.enable_fec = *enable_fecs[i] != 0;
+    if (enable_dtxs[i])
+      ana_event.config.enable_dtx = *enable_dtxs[i] != 0;
+    if (num_channels[i])
+      ana_event.config.num_channels = static_cast<size_t>(*num_channels[i]);
+    UpdateFirstAndLastTimestamp(ana_event.timestamp_us);
+    audio_network_adaptation_events_.push_back(ana_event);
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreIceCandidatePairEvents(
+    const rtclog2::IceCandidatePairEvent& proto) {
+  const size_t n = proto.number_of_deltas();
+  std::vector<uint64_t> timestamps_ms, event_types, candidate_pair_ids;
+  if (!DecodeRequiredBatchField(proto.has_timestamp_ms(), proto.timestamp_ms(),
+                                proto.timestamp_deltas_ms(), n,
+                                &timestamps_ms) ||
+      !DecodeRequiredBatchField(proto.has_event_type(), proto.event_type(),
+                                proto.event_type_deltas(), n, &event_types) ||
+      !DecodeRequiredBatchField(proto.has_candidate_pair_id(),
+                                proto.candidate_pair_id(),
+                                proto.candidate_pair_id_deltas(), n,
+                                &candidate_pair_ids)) {
+    return false;
+  }
+  for (size_t i = 0; i <= n; ++i) {
+    LoggedIceCandidatePairEvent ice_event;
+    if (event_types[i] > std::numeric_limits<int>::max() ||
+        !rtclog2::IceCandidatePairEvent::IceCandidatePairEventType_IsValid(
+            static_cast<int>(event_types[i])) ||
+        !GetRuntimeIceCandidatePairEventType(
+            static_cast<rtclog2::IceCandidatePairEvent::IceCandidatePairEventType>(
+                event_types[i]),
+            &ice_event.type)) {
+      return false;
+    }
+    ice_event.timestamp_us = timestamps_ms[i] * 1000;
+    ice_event.candidate_pair_id =
+        static_cast<uint32_t>(candidate_pair_ids[i]);
+    UpdateFirstAndLastTimestamp(ice_event.timestamp_us);
+    ice_candidate_pair_events_.push_back(ice_event);
+  }
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreBweProbeClusterCreated(
+    const rtclog2::BweProbeCluster& proto) {
+  if (!proto.has_timestamp_ms() || !proto.has_id() ||
+      !proto.has_bitrate_bps() || !proto.has_min_packets() ||
+      !proto.has_min_bytes()) {
+    return false;
+  }
+  LoggedBweProbeClusterCreatedEvent probe_cluster;
+  probe_cluster.timestamp_us = proto.timestamp_ms() * 1000;
+  probe_cluster.id = proto.id();
+  probe_cluster.bitrate_bps = proto.bitrate_bps();
+  probe_cluster.min_packets = proto.min_packets();
+  probe_cluster.min_bytes = proto.min_bytes();
+  UpdateFirstAndLastTimestamp(probe_cluster.timestamp_us);
+  bwe_probe_cluster_created_events_.push_back(probe_cluster);
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreBweProbeSuccess(
+    const rtclog2::BweProbeResultSuccess& proto) {
+  if (!proto.has_timestamp_ms() || !proto.has_id() ||
+      !proto.has_bitrate_bps()) {
+    return false;
+  }
+  LoggedBweProbeSuccessEvent probe_result;
+  probe_result.timestamp_us = proto.timestamp_ms() * 1000;
+  probe_result.id = proto.id();
+  probe_result.bitrate_bps = proto.bitrate_bps();
+  UpdateFirstAndLastTimestamp(probe_result.timestamp_us);
+  bwe_probe_success_events_.push_back(probe_result);
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreBweProbeFailure(
+    const rtclog2::BweProbeResultFailure& proto) {
+  LoggedBweProbeFailureEvent probe_result;
+  if (!proto.has_timestamp_ms() || !proto.has_id() ||
+      !GetRuntimeProbeFailureReason(proto.failure(),
+                                    &probe_result.failure_reason)) {
+    return false;
+  }
+  probe_result.timestamp_us = proto.timestamp_ms() * 1000;
+  probe_result.id = proto.id();
+  UpdateFirstAndLastTimestamp(probe_result.timestamp_us);
+  bwe_probe_failure_events_.push_back(probe_result);
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreAlrState(const rtclog2::AlrState& proto) {
+  if (!proto.has_timestamp_ms() || !proto.has_in_alr())
+    return false;
+  LoggedAlrStateEvent alr_event;
+  alr_event.timestamp_us = proto.timestamp_ms() * 1000;
+  alr_event.in_alr = proto.in_alr();
+  UpdateFirstAndLastTimestamp(alr_event.timestamp_us);
+  alr_state_events_.push_back(alr_event);
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreIceCandidatePairConfig(
+    const rtclog2::IceCandidatePairConfig& proto) {
+  LoggedIceCandidatePairConfig ice_config;
+  if (!proto.has_timestamp_ms() || !proto.has_candidate_pair_id() ||
+      !GetRuntimeIceCandidatePairConfigType(proto.config_type(),
+                                            &ice_config.type)) {
+    return false;
+  }
+  ice_config.timestamp_us = proto.timestamp_ms() * 1000;
+  ice_config.candidate_pair_id = proto.candidate_pair_id();
+  ice_config.local_candidate_type =
+      GetRuntimeIceCandidateType(proto.local_candidate_type());
+  ice_config.local_relay_protocol =
+      GetRuntimeIceCandidatePairProtocol(proto.local_relay_protocol());
+  ice_config.local_network_type =
+      GetRuntimeIceCandidateNetworkType(proto.local_network_type());
+  ice_config.local_address_family =
+      GetRuntimeIceCandidatePairAddressFamily(proto.local_address_family());
+  ice_config.remote_candidate_type =
+      GetRuntimeIceCandidateType(proto.remote_candidate_type());
+  ice_config.remote_address_family =
+      GetRuntimeIceCandidatePairAddressFamily(proto.remote_address_family());
+  ice_config.candidate_pair_protocol =
+      GetRuntimeIceCandidatePairProtocol(proto.candidate_pair_protocol());
+  UpdateFirstAndLastTimestamp(ice_config.timestamp_us);
+  ice_candidate_pair_configs_.push_back(ice_config);
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreVideoRecvConfig(
+    const rtclog2::VideoRecvStreamConfig& proto) {
+  if (!proto.has_timestamp_ms() || !proto.has_remote_ssrc() ||
+      !proto.has_local_ssrc()) {
+    return false;
+  }
+  rtclog::StreamConfig config;
+  config.remote_ssrc = proto.remote_ssrc();
+  config.local_ssrc = proto.local_ssrc();
+  config.rtx_ssrc = proto.rtx_ssrc();
+  config.rsid = proto.rsid();
+  config.rtp_extensions =
+      GetRuntimeRtpHeaderExtensionConfig(proto.header_extensions());
+  StoreVideoRecvConfig(proto.timestamp_ms() * 1000, config);
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreVideoSendConfig(
+    const rtclog2::VideoSendStreamConfig& proto) {
+  if (!proto.has_timestamp_ms() || !proto.has_ssrc())
+    return false;
+  rtclog::StreamConfig config;
+  config.local_ssrc = proto.ssrc();
+  config.rtx_ssrc = proto.rtx_ssrc();
+  config.rsid = proto.rsid();
+  config.rtp_extensions =
+      GetRuntimeRtpHeaderExtensionConfig(proto.header_extensions());
+  StoreVideoSendConfig(proto.timestamp_ms() * 1000,
+                       std::vector<rtclog::StreamConfig>(1, config));
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreAudioRecvConfig(
+    const rtclog2::AudioRecvStreamConfig& proto) {
+  if (!proto.has_timestamp_ms() || !proto.has_remote_ssrc() ||
+      !proto.has_local_ssrc()) {
+    return false;
+  }
+  rtclog::StreamConfig config;
+  config.remote_ssrc = proto.remote_ssrc();
+  config.local_ssrc = proto.local_ssrc();
+  config.rsid = proto.rsid();
+  config.rtp_extensions =
+      GetRuntimeRtpHeaderExtensionConfig(proto.header_extensions());
+  StoreAudioRecvConfig(proto.timestamp_ms() * 1000, config);
+  return true;
+}
+
+bool ParsedRtcEventLogNew::StoreAudioSendConfig(
+    const rtclog2::AudioSendStreamConfig& proto) {
+  if (!proto.has_timestamp_ms() || !proto.has_ssrc())
+    return false;
+  rtclog::StreamConfig config;
+  config.local_ssrc = proto.ssrc();
+  config.rsid = proto.rsid();
+  config.rtp_extensions =
+      GetRuntimeRtpHeaderExtensionConfig(proto.header_extensions());
+  StoreAudioSendConfig(proto.timestamp_ms() * 1000, config);
+  return true;
+}
+
 size_t ParsedRtcEventLogNew::GetNumberOfEvents() const {
   return events_.size();
 }
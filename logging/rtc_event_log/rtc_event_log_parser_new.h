@@ -24,6 +24,7 @@
 #include "logging/rtc_event_log/events/rtc_event_ice_candidate_pair_config.h"
 #include "logging/rtc_event_log/events/rtc_event_probe_result_failure.h"
 #include "logging/rtc_event_log/rtc_event_log.h"
+#include "logging/rtc_event_log/rtc_event_log_reader.h"
 #include "logging/rtc_event_log/rtc_stream_config.h"
 #include "modules/audio_coding/audio_network_adaptor/include/audio_network_adaptor.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
@@ -42,6 +43,11 @@ RTC_PUSH_IGNORING_WUNDEF()
 #else
 #include "logging/rtc_event_log/rtc_event_log.pb.h"
 #endif
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/logging/rtc_event_log/rtc_event_log2.pb.h"
+#else
+#include "logging/rtc_event_log/rtc_event_log2.pb.h"
+#endif
 RTC_POP_IGNORING_WUNDEF()
 
 namespace webrtc {
@@ -506,6 +512,11 @@ class ParsedRtcEventLogNew {
     kDontParse,
     kAttemptWebrtcDefaultConfig
   };
+  // Whether the rtclog::Event messages of a legacy log are kept after they
+  // have been parsed, for the index based accessors. Tools that only use the
+  // typed accessors should discard them, since they take more memory than the
+  // parsed events.
+  enum class RawEvents { kKeep, kDiscard };
 
   struct LoggedRtpStreamIncoming {
     LoggedRtpStreamIncoming();
@@ -539,13 +550,16 @@ class ParsedRtcEventLogNew {
 
   explicit ParsedRtcEventLogNew(
       UnconfiguredHeaderExtensions parse_unconfigured_header_extensions =
-          UnconfiguredHeaderExtensions::kDontParse);
+          UnconfiguredHeaderExtensions::kDontParse,
+      RawEvents raw_events = RawEvents::kKeep);
 
   // Clears previously parsed events and resets the ParsedRtcEventLogNew to an
   // empty state.
   void Clear();
 
-  // Reads an RtcEventLog file and returns true if parsing was successful.
+  // Reads an RtcEventLog file and returns true if parsing was successful. The
+  // file is mapped into memory and parsed a record at a time, see
+  // RtcEventLogReader.
   bool ParseFile(const std::string& file_name);
 
   // Reads an RtcEventLog from a string and returns true if successful.
@@ -555,7 +569,12 @@ class ParsedRtcEventLogNew {
   bool ParseStream(
       std::istream& stream);  // no-presubmit-check TODO(webrtc:8982)
 
-  // Returns the number of events in an EventStream.
+  // Reads the RtcEventLog that |reader| reads, from where it is, and returns
+  // true if successful.
+  bool ParseReader(RtcEventLogReader* reader);
+
+  // Returns the number of events in an EventStream, or zero if the events are
+  // discarded, see RawEvents.
   size_t GetNumberOfEvents() const;
 
   // Reads the arrival timestamp (in microseconds) from a rtclog::Event.
@@ -838,11 +857,49 @@ class ParsedRtcEventLogNew {
   int64_t last_timestamp() const { return last_timestamp_; }
 
  private:
-  bool ParseStreamInternal(
-      std::istream& stream);  // no-presubmit-check TODO(webrtc:8982)
+  bool ParseReaderInternal(RtcEventLogReader* reader);
 
   void StoreParsedEvent(const rtclog::Event& event);
 
+  // Shared by both formats.
+  void StoreVideoRecvConfig(int64_t timestamp_us,
+                            const rtclog::StreamConfig& config);
+  void StoreVideoSendConfig(int64_t timestamp_us,
+                            const std::vector<rtclog::StreamConfig>& configs);
+  void StoreAudioRecvConfig(int64_t timestamp_us,
+                            const rtclog::StreamConfig& config);
+  void StoreAudioSendConfig(int64_t timestamp_us,
+                            const rtclog::StreamConfig& config);
+  void StoreRtcpPacket(int64_t timestamp_us,
+                       PacketDirection direction,
+                       const uint8_t* packet,
+                       size_t total_length);
+  void UpdateFirstAndLastTimestamp(int64_t timestamp_us);
+
+  // The rtclog2 format, in which the events are batched and delta encoded.
+  // These return false if the log is malformed. The parsed events are only
+  // available through the typed accessors, not through the index based ones.
+  bool StoreParsedNewFormatEvent(const rtclog2::EventStream& stream);
+  bool StoreIncomingRtpPackets(const rtclog2::IncomingRtpPackets& proto);
+  bool StoreOutgoingRtpPackets(const rtclog2::OutgoingRtpPackets& proto);
+  bool StoreIncomingRtcpPackets(const rtclog2::IncomingRtcpPackets& proto);
+  bool StoreOutgoingRtcpPackets(const rtclog2::OutgoingRtcpPackets& proto);
+  bool StoreAudioPlayoutEvents(const rtclog2::AudioPlayoutEvents& proto);
+  bool StoreLossBasedBweUpdates(const rtclog2::LossBasedBweUpdates& proto);
+  bool StoreDelayBasedBweUpdates(const rtclog2::DelayBasedBweUpdates& proto);
+  bool StoreAudioNetworkAdaptations(
+      const rtclog2::AudioNetworkAdaptations& proto);
+  bool StoreIceCandidatePairEvents(const rtclog2::IceCandidatePairEvent& proto);
+  bool StoreBweProbeClusterCreated(const rtclog2::BweProbeCluster& proto);
+  bool StoreBweProbeSuccess(const rtclog2::BweProbeResultSuccess& proto);
+  bool StoreBweProbeFailure(const rtclog2::BweProbeResultFailure& proto);
+  bool StoreAlrState(const rtclog2::AlrState& proto);
+  bool StoreIceCandidatePairConfig(const rtclog2::IceCandidatePairConfig& proto);
+  bool StoreVideoRecvConfig(const rtclog2::VideoRecvStreamConfig& proto);
+  bool StoreVideoSendConfig(const rtclog2::VideoSendStreamConfig& proto);
+  bool StoreAudioRecvConfig(const rtclog2::AudioRecvStreamConfig& proto);
+  bool StoreAudioSendConfig(const rtclog2::AudioSendStreamConfig& proto);
+
   rtclog::StreamConfig GetVideoReceiveConfig(const rtclog::Event& event) const;
   std::vector<rtclog::StreamConfig> GetVideoSendConfig(
       const rtclog::Event& event) const;
@@ -891,6 +948,7 @@ class ParsedRtcEventLogNew {
   };
 
   const UnconfiguredHeaderExtensions parse_unconfigured_header_extensions_;
+  const RawEvents raw_events_;
 
   // Make a default extension map for streams without configuration information.
   // TODO(ivoc): Once configuration of audio streams is stored in the event log,
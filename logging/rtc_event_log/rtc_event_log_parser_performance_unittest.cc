@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "api/rtpparameters.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
+#include "logging/rtc_event_log/events/rtc_event_bwe_update_delay_based.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_incoming.h"
+#include "logging/rtc_event_log/events/rtc_event_rtp_packet_outgoing.h"
+#include "logging/rtc_event_log/rtc_event_log_parser_new.h"
+#include "logging/rtc_event_log/rtc_event_log_reader.h"
+#include "modules/remote_bitrate_estimator/include/bwe_defines.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/fileutils.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kCallDurationMs = 120000;
+constexpr int kBatchDurationMs = 1000;
+constexpr uint32_t kVideoSsrc = 0x1234;
+constexpr uint32_t kAudioSsrc = 0x5678;
+
+// Encodes a call that sends a video packet every millisecond and receives an
+// audio packet every 20 ms, a second at a time, as RtcEventLogImpl would.
+std::string EncodeCall(RtcEventLogEncoder* encoder) {
+  rtc::ScopedFakeClock clock;
+  // The parser assumes the default extension IDs for unconfigured streams.
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<TransportSequenceNumber>(
+      RtpExtension::kTransportSequenceNumberDefaultId);
+  extensions.Register<AbsoluteSendTime>(RtpExtension::kAbsSendTimeDefaultId);
+  uint16_t sequence_number = 0;
+
+  int64_t time_ms = 1;
+  clock.SetTimeMicros(time_ms * 1000);
+  std::string log = encoder->EncodeLogStart(rtc::TimeMicros());
+  while (time_ms <= kCallDurationMs) {
+    std::deque<std::unique_ptr<RtcEvent>> batch;
+    for (int i = 0; i < kBatchDurationMs; ++i, ++time_ms) {
+      clock.SetTimeMicros(time_ms * 1000);
+      RtpPacketToSend video_packet(&extensions);
+      video_packet.SetPayloadType(96);
+      video_packet.SetSequenceNumber(sequence_number);
+      video_packet.SetTimestamp(90 * (time_ms - time_ms % 33));
+      video_packet.SetSsrc(kVideoSsrc);
+      video_packet.SetExtension<TransportSequenceNumber>(sequence_number++);
+      video_packet.SetExtension<AbsoluteSendTime>(
+          AbsoluteSendTime::MsTo24Bits(time_ms));
+      video_packet.SetPayloadSize(1100);
+      batch.push_back(absl::make_unique<RtcEventRtpPacketOutgoing>(
+          video_packet, PacedPacketInfo::kNotAProbe));
+      if (time_ms % 20 == 0) {
+        RtpPacketReceived audio_packet(&extensions);
+        audio_packet.SetPayloadType(111);
+        audio_packet.SetSequenceNumber(time_ms / 20);
+        audio_packet.SetTimestamp(48 * time_ms);
+        audio_packet.SetSsrc(kAudioSsrc);
+        audio_packet.SetPayloadSize(80);
+        batch.push_back(
+            absl::make_unique<RtcEventRtpPacketIncoming>(audio_packet));
+        batch.push_back(absl::make_unique<RtcEventAudioPlayout>(kAudioSsrc));
+      }
+      if (time_ms % 25 == 0) {
+        batch.push_back(absl::make_unique<RtcEventBweUpdateDelayBased>(
+            1000000 + 100 * (time_ms % 1000), BandwidthUsage::kBwNormal));
+      }
+    }
+    log += encoder->EncodeBatch(batch.begin(), batch.end());
+  }
+  return log + encoder->EncodeLogEnd(rtc::TimeMicros());
+}
+
+void ReportThroughput(const std::string& measurement,
+                      const std::string& trace,
+                      size_t num_bytes,
+                      int64_t elapsed_ns) {
+  test::PrintResult(measurement, "", trace,
+                    num_bytes * 1000.0 / std::max<int64_t>(elapsed_ns, 1),
+                    "MB/s", true);
+}
+
+void MeasureParsing(const std::string& trace, RtcEventLogEncoder* encoder) {
+  const std::string log = EncodeCall(encoder);
+  const std::string file_name =
+      test::OutputPath() + "RtcEventLogParserPerformanceTest_" + trace;
+  FILE* file = fopen(file_name.c_str(), "wb");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(fwrite(log.data(), 1, log.size(), file), log.size());
+  fclose(file);
+
+  // Reading alone, which bounds what a streaming tool can do.
+  int64_t start_ns = rtc::TimeNanos();
+  std::unique_ptr<RtcEventLogReader> reader =
+      RtcEventLogReader::CreateFromFile(file_name);
+  ASSERT_TRUE(reader);
+  RtcEventLogReader::Result result;
+  while ((result = reader->ReadNext()) == RtcEventLogReader::kRecord) {
+  }
+  ReportThroughput("rtc_event_log_read", trace, log.size(),
+                   rtc::TimeNanos() - start_ns);
+  EXPECT_EQ(result, RtcEventLogReader::kEndOfLog);
+
+  // Reading and storing the parsed events, as the analysis tools do.
+  start_ns = rtc::TimeNanos();
+  ParsedRtcEventLogNew parsed_log(
+      ParsedRtcEventLogNew::UnconfiguredHeaderExtensions::kDontParse,
+      ParsedRtcEventLogNew::RawEvents::kDiscard);
+  EXPECT_TRUE(parsed_log.ParseFile(file_name));
+  ReportThroughput("rtc_event_log_parse", trace, log.size(),
+                   rtc::TimeNanos() - start_ns);
+  EXPECT_EQ(parsed_log.outgoing_rtp_packets_by_ssrc().size(), 1u);
+
+  remove(file_name.c_str());
+}
+
+}  // namespace
+
+TEST(RtcEventLogParserPerformanceTest, ParseCall) {
+  RtcEventLogEncoderLegacy legacy_encoder;
+  MeasureParsing("legacy", &legacy_encoder);
+  RtcEventLogEncoderNewFormat new_format_encoder;
+  MeasureParsing("new_format", &new_format_encoder);
+}
+
+}  // namespace webrtc
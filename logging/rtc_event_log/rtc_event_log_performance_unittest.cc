@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/rtceventlogoutput.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
+#include "logging/rtc_event_log/rtc_event_log.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumThreads = 4;
+constexpr int kEventsPerThread = 100000;
+constexpr int64_t kOutputPeriodMs = 5000;
+
+class CountingOutput final : public RtcEventLogOutput {
+ public:
+  explicit CountingOutput(std::atomic<size_t>* written_bytes)
+      : written_bytes_(written_bytes) {}
+
+  bool IsActive() const override { return true; }
+  bool Write(const std::string& output) override {
+    *written_bytes_ += output.size();
+    return true;
+  }
+
+ private:
+  std::atomic<size_t>* const written_bytes_;
+};
+
+// Logs events as fast as it can, as the network and pacer threads would if
+// they were busy with nothing else, and keeps track of the time it takes.
+struct Logger {
+  RtcEventLog* event_log;
+  uint32_t ssrc;
+  int64_t elapsed_ns;
+};
+
+void LogEvents(void* obj) {
+  Logger* logger = static_cast<Logger*>(obj);
+  const int64_t start_ns = rtc::TimeNanos();
+  for (int i = 0; i < kEventsPerThread; ++i) {
+    logger->event_log->Log(
+        absl::make_unique<RtcEventAudioPlayout>(logger->ssrc));
+  }
+  logger->elapsed_ns = rtc::TimeNanos() - start_ns;
+}
+
+}  // namespace
+
+// Measures how long Log() blocks the threads that log.
+TEST(RtcEventLogPerformanceTest, LogFromSeveralThreads) {
+  std::atomic<size_t> written_bytes(0);
+  std::unique_ptr<RtcEventLog> event_log =
+      RtcEventLog::Create(RtcEventLog::EncodingType::NewFormat);
+  ASSERT_TRUE(event_log->StartLogging(
+      absl::make_unique<CountingOutput>(&written_bytes), kOutputPeriodMs));
+
+  const int64_t start_ns = rtc::TimeNanos();
+  std::vector<Logger> loggers(kNumThreads);
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    loggers[i] = {event_log.get(), static_cast<uint32_t>(i), 0};
+    threads.push_back(absl::make_unique<rtc::PlatformThread>(
+        &LogEvents, &loggers[i], "Logger"));
+    threads.back()->Start();
+  }
+  int64_t elapsed_ns = 0;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads[i]->Stop();
+    elapsed_ns += loggers[i].elapsed_ns;
+  }
+  // Stopping writes out whatever is left, so this includes the time spent on
+  // the log's own task queue.
+  event_log->StopLogging();
+  const int64_t total_elapsed_ns = rtc::TimeNanos() - start_ns;
+  EXPECT_GT(written_bytes.load(), 0u);
+
+  const double num_events = kNumThreads * kEventsPerThread;
+  test::PrintResult("rtc_event_log_log", "", "caller", elapsed_ns / num_events,
+                    "ns/event", true);
+  test::PrintResult("rtc_event_log_log", "", "total",
+                    total_elapsed_ns / num_events, "ns/event", true);
+}
+
+}  // namespace webrtc
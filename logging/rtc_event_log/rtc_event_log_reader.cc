@@ -0,0 +1,236 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/rtc_event_log_reader.h"
+
+#if defined(WEBRTC_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>  // no-presubmit-check TODO(webrtc:8982)
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+namespace {
+
+// The tag of the |Event| messages that make up a legacy log, i.e. field number
+// 1 with the length delimited wire type. Logs in the new format start with a
+// different one, the version field's.
+constexpr uint64_t kLegacyEventTag = (1 << 3) | 2;
+constexpr size_t kMaxLegacyEventSize = (1u << 16) - 1;
+
+enum WireType {
+  kVarInt = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+  kFixed32 = 5,
+};
+
+// Reads the varint at |*position| and advances |*position| past it.
+bool ReadVarInt(const uint8_t* data,
+                size_t size,
+                size_t* position,
+                uint64_t* value) {
+  *value = 0;
+  for (size_t i = 0; i < 10 && *position < size; ++i) {
+    // The most significant bit of each byte is 0 if it is the last byte in
+    // the varint, and the other 7 bits hold the value, least significant
+    // group first.
+    const uint8_t byte = data[(*position)++];
+    *value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+// The contents of a log file, mapped into memory where that is supported so
+// that pages are read from disk as the reader reaches them, and can be
+// dropped again by the kernel once they have been parsed.
+class RtcEventLogReader::MappedFile {
+ public:
+  static std::unique_ptr<MappedFile> Open(const std::string& file_name) {
+    std::unique_ptr<MappedFile> file(new MappedFile());
+#if defined(WEBRTC_POSIX)
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+      return nullptr;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      close(fd);
+      return nullptr;
+    }
+    file->size_ = static_cast<size_t>(file_stat.st_size);
+    if (file->size_ > 0) {
+      void* mapping =
+          mmap(nullptr, file->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+      }
+      // The log is parsed front to back, once.
+      madvise(mapping, file->size_, MADV_SEQUENTIAL);
+      file->data_ = static_cast<const uint8_t*>(mapping);
+    }
+    // The mapping keeps the file open.
+    close(fd);
+#else
+    std::ifstream stream(  // no-presubmit-check TODO(webrtc:8982)
+        file_name, std::ios_base::in | std::ios_base::binary);
+    if (!stream.good() || !stream.is_open())
+      return nullptr;
+    file->contents_.assign(std::istreambuf_iterator<char>(stream),
+                           std::istreambuf_iterator<char>());
+    file->data_ = reinterpret_cast<const uint8_t*>(file->contents_.data());
+    file->size_ = file->contents_.size();
+#endif
+    return file;
+  }
+
+  ~MappedFile() {
+#if defined(WEBRTC_POSIX)
+    if (data_)
+      munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+  }
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile() = default;
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#if !defined(WEBRTC_POSIX)
+  std::string contents_;
+#endif
+};
+
+RtcEventLogReader::RtcEventLogReader(const void* data, size_t size)
+    : data_(static_cast<const uint8_t*>(data)),
+      size_(size),
+      is_new_format_(size > 0 && data_[0] != kLegacyEventTag) {}
+
+RtcEventLogReader::RtcEventLogReader(std::unique_ptr<MappedFile> file)
+    : file_(std::move(file)),
+      data_(file_->data()),
+      size_(file_->size()),
+      is_new_format_(size_ > 0 && data_[0] != kLegacyEventTag) {}
+
+RtcEventLogReader::~RtcEventLogReader() = default;
+
+std::unique_ptr<RtcEventLogReader> RtcEventLogReader::CreateFromFile(
+    const std::string& file_name) {
+  std::unique_ptr<MappedFile> file = MappedFile::Open(file_name);
+  if (!file) {
+    RTC_LOG(LS_WARNING) << "Could not open file for reading.";
+    return nullptr;
+  }
+  return std::unique_ptr<RtcEventLogReader>(
+      new RtcEventLogReader(std::move(file)));
+}
+
+RtcEventLogReader::Result RtcEventLogReader::ReadNext() {
+  if (position_ == size_)
+    return kEndOfLog;
+  return is_new_format_ ? ReadNextBatch() : ReadNextLegacyEvent();
+}
+
+RtcEventLogReader::Result RtcEventLogReader::ReadNextLegacyEvent() {
+  uint64_t tag;
+  if (!ReadVarInt(data_, size_, &position_, &tag)) {
+    RTC_LOG(LS_WARNING)
+        << "Missing field tag from beginning of protobuf event.";
+    return kMalformed;
+  } else if (tag != kLegacyEventTag) {
+    RTC_LOG(LS_WARNING)
+        << "Unexpected field tag at beginning of protobuf event.";
+    return kMalformed;
+  }
+
+  uint64_t message_length;
+  if (!ReadVarInt(data_, size_, &position_, &message_length)) {
+    RTC_LOG(LS_WARNING) << "Missing message length after protobuf field tag.";
+    return kMalformed;
+  } else if (message_length > kMaxLegacyEventSize) {
+    RTC_LOG(LS_WARNING) << "Protobuf message length is too large.";
+    return kMalformed;
+  } else if (message_length > size_ - position_) {
+    RTC_LOG(LS_WARNING) << "Failed to read protobuf message from file.";
+    return kMalformed;
+  }
+
+  if (!legacy_event_.ParseFromArray(data_ + position_,
+                                    static_cast<int>(message_length))) {
+    RTC_LOG(LS_WARNING) << "Failed to parse protobuf message.";
+    return kMalformed;
+  }
+  position_ += message_length;
+  return kRecord;
+}
+
+RtcEventLogReader::Result RtcEventLogReader::ReadNextBatch() {
+  // Concatenated EventStream messages parse as one, so the log is a sequence
+  // of EventStream fields, and each field parses as an EventStream of its own.
+  const size_t field_start = position_;
+  uint64_t tag;
+  if (!ReadVarInt(data_, size_, &position_, &tag)) {
+    RTC_LOG(LS_WARNING) << "Missing field tag in event stream.";
+    return kMalformed;
+  }
+  uint64_t value;
+  bool success;
+  switch (tag & 0x7) {
+    case kVarInt:
+      success = ReadVarInt(data_, size_, &position_, &value);
+      break;
+    case kFixed64:
+      success = size_ - position_ >= 8;
+      position_ += success ? 8 : 0;
+      break;
+    case kLengthDelimited:
+      success = ReadVarInt(data_, size_, &position_, &value) &&
+                value <= size_ - position_;
+      position_ += success ? value : 0;
+      break;
+    case kFixed32:
+      success = size_ - position_ >= 4;
+      position_ += success ? 4 : 0;
+      break;
+    default:
+      success = false;
+  }
+  const size_t field_size = position_ - field_start;
+  if (!success ||
+      field_size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    RTC_LOG(LS_WARNING) << "Truncated or unsupported field in event stream.";
+    return kMalformed;
+  }
+
+  if (!batch_.ParseFromArray(data_ + field_start,
+                             static_cast<int>(field_size))) {
+    RTC_LOG(LS_WARNING) << "Failed to parse protobuf message.";
+    return kMalformed;
+  }
+  return kRecord;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_READER_H_
+#define LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/ignore_wundef.h"
+
+// Files generated at build-time by the protobuf compiler.
+RTC_PUSH_IGNORING_WUNDEF()
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/logging/rtc_event_log/rtc_event_log.pb.h"
+#else
+#include "logging/rtc_event_log/rtc_event_log.pb.h"
+#endif
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/logging/rtc_event_log/rtc_event_log2.pb.h"
+#else
+#include "logging/rtc_event_log/rtc_event_log2.pb.h"
+#endif
+RTC_POP_IGNORING_WUNDEF()
+
+namespace webrtc {
+
+// Reads an event log one record at a time, so that logs of any size can be
+// processed in memory proportional to the largest record rather than to the
+// log. In the legacy format a record is one rtclog::Event. In the new format
+// it is one top level field of the rtclog2::EventStream, i.e. one batch of
+// events of a single type, which is returned as an EventStream holding only
+// that field.
+//
+// Example:
+//   auto reader = RtcEventLogReader::CreateFromFile(file_name);
+//   RtcEventLogReader::Result result;
+//   while ((result = reader->ReadNext()) == RtcEventLogReader::kRecord) {
+//     if (reader->is_new_format())
+//       Process(reader->batch());
+//     else
+//       Process(reader->legacy_event());
+//   }
+class RtcEventLogReader {
+ public:
+  enum Result { kRecord, kEndOfLog, kMalformed };
+
+  // Reads the log in |data|, which must outlive the reader.
+  RtcEventLogReader(const void* data, size_t size);
+  ~RtcEventLogReader();
+
+  // Maps |file_name| into memory where that is supported, and reads it into
+  // memory otherwise. Returns null if the file can't be opened.
+  static std::unique_ptr<RtcEventLogReader> CreateFromFile(
+      const std::string& file_name);
+
+  // Reads the next record. After kRecord, the record is available through
+  // legacy_event() or batch() until the next call. After kMalformed, the
+  // records read so far are valid but the rest of the log is not readable.
+  Result ReadNext();
+
+  bool is_new_format() const { return is_new_format_; }
+  const rtclog::Event& legacy_event() const { return legacy_event_; }
+  const rtclog2::EventStream& batch() const { return batch_; }
+
+  // Bytes of the log read so far, and in total.
+  size_t position() const { return position_; }
+  size_t size() const { return size_; }
+
+ private:
+  class MappedFile;
+
+  explicit RtcEventLogReader(std::unique_ptr<MappedFile> file);
+
+  Result ReadNextLegacyEvent();
+  Result ReadNextBatch();
+
+  // Set when the reader owns the memory it reads.
+  const std::unique_ptr<MappedFile> file_;
+  const uint8_t* const data_;
+  const size_t size_;
+  const bool is_new_format_;
+  size_t position_ = 0;
+
+  rtclog::Event legacy_event_;
+  rtclog2::EventStream batch_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RtcEventLogReader);
+};
+
+}  // namespace webrtc
+
+#endif  // LOGGING_RTC_EVENT_LOG_RTC_EVENT_LOG_READER_H_
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/rtc_event_log_reader.h"
+
+#include <stdio.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_legacy.h"
+#include "logging/rtc_event_log/encoder/rtc_event_log_encoder_new_format.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
+#include "logging/rtc_event_log/events/rtc_event_bwe_update_delay_based.h"
+#include "modules/remote_bitrate_estimator/include/bwe_defines.h"
+#include "rtc_base/fakeclock.h"
+#include "test/gtest.h"
+#include "test/testsupport/fileutils.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumEvents = 10;
+constexpr int64_t kStartTimeUs = 1000000;
+
+std::string EncodeLog(RtcEventLogEncoder* encoder) {
+  rtc::ScopedFakeClock clock;
+  clock.SetTimeMicros(kStartTimeUs);
+  std::deque<std::unique_ptr<RtcEvent>> events;
+  for (int i = 0; i < kNumEvents; ++i) {
+    events.push_back(absl::make_unique<RtcEventAudioPlayout>(i % 2));
+    events.push_back(absl::make_unique<RtcEventBweUpdateDelayBased>(
+        100000 + i, BandwidthUsage::kBwNormal));
+    clock.AdvanceTimeMicros(1000);
+  }
+  return encoder->EncodeLogStart(kStartTimeUs) +
+         encoder->EncodeBatch(events.begin(), events.end()) +
+         encoder->EncodeLogEnd(rtc::TimeMicros());
+}
+
+std::string LegacyLog() {
+  RtcEventLogEncoderLegacy encoder;
+  return EncodeLog(&encoder);
+}
+
+std::string NewFormatLog() {
+  RtcEventLogEncoderNewFormat encoder;
+  return EncodeLog(&encoder);
+}
+
+}  // namespace
+
+TEST(RtcEventLogReaderTest, EmptyLog) {
+  RtcEventLogReader reader(nullptr, 0);
+  EXPECT_EQ(reader.ReadNext(), RtcEventLogReader::kEndOfLog);
+}
+
+TEST(RtcEventLogReaderTest, ReadsLegacyLogOneEventAtATime) {
+  const std::string log = LegacyLog();
+  RtcEventLogReader reader(log.data(), log.size());
+  EXPECT_FALSE(reader.is_new_format());
+
+  ASSERT_EQ(reader.ReadNext(), RtcEventLogReader::kRecord);
+  EXPECT_EQ(reader.legacy_event().type(), rtclog::Event::LOG_START);
+  for (int i = 0; i < kNumEvents; ++i) {
+    ASSERT_EQ(reader.ReadNext(), RtcEventLogReader::kRecord);
+    EXPECT_EQ(reader.legacy_event().type(),
+              rtclog::Event::AUDIO_PLAYOUT_EVENT);
+    EXPECT_EQ(reader.legacy_event().audio_playout_event().local_ssrc(),
+              static_cast<uint32_t>(i % 2));
+    ASSERT_EQ(reader.ReadNext(), RtcEventLogReader::kRecord);
+    EXPECT_EQ(reader.legacy_event().type(),
+              rtclog::Event::DELAY_BASED_BWE_UPDATE);
+  }
+  ASSERT_EQ(reader.ReadNext(), RtcEventLogReader::kRecord);
+  EXPECT_EQ(reader.legacy_event().type(), rtclog::Event::LOG_END);
+  EXPECT_EQ(reader.ReadNext(), RtcEventLogReader::kEndOfLog);
+  EXPECT_EQ(reader.position(), log.size());
+}
+
+TEST(RtcEventLogReaderTest, ReadsNewFormatLogOneFieldAtATime) {
+  const std::string log = NewFormatLog();
+  RtcEventLogReader reader(log.data(), log.size());
+  EXPECT_TRUE(reader.is_new_format());
+
+  // The records put together are the log.
+  rtclog2::EventStream merged;
+  size_t records_size = 0;
+  int num_records = 0;
+  while (reader.ReadNext() == RtcEventLogReader::kRecord) {
+    records_size += reader.batch().ByteSizeLong();
+    merged.MergeFrom(reader.batch());
+    ++num_records;
+  }
+  EXPECT_EQ(reader.position(), log.size());
+  EXPECT_EQ(records_size, log.size());
+  rtclog2::EventStream whole;
+  ASSERT_TRUE(whole.ParseFromString(log));
+  EXPECT_EQ(merged.SerializeAsString(), whole.SerializeAsString());
+  // The version, the start and end events, the playout events of each of the
+  // two SSRCs and the BWE updates.
+  EXPECT_EQ(num_records, 6);
+}
+
+TEST(RtcEventLogReaderTest, StopsAtTruncatedLegacyLog) {
+  const std::string log = LegacyLog();
+  RtcEventLogReader reader(log.data(), log.size() - 1);
+  int num_records = 0;
+  RtcEventLogReader::Result result;
+  while ((result = reader.ReadNext()) == RtcEventLogReader::kRecord)
+    ++num_records;
+  EXPECT_EQ(result, RtcEventLogReader::kMalformed);
+  EXPECT_EQ(num_records, 2 * kNumEvents + 1);
+}
+
+TEST(RtcEventLogReaderTest, StopsAtTruncatedNewFormatLog) {
+  const std::string log = NewFormatLog();
+  RtcEventLogReader reader(log.data(), log.size() - 1);
+  RtcEventLogReader::Result result;
+  while ((result = reader.ReadNext()) == RtcEventLogReader::kRecord) {
+  }
+  EXPECT_EQ(result, RtcEventLogReader::kMalformed);
+}
+
+TEST(RtcEventLogReaderTest, ReadsFile) {
+  const std::string log = NewFormatLog();
+  const std::string file_name =
+      test::OutputPath() + "RtcEventLogReaderTest_ReadsFile";
+  FILE* file = fopen(file_name.c_str(), "wb");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(fwrite(log.data(), 1, log.size(), file), log.size());
+  fclose(file);
+
+  std::unique_ptr<RtcEventLogReader> reader =
+      RtcEventLogReader::CreateFromFile(file_name);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(reader->size(), log.size());
+  while (reader->ReadNext() == RtcEventLogReader::kRecord) {
+  }
+  EXPECT_EQ(reader->position(), log.size());
+  remove(file_name.c_str());
+
+  EXPECT_FALSE(RtcEventLogReader::CreateFromFile(file_name));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/rtc_event_queue.h"
+
+#include <stdint.h>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t power = 1;
+  while (power < value)
+    power <<= 1;
+  return power;
+}
+
+}  // namespace
+
+RtcEventQueue::RtcEventQueue(size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+      slots_(new Slot[mask_ + 1]),
+      push_position_(0),
+      pop_position_(0) {
+  RTC_DCHECK_GT(capacity, 0);
+  for (size_t i = 0; i <= mask_; ++i) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+    slots_[i].event = nullptr;
+  }
+}
+
+RtcEventQueue::~RtcEventQueue() {
+  while (Pop()) {
+  }
+}
+
+bool RtcEventQueue::Push(std::unique_ptr<RtcEvent>* event) {
+  RTC_DCHECK(*event);
+  size_t position = push_position_.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &slots_[position & mask_];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const intptr_t lag =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if (lag == 0) {
+      // The slot is free; claim it unless another thread got there first, in
+      // which case |position| is updated to the current push position.
+      if (push_position_.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (lag < 0) {
+      // The slot still holds the event pushed a lap ago.
+      return false;
+    } else {
+      position = push_position_.load(std::memory_order_relaxed);
+    }
+  }
+  slot->event = event->release();
+  // Sequentially consistent, so that a consumer that is told about the push
+  // after this store is guaranteed to see the event.
+  slot->sequence.store(position + 1, std::memory_order_seq_cst);
+  return true;
+}
+
+std::unique_ptr<RtcEvent> RtcEventQueue::Pop() {
+  Slot& slot = slots_[pop_position_ & mask_];
+  if (slot.sequence.load(std::memory_order_seq_cst) != pop_position_ + 1)
+    return nullptr;
+  std::unique_ptr<RtcEvent> event(slot.event);
+  slot.event = nullptr;
+  // Free the slot for the push one lap ahead.
+  slot.sequence.store(pop_position_ + mask_ + 1, std::memory_order_release);
+  ++pop_position_;
+  return event;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef LOGGING_RTC_EVENT_LOG_RTC_EVENT_QUEUE_H_
+#define LOGGING_RTC_EVENT_LOG_RTC_EVENT_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+
+#include "logging/rtc_event_log/events/rtc_event.h"
+#include "rtc_base/constructormagic.h"
+
+namespace webrtc {
+
+// A bounded ring buffer of events, which any number of threads may push to
+// without taking a lock, and one thread at a time pops from in the order they
+// were pushed. Pushing claims a slot with a single compare-and-swap and
+// allocates nothing.
+class RtcEventQueue {
+ public:
+  // |capacity| is rounded up to a power of two.
+  explicit RtcEventQueue(size_t capacity);
+  ~RtcEventQueue();
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // May be called on any thread. Takes ownership of |*event| and returns true,
+  // unless the queue is full, in which case |*event| is left untouched.
+  bool Push(std::unique_ptr<RtcEvent>* event);
+
+  // Returns the oldest event, or null if the queue is empty or if the oldest
+  // event is still being pushed. Calls must not overlap.
+  std::unique_ptr<RtcEvent> Pop();
+
+ private:
+  struct Slot {
+    // Equals the slot's position while it is free to push to, and the
+    // position plus one once it holds an event.
+    std::atomic<size_t> sequence;
+    RtcEvent* event;
+  };
+
+  const size_t mask_;
+  const std::unique_ptr<Slot[]> slots_;
+  std::atomic<size_t> push_position_;
+  size_t pop_position_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RtcEventQueue);
+};
+
+}  // namespace webrtc
+
+#endif  // LOGGING_RTC_EVENT_LOG_RTC_EVENT_QUEUE_H_
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "logging/rtc_event_log/rtc_event_queue.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "logging/rtc_event_log/events/rtc_event_audio_playout.h"
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+// The SSRC of an audio playout event serves as the event's identity.
+std::unique_ptr<RtcEvent> NewEvent(uint32_t id) {
+  return absl::make_unique<RtcEventAudioPlayout>(id);
+}
+
+uint32_t EventId(const std::unique_ptr<RtcEvent>& event) {
+  return static_cast<const RtcEventAudioPlayout&>(*event).ssrc_;
+}
+
+constexpr int kNumProducers = 4;
+constexpr uint32_t kEventsPerProducer = 10000;
+
+struct Producer {
+  RtcEventQueue* queue;
+  uint32_t first_id;
+};
+
+void PushEvents(void* obj) {
+  Producer* producer = static_cast<Producer*>(obj);
+  for (uint32_t i = 0; i < kEventsPerProducer; ++i) {
+    std::unique_ptr<RtcEvent> event = NewEvent(producer->first_id + i);
+    EXPECT_TRUE(producer->queue->Push(&event));
+  }
+}
+
+}  // namespace
+
+TEST(RtcEventQueueTest, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(RtcEventQueue(1).capacity(), 1u);
+  EXPECT_EQ(RtcEventQueue(5).capacity(), 8u);
+  EXPECT_EQ(RtcEventQueue(4096).capacity(), 4096u);
+}
+
+TEST(RtcEventQueueTest, PopsInPushOrder) {
+  RtcEventQueue queue(8);
+  EXPECT_FALSE(queue.Pop());
+  // Go round the ring a few times.
+  for (uint32_t lap = 0; lap < 3; ++lap) {
+    for (uint32_t i = 0; i < 6; ++i) {
+      std::unique_ptr<RtcEvent> event = NewEvent(10 * lap + i);
+      EXPECT_TRUE(queue.Push(&event));
+      EXPECT_FALSE(event);
+    }
+    for (uint32_t i = 0; i < 6; ++i) {
+      std::unique_ptr<RtcEvent> event = queue.Pop();
+      ASSERT_TRUE(event);
+      EXPECT_EQ(EventId(event), 10 * lap + i);
+    }
+    EXPECT_FALSE(queue.Pop());
+  }
+}
+
+TEST(RtcEventQueueTest, PushFailsWhenFull) {
+  RtcEventQueue queue(4);
+  for (uint32_t i = 0; i < 4; ++i) {
+    std::unique_ptr<RtcEvent> event = NewEvent(i);
+    EXPECT_TRUE(queue.Push(&event));
+  }
+  std::unique_ptr<RtcEvent> event = NewEvent(4);
+  EXPECT_FALSE(queue.Push(&event));
+  ASSERT_TRUE(event);  // Ownership was not taken.
+
+  EXPECT_EQ(EventId(queue.Pop()), 0u);
+  EXPECT_TRUE(queue.Push(&event));
+  for (uint32_t i = 1; i <= 4; ++i)
+    EXPECT_EQ(EventId(queue.Pop()), i);
+}
+
+TEST(RtcEventQueueTest, DestructorDeletesRemainingEvents) {
+  // Leaks would be caught by the memory checkers.
+  RtcEventQueue queue(4);
+  std::unique_ptr<RtcEvent> event = NewEvent(1);
+  EXPECT_TRUE(queue.Push(&event));
+}
+
+TEST(RtcEventQueueTest, ConcurrentProducersKeepTheirOrder) {
+  RtcEventQueue queue(kNumProducers * kEventsPerProducer);
+  std::vector<Producer> producers(kNumProducers);
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers[i] = {&queue, i * kEventsPerProducer};
+    threads.push_back(absl::make_unique<rtc::PlatformThread>(
+        &PushEvents, &producers[i], "Producer"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+
+  // The producers' events are interleaved, but each producer's must come out
+  // in the order it pushed them.
+  std::vector<uint32_t> next_id(kNumProducers);
+  for (int i = 0; i < kNumProducers; ++i)
+    next_id[i] = i * kEventsPerProducer;
+  for (uint32_t i = 0; i < kNumProducers * kEventsPerProducer; ++i) {
+    std::unique_ptr<RtcEvent> event = queue.Pop();
+    ASSERT_TRUE(event);
+    const uint32_t id = EventId(event);
+    const uint32_t producer = id / kEventsPerProducer;
+    ASSERT_LT(producer, static_cast<uint32_t>(kNumProducers));
+    EXPECT_EQ(id, next_id[producer]);
+    next_id[producer] = id + 1;
+  }
+  EXPECT_FALSE(queue.Pop());
+}
+
+}  // namespace webrtc
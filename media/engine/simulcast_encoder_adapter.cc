@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "api/video/i420_buffer.h"
 #include "api/video/video_bitrate_allocation.h"
@@ -20,6 +21,7 @@
 #include "media/engine/scopedvideoencoder.h"
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/task_pool.h"
 #include "system_wrappers/include/clock.h"
 #include "system_wrappers/include/field_trial.h"
 #include "third_party/libyuv/include/libyuv/scale.h"
@@ -309,6 +311,56 @@ int SimulcastEncoderAdapter::Encode(
 
   int src_width = input_image.width();
   int src_height = input_image.height();
+  // If scaling isn't required, because the input resolution
+  // matches the destination or the input image is empty (e.g.
+  // a keyframe request for encoders with internal camera
+  // sources) or the source image has a native handle, pass the image on
+  // directly. Otherwise, we'll scale it to match what the encoder expects
+  // (below).
+  // For texture frames, the underlying encoder is expected to be able to
+  // correctly sample/scale the source texture.
+  // TODO(perkj): ensure that works going forward, and figure out how this
+  // affects webrtc:5683.
+  std::vector<size_t> streams_to_scale;
+  if (input_image.video_frame_buffer()->type() !=
+      VideoFrameBuffer::Type::kNative) {
+    for (size_t stream_idx = 0; stream_idx < streaminfos_.size();
+         ++stream_idx) {
+      // Don't scale frames in resolutions that we don't intend to send.
+      if (streaminfos_[stream_idx].send_stream &&
+          (streaminfos_[stream_idx].width != src_width ||
+           streaminfos_[stream_idx].height != src_height)) {
+        streams_to_scale.push_back(stream_idx);
+      }
+    }
+  }
+
+  // The scaled streams don't depend on each other, so scale them in parallel
+  // before encoding.
+  std::vector<rtc::scoped_refptr<I420Buffer>> scaled_buffers(
+      streaminfos_.size());
+  if (!streams_to_scale.empty()) {
+    rtc::scoped_refptr<I420BufferInterface> src_buffer =
+        input_image.video_frame_buffer()->ToI420();
+    rtc::TaskPool::Default()->ParallelFor(
+        streams_to_scale.size(), [&](size_t i) {
+          const size_t stream_idx = streams_to_scale[i];
+          int dst_width = streaminfos_[stream_idx].width;
+          int dst_height = streaminfos_[stream_idx].height;
+          rtc::scoped_refptr<I420Buffer> dst_buffer =
+              I420Buffer::Create(dst_width, dst_height);
+          libyuv::I420Scale(src_buffer->DataY(), src_buffer->StrideY(),
+                            src_buffer->DataU(), src_buffer->StrideU(),
+                            src_buffer->DataV(), src_buffer->StrideV(),
+                            src_width, src_height, dst_buffer->MutableDataY(),
+                            dst_buffer->StrideY(), dst_buffer->MutableDataU(),
+                            dst_buffer->StrideU(), dst_buffer->MutableDataV(),
+                            dst_buffer->StrideV(), dst_width, dst_height,
+                            libyuv::kFilterBilinear);
+          scaled_buffers[stream_idx] = dst_buffer;
+        });
+  }
+
   for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
     // Don't encode frames in resolutions that we don't intend to send.
     if (!streaminfos_[stream_idx].send_stream) {
@@ -323,47 +375,18 @@ int SimulcastEncoderAdapter::Encode(
       stream_frame_types.push_back(kVideoFrameDelta);
     }
 
-    int dst_width = streaminfos_[stream_idx].width;
-    int dst_height = streaminfos_[stream_idx].height;
-    // If scaling isn't required, because the input resolution
-    // matches the destination or the input image is empty (e.g.
-    // a keyframe request for encoders with internal camera
-    // sources) or the source image has a native handle, pass the image on
-    // directly. Otherwise, we'll scale it to match what the encoder expects
-    // (below).
-    // For texture frames, the underlying encoder is expected to be able to
-    // correctly sample/scale the source texture.
-    // TODO(perkj): ensure that works going forward, and figure out how this
-    // affects webrtc:5683.
-    if ((dst_width == src_width && dst_height == src_height) ||
-        input_image.video_frame_buffer()->type() ==
-            VideoFrameBuffer::Type::kNative) {
-      int ret = streaminfos_[stream_idx].encoder->Encode(
+    int ret;
+    if (!scaled_buffers[stream_idx]) {
+      ret = streaminfos_[stream_idx].encoder->Encode(
           input_image, codec_specific_info, &stream_frame_types);
-      if (ret != WEBRTC_VIDEO_CODEC_OK) {
-        return ret;
-      }
     } else {
-      rtc::scoped_refptr<I420Buffer> dst_buffer =
-          I420Buffer::Create(dst_width, dst_height);
-      rtc::scoped_refptr<I420BufferInterface> src_buffer =
-          input_image.video_frame_buffer()->ToI420();
-      libyuv::I420Scale(src_buffer->DataY(), src_buffer->StrideY(),
-                        src_buffer->DataU(), src_buffer->StrideU(),
-                        src_buffer->DataV(), src_buffer->StrideV(), src_width,
-                        src_height, dst_buffer->MutableDataY(),
-                        dst_buffer->StrideY(), dst_buffer->MutableDataU(),
-                        dst_buffer->StrideU(), dst_buffer->MutableDataV(),
-                        dst_buffer->StrideV(), dst_width, dst_height,
-                        libyuv::kFilterBilinear);
-
-      int ret = streaminfos_[stream_idx].encoder->Encode(
-          VideoFrame(dst_buffer, input_image.timestamp(),
+      ret = streaminfos_[stream_idx].encoder->Encode(
+          VideoFrame(scaled_buffers[stream_idx], input_image.timestamp(),
                      input_image.render_time_ms(), webrtc::kVideoRotation_0),
           codec_specific_info, &stream_frame_types);
-      if (ret != WEBRTC_VIDEO_CODEC_OK) {
-        return ret;
-      }
+    }
+    if (ret != WEBRTC_VIDEO_CODEC_OK) {
+      return ret;
     }
   }
 
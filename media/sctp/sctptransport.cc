@@ -22,6 +22,7 @@ enum PreservedErrno {
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <algorithm>
 #include <memory>
@@ -38,6 +39,7 @@ enum PreservedErrno {
 #include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/stringutils.h"
 #include "rtc_base/thread_checker.h"
+#include "rtc_base/timeutils.h"
 #include "rtc_base/trace_event.h"
 #include "usrsctplib/usrsctp.h"
 
@@ -260,11 +262,20 @@ class SctpTransport::UsrSctpWrapper {
     VerboseLogPacket(data, length, SCTP_DUMP_OUTBOUND);
     // Note: We have to copy the data; the caller will delete it.
     rtc::CopyOnWriteBuffer buf(reinterpret_cast<uint8_t*>(data), length);
-    // TODO(deadbeef): Why do we need an AsyncInvoke here? We're already on the
-    // right thread and don't need to unwind the stack.
-    transport->invoker_.AsyncInvoke<void>(
-        RTC_FROM_HERE, transport->network_thread_,
-        rtc::Bind(&SctpTransport::OnPacketFromSctpToNetwork, transport, buf));
+    // usrsctp usually produces several packets in a row, e.g. for a large
+    // message or when a burst of received packets is acknowledged. They are
+    // queued and sent to the network by a single task.
+    bool post;
+    {
+      rtc::CritScope lock(&transport->packets_crit_);
+      post = transport->outbound_packets_.empty();
+      transport->outbound_packets_.push_back(std::move(buf));
+    }
+    if (post) {
+      transport->invoker_.AsyncInvoke<void>(
+          RTC_FROM_HERE, transport->network_thread_,
+          rtc::Bind(&SctpTransport::SendOutboundPackets, transport));
+    }
     return 0;
   }
 
@@ -295,14 +306,11 @@ class SctpTransport::UsrSctpWrapper {
     } else {
       ReceiveDataParams params;
 
-      // Expect only continuation messages belonging to the same sid, usrsctp
-      // ensures this.
-      RTC_CHECK(transport->partial_message_.size() == 0 ||
-                rcv.rcv_sid == transport->partial_message_sid_);
-
-      transport->partial_message_.AppendData(reinterpret_cast<uint8_t*>(data),
-                                             length);
-      transport->partial_message_sid_ = rcv.rcv_sid;
+      // With I-DATA, usrsctp may interleave the parts of messages on
+      // different streams, so they are collected per stream.
+      rtc::CopyOnWriteBuffer& partial_message =
+          transport->partial_messages_[rcv.rcv_sid];
+      partial_message.AppendData(reinterpret_cast<uint8_t*>(data), length);
 
       free(data);
 
@@ -310,8 +318,7 @@ class SctpTransport::UsrSctpWrapper {
       // This enables messages from a single send to be delivered in a single
       // callback. Larger messages (originating from other implementations) will
       // still be delivered in chunks.
-      if (!(flags & MSG_EOR) &&
-          (transport->partial_message_.size() < kSendBufferSize)) {
+      if (!(flags & MSG_EOR) && (partial_message.size() < kSendBufferSize)) {
         return 1;
       }
 
@@ -325,9 +332,9 @@ class SctpTransport::UsrSctpWrapper {
       transport->invoker_.AsyncInvoke<void>(
           RTC_FROM_HERE, transport->network_thread_,
           rtc::Bind(&SctpTransport::OnInboundPacketFromSctpToTransport,
-                    transport, transport->partial_message_, params, flags));
+                    transport, partial_message, params, flags));
 
-      transport->partial_message_.Clear();
+      partial_message.Clear();
     }
     return 1;
   }
@@ -353,9 +360,8 @@ class SctpTransport::UsrSctpWrapper {
   }
 
   static int SendThresholdCallback(struct socket* sock, uint32_t sb_free) {
-    // Fired on our I/O thread. SctpTransport::OnPacketReceived() gets
-    // a packet containing acknowledgments, which goes into usrsctp_conninput,
-    // and then back here.
+    // Fired on the thread that calls usrsctp_conninput() with a packet
+    // containing acknowledgments, which may be the SCTP thread.
     SctpTransport* transport = GetTransportFromSocket(sock);
     if (!transport) {
       RTC_LOG(LS_ERROR)
@@ -363,23 +369,41 @@ class SctpTransport::UsrSctpWrapper {
           << sock;
       return 0;
     }
-    transport->OnSendThresholdCallback();
+    if (transport->network_thread_->IsCurrent()) {
+      transport->OnSendThresholdCallback();
+    } else {
+      transport->invoker_.AsyncInvoke<void>(
+          RTC_FROM_HERE, transport->network_thread_,
+          rtc::Bind(&SctpTransport::OnSendThresholdCallback, transport));
+    }
     return 0;
   }
 };
 
 SctpTransport::SctpTransport(rtc::Thread* network_thread,
                              rtc::PacketTransportInternal* transport)
+    : SctpTransport(network_thread, transport, network_thread) {}
+
+SctpTransport::SctpTransport(rtc::Thread* network_thread,
+                             rtc::PacketTransportInternal* transport,
+                             rtc::Thread* sctp_thread)
     : network_thread_(network_thread),
+      sctp_thread_(sctp_thread),
+      sctp_invoker_(sctp_thread != network_thread ? new rtc::AsyncInvoker()
+                                                  : nullptr),
       transport_(transport),
       was_ever_writable_(transport->writable()) {
   RTC_DCHECK(network_thread_);
+  RTC_DCHECK(sctp_thread_);
   RTC_DCHECK(transport_);
   RTC_DCHECK_RUN_ON(network_thread_);
   ConnectTransportSignals();
 }
 
 SctpTransport::~SctpTransport() {
+  // Cancels the queued packets and waits for the SCTP thread to finish giving
+  // packets to usrsctp.
+  sctp_invoker_.reset();
   // Close abruptly; no reset procedure.
   CloseSctpSocket();
 }
@@ -505,12 +529,51 @@ bool SctpTransport::SendData(const SendDataParams& params,
     }
   }
 
-  // Send data using SCTP.
-  ssize_t send_res = 0;  // result from usrsctp_sendv.
+  // Only one message can be partially sent at a time; the rest of it has to
+  // be handed to usrsctp before anything else.
+  if (partial_outgoing_message_) {
+    if (result) {
+      *result = SDR_BLOCK;
+    }
+    ready_to_send_data_ = false;
+    return false;
+  }
+
+  // |payload| is shared, not copied, until usrsctp takes the data.
+  OutgoingMessage message;
+  message.params = params;
+  message.payload = payload;
+  SendDataResult send_result = SendMessageInternal(&message);
+  if (result) {
+    *result = send_result;
+  }
+  if (send_result != SDR_SUCCESS) {
+    return false;
+  }
+  {
+    rtc::CritScope lock(&packets_crit_);
+    ++stats_.messages_sent;
+    stats_.bytes_sent += message.payload.size();
+  }
+  if (message.offset < message.payload.size()) {
+    // usrsctp took only a part of the message. The message has been accepted
+    // and the rest is sent from OnSendThresholdCallback().
+    partial_outgoing_message_ = std::move(message);
+  }
+  return true;
+}
+
+SendDataResult SctpTransport::SendMessageInternal(OutgoingMessage* message) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  const SendDataParams& params = message->params;
   struct sctp_sendv_spa spa = {0};
   spa.sendv_flags |= SCTP_SEND_SNDINFO_VALID;
   spa.sendv_sndinfo.snd_sid = params.sid;
   spa.sendv_sndinfo.snd_ppid = rtc::HostToNetwork32(GetPpid(params.type));
+  // With SCTP_EXPLICIT_EOR, marking the end of the record makes usrsctp
+  // accept as much of the message as fits in the send buffer and return the
+  // number of bytes it took, instead of failing until the whole message fits.
+  // Sending the rest later continues the same message.
   spa.sendv_sndinfo.snd_flags |= SCTP_EOR;
 
   // Ordered implies reliable.
@@ -527,27 +590,26 @@ bool SctpTransport::SendData(const SendDataParams& params,
     }
   }
 
-  // We don't fragment.
-  send_res = usrsctp_sendv(
-      sock_, payload.data(), static_cast<size_t>(payload.size()), NULL, 0, &spa,
+  ssize_t send_res = usrsctp_sendv(
+      sock_, message->payload.data() + message->offset,
+      message->payload.size() - message->offset, NULL, 0, &spa,
       rtc::checked_cast<socklen_t>(sizeof(spa)), SCTP_SENDV_SPA, 0);
   if (send_res < 0) {
     if (errno == SCTP_EWOULDBLOCK) {
-      *result = SDR_BLOCK;
       ready_to_send_data_ = false;
       RTC_LOG(LS_INFO) << debug_name_
-                       << "->SendData(...): EWOULDBLOCK returned";
-    } else {
-      RTC_LOG_ERRNO(LS_ERROR) << "ERROR:" << debug_name_ << "->SendData(...): "
-                              << " usrsctp_sendv: ";
+                       << "->SendMessageInternal(...): EWOULDBLOCK returned";
+      return SDR_BLOCK;
     }
-    return false;
+    RTC_LOG_ERRNO(LS_ERROR) << "ERROR:" << debug_name_
+                            << "->SendMessageInternal(...): "
+                            << " usrsctp_sendv: ";
+    return SDR_ERROR;
   }
-  if (result) {
-    // Only way out now is success.
-    *result = SDR_SUCCESS;
-  }
-  return true;
+  RTC_DCHECK_LE(static_cast<size_t>(send_res),
+                message->payload.size() - message->offset);
+  message->offset += static_cast<size_t>(send_res);
+  return SDR_SUCCESS;
 }
 
 bool SctpTransport::ReadyToSendData() {
@@ -555,6 +617,25 @@ bool SctpTransport::ReadyToSendData() {
   return ready_to_send_data_;
 }
 
+SctpTransportStats SctpTransport::GetStats() const {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  SctpTransportStats stats;
+  {
+    rtc::CritScope lock(&packets_crit_);
+    stats = stats_;
+  }
+  if (sock_) {
+    struct sctp_status status;
+    memset(&status, 0, sizeof(status));
+    socklen_t size = sizeof(status);
+    if (usrsctp_getsockopt(sock_, IPPROTO_SCTP, SCTP_STATUS, &status, &size) ==
+        0) {
+      stats.srtt_ms = static_cast<int>(status.sstat_primary.spinfo_srtt);
+    }
+  }
+  return stats;
+}
+
 void SctpTransport::ConnectTransportSignals() {
   RTC_DCHECK_RUN_ON(network_thread_);
   if (!transport_) {
@@ -726,6 +807,25 @@ bool SctpTransport::ConfigureSctpSocket() {
     return false;
   }
 
+#if defined(SCTP_INTERLEAVING_SUPPORTED)
+  // Offer I-DATA chunks (RFC 8260). When the peer supports them, the parts of
+  // a large message are interleaved with messages on other streams instead
+  // of holding them back until the whole message is sent. This requires the
+  // highest fragment interleave level, at which usrsctp hands over the parts
+  // of messages on different streams interleaved. Not fatal if unsupported.
+  int interleave_level = 2;
+  struct sctp_assoc_value interleaving;
+  interleaving.assoc_id = SCTP_FUTURE_ASSOC;
+  interleaving.assoc_value = 1;
+  if (usrsctp_setsockopt(sock_, IPPROTO_SCTP, SCTP_FRAGMENT_INTERLEAVE,
+                         &interleave_level, sizeof(interleave_level)) ||
+      usrsctp_setsockopt(sock_, IPPROTO_SCTP, SCTP_INTERLEAVING_SUPPORTED,
+                         &interleaving, sizeof(interleaving))) {
+    RTC_LOG_ERRNO(LS_WARNING) << debug_name_ << "->ConfigureSctpSocket(): "
+                              << "Failed to enable I-DATA.";
+  }
+#endif
+
   // Subscribe to SCTP event notifications.
   int event_types[] = {SCTP_ASSOC_CHANGE, SCTP_PEER_ADDR_CHANGE,
                        SCTP_SEND_FAILED_EVENT, SCTP_SENDER_DRY_EVENT,
@@ -758,6 +858,7 @@ void SctpTransport::CloseSctpSocket() {
     usrsctp_deregister_address(this);
     UsrSctpWrapper::DecrementUsrSctpUsageCount();
     ready_to_send_data_ = false;
+    partial_outgoing_message_.reset();
   }
 }
 
@@ -868,7 +969,29 @@ void SctpTransport::OnPacketRead(rtc::PacketTransportInternal* transport,
     // will be will be given to the global OnSctpInboundData, and then,
     // marshalled by the AsyncInvoker.
     VerboseLogPacket(data, len, SCTP_DUMP_INBOUND);
-    usrsctp_conninput(this, data, len, 0);
+    if (!sctp_invoker_) {
+      {
+        rtc::CritScope lock(&packets_crit_);
+        ++stats_.packets_received;
+        ++stats_.packet_receive_batches;
+      }
+      usrsctp_conninput(this, data, len, 0);
+      return;
+    }
+    // Packets that arrive while the SCTP thread is busy are given to it
+    // together.
+    bool post;
+    {
+      rtc::CritScope lock(&packets_crit_);
+      post = inbound_packets_.empty();
+      inbound_packets_.push_back(
+          {rtc::CopyOnWriteBuffer(data, len), rtc::TimeMicros()});
+    }
+    if (post) {
+      sctp_invoker_->AsyncInvoke<void>(
+          RTC_FROM_HERE, sctp_thread_,
+          rtc::Bind(&SctpTransport::ProcessInboundPackets, this));
+    }
   } else {
     // TODO(ldixon): Consider caching the packet for very slightly better
     // reliability.
@@ -877,9 +1000,55 @@ void SctpTransport::OnPacketRead(rtc::PacketTransportInternal* transport,
 
 void SctpTransport::OnSendThresholdCallback() {
   RTC_DCHECK_RUN_ON(network_thread_);
+  if (partial_outgoing_message_) {
+    if (SendMessageInternal(&*partial_outgoing_message_) != SDR_SUCCESS) {
+      return;
+    }
+    if (partial_outgoing_message_->offset <
+        partial_outgoing_message_->payload.size()) {
+      return;
+    }
+    partial_outgoing_message_.reset();
+  }
   SetReadyToSendData();
 }
 
+void SctpTransport::ProcessInboundPackets() {
+  RTC_DCHECK_RUN_ON(sctp_thread_);
+  TRACE_EVENT0("webrtc", "SctpTransport::ProcessInboundPackets");
+  std::vector<InboundPacket> packets;
+  const int64_t now_us = rtc::TimeMicros();
+  {
+    rtc::CritScope lock(&packets_crit_);
+    packets.swap(inbound_packets_);
+    stats_.packets_received += packets.size();
+    ++stats_.packet_receive_batches;
+    for (const InboundPacket& packet : packets) {
+      const int64_t delay_us = now_us - packet.arrival_time_us;
+      stats_.total_receive_queue_delay_us += delay_us;
+      stats_.max_receive_queue_delay_us =
+          std::max(stats_.max_receive_queue_delay_us, delay_us);
+    }
+  }
+  for (const InboundPacket& packet : packets) {
+    usrsctp_conninput(this, packet.data.data(), packet.data.size(), 0);
+  }
+}
+
+void SctpTransport::SendOutboundPackets() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  std::vector<rtc::CopyOnWriteBuffer> packets;
+  {
+    rtc::CritScope lock(&packets_crit_);
+    packets.swap(outbound_packets_);
+    stats_.packets_sent += packets.size();
+    ++stats_.packet_send_batches;
+  }
+  for (const rtc::CopyOnWriteBuffer& packet : packets) {
+    OnPacketFromSctpToNetwork(packet);
+  }
+}
+
 sockaddr_conn SctpTransport::GetSctpSockAddr(int port) {
   sockaddr_conn sconn = {0};
   sconn.sconn_family = AF_CONN;
@@ -947,6 +1116,11 @@ void SctpTransport::OnDataFromSctpToTransport(
   RTC_LOG(LS_VERBOSE) << debug_name_ << "->OnDataFromSctpToTransport(...): "
                       << "Posting with length: " << buffer.size()
                       << " on stream " << params.sid;
+  {
+    rtc::CritScope lock(&packets_crit_);
+    ++stats_.messages_received;
+    stats_.bytes_received += buffer.size();
+  }
   // Reports all received messages to upper layers, no matter whether the sid
   // is known.
   SignalDataReceived(params, buffer);
@@ -19,11 +19,14 @@
 #include <string>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "rtc_base/asyncinvoker.h"
 #include "rtc_base/constructormagic.h"
 #include "rtc_base/copyonwritebuffer.h"
+#include "rtc_base/criticalsection.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
 // For SendDataParams/ReceiveDataParams.
 #include "media/base/mediachannel.h"
 #include "media/sctp/sctptransportinternal.h"
@@ -49,7 +52,9 @@ struct SctpInboundPacket;
 //  4.  SctpTransport::OnPacketFromSctpToNetwork(wrapped_data)
 //  5.  DtlsTransport::SendPacket(wrapped_data)
 //  6.  ... across network ... a packet is sent back ...
-//  7.  SctpTransport::OnPacketReceived(wrapped_data)
+//  7.  SctpTransport::OnPacketRead(wrapped_data)
+// [if there is a separate SCTP thread, packets are queued and handed over in
+//  batches; the SCTP thread then calls the following]
 //  8.  usrsctp_conninput(wrapped_data)
 // [network thread returns; sctp thread then calls the following]
 //  9.  OnSctpInboundData(data)
@@ -69,6 +74,12 @@ class SctpTransport : public SctpTransportInternal,
   // |channel| is required (must not be null).
   SctpTransport(rtc::Thread* network_thread,
                 rtc::PacketTransportInternal* channel);
+  // As above, but received packets are handed to usrsctp on |sctp_thread|, so
+  // that the SCTP stack of a busy association doesn't hold up the network
+  // thread. |sctp_thread| may be shared by several transports.
+  SctpTransport(rtc::Thread* network_thread,
+                rtc::PacketTransportInternal* channel,
+                rtc::Thread* sctp_thread);
   ~SctpTransport() override;
 
   // SctpTransportInternal overrides (see sctptransportinternal.h for comments).
@@ -80,6 +91,7 @@ class SctpTransport : public SctpTransportInternal,
                 const rtc::CopyOnWriteBuffer& payload,
                 SendDataResult* result = nullptr) override;
   bool ReadyToSendData() override;
+  SctpTransportStats GetStats() const override;
   void set_debug_name_for_testing(const char* debug_name) override {
     debug_name_ = debug_name;
   }
@@ -102,6 +114,17 @@ class SctpTransport : public SctpTransportInternal,
   // Sets |sock_ |to nullptr.
   void CloseSctpSocket();
 
+  struct OutgoingMessage {
+    SendDataParams params;
+    rtc::CopyOnWriteBuffer payload;
+    // Number of bytes of |payload| that usrsctp has taken.
+    size_t offset = 0;
+  };
+
+  // Hands as much of |message| as fits in the send buffer to usrsctp and
+  // advances its offset. Returns SDR_SUCCESS unless usrsctp failed.
+  SendDataResult SendMessageInternal(OutgoingMessage* message);
+
   // Sends a SCTP_RESET_STREAM for all streams in closing_ssids_.
   bool SendQueuedStreamResets();
 
@@ -120,7 +143,12 @@ class SctpTransport : public SctpTransportInternal,
   void OnSendThresholdCallback();
   sockaddr_conn GetSctpSockAddr(int port);
 
-  // Called using |invoker_| to send packet on the network.
+  // Called using |sctp_invoker_| to give the queued received packets to
+  // usrsctp.
+  void ProcessInboundPackets();
+  // Called using |invoker_| to send the packets usrsctp has produced since the
+  // last call.
+  void SendOutboundPackets();
   void OnPacketFromSctpToNetwork(const rtc::CopyOnWriteBuffer& buffer);
   // Called using |invoker_| to decide what to do with the packet.
   // The |flags| parameter is used by SCTP to distinguish notification packets
@@ -138,15 +166,38 @@ class SctpTransport : public SctpTransportInternal,
   // Responsible for marshalling incoming data to the channels listeners, and
   // outgoing data to the network interface.
   rtc::Thread* network_thread_;
+  // Where received packets are given to usrsctp. Same as |network_thread_|
+  // unless a separate SCTP thread was given.
+  rtc::Thread* const sctp_thread_;
   // Helps pass inbound/outbound packets asynchronously to the network thread.
   rtc::AsyncInvoker invoker_;
+  // Passes received packets to |sctp_thread_|. Null if it is the network
+  // thread.
+  std::unique_ptr<rtc::AsyncInvoker> sctp_invoker_;
+
+  struct InboundPacket {
+    rtc::CopyOnWriteBuffer data;
+    int64_t arrival_time_us;
+  };
+  // Packets waiting to be handed between threads. A task is only posted when
+  // a queue becomes non-empty, so a burst of packets costs one thread hop.
+  rtc::CriticalSection packets_crit_;
+  std::vector<InboundPacket> inbound_packets_ RTC_GUARDED_BY(packets_crit_);
+  std::vector<rtc::CopyOnWriteBuffer> outbound_packets_
+      RTC_GUARDED_BY(packets_crit_);
+  // Updated on the network thread, the SCTP thread and the usrsctp timer
+  // thread.
+  SctpTransportStats stats_ RTC_GUARDED_BY(packets_crit_);
   // Underlying DTLS channel.
   rtc::PacketTransportInternal* transport_ = nullptr;
 
   // Track the data received from usrsctp between callbacks until the EOR bit
-  // arrives.
-  rtc::CopyOnWriteBuffer partial_message_;
-  int partial_message_sid_;
+  // arrives, per stream. Only accessed on the usrsctp thread.
+  std::map<uint16_t, rtc::CopyOnWriteBuffer> partial_messages_;
+
+  // A message that usrsctp has only taken a part of. The rest is sent before
+  // any other message, as soon as there is room in the send buffer.
+  absl::optional<OutgoingMessage> partial_outgoing_message_;
 
   bool was_ever_writable_ = false;
   int local_port_ = kSctpDefaultPort;
@@ -212,17 +263,22 @@ class SctpTransport : public SctpTransportInternal,
 
 class SctpTransportFactory : public SctpTransportInternalFactory {
  public:
-  explicit SctpTransportFactory(rtc::Thread* network_thread)
-      : network_thread_(network_thread) {}
+  // If |sctp_thread| is not null, the created transports process received
+  // packets on it.
+  explicit SctpTransportFactory(rtc::Thread* network_thread,
+                                rtc::Thread* sctp_thread = nullptr)
+      : network_thread_(network_thread), sctp_thread_(sctp_thread) {}
 
   std::unique_ptr<SctpTransportInternal> CreateSctpTransport(
       rtc::PacketTransportInternal* transport) override {
-    return std::unique_ptr<SctpTransportInternal>(
-        new SctpTransport(network_thread_, transport));
+    return std::unique_ptr<SctpTransportInternal>(new SctpTransport(
+        network_thread_, transport,
+        sctp_thread_ ? sctp_thread_ : network_thread_));
   }
 
  private:
   rtc::Thread* network_thread_;
+  rtc::Thread* sctp_thread_;
 };
 
 }  // namespace cricket
@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "media/sctp/sctptransport.h"
+#include "p2p/base/fakedtlstransport.h"
+#include "rtc_base/copyonwritebuffer.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const int kTimeoutMs = 60000;
+const int kTransport1Port = 5001;
+const int kTransport2Port = 5002;
+const size_t kBytesPerRun = 16 * 1024 * 1024;
+
+class ByteCounter : public sigslot::has_slots<> {
+ public:
+  void OnDataReceived(const ReceiveDataParams& params,
+                      const rtc::CopyOnWriteBuffer& data) {
+    bytes_received_ += data.size();
+  }
+  size_t bytes_received() const { return bytes_received_; }
+
+ private:
+  size_t bytes_received_ = 0;
+};
+
+// Sends |kBytesPerRun| bytes in messages of |message_size| bytes from one
+// transport to the other, as fast as flow control allows, and returns the
+// throughput in Mbps.
+double MeasureThroughputMbps(size_t message_size) {
+  FakeDtlsTransport fake_dtls1("fake dtls 1", 0);
+  FakeDtlsTransport fake_dtls2("fake dtls 2", 0);
+  SctpTransport transport1(rtc::Thread::Current(), &fake_dtls1);
+  SctpTransport transport2(rtc::Thread::Current(), &fake_dtls2);
+  ByteCounter counter;
+  transport2.SignalDataReceived.connect(&counter, &ByteCounter::OnDataReceived);
+  fake_dtls1.SetDestination(&fake_dtls2, false);
+  transport1.OpenStream(1);
+  transport2.OpenStream(1);
+  transport1.Start(kTransport1Port, kTransport2Port);
+  transport2.Start(kTransport2Port, kTransport1Port);
+  EXPECT_TRUE_WAIT(transport1.ReadyToSendData(), kTimeoutMs);
+
+  // The same payload is sent over and over; it is shared, not copied, until
+  // usrsctp takes it.
+  rtc::CopyOnWriteBuffer payload(message_size);
+  memset(payload.data<uint8_t>(), 'x', message_size);
+  SendDataParams params;
+  params.sid = 1;
+  params.type = DMT_BINARY;
+
+  const int64_t start_us = rtc::TimeMicros();
+  size_t bytes_sent = 0;
+  while (bytes_sent < kBytesPerRun) {
+    SendDataResult result;
+    if (transport1.SendData(params, payload, &result)) {
+      bytes_sent += message_size;
+      continue;
+    }
+    EXPECT_EQ(SDR_BLOCK, result);
+    if (result != SDR_BLOCK)
+      return 0;
+    EXPECT_TRUE_WAIT(transport1.ReadyToSendData(), kTimeoutMs);
+  }
+  EXPECT_EQ_WAIT(bytes_sent, counter.bytes_received(), kTimeoutMs);
+  const int64_t elapsed_us =
+      std::max<int64_t>(rtc::TimeMicros() - start_us, 1);
+  return 8.0 * bytes_sent / elapsed_us;
+}
+
+}  // namespace
+
+// Data channel throughput over a loopback DTLS transport, so that the cost of
+// the SCTP stack and the transport glue dominates.
+TEST(SctpTransportPerformanceTest, Throughput) {
+  for (size_t message_size : {1024, 64 * 1024, 1024 * 1024}) {
+    rtc::StringBuilder trace;
+    trace << message_size << "_byte_messages";
+    webrtc::test::PrintResult("sctp_transport", "", trace.str(),
+                              MeasureThroughputMbps(message_size), "Mbps",
+                              true);
+  }
+}
+
+}  // namespace cricket
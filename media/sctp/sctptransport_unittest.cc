@@ -48,6 +48,7 @@ class SctpFakeDataReceiver : public sigslot::has_slots<> {
     received_ = false;
     last_data_ = "";
     last_params_ = ReceiveDataParams();
+    bytes_received_ = 0;
   }
 
   void OnDataReceived(const ReceiveDataParams& params,
@@ -55,9 +56,11 @@ class SctpFakeDataReceiver : public sigslot::has_slots<> {
     received_ = true;
     last_data_ = std::string(data.data<char>(), data.size());
     last_params_ = params;
+    bytes_received_ += data.size();
   }
 
   bool received() const { return received_; }
+  size_t bytes_received() const { return bytes_received_; }
   std::string last_data() const { return last_data_; }
   ReceiveDataParams last_params() const { return last_params_; }
 
@@ -65,6 +68,7 @@ class SctpFakeDataReceiver : public sigslot::has_slots<> {
   bool received_;
   std::string last_data_;
   ReceiveDataParams last_params_;
+  size_t bytes_received_ = 0;
 };
 
 class SctpTransportObserver : public sigslot::has_slots<> {
@@ -168,9 +172,11 @@ class SctpTransportTest : public testing::Test, public sigslot::has_slots<> {
   }
 
   SctpTransport* CreateTransport(FakeDtlsTransport* fake_dtls,
-                                 SctpFakeDataReceiver* recv) {
-    SctpTransport* transport =
-        new SctpTransport(rtc::Thread::Current(), fake_dtls);
+                                 SctpFakeDataReceiver* recv,
+                                 rtc::Thread* sctp_thread = nullptr) {
+    SctpTransport* transport = new SctpTransport(
+        rtc::Thread::Current(), fake_dtls,
+        sctp_thread ? sctp_thread : rtc::Thread::Current());
     // When data is received, pass it to the SctpFakeDataReceiver.
     transport->SignalDataReceived.connect(
         recv, &SctpFakeDataReceiver::OnDataReceived);
@@ -331,6 +337,44 @@ TEST_F(SctpTransportTest, NegativeOnePortTreatedAsDefault) {
   EXPECT_TRUE_WAIT(ReceivedData(&recv1, 1, "bar"), kDefaultTimeout);
 }
 
+// Received packets can be given to usrsctp on a separate thread, shared by
+// both transports here, while everything else stays on the network thread.
+TEST_F(SctpTransportTest, ProcessesReceivedPacketsOnSctpThread) {
+  std::unique_ptr<rtc::Thread> sctp_thread(rtc::Thread::Create());
+  sctp_thread->Start();
+  FakeDtlsTransport fake_dtls1("fake dtls 1", 0);
+  FakeDtlsTransport fake_dtls2("fake dtls 2", 0);
+  SctpFakeDataReceiver recv1;
+  SctpFakeDataReceiver recv2;
+  std::unique_ptr<SctpTransport> transport1(
+      CreateTransport(&fake_dtls1, &recv1, sctp_thread.get()));
+  std::unique_ptr<SctpTransport> transport2(
+      CreateTransport(&fake_dtls2, &recv2, sctp_thread.get()));
+  transport1->OpenStream(1);
+  transport2->OpenStream(1);
+  transport1->Start(kTransport1Port, kTransport2Port);
+  transport2->Start(kTransport2Port, kTransport1Port);
+  fake_dtls1.SetDestination(&fake_dtls2, false);
+
+  SendDataResult result;
+  ASSERT_TRUE_WAIT(transport1->ReadyToSendData(), kDefaultTimeout);
+  ASSERT_TRUE(SendData(transport1.get(), 1, "foo", &result));
+  ASSERT_TRUE(SendData(transport2.get(), 1, "bar", &result));
+  EXPECT_TRUE_WAIT(ReceivedData(&recv2, 1, "foo"), kDefaultTimeout);
+  EXPECT_TRUE_WAIT(ReceivedData(&recv1, 1, "bar"), kDefaultTimeout);
+
+  SctpTransportStats stats = transport2->GetStats();
+  EXPECT_EQ(1u, stats.messages_sent);
+  EXPECT_EQ(3u, stats.bytes_sent);
+  EXPECT_EQ(1u, stats.messages_received);
+  EXPECT_EQ(3u, stats.bytes_received);
+  EXPECT_GT(stats.packets_received, 0u);
+  EXPECT_GT(stats.packet_receive_batches, 0u);
+  EXPECT_LE(stats.packet_receive_batches, stats.packets_received);
+  EXPECT_GT(stats.packets_sent, 0u);
+  EXPECT_GE(stats.srtt_ms, 0);
+}
+
 TEST_F(SctpTransportTest, OpenStreamWithAlreadyOpenedStreamFails) {
   FakeDtlsTransport fake_dtls("fake dtls", 0);
   SctpFakeDataReceiver recv;
@@ -447,6 +491,32 @@ TEST_F(SctpTransportTest, SendDataBlocked) {
   EXPECT_EQ(SDR_BLOCK, result);
 }
 
+// A message that does not fit in the send buffer is taken by usrsctp in parts.
+// It is still accepted as a whole, and other messages are blocked until all of
+// it has been handed over.
+TEST_F(SctpTransportTest, SendsMessageLargerThanSendBuffer) {
+  SetupConnectedTransportsWithTwoStreams();
+  EXPECT_EQ_WAIT(1, transport1_ready_to_send_count(), kDefaultTimeout);
+
+  const size_t kMessageSize = 1024 * 1024;
+  SendDataParams params;
+  params.sid = 1;
+  rtc::CopyOnWriteBuffer large_message(kMessageSize);
+  memset(large_message.data<uint8_t>(), 'x', kMessageSize);
+  SendDataResult result;
+  ASSERT_TRUE(transport1()->SendData(params, large_message, &result));
+  EXPECT_EQ(SDR_SUCCESS, result);
+
+  // The rest of the large message is still waiting for room.
+  EXPECT_FALSE(SendData(transport1(), 2, "small", &result));
+  EXPECT_EQ(SDR_BLOCK, result);
+
+  EXPECT_EQ_WAIT(2, transport1_ready_to_send_count(), kDefaultTimeout);
+  EXPECT_EQ_WAIT(kMessageSize, receiver2()->bytes_received(), kDefaultTimeout);
+  ASSERT_TRUE(SendData(transport1(), 2, "small", &result));
+  EXPECT_TRUE_WAIT(ReceivedData(receiver2(), 2, "small"), kDefaultTimeout);
+}
+
 // Trying to send data for a nonexistent stream should fail.
 TEST_F(SctpTransportTest, SendDataWithNonexistentStreamFails) {
   SetupConnectedTransportsWithTwoStreams();
@@ -48,6 +48,27 @@ constexpr uint16_t kMinSctpSid = 0;
 // usrsctp.h)
 const int kSctpDefaultPort = 5000;
 
+// Counters for one SCTP association.
+struct SctpTransportStats {
+  // Data channel messages.
+  uint64_t messages_sent = 0;
+  uint64_t bytes_sent = 0;
+  uint64_t messages_received = 0;
+  uint64_t bytes_received = 0;
+  // SCTP packets, and the number of tasks that were used to hand them between
+  // threads. More packets per batch means less overhead per packet.
+  uint64_t packets_sent = 0;
+  uint64_t packet_send_batches = 0;
+  uint64_t packets_received = 0;
+  uint64_t packet_receive_batches = 0;
+  // Time received packets waited before usrsctp processed them. Only nonzero
+  // when packets are processed on a separate SCTP thread.
+  int64_t total_receive_queue_delay_us = 0;
+  int64_t max_receive_queue_delay_us = 0;
+  // Smoothed round trip time of the primary path, or -1 without a socket.
+  int srtt_ms = -1;
+};
+
 // Abstract SctpTransport interface for use internally (by PeerConnection etc.).
 // Exists to allow mock/fake SctpTransports to be created.
 class SctpTransportInternal {
@@ -120,6 +141,9 @@ class SctpTransportInternal {
   // and outgoing streams reset).
   sigslot::signal1<int> SignalClosingProcedureComplete;
 
+  // Returns counters for the association.
+  virtual SctpTransportStats GetStats() const = 0;
+
   // Helper for debugging.
   virtual void set_debug_name_for_testing(const char* debug_name) = 0;
 };
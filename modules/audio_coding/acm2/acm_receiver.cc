@@ -182,6 +182,14 @@ int AcmReceiver::GetAudio(int desired_freq_hz,
   return 0;
 }
 
+void AcmReceiver::SkipAudio() {
+  rtc::CritScope lock(&crit_sect_);
+  neteq_->SkipAudio();
+  // The last output frame no longer precedes the next one; don't prime the
+  // resampler with it.
+  resampled_last_output_frame_ = true;
+}
+
 void AcmReceiver::SetCodecs(const std::map<int, SdpAudioFormat>& codecs) {
   neteq_->SetCodecs(codecs);
 }
@@ -78,6 +78,12 @@ class AcmReceiver {
   //
   int GetAudio(int desired_freq_hz, AudioFrame* audio_frame, bool* muted);
 
+  //
+  // Advances the playout position by 10 ms without decoding. See
+  // NetEq::SkipAudio().
+  //
+  void SkipAudio();
+
   // Replace the current set of decoders with the specified set.
   void SetCodecs(const std::map<int, SdpAudioFormat>& codecs);
 
@@ -161,6 +161,8 @@ class AudioCodingModuleImpl final : public AudioCodingModule {
                       AudioFrame* audio_frame,
                       bool* muted) override;
 
+  void SkipPlayout10Ms() override;
+
   /////////////////////////////////////////
   //   Statistics
   //
@@ -1079,6 +1081,10 @@ int AudioCodingModuleImpl::PlayoutData10Ms(int desired_freq_hz,
   return 0;
 }
 
+void AudioCodingModuleImpl::SkipPlayout10Ms() {
+  receiver_.SkipAudio();
+}
+
 /////////////////////////////////////////
 //   Statistics
 //
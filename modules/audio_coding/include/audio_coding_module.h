@@ -621,6 +621,15 @@ class AudioCodingModule {
                                   AudioFrame* audio_frame,
                                   bool* muted) = 0;
 
+  ///////////////////////////////////////////////////////////////////////////
+  // void SkipPlayout10Ms()
+  // Advances playout by 10 milliseconds without decoding any audio. Packets
+  // that would have been played out are discarded. The next call to
+  // PlayoutData10Ms() resumes from the next packet in the jitter buffer, with
+  // a reset decoder.
+  //
+  virtual void SkipPlayout10Ms() = 0;
+
   ///////////////////////////////////////////////////////////////////////////
   //   Codec specific
   //
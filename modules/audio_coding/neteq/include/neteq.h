@@ -110,10 +110,21 @@ class NetEq {
     bool enable_muted_state = false;
     absl::optional<AudioCodecPairId> codec_pair_id;
     bool for_test_no_time_stretching = false;  // Use only for testing.
+    // Creates a reduced-footprint instance intended for servers that only
+    // occasionally play out the stream, e.g. for audio level analysis or
+    // selective mixing. It keeps a short packet buffer and decodes only when
+    // GetAudio() is called. There is no time-stretching, DTMF playout or
+    // RFC 3389 comfort noise, and packet loss is concealed by the decoder's
+    // own PLC, if any, or by zeros.
+    bool enable_lite_mode = false;
   };
 
   enum ReturnCodes { kOK = 0, kFail = -1 };
 
+  // The number of consecutive SkipAudio() calls after which the decoder is
+  // reset rather than continued from where it left off.
+  static const int kMaxSkippedFramesWithoutReset = 50;  // 500 ms.
+
   // Creates a new NetEq object, with parameters set in |config|. The |config|
   // object will only have to be valid for the duration of the call to this
   // method.
@@ -154,6 +165,15 @@ class NetEq {
       bool* muted,
       absl::optional<Operations> action_override = absl::nullopt) = 0;
 
+  // Advances the playout position by 10 ms without decoding or producing any
+  // audio. Packets that the playout position passes are discarded. The first
+  // GetAudio() call after one or more SkipAudio() calls starts over from the
+  // next packet in the buffer. The decoder state is kept across a short run
+  // of SkipAudio() calls, as across lost packets, and only reset after a long
+  // one. This lets streams that are only played out some of the time, e.g. by
+  // a selective mixer, keep up with the sender without running their decoder.
+  virtual void SkipAudio() = 0;
+
   // Replaces the current set of decoders with the given one.
   virtual void SetCodecs(const std::map<int, SdpAudioFormat>& codecs) = 0;
 
@@ -286,6 +306,10 @@ class NetEq {
   // Mainly intended for testing.
   virtual int SyncBufferSizeMs() const = 0;
 
+  // Returns an estimate of the memory in bytes held by this instance. Decoder
+  // instances and packet payloads are not included.
+  virtual size_t EstimatedMemoryUsageBytes() const = 0;
+
  protected:
   NetEq() {}
 
@@ -13,6 +13,7 @@
 #include <memory>
 
 #include "modules/audio_coding/neteq/neteq_impl.h"
+#include "modules/audio_coding/neteq/neteq_lite.h"
 #include "rtc_base/strings/string_builder.h"
 
 namespace webrtc {
@@ -32,7 +33,8 @@ std::string NetEq::Config::ToString() const {
      << ", max_packets_in_buffer=" << max_packets_in_buffer
      << ", enable_fast_accelerate="
      << (enable_fast_accelerate ? " true" : "false")
-     << ", enable_muted_state=" << (enable_muted_state ? " true" : "false");
+     << ", enable_muted_state=" << (enable_muted_state ? " true" : "false")
+     << ", enable_lite_mode=" << (enable_lite_mode ? " true" : "false");
   return ss.str();
 }
 
@@ -41,6 +43,9 @@ std::string NetEq::Config::ToString() const {
 NetEq* NetEq::Create(
     const NetEq::Config& config,
     const rtc::scoped_refptr<AudioDecoderFactory>& decoder_factory) {
+  if (config.enable_lite_mode) {
+    return new NetEqLite(config, decoder_factory);
+  }
   return new NetEqImpl(config,
                        NetEqImpl::Dependencies(config, decoder_factory));
 }
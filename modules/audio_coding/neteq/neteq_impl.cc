@@ -157,6 +157,7 @@ void NetEqImpl::InsertEmptyPacket(const RTPHeader& /*rtp_header*/) {
 }
 
 namespace {
+
 void SetAudioFrameActivityAndType(bool vad_enabled,
                                   NetEqImpl::OutputType type,
                                   AudioFrame::VADActivity last_vad_activity,
@@ -204,6 +205,7 @@ int NetEqImpl::GetAudio(AudioFrame* audio_frame,
                         absl::optional<Operations> action_override) {
   TRACE_EVENT0("webrtc", "NetEqImpl::GetAudio");
   rtc::CritScope lock(&crit_sect_);
+  skipped_frames_ = 0;
   if (GetAudioInternal(audio_frame, muted, action_override) != 0) {
     return kFail;
   }
@@ -223,6 +225,30 @@ int NetEqImpl::GetAudio(AudioFrame* audio_frame,
   return kOK;
 }
 
+void NetEqImpl::SkipAudio() {
+  TRACE_EVENT0("webrtc", "NetEqImpl::SkipAudio");
+  rtc::CritScope lock(&crit_sect_);
+  last_decoded_timestamps_.clear();
+  tick_timer_->Increment();
+  if (first_packet_) {
+    return;
+  }
+  // Move the playout position one frame ahead, past any audio left in the
+  // sync buffer, and drop the packets that should have been played out by now.
+  playout_timestamp_ += static_cast<uint32_t>(output_size_samples_);
+  sync_buffer_->set_next_index(sync_buffer_->Size());
+  sync_buffer_->set_end_timestamp(playout_timestamp_);
+  packet_buffer_->DiscardOldPackets(playout_timestamp_, 5 * fs_hz_, &stats_);
+  // Make the next GetAudio() call start over from the next packet in the
+  // buffer, the same way as after a codec change. If the buffer is empty, a
+  // later packet is handled as a future packet instead. Across a short gap the
+  // decoder continues as after lost packets; it is only reset once the gap
+  // gets long.
+  new_codec_ = !packet_buffer_->Empty();
+  if (++skipped_frames_ == kMaxSkippedFramesWithoutReset + 1)
+    reset_decoder_ = true;
+}
+
 void NetEqImpl::SetCodecs(const std::map<int, SdpAudioFormat>& codecs) {
   rtc::CritScope lock(&crit_sect_);
   const std::vector<int> changed_payload_types =
@@ -512,6 +538,32 @@ int NetEqImpl::SyncBufferSizeMs() const {
                                  rtc::CheckedDivExact(fs_hz_, 1000));
 }
 
+size_t NetEqImpl::EstimatedMemoryUsageBytes() const {
+  rtc::CritScope lock(&crit_sect_);
+  int num_packets = 0;
+  int max_num_packets = 0;
+  packet_buffer_->BufferStat(&num_packets, &max_num_packets);
+  size_t bytes = sizeof(*this) + sizeof(*packet_buffer_) +
+                 static_cast<size_t>(max_num_packets) * sizeof(Packet) +
+                 sizeof(*delay_manager_) + sizeof(*dtmf_buffer_) +
+                 sizeof(*dtmf_tone_generator_) +
+                 decoded_buffer_length_ * sizeof(int16_t);
+  // The signal processing components are sized by the sample rate and the
+  // number of channels, and are recreated when either changes.
+  if (sync_buffer_) {
+    bytes += sync_buffer_->Channels() *
+             (sync_buffer_->Size() + algorithm_buffer_->Size()) *
+             sizeof(int16_t);
+  }
+  if (expand_) {
+    bytes += sizeof(*expand_) + sizeof(*merge_) + sizeof(*normal_) +
+             sizeof(*accelerate_) + sizeof(*preemptive_expand_) +
+             sizeof(*comfort_noise_) + sizeof(*background_noise_) +
+             sizeof(*decision_logic_);
+  }
+  return bytes;
+}
+
 const SyncBuffer* NetEqImpl::sync_buffer_for_test() const {
   rtc::CritScope lock(&crit_sect_);
   return sync_buffer_.get();
@@ -136,6 +136,8 @@ class NetEqImpl : public webrtc::NetEq {
       bool* muted,
       absl::optional<Operations> action_override = absl::nullopt) override;
 
+  void SkipAudio() override;
+
   void SetCodecs(const std::map<int, SdpAudioFormat>& codecs) override;
 
   int RegisterPayloadType(NetEqDecoder codec,
@@ -213,6 +215,8 @@ class NetEqImpl : public webrtc::NetEq {
 
   int SyncBufferSizeMs() const override;
 
+  size_t EstimatedMemoryUsageBytes() const override;
+
   // This accessor method is only intended for testing purposes.
   const SyncBuffer* sync_buffer_for_test() const;
   Operations last_operation_for_test() const;
@@ -410,6 +414,8 @@ class NetEqImpl : public webrtc::NetEq {
   bool new_codec_ RTC_GUARDED_BY(crit_sect_);
   uint32_t timestamp_ RTC_GUARDED_BY(crit_sect_);
   bool reset_decoder_ RTC_GUARDED_BY(crit_sect_);
+  // The number of SkipAudio() calls since the last GetAudio() call.
+  int skipped_frames_ RTC_GUARDED_BY(crit_sect_) = 0;
   absl::optional<uint8_t> current_rtp_payload_type_ RTC_GUARDED_BY(crit_sect_);
   absl::optional<uint8_t> current_cng_rtp_payload_type_
       RTC_GUARDED_BY(crit_sect_);
@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
 #include <memory>
 
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
@@ -426,6 +427,138 @@ TEST_F(NetEqImplTest, InsertPacketsUntilBufferIsFull) {
   EXPECT_EQ(rtp_header.sequenceNumber, test_packet->sequence_number);
 }
 
+// Verifies that SkipAudio() drops the packets that the playout position has
+// passed without decoding them, and that decoding resumes after them.
+TEST_F(NetEqImplTest, SkipAudioDiscardsPlayedOutPackets) {
+  UseNoMocks();
+  CreateInstance();
+
+  const int kPayloadLengthSamples = 80;  // 10 ms at 8 kHz.
+  const size_t kPayloadLengthBytes = 2 * kPayloadLengthSamples;  // PCM 16-bit.
+  const uint8_t kPayloadType = 17;  // Just an arbitrary number.
+  const uint32_t kReceiveTime = 17;  // Value doesn't matter for this test.
+  const size_t kNumPackets = 10;
+  const size_t kNumSkippedFrames = 5;
+  uint8_t payload[kPayloadLengthBytes] = {0};
+  RTPHeader rtp_header;
+  rtp_header.payloadType = kPayloadType;
+  rtp_header.sequenceNumber = 0x1234;
+  rtp_header.timestamp = 0x12345678;
+  rtp_header.ssrc = 0x87654321;
+  const uint32_t first_timestamp = rtp_header.timestamp;
+
+  EXPECT_EQ(NetEq::kOK, neteq_->RegisterPayloadType(
+                            NetEqDecoder::kDecoderPCM16B, "", kPayloadType));
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(NetEq::kOK,
+              neteq_->InsertPacket(rtp_header, payload, kReceiveTime));
+    rtp_header.timestamp += kPayloadLengthSamples;
+    rtp_header.sequenceNumber += 1;
+  }
+
+  AudioFrame output;
+  bool muted;
+  EXPECT_EQ(NetEq::kOK, neteq_->GetAudio(&output, &muted));
+  const size_t packets_before_skipping = packet_buffer_->NumPacketsInBuffer();
+
+  for (size_t i = 0; i < kNumSkippedFrames; ++i) {
+    neteq_->SkipAudio();
+    EXPECT_TRUE(neteq_->LastDecodedTimestamps().empty());
+  }
+  EXPECT_EQ(packets_before_skipping - kNumSkippedFrames,
+            packet_buffer_->NumPacketsInBuffer());
+
+  EXPECT_EQ(NetEq::kOK, neteq_->GetAudio(&output, &muted));
+  EXPECT_FALSE(muted);
+  EXPECT_EQ(AudioFrame::kNormalSpeech, output.speech_type_);
+  const std::vector<uint32_t> decoded = neteq_->LastDecodedTimestamps();
+  ASSERT_FALSE(decoded.empty());
+  EXPECT_GE(decoded[0],
+            first_timestamp + (kNumSkippedFrames + 1) * kPayloadLengthSamples);
+}
+
+// Verifies that the decoder state is kept across a short run of SkipAudio()
+// calls, and that the decoder is reset after a long one.
+TEST_F(NetEqImplTest, SkipAudioResetsDecoderOnlyAfterLongGap) {
+  UseNoMocks();
+  CreateInstance();
+
+  const uint8_t kPayloadType = 17;   // Just an arbitrary number.
+  const uint32_t kReceiveTime = 17;  // Value doesn't matter for this test.
+  const int kSampleRateHz = 8000;
+  const size_t kPayloadLengthSamples =
+      static_cast<size_t>(10 * kSampleRateHz / 1000);  // 10 ms.
+  const size_t kPayloadLengthBytes = kPayloadLengthSamples;
+  uint8_t payload[kPayloadLengthBytes] = {0};
+  RTPHeader rtp_header;
+  rtp_header.payloadType = kPayloadType;
+  rtp_header.sequenceNumber = 0x1234;
+  rtp_header.timestamp = 0x12345678;
+  rtp_header.ssrc = 0x87654321;
+
+  // A dummy decoder that produces as many zero samples as the input has
+  // bytes, and counts how often it is reset.
+  class ResetCountingDecoder : public AudioDecoder {
+   public:
+    int DecodeInternal(const uint8_t* encoded,
+                       size_t encoded_len,
+                       int /* sample_rate_hz */,
+                       int16_t* decoded,
+                       SpeechType* speech_type) override {
+      std::fill(decoded, decoded + encoded_len, 0);
+      *speech_type = kSpeech;
+      return rtc::checked_cast<int>(encoded_len);
+    }
+
+    void Reset() override { ++num_resets_; }
+
+    int SampleRateHz() const override { return kSampleRateHz; }
+
+    size_t Channels() const override { return 1; }
+
+    int num_resets() const { return num_resets_; }
+
+   private:
+    int num_resets_ = 0;
+  } decoder;
+
+  EXPECT_EQ(NetEq::kOK, neteq_->RegisterExternalDecoder(
+                            &decoder, NetEqDecoder::kDecoderPCM16B,
+                            "dummy name", kPayloadType));
+
+  auto insert_next_packet = [&]() {
+    EXPECT_EQ(NetEq::kOK,
+              neteq_->InsertPacket(rtp_header, payload, kReceiveTime));
+    rtp_header.timestamp += kPayloadLengthSamples;
+    rtp_header.sequenceNumber += 1;
+  };
+
+  AudioFrame output;
+  bool muted;
+  insert_next_packet();
+  insert_next_packet();
+  EXPECT_EQ(NetEq::kOK, neteq_->GetAudio(&output, &muted));
+  const int resets_before_skipping = decoder.num_resets();
+
+  // A 50 ms gap.
+  for (int i = 0; i < 5; ++i) {
+    insert_next_packet();
+    neteq_->SkipAudio();
+  }
+  insert_next_packet();
+  EXPECT_EQ(NetEq::kOK, neteq_->GetAudio(&output, &muted));
+  EXPECT_EQ(resets_before_skipping, decoder.num_resets());
+
+  // A 1 s gap.
+  for (int i = 0; i < 100; ++i) {
+    insert_next_packet();
+    neteq_->SkipAudio();
+  }
+  insert_next_packet();
+  EXPECT_EQ(NetEq::kOK, neteq_->GetAudio(&output, &muted));
+  EXPECT_GT(decoder.num_resets(), resets_before_skipping);
+}
+
 TEST_F(NetEqImplTest, TestDtmfPacketAVT) {
   TestDtmfPacket(NetEqDecoder::kDecoderAVT);
 }
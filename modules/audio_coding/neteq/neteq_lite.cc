@@ -0,0 +1,671 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/neteq/neteq_lite.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "api/audio/audio_frame.h"
+#include "api/audio_codecs/audio_decoder.h"
+#include "common_types.h"  // NOLINT(build/include)
+#include "modules/audio_coding/neteq/decoder_database.h"
+#include "modules/audio_coding/neteq/packet_buffer.h"
+#include "modules/audio_coding/neteq/red_payload_splitter.h"
+#include "modules/audio_coding/neteq/tick_timer.h"
+#include "modules/audio_coding/neteq/timestamp_scaler.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/numerics/safe_conversions.h"
+#include "rtc_base/sanitizer.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kOutputSizeMs = 10;
+// Used for sizing the decode buffer when a frame cannot tell its duration.
+const size_t kMaxFrameSize = 5760;  // 120 ms @ 48 kHz.
+// The packet buffer target level when no minimum delay is set.
+const int kDefaultTargetDelayMs = 40;
+// The amount of audio above the target level that is tolerated before the
+// oldest packets are discarded.
+const int kMaxExcessDelayMs = 80;
+// The number of consecutive concealed output frames after which playout stops
+// until the packet buffer has refilled to the target level.
+const int kMaxConcealedFrames = 10;
+
+int ValidSampleRate(int fs_hz) {
+  if (fs_hz != 8000 && fs_hz != 16000 && fs_hz != 32000 && fs_hz != 48000) {
+    RTC_LOG(LS_ERROR) << "Sample rate " << fs_hz << " Hz not supported. "
+                      << "Changing to 8000 Hz.";
+    return 8000;
+  }
+  return fs_hz;
+}
+
+}  // namespace
+
+NetEqLite::NetEqLite(
+    const NetEq::Config& config,
+    const rtc::scoped_refptr<AudioDecoderFactory>& decoder_factory)
+    : tick_timer_(new TickTimer),
+      decoder_database_(
+          new DecoderDatabase(decoder_factory, config.codec_pair_id)),
+      packet_buffer_(
+          new PacketBuffer(config.max_packets_in_buffer, tick_timer_.get())),
+      red_payload_splitter_(new RedPayloadSplitter),
+      timestamp_scaler_(new TimestampScaler(*decoder_database_)),
+      enable_muted_state_(config.enable_muted_state),
+      fs_hz_(ValidSampleRate(config.sample_rate_hz)),
+      output_size_samples_(kOutputSizeMs * fs_hz_ / 1000),
+      decoder_frame_length_(3 * output_size_samples_),
+      last_output_sample_rate_hz_(fs_hz_),
+      maximum_delay_ms_(config.max_delay_ms) {
+  RTC_LOG(LS_INFO) << "NetEq config: " << config.ToString();
+}
+
+NetEqLite::~NetEqLite() = default;
+
+int NetEqLite::InsertPacket(const RTPHeader& rtp_header,
+                            rtc::ArrayView<const uint8_t> payload,
+                            uint32_t receive_timestamp) {
+  rtc::MsanCheckInitialized(payload);
+  TRACE_EVENT0("webrtc", "NetEqLite::InsertPacket");
+  rtc::CritScope lock(&crit_sect_);
+  if (payload.empty()) {
+    RTC_LOG_F(LS_ERROR) << "payload is empty";
+    return kFail;
+  }
+
+  PacketList packet_list;
+  packet_list.push_back([&rtp_header, &payload] {
+    Packet packet;
+    packet.payload_type = rtp_header.payloadType;
+    packet.sequence_number = rtp_header.sequenceNumber;
+    packet.timestamp = rtp_header.timestamp;
+    packet.payload.SetData(payload.data(), payload.size());
+    return packet;
+  }());
+
+  if (first_packet_ || rtp_header.ssrc != ssrc_) {
+    timestamp_scaler_->Reset();
+    rtcp_.Init(rtp_header.sequenceNumber);
+    packet_buffer_->Flush();
+    ssrc_ = rtp_header.ssrc;
+    first_packet_ = false;
+    playing_ = false;
+  }
+  rtcp_.Update(rtp_header, receive_timestamp);
+
+  if (decoder_database_->IsRed(rtp_header.payloadType)) {
+    if (!red_payload_splitter_->SplitRed(&packet_list)) {
+      return kFail;
+    }
+    red_payload_splitter_->CheckRedPayloads(&packet_list, *decoder_database_);
+    if (packet_list.empty()) {
+      return kFail;
+    }
+  }
+  if (decoder_database_->CheckPayloadTypes(packet_list) ==
+      DecoderDatabase::kDecoderNotFound) {
+    return kFail;
+  }
+  timestamp_scaler_->ToInternal(&packet_list);
+
+  // Parse the payloads into frames, but leave the decoding to GetAudio().
+  PacketList parsed_packet_list;
+  for (Packet& packet : packet_list) {
+    const DecoderDatabase::DecoderInfo* info =
+        decoder_database_->GetDecoderInfo(packet.payload_type);
+    RTC_DCHECK(info);
+    if (info->IsDtmf()) {
+      // DTMF events are not played out.
+      continue;
+    }
+    if (info->IsComfortNoise()) {
+      parsed_packet_list.push_back(std::move(packet));
+      continue;
+    }
+    std::vector<AudioDecoder::ParseResult> results =
+        info->GetDecoder()->ParsePayload(std::move(packet.payload),
+                                         packet.timestamp);
+    for (auto& result : results) {
+      RTC_DCHECK(result.frame);
+      Packet parsed_packet;
+      parsed_packet.sequence_number = packet.sequence_number;
+      parsed_packet.payload_type = packet.payload_type;
+      parsed_packet.timestamp = result.timestamp;
+      parsed_packet.priority.codec_level = result.priority;
+      parsed_packet.priority.red_level = packet.priority.red_level;
+      parsed_packet.frame = std::move(result.frame);
+      parsed_packet_list.push_back(std::move(parsed_packet));
+    }
+  }
+  if (parsed_packet_list.empty()) {
+    return kOK;
+  }
+
+  const int ret = packet_buffer_->InsertPacketList(
+      &parsed_packet_list, *decoder_database_, &current_rtp_payload_type_,
+      &current_cng_rtp_payload_type_, &stats_);
+  if (ret == PacketBuffer::kFlushed) {
+    playing_ = false;
+  } else if (ret != PacketBuffer::kOK) {
+    return kFail;
+  }
+  // Keep the buffer short also for streams that are not played out, so that
+  // playout can start from recent audio as soon as GetAudio() is called.
+  LimitBufferLevel();
+  return kOK;
+}
+
+void NetEqLite::InsertEmptyPacket(const RTPHeader& /*rtp_header*/) {}
+
+int NetEqLite::GetAudio(AudioFrame* audio_frame,
+                        bool* muted,
+                        absl::optional<Operations> /*action_override*/) {
+  TRACE_EVENT0("webrtc", "NetEqLite::GetAudio");
+  rtc::CritScope lock(&crit_sect_);
+  *muted = false;
+  skipped_frames_ = 0;
+  last_decoded_timestamps_.clear();
+  tick_timer_->Increment();
+  stats_.IncreaseCounter(output_size_samples_, fs_hz_);
+
+  audio_frame->ResetWithoutMuting();
+  if (FillDecodedAudio()) {
+    const size_t num_samples = output_size_samples_ * channels_;
+    RTC_CHECK_LE(num_samples, AudioFrame::kMaxDataSizeSamples);
+    memcpy(audio_frame->mutable_data(), decoded_.data() + decoded_read_index_,
+           num_samples * sizeof(int16_t));
+    decoded_read_index_ += num_samples;
+    playout_timestamp_ =
+        timestamp_ - static_cast<uint32_t>(FutureDecodedSamples());
+    if (last_frame_concealed_) {
+      audio_frame->speech_type_ = AudioFrame::kPLC;
+    } else if (in_cng_ || last_speech_type_ == AudioDecoder::kComfortNoise) {
+      audio_frame->speech_type_ = AudioFrame::kCNG;
+    } else {
+      audio_frame->speech_type_ = AudioFrame::kNormalSpeech;
+    }
+  } else {
+    // Nothing is playing; output silence.
+    if (enable_muted_state_) {
+      audio_frame->Mute();
+      *muted = true;
+    } else {
+      memset(audio_frame->mutable_data(), 0,
+             output_size_samples_ * channels_ * sizeof(int16_t));
+    }
+    if (!first_packet_) {
+      stats_.ExpandedNoiseSamples(output_size_samples_, false);
+    }
+    playout_timestamp_ += static_cast<uint32_t>(output_size_samples_);
+    audio_frame->speech_type_ = AudioFrame::kPLCCNG;
+  }
+  audio_frame->sample_rate_hz_ = fs_hz_;
+  audio_frame->samples_per_channel_ = output_size_samples_;
+  audio_frame->num_channels_ = channels_;
+  audio_frame->vad_activity_ = AudioFrame::kVadUnknown;
+  audio_frame->timestamp_ =
+      first_packet_
+          ? 0
+          : timestamp_scaler_->ToExternal(playout_timestamp_) -
+                static_cast<uint32_t>(output_size_samples_);
+  last_output_sample_rate_hz_ = fs_hz_;
+  return kOK;
+}
+
+void NetEqLite::SkipAudio() {
+  TRACE_EVENT0("webrtc", "NetEqLite::SkipAudio");
+  rtc::CritScope lock(&crit_sect_);
+  last_decoded_timestamps_.clear();
+  tick_timer_->Increment();
+  playout_timestamp_ += static_cast<uint32_t>(output_size_samples_);
+  if (playing_) {
+    // The buffer level is kept in check by LimitBufferLevel() on insertion.
+    // Playout restarts from the buffer the next time GetAudio() is called.
+    playing_ = false;
+    decoded_.Clear();
+    decoded_read_index_ = 0;
+  }
+  // Across a short gap the decoder continues as after lost packets. It is only
+  // reset once the gap gets long.
+  if (++skipped_frames_ == kMaxSkippedFramesWithoutReset + 1) {
+    AudioDecoder* decoder = decoder_database_->GetActiveDecoder();
+    if (decoder) {
+      decoder->Reset();
+    }
+  }
+}
+
+void NetEqLite::SetCodecs(const std::map<int, SdpAudioFormat>& codecs) {
+  rtc::CritScope lock(&crit_sect_);
+  const std::vector<int> changed_payload_types =
+      decoder_database_->SetCodecs(codecs);
+  for (const int pt : changed_payload_types) {
+    packet_buffer_->DiscardPacketsWithPayloadType(pt, &stats_);
+  }
+}
+
+int NetEqLite::RegisterPayloadType(NetEqDecoder codec,
+                                   const std::string& name,
+                                   uint8_t rtp_payload_type) {
+  rtc::CritScope lock(&crit_sect_);
+  if (decoder_database_->RegisterPayload(rtp_payload_type, codec, name) !=
+      DecoderDatabase::kOK) {
+    return kFail;
+  }
+  return kOK;
+}
+
+int NetEqLite::RegisterExternalDecoder(AudioDecoder* decoder,
+                                       NetEqDecoder codec,
+                                       const std::string& codec_name,
+                                       uint8_t rtp_payload_type) {
+  rtc::CritScope lock(&crit_sect_);
+  if (!decoder) {
+    RTC_LOG(LS_ERROR) << "Cannot register external decoder with NULL pointer";
+    RTC_NOTREACHED();
+    return kFail;
+  }
+  if (decoder_database_->InsertExternal(rtp_payload_type, codec, codec_name,
+                                        decoder) != DecoderDatabase::kOK) {
+    return kFail;
+  }
+  return kOK;
+}
+
+bool NetEqLite::RegisterPayloadType(int rtp_payload_type,
+                                    const SdpAudioFormat& audio_format) {
+  rtc::CritScope lock(&crit_sect_);
+  return decoder_database_->RegisterPayload(rtp_payload_type, audio_format) ==
+         DecoderDatabase::kOK;
+}
+
+int NetEqLite::RemovePayloadType(uint8_t rtp_payload_type) {
+  rtc::CritScope lock(&crit_sect_);
+  int ret = decoder_database_->Remove(rtp_payload_type);
+  if (ret == DecoderDatabase::kOK || ret == DecoderDatabase::kDecoderNotFound) {
+    packet_buffer_->DiscardPacketsWithPayloadType(rtp_payload_type, &stats_);
+    return kOK;
+  }
+  return kFail;
+}
+
+void NetEqLite::RemoveAllPayloadTypes() {
+  rtc::CritScope lock(&crit_sect_);
+  decoder_database_->RemoveAll();
+}
+
+bool NetEqLite::SetMinimumDelay(int delay_ms) {
+  rtc::CritScope lock(&crit_sect_);
+  if (delay_ms < 0 || delay_ms > 10000 ||
+      (maximum_delay_ms_ > 0 && delay_ms > maximum_delay_ms_)) {
+    return false;
+  }
+  minimum_delay_ms_ = delay_ms;
+  return true;
+}
+
+bool NetEqLite::SetMaximumDelay(int delay_ms) {
+  rtc::CritScope lock(&crit_sect_);
+  if (delay_ms < 0 || delay_ms > 10000 ||
+      (delay_ms > 0 && delay_ms < minimum_delay_ms_)) {
+    return false;
+  }
+  maximum_delay_ms_ = delay_ms;
+  return true;
+}
+
+int NetEqLite::TargetDelayMs() const {
+  rtc::CritScope lock(&crit_sect_);
+  return TargetDelayMsInternal();
+}
+
+int NetEqLite::CurrentDelayMs() const {
+  rtc::CritScope lock(&crit_sect_);
+  return rtc::dchecked_cast<int>(
+      (BufferedSamples() + FutureDecodedSamples()) /
+      rtc::CheckedDivExact(fs_hz_, 1000));
+}
+
+int NetEqLite::FilteredCurrentDelayMs() const {
+  // There is no buffer level filter; report the instantaneous delay.
+  return CurrentDelayMs();
+}
+
+int NetEqLite::NetworkStatistics(NetEqNetworkStatistics* stats) {
+  rtc::CritScope lock(&crit_sect_);
+  stats->preferred_buffer_size_ms = TargetDelayMsInternal();
+  stats->jitter_peaks_found = false;
+  stats->clockdrift_ppm = 0;
+  stats_.GetNetworkStatistics(fs_hz_,
+                              BufferedSamples() + FutureDecodedSamples(),
+                              decoder_frame_length_, stats);
+  return 0;
+}
+
+NetEqLifetimeStatistics NetEqLite::GetLifetimeStatistics() const {
+  rtc::CritScope lock(&crit_sect_);
+  return stats_.GetLifetimeStatistics();
+}
+
+NetEqOperationsAndState NetEqLite::GetOperationsAndState() const {
+  rtc::CritScope lock(&crit_sect_);
+  auto result = stats_.GetOperationsAndState();
+  result.current_buffer_size_ms =
+      (BufferedSamples() + FutureDecodedSamples()) * 1000 / fs_hz_;
+  return result;
+}
+
+void NetEqLite::GetRtcpStatistics(RtcpStatistics* stats) {
+  rtc::CritScope lock(&crit_sect_);
+  if (stats) {
+    rtcp_.GetStatistics(false, stats);
+  }
+}
+
+void NetEqLite::GetRtcpStatisticsNoReset(RtcpStatistics* stats) {
+  rtc::CritScope lock(&crit_sect_);
+  if (stats) {
+    rtcp_.GetStatistics(true, stats);
+  }
+}
+
+void NetEqLite::EnableVad() {
+  RTC_LOG(LS_WARNING) << "Post-decode VAD is not supported in lite mode";
+}
+
+void NetEqLite::DisableVad() {}
+
+absl::optional<uint32_t> NetEqLite::GetPlayoutTimestamp() const {
+  rtc::CritScope lock(&crit_sect_);
+  if (first_packet_ || in_cng_) {
+    return absl::nullopt;
+  }
+  return timestamp_scaler_->ToExternal(playout_timestamp_);
+}
+
+int NetEqLite::last_output_sample_rate_hz() const {
+  rtc::CritScope lock(&crit_sect_);
+  return last_output_sample_rate_hz_;
+}
+
+absl::optional<CodecInst> NetEqLite::GetDecoder(int payload_type) const {
+  rtc::CritScope lock(&crit_sect_);
+  const DecoderDatabase::DecoderInfo* di =
+      decoder_database_->GetDecoderInfo(payload_type);
+  if (!di) {
+    return absl::nullopt;
+  }
+
+  // Create a CodecInst with some fields set. The remaining fields are zeroed,
+  // but we tell MSan to consider them uninitialized.
+  CodecInst ci = {0};
+  rtc::MsanMarkUninitialized(rtc::MakeArrayView(&ci, 1));
+  ci.pltype = payload_type;
+  strncpy(ci.plname, di->get_name().c_str(), sizeof(ci.plname));
+  ci.plname[sizeof(ci.plname) - 1] = '\0';
+  ci.plfreq = di->IsRed() ? 8000 : di->SampleRateHz();
+  AudioDecoder* const decoder = di->GetDecoder();
+  ci.channels = decoder ? decoder->Channels() : 1;
+  return ci;
+}
+
+absl::optional<SdpAudioFormat> NetEqLite::GetDecoderFormat(
+    int payload_type) const {
+  rtc::CritScope lock(&crit_sect_);
+  const DecoderDatabase::DecoderInfo* const di =
+      decoder_database_->GetDecoderInfo(payload_type);
+  if (!di) {
+    return absl::nullopt;
+  }
+  return di->GetFormat();
+}
+
+void NetEqLite::FlushBuffers() {
+  rtc::CritScope lock(&crit_sect_);
+  packet_buffer_->Flush();
+  decoded_.Clear();
+  decoded_read_index_ = 0;
+  playing_ = false;
+  // Set to wait for new codec.
+  first_packet_ = true;
+}
+
+void NetEqLite::PacketBufferStatistics(int* current_num_packets,
+                                       int* max_num_packets) const {
+  rtc::CritScope lock(&crit_sect_);
+  packet_buffer_->BufferStat(current_num_packets, max_num_packets);
+}
+
+void NetEqLite::EnableNack(size_t /*max_nack_list_size*/) {
+  RTC_LOG(LS_WARNING) << "NACK is not supported in lite mode";
+}
+
+void NetEqLite::DisableNack() {}
+
+std::vector<uint16_t> NetEqLite::GetNackList(
+    int64_t /*round_trip_time_ms*/) const {
+  return std::vector<uint16_t>();
+}
+
+std::vector<uint32_t> NetEqLite::LastDecodedTimestamps() const {
+  rtc::CritScope lock(&crit_sect_);
+  return last_decoded_timestamps_;
+}
+
+int NetEqLite::SyncBufferSizeMs() const {
+  rtc::CritScope lock(&crit_sect_);
+  return rtc::dchecked_cast<int>(FutureDecodedSamples() /
+                                 rtc::CheckedDivExact(fs_hz_, 1000));
+}
+
+size_t NetEqLite::EstimatedMemoryUsageBytes() const {
+  rtc::CritScope lock(&crit_sect_);
+  int num_packets = 0;
+  int max_num_packets = 0;
+  packet_buffer_->BufferStat(&num_packets, &max_num_packets);
+  return sizeof(*this) + sizeof(*tick_timer_) + sizeof(*packet_buffer_) +
+         static_cast<size_t>(max_num_packets) * sizeof(Packet) +
+         sizeof(*red_payload_splitter_) + sizeof(*timestamp_scaler_) +
+         decoded_.capacity() * sizeof(int16_t) +
+         last_decoded_timestamps_.capacity() * sizeof(uint32_t);
+}
+
+bool NetEqLite::FillDecodedAudio() {
+  if (!playing_) {
+    const size_t target_samples =
+        static_cast<size_t>(TargetDelayMsInternal()) * fs_hz_ / 1000;
+    if (packet_buffer_->Empty() || BufferedSamples() < target_samples) {
+      return false;
+    }
+    timestamp_ = packet_buffer_->PeekNextPacket()->timestamp;
+    decoded_.Clear();
+    decoded_read_index_ = 0;
+    consecutive_concealed_frames_ = 0;
+    playing_ = true;
+  }
+
+  // Drop the audio that has already been played out.
+  if (decoded_read_index_ > 0) {
+    const size_t remaining = decoded_.size() - decoded_read_index_;
+    memmove(decoded_.data(), decoded_.data() + decoded_read_index_,
+            remaining * sizeof(int16_t));
+    decoded_.SetSize(remaining);
+    decoded_read_index_ = 0;
+  }
+
+  bool concealed = false;
+  while (FutureDecodedSamples() < output_size_samples_) {
+    packet_buffer_->DiscardAllOldPackets(timestamp_, &stats_);
+    const Packet* next_packet = packet_buffer_->PeekNextPacket();
+    if (next_packet && next_packet->timestamp == timestamp_) {
+      MaybeUpdateOutputFormat(*next_packet);
+      absl::optional<Packet> packet = packet_buffer_->GetNextPacket();
+      RTC_DCHECK(packet);
+      timestamp_ += static_cast<uint32_t>(DecodePacket(std::move(*packet)));
+      // If nothing was decoded, the next iteration conceals the gap.
+    } else {
+      size_t num_samples = output_size_samples_ - FutureDecodedSamples();
+      if (next_packet) {
+        num_samples = std::min<size_t>(num_samples,
+                                       next_packet->timestamp - timestamp_);
+      }
+      Conceal(num_samples);
+      timestamp_ += static_cast<uint32_t>(num_samples);
+      concealed = concealed || !in_cng_;
+    }
+  }
+
+  last_frame_concealed_ = concealed;
+  consecutive_concealed_frames_ =
+      concealed ? consecutive_concealed_frames_ + 1 : 0;
+  if (consecutive_concealed_frames_ >= kMaxConcealedFrames &&
+      packet_buffer_->Empty()) {
+    // The stream has stopped. Play out this frame, then wait for the buffer
+    // to refill before starting again.
+    playing_ = false;
+  }
+  return true;
+}
+
+size_t NetEqLite::DecodePacket(Packet&& packet) {
+  last_decoded_timestamps_.push_back(packet.timestamp);
+  if (!packet.frame) {
+    // An RFC 3389 SID frame. The comfort noise is played out as zeros.
+    in_cng_ = true;
+    return 0;
+  }
+  in_cng_ = false;
+  bool new_decoder = false;
+  if (decoder_database_->SetActiveDecoder(packet.payload_type, &new_decoder) !=
+      DecoderDatabase::kOK) {
+    return 0;
+  }
+
+  const size_t duration = packet.frame->Duration();
+  const size_t max_samples =
+      (duration > 0 ? duration : kMaxFrameSize) * channels_;
+  const size_t old_size = decoded_.size();
+  decoded_.SetSize(old_size + max_samples);
+  const absl::optional<AudioDecoder::EncodedAudioFrame::DecodeResult> result =
+      packet.frame->Decode(
+          rtc::ArrayView<int16_t>(decoded_.data() + old_size, max_samples));
+  if (!result) {
+    RTC_LOG(LS_WARNING) << "Decode error";
+    decoded_.SetSize(old_size);
+    return 0;
+  }
+  RTC_DCHECK_LE(result->num_decoded_samples, max_samples);
+  decoded_.SetSize(old_size + result->num_decoded_samples);
+  last_speech_type_ = result->speech_type;
+
+  const size_t decoded_samples_per_channel =
+      result->num_decoded_samples / channels_;
+  if (decoded_samples_per_channel > 0) {
+    decoder_frame_length_ = decoded_samples_per_channel;
+  }
+  if (packet.priority.codec_level > 0) {
+    stats_.SecondaryDecodedSamples(
+        rtc::dchecked_cast<int>(decoded_samples_per_channel));
+  }
+  const uint64_t waiting_time_ms = packet.waiting_time->ElapsedMs();
+  stats_.JitterBufferDelay(decoded_samples_per_channel, waiting_time_ms);
+  stats_.StoreWaitingTime(rtc::saturated_cast<int>(waiting_time_ms));
+  return decoded_samples_per_channel;
+}
+
+void NetEqLite::Conceal(size_t num_samples) {
+  const size_t old_size = decoded_.size();
+  AudioDecoder* decoder =
+      in_cng_ ? nullptr : decoder_database_->GetActiveDecoder();
+  if (decoder) {
+    decoder->GeneratePlc(num_samples, &decoded_);
+  }
+  const bool generated = decoded_.size() >= old_size + num_samples * channels_;
+  // Use at most |num_samples|, so that the concealment never overlaps the next
+  // packet, and fill with zeros if the decoder has no PLC.
+  decoded_.SetSize(old_size + num_samples * channels_);
+  if (!generated) {
+    std::fill(decoded_.data() + old_size, decoded_.end(), 0);
+  }
+  if (in_cng_) {
+    return;
+  }
+  const bool is_new_concealment_event = !last_frame_concealed_;
+  if (generated) {
+    stats_.ExpandedVoiceSamples(num_samples, is_new_concealment_event);
+  } else {
+    stats_.ExpandedNoiseSamples(num_samples, is_new_concealment_event);
+  }
+}
+
+void NetEqLite::LimitBufferLevel() {
+  const size_t max_samples =
+      static_cast<size_t>(TargetDelayMsInternal() + kMaxExcessDelayMs) *
+      fs_hz_ / 1000;
+  bool discarded = false;
+  while (!packet_buffer_->Empty() && BufferedSamples() > max_samples) {
+    packet_buffer_->DiscardNextPacket(&stats_);
+    discarded = true;
+  }
+  if (discarded && playing_ && !packet_buffer_->Empty()) {
+    // Skip ahead to the oldest remaining packet.
+    timestamp_ = packet_buffer_->PeekNextPacket()->timestamp;
+    decoded_.Clear();
+    decoded_read_index_ = 0;
+  }
+}
+
+void NetEqLite::MaybeUpdateOutputFormat(const Packet& packet) {
+  const DecoderDatabase::DecoderInfo* info =
+      decoder_database_->GetDecoderInfo(packet.payload_type);
+  if (!info || info->IsComfortNoise()) {
+    // Comfort noise is played out in the format of the preceding speech.
+    return;
+  }
+  AudioDecoder* decoder = info->GetDecoder();
+  const size_t channels = decoder ? decoder->Channels() : 1;
+  const int fs_hz = ValidSampleRate(info->SampleRateHz());
+  if (fs_hz == fs_hz_ && channels == channels_) {
+    return;
+  }
+  // The audio that is yet to be played out is in the old format; drop it.
+  decoded_.Clear();
+  decoded_read_index_ = 0;
+  fs_hz_ = fs_hz;
+  channels_ = channels;
+  output_size_samples_ = kOutputSizeMs * fs_hz_ / 1000;
+  decoder_frame_length_ = 3 * output_size_samples_;
+}
+
+size_t NetEqLite::BufferedSamples() const {
+  return packet_buffer_->NumSamplesInBuffer(decoder_frame_length_);
+}
+
+size_t NetEqLite::FutureDecodedSamples() const {
+  return (decoded_.size() - decoded_read_index_) / channels_;
+}
+
+int NetEqLite::TargetDelayMsInternal() const {
+  int target_delay_ms = std::max(minimum_delay_ms_, kDefaultTargetDelayMs);
+  if (maximum_delay_ms_ > 0) {
+    target_delay_ms = std::min(target_delay_ms, maximum_delay_ms_);
+  }
+  return target_delay_ms;
+}
+
+}  // namespace webrtc
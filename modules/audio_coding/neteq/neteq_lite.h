@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_CODING_NETEQ_NETEQ_LITE_H_
+#define MODULES_AUDIO_CODING_NETEQ_NETEQ_LITE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "modules/audio_coding/neteq/include/neteq.h"
+#include "modules/audio_coding/neteq/packet.h"
+#include "modules/audio_coding/neteq/rtcp.h"
+#include "modules/audio_coding/neteq/statistics_calculator.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+class DecoderDatabase;
+class PacketBuffer;
+class RedPayloadSplitter;
+class TickTimer;
+class TimestampScaler;
+
+// A reduced-footprint NetEq, created by NetEq::Create() when
+// NetEq::Config::enable_lite_mode is set. It is meant for receivers which
+// inspect many streams but play out only a few of them, such as a mixing
+// server. Compared with NetEqImpl, it
+//  - keeps a short packet buffer with a fixed target level instead of an
+//    adaptive delay manager, and discards the oldest packets when the buffer
+//    grows beyond the target instead of time-stretching;
+//  - has no sync buffer and no expand, merge, background noise or DTMF
+//    components; decoded audio is kept only until it has been played out;
+//  - decodes packets only from GetAudio(), so a stream that is never played
+//    out never runs its decoder;
+//  - conceals losses with the decoder's own PLC if it has one, and otherwise
+//    with zeros. RFC 3389 comfort noise is played out as zeros and DTMF events
+//    are dropped.
+class NetEqLite : public webrtc::NetEq {
+ public:
+  NetEqLite(const NetEq::Config& config,
+            const rtc::scoped_refptr<AudioDecoderFactory>& decoder_factory);
+  ~NetEqLite() override;
+
+  int InsertPacket(const RTPHeader& rtp_header,
+                   rtc::ArrayView<const uint8_t> payload,
+                   uint32_t receive_timestamp) override;
+  void InsertEmptyPacket(const RTPHeader& rtp_header) override;
+  int GetAudio(
+      AudioFrame* audio_frame,
+      bool* muted,
+      absl::optional<Operations> action_override = absl::nullopt) override;
+
+  void SkipAudio() override;
+  void SetCodecs(const std::map<int, SdpAudioFormat>& codecs) override;
+  int RegisterPayloadType(NetEqDecoder codec,
+                          const std::string& codec_name,
+                          uint8_t rtp_payload_type) override;
+  int RegisterExternalDecoder(AudioDecoder* decoder,
+                              NetEqDecoder codec,
+                              const std::string& codec_name,
+                              uint8_t rtp_payload_type) override;
+  bool RegisterPayloadType(int rtp_payload_type,
+                           const SdpAudioFormat& audio_format) override;
+  int RemovePayloadType(uint8_t rtp_payload_type) override;
+  void RemoveAllPayloadTypes() override;
+  bool SetMinimumDelay(int delay_ms) override;
+  bool SetMaximumDelay(int delay_ms) override;
+  int TargetDelayMs() const override;
+  int CurrentDelayMs() const override;
+  int FilteredCurrentDelayMs() const override;
+  int NetworkStatistics(NetEqNetworkStatistics* stats) override;
+  NetEqLifetimeStatistics GetLifetimeStatistics() const override;
+  NetEqOperationsAndState GetOperationsAndState() const override;
+  void GetRtcpStatistics(RtcpStatistics* stats) override;
+  void GetRtcpStatisticsNoReset(RtcpStatistics* stats) override;
+  // Post-decode VAD is not supported; these calls have no effect.
+  void EnableVad() override;
+  void DisableVad() override;
+  absl::optional<uint32_t> GetPlayoutTimestamp() const override;
+  int last_output_sample_rate_hz() const override;
+  absl::optional<CodecInst> GetDecoder(int payload_type) const override;
+  absl::optional<SdpAudioFormat> GetDecoderFormat(
+      int payload_type) const override;
+  void FlushBuffers() override;
+  void PacketBufferStatistics(int* current_num_packets,
+                              int* max_num_packets) const override;
+  // NACK is not supported; these calls have no effect and GetNackList()
+  // always returns an empty list.
+  void EnableNack(size_t max_nack_list_size) override;
+  void DisableNack() override;
+  std::vector<uint16_t> GetNackList(int64_t round_trip_time_ms) const override;
+  std::vector<uint32_t> LastDecodedTimestamps() const override;
+  // Returns the length of the decoded audio that is yet to be played out.
+  int SyncBufferSizeMs() const override;
+  size_t EstimatedMemoryUsageBytes() const override;
+
+ private:
+  // Produces |output_size_samples_| samples per channel into |decoded_| by
+  // decoding or concealing. Returns false if nothing is playing.
+  bool FillDecodedAudio() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
+  // Decodes |packet| and appends the audio to |decoded_|. Returns the number
+  // of samples per channel appended.
+  size_t DecodePacket(Packet&& packet) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
+  // Appends |num_samples| samples per channel of concealment audio to
+  // |decoded_|.
+  void Conceal(size_t num_samples) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
+  // Discards the oldest packets until the buffer holds no more than the target
+  // level plus kMaxExcessDelayMs worth of audio.
+  void LimitBufferLevel() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
+  // Updates the output format if the next packet to decode uses a decoder
+  // with a different sample rate or number of channels.
+  void MaybeUpdateOutputFormat(const Packet& packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
+  size_t BufferedSamples() const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+  size_t FutureDecodedSamples() const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+  int TargetDelayMsInternal() const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
+  rtc::CriticalSection crit_sect_;
+  const std::unique_ptr<TickTimer> tick_timer_ RTC_GUARDED_BY(crit_sect_);
+  const std::unique_ptr<DecoderDatabase> decoder_database_
+      RTC_GUARDED_BY(crit_sect_);
+  const std::unique_ptr<PacketBuffer> packet_buffer_ RTC_GUARDED_BY(crit_sect_);
+  const std::unique_ptr<RedPayloadSplitter> red_payload_splitter_
+      RTC_GUARDED_BY(crit_sect_);
+  const std::unique_ptr<TimestampScaler> timestamp_scaler_
+      RTC_GUARDED_BY(crit_sect_);
+  const bool enable_muted_state_;
+  Rtcp rtcp_ RTC_GUARDED_BY(crit_sect_);
+  StatisticsCalculator stats_ RTC_GUARDED_BY(crit_sect_);
+
+  int fs_hz_ RTC_GUARDED_BY(crit_sect_);
+  size_t channels_ RTC_GUARDED_BY(crit_sect_) = 1;
+  size_t output_size_samples_ RTC_GUARDED_BY(crit_sect_);
+  // The duration of the last decoded packet, in samples per channel.
+  size_t decoder_frame_length_ RTC_GUARDED_BY(crit_sect_);
+  int last_output_sample_rate_hz_ RTC_GUARDED_BY(crit_sect_);
+  int minimum_delay_ms_ RTC_GUARDED_BY(crit_sect_) = 0;
+  int maximum_delay_ms_ RTC_GUARDED_BY(crit_sect_);
+  absl::optional<uint8_t> current_rtp_payload_type_ RTC_GUARDED_BY(crit_sect_);
+  absl::optional<uint8_t> current_cng_rtp_payload_type_
+      RTC_GUARDED_BY(crit_sect_);
+  uint32_t ssrc_ RTC_GUARDED_BY(crit_sect_) = 0;
+  bool first_packet_ RTC_GUARDED_BY(crit_sect_) = true;
+  // True while audio is being played out from the packet buffer. Playout
+  // (re)starts when the buffer reaches the target level.
+  bool playing_ RTC_GUARDED_BY(crit_sect_) = false;
+  // The internal timestamp of the next sample to decode or conceal.
+  uint32_t timestamp_ RTC_GUARDED_BY(crit_sect_) = 0;
+  // The internal timestamp of the last sample played out, plus one.
+  uint32_t playout_timestamp_ RTC_GUARDED_BY(crit_sect_) = 0;
+  int consecutive_concealed_frames_ RTC_GUARDED_BY(crit_sect_) = 0;
+  // The number of SkipAudio() calls since the last GetAudio() call.
+  int skipped_frames_ RTC_GUARDED_BY(crit_sect_) = 0;
+  bool last_frame_concealed_ RTC_GUARDED_BY(crit_sect_) = false;
+  // True after an RFC 3389 SID frame, until the next speech frame.
+  bool in_cng_ RTC_GUARDED_BY(crit_sect_) = false;
+  AudioDecoder::SpeechType last_speech_type_ RTC_GUARDED_BY(crit_sect_) =
+      AudioDecoder::kSpeech;
+  // Interleaved decoded audio. The samples before |decoded_read_index_| have
+  // already been played out.
+  rtc::BufferT<int16_t> decoded_ RTC_GUARDED_BY(crit_sect_);
+  size_t decoded_read_index_ RTC_GUARDED_BY(crit_sect_) = 0;
+  std::vector<uint32_t> last_decoded_timestamps_ RTC_GUARDED_BY(crit_sect_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(NetEqLite);
+};
+
+}  // namespace webrtc
+#endif  // MODULES_AUDIO_CODING_NETEQ_NETEQ_LITE_H_
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "api/audio/audio_frame.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "common_types.h"  // NOLINT(build/include)
+#include "modules/audio_coding/neteq/include/neteq.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kPayloadType = 0;
+const int kSampleRateHz = 8000;
+const size_t kPacketSamples = 160;  // 20 ms @ 8 kHz.
+const size_t kOutputSamples = 80;   // 10 ms @ 8 kHz.
+
+class NetEqLiteTest : public ::testing::Test {
+ protected:
+  NetEqLiteTest() {
+    NetEq::Config config;
+    config.sample_rate_hz = kSampleRateHz;
+    config.enable_lite_mode = true;
+    neteq_.reset(NetEq::Create(config, CreateBuiltinAudioDecoderFactory()));
+    EXPECT_TRUE(neteq_->RegisterPayloadType(kPayloadType,
+                                            SdpAudioFormat("pcmu", 8000, 1)));
+    rtp_header_.payloadType = kPayloadType;
+    rtp_header_.sequenceNumber = 0x1234;
+    rtp_header_.timestamp = 0x12345678;
+    rtp_header_.ssrc = 0x87654321;
+  }
+
+  // Inserts a 20 ms packet and advances the RTP header to the next packet.
+  void InsertNextPacket() {
+    const std::vector<uint8_t> payload(kPacketSamples, 0x55);
+    EXPECT_EQ(NetEq::kOK, neteq_->InsertPacket(rtp_header_, payload, 0));
+    SkipPacket();
+  }
+
+  void SkipPacket() {
+    rtp_header_.sequenceNumber++;
+    rtp_header_.timestamp += kPacketSamples;
+  }
+
+  void GetAudio() {
+    bool muted;
+    ASSERT_EQ(NetEq::kOK, neteq_->GetAudio(&output_, &muted));
+    ASSERT_EQ(kOutputSamples, output_.samples_per_channel_);
+    ASSERT_EQ(kSampleRateHz, output_.sample_rate_hz_);
+    ASSERT_EQ(1u, output_.num_channels_);
+  }
+
+  std::unique_ptr<NetEq> neteq_;
+  RTPHeader rtp_header_;
+  AudioFrame output_;
+};
+
+}  // namespace
+
+TEST_F(NetEqLiteTest, WaitsForTargetLevelThenDecodesInOrder) {
+  const uint32_t first_timestamp = rtp_header_.timestamp;
+  InsertNextPacket();
+  // One packet is below the default target level; nothing is played out.
+  GetAudio();
+  EXPECT_TRUE(neteq_->LastDecodedTimestamps().empty());
+
+  InsertNextPacket();
+  for (uint32_t i = 0; i < 4; ++i) {
+    GetAudio();
+    EXPECT_EQ(AudioFrame::kNormalSpeech, output_.speech_type_);
+    if (i % 2 == 0) {
+      // A new 20 ms packet is decoded every other 10 ms frame.
+      const uint32_t expected_timestamp =
+          first_timestamp + static_cast<uint32_t>((i / 2) * kPacketSamples);
+      EXPECT_EQ(std::vector<uint32_t>({expected_timestamp}),
+                neteq_->LastDecodedTimestamps());
+    } else {
+      EXPECT_TRUE(neteq_->LastDecodedTimestamps().empty());
+    }
+    EXPECT_EQ(first_timestamp + static_cast<uint32_t>(i * kOutputSamples),
+              output_.timestamp_);
+  }
+}
+
+TEST_F(NetEqLiteTest, ConcealsMissingPacket) {
+  InsertNextPacket();
+  InsertNextPacket();
+  SkipPacket();
+  InsertNextPacket();
+
+  for (int i = 0; i < 4; ++i) {
+    GetAudio();
+    EXPECT_EQ(AudioFrame::kNormalSpeech, output_.speech_type_);
+  }
+  for (int i = 0; i < 2; ++i) {
+    GetAudio();
+    EXPECT_EQ(AudioFrame::kPLC, output_.speech_type_);
+  }
+  GetAudio();
+  EXPECT_EQ(AudioFrame::kNormalSpeech, output_.speech_type_);
+  EXPECT_GT(neteq_->GetLifetimeStatistics().concealed_samples, 0u);
+}
+
+TEST_F(NetEqLiteTest, KeepsBufferShortWhenNotPlayedOut) {
+  for (int i = 0; i < 100; ++i) {
+    InsertNextPacket();
+  }
+  // The buffer holds at most the 40 ms target plus 80 ms of excess audio.
+  EXPECT_LE(neteq_->CurrentDelayMs(), 120);
+  EXPECT_GE(neteq_->CurrentDelayMs(), 40);
+
+  // Playout starts from the most recent packets.
+  GetAudio();
+  ASSERT_EQ(1u, neteq_->LastDecodedTimestamps().size());
+  EXPECT_GE(neteq_->LastDecodedTimestamps()[0],
+            rtp_header_.timestamp - static_cast<uint32_t>(6 * kPacketSamples));
+}
+
+TEST_F(NetEqLiteTest, SkipAudioDoesNotDecode) {
+  for (int i = 0; i < 4; ++i) {
+    InsertNextPacket();
+  }
+  GetAudio();
+  EXPECT_EQ(1u, neteq_->LastDecodedTimestamps().size());
+
+  for (int i = 0; i < 4; ++i) {
+    InsertNextPacket();
+    neteq_->SkipAudio();
+    EXPECT_TRUE(neteq_->LastDecodedTimestamps().empty());
+  }
+  EXPECT_LE(neteq_->CurrentDelayMs(), 120);
+
+  // Playout resumes from the packet buffer.
+  GetAudio();
+  EXPECT_EQ(AudioFrame::kNormalSpeech, output_.speech_type_);
+  EXPECT_EQ(1u, neteq_->LastDecodedTimestamps().size());
+}
+
+TEST(NetEqLite, UsesLessMemoryThanFullNetEq) {
+  NetEq::Config config;
+  config.sample_rate_hz = 48000;
+  std::unique_ptr<NetEq> neteq(
+      NetEq::Create(config, CreateBuiltinAudioDecoderFactory()));
+  config.enable_lite_mode = true;
+  std::unique_ptr<NetEq> neteq_lite(
+      NetEq::Create(config, CreateBuiltinAudioDecoderFactory()));
+  EXPECT_LT(neteq_lite->EstimatedMemoryUsageBytes(),
+            neteq->EstimatedMemoryUsageBytes() / 2);
+}
+
+}  // namespace webrtc
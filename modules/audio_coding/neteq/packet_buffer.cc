@@ -8,13 +8,13 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-// This is the implementation of the PacketBuffer class. It is mostly based on
-// an STL list. The list is kept sorted at all times so that the next packet to
-// decode is at the beginning of the list.
+// This is the implementation of the PacketBuffer class. It is based on a ring
+// of preallocated Packet slots. The ring is kept sorted at all times so that
+// the next packet to decode is at the beginning of the ring.
 
 #include "modules/audio_coding/neteq/packet_buffer.h"
 
-#include <algorithm>  // find_if()
+#include <algorithm>  // max()
 
 #include "api/audio_codecs/audio_decoder.h"
 #include "modules/audio_coding/neteq/decoder_database.h"
@@ -24,18 +24,6 @@
 
 namespace webrtc {
 namespace {
-// Predicate used when inserting packets in the buffer list.
-// Operator() returns true when |packet| goes before |new_packet|.
-class NewTimestampIsLarger {
- public:
-  explicit NewTimestampIsLarger(const Packet& new_packet)
-      : new_packet_(new_packet) {}
-  bool operator()(const Packet& packet) { return (new_packet_ >= packet); }
-
- private:
-  const Packet& new_packet_;
-};
-
 // Returns true if both payload types are known to the decoder database, and
 // have the same sample rate.
 bool EqualSampleRates(uint8_t pt1,
@@ -59,7 +47,11 @@ void LogPacketDiscarded(int codec_level, StatisticsCalculator* stats) {
 
 PacketBuffer::PacketBuffer(size_t max_number_of_packets,
                            const TickTimer* tick_timer)
-    : max_number_of_packets_(max_number_of_packets), tick_timer_(tick_timer) {}
+    : max_number_of_packets_(max_number_of_packets),
+      // Flushing on overfill makes room for one packet even if
+      // |max_number_of_packets| is zero.
+      buffer_(std::max<size_t>(max_number_of_packets, 1)),
+      tick_timer_(tick_timer) {}
 
 // Destructor. All packets in the buffer will be destroyed.
 PacketBuffer::~PacketBuffer() {
@@ -68,11 +60,14 @@ PacketBuffer::~PacketBuffer() {
 
 // Flush the buffer. All packets in the buffer will be destroyed.
 void PacketBuffer::Flush() {
-  buffer_.clear();
+  while (size_ > 0) {
+    PopFront();
+  }
+  first_ = 0;
 }
 
 bool PacketBuffer::Empty() const {
-  return buffer_.empty();
+  return size_ == 0;
 }
 
 int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
@@ -88,36 +83,38 @@ int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
 
   packet.waiting_time = tick_timer_->GetNewStopwatch();
 
-  if (buffer_.size() >= max_number_of_packets_) {
+  if (size_ >= max_number_of_packets_) {
     // Buffer is full. Flush it.
     Flush();
     RTC_LOG(LS_WARNING) << "Packet buffer flushed";
     return_val = kFlushed;
   }
 
-  // Get an iterator pointing to the place in the buffer where the new packet
-  // should be inserted. The list is searched from the back, since the most
-  // likely case is that the new packet should be near the end of the list.
-  PacketList::reverse_iterator rit = std::find_if(
-      buffer_.rbegin(), buffer_.rend(), NewTimestampIsLarger(packet));
+  // Find the position in the buffer where the new packet should be inserted.
+  // The buffer is searched from the back, since the most likely case is that
+  // the new packet should be appended at the end.
+  size_t index = size_;
+  while (index > 0 && !(packet >= PacketAt(index - 1))) {
+    --index;
+  }
 
-  // The new packet is to be inserted to the right of |rit|. If it has the same
-  // timestamp as |rit|, which has a higher priority, do not insert the new
-  // packet to list.
-  if (rit != buffer_.rend() && packet.timestamp == rit->timestamp) {
+  // The new packet is to be inserted after |index - 1|. If it has the same
+  // timestamp as that packet, which has a higher priority, do not insert the
+  // new packet.
+  if (index > 0 && packet.timestamp == PacketAt(index - 1).timestamp) {
     LogPacketDiscarded(packet.priority.codec_level, stats);
     return return_val;
   }
 
-  // The new packet is to be inserted to the left of |it|. If it has the same
-  // timestamp as |it|, which has a lower priority, replace |it| with the new
-  // packet.
-  PacketList::iterator it = rit.base();
-  if (it != buffer_.end() && packet.timestamp == it->timestamp) {
-    LogPacketDiscarded(it->priority.codec_level, stats);
-    it = buffer_.erase(it);
+  // The new packet is to be inserted before |index|. If it has the same
+  // timestamp as that packet, which has a lower priority, replace it with the
+  // new packet.
+  if (index < size_ && packet.timestamp == PacketAt(index).timestamp) {
+    LogPacketDiscarded(PacketAt(index).priority.codec_level, stats);
+    PacketAt(index) = std::move(packet);
+    return return_val;
   }
-  buffer_.insert(it, std::move(packet));  // Insert the packet at that position.
+  InsertAt(index, std::move(packet));
 
   return return_val;
 }
@@ -175,7 +172,7 @@ int PacketBuffer::NextTimestamp(uint32_t* next_timestamp) const {
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  *next_timestamp = buffer_.front().timestamp;
+  *next_timestamp = PacketAt(0).timestamp;
   return kOK;
 }
 
@@ -187,11 +184,11 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  PacketList::const_iterator it;
-  for (it = buffer_.begin(); it != buffer_.end(); ++it) {
-    if (it->timestamp >= timestamp) {
+  for (size_t i = 0; i < size_; ++i) {
+    const Packet& packet = PacketAt(i);
+    if (packet.timestamp >= timestamp) {
       // Found a packet matching the search.
-      *next_timestamp = it->timestamp;
+      *next_timestamp = packet.timestamp;
       return kOK;
     }
   }
@@ -199,7 +196,7 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
 }
 
 const Packet* PacketBuffer::PeekNextPacket() const {
-  return buffer_.empty() ? nullptr : &buffer_.front();
+  return Empty() ? nullptr : &PacketAt(0);
 }
 
 absl::optional<Packet> PacketBuffer::GetNextPacket() {
@@ -208,10 +205,10 @@ absl::optional<Packet> PacketBuffer::GetNextPacket() {
     return absl::nullopt;
   }
 
-  absl::optional<Packet> packet(std::move(buffer_.front()));
+  absl::optional<Packet> packet(std::move(PacketAt(0)));
   // Assert that the packet sanity checks in InsertPacket method works.
   RTC_DCHECK(!packet->empty());
-  buffer_.pop_front();
+  PopFront();
 
   return packet;
 }
@@ -221,17 +218,17 @@ int PacketBuffer::DiscardNextPacket(StatisticsCalculator* stats) {
     return kBufferEmpty;
   }
   // Assert that the packet sanity checks in InsertPacket method works.
-  const Packet& packet = buffer_.front();
+  const Packet& packet = PacketAt(0);
   RTC_DCHECK(!packet.empty());
   LogPacketDiscarded(packet.priority.codec_level, stats);
-  buffer_.pop_front();
+  PopFront();
   return kOK;
 }
 
 void PacketBuffer::DiscardOldPackets(uint32_t timestamp_limit,
                                      uint32_t horizon_samples,
                                      StatisticsCalculator* stats) {
-  buffer_.remove_if([timestamp_limit, horizon_samples, stats](const Packet& p) {
+  RemoveIf([timestamp_limit, horizon_samples, stats](const Packet& p) {
     if (timestamp_limit == p.timestamp ||
         !IsObsoleteTimestamp(p.timestamp, timestamp_limit, horizon_samples)) {
       return false;
@@ -248,7 +245,7 @@ void PacketBuffer::DiscardAllOldPackets(uint32_t timestamp_limit,
 
 void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
                                                  StatisticsCalculator* stats) {
-  buffer_.remove_if([payload_type, stats](const Packet& p) {
+  RemoveIf([payload_type, stats](const Packet& p) {
     if (p.payload_type != payload_type) {
       return false;
     }
@@ -258,13 +255,14 @@ void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
 }
 
 size_t PacketBuffer::NumPacketsInBuffer() const {
-  return buffer_.size();
+  return size_;
 }
 
 size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
   size_t num_samples = 0;
   size_t last_duration = last_decoded_length;
-  for (const Packet& packet : buffer_) {
+  for (size_t i = 0; i < size_; ++i) {
+    const Packet& packet = PacketAt(i);
     if (packet.frame) {
       // TODO(hlundin): Verify that it's fine to count all packets and remove
       // this check.
@@ -284,7 +282,8 @@ size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
 bool PacketBuffer::ContainsDtxOrCngPacket(
     const DecoderDatabase* decoder_database) const {
   RTC_DCHECK(decoder_database);
-  for (const Packet& packet : buffer_) {
+  for (size_t i = 0; i < size_; ++i) {
+    const Packet& packet = PacketAt(i);
     if ((packet.frame && packet.frame->IsDtxPacket()) ||
         decoder_database->IsComfortNoise(packet.payload_type)) {
       return true;
@@ -294,8 +293,66 @@ bool PacketBuffer::ContainsDtxOrCngPacket(
 }
 
 void PacketBuffer::BufferStat(int* num_packets, int* max_num_packets) const {
-  *num_packets = static_cast<int>(buffer_.size());
+  *num_packets = static_cast<int>(size_);
   *max_num_packets = static_cast<int>(max_number_of_packets_);
 }
 
+Packet& PacketBuffer::PacketAt(size_t index) {
+  RTC_DCHECK_LT(index, size_);
+  const size_t slot = first_ + index;
+  return buffer_[slot < buffer_.size() ? slot : slot - buffer_.size()];
+}
+
+const Packet& PacketBuffer::PacketAt(size_t index) const {
+  RTC_DCHECK_LT(index, size_);
+  const size_t slot = first_ + index;
+  return buffer_[slot < buffer_.size() ? slot : slot - buffer_.size()];
+}
+
+void PacketBuffer::InsertAt(size_t index, Packet&& packet) {
+  RTC_DCHECK_LE(index, size_);
+  RTC_DCHECK_LT(size_, buffer_.size());
+  if (index < size_ / 2) {
+    // Closer to the front; move the first |index| packets one step back.
+    first_ = first_ == 0 ? buffer_.size() - 1 : first_ - 1;
+    ++size_;
+    for (size_t i = 0; i < index; ++i) {
+      PacketAt(i) = std::move(PacketAt(i + 1));
+    }
+  } else {
+    // Closer to the back; move the last |size_ - index| packets one step
+    // forward. This loop does nothing in the common case of appending.
+    ++size_;
+    for (size_t i = size_ - 1; i > index; --i) {
+      PacketAt(i) = std::move(PacketAt(i - 1));
+    }
+  }
+  PacketAt(index) = std::move(packet);
+}
+
+void PacketBuffer::PopFront() {
+  RTC_DCHECK_GT(size_, 0);
+  // Assign an empty packet to release the payload and frame right away.
+  PacketAt(0) = Packet();
+  first_ = first_ + 1 == buffer_.size() ? 0 : first_ + 1;
+  --size_;
+}
+
+template <typename Predicate>
+void PacketBuffer::RemoveIf(Predicate predicate) {
+  size_t kept = 0;
+  for (size_t i = 0; i < size_; ++i) {
+    if (predicate(PacketAt(i))) {
+      PacketAt(i) = Packet();
+    } else {
+      if (kept != i) {
+        PacketAt(kept) = std::move(PacketAt(i));
+      }
+      ++kept;
+    }
+  }
+  // The slots after the kept packets are now all empty.
+  size_ = kept;
+}
+
 }  // namespace webrtc
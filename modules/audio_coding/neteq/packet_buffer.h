@@ -11,6 +11,8 @@
 #ifndef MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 #define MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "modules/audio_coding/neteq/decoder_database.h"
 #include "modules/audio_coding/neteq/packet.h"
@@ -23,7 +25,9 @@ class DecoderDatabase;
 class StatisticsCalculator;
 class TickTimer;
 
-// This is the actual buffer holding the packets before decoding.
+// This is the actual buffer holding the packets before decoding. The packets
+// are stored in a fixed-capacity ring, sorted on timestamp, so that the common
+// case of in-order arrival is a constant-time append without any allocation.
 class PacketBuffer {
  public:
   enum BufferReturnCodes {
@@ -142,8 +146,30 @@ class PacketBuffer {
   }
 
  private:
+  // Returns the packet at position |index|, counted from the first (oldest)
+  // packet in the buffer. |index| must be less than |size_|.
+  Packet& PacketAt(size_t index);
+  const Packet& PacketAt(size_t index) const;
+
+  // Inserts |packet| at position |index|, moving either the packets before or
+  // the packets after it, whichever is fewer. The buffer must not be full.
+  void InsertAt(size_t index, Packet&& packet);
+
+  // Removes the first packet and releases its resources.
+  void PopFront();
+
+  // Removes all packets for which |predicate| returns true. The relative order
+  // of the remaining packets is preserved.
+  template <typename Predicate>
+  void RemoveIf(Predicate predicate);
+
   size_t max_number_of_packets_;
-  PacketList buffer_;
+  // Ring storage with room for |max_number_of_packets_| packets. The packet
+  // to decode next is at |buffer_[first_]|, and the |size_| packets following
+  // it (with wrap-around) are in increasing timestamp order.
+  std::vector<Packet> buffer_;
+  size_t first_ = 0;
+  size_t size_ = 0;
   const TickTimer* tick_timer_;
   RTC_DISALLOW_COPY_AND_ASSIGN(PacketBuffer);
 };
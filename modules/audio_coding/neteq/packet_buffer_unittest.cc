@@ -11,6 +11,9 @@
 // Unit tests for PacketBuffer class.
 
 #include "modules/audio_coding/neteq/packet_buffer.h"
+
+#include <vector>
+
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "modules/audio_coding/neteq/mock/mock_decoder_database.h"
 #include "modules/audio_coding/neteq/mock/mock_statistics_calculator.h"
@@ -434,6 +437,52 @@ TEST(PacketBuffer, Reordering) {
   EXPECT_CALL(decoder_database, Die());  // Called when object is deleted.
 }
 
+// Test that the buffer stays sorted when the packets wrap around the end of the
+// internal ring storage, with late packets arriving both near the front and
+// near the back of the buffer.
+TEST(PacketBuffer, ReorderingAcrossRingWrap) {
+  TickTimer tick_timer;
+  PacketBuffer buffer(8, &tick_timer);  // 8 packets.
+  const uint32_t ts_increment = 10;
+  PacketGenerator gen(0, 0, 0, ts_increment);
+  const int payload_len = 10;
+  StrictMock<MockStatisticsCalculator> mock_stats;
+
+  // Advance the start of the ring by inserting and extracting a few packets.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(gen.NextPacket(payload_len), &mock_stats));
+    EXPECT_TRUE(buffer.GetNextPacket());
+  }
+
+  // Generate 7 packets and insert them in the order 1, 2, 4, 5, 0, 6, 3.
+  std::vector<Packet> packets;
+  for (int i = 0; i < 7; ++i) {
+    packets.push_back(gen.NextPacket(payload_len));
+  }
+  const uint32_t start_ts = packets[0].timestamp;
+  for (int i : {1, 2, 4, 5, 0, 6, 3}) {
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(packets[i]), &mock_stats));
+  }
+  EXPECT_EQ(7u, buffer.NumPacketsInBuffer());
+
+  uint32_t next_ts;
+  EXPECT_EQ(PacketBuffer::kOK,
+            buffer.NextHigherTimestamp(start_ts + 25, &next_ts));
+  EXPECT_EQ(start_ts + 30, next_ts);
+
+  // Extract them and make sure that they come out in the right order.
+  uint32_t current_ts = start_ts;
+  for (int i = 0; i < 7; ++i) {
+    const absl::optional<Packet> packet = buffer.GetNextPacket();
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(current_ts, packet->timestamp);
+    current_ts += ts_increment;
+  }
+  EXPECT_TRUE(buffer.Empty());
+}
+
 // The test first inserts a packet with narrow-band CNG, then a packet with
 // wide-band speech. The expected behavior of the packet buffer is to detect a
 // change in sample rate, even though no speech packet has been inserted before,
@@ -8,9 +8,18 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <memory>
+#include <utility>
+
+#include "modules/audio_coding/neteq/tools/audio_sink.h"
+#include "modules/audio_coding/neteq/tools/neteq_input.h"
+#include "modules/audio_coding/neteq/tools/neteq_packet_source_input.h"
 #include "modules/audio_coding/neteq/tools/neteq_performance_test.h"
+#include "modules/audio_coding/neteq/tools/neteq_test.h"
+#include "rtc_base/timeutils.h"
 #include "system_wrappers/include/field_trial.h"
 #include "test/gtest.h"
+#include "test/testsupport/fileutils.h"
 #include "test/testsupport/perf_test.h"
 
 // Runs a test with 10% packet losses and 10% clock drift, to exercise
@@ -47,3 +56,66 @@ TEST(NetEqPerformanceTest, RunClean) {
   webrtc::test::PrintResult("neteq_performance", "", "0_pl_0_drift", runtime,
                             "ms", true);
 }
+
+namespace webrtc {
+namespace test {
+namespace {
+
+// Keeps the jitter buffer at a large target delay, as used for streaming
+// receivers, so that the packet buffer holds many packets at all times.
+class MinimumDelaySetter : public NetEqPostInsertPacket {
+ public:
+  explicit MinimumDelaySetter(int delay_ms) : delay_ms_(delay_ms) {}
+  void AfterInsertPacket(const NetEqInput::PacketData& packet,
+                         NetEq* neteq) override {
+    if (!delay_set_) {
+      delay_set_ = neteq->SetMinimumDelay(delay_ms_);
+    }
+  }
+
+ private:
+  const int delay_ms_;
+  bool delay_set_ = false;
+};
+
+}  // namespace
+
+// Replays a real RTP dump through NetEq with a 1.5 second target delay. This
+// exercises the packet buffer with a deep queue of packets on every insert and
+// extract, which is where its data layout matters the most.
+TEST(NetEqPerformanceTest, RunRtpDumpLargeJitterBuffer) {
+  const int kSimulationTimeMs = 600000;
+  const int kQuickSimulationTimeMs = 20000;
+  const int kTargetDelayMs = 1500;
+  NetEq::Config config;
+  config.max_packets_in_buffer = 200;
+  config.max_delay_ms = 2 * kTargetDelayMs;
+  NetEqPacketSourceInput::RtpHeaderExtensionMap rtp_ext_map = {
+      {1, kRtpExtensionAudioLevel},
+      {3, kRtpExtensionAbsoluteSendTime},
+      {5, kRtpExtensionTransportSequenceNumber},
+      {7, kRtpExtensionVideoContentType},
+      {8, kRtpExtensionVideoTiming}};
+  std::unique_ptr<NetEqInput> input(new NetEqRtpDumpInput(
+      ResourcePath("audio_coding/neteq_universal_new", "rtp"), rtp_ext_map));
+  std::unique_ptr<TimeLimitedNetEqInput> input_time_limit(
+      new TimeLimitedNetEqInput(std::move(input),
+                                field_trial::IsEnabled("WebRTC-QuickPerfTest")
+                                    ? kQuickSimulationTimeMs
+                                    : kSimulationTimeMs));
+  std::unique_ptr<AudioSink> output(new VoidAudioSink);
+  MinimumDelaySetter delay_setter(kTargetDelayMs);
+  NetEqTest::Callbacks callbacks;
+  callbacks.post_insert_packet = &delay_setter;
+  NetEqTest test(config, NetEqTest::StandardDecoderMap(),
+                 NetEqTest::ExtDecoderMap(), std::move(input_time_limit),
+                 std::move(output), callbacks);
+  const int64_t start_time_ms = rtc::TimeMillis();
+  ASSERT_GT(test.Run(), 0);
+  const int64_t runtime = rtc::TimeMillis() - start_time_ms;
+  PrintResult("neteq_performance", "", "rtp_dump_1500ms_target", runtime, "ms",
+              true);
+}
+
+}  // namespace test
+}  // namespace webrtc
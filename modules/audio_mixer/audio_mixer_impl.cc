@@ -69,6 +69,18 @@ bool ShouldMixBefore(const SourceFrame& a, const SourceFrame& b) {
   return a.energy > b.energy;
 }
 
+// Ranks sources on what they know about their next frame before decoding it.
+bool ShouldDecodeBefore(
+    const std::pair<AudioMixerImpl::SourceStatus*,
+                    AudioMixer::Source::PreDecodeInfo>& a,
+    const std::pair<AudioMixerImpl::SourceStatus*,
+                    AudioMixer::Source::PreDecodeInfo>& b) {
+  if (a.second.voice_activity != b.second.voice_activity) {
+    return a.second.voice_activity;
+  }
+  return a.second.audio_level_dbov < b.second.audio_level_dbov;
+}
+
 void RampAndUpdateGain(
     const std::vector<SourceFrame>& mixed_sources_and_frames) {
   for (const auto& source_frame : mixed_sources_and_frames) {
@@ -93,7 +105,14 @@ AudioMixerImpl::SourceStatusList::const_iterator FindSourceInList(
 AudioMixerImpl::AudioMixerImpl(
     std::unique_ptr<OutputRateCalculator> output_rate_calculator,
     bool use_limiter)
+    : AudioMixerImpl(std::move(output_rate_calculator), use_limiter, false) {}
+
+AudioMixerImpl::AudioMixerImpl(
+    std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+    bool use_limiter,
+    bool skip_unselected_sources)
     : output_rate_calculator_(std::move(output_rate_calculator)),
+      skip_unselected_sources_(skip_unselected_sources),
       output_frequency_(0),
       sample_size_(0),
       audio_source_list_(),
@@ -110,9 +129,17 @@ rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create() {
 rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
     std::unique_ptr<OutputRateCalculator> output_rate_calculator,
     bool use_limiter) {
+  return Create(std::move(output_rate_calculator), use_limiter, false);
+}
+
+rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
+    std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+    bool use_limiter,
+    bool skip_unselected_sources) {
   return rtc::scoped_refptr<AudioMixerImpl>(
       new rtc::RefCountedObject<AudioMixerImpl>(
-          std::move(output_rate_calculator), use_limiter));
+          std::move(output_rate_calculator), use_limiter,
+          skip_unselected_sources));
 }
 
 void AudioMixerImpl::Mix(size_t number_of_channels,
@@ -178,8 +205,41 @@ AudioFrameList AudioMixerImpl::GetAudioFromSources() {
   std::vector<SourceFrame> audio_source_mixing_data_list;
   std::vector<SourceFrame> ramp_list;
 
-  // Get audio from the audio sources and put it in the SourceFrame vector.
+  // When skipping is enabled, sources that can tell how loud their next
+  // frame is are ranked on that before decoding. Only the loudest of them, and
+  // the ones mixed in the last round, are asked for audio. The rest are
+  // skipped and do not decode.
+  std::vector<SourceStatus*> sources_to_decode;
+  std::vector<std::pair<SourceStatus*, Source::PreDecodeInfo>>
+      pre_decode_candidates;
   for (auto& source_and_status : audio_source_list_) {
+    absl::optional<Source::PreDecodeInfo> pre_decode_info;
+    if (skip_unselected_sources_ && !source_and_status->is_mixed)
+      pre_decode_info = source_and_status->audio_source->GetPreDecodeInfo();
+    if (pre_decode_info) {
+      pre_decode_candidates.emplace_back(source_and_status.get(),
+                                         *pre_decode_info);
+    } else {
+      sources_to_decode.push_back(source_and_status.get());
+    }
+  }
+  const size_t num_candidates_to_decode =
+      std::min(pre_decode_candidates.size(),
+               static_cast<size_t>(kMaximumAmountOfMixedAudioSources));
+  std::partial_sort(
+      pre_decode_candidates.begin(),
+      pre_decode_candidates.begin() + num_candidates_to_decode,
+      pre_decode_candidates.end(), ShouldDecodeBefore);
+  for (size_t i = 0; i < pre_decode_candidates.size(); ++i) {
+    if (i < num_candidates_to_decode) {
+      sources_to_decode.push_back(pre_decode_candidates[i].first);
+    } else {
+      pre_decode_candidates[i].first->audio_source->SkipAudioFrame();
+    }
+  }
+
+  // Get audio from the audio sources and put it in the SourceFrame vector.
+  for (SourceStatus* source_and_status : sources_to_decode) {
     const auto audio_frame_info =
         source_and_status->audio_source->GetAudioFrameWithInfo(
             OutputFrequency(), &source_and_status->audio_frame);
@@ -189,7 +249,7 @@ AudioFrameList AudioMixerImpl::GetAudioFromSources() {
       continue;
     }
     audio_source_mixing_data_list.emplace_back(
-        source_and_status.get(), &source_and_status->audio_frame,
+        source_and_status, &source_and_status->audio_frame,
         audio_frame_info == Source::AudioFrameInfo::kMuted);
   }
 
@@ -50,6 +50,17 @@ class AudioMixerImpl : public AudioMixer {
       std::unique_ptr<OutputRateCalculator> output_rate_calculator,
       bool use_limiter);
 
+  // If |skip_unselected_sources| is true, sources that report
+  // Source::PreDecodeInfo and are not among the most active ones are not asked
+  // for audio, but skipped with Source::SkipAudioFrame(). This saves decoding
+  // them when there are many sources, e.g. on a conference server, but
+  // anything that runs on decoded audio, e.g. level statistics, then only
+  // sees the mixed sources.
+  static rtc::scoped_refptr<AudioMixerImpl> Create(
+      std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+      bool use_limiter,
+      bool skip_unselected_sources);
+
   ~AudioMixerImpl() override;
 
   // AudioMixer functions
@@ -68,6 +79,9 @@ class AudioMixerImpl : public AudioMixer {
  protected:
   AudioMixerImpl(std::unique_ptr<OutputRateCalculator> output_rate_calculator,
                  bool use_limiter);
+  AudioMixerImpl(std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+                 bool use_limiter,
+                 bool skip_unselected_sources);
 
  private:
   // Set mixing frequency through OutputFrequencyCalculator.
@@ -77,7 +91,10 @@ class AudioMixerImpl : public AudioMixer {
 
   // Compute what audio sources to mix from audio_source_list_. Ramp
   // in and out. Update mixed status. Mixes up to
-  // kMaximumAmountOfMixedAudioSources audio sources.
+  // kMaximumAmountOfMixedAudioSources audio sources. If
+  // |skip_unselected_sources_|, sources that provide Source::PreDecodeInfo and
+  // are not among the most active ones are skipped without being asked for
+  // audio.
   AudioFrameList GetAudioFromSources() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // Add/remove the MixerAudioSource to the specified
@@ -94,6 +111,7 @@ class AudioMixerImpl : public AudioMixer {
   rtc::RaceChecker race_checker_;
 
   std::unique_ptr<OutputRateCalculator> output_rate_calculator_;
+  const bool skip_unselected_sources_;
   // The current sample frequency and sample size when mixing.
   int output_frequency_ RTC_GUARDED_BY(race_checker_);
   size_t sample_size_ RTC_GUARDED_BY(race_checker_);
@@ -77,6 +77,8 @@ class MockMixerAudioSource : public testing::NiceMock<AudioMixer::Source> {
 
   MOCK_CONST_METHOD0(PreferredSampleRate, int());
   MOCK_CONST_METHOD0(Ssrc, int());
+  MOCK_CONST_METHOD0(GetPreDecodeInfo, absl::optional<PreDecodeInfo>());
+  MOCK_METHOD0(SkipAudioFrame, void());
 
   AudioFrame* fake_frame() { return &fake_frame_; }
   AudioFrameInfo fake_info() { return fake_audio_frame_info_; }
@@ -367,6 +369,72 @@ TEST(AudioMixer, RampedOutSourcesShouldNotBeMarkedMixed) {
   }
 }
 
+TEST(AudioMixer, QuietSourcesWithPreDecodeInfoAreSkipped) {
+  constexpr int kAudioSources =
+      AudioMixerImpl::kMaximumAmountOfMixedAudioSources + 2;
+
+  const auto mixer = AudioMixerImpl::Create(
+      std::unique_ptr<OutputRateCalculator>(new DefaultOutputRateCalculator()),
+      true, true);
+  MockMixerAudioSource participants[kAudioSources];
+  // A source which can't tell its level before decoding is always decoded.
+  MockMixerAudioSource source_without_info;
+  ResetFrame(source_without_info.fake_frame());
+  EXPECT_TRUE(mixer->AddSource(&source_without_info));
+
+  for (int i = 0; i < kAudioSources; ++i) {
+    ResetFrame(participants[i].fake_frame());
+    participants[i].fake_frame()->mutable_data()[0] = 1000;
+    // The audio level decreases (-dBov increases) with the index |i|.
+    AudioMixer::Source::PreDecodeInfo info;
+    info.audio_level_dbov = 10 + i;
+    info.voice_activity = true;
+    ON_CALL(participants[i], GetPreDecodeInfo()).WillByDefault(Return(info));
+    EXPECT_TRUE(mixer->AddSource(&participants[i]));
+  }
+
+  EXPECT_CALL(source_without_info, GetAudioFrameWithInfo(_, _))
+      .Times(Exactly(1));
+  EXPECT_CALL(source_without_info, SkipAudioFrame()).Times(0);
+  for (int i = 0; i < kAudioSources; ++i) {
+    const bool loud = i < AudioMixerImpl::kMaximumAmountOfMixedAudioSources;
+    EXPECT_CALL(participants[i], GetAudioFrameWithInfo(_, _))
+        .Times(Exactly(loud ? 1 : 0));
+    EXPECT_CALL(participants[i], SkipAudioFrame()).Times(Exactly(loud ? 0 : 1));
+  }
+
+  mixer->Mix(1, &frame_for_mixing);
+
+  for (int i = AudioMixerImpl::kMaximumAmountOfMixedAudioSources;
+       i < kAudioSources; ++i) {
+    EXPECT_FALSE(mixer->GetAudioSourceMixabilityStatusForTest(&participants[i]))
+        << "Mixed status of AudioSource #" << i << " wrong.";
+  }
+}
+
+// Unless the mixer is created to skip sources, every source is decoded, also
+// the ones that report pre-decode info.
+TEST(AudioMixer, SourcesAreNotSkippedByDefault) {
+  constexpr int kAudioSources =
+      AudioMixerImpl::kMaximumAmountOfMixedAudioSources + 2;
+
+  const auto mixer = AudioMixerImpl::Create();
+  MockMixerAudioSource participants[kAudioSources];
+  for (int i = 0; i < kAudioSources; ++i) {
+    ResetFrame(participants[i].fake_frame());
+    AudioMixer::Source::PreDecodeInfo info;
+    info.audio_level_dbov = 10 + i;
+    info.voice_activity = true;
+    ON_CALL(participants[i], GetPreDecodeInfo()).WillByDefault(Return(info));
+    EXPECT_TRUE(mixer->AddSource(&participants[i]));
+    EXPECT_CALL(participants[i], GetAudioFrameWithInfo(_, _))
+        .Times(Exactly(1));
+    EXPECT_CALL(participants[i], SkipAudioFrame()).Times(0);
+  }
+
+  mixer->Mix(1, &frame_for_mixing);
+}
+
 // This test checks that the initialization and participant addition
 // can be done on a different thread.
 TEST(AudioMixer, ConstructFromOtherThread) {
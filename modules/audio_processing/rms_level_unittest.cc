@@ -134,6 +134,22 @@ TEST(RmsLevelTest, RunHalfScaleAndInsertFullScale) {
   EXPECT_EQ(3, stats.peak);
 }
 
+TEST(RmsLevelTest, FloatInputMatchesInt16Input) {
+  auto x = CreateSinusoid(1000, INT16_MAX / 2, kSampleRateHz);
+  const std::vector<float> x_float(x.begin(), x.end());
+  auto level = RunTest(x);
+  RmsLevel level_float;
+  for (size_t n = 0; n + kBlockSizeSamples <= x_float.size();
+       n += kBlockSizeSamples) {
+    level_float.Analyze(rtc::ArrayView<const float>(&x_float[n],
+                                                    kBlockSizeSamples));
+  }
+  auto stats = level->AverageAndPeak();
+  auto stats_float = level_float.AverageAndPeak();
+  EXPECT_EQ(stats.average, stats_float.average);
+  EXPECT_EQ(stats.peak, stats_float.peak);
+}
+
 TEST(RmsLevelTest, ResetOnBlockSizeChange) {
   auto x = CreateSinusoid(1000, INT16_MAX, kSampleRateHz);
   auto level = RunTest(x);
@@ -40,6 +40,13 @@ class ProcessThread {
 
   static std::unique_ptr<ProcessThread> Create(const char* thread_name);
 
+  // Creates a ProcessThread that spreads its modules over |num_threads|
+  // worker threads and only looks at the modules that are due when it wakes
+  // up, for processes with thousands of modules. Posted tasks run on the first
+  // worker thread.
+  static std::unique_ptr<ProcessThread> CreateSharded(const char* thread_name,
+                                                      int num_threads);
+
   // Starts the worker thread.  Must be called from the construction thread.
   virtual void Start() = 0;
 
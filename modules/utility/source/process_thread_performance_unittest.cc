@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "modules/include/module.h"
+#include "modules/utility/include/process_thread.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/location.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumModules = 5000;
+// As often as an RtpRtcp module wants to be processed.
+constexpr int64_t kRtpRtcpIntervalMs = 5;
+// As often as a module that is mostly idle wants to be processed.
+constexpr int64_t kIdleIntervalMs = 1000;
+constexpr int kRunTimeMs = 2000;
+
+// A module that wants to be processed every |interval_ms|, and keeps track of
+// how late it was processed.
+class PeriodicModule : public Module {
+ public:
+  PeriodicModule(int64_t interval_ms, int64_t first_process_ms)
+      : interval_ms_(interval_ms), next_process_ms_(first_process_ms) {}
+
+  int64_t TimeUntilNextProcess() override {
+    return next_process_ms_ - rtc::TimeMillis();
+  }
+
+  void Process() override {
+    const int64_t now_ms = rtc::TimeMillis();
+    if (now_ms > next_process_ms_)
+      total_delay_ms_ += now_ms - next_process_ms_;
+    ++num_processed_;
+    next_process_ms_ = now_ms + interval_ms_;
+  }
+
+  int num_processed() const { return num_processed_; }
+  int64_t total_delay_ms() const { return total_delay_ms_; }
+
+ private:
+  const int64_t interval_ms_;
+  int64_t next_process_ms_;
+  int num_processed_ = 0;
+  int64_t total_delay_ms_ = 0;
+};
+
+// Runs |kNumModules| modules that want to be processed every |interval_ms|,
+// due at evenly spread times, on |process_thread| for |kRunTimeMs| and prints
+// the CPU time it took and how late the modules were processed.
+void MeasureProcessThread(const std::string& trace,
+                          std::unique_ptr<ProcessThread> process_thread,
+                          int64_t interval_ms) {
+  const int64_t start_ms = rtc::TimeMillis();
+  std::vector<std::unique_ptr<PeriodicModule>> modules;
+  for (int i = 0; i < kNumModules; ++i) {
+    modules.emplace_back(
+        new PeriodicModule(interval_ms, start_ms + i % interval_ms));
+    process_thread->RegisterModule(modules.back().get(), RTC_FROM_HERE);
+  }
+
+  const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+  process_thread->Start();
+  rtc::Thread::SleepMs(kRunTimeMs);
+  process_thread->Stop();
+  const int64_t cpu_ns = rtc::GetProcessCpuTimeNanos() - start_cpu_ns;
+
+  int64_t num_processed = 0;
+  int64_t total_delay_ms = 0;
+  for (const auto& module : modules) {
+    num_processed += module->num_processed();
+    total_delay_ms += module->total_delay_ms();
+    process_thread->DeRegisterModule(module.get());
+  }
+  ASSERT_GT(num_processed, 0);
+
+  test::PrintResult(
+      "process_thread_cpu_usage", "", trace,
+      100.0 * cpu_ns / (kRunTimeMs * rtc::kNumNanosecsPerMillisec), "%", true);
+  test::PrintResult("process_thread_process_calls", "", trace,
+                    num_processed * 1000 / kRunTimeMs, "calls/s", false);
+  test::PrintResult("process_thread_process_delay", "", trace,
+                    static_cast<double>(total_delay_ms) / num_processed, "ms",
+                    true);
+}
+
+}  // namespace
+
+TEST(ProcessThreadPerformanceTest, FiveThousandModules) {
+  for (int64_t interval_ms : {kRtpRtcpIntervalMs, kIdleIntervalMs}) {
+    const std::string suffix = "_" + std::to_string(interval_ms) + "ms";
+    MeasureProcessThread("process_thread" + suffix,
+                         ProcessThread::Create("ProcessThread"), interval_ms);
+    MeasureProcessThread("sharded_1_thread" + suffix,
+                         ProcessThread::CreateSharded("ProcessThread", 1),
+                         interval_ms);
+    MeasureProcessThread("sharded_4_threads" + suffix,
+                         ProcessThread::CreateSharded("ProcessThread", 4),
+                         interval_ms);
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,420 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/utility/source/sharded_process_thread_impl.h"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "modules/include/module.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/trace_event.h"
+#include "system_wrappers/include/event_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+// Same as in ProcessThreadImpl: a module that asked for a callback right away
+// is processed without a call to TimeUntilNextProcess first.
+const int64_t kCallProcessImmediately = -1;
+
+int64_t GetNextCallbackTime(Module* module, int64_t time_now) {
+  int64_t interval = module->TimeUntilNextProcess();
+  if (interval < 0) {
+    // Falling behind, we should call the callback now.
+    return time_now;
+  }
+  return time_now + interval;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<ProcessThread> ProcessThread::CreateSharded(
+    const char* thread_name,
+    int num_threads) {
+  return std::unique_ptr<ProcessThread>(
+      new ShardedProcessThreadImpl(thread_name, num_threads));
+}
+
+// One worker thread and the modules it processes. Unlike ProcessThreadImpl, a
+// shard does not hold its lock while it calls into a module, so that a module
+// may hold locks of its own while it calls WakeUp() from another thread.
+// Instead, RemoveModule() waits for the module to return, so that a module is
+// not called anymore once RemoveModule() returns.
+class ShardedProcessThreadImpl::Shard {
+ public:
+  explicit Shard(std::string thread_name)
+      : wake_up_(EventWrapper::Create()),
+        module_returned_(false, false),
+        thread_name_(std::move(thread_name)) {}
+
+  ~Shard() {
+    RTC_DCHECK(!thread_);
+    while (!queue_.empty()) {
+      delete queue_.front();
+      queue_.pop();
+    }
+  }
+
+  void Start() {
+    RTC_DCHECK(!thread_);
+    thread_.reset(new rtc::PlatformThread(&Shard::Run, this,
+                                          thread_name_.c_str()));
+    thread_->Start();
+  }
+
+  void Stop() {
+    RTC_DCHECK(thread_);
+    {
+      rtc::CritScope lock(&lock_);
+      stop_ = true;
+    }
+    wake_up_->Set();
+    thread_->Stop();
+    stop_ = false;
+    thread_.reset();
+  }
+
+  void WakeUp(Module* module) {
+    {
+      rtc::CritScope lock(&lock_);
+      auto it = slots_.find(module);
+      if (it != slots_.end()) {
+        modules_[it->second].next_callback = kCallProcessImmediately;
+        Schedule(it->second);
+      }
+    }
+    wake_up_->Set();
+  }
+
+  void PostTask(std::unique_ptr<rtc::QueuedTask> task) {
+    {
+      rtc::CritScope lock(&lock_);
+      queue_.push(task.release());
+    }
+    wake_up_->Set();
+  }
+
+  void AddModule(Module* module, const rtc::Location& from) {
+    {
+      rtc::CritScope lock(&lock_);
+      size_t slot;
+      if (free_slots_.empty()) {
+        slot = modules_.size();
+        modules_.emplace_back();
+      } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+      }
+      modules_[slot].module = module;
+      modules_[slot].location = from;
+      modules_[slot].next_callback = 0;
+      slots_[module] = slot;
+      Schedule(slot);
+    }
+    // The new module has not been asked for its callback time yet.
+    wake_up_->Set();
+  }
+
+  void RemoveModule(Module* module) {
+    rtc::CritScope lock(&lock_);
+    auto it = slots_.find(module);
+    if (it == slots_.end())
+      return;
+    while (running_module_ == module) {
+      lock_.Leave();
+      module_returned_.Wait(rtc::Event::kForever);
+      lock_.Enter();
+    }
+    // The entries of the slot in |deadlines_| are dropped as they come up.
+    modules_[it->second] = ModuleCallback();
+    free_slots_.push_back(it->second);
+    slots_.erase(it);
+  }
+
+  size_t num_modules() {
+    rtc::CritScope lock(&lock_);
+    return slots_.size();
+  }
+
+ private:
+  struct ModuleCallback {
+    Module* module = nullptr;
+    int64_t next_callback = 0;  // Absolute timestamp.
+    // Tells which entry in |deadlines_| is the current one for the module.
+    // Zero for a free slot.
+    uint64_t generation = 0;
+    // The last round in which the module was processed.
+    uint64_t processed_round = 0;
+    rtc::Location location;
+  };
+
+  struct Entry {
+    size_t slot;
+    uint64_t generation;
+  };
+
+  static bool Run(void* obj) { return static_cast<Shard*>(obj)->Process(); }
+
+  // Adds an entry for the current |next_callback| of the module in |slot|,
+  // which makes any earlier entry of the module stale.
+  void Schedule(size_t slot) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    ModuleCallback& m = modules_[slot];
+    m.generation = ++next_generation_;
+    deadlines_[m.next_callback].push_back(Entry{slot, m.generation});
+  }
+
+  // Asks the module in |slot| for its callback time if it has not been asked
+  // yet, and processes it if it is due. Releases |lock_| while it calls into
+  // the module.
+  void ProcessModule(size_t slot, int64_t now)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    // |modules_| may grow while |lock_| is released, so the slot is looked
+    // up again afterwards.
+    Module* const module = modules_[slot].module;
+    const rtc::Location location = modules_[slot].location;
+    const uint64_t generation = modules_[slot].generation;
+    const bool query = modules_[slot].next_callback == 0;
+    running_module_ = module;
+    lock_.Leave();
+
+    int64_t next_callback = kCallProcessImmediately;
+    if (query)
+      next_callback = GetNextCallbackTime(module, now);
+    const bool process = next_callback <= now;
+    if (process) {
+      {
+        TRACE_EVENT2("webrtc", "ModuleProcess", "function",
+                     location.function_name(), "file",
+                     location.file_and_line());
+        module->Process();
+      }
+      // Use a new 'now' reference to calculate when the next callback
+      // should occur.  We'll continue to use 'now' above for the baseline
+      // of calculating how long we should wait, to reduce variance.
+      next_callback = GetNextCallbackTime(module, rtc::TimeMillis());
+    }
+
+    lock_.Enter();
+    running_module_ = nullptr;
+    module_returned_.Set();
+    ModuleCallback& m = modules_[slot];
+    // A module that was woken up meanwhile keeps its immediate callback.
+    const bool woken_up = m.generation != generation;
+    if (!woken_up)
+      m.next_callback = next_callback;
+    if (process) {
+      m.processed_round = round_;
+      processed_.push_back(slot);
+    } else if (!woken_up) {
+      Schedule(slot);
+    }
+  }
+
+  bool Process() {
+    TRACE_EVENT1("webrtc", "ShardedProcessThreadImpl", "name",
+                 thread_name_.c_str());
+    int64_t now = rtc::TimeMillis();
+    int64_t next_checkpoint = now + (1000 * 60);
+
+    {
+      rtc::CritScope lock(&lock_);
+      if (stop_)
+        return false;
+      ++round_;
+      while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+        due_.swap(deadlines_.begin()->second);
+        deadlines_.erase(deadlines_.begin());
+        for (const Entry& entry : due_) {
+          if (modules_[entry.slot].generation != entry.generation)
+            continue;
+          // A module that was woken up while it was processed in this round
+          // is processed again in the next one. It is scheduled again with
+          // the modules processed in this round.
+          if (modules_[entry.slot].processed_round == round_)
+            continue;
+          ProcessModule(entry.slot, now);
+        }
+        due_.clear();
+      }
+      // As with ProcessThreadImpl, a module is processed at most once per
+      // round, even if it is due again right away.
+      for (size_t slot : processed_) {
+        // Skips the slots of modules removed during the round.
+        if (modules_[slot].module)
+          Schedule(slot);
+      }
+      processed_.clear();
+
+      if (!deadlines_.empty())
+        next_checkpoint = std::min(next_checkpoint, deadlines_.begin()->first);
+
+      while (!queue_.empty()) {
+        rtc::QueuedTask* task = queue_.front();
+        queue_.pop();
+        lock_.Leave();
+        task->Run();
+        delete task;
+        lock_.Enter();
+      }
+    }
+
+    int64_t time_to_wait = next_checkpoint - rtc::TimeMillis();
+    if (time_to_wait > 0)
+      wake_up_->Wait(static_cast<unsigned long>(time_to_wait));
+
+    return true;
+  }
+
+  rtc::CriticalSection lock_;  // Used to guard the members below.
+  const std::unique_ptr<EventWrapper> wake_up_;
+  const std::string thread_name_;
+  std::unique_ptr<rtc::PlatformThread> thread_;
+
+  // The modules, by slot. A slot is only looked up by module to register,
+  // deregister or wake up the module.
+  std::vector<ModuleCallback> modules_;
+  std::vector<size_t> free_slots_;
+  std::unordered_map<const Module*, size_t> slots_;
+  // The entries of the modules by callback time. Since modules ask to be
+  // called back every few milliseconds, many share the same time, and only
+  // the times that are due are looked at.
+  std::map<int64_t, std::vector<Entry>> deadlines_;
+  uint64_t next_generation_ = 0;
+  // The entries being processed and the slots of the modules processed in
+  // the current round, to be scheduled again after it.
+  std::vector<Entry> due_;
+  std::vector<size_t> processed_;
+  uint64_t round_ = 0;
+  // The module being called into with |lock_| released, if any.
+  Module* running_module_ = nullptr;
+  // Signaled when the shard returns from a call into a module.
+  rtc::Event module_returned_;
+  std::queue<rtc::QueuedTask*> queue_;
+  bool stop_ = false;
+};
+
+ShardedProcessThreadImpl::ShardedProcessThreadImpl(const char* thread_name,
+                                                   int num_threads) {
+  RTC_DCHECK_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    std::string name(thread_name);
+    if (num_threads > 1)
+      name += "_" + std::to_string(i);
+    shards_.emplace_back(new Shard(std::move(name)));
+  }
+}
+
+ShardedProcessThreadImpl::~ShardedProcessThreadImpl() {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  RTC_DCHECK(!started_);
+}
+
+void ShardedProcessThreadImpl::Start() {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  RTC_DCHECK(!started_);
+  if (started_)
+    return;
+
+  for (const auto& module_shard : module_shards_)
+    module_shard.first->ProcessThreadAttached(this);
+
+  for (const auto& shard : shards_)
+    shard->Start();
+  started_ = true;
+}
+
+void ShardedProcessThreadImpl::Stop() {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  if (!started_)
+    return;
+
+  for (const auto& shard : shards_)
+    shard->Stop();
+  started_ = false;
+
+  for (const auto& module_shard : module_shards_)
+    module_shard.first->ProcessThreadAttached(nullptr);
+}
+
+void ShardedProcessThreadImpl::WakeUp(Module* module) {
+  // Allowed to be called on any thread.
+  Shard* shard;
+  {
+    rtc::CritScope lock(&lock_);
+    auto it = module_shards_.find(module);
+    if (it == module_shards_.end())
+      return;
+    shard = it->second;
+  }
+  shard->WakeUp(module);
+}
+
+void ShardedProcessThreadImpl::PostTask(
+    std::unique_ptr<rtc::QueuedTask> task) {
+  // Allowed to be called on any thread.
+  shards_[0]->PostTask(std::move(task));
+}
+
+void ShardedProcessThreadImpl::RegisterModule(Module* module,
+                                              const rtc::Location& from) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  RTC_DCHECK(module) << from.ToString();
+  RTC_DCHECK(module_shards_.find(module) == module_shards_.end())
+      << "Already registered, now attempting from here: " << from.ToString();
+
+  if (started_)
+    module->ProcessThreadAttached(this);
+
+  Shard* shard = shards_[0].get();
+  size_t num_modules = shard->num_modules();
+  for (size_t i = 1; i < shards_.size(); ++i) {
+    size_t shard_modules = shards_[i]->num_modules();
+    if (shard_modules < num_modules) {
+      shard = shards_[i].get();
+      num_modules = shard_modules;
+    }
+  }
+  shard->AddModule(module, from);
+
+  rtc::CritScope lock(&lock_);
+  module_shards_[module] = shard;
+}
+
+void ShardedProcessThreadImpl::DeRegisterModule(Module* module) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  RTC_DCHECK(module);
+
+  auto it = module_shards_.find(module);
+  if (it != module_shards_.end()) {
+    Shard* shard = it->second;
+    {
+      rtc::CritScope lock(&lock_);
+      module_shards_.erase(it);
+    }
+    shard->RemoveModule(module);
+  }
+
+  // Notify the module that it's been detached.
+  module->ProcessThreadAttached(nullptr);
+}
+
+}  // namespace webrtc
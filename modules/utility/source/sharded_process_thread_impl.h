@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_UTILITY_SOURCE_SHARDED_PROCESS_THREAD_IMPL_H_
+#define MODULES_UTILITY_SOURCE_SHARDED_PROCESS_THREAD_IMPL_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "modules/utility/include/process_thread.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/location.h"
+#include "rtc_base/thread_checker.h"
+
+namespace webrtc {
+
+// A ProcessThread for processes with many modules. Where ProcessThreadImpl
+// looks at every module on every wakeup, this one keeps the modules of a
+// thread ordered by their next callback times and only looks at the ones that
+// are due. A module is asked for TimeUntilNextProcess() again only
+// after it has been processed or woken up.
+//
+// The modules are spread over |num_threads| worker threads, each module
+// going to the thread with the fewest modules when it is registered. Posted
+// tasks all run on the first thread, in order.
+class ShardedProcessThreadImpl : public ProcessThread {
+ public:
+  ShardedProcessThreadImpl(const char* thread_name, int num_threads);
+  ~ShardedProcessThreadImpl() override;
+
+  void Start() override;
+  void Stop() override;
+
+  void WakeUp(Module* module) override;
+  void PostTask(std::unique_ptr<rtc::QueuedTask> task) override;
+
+  void RegisterModule(Module* module, const rtc::Location& from) override;
+  void DeRegisterModule(Module* module) override;
+
+ private:
+  class Shard;
+
+  rtc::ThreadChecker thread_checker_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  bool started_ = false;
+
+  // Used to guard |module_shards_|. Never held while taking the lock of a
+  // shard.
+  rtc::CriticalSection lock_;
+  // Only changed on the construction thread, which may read it without
+  // holding |lock_|.
+  std::map<Module*, Shard*> module_shards_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_UTILITY_SOURCE_SHARDED_PROCESS_THREAD_IMPL_H_
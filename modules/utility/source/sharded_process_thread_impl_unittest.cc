@@ -0,0 +1,352 @@
+/*
+ *  Copyright (c) 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "modules/include/module.h"
+#include "modules/utility/source/sharded_process_thread_impl.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/location.h"
+#include "rtc_base/platform_thread_types.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/event_wrapper.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
+using ::testing::Return;
+
+// The length of time, in milliseconds, to wait for an event to become signaled.
+static const int kEventWaitTimeout = 500;
+
+class MockModule : public Module {
+ public:
+  MOCK_METHOD0(TimeUntilNextProcess, int64_t());
+  MOCK_METHOD0(Process, void());
+  MOCK_METHOD1(ProcessThreadAttached, void(ProcessThread*));
+};
+
+class RecordCallTask : public rtc::QueuedTask {
+ public:
+  RecordCallTask(std::vector<std::string>* calls, const char* name)
+      : calls_(calls), name_(name) {}
+  bool Run() override {
+    calls_->push_back(name_);
+    return true;
+  }
+
+ private:
+  std::vector<std::string>* const calls_;
+  const char* const name_;
+};
+
+class RaiseEventTask : public rtc::QueuedTask {
+ public:
+  explicit RaiseEventTask(EventWrapper* event) : event_(event) {}
+  bool Run() override {
+    event_->Set();
+    return true;
+  }
+
+ private:
+  EventWrapper* event_;
+};
+
+ACTION_P(SetEvent, event) {
+  event->Set();
+}
+
+ACTION_P(Increment, counter) {
+  ++(*counter);
+}
+
+ACTION_P(SetTimestamp, ptr) {
+  *ptr = rtc::TimeMillis();
+}
+
+ACTION_P(SetCurrentThread, ptr) {
+  *ptr = rtc::CurrentThreadRef();
+}
+
+ACTION_P(SetTrue, flag) {
+  *flag = true;
+}
+
+ACTION_P(SleepMs, ms) {
+  rtc::Thread::SleepMs(ms);
+}
+
+ACTION_P(LockAndUnlock, lock) {
+  rtc::CritScope scope(lock);
+}
+
+TEST(ShardedProcessThreadImpl, StartStop) {
+  ShardedProcessThreadImpl thread("ProcessThread", 2);
+  for (int i = 0; i < 2; ++i) {
+    thread.Start();
+    thread.Stop();
+  }
+}
+
+TEST(ShardedProcessThreadImpl, ProcessCall) {
+  ShardedProcessThreadImpl thread("ProcessThread", 1);
+  std::unique_ptr<EventWrapper> event(EventWrapper::Create());
+
+  MockModule module;
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(1));
+  EXPECT_CALL(module, Process())
+      .WillOnce(DoAll(SetEvent(event.get()), Return()))
+      .WillRepeatedly(Return());
+
+  thread.RegisterModule(&module, RTC_FROM_HERE);
+
+  EXPECT_CALL(module, ProcessThreadAttached(&thread)).Times(1);
+  thread.Start();
+  EXPECT_EQ(kEventSignaled, event->Wait(kEventWaitTimeout));
+
+  EXPECT_CALL(module, ProcessThreadAttached(nullptr)).Times(1);
+  thread.Stop();
+}
+
+// After a module is deregistered, it gets no more callbacks, even though its
+// deadline is still in the heap.
+TEST(ShardedProcessThreadImpl, Deregister) {
+  ShardedProcessThreadImpl thread("ProcessThread", 1);
+  std::unique_ptr<EventWrapper> event(EventWrapper::Create());
+
+  int process_count = 0;
+  MockModule module;
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(1));
+  EXPECT_CALL(module, Process())
+      .WillOnce(
+          DoAll(SetEvent(event.get()), Increment(&process_count), Return()))
+      .WillRepeatedly(DoAll(Increment(&process_count), Return()));
+
+  EXPECT_CALL(module, ProcessThreadAttached(&thread)).Times(1);
+  thread.Start();
+  thread.RegisterModule(&module, RTC_FROM_HERE);
+  EXPECT_EQ(kEventSignaled, event->Wait(kEventWaitTimeout));
+
+  EXPECT_CALL(module, ProcessThreadAttached(nullptr)).Times(1);
+  thread.DeRegisterModule(&module);
+
+  EXPECT_GE(process_count, 1);
+  int count_after_deregister = process_count;
+
+  // We shouldn't get any more callbacks.
+  EXPECT_EQ(kEventTimeout, event->Wait(20));
+  EXPECT_EQ(count_after_deregister, process_count);
+  thread.Stop();
+}
+
+// A module that is woken up is processed right away, without being asked for
+// its callback time first.
+TEST(ShardedProcessThreadImpl, WakeUp) {
+  ShardedProcessThreadImpl thread("ProcessThread", 2);
+  thread.Start();
+
+  std::unique_ptr<EventWrapper> started(EventWrapper::Create());
+  std::unique_ptr<EventWrapper> called(EventWrapper::Create());
+
+  MockModule module;
+  int64_t start_time;
+  int64_t called_time;
+
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(DoAll(SetTimestamp(&start_time), SetEvent(started.get()),
+                      Return(1000)))
+      .WillOnce(Return(1000));
+  EXPECT_CALL(module, Process())
+      .WillOnce(
+          DoAll(SetTimestamp(&called_time), SetEvent(called.get()), Return()))
+      .WillRepeatedly(Return());
+
+  EXPECT_CALL(module, ProcessThreadAttached(&thread)).Times(1);
+  thread.RegisterModule(&module, RTC_FROM_HERE);
+
+  EXPECT_EQ(kEventSignaled, started->Wait(kEventWaitTimeout));
+  thread.WakeUp(&module);
+  EXPECT_EQ(kEventSignaled, called->Wait(kEventWaitTimeout));
+
+  EXPECT_CALL(module, ProcessThreadAttached(nullptr)).Times(1);
+  thread.Stop();
+
+  EXPECT_GE(called_time, start_time);
+  uint32_t diff = called_time - start_time;
+  // We should have been called back much quicker than 1sec.
+  EXPECT_LE(diff, 100u);
+}
+
+// A module that is not due is not asked for its callback time again while
+// another module is processed.
+TEST(ShardedProcessThreadImpl, OnlyQueriesDueModules) {
+  ShardedProcessThreadImpl thread("ProcessThread", 1);
+  std::unique_ptr<EventWrapper> event(EventWrapper::Create());
+
+  int process_count = 0;
+  MockModule busy_module;
+  EXPECT_CALL(busy_module, TimeUntilNextProcess()).WillRepeatedly(Return(1));
+  EXPECT_CALL(busy_module, Process())
+      .WillRepeatedly(DoAll(Increment(&process_count), Return()));
+  EXPECT_CALL(busy_module, ProcessThreadAttached(_)).Times(2);
+
+  MockModule idle_module;
+  EXPECT_CALL(idle_module, TimeUntilNextProcess())
+      .WillOnce(DoAll(SetEvent(event.get()), Return(10000)));
+  EXPECT_CALL(idle_module, Process()).Times(0);
+  EXPECT_CALL(idle_module, ProcessThreadAttached(_)).Times(2);
+
+  thread.RegisterModule(&busy_module, RTC_FROM_HERE);
+  thread.RegisterModule(&idle_module, RTC_FROM_HERE);
+  thread.Start();
+  EXPECT_EQ(kEventSignaled, event->Wait(kEventWaitTimeout));
+  EXPECT_EQ(kEventTimeout, event->Wait(50));
+  thread.Stop();
+
+  EXPECT_GT(process_count, 1);
+}
+
+// Modules are spread over the worker threads.
+TEST(ShardedProcessThreadImpl, SpreadsModulesOverThreads) {
+  ShardedProcessThreadImpl thread("ProcessThread", 2);
+  std::unique_ptr<EventWrapper> event1(EventWrapper::Create());
+  std::unique_ptr<EventWrapper> event2(EventWrapper::Create());
+
+  rtc::PlatformThreadRef thread1;
+  rtc::PlatformThreadRef thread2;
+  MockModule module1;
+  MockModule module2;
+  for (MockModule* module : {&module1, &module2}) {
+    EXPECT_CALL(*module, TimeUntilNextProcess())
+        .WillOnce(Return(0))
+        .WillRepeatedly(Return(1000));
+    EXPECT_CALL(*module, ProcessThreadAttached(_)).Times(2);
+  }
+  EXPECT_CALL(module1, Process())
+      .WillOnce(DoAll(SetCurrentThread(&thread1), SetEvent(event1.get()),
+                      Return()));
+  EXPECT_CALL(module2, Process())
+      .WillOnce(DoAll(SetCurrentThread(&thread2), SetEvent(event2.get()),
+                      Return()));
+
+  thread.RegisterModule(&module1, RTC_FROM_HERE);
+  thread.RegisterModule(&module2, RTC_FROM_HERE);
+  thread.Start();
+  EXPECT_EQ(kEventSignaled, event1->Wait(kEventWaitTimeout));
+  EXPECT_EQ(kEventSignaled, event2->Wait(kEventWaitTimeout));
+  thread.Stop();
+
+  EXPECT_FALSE(rtc::IsThreadRefEqual(thread1, thread2));
+}
+
+// A module that calls WakeUp() while it holds a lock that the module takes in
+// Process() does not deadlock with the process thread.
+TEST(ShardedProcessThreadImpl, WakeUpWhileHoldingModuleLock) {
+  ShardedProcessThreadImpl thread("ProcessThread", 1);
+  std::unique_ptr<EventWrapper> started(EventWrapper::Create());
+  rtc::CriticalSection module_lock;
+
+  MockModule module;
+  EXPECT_CALL(module, TimeUntilNextProcess()).WillRepeatedly(Return(0));
+  EXPECT_CALL(module, Process())
+      .WillOnce(DoAll(SetEvent(started.get()), LockAndUnlock(&module_lock),
+                      Return()))
+      .WillRepeatedly(Return());
+  EXPECT_CALL(module, ProcessThreadAttached(_)).Times(2);
+  thread.RegisterModule(&module, RTC_FROM_HERE);
+
+  {
+    rtc::CritScope lock(&module_lock);
+    thread.Start();
+    EXPECT_EQ(kEventSignaled, started->Wait(kEventWaitTimeout));
+    // The process thread is now waiting for |module_lock| in Process().
+    thread.WakeUp(&module);
+  }
+  thread.Stop();
+}
+
+// DeRegisterModule() does not return while the module is being processed.
+TEST(ShardedProcessThreadImpl, DeregisterWaitsForProcess) {
+  ShardedProcessThreadImpl thread("ProcessThread", 1);
+  std::unique_ptr<EventWrapper> started(EventWrapper::Create());
+  std::atomic<bool> returned(false);
+
+  MockModule module;
+  EXPECT_CALL(module, TimeUntilNextProcess()).WillRepeatedly(Return(0));
+  EXPECT_CALL(module, Process())
+      .WillOnce(DoAll(SetEvent(started.get()), SleepMs(50),
+                      SetTrue(&returned), Return()));
+  EXPECT_CALL(module, ProcessThreadAttached(_)).Times(2);
+  thread.RegisterModule(&module, RTC_FROM_HERE);
+  thread.Start();
+
+  EXPECT_EQ(kEventSignaled, started->Wait(kEventWaitTimeout));
+  thread.DeRegisterModule(&module);
+  EXPECT_TRUE(returned);
+  thread.Stop();
+}
+
+// A module that wakes itself up in Process() is processed again in the next
+// round, after the tasks posted in this one, rather than right away.
+TEST(ShardedProcessThreadImpl, WakeUpInProcessWaitsForNextRound) {
+  ShardedProcessThreadImpl thread("ProcessThread", 1);
+  std::unique_ptr<EventWrapper> called(EventWrapper::Create());
+  std::vector<std::string> calls;
+
+  MockModule module;
+  EXPECT_CALL(module, TimeUntilNextProcess())
+      .WillOnce(Return(0))
+      .WillRepeatedly(Return(1000));
+  EXPECT_CALL(module, Process())
+      .WillOnce(Invoke([&] {
+        calls.push_back("process");
+        thread.PostTask(std::unique_ptr<rtc::QueuedTask>(
+            new RecordCallTask(&calls, "task")));
+        thread.WakeUp(&module);
+      }))
+      .WillOnce(Invoke([&] {
+        calls.push_back("process");
+        called->Set();
+      }));
+  EXPECT_CALL(module, ProcessThreadAttached(_)).Times(2);
+  thread.RegisterModule(&module, RTC_FROM_HERE);
+  thread.Start();
+
+  EXPECT_EQ(kEventSignaled, called->Wait(kEventWaitTimeout));
+  thread.Stop();
+  EXPECT_THAT(calls, ElementsAre("process", "task", "process"));
+}
+
+TEST(ShardedProcessThreadImpl, PostTask) {
+  ShardedProcessThreadImpl thread("ProcessThread", 2);
+  std::unique_ptr<EventWrapper> task_ran(EventWrapper::Create());
+  std::unique_ptr<RaiseEventTask> task(new RaiseEventTask(task_ran.get()));
+  thread.Start();
+  thread.PostTask(std::move(task));
+  EXPECT_EQ(kEventSignaled, task_ran->Wait(kEventWaitTimeout));
+  thread.Stop();
+}
+
+}  // namespace webrtc
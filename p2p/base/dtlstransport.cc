@@ -204,6 +204,16 @@ bool DtlsTransport::SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version) {
   return true;
 }
 
+void DtlsTransport::SetSessionCache(rtc::SSLSessionCache* session_cache) {
+  RTC_DCHECK(!dtls_);
+  session_cache_ = session_cache;
+}
+
+void DtlsTransport::SetHandshakeOffloadPool(rtc::TaskPool* pool) {
+  RTC_DCHECK(!dtls_);
+  handshake_offload_pool_ = pool;
+}
+
 bool DtlsTransport::SetDtlsRole(rtc::SSLRole role) {
   if (dtls_) {
     RTC_DCHECK(dtls_role_);
@@ -350,6 +360,8 @@ bool DtlsTransport::SetupDtls() {
   dtls_->SetMode(rtc::SSL_MODE_DTLS);
   dtls_->SetMaxProtocolVersion(ssl_max_version_);
   dtls_->SetServerRole(*dtls_role_);
+  dtls_->SetSessionCache(session_cache_);
+  dtls_->SetHandshakeOffloadPool(handshake_offload_pool_);
   dtls_->SignalEvent.connect(this, &DtlsTransport::OnDtlsEvent);
   dtls_->SignalSSLHandshakeError.connect(this,
                                          &DtlsTransport::OnDtlsHandshakeError);
@@ -139,6 +139,16 @@ class DtlsTransport : public DtlsTransportInternal {
 
   bool SetSslMaxProtocolVersion(rtc::SSLProtocolVersion version) override;
 
+  // Resume the sessions of earlier handshakes through |session_cache|, which
+  // must outlive this transport. See SSLStreamAdapter::SetSessionCache.
+  // Must be called before the remote fingerprint is set.
+  void SetSessionCache(rtc::SSLSessionCache* session_cache);
+
+  // Do the private key operations of the handshake on |pool|. See
+  // SSLStreamAdapter::SetHandshakeOffloadPool. Must be called before the
+  // remote fingerprint is set.
+  void SetHandshakeOffloadPool(rtc::TaskPool* pool);
+
   // Find out which DTLS-SRTP cipher was negotiated
   bool GetSrtpCryptoSuite(int* cipher) override;
 
@@ -232,6 +242,8 @@ class DtlsTransport : public DtlsTransportInternal {
   absl::optional<rtc::SSLRole> dtls_role_;
   rtc::SSLProtocolVersion ssl_max_version_;
   rtc::CryptoOptions crypto_options_;
+  rtc::SSLSessionCache* session_cache_ = nullptr;
+  rtc::TaskPool* handshake_offload_pool_ = nullptr;
   rtc::Buffer remote_fingerprint_value_;
   std::string remote_fingerprint_algorithm_;
 
@@ -85,6 +85,11 @@ struct IceConfig {
   // candidate pairs will succeed, even before a binding response is received.
   bool presume_writable_when_fully_relayed = false;
 
+  // If set to true, the ICE transport is an ICE-lite agent (RFC 8445,
+  // section 2.5): it only answers the checks of its peer, which must be a full
+  // agent in the controlling role, and never sends any itself.
+  bool ice_lite = false;
+
   // Interval to check on all networks and to perform ICE regathering on any
   // active network having no connection on it.
   absl::optional<int> regather_on_failed_networks_interval;
@@ -12,7 +12,9 @@
 
 #include <algorithm>
 #include <iterator>
+#include <map>
 #include <set>
+#include <tuple>
 #include <utility>
 
 #include "api/candidate.h"
@@ -34,12 +36,16 @@ namespace {
 // The minimum improvement in RTT that justifies a switch.
 const int kMinImprovement = 10;
 
+// Below this many connections, sorting all of them costs less than setting
+// aside the ones whose sort key didn't change and merging them back.
+const size_t kMinConnectionsToSortIncrementally = 32;
+
 bool IsRelayRelay(const cricket::Connection* conn) {
   return conn->local_candidate().type() == cricket::RELAY_PORT_TYPE &&
          conn->remote_candidate().type() == cricket::RELAY_PORT_TYPE;
 }
 
-bool IsUdp(cricket::Connection* conn) {
+bool IsUdp(const cricket::Connection* conn) {
   return conn->local_candidate().relay_protocol() == cricket::UDP_PROTOCOL_NAME;
 }
 
@@ -190,8 +196,11 @@ void P2PTransportChannel::AddAllocatorSession(
 
 void P2PTransportChannel::AddConnection(Connection* connection) {
   connections_.push_back(connection);
+  connection_sort_keys_.push_back(absl::nullopt);
   unpinged_connections_.insert(connection);
+  ping_queue_stale_ = true;
   connection->set_remote_ice_mode(remote_ice_mode_);
+  connection->set_local_ice_mode(local_ice_mode());
   connection->set_receiving_timeout(config_.receiving_timeout);
   connection->set_unwritable_timeout(config_.ice_unwritable_timeout);
   connection->set_unwritable_min_checks(config_.ice_unwritable_min_checks);
@@ -468,9 +477,18 @@ void P2PTransportChannel::SetIceConfig(const IceConfig& config) {
 
   config_.prioritize_most_likely_candidate_pairs =
       config.prioritize_most_likely_candidate_pairs;
+  ping_queue_stale_ = true;
   RTC_LOG(LS_INFO) << "Set ping most likely connection to "
                    << config_.prioritize_most_likely_candidate_pairs;
 
+  if (config_.ice_lite != config.ice_lite) {
+    config_.ice_lite = config.ice_lite;
+    for (Connection* connection : connections_) {
+      connection->set_local_ice_mode(local_ice_mode());
+    }
+    RTC_LOG(LS_INFO) << "Set ICE-lite to " << config_.ice_lite;
+  }
+
   if (config_.stable_writable_connection_ping_interval !=
       config.stable_writable_connection_ping_interval) {
     config_.stable_writable_connection_ping_interval =
@@ -1415,7 +1433,8 @@ void P2PTransportChannel::MaybeStartPinging() {
     invoker_.AsyncInvoke<void>(
         RTC_FROM_HERE, thread(),
         rtc::Bind(&P2PTransportChannel::CheckAndPing, this));
-    regathering_controller_->Start();
+    if (!config_.ice_lite)
+      regathering_controller_->Start();
     started_pinging_ = true;
   }
 }
@@ -1622,6 +1641,129 @@ bool P2PTransportChannel::PresumedWritable(const Connection* conn) const {
            conn->remote_candidate().type() == PRFLX_PORT_TYPE));
 }
 
+bool P2PTransportChannel::ConnectionSortKey::operator==(
+    const ConnectionSortKey& o) const {
+  return writable == o.writable && write_state == o.write_state &&
+         receiving == o.receiving && connected == o.connected &&
+         remote_nomination == o.remote_nomination &&
+         last_data_received == o.last_data_received &&
+         uses_preferred_network == o.uses_preferred_network &&
+         network_cost == o.network_cost && priority == o.priority &&
+         generation == o.generation && pruned == o.pruned && rtt == o.rtt;
+}
+
+bool P2PTransportChannel::ConnectionSortKey::IsBetterThan(
+    const ConnectionSortKey& o) const {
+  // Fields where lower is better are compared the other way around.
+  return std::tie(writable, o.write_state, receiving, connected,
+                  remote_nomination, last_data_received,
+                  uses_preferred_network, o.network_cost, priority,
+                  generation, o.pruned, o.rtt) >
+         std::tie(o.writable, write_state, o.receiving, o.connected,
+                  o.remote_nomination, o.last_data_received,
+                  o.uses_preferred_network, network_cost, o.priority,
+                  o.generation, pruned, rtt);
+}
+
+// Reduces CompareConnections(), without a receiving unchanged threshold, and
+// the latency tie break to a key that can be compared field by field.
+P2PTransportChannel::ConnectionSortKey P2PTransportChannel::GetSortKey(
+    const Connection* conn,
+    const std::set<const PortInterface*>& ports,
+    const std::multimap<rtc::SocketAddress, const Candidate*>&
+        remote_candidates) const {
+  ConnectionSortKey key;
+  key.writable = conn->writable() || PresumedWritable(conn);
+  key.write_state = conn->write_state();
+  key.receiving = conn->receiving();
+  // Only compared between writable connections; see CompareConnectionStates.
+  key.connected =
+      conn->write_state() == Connection::STATE_WRITABLE && conn->connected();
+  // Nominations and received data only count on the controlled side.
+  const bool controlled = ice_role_ == ICEROLE_CONTROLLED;
+  key.remote_nomination = controlled ? conn->remote_nomination() : 0;
+  key.last_data_received = controlled ? conn->last_data_received() : 0;
+  key.uses_preferred_network =
+      LocalCandidateUsesPreferredNetwork(conn, config_.network_preference);
+  key.network_cost = conn->ComputeNetworkCost();
+  key.priority = conn->priority();
+  key.generation = int64_t{conn->remote_candidate().generation()} +
+                   conn->port()->generation();
+  const Candidate& remote = conn->remote_candidate();
+  auto range = remote_candidates.equal_range(remote.address());
+  key.pruned =
+      ports.find(conn->port()) == ports.end() ||
+      std::none_of(range.first, range.second,
+                   [&remote](const std::pair<const rtc::SocketAddress,
+                                             const Candidate*>& entry) {
+                     return *entry.second == remote;
+                   });
+  key.rtt = conn->rtt();
+  return key;
+}
+
+bool P2PTransportChannel::SortConnections() {
+  RTC_DCHECK_EQ(connections_.size(), connection_sort_keys_.size());
+  // Look up pruned ports and remote candidates once for all connections.
+  std::set<const PortInterface*> ports(ports_.begin(), ports_.end());
+  std::multimap<rtc::SocketAddress, const Candidate*> remote_candidates;
+  for (const RemoteCandidate& candidate : remote_candidates_)
+    remote_candidates.emplace(candidate.address(), &candidate);
+
+  // The connections whose key didn't change are still in order. Only the
+  // others need to be sorted, and then merged in, unless there are too few
+  // connections for that to pay off. Ties keep the current order, as with a
+  // stable sort.
+  struct Entry {
+    ConnectionSortKey key;
+    size_t index;
+    Connection* connection;
+  };
+  auto sorts_before = [](const Entry& a, const Entry& b) {
+    if (a.key.IsBetterThan(b.key))
+      return true;
+    if (b.key.IsBetterThan(a.key))
+      return false;
+    return a.index < b.index;
+  };
+  const bool incremental =
+      connections_.size() >= kMinConnectionsToSortIncrementally;
+  std::vector<Entry> unchanged;
+  std::vector<Entry> changed;
+  changed.reserve(connections_.size());
+  bool keys_changed = false;
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    Entry entry = {GetSortKey(connections_[i], ports, remote_candidates), i,
+                   connections_[i]};
+    if (connection_sort_keys_[i] && *connection_sort_keys_[i] == entry.key) {
+      (incremental ? unchanged : changed).push_back(entry);
+    } else {
+      connection_sort_keys_[i] = entry.key;
+      changed.push_back(entry);
+      keys_changed = true;
+    }
+  }
+  if (!keys_changed)
+    return false;
+
+  std::sort(changed.begin(), changed.end(), sorts_before);
+  std::vector<Entry> sorted;
+  if (incremental) {
+    sorted.reserve(connections_.size());
+    std::merge(unchanged.begin(), unchanged.end(), changed.begin(),
+               changed.end(), std::back_inserter(sorted), sorts_before);
+  } else {
+    sorted.swap(changed);
+  }
+  bool reordered = false;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    reordered |= sorted[i].index != i;
+    connections_[i] = sorted[i].connection;
+    connection_sort_keys_[i] = sorted[i].key;
+  }
+  return reordered;
+}
+
 // Sort the available connections to find the best one.  We also monitor
 // the number of available connections and the current state.
 void P2PTransportChannel::SortConnectionsAndUpdateState(
@@ -1639,21 +1781,16 @@ void P2PTransportChannel::SortConnectionsAndUpdateState(
   // that amongst equal preference, writable connections, this will choose the
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
-  // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  std::stable_sort(connections_.begin(), connections_.end(),
-                   [this](const Connection* a, const Connection* b) {
-                     int cmp = CompareConnections(a, b, absl::nullopt, nullptr);
-                     if (cmp != 0) {
-                       return cmp > 0;
-                     }
-                     // Otherwise, sort based on latency estimate.
-                     return a->rtt() < b->rtt();
-                   });
+  if (SortConnections()) {
+    ping_queue_stale_ = true;
+  }
 
-  RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
-                      << " available connections";
-  for (size_t i = 0; i < connections_.size(); ++i) {
-    RTC_LOG(LS_VERBOSE) << connections_[i]->ToString();
+  if (RTC_LOG_CHECK_LEVEL(LS_VERBOSE)) {
+    RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
+                        << " available connections";
+    for (size_t i = 0; i < connections_.size(); ++i) {
+      RTC_LOG(LS_VERBOSE) << connections_[i]->ToString();
+    }
   }
 
   Connection* top_connection =
@@ -1931,6 +2068,17 @@ void P2PTransportChannel::CheckAndPing() {
   // Make sure the states of the connections are up-to-date (since this affects
   // which ones are pingable).
   UpdateConnectionStates();
+  if (config_.ice_lite) {
+    // Nothing to ping, so the states only need to be updated for connections
+    // that stop receiving, and at the granularity of the receiving timeout.
+    // This keeps a server with many sessions from waking up for each of them
+    // every few tens of milliseconds.
+    invoker_.AsyncInvokeDelayed<void>(
+        RTC_FROM_HERE, thread(),
+        rtc::Bind(&P2PTransportChannel::CheckAndPing, this),
+        config_.receiving_timeout_or_default());
+    return;
+  }
   // When the selected connection is not receiving or not writable, or any
   // active connection has not been pinged enough times, use the weak ping
   // interval.
@@ -2093,39 +2241,80 @@ Connection* P2PTransportChannel::FindNextPingableConnection() {
             pinged_connections_.size() + unpinged_connections_.size());
   // If there are unpinged and pingable connections, only ping those.
   // Otherwise, treat everything as unpinged.
-  // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
-  // "pinged" to filter out unpinged connections.
-  if (std::find_if(unpinged_connections_.begin(), unpinged_connections_.end(),
-                   [this, now](Connection* conn) {
-                     return this->IsPingable(conn, now);
-                   }) == unpinged_connections_.end()) {
+  Connection* conn = FindMostPingableUnpingedConnection(now);
+  if (!conn && !pinged_connections_.empty()) {
     unpinged_connections_.insert(pinged_connections_.begin(),
                                  pinged_connections_.end());
     pinged_connections_.clear();
+    ping_queue_stale_ = true;
+    conn = FindMostPingableUnpingedConnection(now);
   }
+  return conn;
+}
 
-  // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<Connection*> pingable_connections;
-  std::copy_if(unpinged_connections_.begin(), unpinged_connections_.end(),
-               std::back_inserter(pingable_connections),
-               [this, now](Connection* conn) { return IsPingable(conn, now); });
-  auto iter =
-      std::max_element(pingable_connections.begin(), pingable_connections.end(),
-                       [this](Connection* conn1, Connection* conn2) {
-                         // Some implementations of max_element compare an
-                         // element with itself.
-                         if (conn1 == conn2) {
-                           return false;
-                         }
-                         return MorePingable(conn1, conn2) == conn2;
-                       });
-  if (iter != pingable_connections.end()) {
-    return *iter;
+namespace {
+
+// Orders the ping queue so that the entry to ping first is the largest.
+template <typename Entry>
+bool PingsAfter(const Entry& a, const Entry& b) {
+  if (a.rank != b.rank)
+    return a.rank < b.rank;
+  if (a.last_ping_sent != b.last_ping_sent)
+    return a.last_ping_sent > b.last_ping_sent;
+  return a.position > b.position;
+}
+
+}  // namespace
+
+Connection* P2PTransportChannel::FindMostPingableUnpingedConnection(
+    int64_t now) {
+  if (ping_queue_stale_)
+    RebuildPingQueue();
+  // Connections that can't be pinged right now stay queued.
+  std::vector<PingQueueEntry> skipped;
+  Connection* conn = nullptr;
+  while (!ping_queue_.empty()) {
+    const PingQueueEntry& top = ping_queue_.front();
+    const bool pinged = !unpinged_connections_.count(top.connection);
+    if (!pinged && top.last_ping_sent != top.connection->last_ping_sent()) {
+      // Pinged behind our back, which only moves it back in the queue.
+      RebuildPingQueue();
+      continue;
+    }
+    if (!pinged && IsPingable(top.connection, now)) {
+      conn = top.connection;
+      break;
+    }
+    std::pop_heap(ping_queue_.begin(), ping_queue_.end(),
+                  PingsAfter<PingQueueEntry>);
+    if (!pinged)
+      skipped.push_back(ping_queue_.back());
+    ping_queue_.pop_back();
+  }
+  for (const PingQueueEntry& entry : skipped) {
+    ping_queue_.push_back(entry);
+    std::push_heap(ping_queue_.begin(), ping_queue_.end(),
+                   PingsAfter<PingQueueEntry>);
+  }
+  return conn;
+}
+
+void P2PTransportChannel::RebuildPingQueue() {
+  ping_queue_.clear();
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    Connection* conn = connections_[i];
+    if (unpinged_connections_.count(conn)) {
+      ping_queue_.push_back(
+          {MostLikelyToWorkRank(conn), conn->last_ping_sent(), i, conn});
+    }
   }
-  return nullptr;
+  std::make_heap(ping_queue_.begin(), ping_queue_.end(),
+                 PingsAfter<PingQueueEntry>);
+  ping_queue_stale_ = false;
 }
 
 void P2PTransportChannel::MarkConnectionPinged(Connection* conn) {
+  // Its entry in |ping_queue_| is dropped once it comes up.
   if (conn && pinged_connections_.insert(conn).second) {
     unpinged_connections_.erase(conn);
   }
@@ -2232,7 +2421,10 @@ void P2PTransportChannel::OnConnectionDestroyed(Connection* connection) {
   RTC_DCHECK(iter != connections_.end());
   pinged_connections_.erase(*iter);
   unpinged_connections_.erase(*iter);
+  connection_sort_keys_.erase(connection_sort_keys_.begin() +
+                              (iter - connections_.begin()));
   connections_.erase(iter);
+  ping_queue_stale_ = true;
 
   RTC_LOG(LS_INFO) << ToString() << ": Removed connection " << connection
                    << " (" << connections_.size() << " remaining)";
@@ -2377,58 +2569,10 @@ Connection* P2PTransportChannel::FindOldestConnectionNeedingTriggeredCheck(
   return oldest_needing_triggered_check;
 }
 
-Connection* P2PTransportChannel::MostLikelyToWork(Connection* conn1,
-                                                  Connection* conn2) {
-  bool rr1 = IsRelayRelay(conn1);
-  bool rr2 = IsRelayRelay(conn2);
-  if (rr1 && !rr2) {
-    return conn1;
-  } else if (rr2 && !rr1) {
-    return conn2;
-  } else if (rr1 && rr2) {
-    bool udp1 = IsUdp(conn1);
-    bool udp2 = IsUdp(conn2);
-    if (udp1 && !udp2) {
-      return conn1;
-    } else if (udp2 && udp1) {
-      return conn2;
-    }
-  }
-  return nullptr;
-}
-
-Connection* P2PTransportChannel::LeastRecentlyPinged(Connection* conn1,
-                                                     Connection* conn2) {
-  if (conn1->last_ping_sent() < conn2->last_ping_sent()) {
-    return conn1;
-  }
-  if (conn1->last_ping_sent() > conn2->last_ping_sent()) {
-    return conn2;
-  }
-  return nullptr;
-}
-
-Connection* P2PTransportChannel::MorePingable(Connection* conn1,
-                                              Connection* conn2) {
-  RTC_DCHECK(conn1 != conn2);
-  if (config_.prioritize_most_likely_candidate_pairs) {
-    Connection* most_likely_to_work_conn = MostLikelyToWork(conn1, conn2);
-    if (most_likely_to_work_conn) {
-      return most_likely_to_work_conn;
-    }
-  }
-
-  Connection* least_recently_pinged_conn = LeastRecentlyPinged(conn1, conn2);
-  if (least_recently_pinged_conn) {
-    return least_recently_pinged_conn;
-  }
-
-  // During the initial state when nothing has been pinged yet, return the first
-  // one in the ordered |connections_|.
-  return *(std::find_if(connections_.begin(), connections_.end(),
-                        [conn1, conn2](Connection* conn) {
-                          return conn == conn1 || conn == conn2;
-                        }));
+int P2PTransportChannel::MostLikelyToWorkRank(const Connection* conn) const {
+  if (!config_.prioritize_most_likely_candidate_pairs || !IsRelayRelay(conn))
+    return 0;
+  return IsUdp(conn) ? 2 : 1;
 }
 
 void P2PTransportChannel::set_writable(bool writable) {
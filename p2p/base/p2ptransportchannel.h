@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "api/asyncresolverfactory.h"
 #include "api/candidate.h"
 #include "api/rtcerror.h"
@@ -143,6 +144,9 @@ class P2PTransportChannel : public IceTransportInternal {
   const std::vector<PortInterface*>& pruned_ports() { return pruned_ports_; }
 
   IceMode remote_ice_mode() const { return remote_ice_mode_; }
+  IceMode local_ice_mode() const {
+    return config_.ice_lite ? ICEMODE_LITE : ICEMODE_FULL;
+  }
 
   void PruneAllPorts();
   int check_receiving_interval() const;
@@ -239,6 +243,10 @@ class P2PTransportChannel : public IceTransportInternal {
   bool PresumedWritable(const cricket::Connection* conn) const;
 
   void SortConnectionsAndUpdateState(const std::string& reason_to_sort);
+  // Orders |connections_| by CompareConnections() and then latency, moving
+  // only the connections whose sort key changed since the last call. Returns
+  // true if the order changed.
+  bool SortConnections();
   void SwitchSelectedConnection(Connection* conn);
   void UpdateState();
   void HandleAllTimedOut();
@@ -327,14 +335,13 @@ class P2PTransportChannel : public IceTransportInternal {
   bool IsBackupConnection(const Connection* conn) const;
 
   Connection* FindOldestConnectionNeedingTriggeredCheck(int64_t now);
-  // Between |conn1| and |conn2|, this function returns the one which should
-  // be pinged first.
-  Connection* MorePingable(Connection* conn1, Connection* conn2);
-  // Select the connection which is Relay/Relay. If both of them are,
-  // UDP relay protocol takes precedence.
-  Connection* MostLikelyToWork(Connection* conn1, Connection* conn2);
-  // Compare the last_ping_sent time and return the one least recently pinged.
-  Connection* LeastRecentlyPinged(Connection* conn1, Connection* conn2);
+  // Returns the pingable connection in |unpinged_connections_| that should be
+  // pinged first, or nullptr if there is none.
+  Connection* FindMostPingableUnpingedConnection(int64_t now);
+  void RebuildPingQueue();
+  // With prioritize_most_likely_candidate_pairs, Relay/Relay connections are
+  // pinged first, and among those the ones with a UDP relay protocol.
+  int MostLikelyToWorkRank(const Connection* conn) const;
 
   // Returns the latest remote ICE parameters or nullptr if there are no remote
   // ICE parameters yet.
@@ -391,6 +398,50 @@ class P2PTransportChannel : public IceTransportInternal {
   std::set<Connection*> pinged_connections_;
   std::set<Connection*> unpinged_connections_;
 
+  // What SortConnections() orders connections by, which is what
+  // CompareConnections() and the latency tie break compare for the current
+  // state of the channel.
+  struct ConnectionSortKey {
+    bool writable;
+    int write_state;
+    bool receiving;
+    bool connected;
+    uint32_t remote_nomination;
+    int64_t last_data_received;
+    bool uses_preferred_network;
+    uint32_t network_cost;
+    uint64_t priority;
+    int64_t generation;
+    bool pruned;
+    int rtt;
+
+    bool operator==(const ConnectionSortKey& o) const;
+    // Returns true if a connection with this key sorts before one with |o|.
+    bool IsBetterThan(const ConnectionSortKey& o) const;
+  };
+  ConnectionSortKey GetSortKey(
+      const Connection* conn,
+      const std::set<const PortInterface*>& ports,
+      const std::multimap<rtc::SocketAddress, const Candidate*>&
+          remote_candidates) const;
+  // The sort key of each of |connections_| as of the last sort, or nullopt for
+  // the connections added since.
+  std::vector<absl::optional<ConnectionSortKey>> connection_sort_keys_;
+
+  // A heap of |unpinged_connections_| with the one to ping first on top: the
+  // most likely to work, then the least recently pinged, then the first in
+  // |connections_|. It is rebuilt when stale, e.g. after connections were
+  // re-sorted, so that each ping only costs a heap operation. Entries of
+  // connections pinged since are dropped when they come up.
+  struct PingQueueEntry {
+    int rank;
+    int64_t last_ping_sent;
+    size_t position;
+    Connection* connection;
+  };
+  std::vector<PingQueueEntry> ping_queue_;
+  bool ping_queue_stale_ = true;
+
   Connection* selected_connection_ = nullptr;
 
   std::vector<RemoteCandidate> remote_candidates_;
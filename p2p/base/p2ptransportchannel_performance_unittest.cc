@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/p2pconstants.h"
+#include "p2p/base/p2ptransportchannel.h"
+#include "p2p/client/basicportallocator.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/fakenetwork.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const int kConnectTimeoutMs = 30000;
+const int kRunTimeMs = 30000;
+
+// One ICE agent with a host candidate on each of |num_interfaces| networks.
+class Endpoint : public sigslot::has_slots<> {
+ public:
+  Endpoint(const std::string& name,
+           int subnet,
+           int num_interfaces,
+           IceRole role,
+           uint64_t tiebreaker)
+      : ufrag_(name + "ufrag"), pwd_(name + "password0123456789") {
+    for (int i = 0; i < num_interfaces; ++i) {
+      network_manager_.AddInterface(rtc::SocketAddress(
+          rtc::IPAddress((10 << 24) | (subnet << 16) | (i << 8) | 1), 0));
+    }
+    allocator_ = absl::make_unique<BasicPortAllocator>(&network_manager_);
+    allocator_->set_flags(PORTALLOCATOR_DISABLE_STUN |
+                          PORTALLOCATOR_DISABLE_RELAY |
+                          PORTALLOCATOR_DISABLE_TCP);
+    allocator_->set_step_delay(kMinimumStepDelay);
+    channel_ = absl::make_unique<P2PTransportChannel>(
+        "data", ICE_CANDIDATE_COMPONENT_DEFAULT, allocator_.get());
+    channel_->SetIceRole(role);
+    channel_->SetIceTiebreaker(tiebreaker);
+    channel_->SetIceParameters(IceParameters(ufrag_, pwd_, false));
+    channel_->SignalCandidateGathered.connect(this,
+                                              &Endpoint::OnCandidateGathered);
+  }
+
+  P2PTransportChannel* channel() { return channel_.get(); }
+
+  void Connect(Endpoint* peer) {
+    peer_ = peer;
+    channel_->SetRemoteIceParameters(
+        IceParameters(peer->ufrag_, peer->pwd_, false));
+    channel_->MaybeStartGathering();
+  }
+
+ private:
+  void OnCandidateGathered(IceTransportInternal* transport,
+                           const Candidate& candidate) {
+    peer_->channel_->AddRemoteCandidate(candidate);
+  }
+
+  const std::string ufrag_;
+  const std::string pwd_;
+  rtc::FakeNetworkManager network_manager_;
+  std::unique_ptr<BasicPortAllocator> allocator_;
+  std::unique_ptr<P2PTransportChannel> channel_;
+  Endpoint* peer_ = nullptr;
+};
+
+// Connects an agent on |num_local| networks to one on |num_remote| networks,
+// which makes |num_local| x |num_remote| candidate pairs on either side, and
+// reports how much real time it takes to simulate connecting and then
+// |kRunTimeMs| of keeping the pairs alive.
+void MeasureCandidatePairs(int num_local, int num_remote) {
+  rtc::ScopedFakeClock clock;
+  rtc::VirtualSocketServer socket_server;
+  rtc::AutoSocketServerThread thread(&socket_server);
+  Endpoint ep1("ep1", 1, num_local, ICEROLE_CONTROLLING, 1);
+  Endpoint ep2("ep2", 2, num_remote, ICEROLE_CONTROLLED, 2);
+
+  const int64_t connect_start_ns = rtc::SystemTimeNanos();
+  ep1.Connect(&ep2);
+  ep2.Connect(&ep1);
+  ASSERT_TRUE_SIMULATED_WAIT(
+      ep1.channel()->writable() && ep2.channel()->writable(),
+      kConnectTimeoutMs, clock);
+  const int64_t connect_ns = rtc::SystemTimeNanos() - connect_start_ns;
+  EXPECT_EQ(static_cast<size_t>(num_local * num_remote),
+            ep1.channel()->connections().size());
+
+  const int64_t run_start_ns = rtc::SystemTimeNanos();
+  // In steps, as the timers of the channels repost themselves.
+  for (int i = 0; i < kRunTimeMs; ++i)
+    clock.AdvanceTime(webrtc::TimeDelta::ms(1));
+  const int64_t run_ns = rtc::SystemTimeNanos() - run_start_ns;
+  EXPECT_TRUE(ep1.channel()->writable());
+  EXPECT_TRUE(ep2.channel()->writable());
+
+  rtc::StringBuilder trace;
+  trace << num_local * num_remote << "_pairs";
+  webrtc::test::PrintResult("ice_connect_cpu_time", "", trace.str(),
+                            connect_ns / 1e6, "ms", true);
+  webrtc::test::PrintResult("ice_steady_state_cpu_time", "", trace.str(),
+                            1e3 * run_ns / 1e6 / kRunTimeMs,
+                            "ms/simulated_s", true);
+}
+
+}  // namespace
+
+// Multi-homed agents, as on servers with many interfaces, with both sides
+// pinging and re-sorting all their candidate pairs.
+TEST(P2PTransportChannelPerformanceTest, ManyCandidatePairs) {
+  MeasureCandidatePairs(4, 4);
+  MeasureCandidatePairs(8, 16);
+  MeasureCandidatePairs(16, 32);
+}
+
+}  // namespace cricket
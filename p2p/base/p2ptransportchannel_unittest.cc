@@ -4561,6 +4561,51 @@ TEST_F(P2PTransportChannelMostLikelyToWorkFirstTest, TestTcpTurn) {
   VerifyNextPingableConnection(LOCAL_PORT_TYPE, RELAY_PORT_TYPE);
 }
 
+// Test that two UDP Relay/Relay connections are pinged before the TCP
+// Relay/Relay ones, and that the least recently pinged of the two goes first.
+TEST_F(P2PTransportChannelMostLikelyToWorkFirstTest,
+       TestUdpRelayRelayTieBrokenByLastPingSent) {
+  turn_server()->AddInternalSocket(kTurnTcpIntAddr, PROTO_TCP);
+  RelayServerConfig config(RELAY_TURN);
+  config.credentials = kRelayCredentials;
+  config.ports.push_back(ProtocolAddress(kTurnTcpIntAddr, PROTO_TCP));
+  allocator()->AddTurnServer(config);
+
+  P2PTransportChannel& ch = StartTransportChannel(true, 500);
+  EXPECT_TRUE_WAIT(ch.ports().size() == 3, kDefaultTimeout);
+
+  ch.AddRemoteCandidate(CreateUdpCandidate(RELAY_PORT_TYPE, "1.1.1.1", 1, 1));
+  ch.AddRemoteCandidate(CreateUdpCandidate(RELAY_PORT_TYPE, "2.2.2.2", 2, 2));
+  EXPECT_TRUE_WAIT(ch.connections().size() == 6, kDefaultTimeout);
+
+  // Both UDP Relay/Relay connections come first, then both TCP Relay/Relay
+  // ones, and Local/Relay last.
+  Connection* conn1 = FindNextPingableConnectionAndPingIt(&ch);
+  Connection* conn2 = FindNextPingableConnectionAndPingIt(&ch);
+  ASSERT_NE(nullptr, conn1);
+  ASSERT_NE(nullptr, conn2);
+  EXPECT_NE(conn1, conn2);
+  for (Connection* conn : {conn1, conn2}) {
+    EXPECT_EQ(conn->local_candidate().type(), RELAY_PORT_TYPE);
+    EXPECT_EQ(conn->local_candidate().relay_protocol(), UDP_PROTOCOL_NAME);
+    EXPECT_EQ(conn->remote_candidate().type(), RELAY_PORT_TYPE);
+  }
+  VerifyNextPingableConnection(RELAY_PORT_TYPE, RELAY_PORT_TYPE,
+                               TCP_PROTOCOL_NAME);
+  VerifyNextPingableConnection(RELAY_PORT_TYPE, RELAY_PORT_TYPE,
+                               TCP_PROTOCOL_NAME);
+  VerifyNextPingableConnection(LOCAL_PORT_TYPE, RELAY_PORT_TYPE);
+  VerifyNextPingableConnection(LOCAL_PORT_TYPE, RELAY_PORT_TYPE);
+
+  // Now, every connection has been pinged once. Once |conn1| has been pinged
+  // more recently than |conn2|, |conn2| goes first, whatever their order in
+  // the list of connections.
+  conn2->Ping(rtc::TimeMillis());
+  conn1->Ping(conn2->last_ping_sent() + 1);
+  EXPECT_EQ(conn2, FindNextPingableConnectionAndPingIt(&ch));
+  EXPECT_EQ(conn1, FindNextPingableConnectionAndPingIt(&ch));
+}
+
 // Test that a resolver is created, asked for a result, and destroyed
 // when the address is a hostname.
 TEST(P2PTransportChannelResolverTest, HostnameCandidateIsResolved) {
@@ -371,6 +371,7 @@ void Port::SetIceParameters(int component,
   component_ = component;
   ice_username_fragment_ = username_fragment;
   password_ = password;
+  integrity_key_.reset();
   for (Candidate& c : candidates_) {
     c.set_component(component);
     c.set_username(username_fragment);
@@ -556,16 +557,16 @@ bool Port::GetStunMessage(const char* data,
                           const rtc::SocketAddress& addr,
                           std::unique_ptr<IceMessage>* out_msg,
                           std::string* out_username) {
-  // NOTE: This could clearly be optimized to avoid allocating any memory.
-  //       However, at the data rates we'll be looking at on the client side,
-  //       this probably isn't worth worrying about.
   RTC_DCHECK(out_msg != NULL);
   RTC_DCHECK(out_username != NULL);
   out_username->clear();
 
   // Don't bother parsing the packet if we can tell it's not STUN.
-  // In ICE mode, all STUN packets will have a valid fingerprint.
-  if (!StunMessage::ValidateFingerprint(data, size)) {
+  // In ICE mode, all STUN packets will have a valid fingerprint. The view
+  // checks the framing in place, so that garbage is dropped without
+  // allocating; the full message is only built for packets that pass.
+  StunMessageView view;
+  if (!view.Parse(data, size) || !view.ValidateFingerprint()) {
     return false;
   }
 
@@ -604,7 +605,7 @@ bool Port::GetStunMessage(const char* data,
     }
 
     // If ICE, and the MESSAGE-INTEGRITY is bad, fail with a 401 Unauthorized
-    if (!stun_msg->ValidateMessageIntegrity(data, size, password_)) {
+    if (!view.ValidateMessageIntegrity(GetIntegrityKey())) {
       RTC_LOG(LS_ERROR) << ToString()
                         << ": Received STUN request with bad M-I from "
                         << addr.ToSensitiveString()
@@ -812,7 +813,7 @@ void Port::SendBindingResponse(StunMessage* request,
 
   response.AddAttribute(absl::make_unique<StunXorAddressAttribute>(
       STUN_ATTR_XOR_MAPPED_ADDRESS, addr));
-  response.AddMessageIntegrity(password_);
+  response.AddMessageIntegrity(GetIntegrityKey());
   response.AddFingerprint();
 
   // Send the response message.
@@ -865,7 +866,7 @@ void Port::SendBindingErrorResponse(StunMessage* request,
   // because we don't have enough information to determine the shared secret.
   if (error_code != STUN_ERROR_BAD_REQUEST &&
       error_code != STUN_ERROR_UNAUTHORIZED)
-    response.AddMessageIntegrity(password_);
+    response.AddMessageIntegrity(GetIntegrityKey());
   response.AddFingerprint();
 
   // Send the response message.
@@ -909,6 +910,12 @@ void Port::OnNetworkTypeChanged(const rtc::Network* network) {
   UpdateNetworkCost();
 }
 
+StunMessageIntegrityKey* Port::GetIntegrityKey() {
+  if (!integrity_key_)
+    integrity_key_ = absl::make_unique<StunMessageIntegrityKey>(password_);
+  return integrity_key_.get();
+}
+
 std::string Port::ToString() const {
   rtc::StringBuilder ss;
   ss << "Port[" << rtc::ToHex(reinterpret_cast<uintptr_t>(this)) << ":"
@@ -1045,7 +1052,7 @@ class ConnectionRequest : public StunRequest {
         STUN_ATTR_PRIORITY, prflx_priority));
 
     // Adding Message Integrity attribute.
-    request->AddMessageIntegrity(connection_->remote_candidate().password());
+    request->AddMessageIntegrity(connection_->GetRemoteIntegrityKey());
     // Adding Fingerprint.
     request->AddFingerprint();
   }
@@ -1284,8 +1291,8 @@ void Connection::OnReadPacket(const char* data,
       // id's match.
       case STUN_BINDING_RESPONSE:
       case STUN_BINDING_ERROR_RESPONSE:
-        if (msg->ValidateMessageIntegrity(data, size,
-                                          remote_candidate().password())) {
+        if (StunMessage::ValidateMessageIntegrity(data, size,
+                                                  GetRemoteIntegrityKey())) {
           requests_.CheckResponse(msg.get());
         }
         // Otherwise silently discard the response message.
@@ -1329,6 +1336,13 @@ void Connection::HandleBindingRequest(IceMessage* msg) {
     set_write_state(STATE_WRITE_INIT);
   }
 
+  // RFC 8445, section 2.5: the checks of an ICE-lite agent's peer are all that
+  // validate a pair.
+  if (local_ice_mode_ == ICEMODE_LITE) {
+    set_write_state(STATE_WRITABLE);
+    set_state(IceCandidatePairState::SUCCEEDED);
+  }
+
   if (port_->GetIceRole() == ICEROLE_CONTROLLED) {
     const StunUInt32Attribute* nomination_attr =
         msg->GetUInt32(STUN_ATTR_NOMINATION);
@@ -1663,6 +1677,15 @@ void Connection::LogCandidatePairEvent(webrtc::IceCandidatePairEventType type) {
   ice_event_log_->LogCandidatePairEvent(type, id());
 }
 
+StunMessageIntegrityKey* Connection::GetRemoteIntegrityKey() {
+  const std::string& password = remote_candidate_.password();
+  if (!remote_integrity_key_ || remote_integrity_key_->key() != password) {
+    remote_integrity_key_ =
+        absl::make_unique<StunMessageIntegrityKey>(password);
+  }
+  return remote_integrity_key_.get();
+}
+
 void Connection::OnConnectionRequestResponse(ConnectionRequest* request,
                                              StunMessage* response) {
   // Log at LS_INFO if we receive a ping response on an unwritable
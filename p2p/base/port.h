@@ -453,6 +453,9 @@ class Port : public PortInterface,
 
   void OnNetworkTypeChanged(const rtc::Network* network);
 
+  // Returns the MESSAGE-INTEGRITY key for |password_|.
+  StunMessageIntegrityKey* GetIntegrityKey();
+
   rtc::Thread* thread_;
   rtc::PacketSocketFactory* factory_;
   std::string type_;
@@ -473,6 +476,8 @@ class Port : public PortInterface,
   // username_fragment().
   std::string ice_username_fragment_;
   std::string password_;
+  // Created on first use; reset when |password_| changes.
+  std::unique_ptr<StunMessageIntegrityKey> integrity_key_;
   std::vector<Candidate> candidates_;
   AddressMap connections_;
   int timeout_delay_;
@@ -623,6 +628,9 @@ class Connection : public CandidatePairInterface,
   uint32_t acked_nomination() const { return acked_nomination_; }
 
   void set_remote_ice_mode(IceMode mode) { remote_ice_mode_ = mode; }
+  // An ICE-lite agent doesn't send checks, so a connection becomes writable
+  // once it has answered a check from the peer.
+  void set_local_ice_mode(IceMode mode) { local_ice_mode_ = mode; }
 
   int receiving_timeout() const;
   void set_receiving_timeout(absl::optional<int> receiving_timeout_ms) {
@@ -769,6 +777,10 @@ class Connection : public CandidatePairInterface,
   void LogCandidatePairConfig(webrtc::IceCandidatePairConfigType type);
   void LogCandidatePairEvent(webrtc::IceCandidatePairEventType type);
 
+  // Returns the MESSAGE-INTEGRITY key for the remote candidate's password,
+  // which changes on an ICE restart.
+  StunMessageIntegrityKey* GetRemoteIntegrityKey();
+
   WriteState write_state_;
   bool receiving_;
   bool connected_;
@@ -793,6 +805,7 @@ class Connection : public CandidatePairInterface,
   uint32_t remote_nomination_ = 0;
 
   IceMode remote_ice_mode_;
+  IceMode local_ice_mode_ = ICEMODE_FULL;
   StunRequestManager requests_;
   int rtt_;
   int rtt_samples_ = 0;
@@ -823,6 +836,8 @@ class Connection : public CandidatePairInterface,
   absl::optional<webrtc::IceCandidatePairDescription> log_description_;
   webrtc::IceEventLog* ice_event_log_ = nullptr;
 
+  std::unique_ptr<StunMessageIntegrityKey> remote_integrity_key_;
+
   friend class Port;
   friend class ConnectionRequest;
 };
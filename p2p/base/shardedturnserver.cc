@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/shardedturnserver.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/basicpacketsocketfactory.h"
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace cricket {
+
+ShardedTurnServer::Config::Config() = default;
+
+ShardedTurnServer::Config::Config(const Config&) = default;
+
+ShardedTurnServer::Config::~Config() = default;
+
+ShardedTurnServer::Shard::Shard() = default;
+
+ShardedTurnServer::Shard::Shard(Shard&&) = default;
+
+ShardedTurnServer::Shard::~Shard() = default;
+
+ShardedTurnServer::ShardedTurnServer() = default;
+
+ShardedTurnServer::~ShardedTurnServer() {
+  for (Shard& shard : shards_) {
+    shard.thread->Invoke<void>(RTC_FROM_HERE, [&shard] { shard.server.reset(); });
+    shard.thread->Stop();
+  }
+}
+
+// static
+std::unique_ptr<ShardedTurnServer> ShardedTurnServer::Create(
+    const Config& config) {
+  RTC_DCHECK_GT(config.num_shards, 0);
+  std::unique_ptr<ShardedTurnServer> server(new ShardedTurnServer());
+  server->internal_address_ = config.internal_address;
+  const bool reuse_port = config.num_shards > 1;
+  for (int i = 0; i < config.num_shards; ++i) {
+    if (!server->AddShard(config, reuse_port))
+      return nullptr;
+  }
+  RTC_LOG(LS_INFO) << "TURN server listening on "
+                   << server->internal_address_.ToString() << " with "
+                   << config.num_shards << " shards";
+  return server;
+}
+
+size_t ShardedTurnServer::GetAllocationCount() const {
+  size_t count = 0;
+  for (const Shard& shard : shards_) {
+    count += shard.thread->Invoke<size_t>(
+        RTC_FROM_HERE, [&shard] { return shard.server->allocations().size(); });
+  }
+  return count;
+}
+
+bool ShardedTurnServer::AddShard(const Config& config, bool reuse_port) {
+  Shard shard;
+  shard.thread = rtc::Thread::CreateWithSocketServer();
+  shard.thread->SetName("TurnShard", nullptr);
+  shard.thread->Start();
+  rtc::Thread* thread = shard.thread.get();
+  const bool bound = thread->Invoke<bool>(RTC_FROM_HERE, [&] {
+    rtc::AsyncSocket* socket = thread->socketserver()->CreateAsyncSocket(
+        internal_address_.family(), SOCK_DGRAM);
+    if (!socket)
+      return false;
+    if (reuse_port && socket->SetOption(rtc::Socket::OPT_REUSEPORT, 1) != 0) {
+      RTC_LOG(LS_ERROR) << "Failed to share the TURN server port, error="
+                        << socket->GetError();
+      delete socket;
+      return false;
+    }
+    // Takes ownership of |socket|, also on failure.
+    rtc::AsyncUDPSocket* udp_socket =
+        rtc::AsyncUDPSocket::Create(socket, internal_address_);
+    if (!udp_socket)
+      return false;
+    // Later shards bind the port that the first one got.
+    internal_address_ = udp_socket->GetLocalAddress();
+
+    shard.server = absl::make_unique<TurnServer>(thread);
+    shard.server->set_realm(config.realm);
+    shard.server->set_software(config.software);
+    shard.server->set_auth_hook(config.auth_hook);
+    shard.server->AddInternalSocket(udp_socket, PROTO_UDP);
+    shard.server->SetExternalSocketFactory(
+        new rtc::BasicPacketSocketFactory(thread), config.external_address);
+    return true;
+  });
+  if (!bound)
+    return false;
+  shards_.push_back(std::move(shard));
+  return true;
+}
+
+}  // namespace cricket
@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_SHARDEDTURNSERVER_H_
+#define P2P_BASE_SHARDEDTURNSERVER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "p2p/base/turnserver.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+// Runs one TurnServer per network thread, all listening on the same UDP
+// address. The internal sockets are bound with SO_REUSEPORT, so the kernel
+// spreads clients over the shards by hashing their 5-tuple, and all packets of
+// a client reach the shard that holds its allocation. The shards share no
+// state, so relaying scales with the number of threads.
+//
+// Only UDP clients are supported, and OPT_REUSEPORT must be available if more
+// than one shard is asked for.
+class ShardedTurnServer {
+ public:
+  struct Config {
+    Config();
+    Config(const Config&);
+    ~Config();
+
+    int num_shards = 1;
+    // Address the shards listen on. If the port is 0, one is picked when the
+    // first shard binds.
+    rtc::SocketAddress internal_address;
+    // Address that the relay sockets of the allocations are bound to.
+    rtc::SocketAddress external_address;
+    std::string realm;
+    std::string software;
+    // Called on the shard threads, possibly concurrently. Not owned.
+    TurnAuthInterface* auth_hook = nullptr;
+  };
+
+  // Returns null if a shard can not bind the internal address.
+  static std::unique_ptr<ShardedTurnServer> Create(const Config& config);
+  ~ShardedTurnServer();
+
+  // The address the shards listen on, with the port actually bound.
+  const rtc::SocketAddress& internal_address() const {
+    return internal_address_;
+  }
+  int num_shards() const { return static_cast<int>(shards_.size()); }
+
+  // Number of allocations over all shards. Blocks on each shard thread.
+  size_t GetAllocationCount() const;
+
+ private:
+  struct Shard {
+    Shard();
+    Shard(Shard&&);
+    ~Shard();
+
+    std::unique_ptr<rtc::Thread> thread;
+    // Created and destroyed on |thread|.
+    std::unique_ptr<TurnServer> server;
+  };
+
+  ShardedTurnServer();
+
+  // Starts a shard listening on |internal_address_|. Returns false if its
+  // socket can't be bound.
+  bool AddShard(const Config& config, bool reuse_port);
+
+  std::vector<Shard> shards_;
+  rtc::SocketAddress internal_address_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(ShardedTurnServer);
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_SHARDEDTURNSERVER_H_
@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/shardedturnserver.h"
+
+#include <memory>
+#include <vector>
+
+#include "p2p/base/stun.h"
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/physicalsocketserver.h"
+
+namespace cricket {
+namespace {
+
+const int kTimeoutMs = 5000;
+
+class BindingClient : public sigslot::has_slots<> {
+ public:
+  explicit BindingClient(rtc::SocketFactory* factory)
+      : socket_(rtc::AsyncUDPSocket::Create(
+            factory,
+            rtc::SocketAddress("127.0.0.1", 0))) {
+    socket_->SignalReadPacket.connect(this, &BindingClient::OnReadPacket);
+  }
+
+  void SendBindingRequest(const rtc::SocketAddress& server) {
+    StunMessage request;
+    request.SetType(STUN_BINDING_REQUEST);
+    request.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+    rtc::ByteBufferWriter buf;
+    request.Write(&buf);
+    socket_->SendTo(buf.Data(), buf.Length(), server, rtc::PacketOptions());
+  }
+
+  bool got_response() const { return got_response_; }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& addr,
+                    const rtc::PacketTime& packet_time) {
+    StunMessage response;
+    rtc::ByteBufferReader buf(data, size);
+    if (response.Read(&buf) && response.type() == STUN_BINDING_RESPONSE)
+      got_response_ = true;
+  }
+
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  bool got_response_ = false;
+};
+
+}  // namespace
+
+TEST(ShardedTurnServerTest, ShardsShareThePort) {
+  rtc::PhysicalSocketServer socket_server;
+  rtc::AutoSocketServerThread thread(&socket_server);
+  ShardedTurnServer::Config config;
+  config.num_shards = 4;
+  config.internal_address = rtc::SocketAddress("127.0.0.1", 0);
+  config.external_address = rtc::SocketAddress("127.0.0.1", 0);
+  std::unique_ptr<ShardedTurnServer> server = ShardedTurnServer::Create(config);
+  if (!server) {
+    RTC_LOG(LS_WARNING) << "SO_REUSEPORT not supported, skipping.";
+    return;
+  }
+  EXPECT_EQ(4, server->num_shards());
+  EXPECT_NE(0, server->internal_address().port());
+
+  // Whichever shard the kernel hands each client to answers it.
+  std::vector<std::unique_ptr<BindingClient>> clients;
+  for (int i = 0; i < 16; ++i) {
+    clients.emplace_back(new BindingClient(&socket_server));
+    clients.back()->SendBindingRequest(server->internal_address());
+  }
+  for (const auto& client : clients)
+    EXPECT_TRUE_WAIT(client->got_response(), kTimeoutMs);
+  EXPECT_EQ(0u, server->GetAllocationCount());
+}
+
+}  // namespace cricket
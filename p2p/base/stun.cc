@@ -45,6 +45,99 @@ const char TURN_MAGIC_COOKIE_VALUE[] = {'\x72', '\xC6', '\x4B', '\xC6'};
 const char EMPTY_TRANSACTION_ID[] = "0000000000000000";
 const uint32_t STUN_FINGERPRINT_XOR_VALUE = 0x5354554E;
 
+namespace {
+
+// Finds the MESSAGE-INTEGRITY attribute of a serialized STUN message, after
+// checking that the message length matches |size|.
+bool FindMessageIntegrity(const char* data, size_t size, size_t* offset) {
+  // Verifying the size of the message.
+  if ((size % 4) != 0 || size < kStunHeaderSize) {
+    return false;
+  }
+
+  // Getting the message length from the STUN header.
+  uint16_t msg_length = rtc::GetBE16(&data[2]);
+  if (size != (msg_length + kStunHeaderSize)) {
+    return false;
+  }
+
+  // Finding Message Integrity attribute in stun message.
+  size_t current_pos = kStunHeaderSize;
+  while (current_pos + 4 <= size) {
+    uint16_t attr_type, attr_length;
+    // Getting attribute type and length.
+    attr_type = rtc::GetBE16(&data[current_pos]);
+    attr_length = rtc::GetBE16(&data[current_pos + sizeof(attr_type)]);
+
+    // If M-I, sanity check it, and break out.
+    if (attr_type == STUN_ATTR_MESSAGE_INTEGRITY) {
+      if (attr_length != kStunMessageIntegritySize ||
+          current_pos + sizeof(attr_type) + sizeof(attr_length) + attr_length >
+              size) {
+        return false;
+      }
+      *offset = current_pos;
+      return true;
+    }
+
+    // Otherwise, skip to the next attribute.
+    current_pos += sizeof(attr_type) + sizeof(attr_length) + attr_length;
+    if ((attr_length % 4) != 0) {
+      current_pos += (4 - (attr_length % 4));
+    }
+  }
+  return false;
+}
+
+// Compares the MESSAGE-INTEGRITY attribute at |offset| in |data| with the HMAC
+// of the message before it.
+bool CheckMessageIntegrity(const char* data,
+                           size_t offset,
+                           StunMessageIntegrityKey* key) {
+  // Attributes after MESSAGE-INTEGRITY aren't covered, so the HMAC is computed
+  // with a message length that ends right after the attribute.
+  size_t adjusted_length = offset + kStunAttributeHeaderSize +
+                           kStunMessageIntegritySize - kStunHeaderSize;
+  char hmac[kStunMessageIntegritySize];
+  if (!key->Compute(data, offset, static_cast<uint16_t>(adjusted_length),
+                    hmac)) {
+    return false;
+  }
+
+  // Comparing the calculated HMAC with the one present in the message.
+  return memcmp(data + offset + kStunAttributeHeaderSize, hmac,
+                sizeof(hmac)) == 0;
+}
+
+}  // namespace
+
+// StunMessageIntegrityKey
+
+StunMessageIntegrityKey::StunMessageIntegrityKey(const std::string& key)
+    : key_(key),
+      hmac_(rtc::MessageDigestFactory::CreateHmac(rtc::DIGEST_SHA_1,
+                                                  key.data(), key.size())) {}
+
+StunMessageIntegrityKey::~StunMessageIntegrityKey() = default;
+
+bool StunMessageIntegrityKey::Compute(const char* data,
+                                      size_t size,
+                                      uint16_t length,
+                                      char* hmac) {
+  RTC_DCHECK_GE(size, kStunHeaderSize);
+  if (!hmac_)
+    return false;
+  // Hash the header with |length| patched in, without copying the message.
+  char type_and_length[4];
+  memcpy(type_and_length, data, 2);
+  rtc::SetBE16(type_and_length + 2, length);
+  hmac_->Update(type_and_length, sizeof(type_and_length));
+  hmac_->Update(data + sizeof(type_and_length), size - sizeof(type_and_length));
+  size_t ret = hmac_->Finish(hmac, kStunMessageIntegritySize);
+  RTC_DCHECK(ret == kStunMessageIntegritySize);
+  return ret == kStunMessageIntegritySize;
+}
+
 // StunMessage
 
 StunMessage::StunMessage()
@@ -164,79 +257,20 @@ const StunUInt16ListAttribute* StunMessage::GetUnknownAttributes() const {
 bool StunMessage::ValidateMessageIntegrity(const char* data,
                                            size_t size,
                                            const std::string& password) {
-  // Verifying the size of the message.
-  if ((size % 4) != 0 || size < kStunHeaderSize) {
-    return false;
-  }
-
-  // Getting the message length from the STUN header.
-  uint16_t msg_length = rtc::GetBE16(&data[2]);
-  if (size != (msg_length + kStunHeaderSize)) {
+  size_t offset;
+  if (!FindMessageIntegrity(data, size, &offset)) {
     return false;
   }
+  StunMessageIntegrityKey key(password);
+  return CheckMessageIntegrity(data, offset, &key);
+}
 
-  // Finding Message Integrity attribute in stun message.
-  size_t current_pos = kStunHeaderSize;
-  bool has_message_integrity_attr = false;
-  while (current_pos + 4 <= size) {
-    uint16_t attr_type, attr_length;
-    // Getting attribute type and length.
-    attr_type = rtc::GetBE16(&data[current_pos]);
-    attr_length = rtc::GetBE16(&data[current_pos + sizeof(attr_type)]);
-
-    // If M-I, sanity check it, and break out.
-    if (attr_type == STUN_ATTR_MESSAGE_INTEGRITY) {
-      if (attr_length != kStunMessageIntegritySize ||
-          current_pos + sizeof(attr_type) + sizeof(attr_length) + attr_length >
-              size) {
-        return false;
-      }
-      has_message_integrity_attr = true;
-      break;
-    }
-
-    // Otherwise, skip to the next attribute.
-    current_pos += sizeof(attr_type) + sizeof(attr_length) + attr_length;
-    if ((attr_length % 4) != 0) {
-      current_pos += (4 - (attr_length % 4));
-    }
-  }
-
-  if (!has_message_integrity_attr) {
-    return false;
-  }
-
-  // Getting length of the message to calculate Message Integrity.
-  size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
-  if (size > mi_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize) {
-    // Stun message has other attributes after message integrity.
-    // Adjust the length parameter in stun message to calculate HMAC.
-    size_t extra_offset =
-        size - (mi_pos + kStunAttributeHeaderSize + kStunMessageIntegritySize);
-    size_t new_adjusted_len = size - extra_offset - kStunHeaderSize;
-
-    // Writing new length of the STUN message @ Message Length in temp buffer.
-    //      0                   1                   2                   3
-    //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //     |0 0|     STUN Message Type     |         Message Length        |
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
-  }
-
-  char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, password.c_str(), password.size(),
-                       temp_data.get(), mi_pos, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac))
-    return false;
-
-  // Comparing the calculated HMAC with the one present in the message.
-  return memcmp(data + current_pos + kStunAttributeHeaderSize, hmac,
-                sizeof(hmac)) == 0;
+bool StunMessage::ValidateMessageIntegrity(const char* data,
+                                           size_t size,
+                                           StunMessageIntegrityKey* key) {
+  size_t offset;
+  return FindMessageIntegrity(data, size, &offset) &&
+         CheckMessageIntegrity(data, offset, key);
 }
 
 bool StunMessage::AddMessageIntegrity(const std::string& password) {
@@ -244,6 +278,11 @@ bool StunMessage::AddMessageIntegrity(const std::string& password) {
 }
 
 bool StunMessage::AddMessageIntegrity(const char* key, size_t keylen) {
+  StunMessageIntegrityKey integrity_key(std::string(key, keylen));
+  return AddMessageIntegrity(&integrity_key);
+}
+
+bool StunMessage::AddMessageIntegrity(StunMessageIntegrityKey* key) {
   // Add the attribute with a dummy value. Since this is a known attribute, it
   // can't fail.
   auto msg_integrity_attr_ptr = absl::make_unique<StunByteStringAttribute>(
@@ -256,13 +295,10 @@ bool StunMessage::AddMessageIntegrity(const char* key, size_t keylen) {
   if (!Write(&buf))
     return false;
 
-  int msg_len_for_hmac = static_cast<int>(
-      buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length());
+  size_t msg_len_for_hmac =
+      buf.Length() - kStunAttributeHeaderSize - msg_integrity_attr->length();
   char hmac[kStunMessageIntegritySize];
-  size_t ret = rtc::ComputeHmac(rtc::DIGEST_SHA_1, key, keylen, buf.Data(),
-                                msg_len_for_hmac, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
+  if (!key->Compute(buf.Data(), msg_len_for_hmac, length_, hmac)) {
     RTC_LOG(LS_ERROR) << "HMAC computation failed. Message-Integrity "
                          "has dummy value.";
     return false;
@@ -476,6 +512,120 @@ bool StunMessage::IsValidTransactionId(const std::string& transaction_id) {
          transaction_id.size() == kStunLegacyTransactionIdLength;
 }
 
+// StunMessageView
+
+bool StunMessageView::Parse(const char* data, size_t size) {
+  data_ = nullptr;
+  size_ = 0;
+  integrity_offset_ = 0;
+  fingerprint_offset_ = 0;
+
+  // The two most significant bits of a STUN message are 0, and attributes are
+  // padded to 4 bytes.
+  if (size < kStunHeaderSize || size % 4 != 0 || (data[0] & 0xC0) != 0)
+    return false;
+  if (rtc::GetBE16(data + 2) != size - kStunHeaderSize)
+    return false;
+  if (rtc::GetBE32(data + 4) != kStunMagicCookie)
+    return false;
+
+  size_t integrity_offset = 0;
+  size_t fingerprint_offset = 0;
+  size_t pos = kStunHeaderSize;
+  while (pos < size) {
+    if (fingerprint_offset)
+      return false;  // FINGERPRINT must be the last attribute.
+    if (pos + kStunAttributeHeaderSize > size)
+      return false;
+    uint16_t attr_type = rtc::GetBE16(data + pos);
+    uint16_t attr_length = rtc::GetBE16(data + pos + 2);
+    size_t padded_length = (attr_length + 3) & ~static_cast<size_t>(3);
+    if (pos + kStunAttributeHeaderSize + padded_length > size)
+      return false;
+    if (attr_type == STUN_ATTR_MESSAGE_INTEGRITY && !integrity_offset) {
+      if (attr_length != kStunMessageIntegritySize)
+        return false;
+      integrity_offset = pos;
+    } else if (attr_type == STUN_ATTR_FINGERPRINT) {
+      if (attr_length != StunUInt32Attribute::SIZE)
+        return false;
+      fingerprint_offset = pos;
+    }
+    pos += kStunAttributeHeaderSize + padded_length;
+  }
+
+  data_ = data;
+  size_ = size;
+  integrity_offset_ = integrity_offset;
+  fingerprint_offset_ = fingerprint_offset;
+  return true;
+}
+
+int StunMessageView::type() const {
+  RTC_DCHECK(data_);
+  return rtc::GetBE16(data_);
+}
+
+absl::string_view StunMessageView::transaction_id() const {
+  RTC_DCHECK(data_);
+  return absl::string_view(data_ + kStunTransactionIdOffset,
+                           kStunTransactionIdLength);
+}
+
+bool StunMessageView::GetAttribute(int type, absl::string_view* value) const {
+  RTC_DCHECK(data_);
+  const size_t end = integrity_offset_ ? integrity_offset_ : size_;
+  size_t pos = kStunHeaderSize;
+  // Parse() checked that the attributes fit.
+  while (pos < end) {
+    uint16_t attr_type = rtc::GetBE16(data_ + pos);
+    uint16_t attr_length = rtc::GetBE16(data_ + pos + 2);
+    if (attr_type == type) {
+      *value = absl::string_view(data_ + pos + kStunAttributeHeaderSize,
+                                 attr_length);
+      return true;
+    }
+    pos += kStunAttributeHeaderSize + ((attr_length + 3) & ~3);
+  }
+  return false;
+}
+
+bool StunMessageView::HasAttribute(int type) const {
+  absl::string_view value;
+  return GetAttribute(type, &value);
+}
+
+absl::optional<uint32_t> StunMessageView::GetUInt32(int type) const {
+  absl::string_view value;
+  if (!GetAttribute(type, &value) || value.size() != StunUInt32Attribute::SIZE)
+    return absl::nullopt;
+  return rtc::GetBE32(value.data());
+}
+
+absl::optional<uint64_t> StunMessageView::GetUInt64(int type) const {
+  absl::string_view value;
+  if (!GetAttribute(type, &value) || value.size() != StunUInt64Attribute::SIZE)
+    return absl::nullopt;
+  return rtc::GetBE64(value.data());
+}
+
+bool StunMessageView::ValidateMessageIntegrity(
+    StunMessageIntegrityKey* key) const {
+  RTC_DCHECK(data_);
+  return integrity_offset_ &&
+         CheckMessageIntegrity(data_, integrity_offset_, key);
+}
+
+bool StunMessageView::ValidateFingerprint() const {
+  RTC_DCHECK(data_);
+  if (!fingerprint_offset_)
+    return false;
+  uint32_t fingerprint = rtc::GetBE32(data_ + fingerprint_offset_ +
+                                      kStunAttributeHeaderSize);
+  return (fingerprint ^ STUN_FINGERPRINT_XOR_VALUE) ==
+         rtc::ComputeCrc32(data_, fingerprint_offset_);
+}
+
 // StunAttribute
 
 StunAttribute::StunAttribute(uint16_t type, uint16_t length)
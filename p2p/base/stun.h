@@ -18,9 +18,15 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "rtc_base/bytebuffer.h"
 #include "rtc_base/socketaddress.h"
 
+namespace rtc {
+class MessageDigest;
+}
+
 namespace cricket {
 
 // These are the types of STUN messages defined in RFC 5389.
@@ -125,6 +131,28 @@ class StunByteStringAttribute;
 class StunErrorCodeAttribute;
 class StunUInt16ListAttribute;
 
+// The key of MESSAGE-INTEGRITY attributes, e.g. an ICE password. The HMAC key
+// setup is done once, so keeping the key for all the messages of an ICE
+// session makes each check cost only the hashing of the message itself.
+// Not thread safe.
+class StunMessageIntegrityKey {
+ public:
+  explicit StunMessageIntegrityKey(const std::string& key);
+  ~StunMessageIntegrityKey();
+
+  const std::string& key() const { return key_; }
+
+  // Computes the MESSAGE-INTEGRITY value of the first |size| bytes of |data|,
+  // which is a STUN message up to its MESSAGE-INTEGRITY attribute, as if its
+  // header had |length| as the message length. |hmac| must have room for
+  // kStunMessageIntegritySize bytes.
+  bool Compute(const char* data, size_t size, uint16_t length, char* hmac);
+
+ private:
+  const std::string key_;
+  std::unique_ptr<rtc::MessageDigest> hmac_;
+};
+
 // Records a complete STUN/TURN message.  Each message consists of a type and
 // any number of attributes.  Each attribute is parsed into an instance of an
 // appropriate class (see above).  The Get* methods will return instances of
@@ -173,9 +201,13 @@ class StunMessage {
   static bool ValidateMessageIntegrity(const char* data,
                                        size_t size,
                                        const std::string& password);
+  static bool ValidateMessageIntegrity(const char* data,
+                                       size_t size,
+                                       StunMessageIntegrityKey* key);
   // Adds a MESSAGE-INTEGRITY attribute that is valid for the current message.
   bool AddMessageIntegrity(const std::string& password);
   bool AddMessageIntegrity(const char* key, size_t keylen);
+  bool AddMessageIntegrity(StunMessageIntegrityKey* key);
 
   // Verifies that a given buffer is STUN by checking for a correct FINGERPRINT.
   static bool ValidateFingerprint(const char* data, size_t size);
@@ -214,6 +246,40 @@ class StunMessage {
   uint32_t stun_magic_cookie_;
 };
 
+// A read-only view of a serialized RFC 5389 STUN message, for the hot path of
+// connectivity checks. Parse() only validates the framing, and attributes are
+// found in place when asked for, so nothing is allocated or copied. Use
+// StunMessage to build messages, or to read attributes that need decoding.
+// The view points into the parsed buffer, which must outlive it.
+class StunMessageView {
+ public:
+  // Returns false unless |data| holds exactly one STUN message with the
+  // RFC 5389 magic cookie, whose attributes add up to its length.
+  bool Parse(const char* data, size_t size);
+
+  int type() const;
+  absl::string_view transaction_id() const;
+
+  // Finds the first attribute of |type| before MESSAGE-INTEGRITY; those after
+  // it are ignored, as RFC 5389, section 15.4 requires.
+  bool GetAttribute(int type, absl::string_view* value) const;
+  bool HasAttribute(int type) const;
+  absl::optional<uint32_t> GetUInt32(int type) const;
+  absl::optional<uint64_t> GetUInt64(int type) const;
+
+  bool has_message_integrity() const { return integrity_offset_ != 0; }
+  bool has_fingerprint() const { return fingerprint_offset_ != 0; }
+  bool ValidateMessageIntegrity(StunMessageIntegrityKey* key) const;
+  bool ValidateFingerprint() const;
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  // Offsets of the MESSAGE-INTEGRITY and FINGERPRINT attributes, or 0.
+  size_t integrity_offset_ = 0;
+  size_t fingerprint_offset_ = 0;
+};
+
 // Base class for all STUN/TURN attributes.
 class StunAttribute {
  public:
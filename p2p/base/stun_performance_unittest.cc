@@ -0,0 +1,133 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/p2pconstants.h"
+#include "p2p/base/stun.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/timeutils.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const int kNumSessions = 1000;
+const int kMessagesPerSession = 100;
+
+// A connectivity check of one ICE session, as a controlled agent receives it.
+struct Session {
+  std::string password;
+  rtc::Buffer request;
+  std::unique_ptr<StunMessageIntegrityKey> key;
+};
+
+std::vector<Session> CreateSessions() {
+  std::vector<Session> sessions(kNumSessions);
+  for (Session& session : sessions) {
+    session.password = rtc::CreateRandomString(ICE_PWD_LENGTH);
+    IceMessage request;
+    request.SetType(STUN_BINDING_REQUEST);
+    request.SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    request.AddAttribute(absl::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, rtc::CreateRandomString(ICE_UFRAG_LENGTH) + ":" +
+                                rtc::CreateRandomString(ICE_UFRAG_LENGTH)));
+    request.AddAttribute(absl::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_PRIORITY, rtc::CreateRandomId()));
+    request.AddAttribute(absl::make_unique<StunUInt64Attribute>(
+        STUN_ATTR_ICE_CONTROLLING, rtc::CreateRandomId64()));
+    request.AddAttribute(
+        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+    request.AddMessageIntegrity(session.password);
+    request.AddFingerprint();
+    rtc::ByteBufferWriter buf;
+    request.Write(&buf);
+    session.request.SetData(buf.Data(), buf.Length());
+    session.key = absl::make_unique<StunMessageIntegrityKey>(session.password);
+  }
+  return sessions;
+}
+
+// Validates the request and reads USERNAME, PRIORITY and USE-CANDIDATE by
+// materializing the message, as Port used to.
+bool HandleWithStunMessage(const Session& session) {
+  const char* data = session.request.data<char>();
+  size_t size = session.request.size();
+  if (!StunMessage::ValidateFingerprint(data, size))
+    return false;
+  IceMessage msg;
+  rtc::ByteBufferReader buf(data, size);
+  if (!msg.Read(&buf))
+    return false;
+  const StunByteStringAttribute* username =
+      msg.GetByteString(STUN_ATTR_USERNAME);
+  const StunUInt32Attribute* priority = msg.GetUInt32(STUN_ATTR_PRIORITY);
+  return username && priority && msg.GetByteString(STUN_ATTR_USE_CANDIDATE) &&
+         StunMessage::ValidateMessageIntegrity(data, size, session.password);
+}
+
+// Does the same in place, with the key of the session.
+bool HandleWithStunMessageView(const Session& session) {
+  StunMessageView view;
+  if (!view.Parse(session.request.data<char>(), session.request.size()) ||
+      !view.ValidateFingerprint()) {
+    return false;
+  }
+  absl::string_view username;
+  return view.GetAttribute(STUN_ATTR_USERNAME, &username) &&
+         view.GetUInt32(STUN_ATTR_PRIORITY) &&
+         view.HasAttribute(STUN_ATTR_USE_CANDIDATE) &&
+         view.ValidateMessageIntegrity(session.key.get());
+}
+
+// Returns the connectivity checks handled per second, going round the sessions
+// as interleaved traffic would.
+template <typename Handler>
+double MeasureMessagesPerSecond(const std::vector<Session>& sessions,
+                                Handler handler) {
+  int handled = 0;
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kMessagesPerSession; ++i) {
+    for (const Session& session : sessions) {
+      if (handler(session))
+        ++handled;
+    }
+  }
+  const int64_t elapsed_us =
+      std::max<int64_t>(rtc::TimeMicros() - start_us, 1);
+  EXPECT_EQ(kNumSessions * kMessagesPerSession, handled);
+  return 1e6 * handled / elapsed_us;
+}
+
+}  // namespace
+
+// Bulk handling of connectivity checks over many ICE sessions, each with its
+// own password.
+TEST(StunPerformanceTest, ConnectivityChecksPerSecond) {
+  const std::vector<Session> sessions = CreateSessions();
+  webrtc::test::PrintResult(
+      "stun_connectivity_checks", "", "stun_message",
+      MeasureMessagesPerSecond(sessions, HandleWithStunMessage), "messages/s",
+      true);
+  webrtc::test::PrintResult(
+      "stun_connectivity_checks", "", "stun_message_view",
+      MeasureMessagesPerSecond(sessions, HandleWithStunMessageView),
+      "messages/s", true);
+}
+
+}  // namespace cricket
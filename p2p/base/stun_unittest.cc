@@ -1320,6 +1320,144 @@ TEST_F(StunTest, AddFingerprint) {
       reinterpret_cast<const char*>(buf1.Data()), buf1.Length()));
 }
 
+// A key is set up once and can check any number of messages.
+TEST_F(StunTest, ValidateMessageIntegrityWithKey) {
+  StunMessageIntegrityKey key(kRfc5769SampleMsgPassword);
+  StunMessageIntegrityKey wrong_key("InvalidPassword");
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(StunMessage::ValidateMessageIntegrity(
+        reinterpret_cast<const char*>(kRfc5769SampleRequest),
+        sizeof(kRfc5769SampleRequest), &key));
+    EXPECT_TRUE(StunMessage::ValidateMessageIntegrity(
+        reinterpret_cast<const char*>(kRfc5769SampleResponse),
+        sizeof(kRfc5769SampleResponse), &key));
+    EXPECT_FALSE(StunMessage::ValidateMessageIntegrity(
+        reinterpret_cast<const char*>(kRfc5769SampleRequest),
+        sizeof(kRfc5769SampleRequest), &wrong_key));
+  }
+  EXPECT_FALSE(StunMessage::ValidateMessageIntegrity(
+      reinterpret_cast<const char*>(kRfc5769SampleRequestWithoutMI),
+      sizeof(kRfc5769SampleRequestWithoutMI), &key));
+
+  IceMessage msg;
+  rtc::ByteBufferReader buf(
+      reinterpret_cast<const char*>(kRfc5769SampleRequestWithoutMI),
+      sizeof(kRfc5769SampleRequestWithoutMI));
+  EXPECT_TRUE(msg.Read(&buf));
+  EXPECT_TRUE(msg.AddMessageIntegrity(&key));
+  const StunByteStringAttribute* mi_attr =
+      msg.GetByteString(STUN_ATTR_MESSAGE_INTEGRITY);
+  EXPECT_EQ(
+      0, memcmp(mi_attr->bytes(), kCalculatedHmac1, sizeof(kCalculatedHmac1)));
+}
+
+TEST_F(StunTest, ParseMessageView) {
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                         sizeof(kRfc5769SampleRequest)));
+  EXPECT_EQ(STUN_BINDING_REQUEST, view.type());
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(
+                            kRfc5769SampleMsgTransactionId),
+                        kStunTransactionIdLength),
+            std::string(view.transaction_id()));
+
+  absl::string_view username;
+  ASSERT_TRUE(view.GetAttribute(STUN_ATTR_USERNAME, &username));
+  EXPECT_EQ(kRfc5769SampleMsgUsername, std::string(username));
+  EXPECT_EQ(0x6e0001ffu, view.GetUInt32(STUN_ATTR_PRIORITY));
+  EXPECT_EQ(0x932ff9b151263b36u, view.GetUInt64(STUN_ATTR_ICE_CONTROLLED));
+  EXPECT_FALSE(view.HasAttribute(STUN_ATTR_USE_CANDIDATE));
+  EXPECT_FALSE(view.GetUInt32(STUN_ATTR_ICE_CONTROLLING));
+  // The length is checked.
+  EXPECT_FALSE(view.GetUInt64(STUN_ATTR_PRIORITY));
+
+  EXPECT_TRUE(view.has_message_integrity());
+  EXPECT_TRUE(view.has_fingerprint());
+  EXPECT_TRUE(view.ValidateFingerprint());
+  StunMessageIntegrityKey key(kRfc5769SampleMsgPassword);
+  EXPECT_TRUE(view.ValidateMessageIntegrity(&key));
+  StunMessageIntegrityKey wrong_key("InvalidPassword");
+  EXPECT_FALSE(view.ValidateMessageIntegrity(&wrong_key));
+
+  ASSERT_TRUE(
+      view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequestWithoutMI),
+                 sizeof(kRfc5769SampleRequestWithoutMI)));
+  EXPECT_FALSE(view.has_message_integrity());
+  EXPECT_FALSE(view.has_fingerprint());
+  EXPECT_FALSE(view.ValidateMessageIntegrity(&key));
+  EXPECT_FALSE(view.ValidateFingerprint());
+}
+
+TEST_F(StunTest, MessageViewChecksEveryBit) {
+  StunMessageIntegrityKey key(kRfc5769SampleMsgPassword);
+  char buf[sizeof(kRfc5769SampleRequest)];
+  memcpy(buf, kRfc5769SampleRequest, sizeof(kRfc5769SampleRequest));
+  for (size_t i = 0; i < sizeof(buf); ++i) {
+    buf[i] ^= 0x01;
+    if (i > 0)
+      buf[i - 1] ^= 0x01;
+    StunMessageView view;
+    EXPECT_FALSE(view.Parse(buf, sizeof(buf)) && view.ValidateFingerprint() &&
+                 view.ValidateMessageIntegrity(&key));
+  }
+}
+
+TEST_F(StunTest, MessageViewRejectsMalformedMessages) {
+  StunMessageView view;
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithZeroLength),
+                 sizeof(kStunMessageWithZeroLength)));
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithExcessLength),
+                 sizeof(kStunMessageWithExcessLength)));
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithSmallLength),
+                 sizeof(kStunMessageWithSmallLength)));
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithBadHmacAtEnd),
+                 sizeof(kStunMessageWithBadHmacAtEnd)));
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(kRtcpPacket),
+                          sizeof(kRtcpPacket)));
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                 sizeof(kRfc5769SampleRequest) - 4));
+
+  // FINGERPRINT must be the last attribute.
+  IceMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID("0123456789ab");
+  msg.AddFingerprint();
+  msg.AddAttribute(
+      absl::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 1));
+  rtc::ByteBufferWriter buf;
+  ASSERT_TRUE(msg.Write(&buf));
+  EXPECT_FALSE(view.Parse(buf.Data(), buf.Length()));
+}
+
+// Attributes after MESSAGE-INTEGRITY aren't authenticated, so the view doesn't
+// return them.
+TEST_F(StunTest, MessageViewIgnoresAttributesAfterMessageIntegrity) {
+  IceMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID("0123456789ab");
+  msg.AddAttribute(
+      absl::make_unique<StunByteStringAttribute>(STUN_ATTR_USERNAME, "a:b"));
+  StunMessageIntegrityKey key("password");
+  ASSERT_TRUE(msg.AddMessageIntegrity(&key));
+  msg.AddAttribute(
+      absl::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+  msg.AddFingerprint();
+  rtc::ByteBufferWriter buf;
+  ASSERT_TRUE(msg.Write(&buf));
+
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(buf.Data(), buf.Length()));
+  EXPECT_TRUE(view.HasAttribute(STUN_ATTR_USERNAME));
+  EXPECT_FALSE(view.HasAttribute(STUN_ATTR_USE_CANDIDATE));
+  EXPECT_TRUE(view.ValidateMessageIntegrity(&key));
+  EXPECT_TRUE(view.ValidateFingerprint());
+}
+
 // Sample "GTURN" relay message.
 // clang-format off
 // clang formatting doesn't respect inline comments.
@@ -10,6 +10,8 @@
 
 #include "p2p/base/turnserver.h"
 
+#include <string.h>
+
 #include <tuple>  // for std::tie
 #include <utility>
 
@@ -19,6 +21,7 @@
 #include "p2p/base/stun.h"
 #include "rtc_base/bind.h"
 #include "rtc_base/bytebuffer.h"
+#include "rtc_base/byteorder.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/helpers.h"
 #include "rtc_base/logging.h"
@@ -216,13 +219,29 @@ void TurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
     HandleStunMessage(&conn, data, size);
   } else {
     // This is a channel message; let the allocation handle it.
-    TurnServerAllocation* allocation = FindAllocation(&conn);
+    HandleChannelData(&conn, data, size);
+  }
+}
+
+void TurnServer::HandleChannelData(TurnServerConnection* conn,
+                                   const char* data,
+                                   size_t size) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  // Relayed data is most of the traffic, so it is never parsed as STUN: only
+  // the length in the header is checked. Anything after the announced length
+  // is padding (RFC 5766, section 11.5) and is not relayed.
+  size_t length = rtc::GetBE16(data + 2);
+  if (length <= size - TURN_CHANNEL_HEADER_SIZE) {
+    TurnServerAllocation* allocation = FindAllocation(conn);
     if (allocation) {
-      allocation->HandleChannelData(data, size);
-    }
-    if (stun_message_observer_ != nullptr) {
-      stun_message_observer_->ReceivedChannelData(data, size);
+      allocation->HandleChannelData(data, TURN_CHANNEL_HEADER_SIZE + length);
     }
+  } else {
+    RTC_LOG(LS_WARNING) << "Received truncated channel data, length="
+                        << length << ", size=" << size;
+  }
+  if (stun_message_observer_ != nullptr) {
+    stun_message_observer_->ReceivedChannelData(data, size);
   }
 }
 
@@ -535,6 +554,23 @@ void TurnServer::Send(TurnServerConnection* conn,
   conn->socket()->SendTo(buf.Data(), buf.Length(), conn->src(), options);
 }
 
+void TurnServer::SendChannelData(TurnServerConnection* conn,
+                                 int channel_id,
+                                 const char* data,
+                                 size_t size) {
+  RTC_DCHECK(thread_checker_.CalledOnValidThread());
+  // The buffer only grows, so relaying does not allocate once it has seen the
+  // largest packet.
+  channel_data_buffer_.SetSize(TURN_CHANNEL_HEADER_SIZE + size);
+  uint8_t* buf = channel_data_buffer_.data();
+  rtc::SetBE16(buf, static_cast<uint16_t>(channel_id));
+  rtc::SetBE16(buf + 2, static_cast<uint16_t>(size));
+  memcpy(buf + TURN_CHANNEL_HEADER_SIZE, data, size);
+  rtc::PacketOptions options;
+  conn->socket()->SendTo(buf, channel_data_buffer_.size(), conn->src(),
+                         options);
+}
+
 void TurnServer::OnAllocationDestroyed(TurnServerAllocation* allocation) {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
   // Removing the internal socket if the connection is not udp.
@@ -581,7 +617,10 @@ TurnServerConnection::TurnServerConnection(const rtc::SocketAddress& src,
                                            ProtocolType proto,
                                            rtc::AsyncPacketSocket* socket)
     : src_(src),
-      dst_(socket->GetRemoteAddress()),
+      // UDP server sockets are never connected; skip asking the socket, as
+      // this runs for every packet received.
+      dst_(proto == PROTO_UDP ? rtc::SocketAddress()
+                              : socket->GetRemoteAddress()),
       proto_(proto),
       socket_(socket) {
 }
@@ -594,6 +633,13 @@ bool TurnServerConnection::operator<(const TurnServerConnection& c) const {
   return std::tie(src_, dst_, proto_) < std::tie(c.src_, c.dst_, c.proto_);
 }
 
+size_t TurnServerConnection::Hash() const {
+  size_t hash = src_.Hash();
+  hash = hash * 31 + dst_.Hash();
+  hash = hash * 31 + proto_;
+  return hash;
+}
+
 std::string TurnServerConnection::ToString() const {
   const char* const kProtos[] = {
       "unknown", "udp", "tcp", "ssltcp"
@@ -618,13 +664,12 @@ TurnServerAllocation::TurnServerAllocation(TurnServer* server,
 }
 
 TurnServerAllocation::~TurnServerAllocation() {
-  for (ChannelList::iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    delete *it;
+  for (ChannelIdMap::iterator it = channels_by_id_.begin();
+       it != channels_by_id_.end(); ++it) {
+    delete it->second;
   }
-  for (PermissionList::iterator it = perms_.begin();
-       it != perms_.end(); ++it) {
-    delete *it;
+  for (PermissionMap::iterator it = perms_.begin(); it != perms_.end(); ++it) {
+    delete it->second;
   }
   thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
   RTC_LOG(LS_INFO) << ToString() << ": Allocation destroyed";
@@ -807,7 +852,8 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
     channel1 = new Channel(thread_, channel_id, peer_attr->GetAddress());
     channel1->SignalDestroyed.connect(this,
         &TurnServerAllocation::OnChannelDestroyed);
-    channels_.push_back(channel1);
+    channels_by_id_[channel_id] = channel1;
+    channels_by_peer_[channel1->peer()] = channel1;
   } else {
     channel1->Refresh();
   }
@@ -849,11 +895,7 @@ void TurnServerAllocation::OnExternalPacket(
   Channel* channel = FindChannel(addr);
   if (channel) {
     // There is a channel bound to this address. Send as a channel message.
-    rtc::ByteBufferWriter buf;
-    buf.WriteUInt16(channel->id());
-    buf.WriteUInt16(static_cast<uint16_t>(size));
-    buf.WriteBytes(data, size);
-    server_->Send(&conn_, buf);
+    server_->SendChannelData(&conn_, channel->id(), data, size);
   } else if (!server_->enable_permission_checks_ ||
              HasPermission(addr.ipaddr())) {
     // No channel, but a permission exists. Send as a data indication.
@@ -894,7 +936,7 @@ void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
     perm = new Permission(thread_, addr);
     perm->SignalDestroyed.connect(
         this, &TurnServerAllocation::OnPermissionDestroyed);
-    perms_.push_back(perm);
+    perms_[addr] = perm;
   } else {
     perm->Refresh();
   }
@@ -902,32 +944,20 @@ void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
 
 TurnServerAllocation::Permission* TurnServerAllocation::FindPermission(
     const rtc::IPAddress& addr) const {
-  for (PermissionList::const_iterator it = perms_.begin();
-       it != perms_.end(); ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
-  }
-  return NULL;
+  PermissionMap::const_iterator it = perms_.find(addr);
+  return (it != perms_.end()) ? it->second : NULL;
 }
 
 TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     int channel_id) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->id() == channel_id)
-      return *it;
-  }
-  return NULL;
+  ChannelIdMap::const_iterator it = channels_by_id_.find(channel_id);
+  return (it != channels_by_id_.end()) ? it->second : NULL;
 }
 
 TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     const rtc::SocketAddress& addr) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
-  }
-  return NULL;
+  ChannelAddressMap::const_iterator it = channels_by_peer_.find(addr);
+  return (it != channels_by_peer_.end()) ? it->second : NULL;
 }
 
 void TurnServerAllocation::SendResponse(TurnMessage* msg) {
@@ -958,16 +988,15 @@ void TurnServerAllocation::OnMessage(rtc::Message* msg) {
 }
 
 void TurnServerAllocation::OnPermissionDestroyed(Permission* perm) {
-  PermissionList::iterator it = std::find(perms_.begin(), perms_.end(), perm);
-  RTC_DCHECK(it != perms_.end());
-  perms_.erase(it);
+  size_t erased = perms_.erase(perm->peer());
+  RTC_DCHECK_EQ(1, erased);
 }
 
 void TurnServerAllocation::OnChannelDestroyed(Channel* channel) {
-  ChannelList::iterator it =
-      std::find(channels_.begin(), channels_.end(), channel);
-  RTC_DCHECK(it != channels_.end());
-  channels_.erase(it);
+  size_t erased = channels_by_id_.erase(channel->id());
+  RTC_DCHECK_EQ(1, erased);
+  erased = channels_by_peer_.erase(channel->peer());
+  RTC_DCHECK_EQ(1, erased);
 }
 
 TurnServerAllocation::Permission::Permission(rtc::Thread* thread,
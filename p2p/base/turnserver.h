@@ -11,17 +11,19 @@
 #ifndef P2P_BASE_TURNSERVER_H_
 #define P2P_BASE_TURNSERVER_H_
 
-#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "p2p/base/portinterface.h"
 #include "rtc_base/asyncinvoker.h"
 #include "rtc_base/asyncpacketsocket.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/ipaddress.h"
 #include "rtc_base/messagequeue.h"
 #include "rtc_base/socketaddress.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
@@ -53,6 +55,8 @@ class TurnServerConnection {
   rtc::AsyncPacketSocket* socket() { return socket_; }
   bool operator==(const TurnServerConnection& t) const;
   bool operator<(const TurnServerConnection& t) const;
+  // Hashes the fields compared by operator==.
+  size_t Hash() const;
   std::string ToString() const;
 
  private:
@@ -62,6 +66,12 @@ class TurnServerConnection {
   rtc::AsyncPacketSocket* socket_;
 };
 
+struct TurnServerConnectionHash {
+  size_t operator()(const TurnServerConnection& conn) const {
+    return conn.Hash();
+  }
+};
+
 // Encapsulates a TURN allocation.
 // The object is created when an allocation request is received, and then
 // handles TURN messages (via HandleTurnMessage) and channel data messages
@@ -95,8 +105,21 @@ class TurnServerAllocation : public rtc::MessageHandler,
  private:
   class Channel;
   class Permission;
-  typedef std::list<Permission*> PermissionList;
-  typedef std::list<Channel*> ChannelList;
+  struct IPAddressHash {
+    size_t operator()(const rtc::IPAddress& addr) const {
+      return rtc::HashIP(addr);
+    }
+  };
+  struct SocketAddressHash {
+    size_t operator()(const rtc::SocketAddress& addr) const {
+      return addr.Hash();
+    }
+  };
+  typedef std::unordered_map<rtc::IPAddress, Permission*, IPAddressHash>
+      PermissionMap;
+  typedef std::unordered_map<int, Channel*> ChannelIdMap;
+  typedef std::unordered_map<rtc::SocketAddress, Channel*, SocketAddressHash>
+      ChannelAddressMap;
 
   void HandleAllocateRequest(const TurnMessage* msg);
   void HandleRefreshRequest(const TurnMessage* msg);
@@ -136,8 +159,11 @@ class TurnServerAllocation : public rtc::MessageHandler,
   std::string username_;
   std::string origin_;
   std::string last_nonce_;
-  PermissionList perms_;
-  ChannelList channels_;
+  PermissionMap perms_;
+  // Every channel is in both maps, so that relaying in either direction is a
+  // single lookup.
+  ChannelIdMap channels_by_id_;
+  ChannelAddressMap channels_by_peer_;
 };
 
 // An interface through which the MD5 credential hash can be retrieved.
@@ -170,9 +196,14 @@ class StunMessageObserver {
 // AddInternalServerSocket, and a factory to create external sockets via
 // SetExternalSocketFactory, and it's ready to go.
 // Not yet wired up: TCP support.
+//
+// A TurnServer runs on a single thread. To spread allocations over several
+// threads, see ShardedTurnServer.
 class TurnServer : public sigslot::has_slots<> {
  public:
-  typedef std::map<TurnServerConnection, std::unique_ptr<TurnServerAllocation>>
+  typedef std::unordered_map<TurnServerConnection,
+                             std::unique_ptr<TurnServerAllocation>,
+                             TurnServerConnectionHash>
       AllocationMap;
 
   explicit TurnServer(rtc::Thread* thread);
@@ -259,6 +290,9 @@ class TurnServer : public sigslot::has_slots<> {
   void OnInternalPacket(rtc::AsyncPacketSocket* socket, const char* data,
                         size_t size, const rtc::SocketAddress& address,
                         const rtc::PacketTime& packet_time);
+  void HandleChannelData(TurnServerConnection* conn,
+                         const char* data,
+                         size_t size);
 
   void OnNewInternalConnection(rtc::AsyncSocket* socket);
 
@@ -296,6 +330,10 @@ class TurnServer : public sigslot::has_slots<> {
 
   void SendStun(TurnServerConnection* conn, StunMessage* msg);
   void Send(TurnServerConnection* conn, const rtc::ByteBufferWriter& buf);
+  void SendChannelData(TurnServerConnection* conn,
+                       int channel_id,
+                       const char* data,
+                       size_t size);
 
   void OnAllocationDestroyed(TurnServerAllocation* allocation);
   void DestroyInternalSocket(rtc::AsyncPacketSocket* socket);
@@ -303,8 +341,8 @@ class TurnServer : public sigslot::has_slots<> {
   // Just clears |sockets_to_delete_|; called asynchronously.
   void FreeSockets();
 
-  typedef std::map<rtc::AsyncPacketSocket*,
-                   ProtocolType> InternalSocketMap;
+  typedef std::unordered_map<rtc::AsyncPacketSocket*, ProtocolType>
+      InternalSocketMap;
   typedef std::map<rtc::AsyncSocket*,
                    ProtocolType> ServerSocketMap;
 
@@ -330,6 +368,8 @@ class TurnServer : public sigslot::has_slots<> {
   rtc::SocketAddress external_addr_;
 
   AllocationMap allocations_;
+  // Reused for every ChannelData message relayed to a client.
+  rtc::Buffer channel_data_buffer_;
 
   rtc::AsyncInvoker invoker_;
 
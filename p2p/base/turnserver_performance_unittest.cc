@@ -0,0 +1,235 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/stun.h"
+#include "p2p/base/testturnserver.h"
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/byteorder.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const int kTimeoutMs = 60000;
+const int kChannelId = 0x4000;
+const int kPacketsPerRun = 200000;
+const size_t kPayloadSize = 160;
+const char kUsername[] = "perf";
+
+const rtc::SocketAddress kTurnIntAddr("99.99.99.3", TURN_SERVER_PORT);
+const rtc::SocketAddress kTurnExtAddr("99.99.99.5", 0);
+const rtc::SocketAddress kClientAddr("11.11.11.11", 0);
+const rtc::SocketAddress kPeerAddr("22.22.22.22", 0);
+
+// Counts the packets that made it through the server, in either direction.
+class PacketCounter : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& addr,
+                    const rtc::PacketTime& packet_time) {
+    ++packets_;
+  }
+  int packets() const { return packets_; }
+
+ private:
+  int packets_ = 0;
+};
+
+// A TURN client that allocates, binds a channel to its own peer socket, and
+// then only relays ChannelData.
+class RelayClient : public sigslot::has_slots<> {
+ public:
+  RelayClient(rtc::SocketFactory* factory,
+              const std::string& nonce,
+              PacketCounter* counter)
+      : socket_(rtc::AsyncUDPSocket::Create(factory, kClientAddr)),
+        peer_socket_(rtc::AsyncUDPSocket::Create(factory, kPeerAddr)),
+        nonce_(nonce),
+        counter_(counter) {
+    ComputeStunCredentialHash(kUsername, kTestRealm, kUsername, &key_);
+    socket_->SignalReadPacket.connect(this, &RelayClient::OnReadPacket);
+    peer_socket_->SignalReadPacket.connect(counter_,
+                                           &PacketCounter::OnReadPacket);
+  }
+
+  bool allocated() const { return !relayed_address_.IsNil(); }
+  bool bound() const { return bound_; }
+
+  void Allocate() {
+    TurnMessage request;
+    request.SetType(STUN_ALLOCATE_REQUEST);
+    request.AddAttribute(absl::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_REQUESTED_TRANSPORT, IPPROTO_UDP << 24));
+    SendRequest(&request);
+  }
+
+  void BindChannel() {
+    TurnMessage request;
+    request.SetType(TURN_CHANNEL_BIND_REQUEST);
+    request.AddAttribute(absl::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_CHANNEL_NUMBER, kChannelId << 16));
+    request.AddAttribute(absl::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_PEER_ADDRESS, peer_socket_->GetLocalAddress()));
+    SendRequest(&request);
+  }
+
+  // Sends |channel_data| through the server, which passes its payload on to
+  // the peer.
+  void SendToPeer(const std::vector<char>& channel_data) {
+    socket_->SendTo(channel_data.data(), channel_data.size(), kTurnIntAddr,
+                    rtc::PacketOptions());
+  }
+
+  // Sends |payload| from the peer to the relayed address, which the server
+  // turns into ChannelData for this client.
+  void SendFromPeer(const std::vector<char>& payload) {
+    peer_socket_->SendTo(payload.data(), payload.size(), relayed_address_,
+                         rtc::PacketOptions());
+  }
+
+ private:
+  void SendRequest(TurnMessage* request) {
+    request->SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    request->AddAttribute(
+        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_USERNAME,
+                                                   kUsername));
+    request->AddAttribute(
+        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_REALM,
+                                                   kTestRealm));
+    request->AddAttribute(
+        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_NONCE, nonce_));
+    request->AddMessageIntegrity(key_);
+    rtc::ByteBufferWriter buf;
+    request->Write(&buf);
+    socket_->SendTo(buf.Data(), buf.Length(), kTurnIntAddr,
+                    rtc::PacketOptions());
+  }
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& addr,
+                    const rtc::PacketTime& packet_time) {
+    // The first two bits of a ChannelData message are 0b01.
+    if ((data[0] & 0xC0) == 0x40) {
+      counter_->OnReadPacket(socket, data, size, addr, packet_time);
+      return;
+    }
+    TurnMessage response;
+    rtc::ByteBufferReader buf(data, size);
+    if (!response.Read(&buf))
+      return;
+    if (response.type() == STUN_ALLOCATE_RESPONSE) {
+      relayed_address_ =
+          response.GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS)->GetAddress();
+    } else if (response.type() == TURN_CHANNEL_BIND_RESPONSE) {
+      bound_ = true;
+    }
+  }
+
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::unique_ptr<rtc::AsyncPacketSocket> peer_socket_;
+  const std::string nonce_;
+  PacketCounter* const counter_;
+  std::string key_;
+  rtc::SocketAddress relayed_address_;
+  bool bound_ = false;
+};
+
+// Sets up |num_clients| allocations with a bound channel each, then relays
+// |kPacketsPerRun| packets through them, half from the clients to their peers
+// and half back. Returns the relayed packets per second.
+double MeasureRelayedPacketsPerSecond(int num_clients) {
+  rtc::VirtualSocketServer socket_server;
+  rtc::AutoSocketServerThread thread(&socket_server);
+  TestTurnServer turn_server(&thread, kTurnIntAddr, kTurnExtAddr);
+  const std::string nonce =
+      turn_server.server()->SetTimestampForNextNonce(rtc::TimeMillis());
+
+  PacketCounter counter;
+  std::vector<std::unique_ptr<RelayClient>> clients;
+  for (int i = 0; i < num_clients; ++i) {
+    clients.push_back(
+        absl::make_unique<RelayClient>(&socket_server, nonce, &counter));
+    clients.back()->Allocate();
+  }
+  for (const auto& client : clients)
+    EXPECT_TRUE_WAIT(client->allocated(), kTimeoutMs);
+  for (const auto& client : clients)
+    client->BindChannel();
+  for (const auto& client : clients)
+    EXPECT_TRUE_WAIT(client->bound(), kTimeoutMs);
+  if (::testing::Test::HasFailure())
+    return 0;
+  EXPECT_EQ(static_cast<size_t>(num_clients),
+            turn_server.server()->allocations().size());
+
+  const std::vector<char> payload(kPayloadSize, 'x');
+  std::vector<char> channel_data(4 + kPayloadSize, 'x');
+  rtc::SetBE16(&channel_data[0], kChannelId);
+  rtc::SetBE16(&channel_data[2], kPayloadSize);
+
+  const int rounds = std::max(kPacketsPerRun / (2 * num_clients), 1);
+  const int64_t start_us = rtc::TimeMicros();
+  const int64_t deadline_ms = rtc::TimeMillis() + kTimeoutMs;
+  int expected = 0;
+  for (int round = 0; round < rounds; ++round) {
+    for (const auto& client : clients) {
+      client->SendToPeer(channel_data);
+      client->SendFromPeer(payload);
+    }
+    expected += 2 * num_clients;
+    // Deliver each round before the next, so that the virtual network never
+    // holds more than a round of packets.
+    while (counter.packets() < expected) {
+      if (rtc::TimeMillis() > deadline_ms) {
+        ADD_FAILURE() << "Relayed " << counter.packets() << " of " << expected
+                      << " packets";
+        return 0;
+      }
+      thread.ProcessMessages(0);
+    }
+  }
+  const int64_t elapsed_us =
+      std::max<int64_t>(rtc::TimeMicros() - start_us, 1);
+  return 1e6 * expected / elapsed_us;
+}
+
+}  // namespace
+
+// Relaying throughput of a single TurnServer, with the packets going through
+// VirtualSocketServer so that the server's own work is measured, for a few
+// and for many allocations.
+TEST(TurnServerPerformanceTest, RelayedPacketsPerSecond) {
+  for (int num_clients : {10, 1000}) {
+    rtc::StringBuilder trace;
+    trace << num_clients << "_allocations";
+    webrtc::test::PrintResult("turn_server_relay", "", trace.str(),
+                              MeasureRelayedPacketsPerSecond(num_clients),
+                              "packets/s", true);
+  }
+}
+
+}  // namespace cricket
@@ -9,15 +9,43 @@
  */
 
 #include "p2p/base/turnserver.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
 #include "p2p/base/basicpacketsocketfactory.h"
+#include "p2p/base/stun.h"
+#include "p2p/base/testturnserver.h"
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/byteorder.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/timeutils.h"
 #include "rtc_base/virtualsocketserver.h"
 
 // NOTE: This is a work in progress. Currently this file only has tests for
-// TurnServerConnection, a primitive class used by TurnServer.
+// TurnServerConnection, a primitive class used by TurnServer, and for the
+// relaying of ChannelData.
 
 namespace cricket {
 
+namespace {
+
+const int kTimeoutMs = 1000;
+const int kChannelId = 0x4000;
+const size_t kChannelHeaderSize = 4;
+const char kUsername[] = "test";
+
+const rtc::SocketAddress kTurnIntAddr("99.99.99.3", TURN_SERVER_PORT);
+const rtc::SocketAddress kTurnExtAddr("99.99.99.5", 0);
+const rtc::SocketAddress kClientAddr("11.11.11.11", 0);
+const rtc::SocketAddress kPeerAddr("22.22.22.22", 0);
+
+}  // namespace
+
 class TurnServerConnectionTest : public testing::Test {
  public:
   TurnServerConnectionTest() : thread_(&vss_) {}
@@ -27,6 +55,7 @@ class TurnServerConnectionTest : public testing::Test {
     EXPECT_TRUE(a == b);
     EXPECT_FALSE(a < b);
     EXPECT_FALSE(b < a);
+    EXPECT_EQ(a.Hash(), b.Hash());
   }
 
   void ExpectNotEqual(const TurnServerConnection& a,
@@ -63,4 +92,120 @@ TEST_F(TurnServerConnectionTest, ComparisonOperators) {
   ExpectNotEqual(connection1, connection4);
 }
 
+// Sets up an allocation with a channel bound to a peer socket, and records
+// what the peer receives.
+class TurnServerChannelDataTest : public testing::Test,
+                                  public sigslot::has_slots<> {
+ protected:
+  TurnServerChannelDataTest()
+      : thread_(&vss_),
+        turn_server_(&thread_, kTurnIntAddr, kTurnExtAddr),
+        socket_(rtc::AsyncUDPSocket::Create(&vss_, kClientAddr)),
+        peer_socket_(rtc::AsyncUDPSocket::Create(&vss_, kPeerAddr)) {
+    nonce_ = turn_server_.server()->SetTimestampForNextNonce(rtc::TimeMillis());
+    ComputeStunCredentialHash(kUsername, kTestRealm, kUsername, &key_);
+    socket_->SignalReadPacket.connect(
+        this, &TurnServerChannelDataTest::OnClientReadPacket);
+    peer_socket_->SignalReadPacket.connect(
+        this, &TurnServerChannelDataTest::OnPeerReadPacket);
+  }
+
+  void AllocateAndBindChannel() {
+    TurnMessage allocate;
+    allocate.SetType(STUN_ALLOCATE_REQUEST);
+    allocate.AddAttribute(absl::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_REQUESTED_TRANSPORT, IPPROTO_UDP << 24));
+    SendRequest(&allocate);
+    ASSERT_TRUE_WAIT(allocated_, kTimeoutMs);
+
+    TurnMessage bind;
+    bind.SetType(TURN_CHANNEL_BIND_REQUEST);
+    bind.AddAttribute(absl::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_CHANNEL_NUMBER, kChannelId << 16));
+    bind.AddAttribute(absl::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_PEER_ADDRESS, peer_socket_->GetLocalAddress()));
+    SendRequest(&bind);
+    ASSERT_TRUE_WAIT(bound_, kTimeoutMs);
+  }
+
+  // Sends a ChannelData message that announces |length| bytes of payload and
+  // carries |payload|, which may be shorter or longer than that.
+  void SendChannelData(uint16_t length, const std::string& payload) {
+    std::vector<char> channel_data(kChannelHeaderSize);
+    rtc::SetBE16(&channel_data[0], kChannelId);
+    rtc::SetBE16(&channel_data[2], length);
+    channel_data.insert(channel_data.end(), payload.begin(), payload.end());
+    socket_->SendTo(channel_data.data(), channel_data.size(), kTurnIntAddr,
+                    rtc::PacketOptions());
+  }
+
+  void SendRequest(TurnMessage* request) {
+    request->SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    request->AddAttribute(absl::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, kUsername));
+    request->AddAttribute(absl::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_REALM, kTestRealm));
+    request->AddAttribute(
+        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_NONCE, nonce_));
+    request->AddMessageIntegrity(key_);
+    rtc::ByteBufferWriter buf;
+    request->Write(&buf);
+    socket_->SendTo(buf.Data(), buf.Length(), kTurnIntAddr,
+                    rtc::PacketOptions());
+  }
+
+  void OnClientReadPacket(rtc::AsyncPacketSocket* socket,
+                          const char* data,
+                          size_t size,
+                          const rtc::SocketAddress& addr,
+                          const rtc::PacketTime& packet_time) {
+    TurnMessage response;
+    rtc::ByteBufferReader buf(data, size);
+    if (!response.Read(&buf))
+      return;
+    if (response.type() == STUN_ALLOCATE_RESPONSE) {
+      allocated_ = true;
+    } else if (response.type() == TURN_CHANNEL_BIND_RESPONSE) {
+      bound_ = true;
+    }
+  }
+
+  void OnPeerReadPacket(rtc::AsyncPacketSocket* socket,
+                        const char* data,
+                        size_t size,
+                        const rtc::SocketAddress& addr,
+                        const rtc::PacketTime& packet_time) {
+    peer_received_.push_back(std::string(data, size));
+  }
+
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  TestTurnServer turn_server_;
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::unique_ptr<rtc::AsyncPacketSocket> peer_socket_;
+  std::string nonce_;
+  std::string key_;
+  bool allocated_ = false;
+  bool bound_ = false;
+  std::vector<std::string> peer_received_;
+};
+
+TEST_F(TurnServerChannelDataTest, RelaysChannelDataWithoutPadding) {
+  AllocateAndBindChannel();
+  // Over UDP the payload is not padded, but padding is still tolerated.
+  SendChannelData(5, std::string("hello") + std::string(3, '\0'));
+  ASSERT_EQ_WAIT(1u, peer_received_.size(), kTimeoutMs);
+  EXPECT_EQ("hello", peer_received_[0]);
+}
+
+TEST_F(TurnServerChannelDataTest, DropsTruncatedChannelData) {
+  AllocateAndBindChannel();
+  SendChannelData(10, "hello");
+  // Followed by a valid message, to know that the first one was handled.
+  SendChannelData(5, "world");
+  ASSERT_EQ_WAIT(1u, peer_received_.size(), kTimeoutMs);
+  EXPECT_EQ("world", peer_received_[0]);
+}
+
 }  // namespace cricket
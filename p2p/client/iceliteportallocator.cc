@@ -0,0 +1,362 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/client/iceliteportallocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "p2p/base/stun.h"
+#include "p2p/base/stunport.h"
+#include "rtc_base/byteorder.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace cricket {
+
+namespace {
+
+// Returns the local ufrag of a binding request, which is the part of its
+// USERNAME before the colon (RFC 8445, section 7.2.2).
+bool GetRequestUfrag(const char* data, size_t size, std::string* ufrag) {
+  // Don't bother parsing anything that isn't a binding request.
+  if (size < kStunHeaderSize || rtc::GetBE16(data) != STUN_BINDING_REQUEST)
+    return false;
+  StunMessageView request;
+  absl::string_view username;
+  if (!request.Parse(data, size) ||
+      !request.GetAttribute(STUN_ATTR_USERNAME, &username)) {
+    return false;
+  }
+  size_t colon = username.find(':');
+  if (colon == absl::string_view::npos || colon == 0)
+    return false;
+  ufrag->assign(username.data(), colon);
+  return true;
+}
+
+}  // namespace
+
+// A socket of one port, which sends on the shared socket. The allocator hands
+// it the packets of the port.
+class IceLitePortAllocator::PortSocket : public rtc::AsyncPacketSocket {
+ public:
+  explicit PortSocket(IceLitePortAllocator* allocator)
+      : allocator_(allocator) {}
+
+  rtc::SocketAddress GetLocalAddress() const override {
+    return allocator_->socket_->GetLocalAddress();
+  }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    RTC_NOTREACHED();
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    return allocator_->SendTo(this, pv, cb, addr, options);
+  }
+  // The shared socket stays open.
+  int Close() override { return 0; }
+  State GetState() const override { return allocator_->socket_->GetState(); }
+  // Options apply to the shared socket, so to all sessions.
+  int GetOption(rtc::Socket::Option opt, int* value) override {
+    return allocator_->socket_->GetOption(opt, value);
+  }
+  int SetOption(rtc::Socket::Option opt, int value) override {
+    return allocator_->socket_->SetOption(opt, value);
+  }
+  int GetError() const override { return allocator_->socket_->GetError(); }
+  void SetError(int error) override { allocator_->socket_->SetError(error); }
+
+ private:
+  IceLitePortAllocator* const allocator_;
+};
+
+// Gathers the one host candidate of a session, on a port that the allocator
+// demultiplexes to.
+class IceLitePortAllocatorSession : public PortAllocatorSession {
+ public:
+  IceLitePortAllocatorSession(IceLitePortAllocator* allocator,
+                              const std::string& content_name,
+                              int component,
+                              const std::string& ice_ufrag,
+                              const std::string& ice_pwd)
+      : PortAllocatorSession(content_name,
+                             component,
+                             ice_ufrag,
+                             ice_pwd,
+                             allocator->flags()),
+        allocator_(allocator) {}
+
+  ~IceLitePortAllocatorSession() override {
+    if (port_) {
+      allocator_->RemovePort(port_);
+      // Don't handle our own deletion of the port.
+      port_->SignalDestroyed.disconnect(this);
+      delete port_;
+    }
+  }
+
+  void SetCandidateFilter(uint32_t filter) override {
+    candidate_filter_ = filter;
+  }
+
+  void StartGettingPorts() override {
+    running_ = true;
+    if (port_)
+      return;
+    port_ = allocator_->AddPort(username(), password(), &port_socket_);
+    if (!port_) {
+      allocation_done_ = true;
+      SignalCandidatesAllocationDone(this);
+      return;
+    }
+    port_->set_component(component());
+    port_->set_generation(generation());
+    port_->SignalDestroyed.connect(
+        this, &IceLitePortAllocatorSession::OnPortDestroyed);
+    port_->SignalPortComplete.connect(
+        this, &IceLitePortAllocatorSession::OnPortComplete);
+    SignalPortReady(this, port_);
+    port_->PrepareAddress();
+    port_->KeepAliveUntilPruned();
+  }
+
+  void StopGettingPorts() override { running_ = false; }
+  bool IsGettingPorts() override { return running_; }
+  void ClearGettingPorts() override {
+    running_ = false;
+    cleared_ = true;
+  }
+  bool IsCleared() const override { return cleared_; }
+
+  std::vector<PortInterface*> ReadyPorts() const override {
+    std::vector<PortInterface*> ports;
+    if (port_)
+      ports.push_back(port_);
+    return ports;
+  }
+  std::vector<Candidate> ReadyCandidates() const override {
+    if (!port_ || !(candidate_filter_ & CF_HOST))
+      return std::vector<Candidate>();
+    return port_->Candidates();
+  }
+  bool CandidatesAllocationDone() const override { return allocation_done_; }
+  void PruneAllPorts() override {
+    if (port_)
+      port_->Prune();
+  }
+
+ protected:
+  // A pooled session gets its ICE parameters when it is taken.
+  void UpdateIceParametersInternal() override {
+    if (!port_)
+      return;
+    const std::string old_ufrag = port_->username_fragment();
+    port_->set_content_name(content_name());
+    port_->SetIceParameters(component(), ice_ufrag(), ice_pwd());
+    allocator_->UpdatePortUfrag(port_, old_ufrag);
+  }
+
+ private:
+  void OnPortComplete(Port* port) {
+    if (candidate_filter_ & CF_HOST)
+      SignalCandidatesReady(this, port->Candidates());
+    allocation_done_ = true;
+    SignalCandidatesAllocationDone(this);
+  }
+
+  void OnPortDestroyed(PortInterface* port) {
+    RTC_DCHECK_EQ(port_, port);
+    allocator_->RemovePort(port_);
+    port_ = nullptr;
+    port_socket_.reset();
+  }
+
+  IceLitePortAllocator* const allocator_;
+  // Deletes itself once pruned and without connections.
+  UDPPort* port_ = nullptr;
+  std::unique_ptr<IceLitePortAllocator::PortSocket> port_socket_;
+  uint32_t candidate_filter_ = CF_ALL;
+  bool running_ = false;
+  bool cleared_ = false;
+  bool allocation_done_ = false;
+};
+
+IceLitePortAllocator::IceLitePortAllocator(rtc::Thread* network_thread,
+                                           rtc::Network* network,
+                                           rtc::AsyncPacketSocket* socket)
+    : network_thread_(network_thread), network_(network), socket_(socket) {
+  network_thread_->Invoke<void>(RTC_FROM_HERE, [this] {
+    Initialize();
+    socket_->SignalReadPacket.connect(this,
+                                      &IceLitePortAllocator::OnReadPacket);
+    socket_->SignalSentPacket.connect(this,
+                                      &IceLitePortAllocator::OnSentPacket);
+    socket_->SignalReadyToSend.connect(this,
+                                       &IceLitePortAllocator::OnReadyToSend);
+  });
+}
+
+IceLitePortAllocator::~IceLitePortAllocator() {
+  DiscardCandidatePool();
+  // The other sessions must be gone already, as they remove their ports.
+  RTC_DCHECK(ports_by_ufrag_.empty());
+}
+
+PortAllocatorSession* IceLitePortAllocator::CreateSessionInternal(
+    const std::string& content_name,
+    int component,
+    const std::string& ice_ufrag,
+    const std::string& ice_pwd) {
+  return new IceLitePortAllocatorSession(this, content_name, component,
+                                         ice_ufrag, ice_pwd);
+}
+
+UDPPort* IceLitePortAllocator::AddPort(
+    const std::string& ufrag,
+    const std::string& pwd,
+    std::unique_ptr<PortSocket>* port_socket) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  auto socket = absl::make_unique<PortSocket>(this);
+  UDPPort* port = UDPPort::Create(network_thread_, nullptr, network_,
+                                  socket.get(), ufrag, pwd, std::string(),
+                                  false, absl::nullopt);
+  if (!port)
+    return nullptr;
+  // An empty |ufrag| is replaced by a random one.
+  std::unique_ptr<PortEntry>& entry =
+      ports_by_ufrag_[port->username_fragment()];
+  if (entry) {
+    RTC_LOG(LS_ERROR) << "An ICE session with ufrag "
+                      << port->username_fragment() << " already exists.";
+    delete port;
+    return nullptr;
+  }
+  entry = absl::WrapUnique(new PortEntry{port, socket.get(), {}});
+  *port_socket = std::move(socket);
+  return port;
+}
+
+void IceLitePortAllocator::RemovePort(UDPPort* port) {
+  auto it = ports_by_ufrag_.find(port->username_fragment());
+  RTC_DCHECK(it != ports_by_ufrag_.end());
+  PortEntry* entry = it->second.get();
+  for (const rtc::SocketAddress& addr : entry->remote_addresses) {
+    auto address_it = ports_by_address_.find(addr);
+    if (address_it != ports_by_address_.end() && address_it->second == entry)
+      ports_by_address_.erase(address_it);
+  }
+  ports_by_ufrag_.erase(it);
+}
+
+void IceLitePortAllocator::UpdatePortUfrag(UDPPort* port,
+                                           const std::string& old_ufrag) {
+  auto it = ports_by_ufrag_.find(old_ufrag);
+  RTC_DCHECK(it != ports_by_ufrag_.end());
+  std::unique_ptr<PortEntry> entry = std::move(it->second);
+  ports_by_ufrag_.erase(it);
+  ports_by_ufrag_[port->username_fragment()] = std::move(entry);
+}
+
+int IceLitePortAllocator::SendTo(PortSocket* from,
+                                 const void* data,
+                                 size_t size,
+                                 const rtc::SocketAddress& addr,
+                                 const rtc::PacketOptions& options) {
+  sending_socket_ = from;
+  int sent = socket_->SendTo(data, size, addr, options);
+  sending_socket_ = nullptr;
+  return sent;
+}
+
+void IceLitePortAllocator::MaybeAddRemoteAddress(
+    const std::string& ufrag,
+    const rtc::SocketAddress& remote_addr) {
+  // Handling the request may have destroyed the port.
+  auto it = ports_by_ufrag_.find(ufrag);
+  if (it == ports_by_ufrag_.end())
+    return;
+  PortEntry* entry = it->second.get();
+  // The port only creates a connection for a check whose MESSAGE-INTEGRITY it
+  // validated, so packets can't be diverted by a spoofed check.
+  if (!entry->port->GetConnection(remote_addr))
+    return;
+  PortEntry*& routed_entry = ports_by_address_[remote_addr];
+  if (routed_entry == entry)
+    return;
+  // After an ICE restart, the address moves to the new session.
+  if (routed_entry) {
+    std::vector<rtc::SocketAddress>& addresses =
+        routed_entry->remote_addresses;
+    addresses.erase(
+        std::remove(addresses.begin(), addresses.end(), remote_addr),
+        addresses.end());
+  }
+  routed_entry = entry;
+  entry->remote_addresses.push_back(remote_addr);
+}
+
+void IceLitePortAllocator::OnReadPacket(rtc::AsyncPacketSocket* socket,
+                                        const char* data,
+                                        size_t size,
+                                        const rtc::SocketAddress& remote_addr,
+                                        const rtc::PacketTime& packet_time) {
+  RTC_DCHECK(network_thread_->IsCurrent());
+  // Checks are routed by their ufrag, so that they reach the new session after
+  // an ICE restart, and everything else by the address that a check came from.
+  std::string ufrag;
+  PortEntry* entry = nullptr;
+  if (GetRequestUfrag(data, size, &ufrag)) {
+    auto it = ports_by_ufrag_.find(ufrag);
+    if (it == ports_by_ufrag_.end()) {
+      RTC_LOG(LS_VERBOSE) << "Dropping a check for unknown ufrag " << ufrag
+                          << " from " << remote_addr.ToSensitiveString();
+      return;
+    }
+    entry = it->second.get();
+  } else {
+    auto it = ports_by_address_.find(remote_addr);
+    if (it == ports_by_address_.end()) {
+      RTC_LOG(LS_VERBOSE) << "Dropping a packet from unknown address "
+                          << remote_addr.ToSensitiveString();
+      return;
+    }
+    entry = it->second;
+  }
+  entry->port->HandleIncomingPacket(entry->socket, data, size, remote_addr,
+                                    packet_time);
+  if (!ufrag.empty())
+    MaybeAddRemoteAddress(ufrag, remote_addr);
+}
+
+void IceLitePortAllocator::OnSentPacket(rtc::AsyncPacketSocket* socket,
+                                        const rtc::SentPacket& sent_packet) {
+  if (sending_socket_)
+    sending_socket_->SignalSentPacket(sending_socket_, sent_packet);
+}
+
+void IceLitePortAllocator::OnReadyToSend(rtc::AsyncPacketSocket* socket) {
+  for (const auto& ufrag_and_entry : ports_by_ufrag_) {
+    PortSocket* port_socket = ufrag_and_entry.second->socket;
+    port_socket->SignalReadyToSend(port_socket);
+  }
+}
+
+}  // namespace cricket
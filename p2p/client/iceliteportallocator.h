@@ -0,0 +1,124 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_CLIENT_ICELITEPORTALLOCATOR_H_
+#define P2P_CLIENT_ICELITEPORTALLOCATOR_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "p2p/base/portallocator.h"
+#include "rtc_base/asyncpacketsocket.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/network.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+class UDPPort;
+
+// A PortAllocator for ICE-lite servers, which gives every session a single
+// host candidate on the same UDP socket, so that thousands of
+// P2PTransportChannels need only one port. Packets are demultiplexed first by
+// the remote address of a connection, and for new remote addresses by the
+// ufrag in the USERNAME of their binding request.
+//
+// Meant for P2PTransportChannels with IceConfig::ice_lite set. All methods,
+// and the destruction of the sessions, must be on |network_thread|, and the
+// sessions must be destroyed before the allocator.
+class IceLitePortAllocator : public PortAllocator {
+ public:
+  // |socket| must be a bound UDP socket on an address of |network|. Takes
+  // ownership of |socket|.
+  IceLitePortAllocator(rtc::Thread* network_thread,
+                       rtc::Network* network,
+                       rtc::AsyncPacketSocket* socket);
+  ~IceLitePortAllocator() override;
+
+  void SetNetworkIgnoreMask(int network_ignore_mask) override {}
+
+  rtc::SocketAddress local_address() const {
+    return socket_->GetLocalAddress();
+  }
+  // Number of sessions that have a port on the socket.
+  size_t port_count() const { return ports_by_ufrag_.size(); }
+
+ protected:
+  PortAllocatorSession* CreateSessionInternal(
+      const std::string& content_name,
+      int component,
+      const std::string& ice_ufrag,
+      const std::string& ice_pwd) override;
+
+ private:
+  class PortSocket;
+  friend class IceLitePortAllocatorSession;
+
+  struct PortEntry {
+    UDPPort* port;
+    PortSocket* socket;
+    // Remote addresses routed to |port|, to forget them with it.
+    std::vector<rtc::SocketAddress> remote_addresses;
+  };
+  struct SocketAddressHash {
+    size_t operator()(const rtc::SocketAddress& addr) const {
+      return addr.Hash();
+    }
+  };
+
+  // Creates a port for |ufrag| and |pwd| on the socket. The caller owns both
+  // the port and |*port_socket|, and must call RemovePort() before deleting
+  // them.
+  UDPPort* AddPort(const std::string& ufrag,
+                   const std::string& pwd,
+                   std::unique_ptr<PortSocket>* port_socket);
+  void RemovePort(UDPPort* port);
+  // Moves |port| to the ufrag it has now.
+  void UpdatePortUfrag(UDPPort* port, const std::string& old_ufrag);
+
+  // Sends on behalf of |from|, which gets the sent packet signal.
+  int SendTo(PortSocket* from,
+             const void* data,
+             size_t size,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options);
+
+  // Routes later packets from |remote_addr| to the port of |ufrag|, if that
+  // port has a connection for it.
+  void MaybeAddRemoteAddress(const std::string& ufrag,
+                             const rtc::SocketAddress& remote_addr);
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const rtc::PacketTime& packet_time);
+  void OnSentPacket(rtc::AsyncPacketSocket* socket,
+                    const rtc::SentPacket& sent_packet);
+  void OnReadyToSend(rtc::AsyncPacketSocket* socket);
+
+  rtc::Thread* const network_thread_;
+  rtc::Network* const network_;
+  const std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  // The port socket that is sending, while in SendTo().
+  PortSocket* sending_socket_ = nullptr;
+  // The entries are on the heap so that their addresses survive a ufrag change.
+  std::unordered_map<std::string, std::unique_ptr<PortEntry>> ports_by_ufrag_;
+  std::unordered_map<rtc::SocketAddress, PortEntry*, SocketAddressHash>
+      ports_by_address_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(IceLitePortAllocator);
+};
+
+}  // namespace cricket
+
+#endif  // P2P_CLIENT_ICELITEPORTALLOCATOR_H_
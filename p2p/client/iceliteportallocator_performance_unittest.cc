@@ -0,0 +1,216 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/p2pconstants.h"
+#include "p2p/base/p2ptransportchannel.h"
+#include "p2p/base/stun.h"
+#include "p2p/client/iceliteportallocator.h"
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/network.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const int kTimeoutMs = 60000;
+const int kPacketsPerRun = 200000;
+const size_t kPayloadSize = 160;
+const uint32_t kNetworkCapacity = 64 * 1024 * 1024;
+const rtc::SocketAddress kServerAddr("22.22.22.22", 3478);
+const char kClientUfrag[] = "clnt";
+const char kClientPwd[] = "clientpasswordclientpas";
+
+class PacketCounter : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(rtc::PacketTransportInternal* transport,
+                    const char* data,
+                    size_t size,
+                    const rtc::PacketTime& packet_time,
+                    int flags) {
+    ++packets_;
+  }
+  int packets() const { return packets_; }
+
+ private:
+  int packets_ = 0;
+};
+
+// One ICE session: the server's ICE-lite channel and a client that nominates
+// its only candidate pair, then sends data.
+class Session : public sigslot::has_slots<> {
+ public:
+  Session(int index,
+          rtc::SocketFactory* factory,
+          IceLitePortAllocator* allocator,
+          PacketCounter* counter)
+      // Random ufrags would collide among thousands of sessions.
+      : ufrag_(rtc::CreateRandomString(ICE_UFRAG_LENGTH) +
+               rtc::ToString(index)),
+        pwd_(rtc::CreateRandomString(ICE_PWD_LENGTH)),
+        // One address per client, as behind their own NATs.
+        socket_(rtc::AsyncUDPSocket::Create(
+            factory,
+            rtc::SocketAddress(rtc::IPAddress(0x0B000001 + index), 5000))),
+        channel_(absl::make_unique<P2PTransportChannel>(
+            "data",
+            ICE_CANDIDATE_COMPONENT_DEFAULT,
+            allocator)) {
+    socket_->SignalReadPacket.connect(this, &Session::OnReadPacket);
+    IceConfig config;
+    config.ice_lite = true;
+    channel_->SetIceConfig(config);
+    channel_->SetIceRole(ICEROLE_CONTROLLED);
+    channel_->SetIceParameters(IceParameters(ufrag_, pwd_, false));
+    channel_->SetRemoteIceParameters(
+        IceParameters(kClientUfrag, kClientPwd, false));
+    channel_->SignalReadPacket.connect(counter, &PacketCounter::OnReadPacket);
+    channel_->MaybeStartGathering();
+  }
+
+  bool connected() const { return connected_ && channel_->writable(); }
+
+  void SendCheck() {
+    IceMessage request;
+    request.SetType(STUN_BINDING_REQUEST);
+    request.SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    request.AddAttribute(absl::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, ufrag_ + ":" + kClientUfrag));
+    request.AddAttribute(
+        absl::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 1000));
+    request.AddAttribute(absl::make_unique<StunUInt64Attribute>(
+        STUN_ATTR_ICE_CONTROLLING, 1));
+    request.AddAttribute(
+        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+    request.AddMessageIntegrity(pwd_);
+    request.AddFingerprint();
+    rtc::ByteBufferWriter buf;
+    request.Write(&buf);
+    socket_->SendTo(buf.Data(), buf.Length(), kServerAddr,
+                    rtc::PacketOptions());
+  }
+
+  void SendData(const std::vector<char>& payload) {
+    socket_->SendTo(payload.data(), payload.size(), kServerAddr,
+                    rtc::PacketOptions());
+  }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& addr,
+                    const rtc::PacketTime& packet_time) {
+    if (size >= 2 && rtc::GetBE16(data) == STUN_BINDING_RESPONSE)
+      connected_ = true;
+  }
+
+  const std::string ufrag_;
+  const std::string pwd_;
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  std::unique_ptr<P2PTransportChannel> channel_;
+  bool connected_ = false;
+};
+
+// Processes messages until |condition| holds. Returns false on timeout.
+template <typename Condition>
+bool ProcessUntil(rtc::Thread* thread, Condition condition) {
+  const int64_t deadline_ms = rtc::TimeMillis() + kTimeoutMs;
+  while (!condition()) {
+    if (rtc::TimeMillis() > deadline_ms)
+      return false;
+    thread->ProcessMessages(0);
+  }
+  return true;
+}
+
+// Connects |num_sessions| sessions to one IceLitePortAllocator, then sends
+// |kPacketsPerRun| packets round robin from their clients. Reports how fast
+// sessions are set up and packets are delivered to their channels.
+void MeasureSessions(int num_sessions) {
+  rtc::VirtualSocketServer socket_server;
+  // The server answers every session in a burst from one socket.
+  socket_server.set_network_capacity(kNetworkCapacity);
+  rtc::AutoSocketServerThread thread(&socket_server);
+  rtc::Network network("test", "test", kServerAddr.ipaddr(), 32);
+  network.AddIP(kServerAddr.ipaddr());
+  IceLitePortAllocator allocator(
+      &thread, &network,
+      rtc::AsyncUDPSocket::Create(&socket_server, kServerAddr));
+
+  PacketCounter counter;
+  std::vector<std::unique_ptr<Session>> sessions;
+  const int64_t setup_start_us = rtc::TimeMicros();
+  for (int i = 0; i < num_sessions; ++i) {
+    sessions.push_back(
+        absl::make_unique<Session>(i, &socket_server, &allocator, &counter));
+    sessions.back()->SendCheck();
+  }
+  ASSERT_TRUE(ProcessUntil(&thread, [&sessions] {
+    return std::all_of(
+        sessions.begin(), sessions.end(),
+        [](const std::unique_ptr<Session>& session) {
+          return session->connected();
+        });
+  }));
+  const int64_t setup_us =
+      std::max<int64_t>(rtc::TimeMicros() - setup_start_us, 1);
+  EXPECT_EQ(static_cast<size_t>(num_sessions), allocator.port_count());
+
+  const std::vector<char> payload(kPayloadSize, 'x');
+  const int rounds = std::max(kPacketsPerRun / num_sessions, 1);
+  const int64_t start_us = rtc::TimeMicros();
+  int expected = 0;
+  for (int round = 0; round < rounds; ++round) {
+    for (const auto& session : sessions)
+      session->SendData(payload);
+    expected += num_sessions;
+    // Deliver each round before the next, so that the virtual network never
+    // holds more than a round of packets.
+    ASSERT_TRUE(ProcessUntil(&thread, [&counter, expected] {
+      return counter.packets() >= expected;
+    }))
+        << "Delivered " << counter.packets() << " of " << expected
+        << " packets";
+  }
+  const int64_t elapsed_us =
+      std::max<int64_t>(rtc::TimeMicros() - start_us, 1);
+
+  rtc::StringBuilder trace;
+  trace << num_sessions << "_sessions";
+  webrtc::test::PrintResult("ice_lite_session_setup", "", trace.str(),
+                            1e6 * num_sessions / setup_us, "sessions/s", true);
+  webrtc::test::PrintResult("ice_lite_received_packets", "", trace.str(),
+                            1e6 * expected / elapsed_us, "packets/s", true);
+}
+
+}  // namespace
+
+// Many ICE-lite sessions on a single socket, as on an SFU, with the packets
+// going through VirtualSocketServer.
+TEST(IceLitePortAllocatorPerformanceTest, ThousandsOfSessionsOnOneSocket) {
+  for (int num_sessions : {1000, 10000})
+    MeasureSessions(num_sessions);
+}
+
+}  // namespace cricket
@@ -0,0 +1,248 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/client/iceliteportallocator.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "p2p/base/p2pconstants.h"
+#include "p2p/base/p2ptransportchannel.h"
+#include "p2p/base/stun.h"
+#include "rtc_base/asyncudpsocket.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/network.h"
+#include "rtc_base/virtualsocketserver.h"
+
+namespace cricket {
+namespace {
+
+const int kTimeoutMs = 1000;
+const rtc::SocketAddress kServerAddr("22.22.22.22", 3478);
+const rtc::SocketAddress kClientAddr1("11.11.11.11", 5000);
+const rtc::SocketAddress kClientAddr2("11.11.11.12", 5000);
+const char kClientUfrag[] = "clnt";
+const char kClientPwd[] = "clientpasswordclientpas";
+const char kServerUfrag1[] = "srv1";
+const char kServerPwd1[] = "serverpassword1serverpa";
+const char kServerUfrag2[] = "srv2";
+const char kServerPwd2[] = "serverpassword2serverpa";
+const char kData[] = "hello";
+
+// A full ICE agent in the controlling role, reduced to sending checks with
+// aggressive nomination and data.
+class TestClient : public sigslot::has_slots<> {
+ public:
+  TestClient(rtc::SocketFactory* factory, const rtc::SocketAddress& address)
+      : socket_(rtc::AsyncUDPSocket::Create(factory, address)) {
+    socket_->SignalReadPacket.connect(this, &TestClient::OnReadPacket);
+  }
+
+  void SendCheck(const std::string& server_ufrag,
+                 const std::string& server_pwd) {
+    IceMessage request;
+    request.SetType(STUN_BINDING_REQUEST);
+    request.SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    request.AddAttribute(absl::make_unique<StunByteStringAttribute>(
+        STUN_ATTR_USERNAME, server_ufrag + ":" + kClientUfrag));
+    request.AddAttribute(
+        absl::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 1000));
+    request.AddAttribute(absl::make_unique<StunUInt64Attribute>(
+        STUN_ATTR_ICE_CONTROLLING, 1));
+    request.AddAttribute(
+        absl::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+    request.AddMessageIntegrity(server_pwd);
+    request.AddFingerprint();
+    rtc::ByteBufferWriter buf;
+    request.Write(&buf);
+    socket_->SendTo(buf.Data(), buf.Length(), kServerAddr,
+                    rtc::PacketOptions());
+  }
+
+  void SendData() {
+    socket_->SendTo(kData, sizeof(kData), kServerAddr, rtc::PacketOptions());
+  }
+
+  int responses() const { return responses_; }
+  int error_responses() const { return error_responses_; }
+  int requests() const { return requests_; }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& addr,
+                    const rtc::PacketTime& packet_time) {
+    IceMessage msg;
+    rtc::ByteBufferReader buf(data, size);
+    if (!msg.Read(&buf))
+      return;
+    if (msg.type() == STUN_BINDING_RESPONSE)
+      ++responses_;
+    else if (msg.type() == STUN_BINDING_ERROR_RESPONSE)
+      ++error_responses_;
+    else if (msg.type() == STUN_BINDING_REQUEST)
+      ++requests_;
+  }
+
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  int responses_ = 0;
+  int error_responses_ = 0;
+  int requests_ = 0;
+};
+
+}  // namespace
+
+class IceLitePortAllocatorTest : public testing::Test,
+                                 public sigslot::has_slots<> {
+ public:
+  IceLitePortAllocatorTest()
+      : thread_(&socket_server_),
+        network_("test", "test", kServerAddr.ipaddr(), 32) {
+    network_.AddIP(kServerAddr.ipaddr());
+    allocator_ = absl::make_unique<IceLitePortAllocator>(
+        &thread_, &network_,
+        rtc::AsyncUDPSocket::Create(&socket_server_, kServerAddr));
+  }
+
+  std::unique_ptr<P2PTransportChannel> CreateChannel(const std::string& ufrag,
+                                                     const std::string& pwd) {
+    auto channel = absl::make_unique<P2PTransportChannel>(
+        "data", ICE_CANDIDATE_COMPONENT_DEFAULT, allocator_.get());
+    IceConfig config;
+    config.ice_lite = true;
+    channel->SetIceConfig(config);
+    channel->SetIceRole(ICEROLE_CONTROLLED);
+    channel->SetIceParameters(IceParameters(ufrag, pwd, false));
+    channel->SetRemoteIceParameters(
+        IceParameters(kClientUfrag, kClientPwd, false));
+    channel->SignalReadPacket.connect(
+        this, &IceLitePortAllocatorTest::OnReadPacket);
+    channel->MaybeStartGathering();
+    return channel;
+  }
+
+  void OnReadPacket(rtc::PacketTransportInternal* transport,
+                    const char* data,
+                    size_t size,
+                    const rtc::PacketTime& packet_time,
+                    int flags) {
+    last_transport_read_ = transport;
+  }
+
+ protected:
+  rtc::ScopedFakeClock clock_;
+  rtc::VirtualSocketServer socket_server_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::Network network_;
+  std::unique_ptr<IceLitePortAllocator> allocator_;
+  rtc::PacketTransportInternal* last_transport_read_ = nullptr;
+};
+
+TEST_F(IceLitePortAllocatorTest, SessionsShareTheSocket) {
+  auto channel1 = CreateChannel(kServerUfrag1, kServerPwd1);
+  auto channel2 = CreateChannel(kServerUfrag2, kServerPwd2);
+  EXPECT_EQ(2u, allocator_->port_count());
+  EXPECT_EQ(IceGatheringState::kIceGatheringComplete,
+            channel1->gathering_state());
+  ASSERT_EQ(1u, channel1->ports().size());
+  ASSERT_EQ(1u, channel2->ports().size());
+  const std::vector<Candidate>& candidates1 =
+      static_cast<Port*>(channel1->ports()[0])->Candidates();
+  const std::vector<Candidate>& candidates2 =
+      static_cast<Port*>(channel2->ports()[0])->Candidates();
+  ASSERT_EQ(1u, candidates1.size());
+  ASSERT_EQ(1u, candidates2.size());
+  EXPECT_EQ(kServerAddr, candidates1[0].address());
+  EXPECT_EQ(kServerAddr, candidates2[0].address());
+  EXPECT_EQ(kServerUfrag1, candidates1[0].username());
+  EXPECT_EQ(kServerUfrag2, candidates2[0].username());
+
+  channel1.reset();
+  EXPECT_EQ(1u, allocator_->port_count());
+}
+
+// Each check reaches the session of its ufrag, which becomes writable by
+// answering it, without ever sending a check itself.
+TEST_F(IceLitePortAllocatorTest, RoutesChecksByUfrag) {
+  auto channel1 = CreateChannel(kServerUfrag1, kServerPwd1);
+  auto channel2 = CreateChannel(kServerUfrag2, kServerPwd2);
+  TestClient client1(&socket_server_, kClientAddr1);
+  TestClient client2(&socket_server_, kClientAddr2);
+
+  client1.SendCheck(kServerUfrag1, kServerPwd1);
+  EXPECT_EQ_SIMULATED_WAIT(1, client1.responses(), kTimeoutMs, clock_);
+  EXPECT_TRUE_SIMULATED_WAIT(channel1->writable(), kTimeoutMs, clock_);
+  EXPECT_FALSE(channel2->writable());
+  ASSERT_TRUE(channel1->selected_connection());
+  EXPECT_EQ(kClientAddr1,
+            channel1->selected_connection()->remote_candidate().address());
+
+  client2.SendCheck(kServerUfrag2, kServerPwd2);
+  EXPECT_EQ_SIMULATED_WAIT(1, client2.responses(), kTimeoutMs, clock_);
+  EXPECT_TRUE_SIMULATED_WAIT(channel2->writable(), kTimeoutMs, clock_);
+  ASSERT_TRUE(channel2->selected_connection());
+  EXPECT_EQ(kClientAddr2,
+            channel2->selected_connection()->remote_candidate().address());
+
+  // Run for a while to see that nothing is pinged.
+  SIMULATED_WAIT(false, 3000, clock_);
+  EXPECT_EQ(0, client1.requests());
+  EXPECT_EQ(0, client2.requests());
+  EXPECT_EQ(0, client1.error_responses());
+}
+
+TEST_F(IceLitePortAllocatorTest, RoutesDataByAddress) {
+  auto channel1 = CreateChannel(kServerUfrag1, kServerPwd1);
+  auto channel2 = CreateChannel(kServerUfrag2, kServerPwd2);
+  TestClient client1(&socket_server_, kClientAddr1);
+  TestClient client2(&socket_server_, kClientAddr2);
+
+  // Data from an address that hasn't sent a check is dropped.
+  client2.SendData();
+  client2.SendCheck(kServerUfrag2, kServerPwd2);
+  EXPECT_EQ_SIMULATED_WAIT(1, client2.responses(), kTimeoutMs, clock_);
+  EXPECT_EQ(nullptr, last_transport_read_);
+
+  client2.SendData();
+  EXPECT_EQ_SIMULATED_WAIT(channel2.get(), last_transport_read_, kTimeoutMs,
+                           clock_);
+
+  client1.SendCheck(kServerUfrag1, kServerPwd1);
+  EXPECT_EQ_SIMULATED_WAIT(1, client1.responses(), kTimeoutMs, clock_);
+  client1.SendData();
+  EXPECT_EQ_SIMULATED_WAIT(channel1.get(), last_transport_read_, kTimeoutMs,
+                           clock_);
+}
+
+TEST_F(IceLitePortAllocatorTest, RejectsChecksWithoutValidCredentials) {
+  auto channel = CreateChannel(kServerUfrag1, kServerPwd1);
+  TestClient client(&socket_server_, kClientAddr1);
+
+  // A check for an unknown ufrag isn't answered at all.
+  client.SendCheck(kServerUfrag2, kServerPwd1);
+  // The session rejects a check with the wrong password, and doesn't route
+  // the address to itself.
+  client.SendCheck(kServerUfrag1, kServerPwd2);
+  EXPECT_EQ_SIMULATED_WAIT(1, client.error_responses(), kTimeoutMs, clock_);
+  client.SendData();
+  SIMULATED_WAIT(false, 100, clock_);
+  EXPECT_EQ(0, client.responses());
+  EXPECT_EQ(1, client.error_responses());
+  EXPECT_FALSE(channel->writable());
+  EXPECT_EQ(nullptr, last_transport_read_);
+}
+
+}  // namespace cricket
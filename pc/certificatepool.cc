@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/certificatepool.h"
+
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/timeutils.h"
+
+namespace webrtc {
+
+namespace {
+
+// A pooled certificate on its way to the callback of the request it answers.
+struct CertificateMessageData : public rtc::MessageData {
+  CertificateMessageData(
+      const rtc::scoped_refptr<rtc::RTCCertificateGeneratorCallback>& callback,
+      const rtc::scoped_refptr<rtc::RTCCertificate>& certificate)
+      : callback(callback), certificate(certificate) {}
+
+  const rtc::scoped_refptr<rtc::RTCCertificateGeneratorCallback> callback;
+  const rtc::scoped_refptr<rtc::RTCCertificate> certificate;
+};
+
+bool IsDefaultKeyParams(const rtc::KeyParams& key_params) {
+  const rtc::KeyParams default_key_params;
+  if (key_params.type() != default_key_params.type())
+    return false;
+  if (key_params.type() == rtc::KT_ECDSA)
+    return key_params.ec_curve() == default_key_params.ec_curve();
+  return key_params.rsa_params().mod_size ==
+             default_key_params.rsa_params().mod_size &&
+         key_params.rsa_params().pub_exp ==
+             default_key_params.rsa_params().pub_exp;
+}
+
+}  // namespace
+
+CertificatePool::CertificatePool(
+    std::unique_ptr<rtc::RTCCertificateGeneratorInterface> generator)
+    : generator_(std::move(generator)) {
+  RTC_DCHECK(generator_);
+}
+
+CertificatePool::~CertificatePool() {}
+
+void CertificatePool::Fill(size_t size) {
+  while (certificates_.size() + num_pending_ < size) {
+    ++num_pending_;
+    generator_->GenerateCertificateAsync(rtc::KeyParams(), absl::nullopt,
+                                         this);
+  }
+}
+
+rtc::scoped_refptr<rtc::RTCCertificate> CertificatePool::Take() {
+  const uint64_t now_ms = rtc::TimeUTCMillis();
+  while (!certificates_.empty()) {
+    rtc::scoped_refptr<rtc::RTCCertificate> certificate =
+        certificates_.front();
+    certificates_.pop_front();
+    if (!certificate->HasExpired(now_ms))
+      return certificate;
+  }
+  return nullptr;
+}
+
+void CertificatePool::OnSuccess(
+    const rtc::scoped_refptr<rtc::RTCCertificate>& certificate) {
+  RTC_DCHECK_GT(num_pending_, 0);
+  --num_pending_;
+  certificates_.push_back(certificate);
+}
+
+void CertificatePool::OnFailure() {
+  RTC_DCHECK_GT(num_pending_, 0);
+  --num_pending_;
+  RTC_LOG(LS_WARNING) << "Failed to generate a pooled certificate.";
+}
+
+PooledCertificateGenerator::PooledCertificateGenerator(
+    rtc::Thread* signaling_thread,
+    const rtc::scoped_refptr<rtc::RTCCertificate>& certificate,
+    std::unique_ptr<rtc::RTCCertificateGeneratorInterface> generator)
+    : signaling_thread_(signaling_thread),
+      certificate_(certificate),
+      generator_(std::move(generator)) {
+  RTC_DCHECK(signaling_thread_);
+  RTC_DCHECK(certificate_);
+  RTC_DCHECK(generator_);
+}
+
+PooledCertificateGenerator::~PooledCertificateGenerator() {
+  // Drops the callback of a request that has not been answered yet.
+  signaling_thread_->Clear(this);
+}
+
+void PooledCertificateGenerator::GenerateCertificateAsync(
+    const rtc::KeyParams& key_params,
+    const absl::optional<uint64_t>& expires_ms,
+    const rtc::scoped_refptr<rtc::RTCCertificateGeneratorCallback>& callback) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  if (!certificate_ || expires_ms || !IsDefaultKeyParams(key_params)) {
+    generator_->GenerateCertificateAsync(key_params, expires_ms, callback);
+    return;
+  }
+  // Answer asynchronously, like a generator that does the work, so that the
+  // caller gets a chance to connect to the callback first. The certificate
+  // goes with the message, so that later requests are passed on even before
+  // it is delivered.
+  signaling_thread_->Post(RTC_FROM_HERE, this, 0,
+                          new CertificateMessageData(callback, certificate_));
+  certificate_ = nullptr;
+}
+
+void PooledCertificateGenerator::OnMessage(rtc::Message* msg) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  std::unique_ptr<CertificateMessageData> data(
+      static_cast<CertificateMessageData*>(msg->pdata));
+  data->callback->OnSuccess(data->certificate);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef PC_CERTIFICATEPOOL_H_
+#define PC_CERTIFICATEPOOL_H_
+
+#include <deque>
+#include <memory>
+
+#include "rtc_base/messagehandler.h"
+#include "rtc_base/rtccertificate.h"
+#include "rtc_base/rtccertificategenerator.h"
+#include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/thread.h"
+
+namespace webrtc {
+
+// DTLS certificates with the default key parameters, generated ahead of time
+// so that a PeerConnection does not have to wait for key generation before
+// its first offer or answer. Used on the signaling thread. Reference counted
+// so that the generations that are still pending when the owner goes away can
+// complete.
+class CertificatePool : public rtc::RTCCertificateGeneratorCallback {
+ public:
+  explicit CertificatePool(
+      std::unique_ptr<rtc::RTCCertificateGeneratorInterface> generator);
+  ~CertificatePool() override;
+
+  // Generates certificates until |size| of them are ready or pending.
+  void Fill(size_t size);
+
+  // Returns a certificate that has not expired, or null if none is ready.
+  rtc::scoped_refptr<rtc::RTCCertificate> Take();
+
+  size_t num_ready() const { return certificates_.size(); }
+  size_t num_pending() const { return num_pending_; }
+
+  // rtc::RTCCertificateGeneratorCallback implementation.
+  void OnSuccess(
+      const rtc::scoped_refptr<rtc::RTCCertificate>& certificate) override;
+  void OnFailure() override;
+
+ private:
+  const std::unique_ptr<rtc::RTCCertificateGeneratorInterface> generator_;
+  std::deque<rtc::scoped_refptr<rtc::RTCCertificate>> certificates_;
+  size_t num_pending_ = 0;
+};
+
+// A certificate generator that answers the first request for a certificate
+// with the default key parameters and no expiration time with |certificate|,
+// and passes all other requests on to |generator|. This lets a PeerConnection
+// use a certificate from a CertificatePool the same way as one it generated
+// itself, without it appearing in the PeerConnection's configuration.
+class PooledCertificateGenerator : public rtc::RTCCertificateGeneratorInterface,
+                                   public rtc::MessageHandler {
+ public:
+  PooledCertificateGenerator(
+      rtc::Thread* signaling_thread,
+      const rtc::scoped_refptr<rtc::RTCCertificate>& certificate,
+      std::unique_ptr<rtc::RTCCertificateGeneratorInterface> generator);
+  ~PooledCertificateGenerator() override;
+
+  // rtc::RTCCertificateGeneratorInterface implementation.
+  void GenerateCertificateAsync(
+      const rtc::KeyParams& key_params,
+      const absl::optional<uint64_t>& expires_ms,
+      const rtc::scoped_refptr<rtc::RTCCertificateGeneratorCallback>& callback)
+      override;
+
+ private:
+  // rtc::MessageHandler implementation.
+  void OnMessage(rtc::Message* msg) override;
+
+  rtc::Thread* const signaling_thread_;
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate_;
+  const std::unique_ptr<rtc::RTCCertificateGeneratorInterface> generator_;
+};
+
+}  // namespace webrtc
+
+#endif  // PC_CERTIFICATEPOOL_H_
@@ -0,0 +1,221 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "pc/certificatepool.h"
+#include "rtc_base/fakesslidentity.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kTimeoutMs = 1000;
+
+rtc::scoped_refptr<rtc::RTCCertificate> CreateCertificate(
+    int64_t expires_s) {
+  rtc::FakeSSLCertificate certificate("certificate");
+  certificate.SetCertificateExpirationTime(expires_s);
+  return rtc::RTCCertificate::Create(
+      absl::make_unique<rtc::FakeSSLIdentity>(certificate));
+}
+
+// A certificate generator that answers the requests when told to.
+class ManualCertificateGenerator
+    : public rtc::RTCCertificateGeneratorInterface {
+ public:
+  struct Request {
+    rtc::KeyParams key_params;
+    absl::optional<uint64_t> expires_ms;
+    rtc::scoped_refptr<rtc::RTCCertificateGeneratorCallback> callback;
+  };
+
+  explicit ManualCertificateGenerator(std::vector<Request>* requests)
+      : requests_(requests) {}
+
+  void GenerateCertificateAsync(
+      const rtc::KeyParams& key_params,
+      const absl::optional<uint64_t>& expires_ms,
+      const rtc::scoped_refptr<rtc::RTCCertificateGeneratorCallback>& callback)
+      override {
+    requests_->push_back({key_params, expires_ms, callback});
+  }
+
+ private:
+  std::vector<Request>* const requests_;
+};
+
+class RecordingCallback : public rtc::RTCCertificateGeneratorCallback {
+ public:
+  void OnSuccess(
+      const rtc::scoped_refptr<rtc::RTCCertificate>& certificate) override {
+    certificate_ = certificate;
+    ++num_calls_;
+  }
+  void OnFailure() override { ++num_calls_; }
+
+  const rtc::scoped_refptr<rtc::RTCCertificate>& certificate() const {
+    return certificate_;
+  }
+  int num_calls() const { return num_calls_; }
+
+ private:
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate_;
+  int num_calls_ = 0;
+};
+
+int64_t InOneDayS() {
+  return rtc::TimeUTCMillis() / rtc::kNumMillisecsPerSec + 24 * 60 * 60;
+}
+
+}  // namespace
+
+class CertificatePoolTest : public testing::Test {
+ protected:
+  CertificatePoolTest()
+      : pool_(new rtc::RefCountedObject<CertificatePool>(
+            absl::make_unique<ManualCertificateGenerator>(&requests_))) {}
+
+  std::vector<ManualCertificateGenerator::Request> requests_;
+  rtc::scoped_refptr<CertificatePool> pool_;
+};
+
+TEST_F(CertificatePoolTest, FillRequestsMissingCertificates) {
+  pool_->Fill(2);
+  ASSERT_EQ(2u, requests_.size());
+  EXPECT_EQ(2u, pool_->num_pending());
+  EXPECT_FALSE(requests_[0].expires_ms);
+  EXPECT_EQ(rtc::KeyParams().type(), requests_[0].key_params.type());
+
+  // Certificates that are pending count towards the size of the pool.
+  pool_->Fill(2);
+  EXPECT_EQ(2u, requests_.size());
+
+  requests_[0].callback->OnSuccess(CreateCertificate(InOneDayS()));
+  requests_[1].callback->OnFailure();
+  EXPECT_EQ(1u, pool_->num_ready());
+  EXPECT_EQ(0u, pool_->num_pending());
+
+  pool_->Fill(2);
+  EXPECT_EQ(3u, requests_.size());
+}
+
+TEST_F(CertificatePoolTest, TakeReturnsCertificatesInOrder) {
+  EXPECT_FALSE(pool_->Take());
+  pool_->Fill(2);
+  rtc::scoped_refptr<rtc::RTCCertificate> first =
+      CreateCertificate(InOneDayS());
+  rtc::scoped_refptr<rtc::RTCCertificate> second =
+      CreateCertificate(InOneDayS());
+  requests_[0].callback->OnSuccess(first);
+  requests_[1].callback->OnSuccess(second);
+
+  EXPECT_EQ(first, pool_->Take());
+  EXPECT_EQ(second, pool_->Take());
+  EXPECT_FALSE(pool_->Take());
+}
+
+TEST_F(CertificatePoolTest, TakeSkipsExpiredCertificates) {
+  pool_->Fill(2);
+  rtc::scoped_refptr<rtc::RTCCertificate> valid =
+      CreateCertificate(InOneDayS());
+  requests_[0].callback->OnSuccess(CreateCertificate(1));
+  requests_[1].callback->OnSuccess(valid);
+
+  EXPECT_EQ(valid, pool_->Take());
+  EXPECT_EQ(0u, pool_->num_ready());
+}
+
+class PooledCertificateGeneratorTest : public testing::Test {
+ protected:
+  PooledCertificateGeneratorTest()
+      : certificate_(CreateCertificate(InOneDayS())),
+        generator_(absl::make_unique<PooledCertificateGenerator>(
+            rtc::Thread::Current(),
+            certificate_,
+            absl::make_unique<ManualCertificateGenerator>(&requests_))) {}
+
+  std::vector<ManualCertificateGenerator::Request> requests_;
+  rtc::scoped_refptr<rtc::RTCCertificate> certificate_;
+  std::unique_ptr<PooledCertificateGenerator> generator_;
+};
+
+TEST_F(PooledCertificateGeneratorTest, HandsOutPooledCertificateOnce) {
+  rtc::scoped_refptr<RecordingCallback> first(
+      new rtc::RefCountedObject<RecordingCallback>());
+  generator_->GenerateCertificateAsync(rtc::KeyParams(), absl::nullopt,
+                                       first);
+  // The certificate is handed out asynchronously.
+  EXPECT_EQ(0, first->num_calls());
+  EXPECT_EQ_WAIT(1, first->num_calls(), kTimeoutMs);
+  EXPECT_EQ(certificate_, first->certificate());
+  EXPECT_TRUE(requests_.empty());
+
+  rtc::scoped_refptr<RecordingCallback> second(
+      new rtc::RefCountedObject<RecordingCallback>());
+  generator_->GenerateCertificateAsync(rtc::KeyParams(), absl::nullopt,
+                                       second);
+  EXPECT_EQ(1u, requests_.size());
+}
+
+TEST_F(PooledCertificateGeneratorTest, PassesOnRequestsBeforeDelivery) {
+  rtc::scoped_refptr<RecordingCallback> first(
+      new rtc::RefCountedObject<RecordingCallback>());
+  rtc::scoped_refptr<RecordingCallback> second(
+      new rtc::RefCountedObject<RecordingCallback>());
+  generator_->GenerateCertificateAsync(rtc::KeyParams(), absl::nullopt,
+                                       first);
+  generator_->GenerateCertificateAsync(rtc::KeyParams(), absl::nullopt,
+                                       second);
+  // Only the first request gets the pooled certificate.
+  EXPECT_EQ(1u, requests_.size());
+  EXPECT_EQ_WAIT(1, first->num_calls(), kTimeoutMs);
+  EXPECT_EQ(certificate_, first->certificate());
+  rtc::Thread::Current()->ProcessMessages(0);
+  EXPECT_EQ(0, second->num_calls());
+}
+
+TEST_F(PooledCertificateGeneratorTest, PassesOnOtherRequests) {
+  rtc::scoped_refptr<RecordingCallback> callback(
+      new rtc::RefCountedObject<RecordingCallback>());
+  const rtc::KeyType other_key_type =
+      rtc::KeyParams().type() == rtc::KT_ECDSA ? rtc::KT_RSA : rtc::KT_ECDSA;
+  generator_->GenerateCertificateAsync(rtc::KeyParams(other_key_type),
+                                       absl::nullopt, callback);
+  generator_->GenerateCertificateAsync(rtc::KeyParams(), 1000, callback);
+  EXPECT_EQ(2u, requests_.size());
+
+  // The pooled certificate is still there for a default request.
+  generator_->GenerateCertificateAsync(rtc::KeyParams(), absl::nullopt,
+                                       callback);
+  EXPECT_EQ_WAIT(1, callback->num_calls(), kTimeoutMs);
+  EXPECT_EQ(certificate_, callback->certificate());
+  EXPECT_EQ(2u, requests_.size());
+}
+
+TEST_F(PooledCertificateGeneratorTest, DestroyingDropsPendingCallback) {
+  rtc::scoped_refptr<rtc::RefCountedObject<RecordingCallback>> callback(
+      new rtc::RefCountedObject<RecordingCallback>());
+  generator_->GenerateCertificateAsync(rtc::KeyParams(), absl::nullopt,
+                                       callback);
+  generator_.reset();
+  rtc::Thread::Current()->ProcessMessages(0);
+  EXPECT_EQ(0, callback->num_calls());
+  EXPECT_TRUE(callback->HasOneRef());
+}
+
+}  // namespace webrtc
@@ -46,6 +46,46 @@ struct SendPacketMessageData : public rtc::MessageData {
   rtc::PacketOptions options;
 };
 
+bool CryptosEqual(const std::vector<CryptoParams>& a,
+                  const std::vector<CryptoParams>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const CryptoParams& x, const CryptoParams& y) {
+                      return x.tag == y.tag &&
+                             x.cipher_suite == y.cipher_suite &&
+                             x.key_params == y.key_params &&
+                             x.session_params == y.session_params;
+                    });
+}
+
+// Returns true if applying |b| to a channel would have the same effect as
+// applying |a|, which is the case if an m= section did not change in a
+// renegotiation. The connection address is left out, as it follows the ICE
+// candidates and is not used by the channel.
+bool IsSameContent(const MediaContentDescription& a,
+                   const MediaContentDescription& b) {
+  if (a.type() != b.type() || a.protocol() != b.protocol() ||
+      a.direction() != b.direction() || a.rtcp_mux() != b.rtcp_mux() ||
+      a.rtcp_reduced_size() != b.rtcp_reduced_size() ||
+      a.bandwidth() != b.bandwidth() ||
+      !CryptosEqual(a.cryptos(), b.cryptos()) ||
+      a.rtp_header_extensions() != b.rtp_header_extensions() ||
+      a.rtp_header_extensions_set() != b.rtp_header_extensions_set() ||
+      a.streams() != b.streams() ||
+      a.conference_mode() != b.conference_mode()) {
+    return false;
+  }
+  switch (a.type()) {
+    case MEDIA_TYPE_AUDIO:
+      return a.as_audio()->codecs() == b.as_audio()->codecs();
+    case MEDIA_TYPE_VIDEO:
+      return a.as_video()->codecs() == b.as_video()->codecs();
+    case MEDIA_TYPE_DATA:
+      return a.as_data()->codecs() == b.as_data()->codecs() &&
+             a.as_data()->use_sctpmap() == b.as_data()->use_sctpmap();
+  }
+  return false;
+}
+
 }  // namespace
 
 enum {
@@ -221,6 +261,11 @@ bool BaseChannel::SetRtpTransport(webrtc::RtpTransportInternal* rtp_transport) {
                                                           pair.second);
       }
     }
+    // SetLocalContent skips unchanged contents, so the header extensions may
+    // not be set on the new transport otherwise.
+    if (rtp_header_extensions_) {
+      rtp_transport_->UpdateRtpHeaderExtensionMap(*rtp_header_extensions_);
+    }
   }
   return true;
 }
@@ -266,18 +311,38 @@ bool BaseChannel::SetLocalContent(const MediaContentDescription* content,
                                   SdpType type,
                                   std::string* error_desc) {
   TRACE_EVENT0("webrtc", "BaseChannel::SetLocalContent");
-  return InvokeOnWorker<bool>(
-      RTC_FROM_HERE,
-      Bind(&BaseChannel::SetLocalContent_w, this, content, type, error_desc));
+  // Nothing in the channel depends on |type|, so an unchanged m= section
+  // needs neither a thread hop nor a media channel update.
+  if (content && applied_local_content_ &&
+      IsSameContent(*applied_local_content_, *content)) {
+    return true;
+  }
+  applied_local_content_.reset();
+  if (!InvokeOnWorker<bool>(RTC_FROM_HERE,
+                            Bind(&BaseChannel::SetLocalContent_w, this,
+                                 content, type, error_desc))) {
+    return false;
+  }
+  applied_local_content_.reset(content->Copy());
+  return true;
 }
 
 bool BaseChannel::SetRemoteContent(const MediaContentDescription* content,
                                    SdpType type,
                                    std::string* error_desc) {
   TRACE_EVENT0("webrtc", "BaseChannel::SetRemoteContent");
-  return InvokeOnWorker<bool>(
-      RTC_FROM_HERE,
-      Bind(&BaseChannel::SetRemoteContent_w, this, content, type, error_desc));
+  if (content && applied_remote_content_ &&
+      IsSameContent(*applied_remote_content_, *content)) {
+    return true;
+  }
+  applied_remote_content_.reset();
+  if (!InvokeOnWorker<bool>(RTC_FROM_HERE,
+                            Bind(&BaseChannel::SetRemoteContent_w, this,
+                                 content, type, error_desc))) {
+    return false;
+  }
+  applied_remote_content_.reset(content->Copy());
+  return true;
 }
 
 bool BaseChannel::IsReadyToReceiveMedia_w() const {
@@ -460,6 +525,7 @@ void BaseChannel::UpdateRtpHeaderExtensionMap(
   // extension maps are not merged when BUNDLE is enabled. This is fine because
   // the ID for MID should be consistent among all the RTP transports.
   network_thread_->Invoke<void>(RTC_FROM_HERE, [this, &header_extensions] {
+    rtp_header_extensions_ = header_extensions;
     rtp_transport_->UpdateRtpHeaderExtensionMap(header_extensions);
   });
 }
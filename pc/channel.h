@@ -18,6 +18,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "api/call/audio_sink.h"
 #include "api/jsep.h"
 #include "api/rtpreceiverinterface.h"
@@ -309,6 +310,9 @@ class BaseChannel : public rtc::MessageHandler,
 
   std::vector<std::pair<rtc::Socket::Option, int> > socket_options_;
   std::vector<std::pair<rtc::Socket::Option, int> > rtcp_socket_options_;
+  // The header extensions last set on |rtp_transport_|, applied again when
+  // the transport changes. Accessed on the network thread.
+  absl::optional<RtpHeaderExtensions> rtp_header_extensions_;
   bool writable_ = false;
   bool was_ever_writable_ = false;
   bool has_received_packet_ = false;
@@ -330,6 +334,12 @@ class BaseChannel : public rtc::MessageHandler,
       webrtc::RtpTransceiverDirection::kInactive;
 
   webrtc::RtpDemuxerCriteria demuxer_criteria_;
+
+  // Copies of the contents last applied by SetLocalContent and
+  // SetRemoteContent, so that m= sections that did not change in a
+  // renegotiation are not applied again. Accessed on the signaling thread.
+  std::unique_ptr<MediaContentDescription> applied_local_content_;
+  std::unique_ptr<MediaContentDescription> applied_remote_content_;
 };
 
 // VoiceChannel is a specialization that adds support for early media, DTMF,
@@ -1217,6 +1217,34 @@ class ChannelTest : public testing::Test, public sigslot::has_slots<> {
         channel1_->SetRemoteContent(content.get(), SdpType::kAnswer, &err));
   }
 
+  void TestSetUnchangedContent() {
+    CreateChannels(0, 0);
+
+    std::string err;
+    std::unique_ptr<typename T::Content> content(
+        CreateMediaContentWithStream(1));
+    EXPECT_TRUE(
+        channel1_->SetLocalContent(content.get(), SdpType::kOffer, &err));
+    EXPECT_TRUE(
+        channel1_->SetRemoteContent(content.get(), SdpType::kAnswer, &err));
+
+    // A content that did not change is not applied to the media channel again.
+    media_channel1_->set_fail_set_recv_codecs(true);
+    media_channel1_->set_fail_set_send_codecs(true);
+    std::unique_ptr<typename T::Content> unchanged(
+        CreateMediaContentWithStream(1));
+    EXPECT_TRUE(
+        channel1_->SetLocalContent(unchanged.get(), SdpType::kOffer, &err));
+    EXPECT_TRUE(
+        channel1_->SetRemoteContent(unchanged.get(), SdpType::kAnswer, &err));
+
+    content->set_direction(RtpTransceiverDirection::kSendOnly);
+    EXPECT_FALSE(
+        channel1_->SetLocalContent(content.get(), SdpType::kOffer, &err));
+    EXPECT_FALSE(
+        channel1_->SetRemoteContent(content.get(), SdpType::kAnswer, &err));
+  }
+
   void TestSendTwoOffers() {
     CreateChannels(0, 0);
 
@@ -1687,6 +1715,10 @@ TEST_F(VoiceChannelSingleThreadTest, TestSetContentFailure) {
   Base::TestSetContentFailure();
 }
 
+TEST_F(VoiceChannelSingleThreadTest, TestSetUnchangedContent) {
+  Base::TestSetUnchangedContent();
+}
+
 TEST_F(VoiceChannelSingleThreadTest, TestSendTwoOffers) {
   Base::TestSendTwoOffers();
 }
@@ -1822,6 +1854,10 @@ TEST_F(VoiceChannelDoubleThreadTest, TestSetContentFailure) {
   Base::TestSetContentFailure();
 }
 
+TEST_F(VoiceChannelDoubleThreadTest, TestSetUnchangedContent) {
+  Base::TestSetUnchangedContent();
+}
+
 TEST_F(VoiceChannelDoubleThreadTest, TestSendTwoOffers) {
   Base::TestSendTwoOffers();
 }
@@ -1955,6 +1991,10 @@ TEST_F(VideoChannelSingleThreadTest, TestSetContentFailure) {
   Base::TestSetContentFailure();
 }
 
+TEST_F(VideoChannelSingleThreadTest, TestSetUnchangedContent) {
+  Base::TestSetUnchangedContent();
+}
+
 TEST_F(VideoChannelSingleThreadTest, TestSendTwoOffers) {
   Base::TestSendTwoOffers();
 }
@@ -2088,6 +2128,10 @@ TEST_F(VideoChannelDoubleThreadTest, TestSetContentFailure) {
   Base::TestSetContentFailure();
 }
 
+TEST_F(VideoChannelDoubleThreadTest, TestSetUnchangedContent) {
+  Base::TestSetUnchangedContent();
+}
+
 TEST_F(VideoChannelDoubleThreadTest, TestSendTwoOffers) {
   Base::TestSendTwoOffers();
 }
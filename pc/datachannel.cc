@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "media/sctp/sctptransportinternal.h"
 #include "pc/sctputils.h"
@@ -141,7 +142,7 @@ DataChannel::DataChannel(DataChannelProviderInterface* provider,
 bool DataChannel::Init(const InternalDataChannelInit& config) {
   if (data_channel_type_ == cricket::DCT_RTP) {
     if (config.reliable || config.id != -1 || config.maxRetransmits != -1 ||
-        config.maxRetransmitTime != -1) {
+        config.maxRetransmitTime != -1 || config.fecGroupSize != 0) {
       RTC_LOG(LS_ERROR) << "Failed to initialize the RTP data channel due to "
                            "invalid DataChannelInit.";
       return false;
@@ -159,6 +160,21 @@ bool DataChannel::Init(const InternalDataChannelInit& config) {
           << "maxRetransmits and maxRetransmitTime should not be both set.";
       return false;
     }
+    if (config.fecGroupSize != 0) {
+      if (config.fecGroupSize < 0 ||
+          config.fecGroupSize > kDataChannelMaxFecGroupSize ||
+          config.fecParityMessages < 1 ||
+          config.fecParityMessages > config.fecGroupSize || config.ordered ||
+          !config.negotiated ||
+          (config.maxRetransmits == -1 && config.maxRetransmitTime == -1)) {
+        RTC_LOG(LS_ERROR) << "FEC needs an unordered, unreliable, negotiated "
+                             "SCTP data channel and a valid group size.";
+        return false;
+      }
+      fec_encoder_.reset(new DataChannelFecEncoder(config.fecGroupSize,
+                                                   config.fecParityMessages));
+      fec_decoder_.reset(new DataChannelFecDecoder(config.fecGroupSize));
+    }
     config_ = config;
 
     switch (config_.open_handshake_role) {
@@ -214,6 +230,14 @@ uint64_t DataChannel::buffered_amount() const {
   return queued_send_data_.byte_count();
 }
 
+uint32_t DataChannel::fec_messages_recovered() const {
+  return fec_decoder_ ? fec_decoder_->messages_recovered() : 0;
+}
+
+uint32_t DataChannel::fec_messages_unrecovered() const {
+  return fec_decoder_ ? fec_decoder_->messages_unrecovered() : 0;
+}
+
 void DataChannel::Close() {
   if (state_ == kClosed)
     return;
@@ -387,13 +411,35 @@ void DataChannel::OnDataReceived(const cricket::ReceiveDataParams& params,
   }
 
   bool binary = (params.type == cricket::DMT_BINARY);
-  std::unique_ptr<DataBuffer> buffer(new DataBuffer(payload, binary));
+  if (!fec_decoder_) {
+    DeliverReceivedMessage(
+        std::unique_ptr<DataBuffer>(new DataBuffer(payload, binary)));
+    return;
+  }
+
+  // The message may be a data message, which is delivered right away, or a
+  // parity message; either may allow to rebuild lost messages.
+  std::vector<DataBuffer> messages;
+  if (!fec_decoder_->OnMessageReceived(payload, binary, &messages)) {
+    RTC_LOG(LS_WARNING) << "DataChannel received malformed FEC message, sid = "
+                        << params.sid;
+    return;
+  }
+  for (const DataBuffer& message : messages) {
+    if (!DeliverReceivedMessage(
+            std::unique_ptr<DataBuffer>(new DataBuffer(message)))) {
+      return;
+    }
+  }
+}
+
+bool DataChannel::DeliverReceivedMessage(std::unique_ptr<DataBuffer> buffer) {
   if (state_ == kOpen && observer_) {
     ++messages_received_;
     bytes_received_ += buffer->size();
     observer_->OnMessage(*buffer.get());
   } else {
-    if (queued_received_data_.byte_count() + payload.size() >
+    if (queued_received_data_.byte_count() + buffer->size() >
         kMaxQueuedReceivedDataBytes) {
       RTC_LOG(LS_ERROR) << "Queued received data exceeds the max buffer size.";
 
@@ -402,10 +448,11 @@ void DataChannel::OnDataReceived(const cricket::ReceiveDataParams& params,
         CloseAbruptly();
       }
 
-      return;
+      return false;
     }
     queued_received_data_.Push(buffer.release());
   }
+  return true;
 }
 
 void DataChannel::OnChannelReady(bool writable) {
@@ -589,11 +636,23 @@ bool DataChannel::SendDataMessage(const DataBuffer& buffer,
   send_params.type = buffer.binary ? cricket::DMT_BINARY : cricket::DMT_TEXT;
 
   cricket::SendDataResult send_result = cricket::SDR_SUCCESS;
-  bool success = provider_->SendData(send_params, buffer.data, &send_result);
+  bool success = provider_->SendData(
+      send_params, fec_encoder_ ? fec_encoder_->Encode(buffer) : buffer.data,
+      &send_result);
 
   if (success) {
     ++messages_sent_;
     bytes_sent_ += buffer.size();
+    if (fec_encoder_) {
+      // Parity messages are only useful if they arrive soon after the group,
+      // so they are not queued if the transport is blocked.
+      send_params.type = cricket::DMT_BINARY;
+      for (const rtc::CopyOnWriteBuffer& parity :
+           fec_encoder_->OnMessageSent(buffer)) {
+        cricket::SendDataResult parity_result;
+        provider_->SendData(send_params, parity, &parity_result);
+      }
+    }
     return true;
   }
 
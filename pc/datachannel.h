@@ -12,6 +12,7 @@
 #define PC_DATACHANNEL_H_
 
 #include <deque>
+#include <memory>
 #include <set>
 #include <string>
 
@@ -19,6 +20,7 @@
 #include "api/proxy.h"
 #include "media/base/mediachannel.h"
 #include "pc/channel.h"
+#include "pc/datachannelfec.h"
 #include "rtc_base/asyncinvoker.h"
 #include "rtc_base/scoped_ref_ptr.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
@@ -144,6 +146,12 @@ class DataChannel : public DataChannelInterface, public sigslot::has_slots<> {
   virtual uint64_t bytes_received() const { return bytes_received_; }
   virtual bool Send(const DataBuffer& buffer);
 
+  // Messages rebuilt from parity messages, and messages lost for good, when
+  // DataChannelInit::fecGroupSize is set.
+  uint32_t fec_messages_recovered() const;
+  uint32_t fec_messages_unrecovered() const;
+  bool fec_enabled() const { return fec_decoder_ != nullptr; }
+
   // Called when the channel's ready to use.  That can happen when the
   // underlying DataMediaChannel becomes ready, or when this channel is a new
   // stream on an existing DataMediaChannel, and we've finished negotiation.
@@ -253,6 +261,8 @@ class DataChannel : public DataChannelInterface, public sigslot::has_slots<> {
   void DisconnectFromProvider();
 
   void DeliverQueuedReceivedData();
+  // Returns false if the channel had to be closed.
+  bool DeliverReceivedMessage(std::unique_ptr<DataBuffer> buffer);
 
   void SendQueuedDataMessages();
   bool SendDataMessage(const DataBuffer& buffer, bool queue_if_blocked);
@@ -286,6 +296,9 @@ class DataChannel : public DataChannelInterface, public sigslot::has_slots<> {
   PacketQueue queued_control_data_;
   PacketQueue queued_received_data_;
   PacketQueue queued_send_data_;
+  // Set if DataChannelInit::fecGroupSize is.
+  std::unique_ptr<DataChannelFecEncoder> fec_encoder_;
+  std::unique_ptr<DataChannelFecDecoder> fec_decoder_;
   rtc::AsyncInvoker invoker_;
 };
 
@@ -439,6 +439,40 @@ TEST_F(SctpDataChannelTest, NoMsgSentIfNegotiatedAndNotFromOpenMsg) {
   EXPECT_EQ(0U, provider_->last_send_data_params().ssrc);
 }
 
+// Tests that FEC is only accepted for negotiated, unordered and unreliable
+// channels, and that parity messages follow each complete group.
+TEST_F(SctpDataChannelTest, FecSendsParityAfterEachGroup) {
+  webrtc::InternalDataChannelInit config;
+  config.id = 1;
+  config.negotiated = true;
+  config.open_handshake_role = webrtc::InternalDataChannelInit::kNone;
+  config.fecGroupSize = 2;
+  EXPECT_FALSE(
+      DataChannel::Create(provider_.get(), cricket::DCT_SCTP, "test1", config));
+  config.ordered = false;
+  EXPECT_FALSE(
+      DataChannel::Create(provider_.get(), cricket::DCT_SCTP, "test1", config));
+  config.maxRetransmits = 0;
+  config.fecParityMessages = 3;
+  EXPECT_FALSE(
+      DataChannel::Create(provider_.get(), cricket::DCT_SCTP, "test1", config));
+  config.fecParityMessages = 1;
+
+  SetChannelReady();
+  rtc::scoped_refptr<DataChannel> dc =
+      DataChannel::Create(provider_.get(), cricket::DCT_SCTP, "test1", config);
+  ASSERT_TRUE(dc);
+  EXPECT_EQ_WAIT(webrtc::DataChannelInterface::kOpen, dc->state(), 1000);
+
+  ASSERT_TRUE(dc->Send(webrtc::DataBuffer("first")));
+  EXPECT_EQ(cricket::DMT_TEXT, provider_->last_send_data_params().type);
+  ASSERT_TRUE(dc->Send(webrtc::DataBuffer("second")));
+  EXPECT_EQ(cricket::DMT_BINARY, provider_->last_send_data_params().type);
+  EXPECT_EQ(2U, dc->messages_sent());
+  EXPECT_EQ(11U, dc->bytes_sent());
+  EXPECT_TRUE(dc->fec_enabled());
+}
+
 // Tests that DataChannel::messages_received() and DataChannel::bytes_received()
 // are correct, receiving data both while not open and while open.
 TEST_F(SctpDataChannelTest, VerifyMessagesAndBytesReceived) {
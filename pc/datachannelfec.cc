@@ -0,0 +1,278 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/datachannelfec.h"
+
+#include <string.h>
+
+#include <utility>
+
+#include "modules/include/module_common_types_public.h"
+#include "modules/rtp_rtcp/source/forward_error_correction_internal.h"
+#include "rtc_base/byteorder.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+
+static_assert(kDataChannelMaxFecGroupSize <= kUlpfecMaxMediaPackets,
+              "Groups must fit in the ULPFEC packet masks.");
+
+enum MessageKind : uint8_t {
+  kDataMessage = 0,
+  kParityMessage = 1,
+};
+
+constexpr size_t kDataHeaderSize = 4;
+constexpr size_t kParityHeaderSize = 5;
+// Binary flag and payload length, in front of each payload in a XOR block.
+constexpr size_t kBlockHeaderSize = 5;
+// Number of groups kept for recovery. Messages of older groups are dropped.
+constexpr size_t kMaxGroups = 16;
+
+bool IsProtected(const uint8_t* mask, int index) {
+  return (mask[index / 8] & (0x80 >> (index % 8))) != 0;
+}
+
+// XORs the binary flag, the length and the payload of |message| into |block|,
+// growing it as needed.
+void XorMessage(const DataBuffer& message, std::vector<uint8_t>* block) {
+  const size_t size = kBlockHeaderSize + message.size();
+  if (block->size() < size)
+    block->resize(size, 0);
+  uint8_t header[kBlockHeaderSize];
+  header[0] = message.binary ? 1 : 0;
+  rtc::SetBE32(&header[1], static_cast<uint32_t>(message.size()));
+  uint8_t* data = block->data();
+  for (size_t i = 0; i < kBlockHeaderSize; ++i)
+    data[i] ^= header[i];
+  const uint8_t* payload = message.data.data();
+  data += kBlockHeaderSize;
+  for (size_t i = 0; i < message.size(); ++i)
+    data[i] ^= payload[i];
+}
+
+}  // namespace
+
+DataChannelFecEncoder::DataChannelFecEncoder(int group_size,
+                                             int num_parity_messages)
+    : group_size_(group_size),
+      num_parity_messages_(num_parity_messages),
+      mask_size_(internal::PacketMaskSize(group_size)),
+      masks_(num_parity_messages * mask_size_, 0) {
+  RTC_DCHECK_GT(group_size_, 0);
+  RTC_DCHECK_LE(group_size_, kDataChannelMaxFecGroupSize);
+  RTC_DCHECK_GT(num_parity_messages_, 0);
+  RTC_DCHECK_LE(num_parity_messages_, group_size_);
+  internal::PacketMaskTable mask_table(kFecMaskRandom, group_size_);
+  internal::GeneratePacketMasks(group_size_, num_parity_messages_, 0, false,
+                                &mask_table, masks_.data());
+  group_.reserve(group_size_);
+}
+
+DataChannelFecEncoder::~DataChannelFecEncoder() {}
+
+rtc::CopyOnWriteBuffer DataChannelFecEncoder::Encode(
+    const DataBuffer& message) const {
+  rtc::CopyOnWriteBuffer packet(kDataHeaderSize + message.size());
+  uint8_t* data = packet.data<uint8_t>();
+  data[0] = kDataMessage;
+  rtc::SetBE16(&data[1], group_number_);
+  data[3] = static_cast<uint8_t>(group_.size());
+  if (message.size() > 0)
+    memcpy(&data[kDataHeaderSize], message.data.data(), message.size());
+  return packet;
+}
+
+std::vector<rtc::CopyOnWriteBuffer> DataChannelFecEncoder::OnMessageSent(
+    const DataBuffer& message) {
+  std::vector<rtc::CopyOnWriteBuffer> parity_messages;
+  group_.push_back(message);
+  if (group_.size() < static_cast<size_t>(group_size_))
+    return parity_messages;
+
+  for (int i = 0; i < num_parity_messages_; ++i) {
+    const uint8_t* mask = &masks_[i * mask_size_];
+    std::vector<uint8_t> block;
+    for (int j = 0; j < group_size_; ++j) {
+      if (IsProtected(mask, j))
+        XorMessage(group_[j], &block);
+    }
+    rtc::CopyOnWriteBuffer parity(kParityHeaderSize + mask_size_ +
+                                  block.size());
+    uint8_t* data = parity.data<uint8_t>();
+    data[0] = kParityMessage;
+    rtc::SetBE16(&data[1], group_number_);
+    data[3] = static_cast<uint8_t>(i);
+    data[4] = static_cast<uint8_t>(group_size_);
+    memcpy(&data[kParityHeaderSize], mask, mask_size_);
+    if (!block.empty()) {
+      memcpy(&data[kParityHeaderSize + mask_size_], block.data(),
+             block.size());
+    }
+    parity_messages.push_back(std::move(parity));
+  }
+  group_.clear();
+  ++group_number_;
+  return parity_messages;
+}
+
+DataChannelFecDecoder::Group::Group(int group_size) : messages(group_size) {}
+
+DataChannelFecDecoder::Group::~Group() {}
+
+DataChannelFecDecoder::DataChannelFecDecoder(int group_size)
+    : group_size_(group_size) {
+  RTC_DCHECK_GT(group_size_, 0);
+  RTC_DCHECK_LE(group_size_, kDataChannelMaxFecGroupSize);
+}
+
+DataChannelFecDecoder::~DataChannelFecDecoder() {}
+
+bool DataChannelFecDecoder::OnMessageReceived(
+    const rtc::CopyOnWriteBuffer& payload,
+    bool binary,
+    std::vector<DataBuffer>* messages) {
+  if (payload.size() == 0)
+    return false;
+  const uint8_t* data = payload.data();
+  switch (data[0]) {
+    case kDataMessage: {
+      if (payload.size() < kDataHeaderSize || data[3] >= group_size_)
+        return false;
+      Group* group = FindOrAddGroup(rtc::GetBE16(&data[1]));
+      const int index = data[3];
+      if (!group || group->messages[index])
+        return true;
+      DataBuffer message(
+          rtc::CopyOnWriteBuffer(&data[kDataHeaderSize],
+                                 payload.size() - kDataHeaderSize),
+          binary);
+      group->messages[index] = message;
+      messages->push_back(std::move(message));
+      Recover(group, messages);
+      return true;
+    }
+    case kParityMessage: {
+      const size_t mask_size = internal::PacketMaskSize(group_size_);
+      if (payload.size() < kParityHeaderSize + mask_size ||
+          data[4] != group_size_) {
+        return false;
+      }
+      Group* group = FindOrAddGroup(rtc::GetBE16(&data[1]));
+      if (!group)
+        return true;
+      Parity parity;
+      parity.protects.resize(group_size_);
+      for (int i = 0; i < group_size_; ++i)
+        parity.protects[i] = IsProtected(&data[kParityHeaderSize], i);
+      parity.block.SetData(&data[kParityHeaderSize + mask_size],
+                           payload.size() - kParityHeaderSize - mask_size);
+      group->parities.push_back(std::move(parity));
+      Recover(group, messages);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+DataChannelFecDecoder::Group* DataChannelFecDecoder::FindOrAddGroup(
+    uint16_t group_number) {
+  if (groups_.empty()) {
+    first_group_number_ = group_number;
+    groups_.emplace_back(group_size_);
+    return &groups_.back();
+  }
+  const uint16_t offset = group_number - first_group_number_;
+  if (offset < groups_.size())
+    return &groups_[offset];
+  const uint16_t last_group_number =
+      first_group_number_ + static_cast<uint16_t>(groups_.size() - 1);
+  if (!IsNewerSequenceNumber(group_number, last_group_number))
+    return nullptr;
+
+  const uint16_t num_new_groups = group_number - last_group_number;
+  if (num_new_groups > kMaxGroups) {
+    // Everything kept is dropped, and the groups that are skipped over were
+    // lost entirely.
+    while (!groups_.empty())
+      DropOldestGroup();
+    messages_unrecovered_ +=
+        static_cast<uint32_t>((num_new_groups - kMaxGroups) * group_size_);
+    first_group_number_ = group_number - (kMaxGroups - 1);
+    groups_.resize(kMaxGroups, Group(group_size_));
+    return &groups_.back();
+  }
+  for (uint16_t i = 0; i < num_new_groups; ++i) {
+    groups_.emplace_back(group_size_);
+    if (groups_.size() > kMaxGroups)
+      DropOldestGroup();
+  }
+  return &groups_.back();
+}
+
+void DataChannelFecDecoder::Recover(Group* group,
+                                    std::vector<DataBuffer>* messages) {
+  // Each rebuilt message may leave another parity with a single missing
+  // message, so go on until nothing changes.
+  bool recovered = true;
+  while (recovered) {
+    recovered = false;
+    auto it = group->parities.begin();
+    while (it != group->parities.end()) {
+      int missing_index = -1;
+      int num_missing = 0;
+      for (int i = 0; i < group_size_; ++i) {
+        if (it->protects[i] && !group->messages[i]) {
+          missing_index = i;
+          ++num_missing;
+        }
+      }
+      if (num_missing > 1) {
+        ++it;
+        continue;
+      }
+      if (num_missing == 1) {
+        std::vector<uint8_t> block(it->block.data(),
+                                   it->block.data() + it->block.size());
+        for (int i = 0; i < group_size_; ++i) {
+          if (it->protects[i] && i != missing_index)
+            XorMessage(*group->messages[i], &block);
+        }
+        const size_t size =
+            block.size() >= kBlockHeaderSize ? rtc::GetBE32(&block[1]) : 0;
+        if (block.size() >= kBlockHeaderSize &&
+            size <= block.size() - kBlockHeaderSize) {
+          DataBuffer message(
+              rtc::CopyOnWriteBuffer(block.data() + kBlockHeaderSize, size),
+              block[0] != 0);
+          group->messages[missing_index] = message;
+          messages->push_back(std::move(message));
+          ++messages_recovered_;
+          recovered = true;
+        }
+      }
+      // The parity is used up, or was corrupt.
+      it = group->parities.erase(it);
+    }
+  }
+}
+
+void DataChannelFecDecoder::DropOldestGroup() {
+  for (const absl::optional<DataBuffer>& message : groups_.front().messages) {
+    if (!message)
+      ++messages_unrecovered_;
+  }
+  groups_.pop_front();
+  ++first_group_number_;
+}
+
+}  // namespace webrtc
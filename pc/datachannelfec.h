@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef PC_DATACHANNELFEC_H_
+#define PC_DATACHANNELFEC_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/datachannelinterface.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/copyonwritebuffer.h"
+
+namespace webrtc {
+
+// Largest supported DataChannelInit::fecGroupSize.
+constexpr int kDataChannelMaxFecGroupSize = 48;
+
+// Forward error correction for unreliable SCTP data channels, see
+// DataChannelInit::fecGroupSize.
+//
+// The data messages are sent in groups of a fixed size. Each data message is
+// prefixed with a header giving its group and its index in the group. After
+// the last message of a group, a number of parity messages are sent. Each of
+// them is the XOR of a subset of the messages of the group, chosen with the
+// same packet masks as ULPFEC, so that a receiver that lost a message can
+// rebuild it from the parity and the other messages.
+//
+// Data message:
+//   0                   1                   2                   3
+//   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |   Kind (0)    |         Group number          |     Index     |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |                          Payload ...                          |
+//
+// Parity message:
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |   Kind (1)    |         Group number          | Parity index  |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |  Group size   |  Mask (2 or 6 bytes, ULPFEC layout) ...       |
+//  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//  |                        XOR block ...                          |
+//
+// The XOR block covers, for each protected message, a binary flag byte, the
+// 32 bit payload length and the payload, zero padded to the longest message.
+class DataChannelFecEncoder {
+ public:
+  DataChannelFecEncoder(int group_size, int num_parity_messages);
+  ~DataChannelFecEncoder();
+
+  // Returns |message| with the header for the next position in the current
+  // group.
+  rtc::CopyOnWriteBuffer Encode(const DataBuffer& message) const;
+
+  // Adds |message| to the current group once its encoded form has been
+  // handed to the transport. If that completes the group, returns the parity
+  // messages to send, as binary, and starts the next group.
+  std::vector<rtc::CopyOnWriteBuffer> OnMessageSent(const DataBuffer& message);
+
+ private:
+  const int group_size_;
+  const int num_parity_messages_;
+  size_t mask_size_;
+  // |num_parity_messages_| rows of |mask_size_| bytes.
+  std::vector<uint8_t> masks_;
+  uint16_t group_number_ = 0;
+  std::vector<DataBuffer> group_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(DataChannelFecEncoder);
+};
+
+class DataChannelFecDecoder {
+ public:
+  explicit DataChannelFecDecoder(int group_size);
+  ~DataChannelFecDecoder();
+
+  // Handles a message received on a channel that uses FEC. Appends the data
+  // messages it carries or allows to rebuild to |messages|. Data messages of
+  // groups too old to be kept are dropped, as they may already have been
+  // rebuilt. Returns false if the message is malformed.
+  bool OnMessageReceived(const rtc::CopyOnWriteBuffer& payload,
+                         bool binary,
+                         std::vector<DataBuffer>* messages);
+
+  // Messages rebuilt from parity messages.
+  uint32_t messages_recovered() const { return messages_recovered_; }
+  // Messages of groups that are no longer kept that were neither received
+  // nor rebuilt.
+  uint32_t messages_unrecovered() const { return messages_unrecovered_; }
+
+ private:
+  struct Parity {
+    std::vector<bool> protects;
+    rtc::CopyOnWriteBuffer block;
+  };
+  struct Group {
+    explicit Group(int group_size);
+    ~Group();
+    // Received or rebuilt messages, by index.
+    std::vector<absl::optional<DataBuffer>> messages;
+    std::vector<Parity> parities;
+  };
+
+  // Returns the group with |group_number|, creating it and the ones before it
+  // if needed, or null if it is older than the kept groups.
+  Group* FindOrAddGroup(uint16_t group_number);
+  // Rebuilds as many missing messages of |group| as its parities allow.
+  void Recover(Group* group, std::vector<DataBuffer>* messages);
+  void DropOldestGroup();
+
+  const int group_size_;
+  // Consecutive groups, oldest first.
+  std::deque<Group> groups_;
+  uint16_t first_group_number_ = 0;
+  uint32_t messages_recovered_ = 0;
+  uint32_t messages_unrecovered_ = 0;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(DataChannelFecDecoder);
+};
+
+}  // namespace webrtc
+
+#endif  // PC_DATACHANNELFEC_H_
@@ -0,0 +1,181 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/datachannelfec.h"
+
+#include <string>
+#include <vector>
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+struct SentMessage {
+  rtc::CopyOnWriteBuffer payload;
+  bool binary;
+};
+
+// Encodes |messages| as DataChannel::SendDataMessage() does, with the parity
+// messages following the data messages they protect.
+std::vector<SentMessage> EncodeMessages(DataChannelFecEncoder* encoder,
+                                        const std::vector<DataBuffer>& messages) {
+  std::vector<SentMessage> sent;
+  for (const DataBuffer& message : messages) {
+    sent.push_back({encoder->Encode(message), message.binary});
+    for (const rtc::CopyOnWriteBuffer& parity : encoder->OnMessageSent(message))
+      sent.push_back({parity, true});
+  }
+  return sent;
+}
+
+std::vector<DataBuffer> MakeMessages(int count) {
+  std::vector<DataBuffer> messages;
+  for (int i = 0; i < count; ++i) {
+    if (i % 2) {
+      messages.push_back(DataBuffer("message " + std::to_string(i)));
+    } else {
+      rtc::CopyOnWriteBuffer data(i * 10);
+      for (int j = 0; j < i * 10; ++j)
+        data[j] = static_cast<uint8_t>(i + j);
+      messages.push_back(DataBuffer(data, true));
+    }
+  }
+  return messages;
+}
+
+bool Contains(const std::vector<DataBuffer>& messages,
+              const DataBuffer& message) {
+  for (const DataBuffer& candidate : messages) {
+    if (candidate.data == message.data && candidate.binary == message.binary)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(DataChannelFecTest, DeliversMessagesWithoutLoss) {
+  DataChannelFecEncoder encoder(4, 1);
+  DataChannelFecDecoder decoder(4);
+  const std::vector<DataBuffer> messages = MakeMessages(8);
+  // Two groups of four, each followed by one parity message.
+  std::vector<SentMessage> sent = EncodeMessages(&encoder, messages);
+  ASSERT_EQ(10u, sent.size());
+
+  std::vector<DataBuffer> received;
+  for (const SentMessage& message : sent)
+    EXPECT_TRUE(decoder.OnMessageReceived(message.payload, message.binary,
+                                          &received));
+  ASSERT_EQ(messages.size(), received.size());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    EXPECT_EQ(messages[i].data, received[i].data);
+    EXPECT_EQ(messages[i].binary, received[i].binary);
+  }
+  EXPECT_EQ(0u, decoder.messages_recovered());
+}
+
+TEST(DataChannelFecTest, RecoversOneLostMessagePerGroup) {
+  DataChannelFecEncoder encoder(4, 1);
+  DataChannelFecDecoder decoder(4);
+  const std::vector<DataBuffer> messages = MakeMessages(8);
+  std::vector<SentMessage> sent = EncodeMessages(&encoder, messages);
+
+  // Lose the longest message of the first group and the first message of the
+  // second.
+  std::vector<DataBuffer> received;
+  for (size_t i = 0; i < sent.size(); ++i) {
+    if (i == 2 || i == 5)
+      continue;
+    EXPECT_TRUE(
+        decoder.OnMessageReceived(sent[i].payload, sent[i].binary, &received));
+  }
+  ASSERT_EQ(messages.size(), received.size());
+  for (const DataBuffer& message : messages)
+    EXPECT_TRUE(Contains(received, message));
+  EXPECT_EQ(2u, decoder.messages_recovered());
+}
+
+TEST(DataChannelFecTest, RecoversSeveralLostMessagesWithMoreParity) {
+  DataChannelFecEncoder encoder(8, 4);
+  DataChannelFecDecoder decoder(8);
+  const std::vector<DataBuffer> messages = MakeMessages(8);
+  std::vector<SentMessage> sent = EncodeMessages(&encoder, messages);
+  ASSERT_EQ(12u, sent.size());
+
+  std::vector<DataBuffer> received;
+  for (size_t i = 0; i < sent.size(); ++i) {
+    if (i == 1 || i == 6)
+      continue;
+    EXPECT_TRUE(
+        decoder.OnMessageReceived(sent[i].payload, sent[i].binary, &received));
+  }
+  ASSERT_EQ(messages.size(), received.size());
+  for (const DataBuffer& message : messages)
+    EXPECT_TRUE(Contains(received, message));
+  EXPECT_EQ(2u, decoder.messages_recovered());
+}
+
+TEST(DataChannelFecTest, CountsUnrecoveredMessagesOfDroppedGroups) {
+  DataChannelFecEncoder encoder(2, 1);
+  DataChannelFecDecoder decoder(2);
+  // 40 groups of two messages and one parity message each.
+  std::vector<SentMessage> sent = EncodeMessages(&encoder, MakeMessages(80));
+  ASSERT_EQ(120u, sent.size());
+
+  // Lose both messages of the first group.
+  std::vector<DataBuffer> received;
+  for (size_t i = 2; i < sent.size(); ++i) {
+    EXPECT_TRUE(
+        decoder.OnMessageReceived(sent[i].payload, sent[i].binary, &received));
+  }
+  EXPECT_EQ(78u, received.size());
+  EXPECT_EQ(0u, decoder.messages_recovered());
+  EXPECT_EQ(2u, decoder.messages_unrecovered());
+}
+
+TEST(DataChannelFecTest, IgnoresRecoveredMessageArrivingLate) {
+  DataChannelFecEncoder encoder(2, 1);
+  DataChannelFecDecoder decoder(2);
+  std::vector<SentMessage> sent = EncodeMessages(&encoder, MakeMessages(2));
+
+  std::vector<DataBuffer> received;
+  EXPECT_TRUE(
+      decoder.OnMessageReceived(sent[1].payload, sent[1].binary, &received));
+  EXPECT_TRUE(
+      decoder.OnMessageReceived(sent[2].payload, sent[2].binary, &received));
+  EXPECT_EQ(2u, received.size());
+  EXPECT_TRUE(
+      decoder.OnMessageReceived(sent[0].payload, sent[0].binary, &received));
+  EXPECT_EQ(2u, received.size());
+}
+
+TEST(DataChannelFecTest, RejectsMalformedMessages) {
+  DataChannelFecDecoder decoder(4);
+  std::vector<DataBuffer> received;
+  const uint8_t kEmpty[] = {0};
+  EXPECT_FALSE(decoder.OnMessageReceived(rtc::CopyOnWriteBuffer(kEmpty, 0),
+                                         true, &received));
+  const uint8_t kUnknownKind[] = {7, 0, 0, 0};
+  EXPECT_FALSE(decoder.OnMessageReceived(
+      rtc::CopyOnWriteBuffer(kUnknownKind, sizeof(kUnknownKind)), true,
+      &received));
+  const uint8_t kIndexTooLarge[] = {0, 0, 0, 4, 'x'};
+  EXPECT_FALSE(decoder.OnMessageReceived(
+      rtc::CopyOnWriteBuffer(kIndexTooLarge, sizeof(kIndexTooLarge)), true,
+      &received));
+  const uint8_t kWrongGroupSize[] = {1, 0, 0, 0, 5, 0xf0, 0};
+  EXPECT_FALSE(decoder.OnMessageReceived(
+      rtc::CopyOnWriteBuffer(kWrongGroupSize, sizeof(kWrongGroupSize)), true,
+      &received));
+  EXPECT_TRUE(received.empty());
+}
+
+}  // namespace webrtc
@@ -387,8 +387,11 @@ JsepTransportController::CreateDtlsTransport(const std::string& transport_name,
     auto ice = absl::make_unique<cricket::P2PTransportChannel>(
         transport_name, component, port_allocator_, async_resolver_factory_,
         config_.event_log);
-    dtls = absl::make_unique<cricket::DtlsTransport>(std::move(ice),
-                                                     config_.crypto_options);
+    auto dtls_transport = absl::make_unique<cricket::DtlsTransport>(
+        std::move(ice), config_.crypto_options);
+    dtls_transport->SetSessionCache(config_.dtls_session_cache);
+    dtls_transport->SetHandshakeOffloadPool(config_.dtls_handshake_pool);
+    dtls = std::move(dtls_transport);
   }
 
   RTC_DCHECK(dtls);
@@ -763,8 +766,8 @@ void JsepTransportController::RemoveTransportForMid(const std::string& mid) {
 
 cricket::JsepTransportDescription
 JsepTransportController::CreateJsepTransportDescription(
-    cricket::ContentInfo content_info,
-    cricket::TransportInfo transport_info,
+    const cricket::ContentInfo& content_info,
+    const cricket::TransportInfo& transport_info,
     const std::vector<int>& encrypted_extension_ids,
     int rtp_abs_sendtime_extn_id) {
   const cricket::MediaContentDescription* content_desc =
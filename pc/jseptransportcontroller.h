@@ -79,6 +79,12 @@ class JsepTransportController : public sigslot::has_slots<> {
     Observer* transport_observer = nullptr;
     bool active_reset_srtp_params = false;
     RtcEventLog* event_log = nullptr;
+    // Shared by the DTLS transports of all the PeerConnections of a factory
+    // to resume DTLS sessions. Not used with |external_transport_factory|.
+    rtc::SSLSessionCache* dtls_session_cache = nullptr;
+    // Runs the private key operations of the DTLS handshakes if set. Not used
+    // with |external_transport_factory|.
+    rtc::TaskPool* dtls_handshake_pool = nullptr;
   };
 
   // The ICE related events are signaled on the |signaling_thread|.
@@ -198,8 +204,8 @@ class JsepTransportController : public sigslot::has_slots<> {
   void RemoveTransportForMid(const std::string& mid);
 
   cricket::JsepTransportDescription CreateJsepTransportDescription(
-      cricket::ContentInfo content_info,
-      cricket::TransportInfo transport_info,
+      const cricket::ContentInfo& content_info,
+      const cricket::TransportInfo& transport_info,
       const std::vector<int>& encrypted_extension_ids,
       int rtp_abs_sendtime_extn_id);
 
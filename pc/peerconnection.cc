@@ -936,6 +936,8 @@ bool PeerConnection::Initialize(
   config.enable_external_auth = true;
 #endif
   config.active_reset_srtp_params = configuration.active_reset_srtp_params;
+  config.dtls_session_cache = factory_->dtls_session_cache();
+  config.dtls_handshake_pool = factory_->dtls_handshake_pool();
   transport_controller_.reset(new JsepTransportController(
       signaling_thread(), network_thread(), port_allocator_.get(),
       async_resolver_factory_.get(), config));
@@ -4638,62 +4640,76 @@ bool PeerConnection::InitializePortAllocator_n(
     const cricket::ServerAddresses& stun_servers,
     const std::vector<cricket::RelayServerConfig>& turn_servers,
     const RTCConfiguration& configuration) {
-  port_allocator_->Initialize();
+  port_allocator_flags_ =
+      ConfigurePortAllocator_n(port_allocator_.get(), stun_servers,
+                               turn_servers, configuration,
+                               tls_cert_verifier_.get());
+  return true;
+}
+
+// static
+uint32_t PeerConnection::ConfigurePortAllocator_n(
+    cricket::PortAllocator* port_allocator,
+    const cricket::ServerAddresses& stun_servers,
+    const std::vector<cricket::RelayServerConfig>& turn_servers,
+    const RTCConfiguration& configuration,
+    rtc::SSLCertificateVerifier* tls_cert_verifier) {
+  port_allocator->Initialize();
   // To handle both internal and externally created port allocator, we will
   // enable BUNDLE here.
-  port_allocator_flags_ = port_allocator_->flags();
-  port_allocator_flags_ |= cricket::PORTALLOCATOR_ENABLE_SHARED_SOCKET |
-                           cricket::PORTALLOCATOR_ENABLE_IPV6 |
-                           cricket::PORTALLOCATOR_ENABLE_IPV6_ON_WIFI;
+  uint32_t port_allocator_flags = port_allocator->flags();
+  port_allocator_flags |= cricket::PORTALLOCATOR_ENABLE_SHARED_SOCKET |
+                          cricket::PORTALLOCATOR_ENABLE_IPV6 |
+                          cricket::PORTALLOCATOR_ENABLE_IPV6_ON_WIFI;
   // If the disable-IPv6 flag was specified, we'll not override it
   // by experiment.
   if (configuration.disable_ipv6) {
-    port_allocator_flags_ &= ~(cricket::PORTALLOCATOR_ENABLE_IPV6);
+    port_allocator_flags &= ~(cricket::PORTALLOCATOR_ENABLE_IPV6);
   } else if (webrtc::field_trial::FindFullName("WebRTC-IPv6Default")
                  .find("Disabled") == 0) {
-    port_allocator_flags_ &= ~(cricket::PORTALLOCATOR_ENABLE_IPV6);
+    port_allocator_flags &= ~(cricket::PORTALLOCATOR_ENABLE_IPV6);
   }
 
   if (configuration.disable_ipv6_on_wifi) {
-    port_allocator_flags_ &= ~(cricket::PORTALLOCATOR_ENABLE_IPV6_ON_WIFI);
+    port_allocator_flags &= ~(cricket::PORTALLOCATOR_ENABLE_IPV6_ON_WIFI);
     RTC_LOG(LS_INFO) << "IPv6 candidates on Wi-Fi are disabled.";
   }
 
   if (configuration.tcp_candidate_policy == kTcpCandidatePolicyDisabled) {
-    port_allocator_flags_ |= cricket::PORTALLOCATOR_DISABLE_TCP;
+    port_allocator_flags |= cricket::PORTALLOCATOR_DISABLE_TCP;
     RTC_LOG(LS_INFO) << "TCP candidates are disabled.";
   }
 
   if (configuration.candidate_network_policy ==
       kCandidateNetworkPolicyLowCost) {
-    port_allocator_flags_ |= cricket::PORTALLOCATOR_DISABLE_COSTLY_NETWORKS;
+    port_allocator_flags |= cricket::PORTALLOCATOR_DISABLE_COSTLY_NETWORKS;
     RTC_LOG(LS_INFO) << "Do not gather candidates on high-cost networks";
   }
 
   if (configuration.disable_link_local_networks) {
-    port_allocator_flags_ |= cricket::PORTALLOCATOR_DISABLE_LINK_LOCAL_NETWORKS;
+    port_allocator_flags |= cricket::PORTALLOCATOR_DISABLE_LINK_LOCAL_NETWORKS;
     RTC_LOG(LS_INFO) << "Disable candidates on link-local network interfaces.";
   }
 
-  port_allocator_->set_flags(port_allocator_flags_);
+  port_allocator->set_flags(port_allocator_flags);
   // No step delay is used while allocating ports.
-  port_allocator_->set_step_delay(cricket::kMinimumStepDelay);
-  port_allocator_->set_candidate_filter(
+  port_allocator->set_step_delay(cricket::kMinimumStepDelay);
+  port_allocator->set_candidate_filter(
       ConvertIceTransportTypeToCandidateFilter(configuration.type));
-  port_allocator_->set_max_ipv6_networks(configuration.max_ipv6_networks);
+  port_allocator->set_max_ipv6_networks(configuration.max_ipv6_networks);
 
   auto turn_servers_copy = turn_servers;
   for (auto& turn_server : turn_servers_copy) {
-    turn_server.tls_cert_verifier = tls_cert_verifier_.get();
+    turn_server.tls_cert_verifier = tls_cert_verifier;
   }
   // Call this last since it may create pooled allocator sessions using the
   // properties set above.
-  port_allocator_->SetConfiguration(
+  port_allocator->SetConfiguration(
       stun_servers, std::move(turn_servers_copy),
       configuration.ice_candidate_pool_size, configuration.prune_turn_ports,
       configuration.turn_customizer,
       configuration.stun_candidate_keepalive_interval);
-  return true;
+  return port_allocator_flags;
 }
 
 bool PeerConnection::ReconfigurePortAllocator_n(
@@ -6235,6 +6251,14 @@ PeerConnectionObserver* PeerConnection::Observer() const {
   return observer_;
 }
 
+void PeerConnection::GetStatsDelta(
+    rtc::scoped_refptr<RTCStatsDeltaCallback> callback) {
+  TRACE_EVENT0("webrtc", "PeerConnection::GetStatsDelta");
+  RTC_DCHECK(stats_collector_);
+  RTC_DCHECK(callback);
+  stats_collector_->GetStatsReportDelta(std::move(callback));
+}
+
 void PeerConnection::ClearStatsCache() {
   if (stats_collector_) {
     stats_collector_->ClearCachedStatsReport();
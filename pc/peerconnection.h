@@ -79,6 +79,16 @@ class PeerConnection : public PeerConnectionInternal,
       const PeerConnectionInterface::RTCConfiguration& configuration,
       PeerConnectionDependencies dependencies);
 
+  // Applies the parts of |configuration| that affect candidate gathering to
+  // |port_allocator|, which starts gathering its pooled sessions, and returns
+  // the resulting port allocator flags. Must be called on the network thread.
+  static uint32_t ConfigurePortAllocator_n(
+      cricket::PortAllocator* port_allocator,
+      const cricket::ServerAddresses& stun_servers,
+      const std::vector<cricket::RelayServerConfig>& turn_servers,
+      const RTCConfiguration& configuration,
+      rtc::SSLCertificateVerifier* tls_cert_verifier);
+
   rtc::scoped_refptr<StreamCollectionInterface> local_streams() override;
   rtc::scoped_refptr<StreamCollectionInterface> remote_streams() override;
   bool AddStream(MediaStreamInterface* local_stream) override;
@@ -140,6 +150,8 @@ class PeerConnection : public PeerConnectionInternal,
   void GetStats(
       rtc::scoped_refptr<RtpReceiverInterface> selector,
       rtc::scoped_refptr<RTCStatsCollectorCallback> callback) override;
+  void GetStatsDelta(
+      rtc::scoped_refptr<RTCStatsDeltaCallback> callback) override;
   void ClearStatsCache() override;
 
   SignalingState signaling_state() override;
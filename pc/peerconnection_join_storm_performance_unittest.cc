@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/audio_codecs/builtin_audio_encoder_factory.h"
+#include "api/video_codecs/builtin_video_decoder_factory.h"
+#include "api/video_codecs/builtin_video_encoder_factory.h"
+#include "pc/peerconnectionwrapper.h"
+#include "pc/test/fakeaudiocapturemodule.h"
+#include "pc/test/mockpeerconnectionobservers.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+
+namespace {
+
+using RTCConfiguration = PeerConnectionInterface::RTCConfiguration;
+
+constexpr int kNumPeerConnections = 50;
+constexpr int kPoolSize = 10;
+// Time for the pools to fill before the storm, as between storms.
+constexpr int kWarmUpMs = 1000;
+
+}  // namespace
+
+// Measures how many PeerConnections per second a factory can create and have
+// ready to create an offer, when they all join at once with the same
+// configuration and the factory's default certificate generator and port
+// allocator.
+class PeerConnectionJoinStormPerformanceTest : public ::testing::Test {
+ public:
+  PeerConnectionJoinStormPerformanceTest()
+      : network_thread_(rtc::Thread::CreateWithSocketServer()),
+        worker_thread_(rtc::Thread::Create()) {
+    network_thread_->SetName("PCNetworkThread", this);
+    worker_thread_->SetName("PCWorkerThread", this);
+    RTC_CHECK(network_thread_->Start());
+    RTC_CHECK(worker_thread_->Start());
+  }
+
+  void MeasureJoinStorm(
+      const std::string& trace,
+      const PeerConnectionFactoryInterface::Options& options) {
+    rtc::scoped_refptr<PeerConnectionFactoryInterface> pc_factory =
+        CreatePeerConnectionFactory(
+            network_thread_.get(), worker_thread_.get(), rtc::Thread::Current(),
+            rtc::scoped_refptr<AudioDeviceModule>(
+                FakeAudioCaptureModule::Create()),
+            CreateBuiltinAudioEncoderFactory(),
+            CreateBuiltinAudioDecoderFactory(),
+            CreateBuiltinVideoEncoderFactory(),
+            CreateBuiltinVideoDecoderFactory(), nullptr /* audio_mixer */,
+            nullptr /* audio_processing */);
+    pc_factory->SetOptions(options);
+
+    RTCConfiguration config;
+    config.sdp_semantics = SdpSemantics::kUnifiedPlan;
+    config.bundle_policy = PeerConnectionInterface::kBundlePolicyMaxBundle;
+    config.ice_candidate_pool_size = 1;
+
+    // The first PeerConnection tells the factory what to expect.
+    std::vector<std::unique_ptr<PeerConnectionWrapper>> pcs;
+    pcs.push_back(CreatePeerConnectionWrapper(pc_factory, config));
+    ASSERT_TRUE(pcs.back());
+    rtc::Thread::Current()->ProcessMessages(kWarmUpMs);
+
+    const int64_t start_us = rtc::TimeMicros();
+    for (int i = 0; i < kNumPeerConnections; ++i) {
+      pcs.push_back(CreatePeerConnectionWrapper(pc_factory, config));
+      ASSERT_TRUE(pcs.back());
+      pcs.back()->AddTransceiver(cricket::MEDIA_TYPE_AUDIO);
+      ASSERT_TRUE(pcs.back()->CreateOffer());
+    }
+    const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+
+    const double pcs_per_second =
+        kNumPeerConnections * static_cast<double>(rtc::kNumMicrosecsPerSec) /
+        elapsed_us;
+    test::PrintResult("join_storm_rate", "", trace, pcs_per_second, "PCs/s",
+                      true);
+  }
+
+ private:
+  std::unique_ptr<PeerConnectionWrapper> CreatePeerConnectionWrapper(
+      const rtc::scoped_refptr<PeerConnectionFactoryInterface>& pc_factory,
+      const RTCConfiguration& config) {
+    auto observer = absl::make_unique<MockPeerConnectionObserver>();
+    auto pc = pc_factory->CreatePeerConnection(
+        config, PeerConnectionDependencies(observer.get()));
+    if (!pc) {
+      return nullptr;
+    }
+    return absl::make_unique<PeerConnectionWrapper>(pc_factory, pc,
+                                                    std::move(observer));
+  }
+
+  std::unique_ptr<rtc::Thread> network_thread_;
+  std::unique_ptr<rtc::Thread> worker_thread_;
+};
+
+TEST_F(PeerConnectionJoinStormPerformanceTest, CreatePeerConnections) {
+  PeerConnectionFactoryInterface::Options options;
+  MeasureJoinStorm("no_pools", options);
+
+  options.certificate_pool_size = kPoolSize;
+  MeasureJoinStorm("certificate_pool", options);
+
+  options.port_allocator_pool_size = kPoolSize;
+  MeasureJoinStorm("certificate_and_port_allocator_pools", options);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/audio_codecs/builtin_audio_encoder_factory.h"
+#include "api/video_codecs/builtin_video_decoder_factory.h"
+#include "api/video_codecs/builtin_video_encoder_factory.h"
+#include "p2p/client/basicportallocator.h"
+#include "pc/peerconnectionwrapper.h"
+#include "pc/test/fakeaudiocapturemodule.h"
+#include "pc/test/mockpeerconnectionobservers.h"
+#include "rtc_base/fakenetwork.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+
+namespace {
+
+using RTCConfiguration = PeerConnectionInterface::RTCConfiguration;
+
+constexpr int kNumRenegotiations = 10;
+const rtc::SocketAddress kDefaultLocalAddress("1.1.1.1", 0);
+
+}  // namespace
+
+// Measures the latency of the offer/answer exchange that adds one transceiver
+// to a bundled Unified Plan session, against the number of m= sections the
+// session already has. The m= sections that did not change should not add to
+// the cost.
+class PeerConnectionRenegotiationPerformanceTest : public ::testing::Test {
+ public:
+  PeerConnectionRenegotiationPerformanceTest()
+      : virtual_socket_server_(new rtc::VirtualSocketServer()),
+        network_thread_(new rtc::Thread(virtual_socket_server_.get())),
+        worker_thread_(rtc::Thread::Create()) {
+    network_thread_->SetName("PCNetworkThread", this);
+    worker_thread_->SetName("PCWorkerThread", this);
+    RTC_CHECK(network_thread_->Start());
+    RTC_CHECK(worker_thread_->Start());
+
+    pc_factory_ = CreatePeerConnectionFactory(
+        network_thread_.get(), worker_thread_.get(), rtc::Thread::Current(),
+        rtc::scoped_refptr<AudioDeviceModule>(FakeAudioCaptureModule::Create()),
+        CreateBuiltinAudioEncoderFactory(), CreateBuiltinAudioDecoderFactory(),
+        CreateBuiltinVideoEncoderFactory(), CreateBuiltinVideoDecoderFactory(),
+        nullptr /* audio_mixer */, nullptr /* audio_processing */);
+  }
+
+  std::unique_ptr<PeerConnectionWrapper> CreatePeerConnectionWrapper() {
+    auto* fake_network_manager = new rtc::FakeNetworkManager();
+    fake_network_manager->AddInterface(kDefaultLocalAddress);
+    fake_network_managers_.emplace_back(fake_network_manager);
+
+    auto observer = absl::make_unique<MockPeerConnectionObserver>();
+    PeerConnectionDependencies dependencies(observer.get());
+    dependencies.allocator =
+        absl::make_unique<cricket::BasicPortAllocator>(fake_network_manager);
+
+    RTCConfiguration config;
+    config.sdp_semantics = SdpSemantics::kUnifiedPlan;
+    config.bundle_policy = PeerConnectionInterface::kBundlePolicyMaxBundle;
+    auto pc =
+        pc_factory_->CreatePeerConnection(config, std::move(dependencies));
+    if (!pc) {
+      return nullptr;
+    }
+    return absl::make_unique<PeerConnectionWrapper>(pc_factory_, pc,
+                                                    std::move(observer));
+  }
+
+  void MeasureRenegotiation(int num_m_sections) {
+    std::unique_ptr<PeerConnectionWrapper> caller =
+        CreatePeerConnectionWrapper();
+    std::unique_ptr<PeerConnectionWrapper> callee =
+        CreatePeerConnectionWrapper();
+    ASSERT_TRUE(caller);
+    ASSERT_TRUE(callee);
+    for (int i = 0; i < num_m_sections; ++i) {
+      caller->AddTransceiver(i % 2 == 0 ? cricket::MEDIA_TYPE_AUDIO
+                                        : cricket::MEDIA_TYPE_VIDEO);
+    }
+    ASSERT_TRUE(caller->ExchangeOfferAnswerWith(callee.get()));
+
+    int64_t elapsed_us = 0;
+    for (int i = 0; i < kNumRenegotiations; ++i) {
+      caller->AddTransceiver(cricket::MEDIA_TYPE_AUDIO);
+      const int64_t start_us = rtc::TimeMicros();
+      ASSERT_TRUE(caller->ExchangeOfferAnswerWith(callee.get()));
+      elapsed_us += rtc::TimeMicros() - start_us;
+    }
+
+    const std::string trace = std::to_string(num_m_sections) + "_m_sections";
+    test::PrintResult(
+        "renegotiation_time", "", trace,
+        static_cast<double>(elapsed_us) / kNumRenegotiations / 1000, "ms",
+        true);
+  }
+
+ private:
+  std::unique_ptr<rtc::VirtualSocketServer> virtual_socket_server_;
+  std::unique_ptr<rtc::Thread> network_thread_;
+  std::unique_ptr<rtc::Thread> worker_thread_;
+  rtc::scoped_refptr<PeerConnectionFactoryInterface> pc_factory_;
+  std::vector<std::unique_ptr<rtc::FakeNetworkManager>> fake_network_managers_;
+};
+
+TEST_F(PeerConnectionRenegotiationPerformanceTest, AddTransceiver) {
+  MeasureRenegotiation(2);
+  MeasureRenegotiation(20);
+  MeasureRenegotiation(200);
+}
+
+}  // namespace webrtc
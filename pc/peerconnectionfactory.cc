@@ -10,6 +10,7 @@
 
 #include "pc/peerconnectionfactory.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -28,6 +29,9 @@
 #include "pc/rtpparametersconversion.h"
 #include "rtc_base/bind.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/task_pool.h"
+#include "system_wrappers/include/field_trial.h"
 // Adding 'nogncheck' to disable the gn include headers check to support modular
 // WebRTC build targets.
 // TODO(zhihuang): This wouldn't be necessary if the interface and
@@ -193,6 +197,10 @@ PeerConnectionFactory::~PeerConnectionFactory() {
   RTC_DCHECK(signaling_thread_->IsCurrent());
   channel_manager_.reset(nullptr);
 
+  // The warm port allocators gather candidates on the network thread.
+  network_thread_->Invoke<void>(RTC_FROM_HERE,
+                                [this] { port_allocator_pool_.reset(); });
+
   // Make sure |worker_thread_| and |signaling_thread_| outlive
   // |default_socket_factory_| and |default_network_manager_|.
   default_socket_factory_ = nullptr;
@@ -226,11 +234,39 @@ bool PeerConnectionFactory::Initialize() {
     return false;
   }
 
+  port_allocator_pool_ = absl::make_unique<PortAllocatorPool>(
+      network_thread_, default_network_manager_.get(),
+      default_socket_factory_.get());
   return true;
 }
 
 void PeerConnectionFactory::SetOptions(const Options& options) {
   options_ = options;
+  if (options_.certificate_pool_size > 0) {
+    // Start generating the certificates now rather than at the first
+    // PeerConnection.
+    if (!certificate_pool_) {
+      certificate_pool_ = new rtc::RefCountedObject<CertificatePool>(
+          absl::make_unique<rtc::RTCCertificateGenerator>(signaling_thread_,
+                                                          network_thread_));
+    }
+    certificate_pool_->Fill(options_.certificate_pool_size);
+  }
+}
+
+rtc::SSLSessionCache* PeerConnectionFactory::dtls_session_cache() {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  if (!options_.enable_dtls_session_resumption) {
+    return nullptr;
+  }
+  if (!dtls_session_cache_) {
+    dtls_session_cache_ = rtc::SSLSessionCache::CreateForDtls();
+  }
+  return dtls_session_cache_.get();
+}
+
+rtc::TaskPool* PeerConnectionFactory::dtls_handshake_pool() const {
+  return options_.offload_dtls_handshakes ? rtc::TaskPool::Default() : nullptr;
 }
 
 RtpCapabilities PeerConnectionFactory::GetRtpSenderCapabilities(
@@ -349,13 +385,32 @@ PeerConnectionFactory::CreatePeerConnection(
     PeerConnectionDependencies dependencies) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
 
-  // Set internal defaults if optional dependencies are not set.
+  // Give the PeerConnection a certificate generated ahead of time, unless it
+  // brings its own. It is handed out by the certificate generator rather than
+  // put in the configuration, which stays the one the application gave.
   if (!dependencies.cert_generator) {
     dependencies.cert_generator =
         absl::make_unique<rtc::RTCCertificateGenerator>(signaling_thread_,
                                                         network_thread_);
+    if (certificate_pool_ && configuration.certificates.empty()) {
+      rtc::scoped_refptr<rtc::RTCCertificate> certificate =
+          certificate_pool_->Take();
+      certificate_pool_->Fill(std::max(options_.certificate_pool_size, 0));
+      if (certificate) {
+        dependencies.cert_generator =
+            absl::make_unique<PooledCertificateGenerator>(
+                signaling_thread_, certificate,
+                std::move(dependencies.cert_generator));
+      }
+    }
   }
-  if (!dependencies.allocator) {
+  // A warm port allocator has gathered its pooled sessions without a TLS
+  // certificate verifier for its TURN servers.
+  const bool use_warm_port_allocator =
+      !dependencies.allocator && !dependencies.tls_cert_verifier &&
+      options_.port_allocator_pool_size > 0 &&
+      configuration.ice_candidate_pool_size > 0;
+  if (!dependencies.allocator && !use_warm_port_allocator) {
     dependencies.allocator.reset(new cricket::BasicPortAllocator(
         default_network_manager_.get(), default_socket_factory_.get(),
         configuration.turn_customizer));
@@ -365,19 +420,27 @@ PeerConnectionFactory::CreatePeerConnection(
   // |dependencies.async_resolver_factory| to a new
   // |rtc::BasicAsyncResolverFactory| if no factory is provided.
 
-  network_thread_->Invoke<void>(
-      RTC_FROM_HERE,
-      rtc::Bind(&cricket::PortAllocator::SetNetworkIgnoreMask,
-                dependencies.allocator.get(), options_.network_ignore_mask));
-
-  std::unique_ptr<RtcEventLog> event_log =
-      worker_thread_->Invoke<std::unique_ptr<RtcEventLog>>(
-          RTC_FROM_HERE,
-          rtc::Bind(&PeerConnectionFactory::CreateRtcEventLog_w, this));
+  network_thread_->Invoke<void>(RTC_FROM_HERE, [&] {
+    if (use_warm_port_allocator) {
+      dependencies.allocator = port_allocator_pool_->Take(
+          configuration, options_.network_ignore_mask,
+          options_.port_allocator_pool_size);
+      if (!dependencies.allocator) {
+        dependencies.allocator.reset(new cricket::BasicPortAllocator(
+            default_network_manager_.get(), default_socket_factory_.get(),
+            configuration.turn_customizer));
+      }
+    }
+    dependencies.allocator->SetNetworkIgnoreMask(options_.network_ignore_mask);
+  });
 
-  std::unique_ptr<Call> call = worker_thread_->Invoke<std::unique_ptr<Call>>(
-      RTC_FROM_HERE,
-      rtc::Bind(&PeerConnectionFactory::CreateCall_w, this, event_log.get()));
+  // Create the event log and the call in a single trip to the worker thread.
+  std::unique_ptr<RtcEventLog> event_log;
+  std::unique_ptr<Call> call;
+  worker_thread_->Invoke<void>(RTC_FROM_HERE, [&] {
+    event_log = CreateRtcEventLog_w();
+    call = CreateCall_w(event_log.get());
+  });
 
   rtc::scoped_refptr<PeerConnection> pc(
       new rtc::RefCountedObject<PeerConnection>(this, std::move(event_log),
@@ -416,7 +479,21 @@ rtc::scoped_refptr<AudioTrackInterface> PeerConnectionFactory::CreateAudioTrack(
 std::unique_ptr<cricket::SctpTransportInternalFactory>
 PeerConnectionFactory::CreateSctpTransportInternalFactory() {
 #ifdef HAVE_SCTP
-  return absl::make_unique<cricket::SctpTransportFactory>(network_thread());
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  if (options_.sctp_thread_count <= 0) {
+    return absl::make_unique<cricket::SctpTransportFactory>(network_thread());
+  }
+  while (sctp_threads_.size() <
+         static_cast<size_t>(options_.sctp_thread_count)) {
+    sctp_threads_.push_back(rtc::Thread::Create());
+    sctp_threads_.back()->SetName("sctp_thread", sctp_threads_.back().get());
+    sctp_threads_.back()->Start();
+  }
+  // Spread the PeerConnections over the threads.
+  rtc::Thread* sctp_thread =
+      sctp_threads_[next_sctp_thread_++ % options_.sctp_thread_count].get();
+  return absl::make_unique<cricket::SctpTransportFactory>(network_thread(),
+                                                          sctp_thread);
 #else
   return nullptr;
 #endif
@@ -442,7 +519,10 @@ rtc::Thread* PeerConnectionFactory::network_thread() {
 
 std::unique_ptr<RtcEventLog> PeerConnectionFactory::CreateRtcEventLog_w() {
   RTC_DCHECK_RUN_ON(worker_thread_);
-  const auto encoding_type = RtcEventLog::EncodingType::Legacy;
+  const auto encoding_type =
+      field_trial::IsEnabled("WebRTC-RtcEventLogNewFormat")
+          ? RtcEventLog::EncodingType::NewFormat
+          : RtcEventLog::EncodingType::Legacy;
   return event_log_factory_
              ? event_log_factory_->CreateRtcEventLog(encoding_type)
              : absl::make_unique<RtcEventLogNullImpl>();
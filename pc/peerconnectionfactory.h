@@ -14,13 +14,17 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "api/mediastreaminterface.h"
 #include "api/peerconnectioninterface.h"
 #include "media/sctp/sctptransportinternal.h"
+#include "pc/certificatepool.h"
 #include "pc/channelmanager.h"
+#include "pc/portallocatorpool.h"
 #include "rtc_base/rtccertificategenerator.h"
 #include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/sslstreamadapter.h"
 #include "rtc_base/thread.h"
 
 namespace rtc {
@@ -95,6 +99,12 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
   virtual rtc::Thread* worker_thread();
   virtual rtc::Thread* network_thread();
   const Options& options() const { return options_; }
+  // Returns the DTLS session cache shared by the created PeerConnections, or
+  // null if DTLS session resumption is disabled.
+  rtc::SSLSessionCache* dtls_session_cache();
+  // Returns the pool for the private key operations of DTLS handshakes, or
+  // null if they are not offloaded.
+  rtc::TaskPool* dtls_handshake_pool() const;
 
  protected:
   PeerConnectionFactory(
@@ -136,7 +146,19 @@ class PeerConnectionFactory : public PeerConnectionFactoryInterface {
   rtc::Thread* signaling_thread_;
   std::unique_ptr<rtc::Thread> owned_network_thread_;
   std::unique_ptr<rtc::Thread> owned_worker_thread_;
+  // Created on demand when |options_.sctp_thread_count| is positive.
+  std::vector<std::unique_ptr<rtc::Thread>> sctp_threads_;
+  size_t next_sctp_thread_ = 0;
   Options options_;
+  // Created on demand when |options_.certificate_pool_size| is positive.
+  rtc::scoped_refptr<CertificatePool> certificate_pool_;
+  // Created on demand when |options_.enable_dtls_session_resumption| is true.
+  // Used on the network thread.
+  std::unique_ptr<rtc::SSLSessionCache> dtls_session_cache_;
+  // Port allocators that gather candidates ahead of time when
+  // |options_.port_allocator_pool_size| is positive. Used on the network
+  // thread.
+  std::unique_ptr<PortAllocatorPool> port_allocator_pool_;
   std::unique_ptr<cricket::ChannelManager> channel_manager_;
   std::unique_ptr<rtc::BasicNetworkManager> default_network_manager_;
   std::unique_ptr<rtc::BasicPacketSocketFactory> default_socket_factory_;
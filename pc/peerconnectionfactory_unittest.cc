@@ -426,6 +426,30 @@ TEST_F(PeerConnectionFactoryTest, CreatePCUsingIPLiteralAddress) {
   VerifyTurnServers(turn_servers);
 }
 
+// A PeerConnection that gets a certificate from the factory's certificate pool
+// keeps the configuration it was created with, so it can be set again.
+TEST_F(PeerConnectionFactoryTest, CreatePCWithCertificatePool) {
+  PeerConnectionFactoryInterface::Options options;
+  options.certificate_pool_size = 1;
+  factory_->SetOptions(options);
+  // Let the pool generate its certificate.
+  rtc::Thread::Current()->ProcessMessages(100);
+
+  PeerConnectionInterface::RTCConfiguration config;
+  webrtc::PeerConnectionInterface::IceServer ice_server;
+  ice_server.uri = kStunIceServer;
+  config.servers.push_back(ice_server);
+  rtc::scoped_refptr<PeerConnectionInterface> pc(
+      factory_->CreatePeerConnection(config, std::move(port_allocator_),
+                                     nullptr, &observer_));
+  ASSERT_TRUE(pc.get() != NULL);
+  EXPECT_TRUE(pc->GetConfiguration().certificates.empty());
+
+  webrtc::RTCError error;
+  EXPECT_TRUE(pc->SetConfiguration(config, &error));
+  EXPECT_TRUE(error.ok());
+}
+
 // This test verifies the captured stream is rendered locally using a
 // local video track.
 TEST_F(PeerConnectionFactoryTest, LocalRendering) {
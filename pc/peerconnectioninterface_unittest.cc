@@ -1624,6 +1624,26 @@ TEST_P(PeerConnectionInterfaceTest, AddTrackBeforeConnecting) {
   EXPECT_TRUE(DoGetStats(nullptr));
 }
 
+// Test that GetStatsDelta() delivers every stats object first, and then only
+// the ones that changed.
+TEST_P(PeerConnectionInterfaceTest, GetStatsDelta) {
+  CreatePeerConnectionWithoutDtls();
+  rtc::scoped_refptr<webrtc::MockRTCStatsDeltaCallback> callback(
+      new rtc::RefCountedObject<webrtc::MockRTCStatsDeltaCallback>());
+  pc_->GetStatsDelta(callback);
+  EXPECT_TRUE_WAIT(callback->called(), kTimeout);
+  ASSERT_TRUE(callback->delta());
+  EXPECT_TRUE(callback->delta()->Get("RTCPeerConnection"));
+
+  pc_->ClearStatsCache();
+  callback = new rtc::RefCountedObject<webrtc::MockRTCStatsDeltaCallback>();
+  pc_->GetStatsDelta(callback);
+  EXPECT_TRUE_WAIT(callback->called(), kTimeout);
+  ASSERT_TRUE(callback->delta());
+  EXPECT_FALSE(callback->delta()->Get("RTCPeerConnection"));
+  EXPECT_TRUE(callback->removed_ids().empty());
+}
+
 TEST_P(PeerConnectionInterfaceTest, AttachmentIdIsSetOnAddTrack) {
   CreatePeerConnectionWithoutDtls();
   rtc::scoped_refptr<AudioTrackInterface> audio_track(
@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/portallocatorpool.h"
+
+#include <utility>
+
+#include "p2p/client/basicportallocator.h"
+#include "pc/iceserverparsing.h"
+#include "pc/peerconnection.h"
+#include "rtc_base/bind.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+PortAllocatorPool::PortAllocatorPool(rtc::Thread* network_thread,
+                                     rtc::NetworkManager* network_manager,
+                                     rtc::PacketSocketFactory* socket_factory)
+    : network_thread_(network_thread),
+      network_manager_(network_manager),
+      socket_factory_(socket_factory) {
+  RTC_DCHECK(network_thread_);
+  RTC_DCHECK(network_manager_);
+}
+
+PortAllocatorPool::~PortAllocatorPool() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+}
+
+std::unique_ptr<cricket::PortAllocator> PortAllocatorPool::Take(
+    const PeerConnectionInterface::RTCConfiguration& configuration,
+    int network_ignore_mask,
+    size_t pool_size) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  std::unique_ptr<cricket::PortAllocator> port_allocator;
+  size_t num_to_add = 1;
+  if (configuration == configuration_ &&
+      network_ignore_mask == network_ignore_mask_) {
+    if (!port_allocators_.empty()) {
+      port_allocator = std::move(port_allocators_.back());
+      port_allocators_.pop_back();
+    }
+  } else {
+    // Expect the next PeerConnections to look like this one.
+    port_allocators_.clear();
+    configuration_ = configuration;
+    network_ignore_mask_ = network_ignore_mask;
+    num_to_add = pool_size;
+  }
+  pool_size_ = pool_size;
+  // One at a time, to not hold up the network thread.
+  for (size_t i = 0; i < num_to_add; ++i) {
+    invoker_.AsyncInvoke<void>(RTC_FROM_HERE, network_thread_,
+                               rtc::Bind(&PortAllocatorPool::Add, this));
+  }
+  return port_allocator;
+}
+
+size_t PortAllocatorPool::size() const {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  return port_allocators_.size();
+}
+
+void PortAllocatorPool::Add() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  if (port_allocators_.size() >= pool_size_)
+    return;
+  cricket::ServerAddresses stun_servers;
+  std::vector<cricket::RelayServerConfig> turn_servers;
+  if (ParseIceServers(configuration_.servers, &stun_servers, &turn_servers) !=
+      RTCErrorType::NONE) {
+    return;
+  }
+  std::unique_ptr<cricket::PortAllocator> port_allocator(
+      new cricket::BasicPortAllocator(network_manager_, socket_factory_,
+                                      configuration_.turn_customizer));
+  port_allocator->SetNetworkIgnoreMask(network_ignore_mask_);
+  // The same as the PeerConnection will do, so that it keeps the pooled
+  // sessions.
+  PeerConnection::ConfigurePortAllocator_n(port_allocator.get(), stun_servers,
+                                           turn_servers, configuration_,
+                                           nullptr);
+  port_allocators_.push_back(std::move(port_allocator));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef PC_PORTALLOCATORPOOL_H_
+#define PC_PORTALLOCATORPOOL_H_
+
+#include <memory>
+#include <vector>
+
+#include "api/peerconnectioninterface.h"
+#include "p2p/base/packetsocketfactory.h"
+#include "p2p/base/portallocator.h"
+#include "rtc_base/asyncinvoker.h"
+#include "rtc_base/network.h"
+#include "rtc_base/thread.h"
+
+namespace webrtc {
+
+// Port allocators that have started gathering the pooled candidates of a
+// configuration ahead of time, so that a PeerConnection created with the same
+// configuration can use them right away. The pool expects the next
+// PeerConnections to look like the last one it was asked for. Created on any
+// thread, used and destroyed on the network thread.
+class PortAllocatorPool {
+ public:
+  PortAllocatorPool(rtc::Thread* network_thread,
+                    rtc::NetworkManager* network_manager,
+                    rtc::PacketSocketFactory* socket_factory);
+  ~PortAllocatorPool();
+
+  // Returns a port allocator that has started gathering candidates for
+  // |configuration| with |network_ignore_mask|, or null if there is none, and
+  // tops up the pool to |pool_size| port allocators for that configuration
+  // asynchronously.
+  std::unique_ptr<cricket::PortAllocator> Take(
+      const PeerConnectionInterface::RTCConfiguration& configuration,
+      int network_ignore_mask,
+      size_t pool_size);
+
+  size_t size() const;
+
+ private:
+  void Add();
+
+  rtc::Thread* const network_thread_;
+  rtc::NetworkManager* const network_manager_;
+  rtc::PacketSocketFactory* const socket_factory_;
+  std::vector<std::unique_ptr<cricket::PortAllocator>> port_allocators_;
+  PeerConnectionInterface::RTCConfiguration configuration_;
+  int network_ignore_mask_ = 0;
+  size_t pool_size_ = 0;
+  // Destroyed first, to not top up a pool that is going away.
+  rtc::AsyncInvoker invoker_;
+};
+
+}  // namespace webrtc
+
+#endif  // PC_PORTALLOCATORPOOL_H_
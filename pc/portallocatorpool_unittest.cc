@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+
+#include "p2p/base/basicpacketsocketfactory.h"
+#include "pc/portallocatorpool.h"
+#include "rtc_base/fakenetwork.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/thread.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kTimeoutMs = 1000;
+
+PeerConnectionInterface::RTCConfiguration CreateConfiguration(
+    const std::string& stun_uri) {
+  PeerConnectionInterface::RTCConfiguration configuration;
+  PeerConnectionInterface::IceServer server;
+  server.uri = stun_uri;
+  configuration.servers.push_back(server);
+  configuration.ice_candidate_pool_size = 1;
+  return configuration;
+}
+
+}  // namespace
+
+class PortAllocatorPoolTest : public testing::Test {
+ protected:
+  PortAllocatorPoolTest()
+      : socket_factory_(rtc::Thread::Current()),
+        pool_(rtc::Thread::Current(), &network_manager_, &socket_factory_) {}
+
+  rtc::FakeNetworkManager network_manager_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  PortAllocatorPool pool_;
+};
+
+TEST_F(PortAllocatorPoolTest, FillsPoolForLastConfiguration) {
+  const PeerConnectionInterface::RTCConfiguration configuration =
+      CreateConfiguration("stun:1.2.3.4:1234");
+  // Nothing is warm for the first PeerConnection.
+  EXPECT_FALSE(pool_.Take(configuration, 0, 2));
+  EXPECT_EQ(0u, pool_.size());
+  EXPECT_EQ_WAIT(2u, pool_.size(), kTimeoutMs);
+
+  std::unique_ptr<cricket::PortAllocator> port_allocator =
+      pool_.Take(configuration, 0, 2);
+  ASSERT_TRUE(port_allocator);
+  EXPECT_EQ(1, port_allocator->candidate_pool_size());
+  EXPECT_EQ(1u, port_allocator->stun_servers().size());
+  EXPECT_EQ(1u, pool_.size());
+  // Topped up again.
+  EXPECT_EQ_WAIT(2u, pool_.size(), kTimeoutMs);
+}
+
+TEST_F(PortAllocatorPoolTest, DifferentConfigurationEmptiesPool) {
+  const PeerConnectionInterface::RTCConfiguration configuration =
+      CreateConfiguration("stun:1.2.3.4:1234");
+  pool_.Take(configuration, 0, 1);
+  EXPECT_EQ_WAIT(1u, pool_.size(), kTimeoutMs);
+
+  EXPECT_FALSE(pool_.Take(CreateConfiguration("stun:5.6.7.8:1234"), 0, 1));
+  EXPECT_EQ(0u, pool_.size());
+  EXPECT_EQ_WAIT(1u, pool_.size(), kTimeoutMs);
+
+  // The network ignore mask has to match as well.
+  EXPECT_FALSE(pool_.Take(CreateConfiguration("stun:5.6.7.8:1234"),
+                          rtc::ADAPTER_TYPE_WIFI, 1));
+  EXPECT_EQ(0u, pool_.size());
+}
+
+TEST_F(PortAllocatorPoolTest, DoesNotGrowBeyondPoolSize) {
+  const PeerConnectionInterface::RTCConfiguration configuration =
+      CreateConfiguration("stun:1.2.3.4:1234");
+  pool_.Take(configuration, 0, 2);
+  EXPECT_EQ_WAIT(2u, pool_.size(), kTimeoutMs);
+
+  // Shrinking the pool takes effect on the next top-up.
+  EXPECT_TRUE(pool_.Take(configuration, 0, 1));
+  rtc::Thread::Current()->ProcessMessages(100);
+  EXPECT_EQ(1u, pool_.size());
+}
+
+}  // namespace webrtc
@@ -431,6 +431,8 @@ class RTCStatsReportVerifier {
     verifier.TestMemberIsNonNegative<uint64_t>(data_channel.bytes_sent);
     verifier.TestMemberIsNonNegative<uint32_t>(data_channel.messages_received);
     verifier.TestMemberIsNonNegative<uint64_t>(data_channel.bytes_received);
+    verifier.TestMemberIsUndefined(data_channel.fec_messages_recovered);
+    verifier.TestMemberIsUndefined(data_channel.fec_messages_unrecovered);
     return verifier.ExpectAllMembersSuccessfullyTested();
   }
 
@@ -698,6 +698,12 @@ RTCStatsCollector::RequestInfo::RequestInfo(
                   nullptr,
                   std::move(selector)) {}
 
+RTCStatsCollector::RequestInfo::RequestInfo(
+    rtc::scoped_refptr<RTCStatsDeltaCallback> callback)
+    : filter_mode_(FilterMode::kDelta), delta_callback_(std::move(callback)) {
+  RTC_DCHECK(delta_callback_);
+}
+
 RTCStatsCollector::RequestInfo::RequestInfo(
     RTCStatsCollector::RequestInfo::FilterMode filter_mode,
     rtc::scoped_refptr<RTCStatsCollectorCallback> callback,
@@ -758,6 +764,11 @@ void RTCStatsCollector::GetStatsReport(
   GetStatsReportInternal(RequestInfo(std::move(selector), std::move(callback)));
 }
 
+void RTCStatsCollector::GetStatsReportDelta(
+    rtc::scoped_refptr<RTCStatsDeltaCallback> callback) {
+  GetStatsReportInternal(RequestInfo(std::move(callback)));
+}
+
 void RTCStatsCollector::GetStatsReportInternal(
     RTCStatsCollector::RequestInfo request) {
   RTC_DCHECK(signaling_thread_->IsCurrent());
@@ -913,6 +924,8 @@ void RTCStatsCollector::DeliverCachedReport(
   for (const RequestInfo& request : requests) {
     if (request.filter_mode() == RequestInfo::FilterMode::kAll) {
       request.callback()->OnStatsDelivered(cached_report);
+    } else if (request.filter_mode() == RequestInfo::FilterMode::kDelta) {
+      DeliverStatsDelta(cached_report, request.delta_callback());
     } else {
       bool filter_by_sender_selector;
       rtc::scoped_refptr<RtpSenderInternal> sender_selector;
@@ -933,6 +946,52 @@ void RTCStatsCollector::DeliverCachedReport(
   }
 }
 
+void RTCStatsCollector::DeliverStatsDelta(
+    const rtc::scoped_refptr<const RTCStatsReport>& report,
+    const rtc::scoped_refptr<RTCStatsDeltaCallback>& callback) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  std::vector<std::string> removed_ids;
+  if (!delta_baseline_) {
+    delta_baseline_ = report;
+    callback->OnStatsDeltaDelivered(report, removed_ids);
+    return;
+  }
+
+  // Both reports are ordered on ID, so they are diffed in a single pass. Only
+  // the stats objects that differ are copied.
+  rtc::scoped_refptr<RTCStatsReport> delta =
+      RTCStatsReport::Create(report->timestamp_us());
+  RTCStatsReport::ConstIterator it = report->begin();
+  const RTCStatsReport::ConstIterator end = report->end();
+  RTCStatsReport::ConstIterator baseline_it = delta_baseline_->begin();
+  const RTCStatsReport::ConstIterator baseline_end = delta_baseline_->end();
+  while (it != end || baseline_it != baseline_end) {
+    int order;
+    if (it == end) {
+      order = 1;
+    } else if (baseline_it == baseline_end) {
+      order = -1;
+    } else {
+      order = it->id().compare(baseline_it->id());
+    }
+    if (order < 0) {
+      delta->AddStats(it->copy());
+      ++it;
+    } else if (order > 0) {
+      removed_ids.push_back(baseline_it->id());
+      ++baseline_it;
+    } else {
+      // Timestamps are not compared.
+      if (*it != *baseline_it)
+        delta->AddStats(it->copy());
+      ++it;
+      ++baseline_it;
+    }
+  }
+  delta_baseline_ = report;
+  callback->OnStatsDeltaDelivered(delta, removed_ids);
+}
+
 void RTCStatsCollector::ProduceCertificateStats_n(
     int64_t timestamp_us,
     const std::map<std::string, CertificateStatsPair>& transport_cert_stats,
@@ -941,11 +1000,11 @@ void RTCStatsCollector::ProduceCertificateStats_n(
   for (const auto& transport_cert_stats_pair : transport_cert_stats) {
     if (transport_cert_stats_pair.second.local) {
       ProduceCertificateStatsFromSSLCertificateStats(
-          timestamp_us, *transport_cert_stats_pair.second.local.get(), report);
+          timestamp_us, *transport_cert_stats_pair.second.local, report);
     }
     if (transport_cert_stats_pair.second.remote) {
       ProduceCertificateStatsFromSSLCertificateStats(
-          timestamp_us, *transport_cert_stats_pair.second.remote.get(), report);
+          timestamp_us, *transport_cert_stats_pair.second.remote, report);
     }
   }
 }
@@ -1010,6 +1069,12 @@ void RTCStatsCollector::ProduceDataChannelStats_s(
     data_channel_stats->bytes_sent = data_channel->bytes_sent();
     data_channel_stats->messages_received = data_channel->messages_received();
     data_channel_stats->bytes_received = data_channel->bytes_received();
+    if (data_channel->fec_enabled()) {
+      data_channel_stats->fec_messages_recovered =
+          data_channel->fec_messages_recovered();
+      data_channel_stats->fec_messages_unrecovered =
+          data_channel->fec_messages_unrecovered();
+    }
     report->AddStats(std::move(data_channel_stats));
   }
 }
@@ -1371,28 +1436,51 @@ void RTCStatsCollector::ProduceTransportStats_n(
 std::map<std::string, RTCStatsCollector::CertificateStatsPair>
 RTCStatsCollector::PrepareTransportCertificateStats_n(
     const std::map<std::string, cricket::TransportStats>&
-        transport_stats_by_name) const {
+        transport_stats_by_name) {
   RTC_DCHECK(network_thread_->IsCurrent());
+  // Certificates rarely change, while computing their fingerprints is costly,
+  // so their stats are only computed again when they do change.
+  std::map<std::string, CachedCertificateStats> certificate_stats_cache;
   std::map<std::string, CertificateStatsPair> transport_cert_stats;
   for (const auto& entry : transport_stats_by_name) {
     const std::string& transport_name = entry.first;
+    CachedCertificateStats& cached =
+        certificate_stats_cache[transport_name];
+    auto previous_it = certificate_stats_cache_.find(transport_name);
+    if (previous_it != certificate_stats_cache_.end())
+      cached = std::move(previous_it->second);
 
-    CertificateStatsPair certificate_stats_pair;
     rtc::scoped_refptr<rtc::RTCCertificate> local_certificate;
-    if (pc_->GetLocalCertificate(transport_name, &local_certificate)) {
-      certificate_stats_pair.local =
-          local_certificate->ssl_cert_chain().GetStats();
+    pc_->GetLocalCertificate(transport_name, &local_certificate);
+    if (local_certificate != cached.local_certificate) {
+      cached.local_certificate = local_certificate;
+      cached.local = local_certificate
+                         ? local_certificate->ssl_cert_chain().GetStats()
+                         : nullptr;
     }
 
     std::unique_ptr<rtc::SSLCertChain> remote_cert_chain =
         pc_->GetRemoteSSLCertChain(transport_name);
+    std::vector<rtc::Buffer> remote_ders;
     if (remote_cert_chain) {
-      certificate_stats_pair.remote = remote_cert_chain->GetStats();
+      remote_ders.resize(remote_cert_chain->GetSize());
+      for (size_t i = 0; i < remote_ders.size(); ++i)
+        remote_cert_chain->Get(i).ToDER(&remote_ders[i]);
+    }
+    if (remote_ders != cached.remote_ders) {
+      cached.remote_ders = std::move(remote_ders);
+      cached.remote =
+          remote_cert_chain ? remote_cert_chain->GetStats() : nullptr;
     }
 
+    CertificateStatsPair certificate_stats_pair;
+    certificate_stats_pair.local = cached.local.get();
+    certificate_stats_pair.remote = cached.remote.get();
     transport_cert_stats.insert(
-        std::make_pair(transport_name, std::move(certificate_stats_pair)));
+        std::make_pair(transport_name, certificate_stats_pair));
   }
+  // Drops the certificate stats of transports that have gone away.
+  certificate_stats_cache_.swap(certificate_stats_cache);
   return transport_cert_stats;
 }
 
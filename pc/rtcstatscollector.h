@@ -27,7 +27,9 @@
 #include "pc/peerconnectioninternal.h"
 #include "pc/trackmediainfomap.h"
 #include "rtc_base/asyncinvoker.h"
+#include "rtc_base/buffer.h"
 #include "rtc_base/refcount.h"
+#include "rtc_base/rtccertificate.h"
 #include "rtc_base/scoped_ref_ptr.h"
 #include "rtc_base/sslidentity.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
@@ -65,6 +67,13 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   // as: no RTP streams are received by selector). The result is empty.
   void GetStatsReport(rtc::scoped_refptr<RtpReceiverInternal> selector,
                       rtc::scoped_refptr<RTCStatsCollectorCallback> callback);
+  // Gets the changes to the stats since the previous call, which is cheaper
+  // to deliver and to consume than a full report when polling: unchanged
+  // objects are not copied, and typically most of them are unchanged. The
+  // first delta holds every stats object. Reports are gathered and cached as
+  // with |GetStatsReport|. There is one delta baseline per collector, so this
+  // is meant for a single consumer.
+  void GetStatsReportDelta(rtc::scoped_refptr<RTCStatsDeltaCallback> callback);
   // Clears the cache's reference to the most recent stats report. Subsequently
   // calling |GetStatsReport| guarantees fresh stats.
   void ClearCachedStatsReport();
@@ -89,7 +98,12 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
  private:
   class RequestInfo {
    public:
-    enum class FilterMode { kAll, kSenderSelector, kReceiverSelector };
+    enum class FilterMode {
+      kAll,
+      kSenderSelector,
+      kReceiverSelector,
+      kDelta
+    };
 
     // Constructs with FilterMode::kAll.
     explicit RequestInfo(
@@ -102,11 +116,18 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
     // applied even if |selector| is null, resulting in an empty report.
     RequestInfo(rtc::scoped_refptr<RtpReceiverInternal> selector,
                 rtc::scoped_refptr<RTCStatsCollectorCallback> callback);
+    // Constructs with FilterMode::kDelta.
+    explicit RequestInfo(rtc::scoped_refptr<RTCStatsDeltaCallback> callback);
 
     FilterMode filter_mode() const { return filter_mode_; }
     rtc::scoped_refptr<RTCStatsCollectorCallback> callback() const {
+      RTC_DCHECK(filter_mode_ != FilterMode::kDelta);
       return callback_;
     }
+    rtc::scoped_refptr<RTCStatsDeltaCallback> delta_callback() const {
+      RTC_DCHECK(filter_mode_ == FilterMode::kDelta);
+      return delta_callback_;
+    }
     rtc::scoped_refptr<RtpSenderInternal> sender_selector() const {
       RTC_DCHECK(filter_mode_ == FilterMode::kSenderSelector);
       return sender_selector_;
@@ -124,14 +145,25 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
 
     FilterMode filter_mode_;
     rtc::scoped_refptr<RTCStatsCollectorCallback> callback_;
+    rtc::scoped_refptr<RTCStatsDeltaCallback> delta_callback_;
     rtc::scoped_refptr<RtpSenderInternal> sender_selector_;
     rtc::scoped_refptr<RtpReceiverInternal> receiver_selector_;
   };
 
   void GetStatsReportInternal(RequestInfo request);
 
+  // Points into |certificate_stats_cache_|.
   struct CertificateStatsPair {
+    const rtc::SSLCertificateStats* local = nullptr;
+    const rtc::SSLCertificateStats* remote = nullptr;
+  };
+
+  // The certificate stats of a transport and the certificates they were
+  // computed from.
+  struct CachedCertificateStats {
+    rtc::scoped_refptr<rtc::RTCCertificate> local_certificate;
     std::unique_ptr<rtc::SSLCertificateStats> local;
+    std::vector<rtc::Buffer> remote_ders;
     std::unique_ptr<rtc::SSLCertificateStats> remote;
   };
 
@@ -154,6 +186,11 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   void DeliverCachedReport(
       rtc::scoped_refptr<const RTCStatsReport> cached_report,
       std::vector<RequestInfo> requests);
+  // Delivers the difference between |report| and |delta_baseline_| and makes
+  // |report| the new baseline.
+  void DeliverStatsDelta(
+      const rtc::scoped_refptr<const RTCStatsReport>& report,
+      const rtc::scoped_refptr<RTCStatsDeltaCallback>& callback);
 
   // Produces |RTCCertificateStats|.
   void ProduceCertificateStats_n(
@@ -207,7 +244,7 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   std::map<std::string, CertificateStatsPair>
   PrepareTransportCertificateStats_n(
       const std::map<std::string, cricket::TransportStats>&
-          transport_stats_by_name) const;
+          transport_stats_by_name);
   std::vector<RtpTransceiverStatsInfo> PrepareTransceiverStatsInfos_s() const;
   std::set<std::string> PrepareTransportNames_s() const;
 
@@ -237,6 +274,10 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
 
   Call::Stats call_stats_;
 
+  // The certificate stats of the transports by name, kept from one report to
+  // the next. Only accessed on the network thread.
+  std::map<std::string, CachedCertificateStats> certificate_stats_cache_;
+
   // A timestamp, in microseconds, that is based on a timer that is
   // monotonically increasing. That is, even if the system clock is modified the
   // difference between the timer and this timestamp is how fresh the cached
@@ -244,6 +285,10 @@ class RTCStatsCollector : public virtual rtc::RefCountInterface,
   int64_t cache_timestamp_us_;
   int64_t cache_lifetime_us_;
   rtc::scoped_refptr<const RTCStatsReport> cached_report_;
+  // The report that the most recent delta was computed against. Reports are
+  // immutable, so holding on to it keeps the previous stats objects without
+  // copying them.
+  rtc::scoped_refptr<const RTCStatsReport> delta_baseline_;
 
   // Data recorded and maintained by the stats collector during its lifetime.
   // Some stats are produced from this record instead of other components.
@@ -0,0 +1,234 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/stats/rtcstatsreport.h"
+#include "pc/audiotrack.h"
+#include "pc/rtcstatscollector.h"
+#include "pc/test/fakepeerconnectionforstats.h"
+#include "pc/test/fakevideotracksource.h"
+#include "pc/test/mock_rtpreceiverinternal.h"
+#include "pc/test/mock_rtpsenderinternal.h"
+#include "pc/videotrack.h"
+#include "rtc_base/rtccertificate.h"
+#include "rtc_base/sslidentity.h"
+#include "rtc_base/stringencode.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+using testing::Return;
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumPeerConnections = 50;
+// Local and remote audio and video, 20 tracks in all.
+constexpr int kTracksPerDirectionAndKind = 5;
+constexpr int kNumPolls = 20;
+
+RtpParameters ParametersWithSsrc(uint32_t ssrc) {
+  RtpParameters parameters;
+  parameters.encodings.push_back(RtpEncodingParameters());
+  parameters.encodings[0].ssrc = ssrc;
+  return parameters;
+}
+
+rtc::scoped_refptr<MediaStreamTrackInterface> CreateTrack(
+    cricket::MediaType media_type,
+    const std::string& id) {
+  if (media_type == cricket::MEDIA_TYPE_AUDIO)
+    return AudioTrack::Create(id, nullptr);
+  return VideoTrack::Create(id, FakeVideoTrackSource::Create(),
+                            rtc::Thread::Current());
+}
+
+// A peer connection sending and receiving |kTracksPerDirectionAndKind| audio
+// and video tracks, with the media stats of a call in progress.
+class PeerConnectionForStats {
+ public:
+  PeerConnectionForStats()
+      : pc_(new rtc::RefCountedObject<FakePeerConnectionForStats>()),
+        collector_(RTCStatsCollector::Create(pc_)) {
+    int attachment_id = 1;
+    uint32_t ssrc = 1;
+    for (int i = 0; i < kTracksPerDirectionAndKind; ++i) {
+      AddSender(cricket::MEDIA_TYPE_AUDIO, attachment_id++, ssrc);
+      voice_media_info_.senders.push_back(cricket::VoiceSenderInfo());
+      voice_media_info_.senders.back().add_ssrc(ssrc++);
+      AddReceiver(cricket::MEDIA_TYPE_AUDIO, attachment_id++, ssrc);
+      voice_media_info_.receivers.push_back(cricket::VoiceReceiverInfo());
+      voice_media_info_.receivers.back().add_ssrc(ssrc++);
+      AddSender(cricket::MEDIA_TYPE_VIDEO, attachment_id++, ssrc);
+      video_media_info_.senders.push_back(cricket::VideoSenderInfo());
+      video_media_info_.senders.back().add_ssrc(ssrc++);
+      AddReceiver(cricket::MEDIA_TYPE_VIDEO, attachment_id++, ssrc);
+      video_media_info_.receivers.push_back(cricket::VideoReceiverInfo());
+      video_media_info_.receivers.back().add_ssrc(ssrc++);
+    }
+    voice_media_channel_ = pc_->AddVoiceChannel("audio", "transport");
+    video_media_channel_ = pc_->AddVideoChannel("video", "transport");
+    // DTLS certificates, as in a real call.
+    pc_->SetLocalCertificate(
+        "transport",
+        rtc::RTCCertificate::Create(std::unique_ptr<rtc::SSLIdentity>(
+            rtc::SSLIdentity::Generate("local", rtc::KT_ECDSA))));
+    std::unique_ptr<rtc::SSLIdentity> remote_identity(
+        rtc::SSLIdentity::Generate("remote", rtc::KT_ECDSA));
+    pc_->SetRemoteCertChain("transport",
+                            remote_identity->cert_chain().UniqueCopy());
+  }
+
+  RTCStatsCollector* collector() { return collector_.get(); }
+
+  // Advances the RTP counters by a second of media.
+  void SendAndReceiveMedia() {
+    for (cricket::VoiceSenderInfo& info : voice_media_info_.senders) {
+      info.packets_sent += 50;
+      info.bytes_sent += 50 * 80;
+    }
+    for (cricket::VoiceReceiverInfo& info : voice_media_info_.receivers) {
+      info.packets_rcvd += 50;
+      info.bytes_rcvd += 50 * 80;
+    }
+    for (cricket::VideoSenderInfo& info : video_media_info_.senders) {
+      info.packets_sent += 100;
+      info.bytes_sent += 100 * 1100;
+    }
+    for (cricket::VideoReceiverInfo& info : video_media_info_.receivers) {
+      info.packets_rcvd += 100;
+      info.bytes_rcvd += 100 * 1100;
+    }
+    voice_media_channel_->SetStats(voice_media_info_);
+    video_media_channel_->SetStats(video_media_info_);
+  }
+
+ private:
+  void AddSender(cricket::MediaType media_type,
+                 int attachment_id,
+                 uint32_t ssrc) {
+    rtc::scoped_refptr<MockRtpSenderInternal> sender(
+        new rtc::RefCountedObject<MockRtpSenderInternal>());
+    EXPECT_CALL(*sender, track())
+        .WillRepeatedly(
+            Return(CreateTrack(media_type, "sender" + rtc::ToString(ssrc))));
+    EXPECT_CALL(*sender, ssrc()).WillRepeatedly(Return(ssrc));
+    EXPECT_CALL(*sender, media_type()).WillRepeatedly(Return(media_type));
+    EXPECT_CALL(*sender, GetParameters())
+        .WillRepeatedly(Return(ParametersWithSsrc(ssrc)));
+    EXPECT_CALL(*sender, AttachmentId()).WillRepeatedly(Return(attachment_id));
+    EXPECT_CALL(*sender, stream_ids())
+        .WillRepeatedly(Return(std::vector<std::string>({"stream"})));
+    pc_->AddSender(sender);
+  }
+
+  void AddReceiver(cricket::MediaType media_type,
+                   int attachment_id,
+                   uint32_t ssrc) {
+    rtc::scoped_refptr<MockRtpReceiverInternal> receiver(
+        new rtc::RefCountedObject<MockRtpReceiverInternal>());
+    EXPECT_CALL(*receiver, track())
+        .WillRepeatedly(
+            Return(CreateTrack(media_type, "receiver" + rtc::ToString(ssrc))));
+    EXPECT_CALL(*receiver, streams())
+        .WillRepeatedly(
+            Return(std::vector<rtc::scoped_refptr<MediaStreamInterface>>()));
+    EXPECT_CALL(*receiver, media_type()).WillRepeatedly(Return(media_type));
+    EXPECT_CALL(*receiver, GetParameters())
+        .WillRepeatedly(Return(ParametersWithSsrc(ssrc)));
+    EXPECT_CALL(*receiver, AttachmentId())
+        .WillRepeatedly(Return(attachment_id));
+    pc_->AddReceiver(receiver);
+  }
+
+  rtc::scoped_refptr<FakePeerConnectionForStats> pc_;
+  rtc::scoped_refptr<RTCStatsCollector> collector_;
+  FakeVoiceMediaChannelForStats* voice_media_channel_;
+  FakeVideoMediaChannelForStats* video_media_channel_;
+  cricket::VoiceMediaInfo voice_media_info_;
+  cricket::VideoMediaInfo video_media_info_;
+};
+
+class CountingCallback : public RTCStatsCollectorCallback,
+                         public RTCStatsDeltaCallback {
+ public:
+  void OnStatsDelivered(
+      const rtc::scoped_refptr<const RTCStatsReport>& report) override {
+    ++num_reports;
+    num_stats += report->size();
+  }
+  void OnStatsDeltaDelivered(
+      const rtc::scoped_refptr<const RTCStatsReport>& delta,
+      const std::vector<std::string>& removed_ids) override {
+    ++num_reports;
+    num_stats += delta->size() + removed_ids.size();
+  }
+
+  int num_reports = 0;
+  size_t num_stats = 0;
+};
+
+// Polls every peer connection once a "second", as an application monitoring
+// its calls would, and reports the cost of a poll and the number of stats
+// objects delivered per peer connection.
+void MeasurePolling(const std::string& trace, bool delta) {
+  std::vector<std::unique_ptr<PeerConnectionForStats>> pcs;
+  for (int i = 0; i < kNumPeerConnections; ++i)
+    pcs.emplace_back(new PeerConnectionForStats());
+  rtc::scoped_refptr<CountingCallback> callback(
+      new rtc::RefCountedObject<CountingCallback>());
+
+  int64_t elapsed_us = 0;
+  for (int poll = 0; poll <= kNumPolls; ++poll) {
+    for (const auto& pc : pcs) {
+      pc->SendAndReceiveMedia();
+      pc->collector()->ClearCachedStatsReport();
+    }
+    // The first poll sets up the collectors and the delta baselines.
+    if (poll == 1) {
+      elapsed_us = 0;
+      callback->num_reports = 0;
+      callback->num_stats = 0;
+    }
+    const int num_reports = callback->num_reports + kNumPeerConnections;
+    const int64_t start_us = rtc::TimeMicros();
+    for (const auto& pc : pcs) {
+      if (delta)
+        pc->collector()->GetStatsReportDelta(callback);
+      else
+        pc->collector()->GetStatsReport(callback);
+    }
+    // The signaling, worker and network threads are all this one.
+    while (callback->num_reports < num_reports)
+      rtc::Thread::Current()->ProcessMessages(0);
+    elapsed_us += rtc::TimeMicros() - start_us;
+  }
+  ASSERT_EQ(callback->num_reports, kNumPolls * kNumPeerConnections);
+
+  const double num_polls = kNumPolls * kNumPeerConnections;
+  test::PrintResult("rtc_stats_poll", "", trace, elapsed_us / num_polls,
+                    "us/pc", true);
+  test::PrintResult("rtc_stats_poll_objects", "", trace,
+                    callback->num_stats / num_polls, "objects/pc", false);
+}
+
+}  // namespace
+
+TEST(RTCStatsCollectorPerformanceTest, PollTwentyTracks) {
+  MeasurePolling("full", false);
+  MeasurePolling("delta", true);
+}
+
+}  // namespace webrtc
@@ -284,6 +284,28 @@ rtc::scoped_refptr<MockRtpReceiverInternal> CreateMockReceiver(
   return receiver;
 }
 
+class RTCStatsDeltaObtainer : public RTCStatsDeltaCallback {
+ public:
+  static rtc::scoped_refptr<RTCStatsDeltaObtainer> Create() {
+    return rtc::scoped_refptr<RTCStatsDeltaObtainer>(
+        new rtc::RefCountedObject<RTCStatsDeltaObtainer>());
+  }
+
+  void OnStatsDeltaDelivered(
+      const rtc::scoped_refptr<const RTCStatsReport>& delta,
+      const std::vector<std::string>& removed_ids) override {
+    delta_ = delta;
+    removed_ids_ = removed_ids;
+  }
+
+  rtc::scoped_refptr<const RTCStatsReport> delta() const { return delta_; }
+  const std::vector<std::string>& removed_ids() const { return removed_ids_; }
+
+ private:
+  rtc::scoped_refptr<const RTCStatsReport> delta_;
+  std::vector<std::string> removed_ids_;
+};
+
 class RTCStatsCollectorWrapper {
  public:
   explicit RTCStatsCollectorWrapper(
@@ -317,6 +339,14 @@ class RTCStatsCollectorWrapper {
     return WaitForReport(callback);
   }
 
+  rtc::scoped_refptr<RTCStatsDeltaObtainer> GetStatsReportDelta() {
+    rtc::scoped_refptr<RTCStatsDeltaObtainer> callback =
+        RTCStatsDeltaObtainer::Create();
+    stats_collector_->GetStatsReportDelta(callback);
+    EXPECT_TRUE_WAIT(callback->delta(), kGetStatsReportTimeoutMs);
+    return callback;
+  }
+
   rtc::scoped_refptr<const RTCStatsReport> GetFreshStatsReport() {
     stats_collector_->ClearCachedStatsReport();
     return GetStatsReport();
@@ -712,6 +742,54 @@ TEST_F(RTCStatsCollectorTest, CollectRTCCertificateStatsSingle) {
   ExpectReportContainsCertificateInfo(report, *remote_certinfo);
 }
 
+// Certificate stats are kept from one report to the next, but not once the
+// certificates change.
+TEST_F(RTCStatsCollectorTest, CollectRTCCertificateStatsAfterChange) {
+  const char kTransportName[] = "transport";
+
+  pc_->AddVoiceChannel("audio", kTransportName);
+
+  std::unique_ptr<CertificateInfo> local_certinfo =
+      CreateFakeCertificateAndInfoFromDers(
+          std::vector<std::string>({"(local) first certificate"}));
+  pc_->SetLocalCertificate(kTransportName, local_certinfo->certificate);
+  std::unique_ptr<CertificateInfo> remote_certinfo =
+      CreateFakeCertificateAndInfoFromDers(
+          std::vector<std::string>({"(remote) first certificate"}));
+  pc_->SetRemoteCertChain(
+      kTransportName,
+      remote_certinfo->certificate->ssl_cert_chain().UniqueCopy());
+
+  rtc::scoped_refptr<const RTCStatsReport> report = stats_->GetStatsReport();
+  ExpectReportContainsCertificateInfo(report, *local_certinfo);
+  ExpectReportContainsCertificateInfo(report, *remote_certinfo);
+
+  stats_->stats_collector()->ClearCachedStatsReport();
+  report = stats_->GetStatsReport();
+  ExpectReportContainsCertificateInfo(report, *local_certinfo);
+  ExpectReportContainsCertificateInfo(report, *remote_certinfo);
+
+  std::unique_ptr<CertificateInfo> new_local_certinfo =
+      CreateFakeCertificateAndInfoFromDers(
+          std::vector<std::string>({"(local) second certificate"}));
+  pc_->SetLocalCertificate(kTransportName, new_local_certinfo->certificate);
+  std::unique_ptr<CertificateInfo> new_remote_certinfo =
+      CreateFakeCertificateAndInfoFromDers(
+          std::vector<std::string>({"(remote) second certificate"}));
+  pc_->SetRemoteCertChain(
+      kTransportName,
+      new_remote_certinfo->certificate->ssl_cert_chain().UniqueCopy());
+
+  stats_->stats_collector()->ClearCachedStatsReport();
+  report = stats_->GetStatsReport();
+  ExpectReportContainsCertificateInfo(report, *new_local_certinfo);
+  ExpectReportContainsCertificateInfo(report, *new_remote_certinfo);
+  EXPECT_FALSE(
+      report->Get("RTCCertificate_" + local_certinfo->fingerprints[0]));
+  EXPECT_FALSE(
+      report->Get("RTCCertificate_" + remote_certinfo->fingerprints[0]));
+}
+
 TEST_F(RTCStatsCollectorTest, CollectRTCCodecStats) {
   // Audio
   cricket::VoiceMediaInfo voice_media_info;
@@ -2076,6 +2154,53 @@ TEST_F(RTCStatsCollectorTest, GetStatsWithNullReceiverSelector) {
   EXPECT_EQ(empty_report->size(), 0u);
 }
 
+TEST_F(RTCStatsCollectorTest, GetStatsReportDelta) {
+  cricket::VoiceMediaInfo voice_media_info;
+  for (uint32_t ssrc : {1, 2}) {
+    voice_media_info.senders.push_back(cricket::VoiceSenderInfo());
+    voice_media_info.senders.back().local_stats.push_back(
+        cricket::SsrcSenderInfo());
+    voice_media_info.senders.back().local_stats[0].ssrc = ssrc;
+  }
+  auto* voice_media_channel = pc_->AddVoiceChannel("AudioMid", "TransportName");
+  voice_media_channel->SetStats(voice_media_info);
+
+  // The first delta is the whole report.
+  rtc::scoped_refptr<RTCStatsDeltaObtainer> delta =
+      stats_->GetStatsReportDelta();
+  rtc::scoped_refptr<const RTCStatsReport> report = stats_->GetStatsReport();
+  EXPECT_EQ(delta->delta()->size(), report->size());
+  EXPECT_TRUE(delta->delta()->Get("RTCOutboundRTPAudioStream_1"));
+  EXPECT_TRUE(delta->delta()->Get("RTCOutboundRTPAudioStream_2"));
+  EXPECT_TRUE(delta->removed_ids().empty());
+
+  // Nothing has changed in the cached report.
+  delta = stats_->GetStatsReportDelta();
+  EXPECT_EQ(delta->delta()->size(), 0u);
+  EXPECT_TRUE(delta->removed_ids().empty());
+
+  // Only the stream that sent something is in the next delta.
+  voice_media_info.senders[0].bytes_sent = 1234;
+  voice_media_channel->SetStats(voice_media_info);
+  stats_->stats_collector()->ClearCachedStatsReport();
+  delta = stats_->GetStatsReportDelta();
+  EXPECT_EQ(delta->delta()->size(), 1u);
+  const RTCStats* outbound_rtp =
+      delta->delta()->Get("RTCOutboundRTPAudioStream_1");
+  ASSERT_TRUE(outbound_rtp);
+  EXPECT_EQ(*outbound_rtp->cast_to<RTCOutboundRTPStreamStats>().bytes_sent,
+            1234u);
+  EXPECT_TRUE(delta->removed_ids().empty());
+
+  voice_media_info.senders.pop_back();
+  voice_media_channel->SetStats(voice_media_info);
+  stats_->stats_collector()->ClearCachedStatsReport();
+  delta = stats_->GetStatsReportDelta();
+  EXPECT_EQ(delta->delta()->size(), 0u);
+  EXPECT_EQ(delta->removed_ids(),
+            std::vector<std::string>({"RTCOutboundRTPAudioStream_2"}));
+}
+
 // When the PC has not had SetLocalDescription done, tracks all have
 // SSRC 0, meaning "unconnected".
 // In this state, we report on track stats, but not RTP stats.
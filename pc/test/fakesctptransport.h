@@ -31,9 +31,12 @@ class FakeSctpTransport : public cricket::SctpTransportInternal {
   bool SendData(const cricket::SendDataParams& params,
                 const rtc::CopyOnWriteBuffer& payload,
                 cricket::SendDataResult* result = nullptr) override {
+    ++stats_.messages_sent;
+    stats_.bytes_sent += payload.size();
     return true;
   }
   bool ReadyToSendData() override { return true; }
+  cricket::SctpTransportStats GetStats() const override { return stats_; }
   void set_debug_name_for_testing(const char* debug_name) override {}
 
   int local_port() const { return *local_port_; }
@@ -42,6 +45,7 @@ class FakeSctpTransport : public cricket::SctpTransportInternal {
  private:
   absl::optional<int> local_port_;
   absl::optional<int> remote_port_;
+  cricket::SctpTransportStats stats_;
 };
 
 class FakeSctpTransportFactory : public cricket::SctpTransportInternalFactory {
@@ -499,6 +499,28 @@ class MockRTCStatsCollectorCallback : public webrtc::RTCStatsCollectorCallback {
   rtc::scoped_refptr<const RTCStatsReport> report_;
 };
 
+class MockRTCStatsDeltaCallback : public webrtc::RTCStatsDeltaCallback {
+ public:
+  rtc::scoped_refptr<const RTCStatsReport> delta() { return delta_; }
+  const std::vector<std::string>& removed_ids() const { return removed_ids_; }
+
+  bool called() const { return called_; }
+
+ protected:
+  void OnStatsDeltaDelivered(
+      const rtc::scoped_refptr<const RTCStatsReport>& delta,
+      const std::vector<std::string>& removed_ids) override {
+    delta_ = delta;
+    removed_ids_ = removed_ids;
+    called_ = true;
+  }
+
+ private:
+  bool called_ = false;
+  rtc::scoped_refptr<const RTCStatsReport> delta_;
+  std::vector<std::string> removed_ids_;
+};
+
 }  // namespace webrtc
 
 #endif  // PC_TEST_MOCKPEERCONNECTIONOBSERVERS_H_
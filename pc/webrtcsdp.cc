@@ -22,6 +22,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "api/mediatypes.h"
 #include "api/candidate.h"
 #include "api/cryptoparams.h"
@@ -440,11 +441,11 @@ static bool ParseFailedExpectLine(const std::string& message,
   return ParseFailed(message, line_start, description.str(), error);
 }
 
-static bool AddLine(const std::string& line, std::string* message) {
+static bool AddLine(absl::string_view line, std::string* message) {
   if (!message)
     return false;
 
-  message->append(line);
+  message->append(line.data(), line.size());
   message->append(kLineBreak);
   return true;
 }
@@ -462,7 +463,8 @@ static bool GetLine(const std::string& message,
   if (line_end > 0 && (message.at(line_end - 1) == kReturnChar)) {
     --line_end;
   }
-  *line = message.substr(line_begin, (line_end - line_begin));
+  // Reuses the capacity of |line|, which callers keep across lines.
+  line->assign(message, line_begin, line_end - line_begin);
   const char* cline = line->c_str();
   // RFC 4566
   // An SDP session description consists of a number of lines of text of
@@ -489,19 +491,19 @@ static bool GetLine(const std::string& message,
 
 // Init |os| to "|type|=|value|".
 static void InitLine(const char type,
-                     const std::string& value,
+                     absl::string_view value,
                      rtc::StringBuilder* os) {
   os->Clear();
-  *os << std::string(1, type) << kSdpDelimiterEqual << value;
+  *os << absl::string_view(&type, 1) << kSdpDelimiterEqual << value;
 }
 
 // Init |os| to "a=|attribute|".
-static void InitAttrLine(const std::string& attribute, rtc::StringBuilder* os) {
+static void InitAttrLine(absl::string_view attribute, rtc::StringBuilder* os) {
   InitLine(kLineTypeAttributes, attribute, os);
 }
 
 // Writes a SDP attribute line based on |attribute| and |value| to |message|.
-static void AddAttributeLine(const std::string& attribute,
+static void AddAttributeLine(absl::string_view attribute,
                              int value,
                              std::string* message) {
   rtc::StringBuilder os;
@@ -540,8 +542,9 @@ static bool GetLineWithType(const std::string& message,
 }
 
 static bool HasAttribute(const std::string& line,
-                         const std::string& attribute) {
-  if (line.compare(kLinePrefixLength, attribute.size(), attribute) == 0) {
+                         absl::string_view attribute) {
+  if (line.compare(kLinePrefixLength, attribute.size(), attribute.data(),
+                   attribute.size()) == 0) {
     // Make sure that the match is not only a partial match. If length of
     // strings doesn't match, the next character of the line must be ':' or ' '.
     // This function is also used for media descriptions (e.g., "m=audio 9..."),
@@ -571,19 +574,23 @@ static bool AddSsrcLine(uint32_t ssrc_id,
 
 // Get value only from <attribute>:<value>.
 static bool GetValue(const std::string& message,
-                     const std::string& attribute,
+                     absl::string_view attribute,
                      std::string* value,
                      SdpParseError* error) {
-  std::string leftpart;
-  if (!rtc::tokenize_first(message, kSdpDelimiterColonChar, &leftpart, value)) {
-    return ParseFailedGetValue(message, attribute, error);
-  }
+  // Like rtc::tokenize_first, the value starts after the first run of colons.
+  const size_t colon_pos = message.find(kSdpDelimiterColonChar);
   // The left part should end with the expected attribute.
-  if (leftpart.length() < attribute.length() ||
-      leftpart.compare(leftpart.length() - attribute.length(),
-                       attribute.length(), attribute) != 0) {
-    return ParseFailedGetValue(message, attribute, error);
-  }
+  if (colon_pos == std::string::npos || colon_pos < attribute.size() ||
+      absl::string_view(message).substr(colon_pos - attribute.size(),
+                                        attribute.size()) != attribute) {
+    return ParseFailedGetValue(message, std::string(attribute), error);
+  }
+  const size_t value_pos =
+      message.find_first_not_of(kSdpDelimiterColonChar, colon_pos);
+  if (value_pos == std::string::npos)
+    value->clear();
+  else
+    value->assign(message, value_pos, std::string::npos);
   return true;
 }
 
@@ -1658,12 +1665,24 @@ void WriteFmtpParameter(const std::string& parameter_name,
   *os << parameter_name << kSdpDelimiterEqual << parameter_value;
 }
 
-void WriteFmtpParameters(const cricket::CodecParameterMap& parameters,
+bool IsFmtpParam(const std::string& name) {
+  // RFC 4855, section 3 specifies the mapping of media format parameters to SDP
+  // parameters. Only ptime, maxptime, channels and rate are placed outside of
+  // the fmtp line. In WebRTC, channels and rate are already handled separately
+  // and thus not included in the CodecParameterMap.
+  return name != kCodecParamPTime && name != kCodecParamMaxPTime;
+}
+
+// Writes the fmtp parameters in |params|, which may contain other parameters
+// as well, and returns false if there are none.
+bool WriteFmtpParameters(const cricket::CodecParameterMap& params,
                          rtc::StringBuilder* os) {
   bool first = true;
-  for (const auto& entry : parameters) {
+  for (const auto& entry : params) {
     const std::string& key = entry.first;
     const std::string& value = entry.second;
+    if (!IsFmtpParam(key))
+      continue;
     // Parameters are a semicolon-separated list, no spaces.
     // The list is separated from the header by a space.
     if (first) {
@@ -1674,48 +1693,24 @@ void WriteFmtpParameters(const cricket::CodecParameterMap& parameters,
     }
     WriteFmtpParameter(key, value, os);
   }
-}
-
-bool IsFmtpParam(const std::string& name) {
-  // RFC 4855, section 3 specifies the mapping of media format parameters to SDP
-  // parameters. Only ptime, maxptime, channels and rate are placed outside of
-  // the fmtp line. In WebRTC, channels and rate are already handled separately
-  // and thus not included in the CodecParameterMap.
-  return name != kCodecParamPTime && name != kCodecParamMaxPTime;
-}
-
-// Retreives fmtp parameters from |params|, which may contain other parameters
-// as well, and puts them in |fmtp_parameters|.
-void GetFmtpParams(const cricket::CodecParameterMap& params,
-                   cricket::CodecParameterMap* fmtp_parameters) {
-  for (const auto& entry : params) {
-    const std::string& key = entry.first;
-    const std::string& value = entry.second;
-    if (IsFmtpParam(key)) {
-      (*fmtp_parameters)[key] = value;
-    }
-  }
+  return !first;
 }
 
 template <class T>
 void AddFmtpLine(const T& codec, std::string* message) {
-  cricket::CodecParameterMap fmtp_parameters;
-  GetFmtpParams(codec.params, &fmtp_parameters);
-  if (fmtp_parameters.empty()) {
+  rtc::StringBuilder os;
+  WriteFmtpHeader(codec.id, &os);
+  if (!WriteFmtpParameters(codec.params, &os)) {
     // No need to add an fmtp if it will have no (optional) parameters.
     return;
   }
-  rtc::StringBuilder os;
-  WriteFmtpHeader(codec.id, &os);
-  WriteFmtpParameters(fmtp_parameters, &os);
   AddLine(os.str(), message);
-  return;
 }
 
 template <class T>
 void AddRtcpFbLines(const T& codec, std::string* message) {
+  rtc::StringBuilder os;
   for (const cricket::FeedbackParam& param : codec.feedback_params.params()) {
-    rtc::StringBuilder os;
     WriteRtcpFbHeader(codec.id, &os);
     os << " " << param.id();
     if (!param.param().empty()) {
@@ -2588,39 +2583,21 @@ void AddFeedbackParameters(const cricket::FeedbackParams& feedback_params,
   }
 }
 
-// Gets the current codec setting associated with |payload_type|. If there
-// is no Codec associated with that payload type it returns an empty codec
-// with that payload type.
-template <class T>
-T GetCodecWithPayloadType(const std::vector<T>& codecs, int payload_type) {
-  const T* codec = FindCodecById(codecs, payload_type);
-  if (codec)
-    return *codec;
-  // Return empty codec with |payload_type|.
-  T ret_val;
-  ret_val.id = payload_type;
-  return ret_val;
-}
-
-// Updates or creates a new codec entry in the audio description.
+// Gets the codec associated with |payload_type|. If there is no Codec
+// associated with that payload type it adds an empty codec with that payload
+// type. The codec is updated in place, as its a=rtpmap, a=fmtp and a=rtcp-fb
+// lines are parsed.
 template <class T, class U>
-void AddOrReplaceCodec(MediaContentDescription* content_desc, const U& codec) {
-  T* desc = static_cast<T*>(content_desc);
-  std::vector<U> codecs = desc->codecs();
-  bool found = false;
-  for (U& existing_codec : codecs) {
-    if (codec.id == existing_codec.id) {
-      // Overwrite existing codec with the new codec.
-      existing_codec = codec;
-      found = true;
-      break;
-    }
-  }
-  if (!found) {
-    desc->AddCodec(codec);
-    return;
+U* GetOrAddCodecWithPayloadType(MediaContentDescription* content_desc,
+                                int payload_type) {
+  std::vector<U>& codecs = static_cast<T*>(content_desc)->mutable_codecs();
+  for (U& codec : codecs) {
+    if (codec.id == payload_type)
+      return &codec;
   }
-  desc->set_codecs(codecs);
+  codecs.push_back(U());
+  codecs.back().id = payload_type;
+  return &codecs.back();
 }
 
 // Adds or updates existing codec corresponding to |payload_type| according
@@ -2630,10 +2607,8 @@ void UpdateCodec(MediaContentDescription* content_desc,
                  int payload_type,
                  const cricket::CodecParameterMap& parameters) {
   // Codec might already have been populated (from rtpmap).
-  U new_codec = GetCodecWithPayloadType(static_cast<T*>(content_desc)->codecs(),
-                                        payload_type);
-  AddParameters(parameters, &new_codec);
-  AddOrReplaceCodec<T, U>(content_desc, new_codec);
+  AddParameters(parameters,
+                GetOrAddCodecWithPayloadType<T, U>(content_desc, payload_type));
 }
 
 // Adds or updates existing codec corresponding to |payload_type| according
@@ -2643,10 +2618,9 @@ void UpdateCodec(MediaContentDescription* content_desc,
                  int payload_type,
                  const cricket::FeedbackParam& feedback_param) {
   // Codec might already have been populated (from rtpmap).
-  U new_codec = GetCodecWithPayloadType(static_cast<T*>(content_desc)->codecs(),
-                                        payload_type);
-  AddFeedbackParameter(feedback_param, &new_codec);
-  AddOrReplaceCodec<T, U>(content_desc, new_codec);
+  AddFeedbackParameter(
+      feedback_param,
+      GetOrAddCodecWithPayloadType<T, U>(content_desc, payload_type));
 }
 
 template <class T>
@@ -2663,15 +2637,13 @@ bool PopWildcardCodec(std::vector<T>* codecs, T* wildcard_codec) {
 
 template <class T>
 void UpdateFromWildcardCodecs(cricket::MediaContentDescriptionImpl<T>* desc) {
-  auto codecs = desc->codecs();
   T wildcard_codec;
-  if (!PopWildcardCodec(&codecs, &wildcard_codec)) {
+  if (!PopWildcardCodec(&desc->mutable_codecs(), &wildcard_codec)) {
     return;
   }
-  for (auto& codec : codecs) {
+  for (auto& codec : desc->mutable_codecs()) {
     AddFeedbackParameters(wildcard_codec.feedback_params, &codec);
   }
-  desc->set_codecs(codecs);
 }
 
 void AddAudioAttribute(const std::string& name,
@@ -2680,11 +2652,9 @@ void AddAudioAttribute(const std::string& name,
   if (value.empty()) {
     return;
   }
-  std::vector<cricket::AudioCodec> codecs = audio_desc->codecs();
-  for (cricket::AudioCodec& codec : codecs) {
+  for (cricket::AudioCodec& codec : audio_desc->mutable_codecs()) {
     codec.params[name] = value;
   }
-  audio_desc->set_codecs(codecs);
 }
 
 bool ParseContent(const std::string& message,
@@ -3150,14 +3120,14 @@ void UpdateCodec(int payload_type,
                  AudioContentDescription* audio_desc) {
   // Codec may already be populated with (only) optional parameters
   // (from an fmtp).
-  cricket::AudioCodec codec =
-      GetCodecWithPayloadType(audio_desc->codecs(), payload_type);
-  codec.name = name;
-  codec.clockrate = clockrate;
-  codec.bitrate = bitrate;
-  codec.channels = channels;
-  AddOrReplaceCodec<AudioContentDescription, cricket::AudioCodec>(audio_desc,
-                                                                  codec);
+  cricket::AudioCodec* codec =
+      GetOrAddCodecWithPayloadType<AudioContentDescription,
+                                   cricket::AudioCodec>(audio_desc,
+                                                        payload_type);
+  codec->name = name;
+  codec->clockrate = clockrate;
+  codec->bitrate = bitrate;
+  codec->channels = channels;
 }
 
 // Updates or creates a new codec entry in the video description according to
@@ -3167,11 +3137,11 @@ void UpdateCodec(int payload_type,
                  VideoContentDescription* video_desc) {
   // Codec may already be populated with (only) optional parameters
   // (from an fmtp).
-  cricket::VideoCodec codec =
-      GetCodecWithPayloadType(video_desc->codecs(), payload_type);
-  codec.name = name;
-  AddOrReplaceCodec<VideoContentDescription, cricket::VideoCodec>(video_desc,
-                                                                  codec);
+  cricket::VideoCodec* codec =
+      GetOrAddCodecWithPayloadType<VideoContentDescription,
+                                   cricket::VideoCodec>(video_desc,
+                                                        payload_type);
+  codec->name = name;
 }
 
 bool ParseRtpmapAttribute(const std::string& line,
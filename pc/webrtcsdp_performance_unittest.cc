@@ -0,0 +1,210 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/jsepicecandidate.h"
+#include "api/jsepsessiondescription.h"
+#include "media/base/codec.h"
+#include "media/base/mediaconstants.h"
+#include "p2p/base/p2pconstants.h"
+#include "p2p/base/port.h"
+#include "pc/sessiondescription.h"
+#include "pc/webrtcsdp.h"
+#include "rtc_base/sslfingerprint.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumIterations = 20;
+
+cricket::AudioContentDescription* CreateAudioContent(uint32_t ssrc,
+                                                     const std::string& mid) {
+  cricket::AudioContentDescription* audio =
+      new cricket::AudioContentDescription();
+  audio->set_protocol(cricket::kMediaProtocolDtlsSavpf);
+  audio->set_rtcp_mux(true);
+  audio->set_rtcp_reduced_size(true);
+  cricket::AudioCodec opus(111, cricket::kOpusCodecName, 48000, 0, 2);
+  opus.SetParam(cricket::kCodecParamMinPTime, 10);
+  opus.SetParam(cricket::kCodecParamUseInbandFec, 1);
+  opus.AddFeedbackParam(
+      cricket::FeedbackParam(cricket::kRtcpFbParamTransportCc));
+  audio->AddCodec(opus);
+  audio->AddCodec(cricket::AudioCodec(103, cricket::kIsacCodecName, 16000, 0,
+                                      1));
+  audio->AddCodec(cricket::AudioCodec(104, cricket::kIsacCodecName, 32000, 0,
+                                      1));
+  audio->AddCodec(cricket::AudioCodec(9, cricket::kG722CodecName, 8000, 0, 1));
+  audio->AddCodec(cricket::AudioCodec(0, cricket::kPcmuCodecName, 8000, 0, 1));
+  audio->AddCodec(cricket::AudioCodec(8, cricket::kPcmaCodecName, 8000, 0, 1));
+  audio->AddCodec(cricket::AudioCodec(106, cricket::kCnCodecName, 32000, 0,
+                                      1));
+  audio->AddCodec(cricket::AudioCodec(126, cricket::kDtmfCodecName, 8000, 0,
+                                      1));
+  audio->AddRtpHeaderExtension(RtpExtension(RtpExtension::kAudioLevelUri, 1));
+  audio->AddRtpHeaderExtension(RtpExtension(RtpExtension::kAbsSendTimeUri, 2));
+  audio->AddRtpHeaderExtension(
+      RtpExtension(RtpExtension::kTransportSequenceNumberUri, 3));
+  audio->AddRtpHeaderExtension(RtpExtension(RtpExtension::kMidUri, 4));
+  cricket::StreamParams stream;
+  stream.id = "audio_track_" + mid;
+  stream.cname = "qPvN9hJW1SAoMMak";
+  stream.set_stream_ids({"stream_" + mid});
+  stream.ssrcs.push_back(ssrc);
+  audio->AddStream(stream);
+  return audio;
+}
+
+cricket::VideoContentDescription* CreateVideoContent(uint32_t ssrc,
+                                                     const std::string& mid) {
+  cricket::VideoContentDescription* video =
+      new cricket::VideoContentDescription();
+  video->set_protocol(cricket::kMediaProtocolDtlsSavpf);
+  video->set_rtcp_mux(true);
+  video->set_rtcp_reduced_size(true);
+  const char* const kCodecs[] = {cricket::kVp8CodecName,
+                                 cricket::kVp9CodecName,
+                                 cricket::kH264CodecName};
+  int payload_type = 96;
+  for (const char* name : kCodecs) {
+    cricket::VideoCodec codec(payload_type, name);
+    if (name == cricket::kH264CodecName) {
+      codec.SetParam(cricket::kH264FmtpLevelAsymmetryAllowed, "1");
+      codec.SetParam(cricket::kH264FmtpPacketizationMode, "1");
+      codec.SetParam(cricket::kH264FmtpProfileLevelId, "42e01f");
+    }
+    codec.AddFeedbackParam(cricket::FeedbackParam(
+        cricket::kRtcpFbParamCcm, cricket::kRtcpFbCcmParamFir));
+    codec.AddFeedbackParam(cricket::FeedbackParam(cricket::kRtcpFbParamNack));
+    codec.AddFeedbackParam(cricket::FeedbackParam(
+        cricket::kRtcpFbParamNack, cricket::kRtcpFbNackParamPli));
+    codec.AddFeedbackParam(cricket::FeedbackParam(cricket::kRtcpFbParamRemb));
+    codec.AddFeedbackParam(
+        cricket::FeedbackParam(cricket::kRtcpFbParamTransportCc));
+    video->AddCodec(codec);
+    video->AddCodec(
+        cricket::VideoCodec::CreateRtxCodec(payload_type + 1, payload_type));
+    payload_type += 2;
+  }
+  video->AddCodec(cricket::VideoCodec(payload_type++, cricket::kRedCodecName));
+  video->AddCodec(
+      cricket::VideoCodec(payload_type++, cricket::kUlpfecCodecName));
+  video->AddRtpHeaderExtension(
+      RtpExtension(RtpExtension::kTimestampOffsetUri, 2));
+  video->AddRtpHeaderExtension(RtpExtension(RtpExtension::kAbsSendTimeUri, 3));
+  video->AddRtpHeaderExtension(
+      RtpExtension(RtpExtension::kVideoRotationUri, 4));
+  video->AddRtpHeaderExtension(
+      RtpExtension(RtpExtension::kTransportSequenceNumberUri, 5));
+  video->AddRtpHeaderExtension(RtpExtension(RtpExtension::kMidUri, 6));
+  cricket::StreamParams stream;
+  stream.id = "video_track_" + mid;
+  stream.cname = "qPvN9hJW1SAoMMak";
+  stream.set_stream_ids({"stream_" + mid});
+  stream.ssrcs.push_back(ssrc);
+  stream.ssrcs.push_back(ssrc + 1);
+  stream.ssrc_groups.push_back(
+      cricket::SsrcGroup(cricket::kFidSsrcGroupSemantics, stream.ssrcs));
+  video->AddStream(stream);
+  return video;
+}
+
+// A bundled Unified Plan offer of an SFU, with an m= section for each of
+// |num_audio| audio and |num_video| video tracks.
+std::unique_ptr<JsepSessionDescription> CreateOffer(int num_audio,
+                                                    int num_video) {
+  std::unique_ptr<cricket::SessionDescription> desc(
+      new cricket::SessionDescription());
+  desc->set_msid_signaling(cricket::kMsidSignalingMediaSection);
+  cricket::ContentGroup bundle(cricket::GROUP_TYPE_BUNDLE);
+  const uint8_t kDigest[32] = {
+      0x19, 0xe5, 0x7c, 0x14, 0x4c, 0x41, 0x1f, 0xb3, 0xd1, 0x2b, 0xf9,
+      0x82, 0x4c, 0xa0, 0x19, 0x4b, 0x85, 0xa4, 0x5b, 0x56, 0x61, 0x33,
+      0xba, 0x77, 0x71, 0xad, 0x4f, 0x64, 0x4d, 0x68, 0x29, 0x1e};
+  const rtc::SSLFingerprint fingerprint(rtc::DIGEST_SHA_256, kDigest,
+                                        sizeof(kDigest));
+  uint32_t ssrc = 1000;
+  for (int i = 0; i < num_audio + num_video; ++i) {
+    const std::string mid = std::to_string(i);
+    if (i < num_audio) {
+      desc->AddContent(mid, cricket::MediaProtocolType::kRtp,
+                       CreateAudioContent(ssrc++, mid));
+    } else {
+      desc->AddContent(mid, cricket::MediaProtocolType::kRtp,
+                       CreateVideoContent(ssrc, mid));
+      ssrc += 2;
+    }
+    bundle.AddContentName(mid);
+    desc->AddTransportInfo(cricket::TransportInfo(
+        mid, cricket::TransportDescription(
+                 std::vector<std::string>(), "ufrag_abcd",
+                 "pwd_abcdefghijklmnopqrstuv", cricket::ICEMODE_FULL,
+                 cricket::CONNECTIONROLE_ACTPASS, &fingerprint)));
+  }
+  desc->AddGroup(bundle);
+
+  std::unique_ptr<JsepSessionDescription> offer(
+      new JsepSessionDescription(SdpType::kOffer));
+  offer->Initialize(desc.release(), "4611731400430051336", "2");
+  int port = 50000;
+  for (const char* ip : {"192.168.1.5", "10.0.0.5", "2001:db8::5"}) {
+    cricket::Candidate candidate(
+        cricket::ICE_CANDIDATE_COMPONENT_RTP, cricket::UDP_PROTOCOL_NAME,
+        rtc::SocketAddress(ip, port++), 2122260223, "ufrag_abcd",
+        "pwd_abcdefghijklmnopqrstuv", cricket::LOCAL_PORT_TYPE, 0, "1");
+    JsepIceCandidate jcandidate("0", 0, candidate);
+    offer->AddCandidate(&jcandidate);
+  }
+  return offer;
+}
+
+void MeasureSdp(const std::string& trace, int num_audio, int num_video) {
+  std::unique_ptr<JsepSessionDescription> offer =
+      CreateOffer(num_audio, num_video);
+
+  std::string sdp;
+  int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumIterations; ++i)
+    sdp = SdpSerialize(*offer);
+  const int64_t serialize_us = rtc::TimeMicros() - start_us;
+
+  start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumIterations; ++i) {
+    JsepSessionDescription parsed(SdpType::kOffer);
+    SdpParseError error;
+    ASSERT_TRUE(SdpDeserialize(sdp, &parsed, &error)) << error.description;
+    if (i == 0)
+      EXPECT_EQ(sdp, SdpSerialize(parsed));
+  }
+  const int64_t deserialize_us = rtc::TimeMicros() - start_us;
+
+  test::PrintResult("sdp_size", "", trace, sdp.size(), "bytes", false);
+  test::PrintResult("sdp_serialize", "", trace,
+                    static_cast<double>(serialize_us) / kNumIterations, "us",
+                    true);
+  test::PrintResult("sdp_deserialize", "", trace,
+                    static_cast<double>(deserialize_us) / kNumIterations, "us",
+                    true);
+}
+
+}  // namespace
+
+TEST(WebRtcSdpPerformanceTest, UnifiedPlanOffers) {
+  MeasureSdp("2_m_sections", 1, 1);
+  MeasureSdp("128_m_sections", 64, 64);
+}
+
+}  // namespace webrtc
@@ -38,6 +38,17 @@ MessageDigest* MessageDigestFactory::Create(const std::string& alg) {
   return digest;
 }
 
+MessageDigest* MessageDigestFactory::CreateHmac(const std::string& alg,
+                                                const void* key,
+                                                size_t key_len) {
+  MessageDigest* hmac = new OpenSSLHmac(alg, key, key_len);
+  if (hmac->Size() == 0) {  // invalid algorithm
+    delete hmac;
+    hmac = nullptr;
+  }
+  return hmac;
+}
+
 bool IsFips180DigestAlgorithm(const std::string& alg) {
   // These are the FIPS 180 algorithms.  According to RFC 4572 Section 5,
   // "Self-signed certificates (for which legacy certificates are not a
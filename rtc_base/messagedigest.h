@@ -41,6 +41,12 @@ class MessageDigest {
 class MessageDigestFactory {
  public:
   static MessageDigest* Create(const std::string& alg);
+  // Creates a digest that outputs the HMAC of its input with |key|. The key
+  // is processed once, so reusing the object for many inputs is cheaper than
+  // calling ComputeHmac() for each. Returns null for unknown algorithms.
+  static MessageDigest* CreateHmac(const std::string& alg,
+                                   const void* key,
+                                   size_t key_len);
 };
 
 // A whitelist of approved digest algorithms from RFC 4572 (FIPS 180).
@@ -9,6 +9,9 @@
  */
 
 #include "rtc_base/messagedigest.h"
+
+#include <memory>
+
 #include "rtc_base/gunit.h"
 #include "rtc_base/stringencode.h"
 
@@ -149,6 +152,25 @@ TEST(MessageDigestTest, TestBadHmac) {
   std::string output;
   EXPECT_FALSE(ComputeHmac("sha-9000", "key", "abc", &output));
   EXPECT_EQ("", ComputeHmac("sha-9000", "key", "abc"));
+  EXPECT_EQ(nullptr, MessageDigestFactory::CreateHmac("sha-9000", "key", 3));
+}
+
+TEST(MessageDigestTest, TestHmacWithKeptKey) {
+  const std::string key = "Jefe";
+  std::unique_ptr<MessageDigest> hmac(
+      MessageDigestFactory::CreateHmac(DIGEST_SHA_1, key.data(), key.size()));
+  ASSERT_TRUE(hmac);
+  // Each input after the first reuses the key.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+              ComputeDigest(hmac.get(), "what do ya want for nothing?"));
+  }
+  hmac->Update("what do ya ", 11);
+  hmac->Update("want for nothing?", 17);
+  char output[20];
+  EXPECT_EQ(sizeof(output), hmac->Finish(output, sizeof(output)));
+  EXPECT_EQ("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+            hex_encode(output, sizeof(output)));
 }
 
 }  // namespace rtc
@@ -9,6 +9,7 @@
  */
 #include <algorithm>
 
+#include "absl/types/optional.h"
 #include "rtc_base/atomicops.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -45,6 +46,115 @@ class RTC_SCOPED_LOCKABLE MarkProcessingCritScope {
 };
 }  // namespace
 
+struct MessageQueue::QueuedMessage {
+  Message msg;
+  // Trigger time of a delayed message; unused for other messages.
+  int64_t trigger_ms = 0;
+  bool delayed = false;
+  QueuedMessage* next = nullptr;
+};
+
+namespace {
+
+using QueuedMessage = MessageQueue::QueuedMessage;
+
+// A bounded lock-free pool of free message nodes, shared by all queues so that
+// posting does not allocate in steady state. This is the bounded MPMC queue
+// by Dmitry Vyukov; the per-cell sequence numbers make it safe against ABA
+// when nodes are taken and returned concurrently from any thread.
+class MessageNodePool {
+ public:
+  MessageNodePool() {
+    for (size_t i = 0; i < kCapacity; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  static MessageNodePool* Instance() {
+    static MessageNodePool* const instance = new MessageNodePool();
+    return instance;
+  }
+
+  QueuedMessage* Take() {
+    Cell* cell;
+    size_t pos = take_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & kMask];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (take_pos_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return new QueuedMessage();  // Empty.
+      } else {
+        pos = take_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    QueuedMessage* node = cell->node;
+    cell->sequence.store(pos + kMask + 1, std::memory_order_release);
+    return node;
+  }
+
+  void Return(QueuedMessage* node) {
+    *node = QueuedMessage();
+    Cell* cell;
+    size_t pos = return_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & kMask];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (return_pos_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        delete node;  // Full.
+        return;
+      } else {
+        pos = return_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->node = node;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+  }
+
+ private:
+  static constexpr size_t kCapacity = 1024;
+  static constexpr size_t kMask = kCapacity - 1;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    QueuedMessage* node;
+  };
+
+  Cell cells_[kCapacity];
+  std::atomic<size_t> take_pos_{0};
+  std::atomic<size_t> return_pos_{0};
+};
+
+QueuedMessage* NewNode(const Location& posted_from,
+                       MessageHandler* phandler,
+                       uint32_t id,
+                       MessageData* pdata) {
+  QueuedMessage* node = MessageNodePool::Instance()->Take();
+  node->msg.posted_from = posted_from;
+  node->msg.phandler = phandler;
+  node->msg.message_id = id;
+  node->msg.pdata = pdata;
+  return node;
+}
+
+void FreeNode(QueuedMessage* node) {
+  MessageNodePool::Instance()->Return(node);
+}
+
+}  // namespace
+
 //------------------------------------------------------------------
 // MessageQueueManager
 
@@ -149,7 +259,11 @@ void MessageQueueManager::ProcessAllMessageQueuesInternal() {
 // MessageQueue
 MessageQueue::MessageQueue(SocketServer* ss, bool init_queue)
     : fPeekKeep_(false),
-      dmsgq_next_num_(0),
+      incoming_(nullptr),
+      ready_head_(nullptr),
+      ready_tail_(nullptr),
+      ready_size_(0),
+      delayed_(TimeMillis()),
       fInitialized_(false),
       fDestroyed_(false),
       stop_(0),
@@ -268,25 +382,27 @@ bool MessageQueue::Get(Message* pmsg, int cmsWait, bool process_io) {
       // Otherwise, disposed MessageHandlers will cause deadlocks.
       {
         CritScope cs(&crit_);
+        TakeIncoming();
         // On the first pass, check for delayed messages that have been
         // triggered and calculate the next trigger time.
         if (first_pass) {
           first_pass = false;
-          while (!dmsgq_.empty()) {
-            if (msCurrent < dmsgq_.top().msTrigger_) {
-              cmsDelayNext = TimeDiff(dmsgq_.top().msTrigger_, msCurrent);
-              break;
-            }
-            msgq_.push_back(dmsgq_.top().msg_);
-            dmsgq_.pop();
-          }
+          MoveDueMessages(msCurrent);
+          absl::optional<int64_t> next_ms = delayed_.NextWakeupMs();
+          if (next_ms)
+            cmsDelayNext = std::max<int64_t>(0, TimeDiff(*next_ms, msCurrent));
         }
         // Pull a message off the message queue, if available.
-        if (msgq_.empty()) {
+        if (!ready_head_) {
           break;
         } else {
-          *pmsg = msgq_.front();
-          msgq_.pop_front();
+          QueuedMessage* node = ready_head_;
+          ready_head_ = node->next;
+          if (!ready_head_)
+            ready_tail_ = nullptr;
+          --ready_size_;
+          *pmsg = node->msg;
+          FreeNode(node);
         }
       }  // crit_ is released here.
 
@@ -351,23 +467,11 @@ void MessageQueue::Post(const Location& posted_from,
   if (IsQuitting())
     return;
 
-  // Keep thread safe
-  // Add the message to the end of the queue
-  // Signal for the multiplexer to return
-
-  {
-    CritScope cs(&crit_);
-    Message msg;
-    msg.posted_from = posted_from;
-    msg.phandler = phandler;
-    msg.message_id = id;
-    msg.pdata = pdata;
-    if (time_sensitive) {
-      msg.ts_sensitive = TimeMillis() + kMaxMsgLatency;
-    }
-    msgq_.push_back(msg);
+  QueuedMessage* node = NewNode(posted_from, phandler, id, pdata);
+  if (time_sensitive) {
+    node->msg.ts_sensitive = TimeMillis() + kMaxMsgLatency;
   }
-  WakeUpSocketServer();
+  PushIncoming(node);
 }
 
 void MessageQueue::PostDelayed(const Location& posted_from,
@@ -408,36 +512,23 @@ void MessageQueue::DoDelayPost(const Location& posted_from,
     return;
   }
 
-  // Keep thread safe
-  // Add to the priority queue. Gets sorted soonest first.
-  // Signal for the multiplexer to return.
-
-  {
-    CritScope cs(&crit_);
-    Message msg;
-    msg.posted_from = posted_from;
-    msg.phandler = phandler;
-    msg.message_id = id;
-    msg.pdata = pdata;
-    DelayedMessage dmsg(cmsDelay, tstamp, dmsgq_next_num_, msg);
-    dmsgq_.push(dmsg);
-    // If this message queue processes 1 message every millisecond for 50 days,
-    // we will wrap this number.  Even then, only messages with identical times
-    // will be misordered, and then only briefly.  This is probably ok.
-    ++dmsgq_next_num_;
-    RTC_DCHECK_NE(0, dmsgq_next_num_);
-  }
-  WakeUpSocketServer();
+  // The queue thread moves the message to the timer wheel.
+  QueuedMessage* node = NewNode(posted_from, phandler, id, pdata);
+  node->delayed = true;
+  node->trigger_ms = tstamp;
+  PushIncoming(node);
 }
 
 int MessageQueue::GetDelay() {
   CritScope cs(&crit_);
+  TakeIncoming();
 
-  if (!msgq_.empty())
+  if (ready_head_)
     return 0;
 
-  if (!dmsgq_.empty()) {
-    int delay = TimeUntil(dmsgq_.top().msTrigger_);
+  absl::optional<int64_t> next_ms = delayed_.NextWakeupMs();
+  if (next_ms) {
+    int delay = TimeUntil(*next_ms);
     if (delay < 0)
       delay = 0;
     return delay;
@@ -446,6 +537,82 @@ int MessageQueue::GetDelay() {
   return kForever;
 }
 
+size_t MessageQueue::size() const {
+  CritScope cs(&crit_);
+  size_t size = ready_size_ + delayed_.size() + (fPeekKeep_ ? 1u : 0u);
+  // Nodes on the incoming stack are only unlinked while holding |crit_|, so
+  // the stack can be walked safely here.
+  for (QueuedMessage* node = incoming_.load(std::memory_order_acquire); node;
+       node = node->next) {
+    ++size;
+  }
+  return size;
+}
+
+void MessageQueue::PushIncoming(QueuedMessage* node) {
+  // |node| belongs to the queue as soon as it is published, so whether the
+  // stack was empty is taken from |head| rather than from |node->next|.
+  QueuedMessage* head = incoming_.load(std::memory_order_relaxed);
+  do {
+    node->next = head;
+  } while (!incoming_.compare_exchange_weak(head, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed));
+  // Only the message that makes the stack non-empty signals for the
+  // multiplexer to return. The queue takes the whole stack at once, and a
+  // pending wakeup is not lost if it does so before waiting again.
+  if (!head)
+    WakeUpSocketServer();
+}
+
+void MessageQueue::TakeIncoming() {
+  QueuedMessage* node = incoming_.exchange(nullptr, std::memory_order_acquire);
+  if (!node)
+    return;
+  // Reverse the stack into posting order.
+  QueuedMessage* next = nullptr;
+  while (node) {
+    QueuedMessage* below = node->next;
+    node->next = next;
+    next = node;
+    node = below;
+  }
+  bool has_delayed = false;
+  while (next) {
+    node = next;
+    next = node->next;
+    if (node->delayed) {
+      if (!has_delayed) {
+        // Let the timer wheel follow the clock before filing, in case it
+        // went backwards.
+        MoveDueMessages(TimeMillis());
+        has_delayed = true;
+      }
+      delayed_.Insert(node->trigger_ms, node);
+    } else {
+      AppendReady(node);
+    }
+  }
+}
+
+void MessageQueue::MoveDueMessages(int64_t now_ms) {
+  delayed_.Advance(now_ms, &due_);
+  for (QueuedMessage* node : due_)
+    AppendReady(node);
+  due_.clear();
+}
+
+void MessageQueue::AppendReady(QueuedMessage* node) {
+  node->next = nullptr;
+  if (ready_tail_) {
+    ready_tail_->next = node;
+  } else {
+    ready_head_ = node;
+  }
+  ready_tail_ = node;
+  ++ready_size_;
+}
+
 void MessageQueue::Clear(MessageHandler* phandler,
                          uint32_t id,
                          MessageList* removed) {
@@ -467,38 +634,60 @@ void MessageQueue::ClearInternal(MessageHandler* phandler,
     fPeekKeep_ = false;
   }
 
-  // Remove from ordered message queue
+  TakeIncoming();
 
-  for (MessageList::iterator it = msgq_.begin(); it != msgq_.end();) {
-    if (it->Match(phandler, id)) {
-      if (removed) {
-        removed->push_back(*it);
-      } else {
-        delete it->pdata;
-      }
-      it = msgq_.erase(it);
-    } else {
-      ++it;
-    }
-  }
+  // The nodes of the removed messages are collected on |erased| and their
+  // data only deleted once both queues are consistent again, since deleting
+  // the data may clear this queue again, re-entrantly.
+  QueuedMessage* erased = nullptr;
 
-  // Remove from priority queue. Not directly iterable, so use this approach
+  // Remove from ordered message queue
 
-  PriorityQueue::container_type::iterator new_end = dmsgq_.container().begin();
-  for (PriorityQueue::container_type::iterator it = new_end;
-       it != dmsgq_.container().end(); ++it) {
-    if (it->msg_.Match(phandler, id)) {
-      if (removed) {
-        removed->push_back(it->msg_);
+  QueuedMessage* kept_head = nullptr;
+  QueuedMessage* kept_tail = nullptr;
+  size_t kept_size = 0;
+  for (QueuedMessage* node = ready_head_; node;) {
+    QueuedMessage* next = node->next;
+    if (node->msg.Match(phandler, id)) {
+      if (removed)
+        removed->push_back(node->msg);
+      node->next = erased;
+      erased = node;
+    } else {
+      node->next = nullptr;
+      if (kept_tail) {
+        kept_tail->next = node;
       } else {
-        delete it->msg_.pdata;
+        kept_head = node;
       }
-    } else {
-      *new_end++ = *it;
+      kept_tail = node;
+      ++kept_size;
     }
+    node = next;
+  }
+  ready_head_ = kept_head;
+  ready_tail_ = kept_tail;
+  ready_size_ = kept_size;
+
+  // Remove from the timer wheel
+
+  delayed_.EraseIf([phandler, id, removed, &erased](QueuedMessage*& node) {
+    if (!node->msg.Match(phandler, id))
+      return false;
+    if (removed)
+      removed->push_back(node->msg);
+    node->next = erased;
+    erased = node;
+    return true;
+  });
+
+  while (erased) {
+    QueuedMessage* node = erased;
+    erased = node->next;
+    if (!removed)
+      delete node->msg.pdata;
+    FreeNode(node);
   }
-  dmsgq_.container().erase(new_end, dmsgq_.container().end());
-  dmsgq_.reheap();
 }
 
 void MessageQueue::Dispatch(Message* pmsg) {
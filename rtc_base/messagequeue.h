@@ -14,9 +14,9 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <memory>
-#include <queue>
 #include <utility>
 #include <vector>
 
@@ -28,6 +28,7 @@
 #include "rtc_base/socketserver.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread_annotations.h"
+#include "rtc_base/timer_wheel.h"
 #include "rtc_base/timeutils.h"
 
 namespace rtc {
@@ -168,28 +169,6 @@ struct Message {
 
 typedef std::list<Message> MessageList;
 
-// DelayedMessage goes into a priority queue, sorted by trigger time.  Messages
-// with the same trigger time are processed in num_ (FIFO) order.
-
-class DelayedMessage {
- public:
-  DelayedMessage(int64_t delay,
-                 int64_t trigger,
-                 uint32_t num,
-                 const Message& msg)
-      : cmsDelay_(delay), msTrigger_(trigger), num_(num), msg_(msg) {}
-
-  bool operator<(const DelayedMessage& dmsg) const {
-    return (dmsg.msTrigger_ < msTrigger_) ||
-           ((dmsg.msTrigger_ == msTrigger_) && (dmsg.num_ < num_));
-  }
-
-  int64_t cmsDelay_;  // for debugging
-  int64_t msTrigger_;
-  uint32_t num_;
-  Message msg_;
-};
-
 class MessageQueue {
  public:
   static const int kForever = -1;
@@ -263,10 +242,7 @@ class MessageQueue {
   virtual int GetDelay();
 
   bool empty() const { return size() == 0u; }
-  size_t size() const {
-    CritScope cs(&crit_);  // msgq_.size() is not thread safe.
-    return msgq_.size() + dmsgq_.size() + (fPeekKeep_ ? 1u : 0u);
-  }
+  size_t size() const;
 
   // Internally posts a message which causes the doomed object to be deleted
   template <class T>
@@ -280,13 +256,11 @@ class MessageQueue {
   // no longer be used.
   sigslot::signal0<> SignalQueueDestroyed;
 
- protected:
-  class PriorityQueue : public std::priority_queue<DelayedMessage> {
-   public:
-    container_type& container() { return c; }
-    void reheap() { make_heap(c.begin(), c.end(), comp); }
-  };
+  // A posted message, linked into the queue's internal lists. Nodes are
+  // recycled through a pool shared by all queues. Defined in messagequeue.cc.
+  struct QueuedMessage;
 
+ protected:
   void DoDelayPost(const Location& posted_from,
                    int64_t cmsDelay,
                    int64_t tstamp,
@@ -310,11 +284,26 @@ class MessageQueue {
 
   void WakeUpSocketServer();
 
+  // Pushes |node| onto |incoming_| without taking |crit_|.
+  void PushIncoming(QueuedMessage* node);
+  // Moves messages posted since the last call from |incoming_| to |ready_| and
+  // |delayed_|, in posting order.
+  void TakeIncoming() RTC_EXCLUSIVE_LOCKS_REQUIRED(&crit_);
+  // Moves delayed messages that are due at |now_ms| to the end of |ready_|.
+  void MoveDueMessages(int64_t now_ms) RTC_EXCLUSIVE_LOCKS_REQUIRED(&crit_);
+  void AppendReady(QueuedMessage* node) RTC_EXCLUSIVE_LOCKS_REQUIRED(&crit_);
+
   bool fPeekKeep_;
   Message msgPeek_;
-  MessageList msgq_ RTC_GUARDED_BY(crit_);
-  PriorityQueue dmsgq_ RTC_GUARDED_BY(crit_);
-  uint32_t dmsgq_next_num_ RTC_GUARDED_BY(crit_);
+  // Messages posted from any thread and not yet looked at by the queue, most
+  // recent first. Posting pushes onto this stack without taking |crit_|.
+  std::atomic<QueuedMessage*> incoming_;
+  // Messages ready to be dispatched, in order.
+  QueuedMessage* ready_head_ RTC_GUARDED_BY(crit_);
+  QueuedMessage* ready_tail_ RTC_GUARDED_BY(crit_);
+  size_t ready_size_ RTC_GUARDED_BY(crit_);
+  TimerWheel<QueuedMessage*> delayed_ RTC_GUARDED_BY(crit_);
+  std::vector<QueuedMessage*> due_ RTC_GUARDED_BY(crit_);
   CriticalSection crit_;
   bool fInitialized_;
   bool fDestroyed_;
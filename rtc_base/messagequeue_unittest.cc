@@ -120,6 +120,18 @@ TEST_F(MessageQueueTest, DiposeHandlerWithPostedMessagePending) {
   EXPECT_TRUE(deleted);
 }
 
+// Message nodes are recycled; one that held a delayed message must not delay
+// the next message posted with it.
+TEST_F(MessageQueueTest, PostAfterClearedDelayedPostsIsNotDelayed) {
+  for (int i = 0; i < 2000; ++i)
+    PostDelayed(RTC_FROM_HERE, 100000, nullptr, 1);
+  Clear(nullptr);
+  Post(RTC_FROM_HERE, nullptr, 2);
+  Message msg;
+  EXPECT_TRUE(Get(&msg, 0));
+  EXPECT_EQ(2u, msg.message_id);
+}
+
 struct UnwrapMainThreadScope {
   UnwrapMainThreadScope() : rewrap_(Thread::Current() != nullptr) {
     if (rewrap_)
@@ -12,6 +12,7 @@
 #define RTC_BASE_OPENSSLDIGEST_H_
 
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 
 #include "rtc_base/messagedigest.h"
 
@@ -42,6 +43,22 @@ class OpenSSLDigest : public MessageDigest {
   const EVP_MD* md_;
 };
 
+// A digest that outputs the HMAC of its input with a fixed key. The key is
+// only processed at construction; Finish() rearms the same key for the next
+// input.
+class OpenSSLHmac : public MessageDigest {
+ public:
+  OpenSSLHmac(const std::string& algorithm, const void* key, size_t key_len);
+  ~OpenSSLHmac() override;
+  size_t Size() const override;
+  void Update(const void* buf, size_t len) override;
+  size_t Finish(void* buf, size_t len) override;
+
+ private:
+  HMAC_CTX* ctx_ = nullptr;
+  const EVP_MD* md_;
+};
+
 }  // namespace rtc
 
 #endif  // RTC_BASE_OPENSSLDIGEST_H_
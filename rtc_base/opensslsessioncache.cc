@@ -9,15 +9,37 @@
  */
 
 #include "rtc_base/opensslsessioncache.h"
+
+#include <time.h>
+
+#include <iterator>
+
 #include "rtc_base/checks.h"
 #include "rtc_base/openssl.h"
 
 namespace rtc {
 
-OpenSSLSessionCache::OpenSSLSessionCache(SSLMode ssl_mode, SSL_CTX* ssl_ctx)
-    : ssl_mode_(ssl_mode), ssl_ctx_(ssl_ctx) {
+namespace {
+
+bool IsExpired(const SSL_SESSION* session, int64_t now) {
+  // OpenSSL and BoringSSL disagree on the integer types of these.
+  const int64_t time = static_cast<int64_t>(SSL_SESSION_get_time(session));
+  const int64_t timeout =
+      static_cast<int64_t>(SSL_SESSION_get_timeout(session));
+  return time + timeout <= now;
+}
+
+}  // namespace
+
+const size_t OpenSSLSessionCache::kDefaultMaxSessions;
+
+OpenSSLSessionCache::OpenSSLSessionCache(SSLMode ssl_mode,
+                                         SSL_CTX* ssl_ctx,
+                                         size_t max_sessions)
+    : ssl_mode_(ssl_mode), ssl_ctx_(ssl_ctx), max_sessions_(max_sessions) {
   // It is invalid to pass in a null context.
   RTC_DCHECK(ssl_ctx != nullptr);
+  RTC_DCHECK_GT(max_sessions, 0);
   SSL_CTX_up_ref(ssl_ctx);
 }
 
@@ -28,17 +50,34 @@ OpenSSLSessionCache::~OpenSSLSessionCache() {
   SSL_CTX_free(ssl_ctx_);
 }
 
-SSL_SESSION* OpenSSLSessionCache::LookupSession(
-    const std::string& hostname) const {
-  auto it = sessions_.find(hostname);
-  return (it != sessions_.end()) ? it->second : nullptr;
+SSL_SESSION* OpenSSLSessionCache::LookupSession(const std::string& hostname) {
+  auto it = session_index_.find(hostname);
+  if (it == session_index_.end())
+    return nullptr;
+  SessionList::iterator entry = it->second;
+  if (IsExpired(entry->second, time(nullptr))) {
+    RemoveSession(entry);
+    return nullptr;
+  }
+  // Most recently used first.
+  sessions_.splice(sessions_.begin(), sessions_, entry);
+  return entry->second;
 }
 
 void OpenSSLSessionCache::AddSession(const std::string& hostname,
                                      SSL_SESSION* new_session) {
-  SSL_SESSION* old_session = LookupSession(hostname);
-  SSL_SESSION_free(old_session);
-  sessions_[hostname] = new_session;
+  auto it = session_index_.find(hostname);
+  if (it != session_index_.end())
+    RemoveSession(it->second);
+  RemoveExpiredSessions();
+  while (sessions_.size() >= max_sessions_)
+    RemoveSession(std::prev(sessions_.end()));
+  sessions_.emplace_front(hostname, new_session);
+  session_index_[hostname] = sessions_.begin();
+}
+
+size_t OpenSSLSessionCache::size() const {
+  return sessions_.size();
 }
 
 SSL_CTX* OpenSSLSessionCache::GetSSLContext() const {
@@ -49,4 +88,20 @@ SSLMode OpenSSLSessionCache::GetSSLMode() const {
   return ssl_mode_;
 }
 
+void OpenSSLSessionCache::RemoveSession(SessionList::iterator it) {
+  SSL_SESSION_free(it->second);
+  session_index_.erase(it->first);
+  sessions_.erase(it);
+}
+
+void OpenSSLSessionCache::RemoveExpiredSessions() {
+  const int64_t now = time(nullptr);
+  for (auto it = sessions_.begin(); it != sessions_.end();) {
+    auto next = std::next(it);
+    if (IsExpired(it->second, now))
+      RemoveSession(it);
+    it = next;
+  }
+}
+
 }  // namespace rtc
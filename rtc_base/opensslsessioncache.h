@@ -12,8 +12,10 @@
 #define RTC_BASE_OPENSSLSESSIONCACHE_H_
 
 #include <openssl/ossl_typ.h>
+#include <list>
 #include <map>
 #include <string>
+#include <utility>
 
 #include "rtc_base/constructormagic.h"
 #include "rtc_base/sslstreamadapter.h"
@@ -26,20 +28,32 @@ namespace rtc {
 
 // The OpenSSLSessionCache maps hostnames to SSL_SESSIONS. This cache is
 // owned by the OpenSSLAdapterFactory and is passed down to each OpenSSLAdapter
-// created with the factory.
-class OpenSSLSessionCache final {
+// created with the factory. In DTLS mode it is shared by OpenSSLStreamAdapters
+// instead; they key the sessions by peer certificate digest and take the
+// session ticket keys from the SSL_CTX. Expired sessions are dropped, and once
+// the cache is full the least recently used session is evicted.
+class OpenSSLSessionCache final : public SSLSessionCache {
  public:
+  static const size_t kDefaultMaxSessions = 1000;
+
   // Creates a new OpenSSLSessionCache using the provided the SSL_CTX and
   // the ssl_mode. The SSL_CTX will be up_refed. ssl_ctx cannot be nullptr,
-  // the constructor immediately dchecks this.
-  OpenSSLSessionCache(SSLMode ssl_mode, SSL_CTX* ssl_ctx);
+  // the constructor immediately dchecks this. At most |max_sessions| sessions
+  // are kept.
+  OpenSSLSessionCache(SSLMode ssl_mode,
+                      SSL_CTX* ssl_ctx,
+                      size_t max_sessions = kDefaultMaxSessions);
   // Frees the cached SSL_SESSIONS and then frees the SSL_CTX.
-  ~OpenSSLSessionCache();
+  ~OpenSSLSessionCache() override;
   // Looks up a session by hostname. The returned SSL_SESSION is not up_refed.
-  SSL_SESSION* LookupSession(const std::string& hostname) const;
-  // Adds a session to the cache, and up_refs it. Any existing session with the
-  // same hostname is replaced.
+  // Returns nullptr if the session has expired, and frees it.
+  SSL_SESSION* LookupSession(const std::string& hostname);
+  // Adds a session to the cache and takes ownership of it. Any existing
+  // session with the same hostname is replaced.
   void AddSession(const std::string& hostname, SSL_SESSION* session);
+  // The number of sessions in the cache, including expired sessions that have
+  // not been dropped yet.
+  size_t size() const;
   // Returns the true underlying SSL Context that holds these cached sessions.
   SSL_CTX* GetSSLContext() const;
   // The SSL Mode tht the OpenSSLSessionCache was constructed with. This cannot
@@ -54,10 +68,19 @@ class OpenSSLSessionCache final {
   //  with SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT); Meaning
   //  all client sessions will be added to the cache internal to the context.
   SSL_CTX* ssl_ctx_ = nullptr;
-  // Map of hostnames to SSL_SESSIONs; holds references to the SSL_SESSIONs,
-  // which are cleaned up when the factory is destroyed.
-  // TODO(juberti): Add LRU eviction to keep the cache from growing forever.
-  std::map<std::string, SSL_SESSION*> sessions_;
+  typedef std::list<std::pair<std::string, SSL_SESSION*>> SessionList;
+
+  // Frees the session at |it| and removes it from the cache.
+  void RemoveSession(SessionList::iterator it);
+  // Frees all expired sessions.
+  void RemoveExpiredSessions();
+
+  const size_t max_sessions_;
+  // Hostnames and SSL_SESSIONs, most recently used first; holds references to
+  // the SSL_SESSIONs, which are cleaned up when the factory is destroyed.
+  SessionList sessions_;
+  // Map of hostnames to their entries in |sessions_|.
+  std::map<std::string, SessionList::iterator> session_index_;
   // The cache should never be copied or assigned directly.
   RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLSessionCache);
 };
@@ -78,6 +78,55 @@ TEST(OpenSSLSessionCache, AddToExistingReplacesPrevious) {
   session_cache.AddSession("webrtc.org", ssl_session_1);
   session_cache.AddSession("webrtc.org", ssl_session_2);
   EXPECT_EQ(session_cache.LookupSession("webrtc.org"), ssl_session_2);
+  EXPECT_EQ(session_cache.size(), 1u);
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLSessionCache, EvictsLeastRecentlyUsedSession) {
+  SSL_CTX* ssl_ctx = SSL_CTX_new(DTLSv1_2_client_method());
+  SSL_SESSION* ssl_session_1 = SSL_SESSION_new(ssl_ctx);
+  SSL_SESSION* ssl_session_2 = SSL_SESSION_new(ssl_ctx);
+  SSL_SESSION* ssl_session_3 = SSL_SESSION_new(ssl_ctx);
+
+  OpenSSLSessionCache session_cache(SSL_MODE_DTLS, ssl_ctx, 2);
+  session_cache.AddSession("1", ssl_session_1);
+  session_cache.AddSession("2", ssl_session_2);
+  // Makes "2" the least recently used session.
+  EXPECT_EQ(session_cache.LookupSession("1"), ssl_session_1);
+  session_cache.AddSession("3", ssl_session_3);
+  EXPECT_EQ(session_cache.size(), 2u);
+  EXPECT_EQ(session_cache.LookupSession("2"), nullptr);
+  EXPECT_EQ(session_cache.LookupSession("1"), ssl_session_1);
+  EXPECT_EQ(session_cache.LookupSession("3"), ssl_session_3);
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLSessionCache, ExpiredSessionIsNotReturned) {
+  SSL_CTX* ssl_ctx = SSL_CTX_new(DTLSv1_2_client_method());
+  SSL_SESSION* ssl_session = SSL_SESSION_new(ssl_ctx);
+  SSL_SESSION_set_time(ssl_session, 1);
+
+  OpenSSLSessionCache session_cache(SSL_MODE_DTLS, ssl_ctx);
+  session_cache.AddSession("webrtc.org", ssl_session);
+  EXPECT_EQ(session_cache.LookupSession("webrtc.org"), nullptr);
+  EXPECT_EQ(session_cache.size(), 0u);
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLSessionCache, AddDropsExpiredSessions) {
+  SSL_CTX* ssl_ctx = SSL_CTX_new(DTLSv1_2_client_method());
+  SSL_SESSION* expired_session = SSL_SESSION_new(ssl_ctx);
+  SSL_SESSION_set_time(expired_session, 1);
+  SSL_SESSION* ssl_session = SSL_SESSION_new(ssl_ctx);
+
+  OpenSSLSessionCache session_cache(SSL_MODE_DTLS, ssl_ctx);
+  session_cache.AddSession("expired", expired_session);
+  session_cache.AddSession("webrtc.org", ssl_session);
+  EXPECT_EQ(session_cache.size(), 1u);
+  EXPECT_EQ(session_cache.LookupSession("webrtc.org"), ssl_session);
 
   SSL_CTX_free(ssl_ctx);
 }
@@ -13,6 +13,7 @@
 #include <openssl/bio.h>
 #include <openssl/crypto.h>
 #include <openssl/err.h>
+#include <openssl/evp.h>
 #include <openssl/rand.h>
 #include <openssl/tls1.h>
 #include <openssl/x509v3.h>
@@ -24,15 +25,19 @@
 #include <memory>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/criticalsection.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/openssl.h"
 #include "rtc_base/openssladapter.h"
 #include "rtc_base/openssldigest.h"
 #include "rtc_base/opensslidentity.h"
+#include "rtc_base/refcountedobject.h"
 #include "rtc_base/stream.h"
 #include "rtc_base/stringutils.h"
+#include "rtc_base/task_pool.h"
 #include "rtc_base/thread.h"
 #include "rtc_base/timeutils.h"
 
@@ -266,6 +271,79 @@ static long stream_ctrl(BIO* b, int cmd, long num, void* ptr) {
 // OpenSSLStreamAdapter
 /////////////////////////////////////////////////////////////////////////////
 
+#ifdef OPENSSL_IS_BORINGSSL
+// A signature that the handshake offload pool computes for an adapter. The
+// pool task holds a reference until it is done, so the adapter can go away
+// meanwhile; it calls Cancel() first.
+class OpenSSLStreamAdapter::PrivateKeyOperation : public RefCountInterface {
+ public:
+  PrivateKeyOperation(OpenSSLStreamAdapter* adapter,
+                      EVP_PKEY* key,
+                      const EVP_MD* md,
+                      const uint8_t* in,
+                      size_t in_len)
+      : thread_(Thread::Current()),
+        key_(key),
+        md_(md),
+        input_(in, in_len),
+        adapter_(adapter) {
+    EVP_PKEY_up_ref(key_);
+  }
+
+  // Called on the pool. Posts MSG_PRIVATE_KEY_OPERATION_DONE to the adapter
+  // when done, unless cancelled.
+  void Run() {
+    Buffer signature(EVP_PKEY_size(key_));
+    size_t signature_len = signature.size();
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    const bool ok =
+        ctx && EVP_DigestSignInit(ctx, nullptr, md_, nullptr, key_) &&
+        EVP_DigestSign(ctx, signature.data(), &signature_len, input_.data(),
+                       input_.size());
+    EVP_MD_CTX_free(ctx);
+    signature.SetSize(ok ? signature_len : 0);
+
+    CritScope cs(&crit_);
+    done_ = true;
+    ok_ = ok;
+    signature_ = std::move(signature);
+    if (adapter_) {
+      thread_->Post(RTC_FROM_HERE, adapter_, MSG_PRIVATE_KEY_OPERATION_DONE);
+    }
+  }
+
+  void Cancel() {
+    CritScope cs(&crit_);
+    adapter_ = nullptr;
+  }
+
+  // Returns false if the operation is still running. Otherwise sets |ok| and
+  // moves the signature to |signature|.
+  bool TakeResult(bool* ok, Buffer* signature) {
+    CritScope cs(&crit_);
+    if (!done_)
+      return false;
+    *ok = ok_;
+    *signature = std::move(signature_);
+    return true;
+  }
+
+ protected:
+  ~PrivateKeyOperation() override { EVP_PKEY_free(key_); }
+
+ private:
+  Thread* const thread_;
+  EVP_PKEY* const key_;
+  const EVP_MD* const md_;
+  const Buffer input_;
+  CriticalSection crit_;
+  OpenSSLStreamAdapter* adapter_ RTC_GUARDED_BY(crit_);
+  bool done_ RTC_GUARDED_BY(crit_) = false;
+  bool ok_ RTC_GUARDED_BY(crit_) = false;
+  Buffer signature_ RTC_GUARDED_BY(crit_);
+};
+#endif  // OPENSSL_IS_BORINGSSL
+
 OpenSSLStreamAdapter::OpenSSLStreamAdapter(StreamInterface* stream)
     : SSLStreamAdapter(stream),
       state_(SSL_NONE),
@@ -397,6 +475,10 @@ int OpenSSLStreamAdapter::GetSslVersion() const {
 }
 
 // Key Extractor interface
+bool OpenSSLStreamAdapter::IsSessionResumed() const {
+  return state_ == SSL_CONNECTED && SSL_session_reused(ssl_);
+}
+
 bool OpenSSLStreamAdapter::ExportKeyingMaterial(const std::string& label,
                                                 const uint8_t* context,
                                                 size_t context_len,
@@ -504,6 +586,16 @@ void OpenSSLStreamAdapter::SetInitialRetransmissionTimeout(int timeout_ms) {
   dtls_handshake_timeout_ms_ = timeout_ms;
 }
 
+void OpenSSLStreamAdapter::SetSessionCache(SSLSessionCache* session_cache) {
+  RTC_DCHECK(ssl_ctx_ == nullptr);
+  session_cache_ = static_cast<OpenSSLSessionCache*>(session_cache);
+}
+
+void OpenSSLStreamAdapter::SetHandshakeOffloadPool(TaskPool* pool) {
+  RTC_DCHECK(ssl_ctx_ == nullptr);
+  handshake_offload_pool_ = pool;
+}
+
 //
 // StreamInterface Implementation
 //
@@ -785,6 +877,15 @@ int OpenSSLStreamAdapter::BeginSSL() {
 
   SSL_set_app_data(ssl_, this);
 
+  if (session_cache_ && role_ == SSL_CLIENT && has_peer_certificate_digest()) {
+    SSL_SESSION* session = session_cache_->LookupSession(SessionCacheKey());
+    if (session) {
+      RTC_LOG(LS_INFO) << "Offering to resume the last session with the peer.";
+      if (!SSL_set_session(ssl_, session))
+        return -1;
+    }
+  }
+
   SSL_set_bio(ssl_, bio, bio);  // the SSL object owns the bio now.
   if (ssl_mode_ == SSL_MODE_DTLS) {
 #ifdef OPENSSL_IS_BORINGSSL
@@ -799,6 +900,17 @@ int OpenSSLStreamAdapter::BeginSSL() {
   SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE |
                          SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 
+#ifdef OPENSSL_IS_BORINGSSL
+  // Only ECDSA signatures are worth a thread hop; with RSA keys the handshake
+  // stays on this thread.
+  if (handshake_offload_pool_ && identity_ &&
+      EVP_PKEY_id(SSL_get_privatekey(ssl_)) == EVP_PKEY_EC) {
+    static const SSL_PRIVATE_KEY_METHOD kOffloadPoolKeyMethod = {
+        SignOnOffloadPool, DecryptOnOffloadPool, CompleteOnOffloadPool};
+    SSL_set_private_key_method(ssl_, &kOffloadPoolKeyMethod);
+  }
+#endif
+
 #if !defined(OPENSSL_IS_BORINGSSL)
   // Specify an ECDH group for ECDHE ciphers, otherwise OpenSSL cannot
   // negotiate them when acting as the server. Use NIST's P-256 which is
@@ -828,6 +940,33 @@ int OpenSSLStreamAdapter::ContinueSSL() {
   switch (ssl_error = SSL_get_error(ssl_, code)) {
     case SSL_ERROR_NONE:
       RTC_LOG(LS_VERBOSE) << " -- success";
+      if (!peer_cert_chain_ && SSL_session_reused(ssl_)) {
+        // The peer doesn't send its certificate when a session is resumed,
+        // so SSLVerifyCallback isn't called. Take the certificate from the
+        // session and verify it here instead.
+        RTC_LOG(LS_INFO) << "Resumed a session with the peer.";
+#if defined(OPENSSL_IS_BORINGSSL)
+        STACK_OF(X509)* chain = SSL_get_peer_full_cert_chain(ssl_);
+        if (chain) {
+          std::vector<std::unique_ptr<SSLCertificate>> cert_chain;
+          for (X509* cert : chain) {
+            cert_chain.emplace_back(new OpenSSLCertificate(cert));
+          }
+          peer_cert_chain_.reset(new SSLCertChain(std::move(cert_chain)));
+        }
+#else
+        X509* cert = SSL_get_peer_certificate(ssl_);
+        if (cert) {
+          peer_cert_chain_.reset(
+              new SSLCertChain(new OpenSSLCertificate(cert)));
+          X509_free(cert);
+        }
+#endif
+        if (has_peer_certificate_digest() && !VerifyPeerCertificate()) {
+          SignalSSLHandshakeError(SSLHandshakeError::UNKNOWN);
+          return -1;
+        }
+      }
       // By this point, OpenSSL should have given us a certificate, or errored
       // out if one was missing.
       RTC_DCHECK(peer_cert_chain_ || !client_auth_enabled());
@@ -862,6 +1001,13 @@ int OpenSSLStreamAdapter::ContinueSSL() {
       RTC_LOG(LS_VERBOSE) << " -- error want write";
       break;
 
+#ifdef OPENSSL_IS_BORINGSSL
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
+      // Continued on MSG_PRIVATE_KEY_OPERATION_DONE.
+      RTC_LOG(LS_VERBOSE) << " -- waiting for private key operation";
+      break;
+#endif
+
     case SSL_ERROR_ZERO_RETURN:
     default:
       RTC_LOG(LS_VERBOSE) << " -- error " << code;
@@ -928,8 +1074,16 @@ void OpenSSLStreamAdapter::Cleanup(uint8_t alert) {
   identity_.reset();
   peer_cert_chain_.reset();
 
+#ifdef OPENSSL_IS_BORINGSSL
+  if (private_key_operation_) {
+    private_key_operation_->Cancel();
+    private_key_operation_ = nullptr;
+  }
+#endif
+
   // Clear the DTLS timer
   Thread::Current()->Clear(this, MSG_TIMEOUT);
+  Thread::Current()->Clear(this, MSG_PRIVATE_KEY_OPERATION_DONE);
 }
 
 void OpenSSLStreamAdapter::OnMessage(Message* msg) {
@@ -938,6 +1092,11 @@ void OpenSSLStreamAdapter::OnMessage(Message* msg) {
     RTC_LOG(LS_INFO) << "DTLS timeout expired";
     DTLSv1_handle_timeout(ssl_);
     ContinueSSL();
+  } else if (MSG_PRIVATE_KEY_OPERATION_DONE == msg->message_id) {
+    if (state_ == SSL_CONNECTING) {
+      if (int err = ContinueSSL())
+        Error("ContinueSSL", err, 0, true);
+    }
   } else {
     StreamInterface::OnMessage(msg);
   }
@@ -1054,6 +1213,30 @@ SSL_CTX* OpenSSLStreamAdapter::SetupSSLContext() {
     }
   }
 
+  if (session_cache_) {
+    RTC_DCHECK_EQ(session_cache_->GetSSLMode(), ssl_mode_);
+    // All the adapters that share the cache use its session ticket keys, so
+    // that a server can resume the sessions of the tickets that another one
+    // issued. The session ID context must match too, and OpenSSL requires
+    // one to resume sessions with client certificates.
+    static const unsigned char kSessionIdContext[] = "WebRTC";
+    SSL_CTX* cache_ctx = session_cache_->GetSSLContext();
+    Buffer keys(SSL_CTX_get_tlsext_ticket_keys(cache_ctx, nullptr, 0));
+    if (!SSL_CTX_get_tlsext_ticket_keys(cache_ctx, keys.data(), keys.size()) ||
+        !SSL_CTX_set_tlsext_ticket_keys(ctx, keys.data(), keys.size()) ||
+        !SSL_CTX_set_session_id_context(ctx, kSessionIdContext,
+                                        sizeof(kSessionIdContext) - 1)) {
+      SSL_CTX_free(ctx);
+      return nullptr;
+    }
+    // Servers don't need to store sessions, their tickets hold them. Clients
+    // store them in |session_cache_| only; OpenSSL makes the sessions in the
+    // internal store of |ctx| unresumable when it frees |ctx|.
+    SSL_CTX_set_session_cache_mode(
+        ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, NewSSLSessionCallback);
+  }
+
   return ctx;
 }
 
@@ -1131,6 +1314,94 @@ int OpenSSLStreamAdapter::SSLVerifyCallback(X509_STORE_CTX* store, void* arg) {
   return 1;
 }
 
+int OpenSSLStreamAdapter::NewSSLSessionCallback(SSL* ssl,
+                                                SSL_SESSION* session) {
+  OpenSSLStreamAdapter* stream =
+      reinterpret_cast<OpenSSLStreamAdapter*>(SSL_get_app_data(ssl));
+  // Without a verified certificate there is no digest to key the session by.
+  if (!stream->session_cache_ || !stream->peer_certificate_verified_)
+    return 0;
+  RTC_LOG(LS_INFO) << "Caching the session with the peer.";
+  // Returning 1 tells OpenSSL that the cache took ownership of the session.
+  stream->session_cache_->AddSession(stream->SessionCacheKey(), session);
+  return 1;
+}
+
+std::string OpenSSLStreamAdapter::SessionCacheKey() const {
+  RTC_DCHECK(has_peer_certificate_digest());
+  std::string key = peer_certificate_digest_algorithm_ + ":";
+  key.append(peer_certificate_digest_value_.data<char>(),
+             peer_certificate_digest_value_.size());
+  // The server verifies the client certificate of the session against the
+  // digest it expects, so only resume the sessions of the same identity.
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  size_t digest_length;
+  if (identity_ &&
+      identity_->certificate().ComputeDigest(DIGEST_SHA_256, digest,
+                                             sizeof(digest), &digest_length)) {
+    key.append(":");
+    key.append(reinterpret_cast<const char*>(digest), digest_length);
+  }
+  return key;
+}
+
+#ifdef OPENSSL_IS_BORINGSSL
+ssl_private_key_result_t OpenSSLStreamAdapter::SignOnOffloadPool(
+    SSL* ssl,
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out,
+    uint16_t signature_algorithm,
+    const uint8_t* in,
+    size_t in_len) {
+  OpenSSLStreamAdapter* stream =
+      reinterpret_cast<OpenSSLStreamAdapter*>(SSL_get_app_data(ssl));
+  const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm);
+  if (!md)
+    return ssl_private_key_failure;
+  RTC_DCHECK(!stream->private_key_operation_);
+  scoped_refptr<PrivateKeyOperation> operation(
+      new RefCountedObject<PrivateKeyOperation>(
+          stream, SSL_get_privatekey(ssl), md, in, in_len));
+  stream->private_key_operation_ = operation;
+  stream->handshake_offload_pool_->PostTask(
+      [operation] { operation->Run(); });
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t OpenSSLStreamAdapter::DecryptOnOffloadPool(
+    SSL* ssl,
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out,
+    const uint8_t* in,
+    size_t in_len) {
+  // Only used for RSA key exchange, which an ECDSA key can't do.
+  RTC_NOTREACHED();
+  return ssl_private_key_failure;
+}
+
+ssl_private_key_result_t OpenSSLStreamAdapter::CompleteOnOffloadPool(
+    SSL* ssl,
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out) {
+  OpenSSLStreamAdapter* stream =
+      reinterpret_cast<OpenSSLStreamAdapter*>(SSL_get_app_data(ssl));
+  RTC_DCHECK(stream->private_key_operation_);
+  bool ok;
+  Buffer signature;
+  if (!stream->private_key_operation_->TakeResult(&ok, &signature))
+    return ssl_private_key_retry;
+  stream->private_key_operation_ = nullptr;
+  if (!ok || signature.size() > max_out)
+    return ssl_private_key_failure;
+  memcpy(out, signature.data(), signature.size());
+  *out_len = signature.size();
+  return ssl_private_key_success;
+}
+#endif  // OPENSSL_IS_BORINGSSL
+
 bool OpenSSLStreamAdapter::IsBoringSsl() {
 #ifdef OPENSSL_IS_BORINGSSL
   return true;
@@ -1214,4 +1485,23 @@ void OpenSSLStreamAdapter::enable_time_callback_for_testing() {
   g_use_time_callback_for_testing = true;
 }
 
+std::unique_ptr<OpenSSLSessionCache>
+OpenSSLStreamAdapter::CreateDtlsSessionCache() {
+  SSL_CTX* ctx = SSL_CTX_new(DTLS_method());
+  if (!ctx)
+    return nullptr;
+  // The lengths of the keys differ between BoringSSL and OpenSSL.
+  Buffer keys(SSL_CTX_get_tlsext_ticket_keys(ctx, nullptr, 0));
+  if (keys.empty() || RAND_bytes(keys.data(), keys.size()) != 1 ||
+      !SSL_CTX_set_tlsext_ticket_keys(ctx, keys.data(), keys.size())) {
+    SSL_CTX_free(ctx);
+    return nullptr;
+  }
+  auto session_cache =
+      absl::make_unique<OpenSSLSessionCache>(SSL_MODE_DTLS, ctx);
+  // The cache holds its own reference.
+  SSL_CTX_free(ctx);
+  return session_cache;
+}
+
 }  // namespace rtc
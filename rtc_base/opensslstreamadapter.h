@@ -12,6 +12,9 @@
 #define RTC_BASE_OPENSSLSTREAMADAPTER_H_
 
 #include <openssl/ossl_typ.h>
+#ifdef OPENSSL_IS_BORINGSSL
+#include <openssl/ssl.h>
+#endif
 
 #include <memory>
 #include <string>
@@ -19,6 +22,8 @@
 
 #include "rtc_base/buffer.h"
 #include "rtc_base/opensslidentity.h"
+#include "rtc_base/opensslsessioncache.h"
+#include "rtc_base/scoped_ref_ptr.h"
 #include "rtc_base/sslstreamadapter.h"
 
 namespace rtc {
@@ -74,6 +79,9 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
   void SetMode(SSLMode mode) override;
   void SetMaxProtocolVersion(SSLProtocolVersion version) override;
   void SetInitialRetransmissionTimeout(int timeout_ms) override;
+  void SetSessionCache(SSLSessionCache* session_cache) override;
+  // Only supported with BoringSSL, and for ECDSA keys.
+  void SetHandshakeOffloadPool(TaskPool* pool) override;
 
   StreamResult Read(void* data,
                     size_t data_len,
@@ -93,6 +101,8 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
 
   int GetSslVersion() const override;
 
+  bool IsSessionResumed() const override;
+
   // Key Extractor interface
   bool ExportKeyingMaterial(const std::string& label,
                             const uint8_t* context,
@@ -117,6 +127,10 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
   // using a fake clock.
   static void enable_time_callback_for_testing();
 
+  // Creates a session cache for SetSessionCache() with new session ticket
+  // keys.
+  static std::unique_ptr<OpenSSLSessionCache> CreateDtlsSessionCache();
+
  protected:
   void OnEvent(StreamInterface* stream, int events, int err) override;
 
@@ -132,7 +146,11 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
     SSL_CLOSED       // Clean close
   };
 
-  enum { MSG_TIMEOUT = MSG_MAX + 1 };
+  enum { MSG_TIMEOUT = MSG_MAX + 1, MSG_PRIVATE_KEY_OPERATION_DONE };
+
+#ifdef OPENSSL_IS_BORINGSSL
+  class PrivateKeyOperation;
+#endif
 
   // The following three methods return 0 on success and a negative
   // error code on failure. The error code may be from OpenSSL or -1
@@ -169,6 +187,32 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
   // SSL certificate verification callback. See
   // SSL_CTX_set_cert_verify_callback.
   static int SSLVerifyCallback(X509_STORE_CTX* store, void* arg);
+  // Caches the sessions of a client. See SSL_CTX_sess_set_new_cb.
+  static int NewSSLSessionCallback(SSL* ssl, SSL_SESSION* session);
+  // The key of the sessions with the peer in |session_cache_|.
+  std::string SessionCacheKey() const;
+
+#ifdef OPENSSL_IS_BORINGSSL
+  // The methods of the SSL_PRIVATE_KEY_METHOD that offloads signing to
+  // |handshake_offload_pool_|.
+  static ssl_private_key_result_t SignOnOffloadPool(SSL* ssl,
+                                                   uint8_t* out,
+                                                   size_t* out_len,
+                                                   size_t max_out,
+                                                   uint16_t signature_algorithm,
+                                                   const uint8_t* in,
+                                                   size_t in_len);
+  static ssl_private_key_result_t DecryptOnOffloadPool(SSL* ssl,
+                                                      uint8_t* out,
+                                                      size_t* out_len,
+                                                      size_t max_out,
+                                                      const uint8_t* in,
+                                                      size_t in_len);
+  static ssl_private_key_result_t CompleteOnOffloadPool(SSL* ssl,
+                                                       uint8_t* out,
+                                                       size_t* out_len,
+                                                       size_t max_out);
+#endif
 
   bool waiting_to_verify_peer_certificate() const {
     return client_auth_enabled() && !peer_certificate_verified_;
@@ -212,6 +256,14 @@ class OpenSSLStreamAdapter : public SSLStreamAdapter {
   // A 50-ms initial timeout ensures rapid setup on fast connections, but may
   // be too aggressive for low bandwidth links.
   int dtls_handshake_timeout_ms_ = 50;
+
+  // Not owned.
+  OpenSSLSessionCache* session_cache_ = nullptr;
+  TaskPool* handshake_offload_pool_ = nullptr;
+#ifdef OPENSSL_IS_BORINGSSL
+  // The private key operation running on |handshake_offload_pool_|, if any.
+  scoped_refptr<PrivateKeyOperation> private_key_operation_;
+#endif
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -563,6 +563,15 @@ int PhysicalSocket::TranslateOption(Option opt, int* slevel, int* sopt) {
       return -1;
     case OPT_RTP_SENDTIME_EXTN_ID:
       return -1;  // No logging is necessary as this not a OS socket option.
+    case OPT_REUSEPORT:
+#if defined(SO_REUSEPORT)
+      *slevel = SOL_SOCKET;
+      *sopt = SO_REUSEPORT;
+      break;
+#else
+      RTC_LOG(LS_WARNING) << "Socket::OPT_REUSEPORT not supported.";
+      return -1;
+#endif
     default:
       RTC_NOTREACHED();
       return -1;
@@ -115,6 +115,10 @@ std::vector<int> GetSupportedDtlsSrtpCryptoSuites(
   return crypto_suites;
 }
 
+std::unique_ptr<SSLSessionCache> SSLSessionCache::CreateForDtls() {
+  return OpenSSLStreamAdapter::CreateDtlsSessionCache();
+}
+
 SSLStreamAdapter* SSLStreamAdapter::Create(StreamInterface* stream) {
   return new OpenSSLStreamAdapter(stream);
 }
@@ -20,6 +20,8 @@
 
 namespace rtc {
 
+class TaskPool;
+
 // Constants for SSL profile.
 const int TLS_NULL_WITH_NULL_NULL = 0;
 const int SSL_CIPHER_SUITE_MAX_VALUE = 0xFFFF;
@@ -134,6 +136,17 @@ enum { SSE_MSG_TRUNC = 0xff0001 };
 // Used to send back UMA histogram value. Logged when Dtls handshake fails.
 enum class SSLHandshakeError { UNKNOWN, INCOMPATIBLE_CIPHERSUITE, MAX_VALUE };
 
+// The state that SSLStreamAdapters in DTLS mode share to resume the sessions
+// of earlier handshakes instead of doing full handshakes. Not thread safe; the
+// adapters that share it must be used on one thread.
+class SSLSessionCache {
+ public:
+  // Creates a cache with new session ticket keys.
+  static std::unique_ptr<SSLSessionCache> CreateForDtls();
+
+  virtual ~SSLSessionCache() {}
+};
+
 class SSLStreamAdapter : public StreamAdapterInterface {
  public:
   // Instantiate an SSLStreamAdapter wrapping the given stream,
@@ -177,6 +190,21 @@ class SSLStreamAdapter : public StreamAdapterInterface {
   // This should only be called before StartSSL().
   virtual void SetInitialRetransmissionTimeout(int timeout_ms) = 0;
 
+  // Resume sessions through |session_cache|, which must outlive the adapter.
+  // As a client, offer the session of the last handshake with a peer with the
+  // same certificate digest. As a server, accept the sessions of handshakes
+  // with the other adapters that share the cache. The peer certificate is
+  // verified against the digest either way.
+  // This should only be called before StartSSL().
+  virtual void SetSessionCache(SSLSessionCache* session_cache) {}
+
+  // Do the private key operations of the handshake, the most expensive part
+  // of it with ECDSA keys, on |pool| instead of the current thread, so that
+  // the current thread can process other packets meanwhile. Not all
+  // implementations support this; they ignore it.
+  // This should only be called before StartSSL().
+  virtual void SetHandshakeOffloadPool(TaskPool* pool) {}
+
   // StartSSL starts negotiation with a peer, whose certificate is verified
   // using the certificate digest. Generally, SetIdentity() and possibly
   // SetServerRole() should have been called before this.
@@ -219,6 +247,10 @@ class SSLStreamAdapter : public StreamAdapterInterface {
 
   virtual int GetSslVersion() const = 0;
 
+  // Returns true if the handshake resumed a session through the session cache
+  // instead of doing a full handshake.
+  virtual bool IsSessionResumed() const { return false; }
+
   // Key Exporter interface from RFC 5705
   // Arguments are:
   // label               -- the exporter label.
@@ -0,0 +1,220 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rtc_base/buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/messagedigest.h"
+#include "rtc_base/sslidentity.h"
+#include "rtc_base/sslstreamadapter.h"
+#include "rtc_base/stream.h"
+#include "rtc_base/task_pool.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace rtc {
+namespace {
+
+constexpr int kNumHandshakes = 100;
+constexpr int kTimeoutMs = 60000;
+
+// One end of a lossless in-memory datagram link between two adapters.
+class LoopbackStream : public StreamInterface {
+ public:
+  ~LoopbackStream() override {
+    if (peer_)
+      peer_->peer_ = nullptr;
+  }
+
+  static void Connect(LoopbackStream* a, LoopbackStream* b) {
+    a->peer_ = b;
+    b->peer_ = a;
+  }
+
+  StreamState GetState() const override { return SS_OPEN; }
+
+  StreamResult Read(void* data,
+                    size_t data_len,
+                    size_t* read,
+                    int* error) override {
+    if (packets_.empty())
+      return SR_BLOCK;
+    const Buffer& packet = packets_.front();
+    const size_t size = std::min(data_len, packet.size());
+    memcpy(data, packet.data(), size);
+    if (read)
+      *read = size;
+    packets_.pop_front();
+    return SR_SUCCESS;
+  }
+
+  StreamResult Write(const void* data,
+                     size_t data_len,
+                     size_t* written,
+                     int* error) override {
+    if (peer_) {
+      peer_->packets_.emplace_back(static_cast<const uint8_t*>(data),
+                                   data_len);
+      peer_->PostEvent(SE_READ, 0);
+    }
+    if (written)
+      *written = data_len;
+    return SR_SUCCESS;
+  }
+
+  void Close() override {}
+
+ private:
+  LoopbackStream* peer_ = nullptr;
+  std::deque<Buffer> packets_;
+};
+
+}  // namespace
+
+// Measures how many DTLS handshakes per second one thread completes when many
+// clients connect to it at once, as on a media server. All the handshakes are
+// between the same two ECDSA identities, so that resumed handshakes can use
+// the session of the first one.
+class SSLStreamAdapterPerformanceTest : public ::testing::Test,
+                                        public sigslot::has_slots<> {
+ public:
+  SSLStreamAdapterPerformanceTest()
+      : client_identity_(SSLIdentity::Generate(
+            "client",
+            KeyParams::ECDSA(EC_NIST_P256))),
+        server_identity_(SSLIdentity::Generate(
+            "server",
+            KeyParams::ECDSA(EC_NIST_P256))) {
+    RTC_CHECK(ComputeDigest(*client_identity_, &client_digest_));
+    RTC_CHECK(ComputeDigest(*server_identity_, &server_digest_));
+  }
+
+  void MeasureHandshakes(const std::string& trace,
+                         SSLSessionCache* session_cache,
+                         TaskPool* pool) {
+    // A first handshake on its own fills |session_cache|.
+    StartHandshakes(1, session_cache, pool);
+    ASSERT_TRUE(WaitForHandshakes());
+    adapters_.clear();
+
+    const int64_t start_us = TimeMicros();
+    StartHandshakes(kNumHandshakes, session_cache, pool);
+    ASSERT_TRUE(WaitForHandshakes());
+    const int64_t elapsed_us = TimeMicros() - start_us;
+    adapters_.clear();
+
+    webrtc::test::PrintResult(
+        "dtls_handshake_rate", "", trace,
+        kNumHandshakes * static_cast<double>(kNumMicrosecsPerSec) /
+            std::max<int64_t>(elapsed_us, 1),
+        "handshakes/s", true);
+  }
+
+ private:
+  static bool ComputeDigest(const SSLIdentity& identity, Buffer* digest) {
+    unsigned char value[MessageDigest::kMaxSize];
+    size_t length;
+    if (!identity.certificate().ComputeDigest(DIGEST_SHA_256, value,
+                                              sizeof(value), &length)) {
+      return false;
+    }
+    digest->SetData(value, length);
+    return true;
+  }
+
+  std::unique_ptr<SSLStreamAdapter> CreateAdapter(
+      LoopbackStream* stream,
+      const SSLIdentity& identity,
+      const Buffer& peer_digest,
+      SSLRole role,
+      SSLSessionCache* session_cache,
+      TaskPool* pool) {
+    std::unique_ptr<SSLStreamAdapter> adapter(SSLStreamAdapter::Create(stream));
+    adapter->SetIdentity(identity.GetReference());
+    adapter->SetMode(SSL_MODE_DTLS);
+    adapter->SetServerRole(role);
+    adapter->SetSessionCache(session_cache);
+    adapter->SetHandshakeOffloadPool(pool);
+    RTC_CHECK(adapter->SetPeerCertificateDigest(
+        DIGEST_SHA_256, peer_digest.data(), peer_digest.size()));
+    adapter->SignalEvent.connect(
+        this, &SSLStreamAdapterPerformanceTest::OnEvent);
+    return adapter;
+  }
+
+  void StartHandshakes(int count,
+                       SSLSessionCache* session_cache,
+                       TaskPool* pool) {
+    num_open_ = 0;
+    num_closed_ = 0;
+    for (int i = 0; i < count; ++i) {
+      LoopbackStream* client_stream = new LoopbackStream();
+      LoopbackStream* server_stream = new LoopbackStream();
+      LoopbackStream::Connect(client_stream, server_stream);
+      adapters_.push_back(CreateAdapter(server_stream, *server_identity_,
+                                        client_digest_, SSL_SERVER,
+                                        session_cache, pool));
+      adapters_.push_back(CreateAdapter(client_stream, *client_identity_,
+                                        server_digest_, SSL_CLIENT,
+                                        session_cache, pool));
+    }
+    for (auto& adapter : adapters_)
+      RTC_CHECK_EQ(0, adapter->StartSSL());
+  }
+
+  // Returns false if a handshake failed or timed out.
+  bool WaitForHandshakes() {
+    const int64_t deadline_ms = TimeMillis() + kTimeoutMs;
+    while (num_open_ < static_cast<int>(adapters_.size())) {
+      if (num_closed_ > 0 || TimeMillis() > deadline_ms)
+        return false;
+      Thread::Current()->ProcessMessages(1);
+    }
+    return true;
+  }
+
+  void OnEvent(StreamInterface* stream, int events, int err) {
+    if (events & SE_OPEN)
+      ++num_open_;
+    if (events & SE_CLOSE)
+      ++num_closed_;
+  }
+
+  const std::unique_ptr<SSLIdentity> client_identity_;
+  const std::unique_ptr<SSLIdentity> server_identity_;
+  Buffer client_digest_;
+  Buffer server_digest_;
+  std::vector<std::unique_ptr<SSLStreamAdapter>> adapters_;
+  int num_open_ = 0;
+  int num_closed_ = 0;
+};
+
+TEST_F(SSLStreamAdapterPerformanceTest, ConcurrentDtlsHandshakes) {
+  MeasureHandshakes("full", nullptr, nullptr);
+
+  std::unique_ptr<SSLSessionCache> session_cache =
+      SSLSessionCache::CreateForDtls();
+  ASSERT_TRUE(session_cache);
+  MeasureHandshakes("resumed", session_cache.get(), nullptr);
+
+  MeasureHandshakes("offloaded", nullptr, TaskPool::Default());
+}
+
+}  // namespace rtc
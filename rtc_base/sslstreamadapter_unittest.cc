@@ -21,6 +21,7 @@
 #include "rtc_base/sslidentity.h"
 #include "rtc_base/sslstreamadapter.h"
 #include "rtc_base/stream.h"
+#include "rtc_base/task_pool.h"
 
 using ::testing::WithParamInterface;
 using ::testing::Values;
@@ -369,6 +370,25 @@ class SSLStreamAdapterTestBase : public testing::Test,
     server_ssl_->SetIdentity(server_identity_);
   }
 
+  // Recreate the client/server streams with the given identities, as for a
+  // second connection between the peers.
+  void ResetStreamsWithIdentities(rtc::SSLIdentity* client_identity,
+                                  rtc::SSLIdentity* server_identity) {
+    CreateStreams();
+
+    client_ssl_.reset(rtc::SSLStreamAdapter::Create(client_stream_));
+    server_ssl_.reset(rtc::SSLStreamAdapter::Create(server_stream_));
+
+    client_ssl_->SignalEvent.connect(this, &SSLStreamAdapterTestBase::OnEvent);
+    server_ssl_->SignalEvent.connect(this, &SSLStreamAdapterTestBase::OnEvent);
+
+    client_identity_ = client_identity;
+    server_identity_ = server_identity;
+    client_ssl_->SetIdentity(client_identity_);
+    server_ssl_->SetIdentity(server_identity_);
+    identities_set_ = false;
+  }
+
   virtual void OnEvent(rtc::StreamInterface* stream, int sig, int err) {
     RTC_LOG(LS_VERBOSE) << "SSLStreamAdapterTestBase::OnEvent sig=" << sig;
 
@@ -1346,6 +1366,61 @@ TEST_P(SSLStreamAdapterTestDTLS, TestCertExpired) {
   TestHandshake();
 }
 
+// Test that a second connection between the same peers resumes the session of
+// the first one when they share a session cache, and still verifies the peer
+// certificates.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSSessionResumption) {
+  std::unique_ptr<rtc::SSLSessionCache> session_cache =
+      rtc::SSLSessionCache::CreateForDtls();
+  ASSERT_TRUE(session_cache);
+  client_ssl_->SetSessionCache(session_cache.get());
+  server_ssl_->SetSessionCache(session_cache.get());
+  TestHandshake();
+  EXPECT_FALSE(client_ssl_->IsSessionResumed());
+  EXPECT_FALSE(server_ssl_->IsSessionResumed());
+
+  ResetStreamsWithIdentities(client_identity_->GetReference(),
+                             server_identity_->GetReference());
+  client_ssl_->SetSessionCache(session_cache.get());
+  server_ssl_->SetSessionCache(session_cache.get());
+  TestHandshake();
+  EXPECT_TRUE(client_ssl_->IsSessionResumed());
+  EXPECT_TRUE(server_ssl_->IsSessionResumed());
+  EXPECT_TRUE(GetPeerCertificate(true));
+  EXPECT_TRUE(GetPeerCertificate(false));
+  TestTransfer(100);
+}
+
+// Test that a client with a new identity doesn't offer the session of the
+// old one, which the server would reject.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSSessionNotResumedWithNewIdentity) {
+  std::unique_ptr<rtc::SSLSessionCache> session_cache =
+      rtc::SSLSessionCache::CreateForDtls();
+  ASSERT_TRUE(session_cache);
+  client_ssl_->SetSessionCache(session_cache.get());
+  server_ssl_->SetSessionCache(session_cache.get());
+  TestHandshake();
+
+  ResetStreamsWithIdentities(
+      rtc::SSLIdentity::Generate("client", client_key_type_),
+      server_identity_->GetReference());
+  client_ssl_->SetSessionCache(session_cache.get());
+  server_ssl_->SetSessionCache(session_cache.get());
+  TestHandshake();
+  EXPECT_FALSE(client_ssl_->IsSessionResumed());
+  EXPECT_FALSE(server_ssl_->IsSessionResumed());
+}
+
+// Test that a handshake with the private key operations on a task pool
+// completes and transfers data. Only BoringSSL supports it; the adapter does
+// them itself otherwise.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSHandshakeOffload) {
+  client_ssl_->SetHandshakeOffloadPool(rtc::TaskPool::Default());
+  server_ssl_->SetHandshakeOffloadPool(rtc::TaskPool::Default());
+  TestHandshake();
+  TestTransfer(100);
+}
+
 // Test data transfer using certs created from strings.
 TEST_F(SSLStreamAdapterTestDTLSFromPEMStrings, TestTransfer) {
   TestHandshake();
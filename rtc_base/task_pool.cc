@@ -0,0 +1,247 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_pool.h"
+
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#elif defined(WEBRTC_POSIX)
+#include <unistd.h>
+#endif
+#if defined(WEBRTC_LINUX) || defined(WEBRTC_ANDROID)
+#include <sched.h>
+#endif
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+namespace rtc {
+namespace {
+
+int NumberOfCores() {
+#if defined(WEBRTC_WIN)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return static_cast<int>(info.dwNumberOfProcessors);
+#elif defined(WEBRTC_POSIX)
+  return std::max(1, static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN)));
+#else
+  return 1;
+#endif
+}
+
+void PinCurrentThreadToCore(int core) {
+#if defined(WEBRTC_LINUX) || defined(WEBRTC_ANDROID)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(core, &cpu_set);
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+    RTC_LOG_ERR(LS_WARNING) << "Failed to pin task pool worker to core "
+                            << core;
+#endif
+}
+
+// Shared by the caller and the helper tasks of a ParallelFor() call. The
+// helpers may start after the call has returned, so they hold a reference.
+class ParallelForState : public RefCountInterface {
+ public:
+  ParallelForState(size_t count, const std::function<void(size_t)>& fn)
+      : count_(count), fn_(fn), done_event_(false, false) {}
+
+  // Makes calls until there are no indices left.
+  void Run() {
+    size_t index;
+    while ((index = next_.fetch_add(1, std::memory_order_relaxed)) < count_) {
+      fn_(index);
+      if (done_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_)
+        done_event_.Set();
+    }
+  }
+
+  void Wait() {
+    if (done_.load(std::memory_order_acquire) < count_)
+      done_event_.Wait(Event::kForever);
+  }
+
+ private:
+  const size_t count_;
+  // Only called for indices below |count_|, i.e. before Wait() returns.
+  const std::function<void(size_t)>& fn_;
+  std::atomic<size_t> next_{0};
+  std::atomic<size_t> done_{0};
+  Event done_event_;
+};
+
+}  // namespace
+
+TaskPool::TaskPool(const Config& config)
+    : pin_to_cores_(config.pin_to_cores) {
+  const int num_cores = NumberOfCores();
+  const int num_threads =
+      config.num_threads > 0 ? config.num_threads : num_cores;
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker());
+    Worker* worker = workers_.back().get();
+    worker->pool = this;
+    worker->index = i;
+    worker->thread.reset(
+        new PlatformThread(&TaskPool::WorkerThread, worker, "TaskPool"));
+  }
+  for (auto& worker : workers_) {
+    worker->thread->Start();
+    worker->thread_ref = worker->thread->GetThreadRef();
+  }
+}
+
+TaskPool::~TaskPool() {
+  RTC_DCHECK(!CurrentWorker());
+  quit_.store(true);
+  for (auto& worker : workers_)
+    worker->wake_up.Set();
+  for (auto& worker : workers_)
+    worker->thread->Stop();
+  for (auto& worker : workers_) {
+    for (auto& tasks : worker->tasks) {
+      for (QueuedTask* task : tasks)
+        delete task;
+    }
+  }
+}
+
+// static
+TaskPool* TaskPool::Default() {
+  static TaskPool* const pool = new TaskPool(Config());
+  return pool;
+}
+
+void TaskPool::PostTask(std::unique_ptr<QueuedTask> task, Priority priority) {
+  Worker* worker = CurrentWorker();
+  if (!worker) {
+    worker = workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                      workers_.size()]
+                 .get();
+  }
+  {
+    CritScope lock(&worker->crit);
+    worker->tasks[static_cast<int>(priority)].push_back(task.release());
+  }
+  // Pairs with the check in RunWorker(): either a worker about to go idle sees
+  // the new task, or this sees the idle worker.
+  num_pending_.fetch_add(1);
+  if (num_idle_.load() > 0)
+    WakeUpIdleWorker();
+}
+
+void TaskPool::ParallelFor(size_t count,
+                           const std::function<void(size_t)>& fn,
+                           Priority priority) {
+  if (count == 0)
+    return;
+  if (count == 1) {
+    fn(0);
+    return;
+  }
+  scoped_refptr<ParallelForState> state(
+      new RefCountedObject<ParallelForState>(count, fn));
+  const size_t num_helpers = std::min(count - 1, workers_.size());
+  for (size_t i = 0; i < num_helpers; ++i)
+    PostTask([state] { state->Run(); }, priority);
+  state->Run();
+  state->Wait();
+}
+
+// static
+void TaskPool::WorkerThread(void* context) {
+  Worker* worker = static_cast<Worker*>(context);
+  worker->pool->RunWorker(worker);
+}
+
+void TaskPool::RunWorker(Worker* worker) {
+  if (pin_to_cores_)
+    PinCurrentThreadToCore(worker->index % NumberOfCores());
+  while (!quit_.load()) {
+    std::unique_ptr<QueuedTask> task(TakeTask(worker));
+    if (task) {
+      if (!task->Run())
+        task.release();
+      continue;
+    }
+    {
+      CritScope lock(&idle_crit_);
+      num_idle_.fetch_add(1);
+      if (num_pending_.load() > 0 || quit_.load()) {
+        num_idle_.fetch_sub(1);
+        continue;
+      }
+      idle_workers_.push_back(worker);
+    }
+    worker->wake_up.Wait(Event::kForever);
+  }
+}
+
+TaskPool::Worker* TaskPool::CurrentWorker() const {
+  const PlatformThreadRef current = CurrentThreadRef();
+  for (const auto& worker : workers_) {
+    if (IsThreadRefEqual(worker->thread_ref, current))
+      return worker.get();
+  }
+  return nullptr;
+}
+
+QueuedTask* TaskPool::TakeTask(Worker* self) {
+  if (num_pending_.load(std::memory_order_acquire) == 0)
+    return nullptr;
+  const size_t num_workers = workers_.size();
+  for (int priority = 0; priority < kNumPriorities; ++priority) {
+    {
+      CritScope lock(&self->crit);
+      std::deque<QueuedTask*>& tasks = self->tasks[priority];
+      if (!tasks.empty()) {
+        QueuedTask* task = tasks.back();
+        tasks.pop_back();
+        num_pending_.fetch_sub(1);
+        return task;
+      }
+    }
+    // Steal, starting with the next worker so that thieves spread out.
+    for (size_t i = 1; i < num_workers; ++i) {
+      Worker* victim = workers_[(self->index + i) % num_workers].get();
+      CritScope lock(&victim->crit);
+      std::deque<QueuedTask*>& tasks = victim->tasks[priority];
+      if (!tasks.empty()) {
+        QueuedTask* task = tasks.front();
+        tasks.pop_front();
+        num_pending_.fetch_sub(1);
+        return task;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void TaskPool::WakeUpIdleWorker() {
+  Worker* worker = nullptr;
+  {
+    CritScope lock(&idle_crit_);
+    if (idle_workers_.empty())
+      return;
+    worker = idle_workers_.back();
+    idle_workers_.pop_back();
+    num_idle_.fetch_sub(1);
+  }
+  worker->wake_up.Set();
+}
+
+}  // namespace rtc
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TASK_POOL_H_
+#define RTC_BASE_TASK_POOL_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// A pool of worker threads that run independent tasks in parallel, so that a
+// process can bound the number of threads used for parallel media work
+// instead of having every module start its own.
+//
+// Each worker has its own task queues. Tasks posted from a worker go to that
+// worker's queues and are run most recent first, which keeps forked work on
+// the core whose cache holds its data. Tasks posted from other threads are
+// spread over the workers. A worker that runs out of tasks steals the oldest
+// task of another worker.
+//
+// Tasks are not ordered with respect to each other, except that a worker
+// always runs a task of a higher priority first if it can find one. Use a
+// TaskQueue for work that must run in sequence.
+//
+// Example:
+//   rtc::TaskPool::Default()->ParallelFor(layers.size(), [&](size_t i) {
+//     Scale(input, &layers[i]);
+//   });
+class TaskPool {
+ public:
+  enum class Priority {
+    // Work with a hard deadline, e.g. audio processing.
+    REALTIME = 0,
+    // Work that should keep up with the frame rate, e.g. video scaling.
+    NORMAL,
+    // Work that can be postponed, e.g. logging or statistics.
+    BACKGROUND,
+  };
+
+  struct Config {
+    // Number of worker threads. Zero means one per core.
+    int num_threads = 0;
+    // Binds worker i to core i modulo the number of cores. Only honored on
+    // Linux and Android.
+    bool pin_to_cores = false;
+  };
+
+  explicit TaskPool(const Config& config);
+  // Stops and joins the workers. Tasks that have not started running are
+  // deleted without being run.
+  ~TaskPool();
+
+  // Returns a process wide pool with one worker per core. It is never
+  // destroyed.
+  static TaskPool* Default();
+
+  // Number of worker threads.
+  int num_threads() const { return static_cast<int>(workers_.size()); }
+
+  // Runs |task| on one of the workers. Ownership of |task| is handled as by
+  // TaskQueue::PostTask(). May be called from any thread, including from a
+  // task running in the pool.
+  void PostTask(std::unique_ptr<QueuedTask> task,
+                Priority priority = Priority::NORMAL);
+
+  template <class Closure,
+            typename std::enable_if<!std::is_convertible<
+                Closure,
+                std::unique_ptr<QueuedTask>>::value>::type* = nullptr>
+  void PostTask(Closure&& closure, Priority priority = Priority::NORMAL) {
+    PostTask(NewClosure(std::forward<Closure>(closure)), priority);
+  }
+
+  // Calls |fn| once for each index in [0, |count|), in parallel, and returns
+  // when all calls have returned. The calling thread takes part in the work,
+  // so this can safely be called from a task running in the pool, and never
+  // blocks for longer than it takes to finish calls that already started.
+  void ParallelFor(size_t count,
+                   const std::function<void(size_t)>& fn,
+                   Priority priority = Priority::NORMAL);
+
+ private:
+  static constexpr int kNumPriorities = 3;
+
+  struct Worker {
+    TaskPool* pool = nullptr;
+    int index = 0;
+    std::unique_ptr<PlatformThread> thread;
+    // Set before any task can be posted, constant afterwards.
+    PlatformThreadRef thread_ref;
+    Event wake_up{false, false};
+    CriticalSection crit;
+    // The owner takes from the back, thieves from the front.
+    std::deque<QueuedTask*> tasks[kNumPriorities] RTC_GUARDED_BY(crit);
+  };
+
+  static void WorkerThread(void* context);
+  void RunWorker(Worker* worker);
+  // Returns the worker running on the current thread, or null.
+  Worker* CurrentWorker() const;
+  // Returns the highest priority task available to |self|, which may be null
+  // when called from outside the pool, or null if there is none.
+  QueuedTask* TakeTask(Worker* self);
+  void WakeUpIdleWorker();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  const bool pin_to_cores_;
+  std::atomic<bool> quit_{false};
+  // Tasks posted and not yet taken.
+  std::atomic<int> num_pending_{0};
+  // Workers in |idle_workers_|; read without |idle_crit_| when posting.
+  std::atomic<int> num_idle_{0};
+  // Used to spread tasks posted from outside the pool over the workers.
+  std::atomic<unsigned> next_worker_{0};
+  CriticalSection idle_crit_;
+  std::vector<Worker*> idle_workers_ RTC_GUARDED_BY(idle_crit_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(TaskPool);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_TASK_POOL_H_
@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+TaskPool::Config PoolConfig(int num_threads) {
+  TaskPool::Config config;
+  config.num_threads = num_threads;
+  return config;
+}
+
+}  // namespace
+
+TEST(TaskPoolTest, RunsPostedTasks) {
+  const int kNumTasks = 1000;
+  std::atomic<int> tasks_run(0);
+  Event done(false, false);
+  TaskPool pool(PoolConfig(4));
+  for (int i = 0; i < kNumTasks; ++i) {
+    pool.PostTask([&] {
+      if (++tasks_run == kNumTasks)
+        done.Set();
+    });
+  }
+  EXPECT_TRUE(done.Wait(10000));
+}
+
+TEST(TaskPoolTest, TasksPostedFromTasksRun) {
+  Event done(false, false);
+  TaskPool pool(PoolConfig(2));
+  pool.PostTask([&] { pool.PostTask([&] { done.Set(); }); });
+  EXPECT_TRUE(done.Wait(10000));
+}
+
+TEST(TaskPoolTest, ParallelForCallsEachIndexOnce) {
+  TaskPool pool(PoolConfig(3));
+  std::vector<std::atomic<int>> calls(100);
+  for (auto& count : calls)
+    count = 0;
+  pool.ParallelFor(calls.size(), [&](size_t i) { ++calls[i]; });
+  for (const auto& count : calls)
+    EXPECT_EQ(1, count.load());
+}
+
+TEST(TaskPoolTest, NestedParallelForDoesNotDeadlock) {
+  std::atomic<int> calls(0);
+  Event done(false, false);
+  TaskPool pool(PoolConfig(1));
+  pool.PostTask([&] {
+    pool.ParallelFor(4, [&](size_t) {
+      pool.ParallelFor(4, [&](size_t) { ++calls; });
+    });
+    done.Set();
+  });
+  ASSERT_TRUE(done.Wait(10000));
+  EXPECT_EQ(16, calls.load());
+}
+
+TEST(TaskPoolTest, RunsHigherPriorityFirst) {
+  CriticalSection crit;
+  std::vector<int> order;
+  Event done(false, false);
+  Event blocked(false, false);
+  Event release(false, false);
+  TaskPool pool(PoolConfig(1));
+  pool.PostTask([&] {
+    blocked.Set();
+    release.Wait(Event::kForever);
+  });
+  ASSERT_TRUE(blocked.Wait(10000));
+
+  auto record = [&](int value) {
+    CritScope lock(&crit);
+    order.push_back(value);
+    if (order.size() == 3)
+      done.Set();
+  };
+  pool.PostTask([&] { record(2); }, TaskPool::Priority::BACKGROUND);
+  pool.PostTask([&] { record(1); }, TaskPool::Priority::NORMAL);
+  pool.PostTask([&] { record(0); }, TaskPool::Priority::REALTIME);
+  release.Set();
+
+  ASSERT_TRUE(done.Wait(10000));
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), order);
+}
+
+TEST(TaskPoolTest, DeletesPendingTasksOnDestruction) {
+  Event blocked(false, false);
+  Event release(false, false);
+  auto pool = absl::make_unique<TaskPool>(PoolConfig(1));
+  pool->PostTask([&] {
+    blocked.Set();
+    release.Wait(Event::kForever);
+  });
+  ASSERT_TRUE(blocked.Wait(10000));
+
+  auto value = std::make_shared<int>(0);
+  pool->PostTask([value] { *value = 1; });
+  EXPECT_EQ(2, value.use_count());
+  release.Set();
+  // The blocked task may finish before or after the pool starts stopping;
+  // either way the posted task is run or deleted, never leaked.
+  pool.reset();
+  EXPECT_EQ(1, value.use_count());
+}
+
+}  // namespace rtc
@@ -38,6 +38,11 @@ class QueuedTask {
   virtual bool Run() = 0;
 
  private:
+  // Lets TaskQueue implementations link posted tasks without allocating a
+  // list node per task. Only valid while the task is owned by a queue.
+  friend class TaskQueue;
+  QueuedTask* next_queued_task_ = nullptr;
+
   RTC_DISALLOW_COPY_AND_ASSIGN(QueuedTask);
 };
 
@@ -0,0 +1,407 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// A TaskQueue implementation for Linux that avoids the per-task lock, list
+// node allocation and pipe write of the libevent implementation:
+//  - Posted tasks are pushed onto a lock-free intrusive stack, linked through
+//    QueuedTask::next_queued_task_. The queue thread takes the whole stack
+//    with a single exchange and runs it in posting order.
+//  - The queue thread is woken through an eventfd, and only when it has
+//    announced that it is about to block. Posting to a busy queue therefore
+//    makes no system call.
+//  - Delayed tasks are kept on a hierarchical timer wheel owned by the queue
+//    thread, with a timerfd armed for the earliest wakeup.
+
+#include "rtc_base/task_queue.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/types/optional.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/refcount.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/task_queue_posix.h"
+#include "rtc_base/timer_wheel.h"
+#include "rtc_base/timeutils.h"
+
+namespace rtc {
+using internal::GetQueuePtrTls;
+
+namespace {
+
+using Priority = TaskQueue::Priority;
+
+ThreadPriority TaskQueuePriorityToThreadPriority(Priority priority) {
+  switch (priority) {
+    case Priority::HIGH:
+      return kRealtimePriority;
+    case Priority::LOW:
+      return kLowPriority;
+    case Priority::NORMAL:
+      return kNormalPriority;
+    default:
+      RTC_NOTREACHED();
+      break;
+  }
+  return kNormalPriority;
+}
+
+// Reads and discards the counter of an eventfd or timerfd.
+void DrainCounter(int fd) {
+  uint64_t value;
+  while (read(fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+  }
+}
+
+}  // namespace
+
+class TaskQueue::Impl : public RefCountInterface {
+ public:
+  Impl(const char* queue_name, TaskQueue* queue, Priority priority);
+  ~Impl() override;
+
+  static TaskQueue::Impl* Current();
+  static TaskQueue* CurrentQueue();
+
+  // Used for DCHECKing the current queue.
+  bool IsCurrent() const;
+
+  void PostTask(std::unique_ptr<QueuedTask> task);
+  void PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                        std::unique_ptr<QueuedTask> reply,
+                        TaskQueue::Impl* reply_queue);
+  void PostDelayedTask(std::unique_ptr<QueuedTask> task, uint32_t milliseconds);
+
+  // Stops the queue thread and deletes all tasks that have not run. Tasks
+  // posted afterwards are deleted without running.
+  void Stop();
+
+ private:
+  class PostAndReplyTask;
+  class SetTimerTask;
+
+  static void ThreadMain(void* context);
+  void Run();
+
+  // Runs the tasks that were posted up to now, in posting order.
+  void RunPostedTasks();
+  // Runs the delayed tasks that are due.
+  void RunDueTimers();
+  // Arms |timer_fd_| for the next timer wheel wakeup. Returns false if the
+  // wakeup time has already been reached.
+  bool ArmTimer();
+  void Wakeup();
+  void DeletePostedTasks();
+
+  TaskQueue* const queue_;
+  const int wakeup_fd_;
+  const int timer_fd_;
+
+  // Top of the stack of posted tasks, most recently posted first.
+  std::atomic<QueuedTask*> posted_tasks_{nullptr};
+  // Set by the queue thread right before it blocks. A poster that clears it
+  // is responsible for signaling |wakeup_fd_|.
+  std::atomic<bool> sleeping_{false};
+  std::atomic<bool> quit_{false};
+  std::atomic<bool> stopped_{false};
+
+  // Only accessed on the queue thread, or after it has been stopped.
+  TimerWheel<std::unique_ptr<QueuedTask>> timers_;
+  std::vector<std::unique_ptr<QueuedTask>> due_timers_;
+  absl::optional<int64_t> armed_wakeup_ms_;
+
+  PlatformThread thread_;
+};
+
+class TaskQueue::Impl::PostAndReplyTask : public QueuedTask {
+ public:
+  PostAndReplyTask(std::unique_ptr<QueuedTask> task,
+                   std::unique_ptr<QueuedTask> reply,
+                   TaskQueue::Impl* reply_queue)
+      : task_(std::move(task)),
+        reply_(std::move(reply)),
+        reply_queue_(reply_queue) {}
+
+ private:
+  bool Run() override {
+    if (!task_->Run())
+      task_.release();
+    // If the reply queue has been stopped in the meantime, the reply is
+    // deleted without running. Holding a reference keeps that safe.
+    reply_queue_->PostTask(std::move(reply_));
+    return true;
+  }
+
+  std::unique_ptr<QueuedTask> task_;
+  std::unique_ptr<QueuedTask> reply_;
+  const scoped_refptr<TaskQueue::Impl> reply_queue_;
+};
+
+// Moves a task posted with a delay from another thread onto the timer wheel,
+// with the deadline computed at posting time.
+class TaskQueue::Impl::SetTimerTask : public QueuedTask {
+ public:
+  SetTimerTask(std::unique_ptr<QueuedTask> task, int64_t deadline_ms)
+      : task_(std::move(task)), deadline_ms_(deadline_ms) {}
+
+ private:
+  bool Run() override {
+    TaskQueue::Impl::Current()->timers_.Insert(deadline_ms_, std::move(task_));
+    return true;
+  }
+
+  std::unique_ptr<QueuedTask> task_;
+  const int64_t deadline_ms_;
+};
+
+TaskQueue::Impl::Impl(const char* queue_name,
+                      TaskQueue* queue,
+                      Priority priority)
+    : queue_(queue),
+      wakeup_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      timer_fd_(
+          timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+      timers_(TimeMillis()),
+      thread_(&TaskQueue::Impl::ThreadMain,
+              this,
+              queue_name,
+              TaskQueuePriorityToThreadPriority(priority)) {
+  RTC_DCHECK(queue_name);
+  RTC_CHECK_GE(wakeup_fd_, 0);
+  RTC_CHECK_GE(timer_fd_, 0);
+  thread_.Start();
+}
+
+TaskQueue::Impl::~Impl() {
+  RTC_DCHECK(stopped_.load());
+  DeletePostedTasks();
+  close(wakeup_fd_);
+  close(timer_fd_);
+}
+
+// static
+TaskQueue::Impl* TaskQueue::Impl::Current() {
+  return static_cast<TaskQueue::Impl*>(pthread_getspecific(GetQueuePtrTls()));
+}
+
+// static
+TaskQueue* TaskQueue::Impl::CurrentQueue() {
+  TaskQueue::Impl* current = Current();
+  return current ? current->queue_ : nullptr;
+}
+
+bool TaskQueue::Impl::IsCurrent() const {
+  return IsThreadRefEqual(thread_.GetThreadRef(), CurrentThreadRef());
+}
+
+void TaskQueue::Impl::PostTask(std::unique_ptr<QueuedTask> task) {
+  RTC_DCHECK(task.get());
+  // Once pushed, the task may run and its owner may delete this queue before
+  // this call returns, so keep the queue alive until then.
+  scoped_refptr<TaskQueue::Impl> self;
+  if (Current() != this)
+    self = this;
+  QueuedTask* node = task.release();
+  QueuedTask* top = posted_tasks_.load(std::memory_order_relaxed);
+  do {
+    node->next_queued_task_ = top;
+  } while (!posted_tasks_.compare_exchange_weak(top, node));
+
+  // Pairs with the store of |sleeping_| and the load of |posted_tasks_| in
+  // Run(): either the queue thread sees the task before blocking, or this
+  // thread sees that it is about to block and wakes it up.
+  if (sleeping_.load() && sleeping_.exchange(false))
+    Wakeup();
+
+  // Same pairing with Stop(), so no task is left behind on a stopped queue.
+  if (stopped_.load())
+    DeletePostedTasks();
+}
+
+void TaskQueue::Impl::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                      uint32_t milliseconds) {
+  if (milliseconds == 0) {
+    PostTask(std::move(task));
+  } else if (Current() == this) {
+    timers_.Insert(TimeMillis() + milliseconds, std::move(task));
+  } else {
+    PostTask(absl::make_unique<SetTimerTask>(std::move(task),
+                                             TimeMillis() + milliseconds));
+  }
+}
+
+void TaskQueue::Impl::PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                                       std::unique_ptr<QueuedTask> reply,
+                                       TaskQueue::Impl* reply_queue) {
+  PostTask(absl::make_unique<PostAndReplyTask>(std::move(task),
+                                               std::move(reply), reply_queue));
+}
+
+void TaskQueue::Impl::Stop() {
+  RTC_DCHECK(!IsCurrent());
+  quit_.store(true);
+  Wakeup();
+  thread_.Stop();
+
+  stopped_.store(true);
+  DeletePostedTasks();
+  timers_.Clear();
+}
+
+// static
+void TaskQueue::Impl::ThreadMain(void* context) {
+  TaskQueue::Impl* me = static_cast<TaskQueue::Impl*>(context);
+  pthread_setspecific(GetQueuePtrTls(), me);
+  me->Run();
+  pthread_setspecific(GetQueuePtrTls(), nullptr);
+}
+
+void TaskQueue::Impl::Run() {
+  pollfd fds[2] = {{wakeup_fd_, POLLIN, 0}, {timer_fd_, POLLIN, 0}};
+  while (!quit_.load(std::memory_order_relaxed)) {
+    RunPostedTasks();
+    RunDueTimers();
+
+    sleeping_.store(true);
+    if (posted_tasks_.load() != nullptr || quit_.load() || !ArmTimer()) {
+      sleeping_.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    if (poll(fds, 2, -1) < 0) {
+      RTC_CHECK_EQ(EINTR, errno);
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
+    if (fds[0].revents & POLLIN)
+      DrainCounter(wakeup_fd_);
+    if (fds[1].revents & POLLIN) {
+      DrainCounter(timer_fd_);
+      armed_wakeup_ms_ = absl::nullopt;
+    }
+  }
+}
+
+void TaskQueue::Impl::RunPostedTasks() {
+  QueuedTask* top = posted_tasks_.exchange(nullptr, std::memory_order_acquire);
+  // Reverse the stack into posting order.
+  QueuedTask* next = nullptr;
+  while (top) {
+    QueuedTask* below = top->next_queued_task_;
+    top->next_queued_task_ = next;
+    next = top;
+    top = below;
+  }
+  while (next) {
+    std::unique_ptr<QueuedTask> task(next);
+    next = next->next_queued_task_;
+    task->next_queued_task_ = nullptr;
+    if (!task->Run())
+      task.release();
+  }
+}
+
+void TaskQueue::Impl::RunDueTimers() {
+  if (timers_.empty())
+    return;
+  timers_.Advance(TimeMillis(), &due_timers_);
+  for (std::unique_ptr<QueuedTask>& task : due_timers_) {
+    if (!task->Run())
+      task.release();
+  }
+  due_timers_.clear();
+}
+
+bool TaskQueue::Impl::ArmTimer() {
+  const absl::optional<int64_t> wakeup_ms = timers_.NextWakeupMs();
+  if (wakeup_ms == armed_wakeup_ms_)
+    return true;
+  itimerspec spec = {};
+  if (wakeup_ms) {
+    // The timer is armed relative to now, so that it follows TimeMillis()
+    // also when a fake clock is in use.
+    const int64_t delay_ms = *wakeup_ms - TimeMillis();
+    if (delay_ms <= 0)
+      return false;
+    spec.it_value.tv_sec = delay_ms / 1000;
+    spec.it_value.tv_nsec = (delay_ms % 1000) * 1000000;
+  }
+  RTC_CHECK_EQ(0, timerfd_settime(timer_fd_, 0, &spec, nullptr));
+  armed_wakeup_ms_ = wakeup_ms;
+  return true;
+}
+
+void TaskQueue::Impl::Wakeup() {
+  const uint64_t one = 1;
+  if (write(wakeup_fd_, &one, sizeof(one)) != sizeof(one)) {
+    // The counter can only overflow after 2^64 - 2 unread wakeups, so this
+    // should never happen.
+    RTC_LOG(LS_ERROR) << "Failed to wake up task queue, errno=" << errno;
+  }
+}
+
+void TaskQueue::Impl::DeletePostedTasks() {
+  QueuedTask* top = posted_tasks_.exchange(nullptr, std::memory_order_acquire);
+  while (top) {
+    QueuedTask* below = top->next_queued_task_;
+    delete top;
+    top = below;
+  }
+}
+
+TaskQueue::TaskQueue(const char* queue_name, Priority priority)
+    : impl_(new RefCountedObject<TaskQueue::Impl>(queue_name, this, priority)) {
+}
+
+TaskQueue::~TaskQueue() {
+  impl_->Stop();
+}
+
+// static
+TaskQueue* TaskQueue::Current() {
+  return TaskQueue::Impl::CurrentQueue();
+}
+
+// Used for DCHECKing the current queue.
+bool TaskQueue::IsCurrent() const {
+  return impl_->IsCurrent();
+}
+
+void TaskQueue::PostTask(std::unique_ptr<QueuedTask> task) {
+  return TaskQueue::impl_->PostTask(std::move(task));
+}
+
+void TaskQueue::PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                                 std::unique_ptr<QueuedTask> reply,
+                                 TaskQueue* reply_queue) {
+  return TaskQueue::impl_->PostTaskAndReply(std::move(task), std::move(reply),
+                                            reply_queue->impl_.get());
+}
+
+void TaskQueue::PostTaskAndReply(std::unique_ptr<QueuedTask> task,
+                                 std::unique_ptr<QueuedTask> reply) {
+  return TaskQueue::impl_->PostTaskAndReply(std::move(task), std::move(reply),
+                                            impl_.get());
+}
+
+void TaskQueue::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                uint32_t milliseconds) {
+  return TaskQueue::impl_->PostDelayedTask(std::move(task), milliseconds);
+}
+
+}  // namespace rtc
@@ -0,0 +1,124 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace rtc {
+namespace {
+
+const int kNumPosters = 4;
+const int kTasksPerPoster = 100000;
+const int kNumRoundTrips = 10000;
+const int kNumDelayedTasks = 10000;
+
+}  // namespace
+
+// Posts tasks to one queue from several other queues at once, which is how
+// the encoder, pacer and network queues feed each other.
+TEST(TaskQueuePerformanceTest, PostTaskThroughput) {
+  TaskQueue target("Target");
+  std::vector<std::unique_ptr<TaskQueue>> posters;
+  for (int i = 0; i < kNumPosters; ++i)
+    posters.emplace_back(new TaskQueue("Poster"));
+
+  Event done(false, false);
+  int tasks_run = 0;
+  const int64_t start_us = TimeMicros();
+  for (auto& poster : posters) {
+    poster->PostTask([&target, &tasks_run, &done] {
+      for (int i = 0; i < kTasksPerPoster; ++i) {
+        target.PostTask([&tasks_run, &done] {
+          if (++tasks_run == kNumPosters * kTasksPerPoster)
+            done.Set();
+        });
+      }
+    });
+  }
+  ASSERT_TRUE(done.Wait(60000));
+  const int64_t elapsed_us = TimeMicros() - start_us;
+
+  webrtc::test::PrintResult(
+      "task_queue_post_task", "", "throughput",
+      1000.0 * kNumPosters * kTasksPerPoster / std::max<int64_t>(elapsed_us, 1),
+      "tasks/ms", true);
+}
+
+// Measures the time for a task to hop to another queue and back, which is
+// dominated by the cost of waking up an idle queue.
+TEST(TaskQueuePerformanceTest, PostTaskRoundTripLatency) {
+  TaskQueue ping("Ping");
+  TaskQueue pong("Pong");
+
+  Event done(false, false);
+  int round_trips = 0;
+  std::function<void()> send_ping;
+  send_ping = [&] {
+    pong.PostTask([&] {
+      ping.PostTask([&] {
+        if (++round_trips == kNumRoundTrips) {
+          done.Set();
+        } else {
+          send_ping();
+        }
+      });
+    });
+  };
+
+  const int64_t start_us = TimeMicros();
+  ping.PostTask(send_ping);
+  ASSERT_TRUE(done.Wait(60000));
+  const int64_t elapsed_us = TimeMicros() - start_us;
+
+  webrtc::test::PrintResult(
+      "task_queue_post_task", "", "round_trip_latency",
+      static_cast<double>(elapsed_us) / kNumRoundTrips, "us", true);
+}
+
+// Posts many delayed tasks, as done by pacing and RTCP timers, and measures
+// how late they run.
+TEST(TaskQueuePerformanceTest, PostDelayedTaskLateness) {
+  TaskQueue queue("Delayed");
+
+  Event done(false, false);
+  std::atomic<int64_t> total_lateness_us(0);
+  std::atomic<int> tasks_run(0);
+  queue.PostTask([&] {
+    for (int i = 0; i < kNumDelayedTasks; ++i) {
+      const uint32_t delay_ms = 1 + i % 100;
+      const int64_t deadline_us =
+          TimeMicros() + delay_ms * rtc::kNumMicrosecsPerMillisec;
+      queue.PostDelayedTask(
+          [&, deadline_us] {
+            total_lateness_us += TimeMicros() - deadline_us;
+            if (++tasks_run == kNumDelayedTasks)
+              done.Set();
+          },
+          delay_ms);
+    }
+  });
+  ASSERT_TRUE(done.Wait(60000));
+
+  webrtc::test::PrintResult(
+      "task_queue_post_delayed_task", "", "lateness",
+      static_cast<double>(total_lateness_us.load()) / kNumDelayedTasks, "us",
+      true);
+}
+
+}  // namespace rtc
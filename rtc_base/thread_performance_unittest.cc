@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "rtc_base/event.h"
+#include "rtc_base/location.h"
+#include "rtc_base/messagehandler.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace rtc {
+namespace {
+
+const int kNumPosters = 4;
+const int kMessagesPerPoster = 100000;
+const int kNumInvokes = 10000;
+const int kNumDelayedMessages = 10000;
+
+class CountingHandler : public MessageHandler {
+ public:
+  CountingHandler(int expected, Event* done)
+      : expected_(expected), done_(done) {}
+  void OnMessage(Message* msg) override {
+    if (++count_ == expected_)
+      done_->Set();
+  }
+
+ private:
+  const int expected_;
+  Event* const done_;
+  int count_ = 0;
+};
+
+// Posts |kMessagesPerPoster| messages for |handler| to |target| when run.
+class FloodHandler : public MessageHandler {
+ public:
+  FloodHandler(Thread* target, MessageHandler* handler)
+      : target_(target), handler_(handler) {}
+  void OnMessage(Message* msg) override {
+    for (int i = 0; i < kMessagesPerPoster; ++i)
+      target_->Post(RTC_FROM_HERE, handler_);
+  }
+
+ private:
+  Thread* const target_;
+  MessageHandler* const handler_;
+};
+
+}  // namespace
+
+// Posts messages to one thread from several other threads at once, as the
+// network and worker threads do with the signaling thread.
+TEST(ThreadPerformanceTest, PostThroughput) {
+  std::unique_ptr<Thread> target(Thread::Create());
+  target->Start();
+  std::vector<std::unique_ptr<Thread>> posters;
+  for (int i = 0; i < kNumPosters; ++i) {
+    posters.push_back(Thread::Create());
+    posters.back()->Start();
+  }
+
+  Event done(false, false);
+  CountingHandler counter(kNumPosters * kMessagesPerPoster, &done);
+  FloodHandler flood(target.get(), &counter);
+  const int64_t start_us = TimeMicros();
+  for (auto& poster : posters)
+    poster->Post(RTC_FROM_HERE, &flood);
+  ASSERT_TRUE(done.Wait(60000));
+  const int64_t elapsed_us = TimeMicros() - start_us;
+
+  webrtc::test::PrintResult(
+      "thread_post", "", "throughput",
+      1000.0 * kNumPosters * kMessagesPerPoster /
+          std::max<int64_t>(elapsed_us, 1),
+      "messages/ms", true);
+}
+
+// Measures a synchronous hop to another thread and back, which is how most
+// PeerConnection API calls reach the signaling thread.
+TEST(ThreadPerformanceTest, InvokeRoundTripLatency) {
+  std::unique_ptr<Thread> target(Thread::Create());
+  target->Start();
+
+  int invokes = 0;
+  const int64_t start_us = TimeMicros();
+  for (int i = 0; i < kNumInvokes; ++i)
+    target->Invoke<void>(RTC_FROM_HERE, [&invokes] { ++invokes; });
+  const int64_t elapsed_us = TimeMicros() - start_us;
+  EXPECT_EQ(kNumInvokes, invokes);
+
+  webrtc::test::PrintResult(
+      "thread_invoke", "", "round_trip_latency",
+      static_cast<double>(elapsed_us) / kNumInvokes, "us", true);
+}
+
+// Posts many delayed messages, as done by the port allocator and ICE timers,
+// and measures the cost of scheduling and dispatching them.
+TEST(ThreadPerformanceTest, PostDelayedThroughput) {
+  std::unique_ptr<Thread> target(Thread::Create());
+  target->Start();
+
+  Event done(false, false);
+  CountingHandler handler(kNumDelayedMessages, &done);
+  const int64_t start_us = TimeMicros();
+  for (int i = 0; i < kNumDelayedMessages; ++i)
+    target->PostDelayed(RTC_FROM_HERE, i % 100, &handler);
+  const int64_t post_us = TimeMicros() - start_us;
+  ASSERT_TRUE(done.Wait(60000));
+
+  webrtc::test::PrintResult(
+      "thread_post_delayed", "", "post_time",
+      static_cast<double>(post_us) / kNumDelayedMessages, "us", true);
+}
+
+}  // namespace rtc
@@ -0,0 +1,343 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TIMER_WHEEL_H_
+#define RTC_BASE_TIMER_WHEEL_H_
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/constructormagic.h"
+
+namespace rtc {
+
+// A hierarchical timing wheel with millisecond resolution. Items are inserted
+// with an absolute deadline and are handed back from Advance() once the wheel
+// time has reached the deadline. Insertion is O(1), and expiring an item costs
+// O(1) amortized: an item is moved to a finer level at most once per level on
+// its way to expiry.
+//
+// Level L has 64 slots, each spanning 64^L ms. An item is filed at the level
+// of the most significant 6-bit digit in which its deadline differs from the
+// current wheel time, so each slot only ever holds items of a single future
+// time range and no item has to be looked at before its range comes up.
+//
+// Nodes are recycled, so a wheel in steady state does not allocate. The class
+// is not thread safe. |T| must be movable and default constructible.
+template <typename T>
+class TimerWheel {
+ public:
+  explicit TimerWheel(int64_t now_ms) : current_ms_(now_ms) {}
+  ~TimerWheel() {
+    Clear();
+    while (free_nodes_) {
+      Node* node = free_nodes_;
+      free_nodes_ = node->next;
+      delete node;
+    }
+  }
+
+  // Schedules |item| to be returned by Advance() once the wheel time reaches
+  // |deadline_ms|. Items with a deadline that has already passed are returned
+  // by the next call to Advance(). Items are returned in deadline order, and
+  // items with the same deadline in the order they were inserted.
+  void Insert(int64_t deadline_ms, T item) {
+    Node* node = free_nodes_;
+    if (node) {
+      free_nodes_ = node->next;
+    } else {
+      node = new Node();
+    }
+    node->deadline_ms = deadline_ms;
+    node->item = std::move(item);
+    ++size_;
+    File(node);
+  }
+
+  // Advances the wheel time to |now_ms| and appends all items with a deadline
+  // at or before |now_ms| to |expired|, in deadline order. If |now_ms| is
+  // before the wheel time, e.g. because a fake clock was installed, the wheel
+  // is moved back to |now_ms| first.
+  void Advance(int64_t now_ms, std::vector<T>* expired) {
+    RTC_DCHECK(expired);
+    if (now_ms < current_ms_)
+      Rewind(now_ms);
+    Expire(&due_, expired);
+    while (true) {
+      absl::optional<int64_t> next_ms = NextSlotMs();
+      if (!next_ms || *next_ms > now_ms)
+        break;
+      current_ms_ = *next_ms;
+      // Redistribute the slots that start at the new time, coarsest first,
+      // then expire whatever has ended up due.
+      for (int level = kNumLevels - 1; level > 0; --level) {
+        if ((current_ms_ & LevelMask(level)) == 0)
+          Cascade(level, SlotIndex(current_ms_, level));
+      }
+      Cascade(0, SlotIndex(current_ms_, 0));
+      Expire(&due_, expired);
+    }
+    if (now_ms > current_ms_)
+      current_ms_ = now_ms;
+  }
+
+  // Returns the next time at which Advance() may have work to do, or nullopt
+  // if the wheel is empty. This is never later than the earliest deadline,
+  // but may be earlier when items need to move to a finer level first.
+  absl::optional<int64_t> NextWakeupMs() const {
+    if (due_.head)
+      return current_ms_;
+    return NextSlotMs();
+  }
+
+  // Calls |fn| with a reference to each scheduled item and removes the items
+  // for which it returns true. |fn| may move from the items it removes.
+  template <typename Function>
+  void EraseIf(Function fn) {
+    if (size_ == 0)
+      return;
+    for (int level = 0; level < kNumLevels; ++level) {
+      uint64_t occupied = occupied_[level];
+      while (occupied) {
+        const int slot = LowestSetBit(occupied);
+        occupied &= occupied - 1;
+        if (EraseIf(&slots_[level][slot], fn))
+          occupied_[level] &= ~(uint64_t{1} << slot);
+      }
+    }
+    EraseIf(&due_, fn);
+  }
+
+  // Destroys all scheduled items.
+  void Clear() {
+    for (auto& level : slots_) {
+      for (List& list : level)
+        Release(&list);
+    }
+    for (uint64_t& occupied : occupied_)
+      occupied = 0;
+    Release(&due_);
+    size_ = 0;
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+ private:
+  static constexpr int kSlotBits = 6;
+  static constexpr int kNumSlots = 1 << kSlotBits;
+  // Covers 2^48 ms of wheel time.
+  static constexpr int kNumLevels = 8;
+
+  struct Node {
+    int64_t deadline_ms = 0;
+    T item;
+    Node* next = nullptr;
+  };
+
+  struct List {
+    Node* head = nullptr;
+    Node* tail = nullptr;
+  };
+
+  static int64_t LevelMask(int level) {
+    return (int64_t{1} << (level * kSlotBits)) - 1;
+  }
+
+  static int SlotIndex(int64_t time_ms, int level) {
+    return static_cast<int>((time_ms >> (level * kSlotBits)) & (kNumSlots - 1));
+  }
+
+  static int LowestSetBit(uint64_t bits) {
+    RTC_DCHECK_NE(bits, 0);
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int index = 0;
+    while ((bits & 1) == 0) {
+      bits >>= 1;
+      ++index;
+    }
+    return index;
+#endif
+  }
+
+  static void Append(List* list, Node* node) {
+    node->next = nullptr;
+    if (list->tail) {
+      list->tail->next = node;
+    } else {
+      list->head = node;
+    }
+    list->tail = node;
+  }
+
+  // Adds |node| to |due_|, after all items with the same or an earlier
+  // deadline.
+  void AddDue(Node* node) {
+    if (!due_.tail || due_.tail->deadline_ms <= node->deadline_ms) {
+      Append(&due_, node);
+      return;
+    }
+    if (node->deadline_ms < due_.head->deadline_ms) {
+      node->next = due_.head;
+      due_.head = node;
+      return;
+    }
+    Node* prev = due_.head;
+    while (prev->next->deadline_ms <= node->deadline_ms)
+      prev = prev->next;
+    node->next = prev->next;
+    prev->next = node;
+  }
+
+  void File(Node* node) {
+    if (node->deadline_ms <= current_ms_) {
+      AddDue(node);
+      return;
+    }
+    const uint64_t diff = static_cast<uint64_t>(node->deadline_ms ^ current_ms_);
+    int level = 0;
+    while (level + 1 < kNumLevels && (diff >> ((level + 1) * kSlotBits)) != 0)
+      ++level;
+    RTC_DCHECK_EQ(diff >> ((level + 1) * kSlotBits), 0)
+        << "Deadline too far in the future.";
+    const int slot = SlotIndex(node->deadline_ms, level);
+    Append(&slots_[level][slot], node);
+    occupied_[level] |= uint64_t{1} << slot;
+  }
+
+  // Empties the given slot and files its items again relative to the current
+  // wheel time.
+  void Cascade(int level, int slot) {
+    if ((occupied_[level] & (uint64_t{1} << slot)) == 0)
+      return;
+    occupied_[level] &= ~(uint64_t{1} << slot);
+    Node* node = slots_[level][slot].head;
+    slots_[level][slot] = List();
+    while (node) {
+      Node* next = node->next;
+      File(node);
+      node = next;
+    }
+  }
+
+  void Expire(List* list, std::vector<T>* expired) {
+    Node* node = list->head;
+    *list = List();
+    while (node) {
+      Node* next = node->next;
+      expired->push_back(std::move(node->item));
+      Recycle(node);
+      --size_;
+      node = next;
+    }
+  }
+
+  // Returns true if |list| is empty afterwards.
+  template <typename Function>
+  bool EraseIf(List* list, Function& fn) {
+    Node* node = list->head;
+    *list = List();
+    while (node) {
+      Node* next = node->next;
+      if (fn(node->item)) {
+        Recycle(node);
+        --size_;
+      } else {
+        Append(list, node);
+      }
+      node = next;
+    }
+    return list->head == nullptr;
+  }
+
+  // Sets the wheel time to the earlier |now_ms| and files all items again.
+  void Rewind(int64_t now_ms) {
+    List all;
+    for (int level = 0; level < kNumLevels; ++level) {
+      for (List& list : slots_[level])
+        Splice(&all, &list);
+      occupied_[level] = 0;
+    }
+    Splice(&all, &due_);
+    current_ms_ = now_ms;
+    Node* node = all.head;
+    while (node) {
+      Node* next = node->next;
+      File(node);
+      node = next;
+    }
+  }
+
+  static void Splice(List* to, List* from) {
+    if (!from->head)
+      return;
+    if (to->tail) {
+      to->tail->next = from->head;
+    } else {
+      to->head = from->head;
+    }
+    to->tail = from->tail;
+    *from = List();
+  }
+
+  void Release(List* list) {
+    Node* node = list->head;
+    *list = List();
+    while (node) {
+      Node* next = node->next;
+      Recycle(node);
+      node = next;
+    }
+  }
+
+  void Recycle(Node* node) {
+    node->item = T();
+    node->next = free_nodes_;
+    free_nodes_ = node;
+  }
+
+  // Returns the start time of the earliest occupied slot. Every occupied slot
+  // lies after the current time within its level, so that is where the next
+  // expiry or cascade happens.
+  absl::optional<int64_t> NextSlotMs() const {
+    absl::optional<int64_t> next_ms;
+    for (int level = 0; level < kNumLevels; ++level) {
+      if (occupied_[level] == 0)
+        continue;
+      const int64_t base_ms = current_ms_ & ~LevelMask(level + 1);
+      const int64_t slot_ms =
+          base_ms |
+          (int64_t{LowestSetBit(occupied_[level])} << (level * kSlotBits));
+      if (!next_ms || slot_ms < *next_ms)
+        next_ms = slot_ms;
+    }
+    return next_ms;
+  }
+
+  int64_t current_ms_;
+  size_t size_ = 0;
+  List slots_[kNumLevels][kNumSlots];
+  uint64_t occupied_[kNumLevels] = {};
+  // Items whose deadline has passed, in deadline order.
+  List due_;
+  Node* free_nodes_ = nullptr;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_TIMER_WHEEL_H_
@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/timer_wheel.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace rtc {
+
+TEST(TimerWheelTest, ExpiresAtDeadline) {
+  TimerWheel<int> wheel(1000);
+  std::vector<int> expired;
+  wheel.Insert(1010, 1);
+  EXPECT_EQ(1010, wheel.NextWakeupMs());
+
+  wheel.Advance(1009, &expired);
+  EXPECT_TRUE(expired.empty());
+  EXPECT_EQ(1u, wheel.size());
+
+  wheel.Advance(1010, &expired);
+  EXPECT_EQ(std::vector<int>({1}), expired);
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.NextWakeupMs());
+}
+
+TEST(TimerWheelTest, PastDeadlineExpiresOnNextAdvance) {
+  TimerWheel<int> wheel(1000);
+  std::vector<int> expired;
+  wheel.Insert(900, 1);
+  wheel.Insert(1000, 2);
+  EXPECT_EQ(1000, wheel.NextWakeupMs());
+  wheel.Advance(1000, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2}), expired);
+}
+
+TEST(TimerWheelTest, PastDeadlinesExpireInDeadlineOrder) {
+  TimerWheel<int> wheel(1000);
+  std::vector<int> expired;
+  wheel.Insert(1000, 3);
+  wheel.Insert(900, 1);
+  wheel.Insert(950, 2);
+  wheel.Insert(1000, 4);
+  wheel.Advance(1000, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2, 3, 4}), expired);
+}
+
+TEST(TimerWheelTest, SameDeadlineKeepsInsertionOrder) {
+  TimerWheel<int> wheel(0);
+  std::vector<int> expired;
+  wheel.Insert(5000, 1);
+  wheel.Advance(4000, &expired);
+  // Filed at a finer level than the first item.
+  wheel.Insert(5000, 2);
+  wheel.Insert(5000, 3);
+  wheel.Advance(6000, &expired);
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), expired);
+}
+
+TEST(TimerWheelTest, WakeupIsNeverLaterThanDeadline) {
+  TimerWheel<int> wheel(123);
+  std::vector<int> expired;
+  const int64_t kDeadlineMs = 123 + 10 * 60 * 1000;
+  wheel.Insert(kDeadlineMs, 1);
+  int wakeups = 0;
+  while (expired.empty()) {
+    absl::optional<int64_t> wakeup_ms = wheel.NextWakeupMs();
+    ASSERT_TRUE(wakeup_ms);
+    ASSERT_LE(*wakeup_ms, kDeadlineMs);
+    wheel.Advance(*wakeup_ms, &expired);
+    ++wakeups;
+  }
+  // One wakeup per level the item moves through.
+  EXPECT_LE(wakeups, 4);
+}
+
+TEST(TimerWheelTest, ExpiresRandomDeadlinesInOrder) {
+  webrtc::Random random(4711);
+  const int64_t kStartMs = 987654321;
+  TimerWheel<std::unique_ptr<int64_t>> wheel(kStartMs);
+  std::vector<int64_t> deadlines;
+  for (int i = 0; i < 2000; ++i) {
+    // Spread deadlines from 1 ms to about a day ahead.
+    const int64_t delay_ms = 1 + (int64_t{1} << random.Rand(0, 26)) +
+                             random.Rand(0, 1000);
+    deadlines.push_back(kStartMs + delay_ms);
+    wheel.Insert(deadlines.back(),
+                 std::unique_ptr<int64_t>(new int64_t(deadlines.back())));
+  }
+  std::sort(deadlines.begin(), deadlines.end());
+
+  std::vector<std::unique_ptr<int64_t>> expired;
+  int64_t now_ms = kStartMs;
+  size_t next = 0;
+  while (!wheel.empty()) {
+    now_ms += random.Rand(1, 100000);
+    wheel.Advance(now_ms, &expired);
+    for (; next < expired.size(); ++next) {
+      ASSERT_EQ(deadlines[next], *expired[next]);
+      ASSERT_LE(*expired[next], now_ms);
+    }
+    if (next < deadlines.size()) {
+      EXPECT_GT(deadlines[next], now_ms);
+    }
+  }
+  EXPECT_EQ(deadlines.size(), expired.size());
+}
+
+TEST(TimerWheelTest, MovesBackWhenTimeGoesBackwards) {
+  TimerWheel<int> wheel(1000000);
+  std::vector<int> expired;
+  wheel.Insert(1000100, 1);
+  // A fake clock starting at zero is installed.
+  wheel.Advance(0, &expired);
+  wheel.Insert(100, 2);
+  wheel.Advance(99, &expired);
+  EXPECT_TRUE(expired.empty());
+  wheel.Advance(100, &expired);
+  EXPECT_EQ(std::vector<int>({2}), expired);
+  EXPECT_EQ(1u, wheel.size());
+}
+
+TEST(TimerWheelTest, EraseIf) {
+  TimerWheel<int> wheel(0);
+  std::vector<int> expired;
+  for (int i = 0; i < 10; ++i)
+    wheel.Insert(i * 1000, i);
+  wheel.EraseIf([](int& item) { return item % 2 == 1; });
+  EXPECT_EQ(5u, wheel.size());
+  wheel.Advance(10000, &expired);
+  EXPECT_EQ(std::vector<int>({0, 2, 4, 6, 8}), expired);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, ClearDestroysItems) {
+  TimerWheel<std::shared_ptr<int>> wheel(0);
+  std::shared_ptr<int> item = std::make_shared<int>(17);
+  wheel.Insert(10, item);
+  wheel.Insert(100000, item);
+  EXPECT_EQ(3, item.use_count());
+  wheel.Clear();
+  EXPECT_EQ(1, item.use_count());
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.NextWakeupMs());
+}
+
+}  // namespace rtc
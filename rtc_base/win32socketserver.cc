@@ -563,6 +563,10 @@ int Win32Socket::TranslateOption(Option opt, int* slevel, int* sopt) {
     case OPT_DSCP:
       RTC_LOG(LS_WARNING) << "Socket::OPT_DSCP not supported.";
       return -1;
+    case OPT_REUSEPORT:
+      // SO_REUSEADDR does not spread the load over the sockets on Windows.
+      RTC_LOG(LS_WARNING) << "Socket::OPT_REUSEPORT not supported.";
+      return -1;
     default:
       RTC_NOTREACHED();
       return -1;
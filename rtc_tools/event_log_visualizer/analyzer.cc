@@ -485,6 +485,16 @@ EventLogAnalyzer::EventLogAnalyzer(const ParsedRtcEventLogNew& log,
   }
   RTC_LOG(LS_INFO) << "Found " << log_segments_.size()
                    << " (LOG_START, LOG_END) segments in log.";
+
+  for (const auto& config : parsed_log_.ice_candidate_pair_configs()) {
+    // TODO(qingsi): Add the handling of the "Updated" config event after the
+    // visualization of property change for candidate pairs is introduced.
+    if (candidate_pair_desc_by_id_.find(config.candidate_pair_id) ==
+        candidate_pair_desc_by_id_.end()) {
+      candidate_pair_desc_by_id_[config.candidate_pair_id] =
+          GetCandidatePairLogDescriptionAsString(config);
+    }
+  }
 }
 
 class BitrateObserver : public NetworkChangedObserver,
@@ -1954,8 +1964,6 @@ void EventLogAnalyzer::CreateIceCandidatePairConfigGraph(Plot* plot) {
           TimeSeries("[" + std::to_string(config.candidate_pair_id) + "]" +
                          candidate_pair_desc,
                      LineStyle::kNone, PointStyle::kHighlight);
-      candidate_pair_desc_by_id_[config.candidate_pair_id] =
-          candidate_pair_desc;
     }
     float x = ToCallTimeSec(config.log_time_us());
     float y = static_cast<float>(config.type);
@@ -1977,23 +1985,9 @@ void EventLogAnalyzer::CreateIceCandidatePairConfigGraph(Plot* plot) {
 }
 
 std::string EventLogAnalyzer::GetCandidatePairLogDescriptionFromId(
-    uint32_t candidate_pair_id) {
-  if (candidate_pair_desc_by_id_.find(candidate_pair_id) !=
-      candidate_pair_desc_by_id_.end()) {
-    return candidate_pair_desc_by_id_[candidate_pair_id];
-  }
-  for (const auto& config : parsed_log_.ice_candidate_pair_configs()) {
-    // TODO(qingsi): Add the handling of the "Updated" config event after the
-    // visualization of property change for candidate pairs is introduced.
-    if (candidate_pair_desc_by_id_.find(config.candidate_pair_id) ==
-        candidate_pair_desc_by_id_.end()) {
-      const std::string candidate_pair_desc =
-          GetCandidatePairLogDescriptionAsString(config);
-      candidate_pair_desc_by_id_[config.candidate_pair_id] =
-          candidate_pair_desc;
-    }
-  }
-  return candidate_pair_desc_by_id_[candidate_pair_id];
+    uint32_t candidate_pair_id) const {
+  auto it = candidate_pair_desc_by_id_.find(candidate_pair_id);
+  return it != candidate_pair_desc_by_id_.end() ? it->second : std::string();
 }
 
 void EventLogAnalyzer::CreateIceConnectivityCheckGraph(Plot* plot) {
@@ -2023,6 +2017,18 @@ void EventLogAnalyzer::CreateIceConnectivityCheckGraph(Plot* plot) {
   plot->SetTitle("[IceEventLog] ICE connectivity checks");
 }
 
+void EventLogAnalyzer::CreatePlots(
+    const std::vector<std::function<void()>>& plot_creators,
+    rtc::TaskPool* pool) {
+  if (!pool) {
+    for (const auto& create_plot : plot_creators)
+      create_plot();
+    return;
+  }
+  pool->ParallelFor(plot_creators.size(),
+                    [&plot_creators](size_t i) { plot_creators[i](); });
+}
+
 void EventLogAnalyzer::PrintNotifications(FILE* file) {
   fprintf(file, "========== TRIAGE NOTIFICATIONS ==========\n");
   for (const auto& alert : incoming_rtp_recv_time_gaps_) {
@@ -11,6 +11,7 @@
 #ifndef RTC_TOOLS_EVENT_LOG_VISUALIZER_ANALYZER_H_
 #define RTC_TOOLS_EVENT_LOG_VISUALIZER_ANALYZER_H_
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
@@ -21,6 +22,7 @@
 #include "logging/rtc_event_log/rtc_event_log_parser_new.h"
 #include "modules/audio_coding/neteq/tools/neteq_stats_getter.h"
 #include "rtc_base/strings/string_builder.h"
+#include "rtc_base/task_pool.h"
 #include "rtc_tools/event_log_visualizer/plot_base.h"
 #include "rtc_tools/event_log_visualizer/triage_notifications.h"
 
@@ -100,6 +102,15 @@ class EventLogAnalyzer {
   void CreateIceCandidatePairConfigGraph(Plot* plot);
   void CreateIceConnectivityCheckGraph(Plot* plot);
 
+  // Calls each of |plot_creators| once, in parallel on the threads of |pool|,
+  // or in order on the calling thread if |pool| is null, and returns when all
+  // calls have returned. The methods above that create a graph only read the
+  // log and the analyzer, so they can run concurrently as long as each one
+  // draws into a Plot of its own. The triage notifications can not.
+  static void CreatePlots(
+      const std::vector<std::function<void()>>& plot_creators,
+      rtc::TaskPool* pool);
+
   void CreateTriageNotifications();
   void PrintNotifications(FILE* file);
 
@@ -219,7 +230,8 @@ class EventLogAnalyzer {
     outgoing_high_loss_alerts_.emplace_back(avg_loss_fraction);
   }
 
-  std::string GetCandidatePairLogDescriptionFromId(uint32_t candidate_pair_id);
+  std::string GetCandidatePairLogDescriptionFromId(
+      uint32_t candidate_pair_id) const;
 
   const ParsedRtcEventLogNew& parsed_log_;
 
@@ -241,6 +253,8 @@ class EventLogAnalyzer {
   std::vector<OutgoingCaptureTimeJump> outgoing_capture_time_jumps_;
   std::vector<OutgoingHighLoss> outgoing_high_loss_alerts_;
 
+  // Set up by the constructor, so that the ICE graphs can be created
+  // concurrently.
   std::map<uint32_t, std::string> candidate_pair_desc_by_id_;
 
   // Window and step size used for calculating moving averages, e.g. bitrate.
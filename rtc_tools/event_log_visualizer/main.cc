@@ -8,10 +8,17 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "absl/memory/memory.h"
 #include "logging/rtc_event_log/rtc_event_log_parser_new.h"
 #include "rtc_base/flags.h"
+#include "rtc_base/task_pool.h"
 #include "rtc_tools/event_log_visualizer/analyzer.h"
 #include "rtc_tools/event_log_visualizer/plot_base.h"
 #include "rtc_tools/event_log_visualizer/plot_protobuf.h"
@@ -166,6 +173,11 @@ DEFINE_bool(protobuf_output,
             false,
             "Output charts as protobuf instead of python code.");
 
+DEFINE_int(plot_threads,
+           0,
+           "Number of threads that create the plots. 0 means one per core, "
+           "and 1 creates them one after the other on the main thread.");
+
 void SetAllPlotFlags(bool setting);
 
 int main(int argc, char* argv[]) {
@@ -232,12 +244,13 @@ int main(int argc, char* argv[]) {
     header_extensions = webrtc::ParsedRtcEventLogNew::
         UnconfiguredHeaderExtensions::kAttemptWebrtcDefaultConfig;
   }
-  webrtc::ParsedRtcEventLogNew parsed_log(header_extensions);
+  // Only the typed accessors are used, so the raw events are not kept.
+  webrtc::ParsedRtcEventLogNew parsed_log(
+      header_extensions, webrtc::ParsedRtcEventLogNew::RawEvents::kDiscard);
 
   if (!parsed_log.ParseFile(filename)) {
     std::cerr << "Could not parse the entire log file." << std::endl;
-    std::cerr << "Proceeding to analyze the first "
-              << parsed_log.GetNumberOfEvents() << " events in the file."
+    std::cerr << "Proceeding to analyze the events before the error."
               << std::endl;
   }
 
@@ -249,151 +262,193 @@ int main(int argc, char* argv[]) {
     collection.reset(new webrtc::PythonPlotCollection());
   }
 
+  // The plots are added to the collection in the order of the flags, and are
+  // created once they all have been added, possibly in parallel.
+  std::vector<std::function<void()>> plot_creators;
+  auto add_plot = [&](std::function<void(webrtc::Plot*)> create_plot) {
+    webrtc::Plot* plot = collection->AppendNewPlot();
+    plot_creators.push_back([create_plot, plot] { create_plot(plot); });
+  };
+
   if (FLAG_plot_incoming_packet_sizes) {
-    analyzer.CreatePacketGraph(webrtc::kIncomingPacket,
-                               collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreatePacketGraph(webrtc::kIncomingPacket, plot);
+    });
   }
   if (FLAG_plot_outgoing_packet_sizes) {
-    analyzer.CreatePacketGraph(webrtc::kOutgoingPacket,
-                               collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreatePacketGraph(webrtc::kOutgoingPacket, plot);
+    });
   }
   if (FLAG_plot_incoming_packet_count) {
-    analyzer.CreateAccumulatedPacketsGraph(webrtc::kIncomingPacket,
-                                           collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAccumulatedPacketsGraph(webrtc::kIncomingPacket, plot);
+    });
   }
   if (FLAG_plot_outgoing_packet_count) {
-    analyzer.CreateAccumulatedPacketsGraph(webrtc::kOutgoingPacket,
-                                           collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAccumulatedPacketsGraph(webrtc::kOutgoingPacket, plot);
+    });
   }
   if (FLAG_plot_audio_playout) {
-    analyzer.CreatePlayoutGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) { analyzer.CreatePlayoutGraph(plot); });
   }
   if (FLAG_plot_audio_level) {
-    analyzer.CreateAudioLevelGraph(webrtc::kIncomingPacket,
-                                   collection->AppendNewPlot());
-    analyzer.CreateAudioLevelGraph(webrtc::kOutgoingPacket,
-                                   collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioLevelGraph(webrtc::kIncomingPacket, plot);
+    });
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioLevelGraph(webrtc::kOutgoingPacket, plot);
+    });
   }
   if (FLAG_plot_incoming_sequence_number_delta) {
-    analyzer.CreateSequenceNumberGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateSequenceNumberGraph(plot);
+    });
   }
   if (FLAG_plot_incoming_delay_delta) {
-    analyzer.CreateIncomingDelayDeltaGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateIncomingDelayDeltaGraph(plot);
+    });
   }
   if (FLAG_plot_incoming_delay) {
-    analyzer.CreateIncomingDelayGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateIncomingDelayGraph(plot);
+    });
   }
   if (FLAG_plot_incoming_loss_rate) {
-    analyzer.CreateIncomingPacketLossGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateIncomingPacketLossGraph(plot);
+    });
   }
   if (FLAG_plot_incoming_bitrate) {
-    analyzer.CreateTotalIncomingBitrateGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateTotalIncomingBitrateGraph(plot);
+    });
   }
   if (FLAG_plot_outgoing_bitrate) {
-    analyzer.CreateTotalOutgoingBitrateGraph(collection->AppendNewPlot(),
-                                             FLAG_show_detector_state,
-                                             FLAG_show_alr_state);
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateTotalOutgoingBitrateGraph(plot, FLAG_show_detector_state,
+                                               FLAG_show_alr_state);
+    });
   }
   if (FLAG_plot_incoming_stream_bitrate) {
-    analyzer.CreateStreamBitrateGraph(webrtc::kIncomingPacket,
-                                      collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateStreamBitrateGraph(webrtc::kIncomingPacket, plot);
+    });
   }
   if (FLAG_plot_outgoing_stream_bitrate) {
-    analyzer.CreateStreamBitrateGraph(webrtc::kOutgoingPacket,
-                                      collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateStreamBitrateGraph(webrtc::kOutgoingPacket, plot);
+    });
   }
   if (FLAG_plot_simulated_receiveside_bwe) {
-    analyzer.CreateReceiveSideBweSimulationGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateReceiveSideBweSimulationGraph(plot);
+    });
   }
   if (FLAG_plot_simulated_sendside_bwe) {
-    analyzer.CreateSendSideBweSimulationGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateSendSideBweSimulationGraph(plot);
+    });
   }
   if (FLAG_plot_network_delay_feedback) {
-    analyzer.CreateNetworkDelayFeedbackGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateNetworkDelayFeedbackGraph(plot);
+    });
   }
   if (FLAG_plot_fraction_loss_feedback) {
-    analyzer.CreateFractionLossGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateFractionLossGraph(plot);
+    });
   }
   if (FLAG_plot_timestamps) {
-    analyzer.CreateTimestampGraph(webrtc::kIncomingPacket,
-                                  collection->AppendNewPlot());
-    analyzer.CreateTimestampGraph(webrtc::kOutgoingPacket,
-                                  collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateTimestampGraph(webrtc::kIncomingPacket, plot);
+    });
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateTimestampGraph(webrtc::kOutgoingPacket, plot);
+    });
   }
   if (FLAG_plot_rtcp_details) {
-    auto GetFractionLost = [](const webrtc::rtcp::ReportBlock& block) -> float {
-      return static_cast<double>(block.fraction_lost()) / 256 * 100;
+    using ReportBlockField = float (*)(const webrtc::rtcp::ReportBlock&);
+    auto add_report_plots = [&](ReportBlockField field,
+                                const std::string& name,
+                                const std::string& yaxis_label) {
+      for (webrtc::PacketDirection direction :
+           {webrtc::kIncomingPacket, webrtc::kOutgoingPacket}) {
+        const std::string title =
+            name + (direction == webrtc::kIncomingPacket ? " (incoming RTCP)"
+                                                         : " (outgoing RTCP)");
+        add_plot([=, &analyzer](webrtc::Plot* plot) {
+          analyzer.CreateSenderAndReceiverReportPlot(
+              direction,
+              [field](const webrtc::rtcp::ReportBlock& block) {
+                return field(block);
+              },
+              title, yaxis_label, plot);
+        });
+      }
     };
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kIncomingPacket, GetFractionLost,
-        "Fraction lost (incoming RTCP)", "Loss rate (percent)",
-        collection->AppendNewPlot());
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kOutgoingPacket, GetFractionLost,
-        "Fraction lost (outgoing RTCP)", "Loss rate (percent)",
-        collection->AppendNewPlot());
 
-    auto GetCumulativeLost =
+    add_report_plots(
         [](const webrtc::rtcp::ReportBlock& block) -> float {
-      return block.cumulative_lost_signed();
-    };
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kIncomingPacket, GetCumulativeLost,
-        "Cumulative lost packets (incoming RTCP)", "Packets",
-        collection->AppendNewPlot());
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kOutgoingPacket, GetCumulativeLost,
-        "Cumulative lost packets (outgoing RTCP)", "Packets",
-        collection->AppendNewPlot());
-
-    auto GetHighestSeqNumber =
+          return static_cast<double>(block.fraction_lost()) / 256 * 100;
+        },
+        "Fraction lost", "Loss rate (percent)");
+    add_report_plots(
         [](const webrtc::rtcp::ReportBlock& block) -> float {
-      return block.extended_high_seq_num();
-    };
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kIncomingPacket, GetHighestSeqNumber,
-        "Highest sequence number (incoming RTCP)", "Sequence number",
-        collection->AppendNewPlot());
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kOutgoingPacket, GetHighestSeqNumber,
-        "Highest sequence number (outgoing RTCP)", "Sequence number",
-        collection->AppendNewPlot());
-
-    auto DelaySinceLastSr =
+          return block.cumulative_lost_signed();
+        },
+        "Cumulative lost packets", "Packets");
+    add_report_plots(
         [](const webrtc::rtcp::ReportBlock& block) -> float {
-      return static_cast<double>(block.delay_since_last_sr()) / 65536;
-    };
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kIncomingPacket, DelaySinceLastSr,
-        "Delay since last received sender report (incoming RTCP)", "Time (s)",
-        collection->AppendNewPlot());
-    analyzer.CreateSenderAndReceiverReportPlot(
-        webrtc::kOutgoingPacket, DelaySinceLastSr,
-        "Delay since last received sender report (outgoing RTCP)", "Time (s)",
-        collection->AppendNewPlot());
+          return block.extended_high_seq_num();
+        },
+        "Highest sequence number", "Sequence number");
+    add_report_plots(
+        [](const webrtc::rtcp::ReportBlock& block) -> float {
+          return static_cast<double>(block.delay_since_last_sr()) / 65536;
+        },
+        "Delay since last received sender report", "Time (s)");
   }
 
   if (FLAG_plot_pacer_delay) {
-    analyzer.CreatePacerDelayGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) { analyzer.CreatePacerDelayGraph(plot); });
   }
   if (FLAG_plot_audio_encoder_bitrate_bps) {
-    analyzer.CreateAudioEncoderTargetBitrateGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioEncoderTargetBitrateGraph(plot);
+    });
   }
   if (FLAG_plot_audio_encoder_frame_length_ms) {
-    analyzer.CreateAudioEncoderFrameLengthGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioEncoderFrameLengthGraph(plot);
+    });
   }
   if (FLAG_plot_audio_encoder_packet_loss) {
-    analyzer.CreateAudioEncoderPacketLossGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioEncoderPacketLossGraph(plot);
+    });
   }
   if (FLAG_plot_audio_encoder_fec) {
-    analyzer.CreateAudioEncoderEnableFecGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioEncoderEnableFecGraph(plot);
+    });
   }
   if (FLAG_plot_audio_encoder_dtx) {
-    analyzer.CreateAudioEncoderEnableDtxGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioEncoderEnableDtxGraph(plot);
+    });
   }
   if (FLAG_plot_audio_encoder_num_channels) {
-    analyzer.CreateAudioEncoderNumChannelsGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateAudioEncoderNumChannelsGraph(plot);
+    });
   }
+  // The NetEq simulation runs first, on this thread, and the plots of its
+  // results are created with the others.
+  webrtc::EventLogAnalyzer::NetEqStatsGetterMap neteq_stats;
   if (FLAG_plot_neteq_stats) {
     std::string wav_path;
     if (FLAG_wav_filename[0] != '\0') {
@@ -402,51 +457,76 @@ int main(int argc, char* argv[]) {
       wav_path = webrtc::test::ResourcePath(
           "audio_processing/conversational_speech/EN_script2_F_sp2_B1", "wav");
     }
-    auto neteq_stats = analyzer.SimulateNetEq(wav_path, 48000);
+    neteq_stats = analyzer.SimulateNetEq(wav_path, 48000);
     for (webrtc::EventLogAnalyzer::NetEqStatsGetterMap::const_iterator it =
              neteq_stats.cbegin();
          it != neteq_stats.cend(); ++it) {
-      analyzer.CreateAudioJitterBufferGraph(it->first, it->second.get(),
-                                            collection->AppendNewPlot());
+      const uint32_t ssrc = it->first;
+      const webrtc::test::NetEqStatsGetter* stats_getter = it->second.get();
+      add_plot([&analyzer, ssrc, stats_getter](webrtc::Plot* plot) {
+        analyzer.CreateAudioJitterBufferGraph(ssrc, stats_getter, plot);
+      });
     }
-    analyzer.CreateNetEqNetworkStatsGraph(
-        neteq_stats,
-        [](const webrtc::NetEqNetworkStatistics& stats) {
-          return stats.expand_rate / 16384.f;
-        },
-        "Expand rate", collection->AppendNewPlot());
-    analyzer.CreateNetEqNetworkStatsGraph(
-        neteq_stats,
-        [](const webrtc::NetEqNetworkStatistics& stats) {
-          return stats.speech_expand_rate / 16384.f;
-        },
-        "Speech expand rate", collection->AppendNewPlot());
-    analyzer.CreateNetEqNetworkStatsGraph(
-        neteq_stats,
-        [](const webrtc::NetEqNetworkStatistics& stats) {
-          return stats.accelerate_rate / 16384.f;
-        },
-        "Accelerate rate", collection->AppendNewPlot());
-    analyzer.CreateNetEqNetworkStatsGraph(
-        neteq_stats,
-        [](const webrtc::NetEqNetworkStatistics& stats) {
-          return stats.packet_loss_rate / 16384.f;
-        },
-        "Packet loss rate", collection->AppendNewPlot());
-    analyzer.CreateNetEqLifetimeStatsGraph(
-        neteq_stats,
-        [](const webrtc::NetEqLifetimeStatistics& stats) {
-          return static_cast<float>(stats.concealment_events);
-        },
-        "Concealment events", collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateNetEqNetworkStatsGraph(
+          neteq_stats,
+          [](const webrtc::NetEqNetworkStatistics& stats) {
+            return stats.expand_rate / 16384.f;
+          },
+          "Expand rate", plot);
+    });
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateNetEqNetworkStatsGraph(
+          neteq_stats,
+          [](const webrtc::NetEqNetworkStatistics& stats) {
+            return stats.speech_expand_rate / 16384.f;
+          },
+          "Speech expand rate", plot);
+    });
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateNetEqNetworkStatsGraph(
+          neteq_stats,
+          [](const webrtc::NetEqNetworkStatistics& stats) {
+            return stats.accelerate_rate / 16384.f;
+          },
+          "Accelerate rate", plot);
+    });
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateNetEqNetworkStatsGraph(
+          neteq_stats,
+          [](const webrtc::NetEqNetworkStatistics& stats) {
+            return stats.packet_loss_rate / 16384.f;
+          },
+          "Packet loss rate", plot);
+    });
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateNetEqLifetimeStatsGraph(
+          neteq_stats,
+          [](const webrtc::NetEqLifetimeStatistics& stats) {
+            return static_cast<float>(stats.concealment_events);
+          },
+          "Concealment events", plot);
+    });
   }
 
   if (FLAG_plot_ice_candidate_pair_config) {
-    analyzer.CreateIceCandidatePairConfigGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateIceCandidatePairConfigGraph(plot);
+    });
   }
   if (FLAG_plot_ice_connectivity_check) {
-    analyzer.CreateIceConnectivityCheckGraph(collection->AppendNewPlot());
+    add_plot([&](webrtc::Plot* plot) {
+      analyzer.CreateIceConnectivityCheckGraph(plot);
+    });
+  }
+
+  std::unique_ptr<rtc::TaskPool> pool;
+  if (FLAG_plot_threads != 1) {
+    rtc::TaskPool::Config config;
+    config.num_threads = std::max(FLAG_plot_threads, 0);
+    pool = absl::make_unique<rtc::TaskPool>(config);
   }
+  webrtc::EventLogAnalyzer::CreatePlots(plot_creators, pool.get());
 
   collection->Draw();
 
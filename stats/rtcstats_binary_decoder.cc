@@ -0,0 +1,440 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "stats/rtcstats_binary_decoder.h"
+
+#include "api/stats/rtcstats_objects.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "stats/rtcstats_binary_format.h"
+
+namespace webrtc {
+
+namespace {
+
+using rtcstats_binary_format::Reader;
+
+bool ReadElement(bool* value, Reader* reader) {
+  uint64_t bits;
+  if (!reader->ReadVarInt(&bits) || bits > 1)
+    return false;
+  *value = bits == 1;
+  return true;
+}
+bool ReadElement(int32_t* value, Reader* reader) {
+  int64_t bits;
+  if (!reader->ReadSignedVarInt(&bits))
+    return false;
+  *value = static_cast<int32_t>(bits);
+  return true;
+}
+bool ReadElement(uint32_t* value, Reader* reader) {
+  uint64_t bits;
+  if (!reader->ReadVarInt(&bits))
+    return false;
+  *value = static_cast<uint32_t>(bits);
+  return true;
+}
+bool ReadElement(int64_t* value, Reader* reader) {
+  return reader->ReadSignedVarInt(value);
+}
+bool ReadElement(uint64_t* value, Reader* reader) {
+  return reader->ReadVarInt(value);
+}
+bool ReadElement(double* value, Reader* reader) {
+  return reader->ReadDouble(value);
+}
+bool ReadElement(std::string* value, Reader* reader) {
+  return reader->ReadString(value);
+}
+
+// |member| is null if the decoder's stats class does not have the member, in
+// which case the value is read and dropped.
+template <typename T>
+bool ReadScalar(RTCStatsMemberInterface* member, Reader* reader) {
+  T value;
+  if (!ReadElement(&value, reader))
+    return false;
+  if (member)
+    *static_cast<RTCStatsMember<T>*>(member) = std::move(value);
+  return true;
+}
+
+template <typename T>
+bool ReadInteger(RTCStatsMemberInterface* member,
+                 const RTCStatsMemberInterface* previous,
+                 Reader* reader) {
+  int64_t difference;
+  if (!reader->ReadSignedVarInt(&difference))
+    return false;
+  uint64_t previous_bits = 0;
+  if (previous && previous->is_defined()) {
+    previous_bits =
+        static_cast<uint64_t>(*previous->cast_to<RTCStatsMember<T>>());
+  }
+  if (member) {
+    *static_cast<RTCStatsMember<T>*>(member) =
+        static_cast<T>(previous_bits + static_cast<uint64_t>(difference));
+  }
+  return true;
+}
+
+template <typename T>
+bool ReadSequence(RTCStatsMemberInterface* member, Reader* reader) {
+  uint64_t size;
+  if (!reader->ReadVarInt(&size))
+    return false;
+  std::vector<T> values;
+  for (uint64_t i = 0; i < size; ++i) {
+    // Every element takes at least a byte, so a corrupt size fails here
+    // rather than in an allocation.
+    T value;
+    if (!ReadElement(&value, reader))
+      return false;
+    values.push_back(std::move(value));
+  }
+  if (member)
+    *static_cast<RTCStatsMember<std::vector<T>>*>(member) = std::move(values);
+  return true;
+}
+
+bool ReadValue(int type,
+               RTCStatsMemberInterface* member,
+               const RTCStatsMemberInterface* previous,
+               Reader* reader) {
+  switch (type) {
+    case RTCStatsMemberInterface::kBool:
+      return ReadScalar<bool>(member, reader);
+    case RTCStatsMemberInterface::kInt32:
+      return ReadInteger<int32_t>(member, previous, reader);
+    case RTCStatsMemberInterface::kUint32:
+      return ReadInteger<uint32_t>(member, previous, reader);
+    case RTCStatsMemberInterface::kInt64:
+      return ReadInteger<int64_t>(member, previous, reader);
+    case RTCStatsMemberInterface::kUint64:
+      return ReadInteger<uint64_t>(member, previous, reader);
+    case RTCStatsMemberInterface::kDouble:
+      return ReadScalar<double>(member, reader);
+    case RTCStatsMemberInterface::kString:
+      return ReadScalar<std::string>(member, reader);
+    case RTCStatsMemberInterface::kSequenceBool:
+      return ReadSequence<bool>(member, reader);
+    case RTCStatsMemberInterface::kSequenceInt32:
+      return ReadSequence<int32_t>(member, reader);
+    case RTCStatsMemberInterface::kSequenceUint32:
+      return ReadSequence<uint32_t>(member, reader);
+    case RTCStatsMemberInterface::kSequenceInt64:
+      return ReadSequence<int64_t>(member, reader);
+    case RTCStatsMemberInterface::kSequenceUint64:
+      return ReadSequence<uint64_t>(member, reader);
+    case RTCStatsMemberInterface::kSequenceDouble:
+      return ReadSequence<double>(member, reader);
+    case RTCStatsMemberInterface::kSequenceString:
+      return ReadSequence<std::string>(member, reader);
+  }
+  return false;
+}
+
+template <typename T>
+void CopyValue(const RTCStatsMemberInterface& from,
+               RTCStatsMemberInterface* to) {
+  *static_cast<RTCStatsMember<T>*>(to) = from.cast_to<RTCStatsMember<T>>();
+}
+
+// Copies the value of |from| to |to|, which are members of the same class.
+void CopyMember(const RTCStatsMemberInterface& from,
+                RTCStatsMemberInterface* to) {
+  if (!from.is_defined())
+    return;
+  switch (from.type()) {
+    case RTCStatsMemberInterface::kBool:
+      CopyValue<bool>(from, to);
+      return;
+    case RTCStatsMemberInterface::kInt32:
+      CopyValue<int32_t>(from, to);
+      return;
+    case RTCStatsMemberInterface::kUint32:
+      CopyValue<uint32_t>(from, to);
+      return;
+    case RTCStatsMemberInterface::kInt64:
+      CopyValue<int64_t>(from, to);
+      return;
+    case RTCStatsMemberInterface::kUint64:
+      CopyValue<uint64_t>(from, to);
+      return;
+    case RTCStatsMemberInterface::kDouble:
+      CopyValue<double>(from, to);
+      return;
+    case RTCStatsMemberInterface::kString:
+      CopyValue<std::string>(from, to);
+      return;
+    case RTCStatsMemberInterface::kSequenceBool:
+      CopyValue<std::vector<bool>>(from, to);
+      return;
+    case RTCStatsMemberInterface::kSequenceInt32:
+      CopyValue<std::vector<int32_t>>(from, to);
+      return;
+    case RTCStatsMemberInterface::kSequenceUint32:
+      CopyValue<std::vector<uint32_t>>(from, to);
+      return;
+    case RTCStatsMemberInterface::kSequenceInt64:
+      CopyValue<std::vector<int64_t>>(from, to);
+      return;
+    case RTCStatsMemberInterface::kSequenceUint64:
+      CopyValue<std::vector<uint64_t>>(from, to);
+      return;
+    case RTCStatsMemberInterface::kSequenceDouble:
+      CopyValue<std::vector<double>>(from, to);
+      return;
+    case RTCStatsMemberInterface::kSequenceString:
+      CopyValue<std::vector<std::string>>(from, to);
+      return;
+  }
+  RTC_NOTREACHED();
+}
+
+// The decoder fills in the members of the stats objects it has just created,
+// and owns, through |RTCStats::Members|, which only hands out const pointers.
+std::vector<RTCStatsMemberInterface*> MutableMembers(RTCStats* stats) {
+  std::vector<RTCStatsMemberInterface*> members;
+  for (const RTCStatsMemberInterface* member : stats->Members())
+    members.push_back(const_cast<RTCStatsMemberInterface*>(member));
+  return members;
+}
+
+std::unique_ptr<RTCStats> CreateMediaStreamTrackStats(std::string&& id,
+                                                      int64_t timestamp_us) {
+  // The kind is a member, which is decoded like the others.
+  return std::unique_ptr<RTCStats>(new RTCMediaStreamTrackStats(
+      std::move(id), timestamp_us, RTCMediaStreamTrackKind::kAudio));
+}
+
+}  // namespace
+
+RTCStatsReportBinaryDecoder::RTCStatsReportBinaryDecoder() {
+  RegisterStatsType<RTCCertificateStats>();
+  RegisterStatsType<RTCCodecStats>();
+  RegisterStatsType<RTCDataChannelStats>();
+  RegisterStatsType<RTCIceCandidatePairStats>();
+  RegisterStatsType<RTCLocalIceCandidateStats>();
+  RegisterStatsType<RTCRemoteIceCandidateStats>();
+  RegisterStatsType<RTCMediaStreamStats>();
+  RegisterStatsType(RTCMediaStreamTrackStats::kType,
+                    &CreateMediaStreamTrackStats);
+  RegisterStatsType<RTCPeerConnectionStats>();
+  RegisterStatsType<RTCInboundRTPStreamStats>();
+  RegisterStatsType<RTCOutboundRTPStreamStats>();
+  RegisterStatsType<RTCTransportStats>();
+}
+
+RTCStatsReportBinaryDecoder::~RTCStatsReportBinaryDecoder() {}
+
+void RTCStatsReportBinaryDecoder::RegisterStatsType(const std::string& type,
+                                                    StatsFactory factory) {
+  RTC_DCHECK(factory);
+  factory_by_type_[type] = factory;
+}
+
+rtc::scoped_refptr<const RTCStatsReport> RTCStatsReportBinaryDecoder::Decode(
+    const std::string& encoded) {
+  rtc::scoped_refptr<const RTCStatsReport> report = DecodeInternal(encoded);
+  previous_report_ = report;
+  return report;
+}
+
+rtc::scoped_refptr<const RTCStatsReport>
+RTCStatsReportBinaryDecoder::DecodeInternal(const std::string& encoded) {
+  Reader reader(encoded.data(), encoded.size());
+  uint64_t flags;
+  if (!reader.ReadVarInt(&flags)) {
+    RTC_LOG(LS_WARNING) << "Empty stats report.";
+    return nullptr;
+  }
+  const bool key_report = (flags & rtcstats_binary_format::kKeyReport) != 0;
+  if (key_report) {
+    uint64_t version;
+    if (!reader.ReadVarInt(&version) ||
+        version != rtcstats_binary_format::kVersion) {
+      RTC_LOG(LS_WARNING) << "Unsupported stats report version.";
+      return nullptr;
+    }
+    schemas_.clear();
+    schema_index_by_type_.clear();
+    previous_report_ = nullptr;
+  } else if (!previous_report_) {
+    RTC_LOG(LS_WARNING) << "Delta stats report without the report before it.";
+    return nullptr;
+  }
+  int64_t timestamp_us;
+  if (!reader.ReadSignedVarInt(&timestamp_us))
+    return nullptr;
+  if (!key_report)
+    timestamp_us += previous_report_->timestamp_us();
+
+  uint64_t num_schemas;
+  if (!reader.ReadVarInt(&num_schemas))
+    return nullptr;
+  for (uint64_t i = 0; i < num_schemas; ++i) {
+    Schema schema;
+    uint64_t num_members;
+    if (!reader.ReadString(&schema.type) || !reader.ReadVarInt(&num_members))
+      return nullptr;
+    auto factory_it = factory_by_type_.find(schema.type);
+    if (factory_it == factory_by_type_.end()) {
+      RTC_LOG(LS_WARNING) << "Unknown stats type " << schema.type << ".";
+      return nullptr;
+    }
+    schema.factory = factory_it->second;
+    const std::unique_ptr<RTCStats> prototype = schema.factory("", 0);
+    const std::vector<const RTCStatsMemberInterface*> members =
+        prototype->Members();
+    for (uint64_t j = 0; j < num_members; ++j) {
+      std::string name;
+      uint64_t type;
+      if (!reader.ReadString(&name) || !reader.ReadVarInt(&type) ||
+          type > RTCStatsMemberInterface::kSequenceString) {
+        return nullptr;
+      }
+      int index = -1;
+      for (size_t k = 0; k < members.size(); ++k) {
+        if (name == members[k]->name() &&
+            static_cast<int>(type) == members[k]->type()) {
+          index = static_cast<int>(k);
+          break;
+        }
+      }
+      schema.members.push_back(std::make_pair(static_cast<int>(type), index));
+    }
+    schema_index_by_type_[schema.type] = schemas_.size();
+    schemas_.push_back(std::move(schema));
+  }
+
+  std::vector<const RTCStats*> previous_stats;
+  if (previous_report_) {
+    for (const RTCStats& stats : *previous_report_)
+      previous_stats.push_back(&stats);
+  }
+  // Whether each previous object has been removed or replaced.
+  std::vector<bool> superseded(previous_stats.size(), false);
+  uint64_t num_removed;
+  if (!reader.ReadVarInt(&num_removed))
+    return nullptr;
+  uint64_t next_index = 0;
+  for (uint64_t i = 0; i < num_removed; ++i) {
+    uint64_t distance;
+    if (!reader.ReadVarInt(&distance) ||
+        distance >= previous_stats.size() - next_index) {
+      return nullptr;
+    }
+    next_index += distance;
+    superseded[next_index++] = true;
+  }
+
+  rtc::scoped_refptr<RTCStatsReport> report =
+      RTCStatsReport::Create(timestamp_us);
+  uint64_t num_stats;
+  if (!reader.ReadVarInt(&num_stats))
+    return nullptr;
+  next_index = 0;
+  for (uint64_t i = 0; i < num_stats; ++i) {
+    uint64_t reference;
+    if (!reader.ReadVarInt(&reference))
+      return nullptr;
+    const RTCStats* previous = nullptr;
+    const Schema* schema;
+    std::string id;
+    if (reference == 0) {
+      uint64_t schema_index;
+      if (!reader.ReadVarInt(&schema_index) ||
+          schema_index >= schemas_.size() || !reader.ReadString(&id)) {
+        return nullptr;
+      }
+      schema = &schemas_[schema_index];
+    } else {
+      if (reference > previous_stats.size() - next_index)
+        return nullptr;
+      next_index += reference - 1;
+      if (superseded[next_index])
+        return nullptr;
+      superseded[next_index] = true;
+      previous = previous_stats[next_index++];
+      schema = &schemas_[schema_index_by_type_[previous->type()]];
+      id = previous->id();
+    }
+    int64_t timestamp_offset_us;
+    if (!reader.ReadSignedVarInt(&timestamp_offset_us) || report->Get(id))
+      return nullptr;
+
+    std::unique_ptr<RTCStats> stats =
+        schema->factory(std::move(id), timestamp_us + timestamp_offset_us);
+    std::vector<RTCStatsMemberInterface*> members = MutableMembers(stats.get());
+    std::vector<const RTCStatsMemberInterface*> previous_members;
+    if (previous)
+      previous_members = previous->Members();
+    std::vector<bool> decoded(members.size(), false);
+    uint64_t num_members;
+    if (!reader.ReadVarInt(&num_members))
+      return nullptr;
+    uint64_t next_member = 0;
+    for (uint64_t j = 0; j < num_members; ++j) {
+      uint64_t value;
+      if (!reader.ReadVarInt(&value) ||
+          (value >> 1) >= schema->members.size() - next_member) {
+        return nullptr;
+      }
+      next_member += value >> 1;
+      const int local_index = schema->members[next_member++].second;
+      if (local_index >= 0)
+        decoded[local_index] = true;
+      if ((value & 1) &&
+          !ReadValue(schema->members[next_member - 1].first,
+                     local_index >= 0 ? members[local_index] : nullptr,
+                     local_index >= 0 && previous
+                         ? previous_members[local_index]
+                         : nullptr,
+                     &reader)) {
+        return nullptr;
+      }
+    }
+    for (size_t j = 0; j < previous_members.size(); ++j) {
+      if (!decoded[j])
+        CopyMember(*previous_members[j], members[j]);
+    }
+    report->AddStats(std::move(stats));
+  }
+
+  // The objects that are left are unchanged.
+  for (size_t i = 0; i < previous_stats.size(); ++i) {
+    if (superseded[i])
+      continue;
+    const RTCStats& previous = *previous_stats[i];
+    if (report->Get(previous.id()))
+      return nullptr;
+    const Schema& schema = schemas_[schema_index_by_type_[previous.type()]];
+    std::unique_ptr<RTCStats> stats = schema.factory(
+        std::string(previous.id()), previous.timestamp_us() -
+                                        previous_report_->timestamp_us() +
+                                        timestamp_us);
+    std::vector<RTCStatsMemberInterface*> members = MutableMembers(stats.get());
+    std::vector<const RTCStatsMemberInterface*> previous_members =
+        previous.Members();
+    for (size_t j = 0; j < members.size(); ++j)
+      CopyMember(*previous_members[j], members[j]);
+    report->AddStats(std::move(stats));
+  }
+
+  if (!reader.done()) {
+    RTC_LOG(LS_WARNING) << "Unexpected data after the stats report.";
+    return nullptr;
+  }
+  return report;
+}
+
+}  // namespace webrtc
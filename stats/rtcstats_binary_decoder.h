@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef STATS_RTCSTATS_BINARY_DECODER_H_
+#define STATS_RTCSTATS_BINARY_DECODER_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "api/stats/rtcstatsreport.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+namespace webrtc {
+
+// Reconstructs the reports encoded by |RTCStatsReportBinaryEncoder|, which
+// must be decoded in the order they were encoded, starting with a key report.
+// The stats objects are created as their own |RTCStats| classes, which must be
+// registered with the decoder. The ones in rtcstats_objects.h are registered
+// by default. Members are matched by name, so the decoder's stats classes can
+// have other members than the encoder's. Members that the decoder does not
+// know are dropped, and the ones the encoder does not know are left
+// undefined.
+class RTCStatsReportBinaryDecoder {
+ public:
+  typedef std::unique_ptr<RTCStats> (*StatsFactory)(std::string&& id,
+                                                    int64_t timestamp_us);
+
+  RTCStatsReportBinaryDecoder();
+  ~RTCStatsReportBinaryDecoder();
+
+  // Registers the stats class |T|, which must be constructible from an ID and
+  // a timestamp.
+  template <typename T>
+  void RegisterStatsType() {
+    RegisterStatsType(T::kType, &CreateStats<T>);
+  }
+  void RegisterStatsType(const std::string& type, StatsFactory factory);
+
+  // Returns null if |encoded| is malformed, holds a stats type that is not
+  // registered, or is a delta report and the report before it was not
+  // decoded. Decoding then resumes at the next key report.
+  rtc::scoped_refptr<const RTCStatsReport> Decode(const std::string& encoded);
+
+ private:
+  struct Schema {
+    std::string type;
+    StatsFactory factory;
+    // The |RTCStatsMemberInterface::Type| of each encoded member and the index
+    // of the member with the same name and type in the decoder's stats class,
+    // or -1 if there is none.
+    std::vector<std::pair<int, int>> members;
+  };
+
+  template <typename T>
+  static std::unique_ptr<RTCStats> CreateStats(std::string&& id,
+                                               int64_t timestamp_us) {
+    return std::unique_ptr<RTCStats>(new T(std::move(id), timestamp_us));
+  }
+
+  rtc::scoped_refptr<const RTCStatsReport> DecodeInternal(
+      const std::string& encoded);
+
+  std::map<std::string, StatsFactory> factory_by_type_;
+  std::vector<Schema> schemas_;
+  std::map<std::string, size_t> schema_index_by_type_;
+  rtc::scoped_refptr<const RTCStatsReport> previous_report_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RTCStatsReportBinaryDecoder);
+};
+
+}  // namespace webrtc
+
+#endif  // STATS_RTCSTATS_BINARY_DECODER_H_
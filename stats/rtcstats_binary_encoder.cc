@@ -0,0 +1,284 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "stats/rtcstats_binary_encoder.h"
+
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "stats/rtcstats_binary_format.h"
+
+namespace webrtc {
+
+namespace {
+
+using rtcstats_binary_format::Writer;
+
+void WriteElement(bool value, Writer* writer) {
+  writer->WriteVarInt(value ? 1 : 0);
+}
+void WriteElement(int32_t value, Writer* writer) {
+  writer->WriteSignedVarInt(value);
+}
+void WriteElement(uint32_t value, Writer* writer) {
+  writer->WriteVarInt(value);
+}
+void WriteElement(int64_t value, Writer* writer) {
+  writer->WriteSignedVarInt(value);
+}
+void WriteElement(uint64_t value, Writer* writer) {
+  writer->WriteVarInt(value);
+}
+void WriteElement(double value, Writer* writer) {
+  writer->WriteDouble(value);
+}
+void WriteElement(const std::string& value, Writer* writer) {
+  writer->WriteString(value);
+}
+
+template <typename T>
+void WriteScalar(const RTCStatsMemberInterface& member, Writer* writer) {
+  WriteElement(*member.cast_to<RTCStatsMember<T>>(), writer);
+}
+
+// Writes the difference from the previous value, with wraparound, so that
+// counters take a byte or two.
+template <typename T>
+void WriteInteger(const RTCStatsMemberInterface& member,
+                  const RTCStatsMemberInterface* previous,
+                  Writer* writer) {
+  uint64_t previous_bits = 0;
+  if (previous && previous->is_defined()) {
+    previous_bits =
+        static_cast<uint64_t>(*previous->cast_to<RTCStatsMember<T>>());
+  }
+  const uint64_t bits =
+      static_cast<uint64_t>(*member.cast_to<RTCStatsMember<T>>());
+  writer->WriteSignedVarInt(static_cast<int64_t>(bits - previous_bits));
+}
+
+template <typename T>
+void WriteSequence(const RTCStatsMemberInterface& member, Writer* writer) {
+  const std::vector<T>& values =
+      *member.cast_to<RTCStatsMember<std::vector<T>>>();
+  writer->WriteVarInt(values.size());
+  for (const auto& value : values)
+    WriteElement(static_cast<T>(value), writer);
+}
+
+void WriteValue(const RTCStatsMemberInterface& member,
+                const RTCStatsMemberInterface* previous,
+                Writer* writer) {
+  switch (member.type()) {
+    case RTCStatsMemberInterface::kBool:
+      WriteScalar<bool>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kInt32:
+      WriteInteger<int32_t>(member, previous, writer);
+      return;
+    case RTCStatsMemberInterface::kUint32:
+      WriteInteger<uint32_t>(member, previous, writer);
+      return;
+    case RTCStatsMemberInterface::kInt64:
+      WriteInteger<int64_t>(member, previous, writer);
+      return;
+    case RTCStatsMemberInterface::kUint64:
+      WriteInteger<uint64_t>(member, previous, writer);
+      return;
+    case RTCStatsMemberInterface::kDouble:
+      WriteScalar<double>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kString:
+      WriteScalar<std::string>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kSequenceBool:
+      WriteSequence<bool>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kSequenceInt32:
+      WriteSequence<int32_t>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kSequenceUint32:
+      WriteSequence<uint32_t>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kSequenceInt64:
+      WriteSequence<int64_t>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kSequenceUint64:
+      WriteSequence<uint64_t>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kSequenceDouble:
+      WriteSequence<double>(member, writer);
+      return;
+    case RTCStatsMemberInterface::kSequenceString:
+      WriteSequence<std::string>(member, writer);
+      return;
+  }
+  RTC_NOTREACHED();
+}
+
+struct MemberDiff {
+  std::vector<const RTCStatsMemberInterface*> members;
+  std::vector<const RTCStatsMemberInterface*> previous_members;
+  // Indices of the members that differ from the previous object's, or of the
+  // defined members if there is no previous object.
+  std::vector<size_t> changed;
+};
+
+MemberDiff DiffMembers(const RTCStats& stats, const RTCStats* previous) {
+  MemberDiff diff;
+  diff.members = stats.Members();
+  if (previous)
+    diff.previous_members = previous->Members();
+  for (size_t i = 0; i < diff.members.size(); ++i) {
+    if (previous ? *diff.members[i] != *diff.previous_members[i]
+                 : diff.members[i]->is_defined()) {
+      diff.changed.push_back(i);
+    }
+  }
+  return diff;
+}
+
+void WriteMembers(const MemberDiff& diff, Writer* writer) {
+  writer->WriteVarInt(diff.changed.size());
+  size_t next = 0;
+  for (size_t i : diff.changed) {
+    const RTCStatsMemberInterface& member = *diff.members[i];
+    writer->WriteVarInt(((i - next) << 1) | (member.is_defined() ? 1 : 0));
+    if (member.is_defined()) {
+      WriteValue(member,
+                 diff.previous_members.empty() ? nullptr
+                                               : diff.previous_members[i],
+                 writer);
+    }
+    next = i + 1;
+  }
+}
+
+void WriteNewStats(const RTCStats& stats,
+                   uint64_t schema_index,
+                   int64_t report_timestamp_us,
+                   Writer* writer) {
+  writer->WriteVarInt(0);
+  writer->WriteVarInt(schema_index);
+  writer->WriteString(stats.id());
+  writer->WriteSignedVarInt(stats.timestamp_us() - report_timestamp_us);
+  WriteMembers(DiffMembers(stats, nullptr), writer);
+}
+
+}  // namespace
+
+RTCStatsReportBinaryEncoder::RTCStatsReportBinaryEncoder() {}
+
+RTCStatsReportBinaryEncoder::~RTCStatsReportBinaryEncoder() {}
+
+std::string RTCStatsReportBinaryEncoder::Encode(
+    const rtc::scoped_refptr<const RTCStatsReport>& report) {
+  RTC_DCHECK(report);
+  const bool key_report = !previous_report_;
+  if (key_report)
+    schema_index_by_type_.clear();
+
+  std::string output;
+  Writer writer(&output);
+  writer.WriteVarInt(key_report ? rtcstats_binary_format::kKeyReport : 0);
+  if (key_report)
+    writer.WriteVarInt(rtcstats_binary_format::kVersion);
+  writer.WriteSignedVarInt(
+      report->timestamp_us() -
+      (key_report ? 0 : previous_report_->timestamp_us()));
+
+  // Schemas for the types that have not been seen yet.
+  std::vector<const RTCStats*> new_types;
+  for (const RTCStats& stats : *report) {
+    auto it = schema_index_by_type_.find(stats.type());
+    if (it != schema_index_by_type_.end())
+      continue;
+    schema_index_by_type_.insert(
+        std::make_pair(stats.type(), schema_index_by_type_.size()));
+    new_types.push_back(&stats);
+  }
+  writer.WriteVarInt(new_types.size());
+  for (const RTCStats* stats : new_types) {
+    writer.WriteString(stats->type());
+    const std::vector<const RTCStatsMemberInterface*> members =
+        stats->Members();
+    writer.WriteVarInt(members.size());
+    for (const RTCStatsMemberInterface* member : members) {
+      writer.WriteString(member->name());
+      writer.WriteVarInt(member->type());
+    }
+  }
+
+  // Both reports are ordered on ID, so the stats objects are diffed in a
+  // single pass. The objects are written to |stats_output| because their
+  // number is only known at the end, as are the removed ones.
+  std::string stats_output;
+  Writer stats_writer(&stats_output);
+  uint64_t num_stats = 0;
+  std::vector<uint64_t> removed;
+  RTCStatsReport::ConstIterator it = report->begin();
+  const RTCStatsReport::ConstIterator end = report->end();
+  if (!key_report) {
+    uint64_t previous_index = 0;
+    // One past the index of the last previous object that was referred to.
+    uint64_t next_reference = 0;
+    for (const RTCStats& previous : *previous_report_) {
+      for (; it != end && it->id() < previous.id(); ++it) {
+        WriteNewStats(*it, schema_index_by_type_[it->type()],
+                      report->timestamp_us(), &stats_writer);
+        ++num_stats;
+      }
+      if (it == end || it->id() != previous.id() ||
+          it->type() != previous.type()) {
+        // If the IDs are the same, the object is replaced by a new one of
+        // another type.
+        removed.push_back(previous_index++);
+        continue;
+      }
+      const int64_t timestamp_offset_us =
+          it->timestamp_us() - report->timestamp_us();
+      MemberDiff diff = DiffMembers(*it, &previous);
+      if (!diff.changed.empty() ||
+          timestamp_offset_us !=
+              previous.timestamp_us() - previous_report_->timestamp_us()) {
+        stats_writer.WriteVarInt(previous_index + 1 - next_reference);
+        next_reference = previous_index + 1;
+        stats_writer.WriteSignedVarInt(timestamp_offset_us);
+        WriteMembers(diff, &stats_writer);
+        ++num_stats;
+      }
+      ++previous_index;
+      ++it;
+    }
+  }
+  for (; it != end; ++it) {
+    WriteNewStats(*it, schema_index_by_type_[it->type()],
+                  report->timestamp_us(), &stats_writer);
+    ++num_stats;
+  }
+
+  writer.WriteVarInt(removed.size());
+  uint64_t next_removed = 0;
+  for (uint64_t index : removed) {
+    writer.WriteVarInt(index - next_removed);
+    next_removed = index + 1;
+  }
+  writer.WriteVarInt(num_stats);
+  output += stats_output;
+
+  previous_report_ = report;
+  return output;
+}
+
+void RTCStatsReportBinaryEncoder::RequestKeyReport() {
+  previous_report_ = nullptr;
+}
+
+}  // namespace webrtc
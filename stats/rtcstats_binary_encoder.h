@@ -0,0 +1,56 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef STATS_RTCSTATS_BINARY_ENCODER_H_
+#define STATS_RTCSTATS_BINARY_ENCODER_H_
+
+#include <map>
+#include <string>
+
+#include "api/stats/rtcstatsreport.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+namespace webrtc {
+
+// Encodes a sequence of reports, such as those of a periodic getStats() poll,
+// in a compact binary format to be decoded with |RTCStatsReportBinaryDecoder|.
+// This is an alternative to |RTCStatsReport::ToJson| for exporting stats. The
+// first report is encoded in full, as a key report. Each report after that is
+// encoded against the one before, as the stats objects that were added,
+// removed or changed, and only the members of the changed objects that
+// changed. Integers are encoded as the difference from their previous value,
+// so counters take a byte or two. The member names and types are sent once,
+// as a schema for each stats type, derived from the |WEBRTC_RTCSTATS_IMPL|
+// member lists.
+class RTCStatsReportBinaryEncoder {
+ public:
+  RTCStatsReportBinaryEncoder();
+  ~RTCStatsReportBinaryEncoder();
+
+  // Holds on to |report| until the next report has been encoded against it.
+  std::string Encode(const rtc::scoped_refptr<const RTCStatsReport>& report);
+
+  // Makes the next report a key report, which can be decoded without the ones
+  // before it, e.g. by a decoder that joins late or has lost a report.
+  void RequestKeyReport();
+
+ private:
+  rtc::scoped_refptr<const RTCStatsReport> previous_report_;
+  // The schema index of each stats type, keyed by |RTCStats::type|, which is
+  // the |kType| of the stats class.
+  std::map<const char*, uint64_t> schema_index_by_type_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(RTCStatsReportBinaryEncoder);
+};
+
+}  // namespace webrtc
+
+#endif  // STATS_RTCSTATS_BINARY_ENCODER_H_
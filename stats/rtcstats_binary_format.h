@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2018 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef STATS_RTCSTATS_BINARY_FORMAT_H_
+#define STATS_RTCSTATS_BINARY_FORMAT_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+namespace webrtc {
+namespace rtcstats_binary_format {
+
+// The binary stats format, shared by |RTCStatsReportBinaryEncoder| and
+// |RTCStatsReportBinaryDecoder|. Integers are varints, zigzag encoded if they
+// are signed, strings are a varint length followed by the bytes and doubles
+// are their 8 byte IEEE 754 representation, little endian.
+//
+// An encoded report is:
+//   flags                 kKeyReport if the report does not depend on the
+//                         previous one.
+//   [version]             kVersion, in key reports only.
+//   timestamp_us          Signed, relative to the previous report's in delta
+//                         reports.
+//   num_schemas, schemas  The stats types that appear for the first time since
+//                         the last key report. A schema is the type, the
+//                         number of members and each member's name and
+//                         |RTCStatsMemberInterface::Type|, in |Members| order.
+//                         Schemas are numbered in the order they appear.
+//   num_removed, removed  Indices, in ID order, of the previous report's stats
+//                         objects that are not in this one, each as the
+//                         distance from the one before, minus one.
+//   num_stats, stats      The stats objects that are new or changed, in ID
+//                         order.
+// A stats object is:
+//   reference             0 for a new object, followed by its schema index and
+//                         its ID. Otherwise the distance from the previous
+//                         object the report refers to, which the object
+//                         replaces.
+//   timestamp_us          Signed, relative to the report's.
+//   num_members, members  The members that differ from the previous object's,
+//                         or that are defined in a new object. A member is the
+//                         distance from the member before, minus one, shifted
+//                         up by one bit that is set if the member is defined,
+//                         followed by the value if it is. Integers are
+//                         encoded as the difference from their previous value
+//                         if that was defined. Sequences are the number of
+//                         elements followed by the elements.
+// The previous report's objects that are neither removed nor replaced are
+// unchanged, apart from their timestamps, which keep their offsets from the
+// report's.
+constexpr uint64_t kKeyReport = 1;
+constexpr uint64_t kVersion = 1;
+
+class Writer {
+ public:
+  explicit Writer(std::string* output) : output_(output) {}
+
+  void WriteVarInt(uint64_t value) {
+    while (value >= 0x80) {
+      output_->push_back(static_cast<char>(0x80 | (value & 0x7f)));
+      value >>= 7;
+    }
+    output_->push_back(static_cast<char>(value));
+  }
+  void WriteSignedVarInt(int64_t value) {
+    const uint64_t bits = static_cast<uint64_t>(value);
+    WriteVarInt((bits << 1) ^ (value < 0 ? ~uint64_t{0} : 0));
+  }
+  void WriteDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+      output_->push_back(static_cast<char>(bits >> (8 * i)));
+  }
+  void WriteString(const std::string& value) {
+    WriteVarInt(value.size());
+    output_->append(value);
+  }
+
+ private:
+  std::string* const output_;
+};
+
+class Reader {
+ public:
+  Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+  bool done() const { return position_ == size_; }
+
+  bool ReadVarInt(uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && position_ < size_; shift += 7) {
+      const uint8_t byte = static_cast<uint8_t>(data_[position_++]);
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+  bool ReadSignedVarInt(int64_t* value) {
+    uint64_t bits;
+    if (!ReadVarInt(&bits))
+      return false;
+    *value = static_cast<int64_t>((bits >> 1) ^ (~(bits & 1) + 1));
+    return true;
+  }
+  bool ReadDouble(double* value) {
+    if (size_ - position_ < 8)
+      return false;
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i)
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(data_[position_++]))
+              << (8 * i);
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+  }
+  bool ReadString(std::string* value) {
+    uint64_t length;
+    if (!ReadVarInt(&length) || length > size_ - position_)
+      return false;
+    value->assign(data_ + position_, length);
+    position_ += length;
+    return true;
+  }
+
+ private:
+  const char* const data_;
+  const size_t size_;
+  size_t position_ = 0;
+};
+
+}  // namespace rtcstats_binary_format
+}  // namespace webrtc
+
+#endif  // STATS_RTCSTATS_BINARY_FORMAT_H_
@@ -0,0 +1,248 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/stats/rtcstats_objects.h"
+#include "api/stats/rtcstatsreport.h"
+#include "rtc_base/timeutils.h"
+#include "stats/rtcstats_binary_decoder.h"
+#include "stats/rtcstats_binary_encoder.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+// Local and remote audio and video, 20 tracks in all.
+constexpr int kTracksPerDirectionAndKind = 5;
+constexpr int kNumPolls = 100;
+constexpr int64_t kPollIntervalUs = rtc::kNumMicrosecsPerSec;
+
+template <typename T>
+T* AddStats(RTCStatsReport* report, T* stats) {
+  report->AddStats(std::unique_ptr<RTCStats>(stats));
+  return stats;
+}
+
+// The report of a peer connection with |kTracksPerDirectionAndKind| audio and
+// video tracks in each direction, |poll| seconds into a call. The counters
+// advance and the rest stays the same, as in a getStats() poll.
+rtc::scoped_refptr<const RTCStatsReport> CreateReport(int poll) {
+  const int64_t timestamp_us = (poll + 1) * kPollIntervalUs;
+  const uint32_t packets = 50 * poll;
+  rtc::scoped_refptr<RTCStatsReport> report =
+      RTCStatsReport::Create(timestamp_us);
+
+  RTCPeerConnectionStats* peer_connection =
+      AddStats(report.get(),
+               new RTCPeerConnectionStats("RTCPeerConnection", timestamp_us));
+  peer_connection->data_channels_opened = 0;
+  peer_connection->data_channels_closed = 0;
+
+  for (const char* direction : {"local", "remote"}) {
+    RTCCertificateStats* certificate = AddStats(
+        report.get(),
+        new RTCCertificateStats(
+            std::string("RTCCertificate_") + direction, timestamp_us));
+    certificate->fingerprint = std::string(95, 'f');
+    certificate->fingerprint_algorithm = "sha-256";
+    certificate->base64_certificate = std::string(600, 'c');
+
+    RTCIceCandidateStats* candidate =
+        direction == std::string("local")
+            ? static_cast<RTCIceCandidateStats*>(
+                  AddStats(report.get(),
+                           new RTCLocalIceCandidateStats(
+                               "RTCIceCandidate_local", timestamp_us)))
+            : AddStats(report.get(),
+                       new RTCRemoteIceCandidateStats(
+                           "RTCIceCandidate_remote", timestamp_us));
+    candidate->transport_id = "RTCTransport_0_1";
+    candidate->is_remote = direction != std::string("local");
+    candidate->ip = "192.168.1.1";
+    candidate->port = 50000;
+    candidate->protocol = "udp";
+    candidate->candidate_type = "host";
+    candidate->priority = 2122260223;
+    candidate->deleted = false;
+  }
+
+  RTCIceCandidatePairStats* pair = AddStats(
+      report.get(),
+      new RTCIceCandidatePairStats(
+          "RTCIceCandidatePair_local_remote", timestamp_us));
+  pair->transport_id = "RTCTransport_0_1";
+  pair->local_candidate_id = "RTCIceCandidate_local";
+  pair->remote_candidate_id = "RTCIceCandidate_remote";
+  pair->state = "succeeded";
+  pair->priority = 9114723795036258303;
+  pair->nominated = true;
+  pair->writable = true;
+  pair->bytes_sent = 2000000u * poll;
+  pair->bytes_received = 2000000u * poll;
+  pair->total_round_trip_time = 0.05 * poll;
+  pair->current_round_trip_time = 0.05;
+  pair->requests_received = poll / 2;
+  pair->requests_sent = poll / 2;
+  pair->responses_received = poll / 2;
+  pair->responses_sent = poll / 2;
+
+  RTCTransportStats* transport = AddStats(
+      report.get(), new RTCTransportStats("RTCTransport_0_1", timestamp_us));
+  transport->bytes_sent = 2000000u * poll;
+  transport->bytes_received = 2000000u * poll;
+  transport->dtls_state = "connected";
+  transport->selected_candidate_pair_id = "RTCIceCandidatePair_local_remote";
+  transport->local_certificate_id = "RTCCertificate_local";
+  transport->remote_certificate_id = "RTCCertificate_remote";
+
+  const char* const kKinds[] = {RTCMediaStreamTrackKind::kAudio,
+                                RTCMediaStreamTrackKind::kVideo};
+  for (const char* kind : kKinds) {
+    const bool audio = kind == RTCMediaStreamTrackKind::kAudio;
+    for (const char* direction : {"Inbound", "Outbound"}) {
+      RTCCodecStats* codec = AddStats(
+          report.get(),
+          new RTCCodecStats(std::string("RTCCodec_") + kind + "_" + direction,
+                            timestamp_us));
+      codec->payload_type = audio ? 111 : 96;
+      codec->mime_type = audio ? "audio/opus" : "video/VP8";
+      codec->clock_rate = audio ? 48000 : 90000;
+    }
+    for (int i = 0; i < 2 * kTracksPerDirectionAndKind; ++i) {
+      const bool inbound = i < kTracksPerDirectionAndKind;
+      const std::string name = std::string(kind) + "_" + std::to_string(i);
+      const uint32_t ssrc = (audio ? 1000 : 2000) + i;
+      RTCMediaStreamTrackStats* track =
+          AddStats(report.get(),
+                   new RTCMediaStreamTrackStats(
+                       "RTCMediaStreamTrack_" + name, timestamp_us, kind));
+      track->track_identifier = name;
+      track->remote_source = inbound;
+      track->ended = false;
+      track->detached = false;
+      if (audio) {
+        track->audio_level = 0.25;
+        track->total_audio_energy = 0.1 * poll;
+        track->total_samples_duration = 1.0 * poll;
+        if (inbound) {
+          track->jitter_buffer_delay = 0.06 * poll;
+          track->total_samples_received = 48000u * poll;
+          track->concealed_samples = 100u * poll;
+          track->concealment_events = poll / 10;
+        }
+      } else {
+        track->frame_width = 1280;
+        track->frame_height = 720;
+        track->frames_per_second = 30.0;
+        if (inbound) {
+          track->frames_received = 30 * poll;
+          track->frames_decoded = 30 * poll;
+          track->frames_dropped = poll / 20;
+        } else {
+          track->frames_sent = 30 * poll;
+          track->huge_frames_sent = 0;
+        }
+      }
+
+      RTCRTPStreamStats* rtp;
+      if (inbound) {
+        RTCInboundRTPStreamStats* inbound_rtp = AddStats(
+            report.get(), new RTCInboundRTPStreamStats(
+                              "RTCInboundRTP" + name, timestamp_us));
+        inbound_rtp->packets_received = packets;
+        inbound_rtp->bytes_received = 1000u * packets;
+        inbound_rtp->packets_lost = poll / 10;
+        inbound_rtp->jitter = 0.002;
+        inbound_rtp->fraction_lost = 0.0;
+        if (!audio)
+          inbound_rtp->frames_decoded = 30 * poll;
+        rtp = inbound_rtp;
+      } else {
+        RTCOutboundRTPStreamStats* outbound_rtp = AddStats(
+            report.get(), new RTCOutboundRTPStreamStats(
+                              "RTCOutboundRTP" + name, timestamp_us));
+        outbound_rtp->packets_sent = packets;
+        outbound_rtp->bytes_sent = 1000u * packets;
+        outbound_rtp->target_bitrate = audio ? 32000.0 : 1500000.0;
+        if (!audio)
+          outbound_rtp->frames_encoded = 30 * poll;
+        rtp = outbound_rtp;
+      }
+      rtp->ssrc = ssrc;
+      rtp->is_remote = false;
+      rtp->media_type = audio ? "audio" : "video";
+      rtp->kind = rtp->media_type;
+      rtp->track_id = "RTCMediaStreamTrack_" + name;
+      rtp->transport_id = "RTCTransport_0_1";
+      rtp->codec_id = std::string("RTCCodec_") + kind + "_" +
+                      (inbound ? "Inbound" : "Outbound");
+      if (!audio) {
+        rtp->fir_count = 0;
+        rtp->pli_count = poll / 30;
+        rtp->nack_count = poll / 5;
+        rtp->qp_sum = 20u * 30 * poll;
+      }
+    }
+  }
+  return report;
+}
+
+}  // namespace
+
+TEST(RTCStatsBinaryFormatPerformanceTest, EncodeTwentyTrackPolls) {
+  std::vector<rtc::scoped_refptr<const RTCStatsReport>> reports;
+  for (int poll = 0; poll < kNumPolls; ++poll)
+    reports.push_back(CreateReport(poll));
+
+  size_t json_bytes = 0;
+  int64_t start_us = rtc::TimeMicros();
+  for (const auto& report : reports)
+    json_bytes += report->ToJson().size();
+  const int64_t json_us = rtc::TimeMicros() - start_us;
+
+  RTCStatsReportBinaryEncoder encoder;
+  std::vector<std::string> encoded;
+  start_us = rtc::TimeMicros();
+  for (const auto& report : reports)
+    encoded.push_back(encoder.Encode(report));
+  const int64_t encode_us = rtc::TimeMicros() - start_us;
+  size_t delta_bytes = 0;
+  for (size_t i = 1; i < encoded.size(); ++i)
+    delta_bytes += encoded[i].size();
+
+  RTCStatsReportBinaryDecoder decoder;
+  start_us = rtc::TimeMicros();
+  for (size_t i = 0; i < encoded.size(); ++i) {
+    rtc::scoped_refptr<const RTCStatsReport> decoded =
+        decoder.Decode(encoded[i]);
+    ASSERT_TRUE(decoded);
+    ASSERT_EQ(reports[i]->size(), decoded->size());
+  }
+  const int64_t decode_us = rtc::TimeMicros() - start_us;
+
+  test::PrintResult("rtc_stats_export_size", "", "json",
+                    json_bytes / kNumPolls, "bytes", true);
+  test::PrintResult("rtc_stats_export_size", "", "binary_key",
+                    encoded[0].size(), "bytes", true);
+  test::PrintResult("rtc_stats_export_size", "", "binary_delta",
+                    delta_bytes / (kNumPolls - 1), "bytes", true);
+  test::PrintResult("rtc_stats_export_time", "", "json",
+                    static_cast<double>(json_us) / kNumPolls, "us", true);
+  test::PrintResult("rtc_stats_export_time", "", "binary_encode",
+                    static_cast<double>(encode_us) / kNumPolls, "us", true);
+  test::PrintResult("rtc_stats_export_time", "", "binary_decode",
+                    static_cast<double>(decode_us) / kNumPolls, "us", false);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,237 @@
+/*
+ *  Copyright 2018 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/stats/rtcstats_objects.h"
+#include "api/stats/rtcstatsreport.h"
+#include "rtc_base/gunit.h"
+#include "stats/rtcstats_binary_decoder.h"
+#include "stats/rtcstats_binary_encoder.h"
+#include "stats/test/rtcteststats.h"
+
+namespace webrtc {
+
+namespace {
+
+// Has some of |RTCTestStats|'s members, as an older or newer version of it.
+class RTCTestStatsSubset : public RTCStats {
+ public:
+  WEBRTC_RTCSTATS_DECL();
+
+  RTCTestStatsSubset(const std::string& id, int64_t timestamp_us)
+      : RTCStats(id, timestamp_us),
+        m_int32("mInt32"),
+        m_string("mString"),
+        m_other("mOther") {}
+
+  RTCStatsMember<int32_t> m_int32;
+  RTCStatsMember<std::string> m_string;
+  RTCStatsMember<double> m_other;
+};
+
+WEBRTC_RTCSTATS_IMPL(RTCTestStatsSubset,
+                     RTCStats,
+                     "test-stats",
+                     &m_int32,
+                     &m_string,
+                     &m_other);
+
+std::unique_ptr<RTCTestStats> CreateTestStats(const std::string& id,
+                                              int64_t timestamp_us) {
+  std::unique_ptr<RTCTestStats> stats(new RTCTestStats(id, timestamp_us));
+  stats->m_bool = true;
+  stats->m_int32 = -42;
+  stats->m_uint32 = 42;
+  stats->m_int64 = -1234567890123;
+  stats->m_uint64 = 0xfedcba9876543210;
+  stats->m_double = 3.25;
+  stats->m_string = "string";
+  stats->m_sequence_bool = std::vector<bool>{true, false};
+  stats->m_sequence_int32 = std::vector<int32_t>{-1, 2};
+  stats->m_sequence_uint32 = std::vector<uint32_t>{3, 4};
+  stats->m_sequence_int64 = std::vector<int64_t>{-5, 6};
+  stats->m_sequence_uint64 = std::vector<uint64_t>{7, 8};
+  stats->m_sequence_double = std::vector<double>{0.5, -1.5};
+  stats->m_sequence_string = std::vector<std::string>{"a", "b"};
+  return stats;
+}
+
+// |RTCStats::operator==| does not compare timestamps.
+void ExpectReportsEqual(const RTCStatsReport& expected,
+                        const RTCStatsReport& actual) {
+  EXPECT_EQ(expected.timestamp_us(), actual.timestamp_us());
+  ASSERT_EQ(expected.size(), actual.size());
+  for (const RTCStats& stats : expected) {
+    const RTCStats* decoded = actual.Get(stats.id());
+    ASSERT_TRUE(decoded) << stats.id();
+    EXPECT_EQ(stats, *decoded) << stats.ToJson() << " " << decoded->ToJson();
+    EXPECT_EQ(stats.timestamp_us(), decoded->timestamp_us());
+  }
+}
+
+class RTCStatsBinaryFormatTest : public testing::Test {
+ public:
+  RTCStatsBinaryFormatTest() {
+    decoder_.RegisterStatsType<RTCTestStats>();
+  }
+
+  // Returns the size of the encoded report.
+  size_t EncodeAndDecode(const rtc::scoped_refptr<RTCStatsReport>& report) {
+    const std::string encoded = encoder_.Encode(report);
+    rtc::scoped_refptr<const RTCStatsReport> decoded =
+        decoder_.Decode(encoded);
+    EXPECT_TRUE(decoded);
+    if (decoded)
+      ExpectReportsEqual(*report, *decoded);
+    return encoded.size();
+  }
+
+ protected:
+  RTCStatsReportBinaryEncoder encoder_;
+  RTCStatsReportBinaryDecoder decoder_;
+};
+
+}  // namespace
+
+TEST_F(RTCStatsBinaryFormatTest, KeyReportWithAllMemberTypes) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateTestStats("a", 1000));
+  report->AddStats(CreateTestStats("b", 990));
+  report->AddStats(
+      std::unique_ptr<RTCStats>(new RTCTestStats("undefined", 1000)));
+  EncodeAndDecode(report);
+}
+
+TEST_F(RTCStatsBinaryFormatTest, DeltaReports) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateTestStats("a", 1000));
+  report->AddStats(CreateTestStats("b", 1000));
+  report->AddStats(CreateTestStats("c", 1000));
+  EncodeAndDecode(report);
+
+  // "a" changes, "b" is removed, "c" is unchanged and "d" is added.
+  report = RTCStatsReport::Create(2000);
+  // Members that are not set become undefined.
+  std::unique_ptr<RTCTestStats> a(new RTCTestStats("a", 2000));
+  a->m_int32 = 1;
+  a->m_uint64 = 1;
+  a->m_string = "changed";
+  a->m_sequence_string = std::vector<std::string>{"c"};
+  report->AddStats(std::move(a));
+  report->AddStats(CreateTestStats("c", 2000));
+  report->AddStats(CreateTestStats("d", 1950));
+  EncodeAndDecode(report);
+
+  // An object is replaced by one of another type with the same ID.
+  report = RTCStatsReport::Create(3000);
+  report->AddStats(CreateTestStats("a", 3000));
+  report->AddStats(std::unique_ptr<RTCStats>(
+      new RTCPeerConnectionStats("c", 3000)));
+  report->AddStats(CreateTestStats("d", 2950));
+  EncodeAndDecode(report);
+
+  report = RTCStatsReport::Create(4000);
+  EncodeAndDecode(report);
+}
+
+TEST_F(RTCStatsBinaryFormatTest, UnchangedReportIsSmall) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  for (int i = 0; i < 10; ++i)
+    report->AddStats(CreateTestStats("stats" + std::to_string(i), 1000));
+  const size_t key_report_size = EncodeAndDecode(report);
+
+  rtc::scoped_refptr<RTCStatsReport> unchanged =
+      RTCStatsReport::Create(2000);
+  for (int i = 0; i < 10; ++i)
+    unchanged->AddStats(CreateTestStats("stats" + std::to_string(i), 2000));
+  // The flags, a two byte timestamp, and no schemas, removed or stats
+  // objects.
+  EXPECT_EQ(6u, EncodeAndDecode(unchanged));
+  EXPECT_GT(key_report_size, 100u);
+}
+
+TEST_F(RTCStatsBinaryFormatTest, CountersAreEncodedAsDifferences) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  std::unique_ptr<RTCTestStats> stats(new RTCTestStats("a", 1000));
+  stats->m_uint64 = 1000000000000;
+  report->AddStats(std::move(stats));
+  EncodeAndDecode(report);
+
+  report = RTCStatsReport::Create(2000);
+  stats.reset(new RTCTestStats("a", 2000));
+  stats->m_uint64 = 1000000000001;
+  report->AddStats(std::move(stats));
+  // The flags, a two byte timestamp, no schemas or removed objects, and one
+  // stats object with its reference, timestamp, one member and a one byte
+  // value.
+  EXPECT_EQ(11u, EncodeAndDecode(report));
+}
+
+TEST_F(RTCStatsBinaryFormatTest, MembersAreMatchedByName) {
+  RTCStatsReportBinaryDecoder decoder;
+  decoder.RegisterStatsType<RTCTestStatsSubset>();
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateTestStats("a", 1000));
+  rtc::scoped_refptr<const RTCStatsReport> decoded =
+      decoder.Decode(encoder_.Encode(report));
+  ASSERT_TRUE(decoded);
+  const RTCTestStatsSubset& stats =
+      decoded->Get("a")->cast_to<RTCTestStatsSubset>();
+  EXPECT_EQ(-42, *stats.m_int32);
+  EXPECT_EQ("string", *stats.m_string);
+  EXPECT_FALSE(stats.m_other.is_defined());
+
+  report = RTCStatsReport::Create(2000);
+  std::unique_ptr<RTCTestStats> changed = CreateTestStats("a", 2000);
+  changed->m_int32 = 7;
+  changed->m_uint64 = 8;
+  report->AddStats(std::move(changed));
+  decoded = decoder.Decode(encoder_.Encode(report));
+  ASSERT_TRUE(decoded);
+  EXPECT_EQ(7, *decoded->Get("a")->cast_to<RTCTestStatsSubset>().m_int32);
+}
+
+TEST_F(RTCStatsBinaryFormatTest, UnknownStatsTypeFails) {
+  RTCStatsReportBinaryDecoder decoder;
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateTestStats("a", 1000));
+  EXPECT_FALSE(decoder.Decode(encoder_.Encode(report)));
+}
+
+TEST_F(RTCStatsBinaryFormatTest, MalformedReportFails) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateTestStats("a", 1000));
+  const std::string encoded = encoder_.Encode(report);
+  EXPECT_FALSE(decoder_.Decode(""));
+  for (size_t size = 1; size < encoded.size(); ++size)
+    EXPECT_FALSE(decoder_.Decode(encoded.substr(0, size))) << size;
+  EXPECT_FALSE(decoder_.Decode(encoded + '\0'));
+  EXPECT_TRUE(decoder_.Decode(encoded));
+}
+
+TEST_F(RTCStatsBinaryFormatTest, DeltaReportWithoutItsBaseFails) {
+  rtc::scoped_refptr<RTCStatsReport> report = RTCStatsReport::Create(1000);
+  report->AddStats(CreateTestStats("a", 1000));
+  encoder_.Encode(report);
+
+  report = RTCStatsReport::Create(2000);
+  report->AddStats(CreateTestStats("b", 2000));
+  EXPECT_FALSE(decoder_.Decode(encoder_.Encode(report)));
+
+  encoder_.RequestKeyReport();
+  report = RTCStatsReport::Create(3000);
+  report->AddStats(CreateTestStats("c", 3000));
+  EncodeAndDecode(report);
+}
+
+}  // namespace webrtc
@@ -117,7 +117,9 @@ WEBRTC_RTCSTATS_IMPL(RTCDataChannelStats, RTCStats, "data-channel",
     &messages_sent,
     &bytes_sent,
     &messages_received,
-    &bytes_received);
+    &bytes_received,
+    &fec_messages_recovered,
+    &fec_messages_unrecovered);
 // clang-format on
 
 RTCDataChannelStats::RTCDataChannelStats(const std::string& id,
@@ -133,7 +135,9 @@ RTCDataChannelStats::RTCDataChannelStats(std::string&& id, int64_t timestamp_us)
       messages_sent("messagesSent"),
       bytes_sent("bytesSent"),
       messages_received("messagesReceived"),
-      bytes_received("bytesReceived") {}
+      bytes_received("bytesReceived"),
+      fec_messages_recovered("fecMessagesRecovered"),
+      fec_messages_unrecovered("fecMessagesUnrecovered") {}
 
 RTCDataChannelStats::RTCDataChannelStats(const RTCDataChannelStats& other)
     : RTCStats(other.id(), other.timestamp_us()),
@@ -144,7 +148,9 @@ RTCDataChannelStats::RTCDataChannelStats(const RTCDataChannelStats& other)
       messages_sent(other.messages_sent),
       bytes_sent(other.bytes_sent),
       messages_received(other.messages_received),
-      bytes_received(other.bytes_received) {}
+      bytes_received(other.bytes_received),
+      fec_messages_recovered(other.fec_messages_recovered),
+      fec_messages_unrecovered(other.fec_messages_unrecovered) {}
 
 RTCDataChannelStats::~RTCDataChannelStats() {}
 
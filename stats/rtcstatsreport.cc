@@ -97,6 +97,10 @@ std::unique_ptr<const RTCStats> RTCStatsReport::Take(const std::string& id) {
 
 void RTCStatsReport::TakeMembersFrom(
     rtc::scoped_refptr<RTCStatsReport> victim) {
+  // Move the entries of the smaller map into the larger one. When merging
+  // partial reports, one is often empty.
+  if (victim->stats_.size() > stats_.size())
+    stats_.swap(victim->stats_);
   for (StatsMap::iterator it = victim->stats_.begin();
        it != victim->stats_.end(); ++it) {
     AddStats(std::unique_ptr<const RTCStats>(it->second.release()));
@@ -139,4 +139,22 @@ TEST(RTCStatsReport, TakeMembersFrom) {
   EXPECT_EQ(i, static_cast<int64_t>(6));
 }
 
+TEST(RTCStatsReport, TakeMembersFromLargerReport) {
+  rtc::scoped_refptr<RTCStatsReport> a = RTCStatsReport::Create(1337);
+  a->AddStats(std::unique_ptr<RTCStats>(new RTCTestStats1("B", 1)));
+  rtc::scoped_refptr<RTCStatsReport> b = RTCStatsReport::Create(1338);
+  b->AddStats(std::unique_ptr<RTCStats>(new RTCTestStats1("A", 0)));
+  b->AddStats(std::unique_ptr<RTCStats>(new RTCTestStats1("C", 2)));
+
+  a->TakeMembersFrom(b);
+  EXPECT_EQ(a->timestamp_us(), 1337u);
+  EXPECT_EQ(b->size(), static_cast<size_t>(0));
+  int64_t i = 0;
+  for (const RTCStats& stats : *a) {
+    EXPECT_EQ(stats.timestamp_us(), i);
+    ++i;
+  }
+  EXPECT_EQ(i, static_cast<int64_t>(3));
+}
+
 }  // namespace webrtc
@@ -37,6 +37,15 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
         "=d"(cpu_info[3])
       : "a"(info_type));
 }
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile(
+      "mov %%ebx, %%edi\n"
+      "cpuid\n"
+      "xchg %%edi, %%ebx\n"
+      : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]),
+        "=d"(cpu_info[3])
+      : "a"(info_type), "c"(sub_type));
+}
 #else
 static inline void __cpuid(int cpu_info[4], int info_type) {
   __asm__ volatile("cpuid\n"
@@ -44,7 +53,20 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
                      "=d"(cpu_info[3])
                    : "a"(info_type));
 }
+static inline void __cpuidex(int cpu_info[4], int info_type, int sub_type) {
+  __asm__ volatile("cpuid\n"
+                   : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]),
+                     "=d"(cpu_info[3])
+                   : "a"(info_type), "c"(sub_type));
+}
 #endif
+
+// Reads an extended control register. Only valid if the OSXSAVE bit is set.
+static inline uint64_t _xgetbv(uint32_t xcr) {
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
 #endif  // _MSC_VER
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
@@ -59,6 +81,23 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  if (feature == kAVX2) {
+    // AVX registers can only be used if the OS saves them on context switches,
+    // i.e. OSXSAVE is set and XCR0 has both the SSE and AVX state bits. The
+    // AVX2 kernels also use FMA.
+    const bool fma = 0 != (cpu_info[2] & 0x00001000);
+    const bool osxsave = 0 != (cpu_info[2] & 0x08000000);
+    const bool avx = 0 != (cpu_info[2] & 0x10000000);
+    if (!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+      return 0;
+    }
+    __cpuid(cpu_info, 0);
+    if (cpu_info[0] < 7) {
+      return 0;
+    }
+    __cpuidex(cpu_info, 7, 0);
+    return 0 != (cpu_info[1] & 0x00000020);
+  }
   return 0;
 }
 #else